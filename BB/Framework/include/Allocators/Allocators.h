@@ -1,10 +1,12 @@
 #pragma once
 #include <cstdlib>
 #include <cstdint>
+#include "BackingAllocator.h"
 
 namespace BB
 {	
-#ifdef _DEBUG
+//The heap profiler needs the call site in release builds too.
+#if defined(_DEBUG) || defined(BB_HEAP_PROFILER)
 #define BB_MEMORY_DEBUG const char* a_File, int a_Line,
 #define BB_MEMORY_DEBUG_ARGS __FILE__, __LINE__,
 #define BB_MEMORY_DEBUG_SEND a_File, a_Line,
@@ -14,7 +16,7 @@ namespace BB
 #define BB_MEMORY_DEBUG_ARGS
 #define BB_MEMORY_DEBUG_SEND
 #define BB_MEMORY_DEBUG_FREE
-#endif //_DEBUG
+#endif //_DEBUG || BB_HEAP_PROFILER
 
 	constexpr const size_t MEMORY_BOUNDRY_FRONT = sizeof(size_t);
 	constexpr const size_t MEMORY_BOUNDRY_BACK = sizeof(size_t);
@@ -30,7 +32,7 @@ namespace BB
 	{
 		struct BaseAllocator
 		{
-			BaseAllocator(const char* a_Name = "unnamed") { name = a_Name; };
+			BaseAllocator(const char* a_Name = "unnamed");
 			//Destructor should be handled by the child types.
 			virtual operator Allocator() = 0;
 
@@ -48,13 +50,15 @@ namespace BB
 			struct AllocationLog
 			{
 				AllocationLog* prev; //8 bytes
-				void* front; //16 bytes 
-				void* back; //24 bytes
+				//next is only used to remove a log without walking the list.
+				AllocationLog* next; //16 bytes
+				void* front; //24 bytes 
+				void* back; //32 bytes
 				//maybe not safe due to possibly allocating more then 4 gb.
-				const char* file; //32 bytes
-				int line; //36 bytes
-				uint32_t allocSize; //40 bytes
-				const char* tagName; //48 bytes
+				const char* file; //40 bytes
+				int line; //44 bytes
+				uint32_t allocSize; //48 bytes
+				const char* tagName; //56 bytes
 			}* frontLog = nullptr;
 			const char* name;
 
@@ -113,7 +117,8 @@ namespace BB
 
 		struct FreelistAllocator : public BaseAllocator
 		{
-			FreelistAllocator(const size_t a_Size, const char* a_Name = "unnamed");
+			//a_VirtualOptions can give big freelists huge pages or a NUMA node.
+			FreelistAllocator(const size_t a_Size, const char* a_Name = "unnamed", const VirtualMemoryOptions& a_VirtualOptions = VirtualMemoryOptions());
 			~FreelistAllocator();
 
 			operator Allocator() override;
@@ -185,6 +190,66 @@ namespace BB
 			size_t m_FreeBlocksAmount;
 		};
 
+		//Two level segregated fit allocator, allocating and freeing is O(1) and free blocks are merged with their neighbours right away.
+		struct TLSFAllocator : public BaseAllocator
+		{
+			TLSFAllocator(const size_t a_Size, const char* a_Name = "unnamed");
+			~TLSFAllocator();
+
+			operator Allocator() override;
+
+			//just delete these for safety, copies might cause errors.
+			TLSFAllocator(const TLSFAllocator&) = delete;
+			TLSFAllocator(const TLSFAllocator&&) = delete;
+			TLSFAllocator& operator =(const TLSFAllocator&) = delete;
+			TLSFAllocator& operator =(TLSFAllocator&&) = delete;
+
+			void* Alloc(size_t a_Size, size_t a_Alignment) override;
+			void Free(void* a_Ptr) override;
+			void Clear() override;
+
+			//Every block has an ALIGN_SIZE aligned size, allocations are aligned to at least this.
+			static constexpr const uint32_t ALIGN_SIZE_LOG2 = 4;
+			static constexpr const size_t ALIGN_SIZE = 1ull << ALIGN_SIZE_LOG2;
+			//Every first level list is split in SL_INDEX_COUNT second level lists.
+			static constexpr const uint32_t SL_INDEX_COUNT_LOG2 = 5;
+			static constexpr const uint32_t SL_INDEX_COUNT = 1u << SL_INDEX_COUNT_LOG2;
+			//Blocks below SMALL_BLOCK_SIZE all go in the first first level list.
+			static constexpr const uint32_t FL_INDEX_SHIFT = SL_INDEX_COUNT_LOG2 + ALIGN_SIZE_LOG2;
+			static constexpr const size_t SMALL_BLOCK_SIZE = 1ull << FL_INDEX_SHIFT;
+			//Biggest block size is 1 << FL_INDEX_MAX.
+			static constexpr const uint32_t FL_INDEX_MAX = 38;
+			static constexpr const uint32_t FL_INDEX_COUNT = FL_INDEX_MAX - FL_INDEX_SHIFT + 1;
+
+			struct BlockHeader
+			{
+				//Only the prevPhysical and size are kept for used blocks, the rest is user memory.
+				BlockHeader* prevPhysical;
+				//Size of the full block, the lowest bit is set when the block is free.
+				size_t size;
+				BlockHeader* nextFree;
+				BlockHeader* prevFree;
+			};
+
+			uint8_t* m_Start = nullptr;
+			//Zero sized used block at the end of the memory, so the last block has a next block.
+			BlockHeader* m_Sentinel;
+			size_t m_TotalAllocSize;
+
+			uint32_t m_FLBitmap;
+			uint32_t m_SLBitmap[FL_INDEX_COUNT];
+			BlockHeader* m_FreeBlocks[FL_INDEX_COUNT][SL_INDEX_COUNT];
+
+		private:
+			void InsertFreeBlock(BlockHeader* a_Block);
+			void RemoveFreeBlock(BlockHeader* a_Block);
+			BlockHeader* FindFreeBlock(const size_t a_Size);
+			//Marks a_Block as free, merges it with it's free neighbours and puts it in the free lists.
+			void ReleaseBlock(BlockHeader* a_Block);
+			//False if the reservation has no space left, Alloc then returns a nullptr.
+			bool Grow(const size_t a_MinimumSize);
+		};
+
 		//struct PoolAllocator
 		//{
 		//	PoolAllocator(const size_t a_ObjectSize, const size_t a_ObjectCount, const size_t a_Alignment);
@@ -1,5 +1,6 @@
 #pragma once
 #include <cstdlib>
+#include <cstdint>
 
 namespace BB
 {
@@ -15,18 +16,69 @@ namespace BB
 	constexpr size_t VIRTUAL_RESERVE_EXTRA = 64;  //reserve 256 times more virtual space (64 times more on x86).
 #endif //_X86
 
+	//A reservation is never bigger then this or the requested size, so big pools do not use up the address space.
+#ifdef _64BIT
+	constexpr size_t VIRTUAL_RESERVE_MAX_SIZE = 4ull * 1024 * 1024 * 1024;
+#elif _32BIT
+	constexpr size_t VIRTUAL_RESERVE_MAX_SIZE = 256 * 1024 * 1024;
+#endif //_X86
+
+	//Commits grow by at least what is already commited, but never by more then this at once.
+	constexpr size_t VIRTUAL_COMMIT_AHEAD_MAX = 64 * 1024 * 1024;
+	constexpr uint32_t VIRTUAL_NUMA_NODE_ANY = UINT32_MAX;
+
+	enum class VIRTUAL_PAGE_TYPE : uint32_t
+	{
+		NORMAL,
+		//madvise the reservation so the OS can back it with huge pages, no setup required.
+		TRANSPARENT_HUGE,
+		//Huge pages from the OS huge page pool (MAP_HUGETLB), falls back to TRANSPARENT_HUGE if the pool is empty.
+		EXPLICIT_HUGE
+	};
+
+	//Only used when a reservation is made, resizes use the options of the reservation.
+	struct VirtualMemoryOptions
+	{
+		//Huge pages are Linux only, Windows needs them commited on reserve with the lock pages privilege.
+		//Commits are rounded up to the huge page size, so only use this for big allocations.
+		VIRTUAL_PAGE_TYPE pageType = VIRTUAL_PAGE_TYPE::NORMAL;
+		//Preferred NUMA node for the physical memory, the OS may still use a different node.
+		uint32_t numaNode = VIRTUAL_NUMA_NODE_ANY;
+		//Grow commits geometrically so that most resizes do not need to call the OS.
+		bool commitAhead = true;
+	};
+
+	//Totals for every mallocVirtual reservation.
+	struct VirtualMemoryStats
+	{
+		size_t reserveCount;
+		//Times the OS was asked to commit memory.
+		size_t commitCount;
+		//Resizes that fit in memory that was already commited ahead.
+		size_t commitsAvoided;
+		size_t bytesReserved;
+		size_t bytesCommited;
+		size_t hugePageBytesCommited;
+		//Estimate, assumes all huge page memory is touched and the OS gave huge pages.
+		//A huge page is a single page fault instead of one for every normal page in it.
+		size_t pageFaultsAvoided;
+	};
+
 	/// <summary>
 	/// Reserve and commit virtual memory at the same time. 
 	/// </summary>
 	/// <param name="a_Start:"> The previous pointer used to commit the backing memory, nullptr if this is the first instance of allocation. </param>
 	/// <param name="a_Size:"> size of the virtual memory allocation in bytes, will be changed to be above OSDevice.virtual_memory_minimum_allocation and a multiple of OSDevice.virtual_memory_page_size. If a_Start is not a nullptr it will extend the commited range, will also be changed similiarly to normal.</param>
-	/// <param name="a_ReserveSize:"> How much extra memory is reserved for possible resizes. Default is VIRTUAL_RESERVE_STANDARD, which will reserve 128 times more virtual space (64 times more on x86).</param>
-	/// <returns>Pointer to the start of the virtual memory, or the updated commited range. </returns>
-	void* mallocVirtual(void* a_Start, size_t& a_Size, const size_t a_ReserveSize = VIRTUAL_RESERVE_STANDARD);
+	/// <param name="a_ReserveSize:"> How much extra memory is reserved for possible resizes. Default is VIRTUAL_RESERVE_STANDARD, which will reserve 128 times more virtual space (64 times more on x86). Capped at VIRTUAL_RESERVE_MAX_SIZE, less is reserved if the OS has not enough address space.</param>
+	/// <returns>Pointer to the start of the virtual memory, or the updated commited range. nullptr if the OS is out of memory or a_Start has not enough reserved for the resize.</returns>
+	/// <param name="a_Options:"> How a new reservation is backed, ignored if a_Start is not a nullptr. </param>
+	void* mallocVirtual(void* a_Start, size_t& a_Size, const size_t a_ReserveSize = VIRTUAL_RESERVE_STANDARD, const VirtualMemoryOptions& a_Options = VirtualMemoryOptions());
 	
 	/// <summary>
 	/// Free all the pages from a given pointer.
 	/// </summary>
 	/// /// <param name="a_Ptr:"> The pointer returned from mallocVirtual when you provided a nullptr to a_Start. </param>
 	void freeVirtual(void* a_Ptr);
+
+	VirtualMemoryStats GetVirtualMemoryStats();
 }
\ No newline at end of file
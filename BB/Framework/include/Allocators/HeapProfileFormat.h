@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+
+//Layout of the file written by HeapProfiler::DumpToFile.
+//Only plain types so that tools can read it without pulling in the framework.
+namespace BB
+{
+	constexpr const uint32_t HEAP_PROFILE_MAGIC = 0x50484242; //"BBHP"
+	constexpr const uint32_t HEAP_PROFILE_VERSION = 1;
+	//Index into the string table for allocators that never registered a name.
+	constexpr const uint32_t HEAP_PROFILE_NO_STRING = UINT32_MAX;
+
+	//File order: header, call sites, allocators, tags, frames (oldest first), string table.
+	//String offsets are relative to the start of the string table, every string is null terminated.
+	struct HeapProfileFileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t callSiteCount;
+		uint32_t allocatorCount;
+		uint32_t tagCount;
+		uint32_t frameCount;
+		uint64_t stringTableSize;
+	};
+
+	struct HeapProfileCallSite
+	{
+		uint32_t file;
+		uint32_t line;
+		//Index of the allocator this call site used last.
+		uint32_t allocator;
+		uint32_t padding;
+		uint64_t allocCount;
+		uint64_t freeCount;
+		uint64_t totalBytes;
+		uint64_t liveBytes;
+		uint64_t peakBytes;
+	};
+
+	struct HeapProfileAllocator
+	{
+		uint32_t name;
+		uint32_t padding;
+		uint64_t allocCount;
+		uint64_t freeCount;
+		uint64_t totalBytes;
+		uint64_t liveBytes;
+		uint64_t peakBytes;
+	};
+
+	struct HeapProfileTag
+	{
+		uint32_t name;
+		uint32_t padding;
+		uint64_t liveBytes;
+		uint64_t peakBytes;
+	};
+
+	struct HeapProfileFrame
+	{
+		uint64_t frameNumber;
+		uint64_t allocCount;
+		uint64_t freeCount;
+		uint64_t allocBytes;
+		uint64_t freeBytes;
+	};
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "Allocators.h"
+#include "HeapProfileFormat.h"
+
+namespace BB
+{
+	constexpr const uint32_t HEAP_PROFILER_MAX_CALL_SITES = 4096;
+	constexpr const uint32_t HEAP_PROFILER_MAX_ALLOCATORS = 256;
+	constexpr const uint32_t HEAP_PROFILER_MAX_TAGS = 256;
+	//Amount of frames kept for the allocation rate history.
+	constexpr const uint32_t HEAP_PROFILER_FRAME_HISTORY = 256;
+	//Every profiled allocation has this many bytes (or it's alignment if that is bigger) in front of it.
+	constexpr const size_t HEAP_PROFILER_HEADER_SIZE = 16;
+
+	struct HeapCallSiteInfo
+	{
+		const char* file;
+		int line;
+		//Allocator this call site used last.
+		const void* allocator;
+		const char* allocatorName;
+		uint64_t allocCount;
+		uint64_t freeCount;
+		uint64_t totalBytes;
+		uint64_t liveBytes;
+		uint64_t peakBytes;
+	};
+
+	struct HeapAllocatorInfo
+	{
+		const void* allocator;
+		const char* name;
+		uint64_t allocCount;
+		uint64_t freeCount;
+		uint64_t totalBytes;
+		uint64_t liveBytes;
+		uint64_t peakBytes;
+	};
+
+	struct HeapTagInfo
+	{
+		const char* name;
+		uint64_t liveBytes;
+		uint64_t peakBytes;
+	};
+
+	//Counts every allocation per call site, allocator, tag and frame with atomic counters, it works in release builds too.
+	//Compile with BB_HEAP_PROFILER (cmake option) to send every BBalloc, BBnew and BBnewArr through here.
+	//Call site, allocator and tag tables never remove entries, the first slot of each table collects everything that did not fit.
+	namespace HeapProfiler
+	{
+		//Allocate through the profiler, the pointer must be freed with HeapProfiler::Free.
+		void* Alloc(BB_MEMORY_DEBUG Allocator a_Allocator, const size_t a_Size, const size_t a_Alignment);
+		void Free(Allocator a_Allocator, void* a_Ptr);
+		//Moves the allocation's bytes from it's current tag to a_TagName, a_TagName must stay valid.
+		void TagAllocation(const void* a_Ptr, const char* a_TagName);
+		//Pointer the backing allocator returned for a profiled allocation.
+		void* GetAllocationStart(const void* a_Ptr);
+
+		//Name shown for the allocator, a_Name must stay valid.
+		void RegisterAllocator(const void* a_Allocator, const char* a_Name);
+		//For allocators that free everything at once, the allocator's live bytes go back to 0.
+		//Call sites and tags keep the bytes as live, they do not know which allocator they came from.
+		void OnClear(const void* a_Allocator);
+
+		//Stores the allocation rate of this frame in the history, call it from one thread only.
+		//Called by FrameGraph::BeginRendering.
+		void NextFrame();
+
+		//All Get functions return the amount of infos written.
+		uint32_t GetCallSiteInfos(HeapCallSiteInfo* a_Infos, const uint32_t a_MaxCount);
+		uint32_t GetAllocatorInfos(HeapAllocatorInfo* a_Infos, const uint32_t a_MaxCount);
+		uint32_t GetTagInfos(HeapTagInfo* a_Infos, const uint32_t a_MaxCount);
+		//Oldest frame first, call it from the same thread as NextFrame.
+		uint32_t GetFrameHistory(HeapProfileFrame* a_Frames, const uint32_t a_MaxCount);
+
+		//Writes everything in the HeapProfileFormat.h layout, read it with the HeapProfileReport tool.
+		//Returns false if the file could not be created.
+		bool DumpToFile(const char* a_Path);
+	}
+}
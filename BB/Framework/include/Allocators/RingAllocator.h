@@ -1,5 +1,6 @@
 #pragma once
 #include "BBMemory.h"
+#include "BackingAllocator.h"
 
 namespace BB
 {
@@ -57,4 +58,73 @@ namespace BB
 		size_t m_Size;
 		size_t m_Used;
 	};
+
+	//Max amount of spans that are waiting on a fence, a frame uses more then one span only when the ring wraps or grows.
+	constexpr const uint32_t FRAME_RING_MAX_SPANS = 64;
+
+	//A ring allocator that never overwrites memory that is still in use, use it for upload and transient data of frames in flight.
+	//Every allocation since the last EndFrame is tagged with the fence value given to EndFrame, Retire gives that space back once the fence completed.
+	//When the ring is full of live memory it commits more of it's reserved virtual memory instead of going back to the start.
+	//Not thread safe.
+	class FrameRingAllocator
+	{
+	public:
+		operator Allocator();
+
+		//a_Size must be a value above 0, but it will return the actual page aligned size of the allocator.
+		//The allocator can grow up to a_Size * a_ReserveMultiplier.
+		FrameRingAllocator(size_t& a_Size, const size_t a_ReserveMultiplier = VIRTUAL_RESERVE_HALF);
+		~FrameRingAllocator();
+
+		//just delete these for safety, copies might cause errors.
+		FrameRingAllocator(const FrameRingAllocator&) = delete;
+		FrameRingAllocator(const FrameRingAllocator&&) = delete;
+		FrameRingAllocator& operator =(const FrameRingAllocator&) = delete;
+		FrameRingAllocator& operator =(FrameRingAllocator&&) = delete;
+
+		void* Alloc(size_t a_Size, size_t a_Alignment);
+		//All allocations since the last EndFrame can be reused after a_FenceValue completed, fence values must go up.
+		void EndFrame(const uint64_t a_FenceValue);
+		//Gives back the memory of every frame with a fence value equal or below a_CompletedFenceValue.
+		void Retire(const uint64_t a_CompletedFenceValue);
+
+		//Bytes of frames that did not retire yet, including the frame that did not end yet.
+		size_t GetUsed() const;
+		size_t GetCapacity() const { return m_Capacity; }
+		size_t GetMaxCapacity() const { return m_MaxCapacity; }
+		uint32_t GetGrowCount() const { return m_GrowCount; }
+
+	private:
+		//A range of the ring that is in use until fenceValue completes.
+		struct Span
+		{
+			uint64_t fenceValue;
+			size_t start;
+			size_t end;
+		};
+
+		size_t AlignPosition(const size_t a_Position, const size_t a_Alignment) const;
+		//First byte after a_Position that is in use by a span, or the capacity if there is none.
+		size_t FindLimit(const size_t a_Position) const;
+		size_t FindSpace(const size_t a_Size, const size_t a_Alignment);
+		void CloseSpan();
+		void Grow(const size_t a_RequiredCapacity);
+
+		void* m_Start;
+		size_t m_Capacity;
+		size_t m_MaxCapacity;
+		//Next free byte, everything from m_Head until m_Limit is free.
+		size_t m_Head;
+		size_t m_Limit;
+		//Start of the span that is being allocated from, it's fence value is not known until EndFrame.
+		size_t m_SpanStart;
+		uint64_t m_LastFenceValue;
+		uint32_t m_GrowCount;
+
+		//FIFO of spans, spans that did not get a fence value from EndFrame yet are at the back.
+		uint32_t m_SpanFront;
+		uint32_t m_SpanCount;
+		uint32_t m_OpenSpanCount;
+		Span m_Spans[FRAME_RING_MAX_SPANS];
+	};
 }
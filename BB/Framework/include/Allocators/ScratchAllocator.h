@@ -0,0 +1,74 @@
+#pragma once
+#include "BBMemory.h"
+#include "BackingAllocator.h"
+
+namespace BB
+{
+	//Upper limit of threads that own a scratch arena at the same time.
+	constexpr const uint32_t SCRATCH_MAX_ARENAS = 64;
+	//Memory that is commited when a thread first uses scratch memory, it grows when needed.
+	constexpr const size_t SCRATCH_COMMIT_START = kbSize * 256;
+	//The reservation of a single arena is SCRATCH_COMMIT_START times this, 64 MB on 64 bit.
+	constexpr const size_t SCRATCH_RESERVE_MULTIPLIER = VIRTUAL_RESERVE_EXTRA;
+
+	//Position in the calling thread's arena, get it with Scratch::Mark().
+	struct ScratchMarker
+	{
+		void* position;
+	};
+
+	struct ScratchArenaInfo
+	{
+		uint32_t arenaIndex;
+		size_t used;
+		size_t commited;
+		size_t reserved;
+		//Highest usage since the arena was created.
+		size_t highWaterMark;
+		//Highest usage of the previous frame.
+		size_t frameHighWaterMark;
+	};
+
+	//Every thread gets it's own linear arena on mallocVirtual, so allocating from it never locks.
+	//Memory is never freed one by one, rewind to a marker or wait for the next frame.
+	namespace Scratch
+	{
+		//Allocator for the calling thread's arena, do not hand it to other threads.
+		//Free calls on it are ignored.
+		Allocator GetAllocator();
+		void* Alloc(const size_t a_Size, const size_t a_Alignment);
+
+		//Every Mark must be paired with a Rewind on the same thread, use ScratchScope for that.
+		ScratchMarker Mark();
+		void Rewind(const ScratchMarker a_Marker);
+
+		//Resets every arena, each thread does this itself the next time it uses scratch memory while it has no open scopes.
+		//Called by FrameGraph::BeginRendering.
+		void NextFrame();
+
+		ScratchArenaInfo GetThreadArenaInfo();
+		//Returns the amount of infos written to a_Infos.
+		uint32_t GetArenaInfos(ScratchArenaInfo* a_Infos, const uint32_t a_MaxCount);
+	}
+
+	//Rewinds the calling thread's scratch arena when it goes out of scope.
+	class ScratchScope
+	{
+	public:
+		operator Allocator() { return Scratch::GetAllocator(); }
+
+		ScratchScope() : m_Marker(Scratch::Mark()) {}
+		~ScratchScope() { Scratch::Rewind(m_Marker); }
+
+		//just delete these for safety, copies might cause errors.
+		ScratchScope(const ScratchScope&) = delete;
+		ScratchScope(const ScratchScope&&) = delete;
+		ScratchScope& operator =(const ScratchScope&) = delete;
+		ScratchScope& operator =(ScratchScope&&) = delete;
+
+		void* Alloc(const size_t a_Size, const size_t a_Alignment) { return Scratch::Alloc(a_Size, a_Alignment); }
+
+	private:
+		const ScratchMarker m_Marker;
+	};
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "BBMemory.h"
+#include <atomic>
+#include <mutex>
+
+namespace BB
+{
+	//Upper limit of threads that use thread cache allocators at the same time.
+	constexpr const uint32_t THREAD_CACHE_MAX_THREADS = 64;
+	//Size classes go up to this size, bigger allocations go straight to mallocVirtual.
+	constexpr const size_t THREAD_CACHE_MAX_CLASS_SIZE = kbSize * 32;
+	constexpr const uint32_t THREAD_CACHE_CLASS_COUNT = 40;
+	//Memory that a thread takes from the backing allocator at once for a size class.
+	constexpr const size_t THREAD_CACHE_SPAN_SIZE = kbSize * 64;
+
+	struct ThreadCache;
+
+	//Thread-safe allocator front, every thread allocates from it's own size class caches without locking.
+	//Freeing from the thread that owns the memory puts it back in the cache directly,
+	//freeing from another thread pushes it on a lock-free queue that the owner empties on it's next allocation.
+	//The backing allocator is only used under a lock when a thread needs a new span.
+	//Allocations are not in the debug allocation logs, those are not thread-safe.
+	class ThreadCacheAllocator
+	{
+	public:
+		operator Allocator();
+
+		ThreadCacheAllocator(const Allocator a_BackingAllocator, const char* a_Name = "unnamed");
+		//Only destroy it when no thread uses it anymore, all the spans go back to the backing allocator.
+		~ThreadCacheAllocator();
+
+		//just delete these for safety, copies might cause errors.
+		ThreadCacheAllocator(const ThreadCacheAllocator&) = delete;
+		ThreadCacheAllocator(const ThreadCacheAllocator&&) = delete;
+		ThreadCacheAllocator& operator =(const ThreadCacheAllocator&) = delete;
+		ThreadCacheAllocator& operator =(ThreadCacheAllocator&&) = delete;
+
+		void* Alloc(size_t a_Size, size_t a_Alignment);
+		void Free(void* a_Ptr);
+
+		const char* name;
+
+	private:
+		void* AllocFromSpan(ThreadCache& a_Cache, const uint32_t a_SizeClass);
+
+		const Allocator m_BackingAllocator;
+		std::mutex m_BackingMutex;
+		//THREAD_CACHE_MAX_THREADS caches, indexed by the thread's cache slot.
+		ThreadCache* m_Caches;
+		uint8_t* m_CacheMemory;
+	};
+}
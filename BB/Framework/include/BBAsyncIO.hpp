@@ -0,0 +1,63 @@
+#pragma once
+#include "Common.h"
+#include "BBThreadScheduler.hpp"
+#include <atomic>
+
+namespace BB
+{
+	//Linux caps a single read at this size, use more requests for bigger reads. A bigger request is set to FAILED without reading.
+	constexpr const uint64_t ASYNC_READ_MAX_SIZE = 0x7FFFF000;
+
+	enum class ASYNC_READ_STATE : uint32_t
+	{
+		PENDING,
+		DONE,
+		FAILED
+	};
+
+	enum class ASYNC_IO_BACKEND : uint32_t
+	{
+		NONE, //AsyncIO is not initialized.
+		IO_URING, //Linux only, all reads are in flight in the kernel at the same time.
+		THREAD_POOL //Blocking positional reads on dedicated I/O threads.
+	};
+
+	//A read into a caller-provided buffer, the request must stay alive and unchanged until it is no longer PENDING.
+	//Fill in the input part and leave the rest default.
+	struct AsyncReadRequest
+	{
+		//Opened with LoadOSFile, the file position is not used or changed by the read.
+		OSFileHandle file;
+		void* buffer = nullptr;
+		uint64_t offset = 0;
+		uint64_t size = 0;
+		//Optional, started as a job with completionParameter when the read is DONE or FAILED.
+		void(*completionJob)(void*) = nullptr;
+		void* completionParameter = nullptr;
+
+		//Written by AsyncIO.
+		std::atomic<ASYNC_READ_STATE> state{ ASYNC_READ_STATE::PENDING };
+		//Less then size when the read goes past the end of the file.
+		uint64_t bytesRead = 0;
+		JobCounter* counter = nullptr;
+		AsyncReadRequest* next = nullptr;
+	};
+
+	namespace AsyncIO
+	{
+		//a_QueueDepth is the amount of reads that can be in flight at once, more reads wait in SubmitReads.
+		//a_FallbackThreadCount is the amount of I/O threads used when io_uring is not available.
+		void InitAsyncIO(const uint32_t a_QueueDepth, const uint32_t a_FallbackThreadCount, const bool a_ForceThreadPool = false);
+		//All submitted reads must be finished before calling this.
+		void DestroyAsyncIO();
+
+		//Queues all reads in one go, with io_uring this is a single system call.
+		//a_Counter is optional and is incremented for every request and decremented when its read and completion job are done.
+		//Wait with Threads::WaitForCounter, it runs other jobs while the reads are in flight. The counter must outlive the reads.
+		void SubmitReads(AsyncReadRequest* a_Requests, const uint32_t a_RequestCount, JobCounter* a_Counter = nullptr);
+		//Yields until the request is no longer PENDING, use a JobCounter to run other jobs while waiting.
+		void WaitForRead(const AsyncReadRequest& a_Request);
+
+		ASYNC_IO_BACKEND GetBackend();
+	}
+}
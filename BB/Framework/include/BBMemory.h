@@ -1,5 +1,6 @@
 #pragma once
 #include "Allocators/Allocators.h"
+#include "Allocators/HeapProfiler.h"
 #include "Utils/Utils.h"
 #include "Utils/Logger.h"
 #include <malloc.h>
@@ -19,6 +20,7 @@ namespace BB
 	using FixedLinearAllocator_t = allocators::FixedLinearAllocator;
 	using FreelistAllocator_t = allocators::FreelistAllocator;
 	using POW_FreelistAllocator_t = allocators::POW_FreelistAllocator;
+	using TLSFAllocator_t = allocators::TLSFAllocator;
 
 //_alloca wrapper, does not require a free call.
 #define BBstackAlloc(a_Count, a_Type) (a_Type*)_alloca(a_Count * sizeof(a_Type))
@@ -31,10 +33,29 @@ namespace BB
 #define BBfreeArr(a_Allocator, a_Ptr) BBfreeArr_f(a_Allocator, a_Ptr)
 
 #pragma region AllocationFunctions
+	//Every allocation function below goes through these two, with BB_HEAP_PROFILER they are counted by the heap profiler.
+	inline void* AllocateRaw_f(BB_MEMORY_DEBUG Allocator a_Allocator, const size_t a_Size, const size_t a_Alignment)
+	{
+#ifdef BB_HEAP_PROFILER
+		return HeapProfiler::Alloc(BB_MEMORY_DEBUG_SEND a_Allocator, a_Size, a_Alignment);
+#else
+		return a_Allocator.func(BB_MEMORY_DEBUG_SEND a_Allocator.allocator, a_Size, a_Alignment, nullptr);
+#endif //BB_HEAP_PROFILER
+	}
+
+	inline void FreeRaw_f(Allocator a_Allocator, void* a_Ptr)
+	{
+#ifdef BB_HEAP_PROFILER
+		HeapProfiler::Free(a_Allocator, a_Ptr);
+#else
+		a_Allocator.func(BB_MEMORY_DEBUG_FREE a_Allocator.allocator, 0, 0, a_Ptr);
+#endif //BB_HEAP_PROFILER
+	}
+
 	//Use the BBnew or BBalloc function instead of this.
 	inline void* BBalloc_f(BB_MEMORY_DEBUG Allocator a_Allocator, const size_t a_Size, const size_t a_Alignment)
 	{
-		return a_Allocator.func(BB_MEMORY_DEBUG_SEND a_Allocator.allocator, a_Size, a_Alignment, nullptr);
+		return AllocateRaw_f(BB_MEMORY_DEBUG_SEND a_Allocator, a_Size, a_Alignment);
 	}
 
 	//Use the BBnewArr function instead of this.
@@ -45,7 +66,7 @@ namespace BB
 
 		if constexpr (std::is_trivially_constructible_v<T> || std::is_trivially_destructible_v<T>)
 		{
-			return reinterpret_cast<T*>(a_Allocator.func(BB_MEMORY_DEBUG_SEND a_Allocator.allocator, sizeof(T) * a_Length, __alignof(T), nullptr));
+			return reinterpret_cast<T*>(AllocateRaw_f(BB_MEMORY_DEBUG_SEND a_Allocator, sizeof(T) * a_Length, __alignof(T)));
 		}
 		else
 		{
@@ -57,7 +78,7 @@ namespace BB
 				t_HeaderSize = sizeof(size_t) / sizeof(T);
 
 			//Allocate the array, but shift it by sizeof(size_t) bytes forward to allow the size of the header to be put in as well.
-			T* ptr = (reinterpret_cast<T*>(a_Allocator.func(BB_MEMORY_DEBUG_SEND a_Allocator.allocator, sizeof(T) * (a_Length + t_HeaderSize), __alignof(T), nullptr))) + t_HeaderSize;
+			T* ptr = (reinterpret_cast<T*>(AllocateRaw_f(BB_MEMORY_DEBUG_SEND a_Allocator, sizeof(T) * (a_Length + t_HeaderSize), __alignof(T)))) + t_HeaderSize;
 
 			//Store the size of the array inside the first element of the pointer.
 			*(reinterpret_cast<size_t*>(ptr) - 1) = a_Length;
@@ -77,11 +98,12 @@ namespace BB
 	inline void BBfree_f(Allocator a_Allocator, T* a_Ptr)
 	{
 		BB_ASSERT(a_Ptr != nullptr, "Trying to free a nullptr");
-		if constexpr (!std::is_trivially_destructible_v<T>)
+		//void has no destructor, memory from BBalloc is freed as void*.
+		if constexpr (!std::is_void_v<T> && !std::is_trivially_destructible_v<T>)
 		{
 			a_Ptr->~T();
 		}
-		a_Allocator.func(BB_MEMORY_DEBUG_FREE a_Allocator.allocator, 0, 0, a_Ptr);
+		FreeRaw_f(a_Allocator, a_Ptr);
 	}
 
 	template <typename T>
@@ -91,7 +113,7 @@ namespace BB
 
 		if constexpr (std::is_trivially_constructible_v<T> || std::is_trivially_destructible_v<T>)
 		{
-			a_Allocator.func(BB_MEMORY_DEBUG_FREE a_Allocator.allocator, 0, 0, a_Ptr);
+			FreeRaw_f(a_Allocator, a_Ptr);
 		}
 		else
 		{
@@ -107,12 +129,18 @@ namespace BB
 			else
 				t_HeaderSize = sizeof(size_t) / sizeof(T);
 
-			a_Allocator.func(BB_MEMORY_DEBUG_FREE a_Allocator.allocator, 0, 0, a_Ptr - t_HeaderSize);
+			FreeRaw_f(a_Allocator, a_Ptr - t_HeaderSize);
 		}
 	}
 
 	inline void BBTagAlloc(Allocator a_Allocator, const void* a_Ptr, const char* a_TagName)
 	{
+#ifdef BB_HEAP_PROFILER
+		HeapProfiler::TagAllocation(a_Ptr, a_TagName);
+		//The allocation log is in front of the profiler's header.
+		a_Ptr = HeapProfiler::GetAllocationStart(a_Ptr);
+#endif //BB_HEAP_PROFILER
+#ifdef _DEBUG
 		typedef allocators::BaseAllocator::AllocationLog AllocationLog;
 		AllocationLog* t_Log = reinterpret_cast<AllocationLog*>(Pointer::Subtract(a_Ptr, sizeof(AllocationLog)));
 		//do a check to see if the boundries are there, if yes. Then it's a 99.99999% chance this is a existing allocation using BB.
@@ -122,6 +150,7 @@ namespace BB
 		BB_ASSERT(back - front == t_Log->allocSize, "BBTagAlloc is not tagging a memory space allocated by a BB allocator");
 
 		t_Log->tagName = a_TagName;
+#endif //_DEBUG
 	}
 }
 #pragma endregion // AllocationFunctions
\ No newline at end of file
@@ -0,0 +1,109 @@
+#pragma once
+#include "BBThreadScheduler.hpp"
+#include "Utils/Slice.h"
+
+namespace BB
+{
+	namespace Threads
+	{
+		//Upper limit of jobs that a single parallel range is split over.
+		constexpr const uint32_t PARALLEL_MAX_JOBS = 32;
+
+		//Called for every chunk [a_Begin, a_End) of a parallel range.
+		//a_JobSlot is unique for every job that works on the range and is lower then PARALLEL_MAX_JOBS.
+		//a_Scratch is the thread's scratch arena, it is rewound after every chunk.
+		typedef void (*PFN_ParallelRange)(const size_t a_Begin, const size_t a_End, const uint32_t a_JobSlot, Allocator a_Scratch, void* a_Data);
+		//Called once when all chunks are done, before the task returned by StartParallelRange finishes.
+		typedef void (*PFN_ParallelFinish)(const uint32_t a_JobSlotCount, void* a_Data);
+
+		//Splits a_Count elements into chunks of a_GrainSize and spreads them over the worker threads.
+		//a_DataSize bytes of a_Data are copied and stay alive until the returned task is finished.
+		ThreadTask StartParallelRange(const size_t a_Count, const size_t a_GrainSize, PFN_ParallelRange a_Range, PFN_ParallelFinish a_Finish, const void* a_Data, const size_t a_DataSize);
+
+		template<typename T>
+		using PFN_ParallelFor = void(*)(const Slice<T> a_Range, const size_t a_StartIndex, Allocator a_Scratch, void* a_UserData);
+		template<typename T, typename R>
+		using PFN_ParallelReduceMap = R(*)(const Slice<T> a_Range, Allocator a_Scratch, void* a_UserData);
+		template<typename R>
+		using PFN_ParallelReduceCombine = R(*)(const R& a_Lhs, const R& a_Rhs);
+
+		//a_Function gets called for sub slices of a_Slice, a_StartIndex is the index of the sub slice in a_Slice.
+		template<typename T>
+		ThreadTask ParallelFor(const Slice<T> a_Slice, const size_t a_GrainSize, PFN_ParallelFor<T> a_Function, void* a_UserData)
+		{
+			struct ForData
+			{
+				T* data;
+				PFN_ParallelFor<T> function;
+				void* userData;
+			};
+			const ForData t_Data{ a_Slice.data(), a_Function, a_UserData };
+
+			return StartParallelRange(a_Slice.size(), a_GrainSize,
+				[](const size_t a_Begin, const size_t a_End, const uint32_t, Allocator a_Scratch, void* a_Data)
+				{
+					const ForData& t_ForData = *reinterpret_cast<const ForData*>(a_Data);
+					t_ForData.function(Slice<T>(t_ForData.data + a_Begin, a_End - a_Begin), a_Begin, a_Scratch, t_ForData.userData);
+				},
+				nullptr, &t_Data, sizeof(t_Data));
+		}
+
+		template<typename T>
+		ThreadTask ParallelFor(Array<T>& a_Array, const size_t a_GrainSize, PFN_ParallelFor<T> a_Function, void* a_UserData)
+		{
+			return ParallelFor(Slice<T>(a_Array), a_GrainSize, a_Function, a_UserData);
+		}
+
+		//a_Map reduces a sub slice to a single value, a_Combine merges two values.
+		//a_Combine must be associative and commutative since the chunks are combined in any order.
+		//a_Result is written before the returned task is finished.
+		template<typename T, typename R>
+		ThreadTask ParallelReduce(const Slice<T> a_Slice, const size_t a_GrainSize, const R a_Identity, PFN_ParallelReduceMap<T, R> a_Map, PFN_ParallelReduceCombine<R> a_Combine, R* a_Result, void* a_UserData)
+		{
+			static_assert(std::is_trivially_copyable_v<R>, "ParallelReduce result type must be trivially copyable.");
+			struct ReduceData
+			{
+				T* data;
+				PFN_ParallelReduceMap<T, R> map;
+				PFN_ParallelReduceCombine<R> combine;
+				R* result;
+				void* userData;
+				R identity;
+				//One partial result per job, so jobs never share a value.
+				R partials[PARALLEL_MAX_JOBS];
+			};
+			ReduceData t_Data{};
+			t_Data.data = a_Slice.data();
+			t_Data.map = a_Map;
+			t_Data.combine = a_Combine;
+			t_Data.result = a_Result;
+			t_Data.userData = a_UserData;
+			t_Data.identity = a_Identity;
+			for (uint32_t i = 0; i < PARALLEL_MAX_JOBS; i++)
+				t_Data.partials[i] = a_Identity;
+
+			return StartParallelRange(a_Slice.size(), a_GrainSize,
+				[](const size_t a_Begin, const size_t a_End, const uint32_t a_JobSlot, Allocator a_Scratch, void* a_Data)
+				{
+					ReduceData& t_ReduceData = *reinterpret_cast<ReduceData*>(a_Data);
+					const R t_Value = t_ReduceData.map(Slice<T>(t_ReduceData.data + a_Begin, a_End - a_Begin), a_Scratch, t_ReduceData.userData);
+					t_ReduceData.partials[a_JobSlot] = t_ReduceData.combine(t_ReduceData.partials[a_JobSlot], t_Value);
+				},
+				[](const uint32_t a_JobSlotCount, void* a_Data)
+				{
+					ReduceData& t_ReduceData = *reinterpret_cast<ReduceData*>(a_Data);
+					R t_Result = t_ReduceData.identity;
+					for (uint32_t i = 0; i < a_JobSlotCount; i++)
+						t_Result = t_ReduceData.combine(t_Result, t_ReduceData.partials[i]);
+					*t_ReduceData.result = t_Result;
+				},
+				&t_Data, sizeof(t_Data));
+		}
+
+		template<typename T, typename R>
+		ThreadTask ParallelReduce(Array<T>& a_Array, const size_t a_GrainSize, const R a_Identity, PFN_ParallelReduceMap<T, R> a_Map, PFN_ParallelReduceCombine<R> a_Combine, R* a_Result, void* a_UserData)
+		{
+			return ParallelReduce(Slice<T>(a_Array), a_GrainSize, a_Identity, a_Map, a_Combine, a_Result, a_UserData);
+		}
+	}
+}
@@ -0,0 +1,174 @@
+#pragma once
+#include "Common.h"
+#include <atomic>
+
+//User space locks, uncontended they never leave user space unlike BBMutex.
+//They are not recursive, use BBMutex when a thread can lock the same lock again.
+//The functions use the std names so they work with std::lock_guard and std::shared_lock.
+
+namespace BB
+{
+	//How long a lock spins before the thread sleeps in the OS, long enough to cover a short critical section.
+	constexpr const uint32_t LOCK_SPIN_COUNT = 128;
+
+	//Optional, give one to a lock to see how often it is contended. Multiple locks can share one.
+	struct LockContention
+	{
+		std::atomic<uint64_t> acquires{ 0 };
+		//Acquires that found the lock taken.
+		std::atomic<uint64_t> contended{ 0 };
+		//Times a thread had to sleep in the OS, spinning was not enough.
+		std::atomic<uint64_t> sleeps{ 0 };
+	};
+
+	//Spins for a short while and then sleeps on the lock word.
+	class FutexMutex
+	{
+	public:
+		FutexMutex(LockContention* a_Contention = nullptr) : m_Contention(a_Contention) {};
+		//just delete these for safety, copies might cause errors.
+		FutexMutex(const FutexMutex&) = delete;
+		FutexMutex(const FutexMutex&&) = delete;
+		FutexMutex& operator =(const FutexMutex&) = delete;
+		FutexMutex& operator =(FutexMutex&&) = delete;
+
+		void lock()
+		{
+			if (m_Contention != nullptr)
+				m_Contention->acquires.fetch_add(1, std::memory_order_relaxed);
+			uint32_t t_State = UNLOCKED;
+			if (!m_State.compare_exchange_strong(t_State, LOCKED, std::memory_order_acquire, std::memory_order_relaxed))
+				LockSlow();
+		}
+		bool try_lock()
+		{
+			uint32_t t_State = UNLOCKED;
+			return m_State.compare_exchange_strong(t_State, LOCKED, std::memory_order_acquire, std::memory_order_relaxed);
+		}
+		void unlock()
+		{
+			//Only go to the OS when someone might be sleeping.
+			if (m_State.exchange(UNLOCKED, std::memory_order_release) == SLEEPERS)
+				WakeOne();
+		}
+
+	private:
+		enum : uint32_t
+		{
+			UNLOCKED = 0,
+			LOCKED = 1,
+			SLEEPERS = 2 //Locked and a thread might be sleeping on it.
+		};
+
+		void LockSlow();
+		void WakeOne();
+
+		std::atomic<uint32_t> m_State{ UNLOCKED };
+		LockContention* m_Contention;
+	};
+
+	//Many readers or one writer, for data that is read a lot and rarely written.
+	//A waiting writer stops new readers from getting in so writers cannot be starved.
+	class RWLock
+	{
+	public:
+		RWLock(LockContention* a_Contention = nullptr) : m_Contention(a_Contention) {};
+		//just delete these for safety, copies might cause errors.
+		RWLock(const RWLock&) = delete;
+		RWLock(const RWLock&&) = delete;
+		RWLock& operator =(const RWLock&) = delete;
+		RWLock& operator =(RWLock&&) = delete;
+
+		void lock_shared()
+		{
+			if (m_Contention != nullptr)
+				m_Contention->acquires.fetch_add(1, std::memory_order_relaxed);
+			uint32_t t_State = m_State.load(std::memory_order_relaxed);
+			if ((t_State & (WRITER | WRITER_WAITING)) != 0 ||
+				!m_State.compare_exchange_strong(t_State, t_State + 1, std::memory_order_acquire, std::memory_order_relaxed))
+				LockSharedSlow();
+		}
+		void unlock_shared()
+		{
+			const uint32_t t_State = m_State.fetch_sub(1, std::memory_order_seq_cst);
+			//The last reader lets a sleeping writer in.
+			if ((t_State & READER_MASK) == 1 && m_Sleepers.load(std::memory_order_seq_cst) != 0)
+				WakeAll();
+		}
+
+		void lock()
+		{
+			if (m_Contention != nullptr)
+				m_Contention->acquires.fetch_add(1, std::memory_order_relaxed);
+			uint32_t t_State = 0;
+			if (!m_State.compare_exchange_strong(t_State, WRITER, std::memory_order_acquire, std::memory_order_relaxed))
+				LockSlow();
+		}
+		void unlock()
+		{
+			m_State.fetch_and(~WRITER, std::memory_order_seq_cst);
+			if (m_Sleepers.load(std::memory_order_seq_cst) != 0)
+				WakeAll();
+		}
+
+	private:
+		enum : uint32_t
+		{
+			READER_MASK = 0x3FFFFFFF,
+			WRITER_WAITING = 1u << 30,
+			WRITER = 1u << 31
+		};
+
+		void LockSharedSlow();
+		void LockSlow();
+		void WakeAll();
+
+		std::atomic<uint32_t> m_State{ 0 };
+		std::atomic<uint32_t> m_Sleepers{ 0 };
+		LockContention* m_Contention;
+	};
+
+	//First come first served, threads get the lock in the order they asked for it.
+	//Fair but every unlock wakes all sleepers, so keep it for short sections with few threads.
+	class TicketLock
+	{
+	public:
+		TicketLock(LockContention* a_Contention = nullptr) : m_Contention(a_Contention) {};
+		//just delete these for safety, copies might cause errors.
+		TicketLock(const TicketLock&) = delete;
+		TicketLock(const TicketLock&&) = delete;
+		TicketLock& operator =(const TicketLock&) = delete;
+		TicketLock& operator =(TicketLock&&) = delete;
+
+		void lock()
+		{
+			if (m_Contention != nullptr)
+				m_Contention->acquires.fetch_add(1, std::memory_order_relaxed);
+			const uint32_t t_Ticket = m_NextTicket.fetch_add(1, std::memory_order_relaxed);
+			if (m_NowServing.load(std::memory_order_acquire) != t_Ticket)
+				LockSlow(t_Ticket);
+		}
+		bool try_lock()
+		{
+			const uint32_t t_Serving = m_NowServing.load(std::memory_order_relaxed);
+			uint32_t t_Ticket = t_Serving;
+			return m_NextTicket.compare_exchange_strong(t_Ticket, t_Serving + 1, std::memory_order_acquire, std::memory_order_relaxed);
+		}
+		void unlock()
+		{
+			m_NowServing.fetch_add(1, std::memory_order_seq_cst);
+			if (m_Sleepers.load(std::memory_order_seq_cst) != 0)
+				WakeAll();
+		}
+
+	private:
+		void LockSlow(const uint32_t a_Ticket);
+		void WakeAll();
+
+		//Seperate cache lines, new threads taking a ticket should not slow down the owner's unlock.
+		alignas(64) std::atomic<uint32_t> m_NextTicket{ 0 };
+		alignas(64) std::atomic<uint32_t> m_NowServing{ 0 };
+		std::atomic<uint32_t> m_Sleepers{ 0 };
+		LockContention* m_Contention;
+	};
+}
@@ -1,15 +1,35 @@
 #pragma once
 #include "Common.h"
+#include <atomic>
 
 namespace BB
 {
+	//Counts the amount of unfinished jobs that were started with it.
+	//Used to wait on a group of jobs, value is 0 when all of them are done.
+	struct JobCounter
+	{
+		std::atomic<uint32_t> value{ 0 };
+	};
+
 	namespace Threads
 	{
 		void InitThreads(const uint32_t a_ThreadCount);
 		void DestroyThreads();
-		ThreadTask StartTaskThread(void(*a_Function)(void*), void* a_FuncParameter);
+		//Jobs are never rejected, the queues grow when all workers are busy.
+		//a_Counter is optional and is incremented now and decremented when the job finishes.
+		ThreadTask StartTaskThread(void(*a_Function)(void*), void* a_FuncParameter, JobCounter* a_Counter = nullptr);
+		//Continuation, the job is only queued when all of a_Dependencies are finished.
+		//Already finished or empty handles in a_Dependencies are ignored.
+		ThreadTask StartTaskAfter(void(*a_Function)(void*), void* a_FuncParameter, const ThreadTask* a_Dependencies, const uint32_t a_DependencyCount, JobCounter* a_Counter = nullptr);
 
+		//All the wait functions run other queued jobs on the calling thread while waiting.
 		void WaitForTask(const ThreadTask a_Handle);
+		void WaitForTasks(const ThreadTask* a_Tasks, const uint32_t a_TaskCount);
+		//Returns the index into a_Tasks of a finished task.
+		uint32_t WaitForAnyTask(const ThreadTask* a_Tasks, const uint32_t a_TaskCount);
+		void WaitForCounter(const JobCounter& a_Counter);
 		bool TaskFinished(const ThreadTask a_Handle);
+
+		uint32_t GetThreadCount();
 	}
-}
\ No newline at end of file
+}
@@ -3,6 +3,8 @@
 #include "BBMemory.h"
 #include "Hashmap.h"
 #include "BBString.h"
+#include "StringID.h"
+#include "Slice.h"
 
 //tutorial/guide used: https://kishoreganesh.com/post/writing-a-json-parser-in-cplusplus/
 namespace BB
@@ -66,7 +68,10 @@ namespace BB
 	{
 		struct Pair
 		{
-			char* name;
+			//Invalid if the key could not be interned, the pair is then only in pairLL.
+			StringID name;
+			//Null terminated, not escape decoded.
+			const char* key;
 			JsonNode* node;
 			Pair* next = nullptr;
 		};
@@ -74,22 +79,35 @@ namespace BB
 		JsonObject(Allocator a_Allocator, const uint32_t a_MapSize, Pair* a_PairHead)
 			: map(a_Allocator, a_MapSize), pairLL(a_PairHead)
 		{};
-		OL_HashMap<char*, JsonNode*, String_KeyComp> map;
+		//Compares the key strings, also finds keys that could not be interned. nullptr if the key is not found.
+		JsonNode* Find(const char* a_Key) const;
+		//Find a key with "name"_sid or InternString.
+		SW_HashMap<StringID, JsonNode*> map;
 		Pair* pairLL;
 	};
 
-	struct JsonFile
+	//Stage 1 of the parser, the positions of every structural character ({}[]:,), string start and scalar start outside of strings.
+	//Made 64 bytes at a time with SIMD like simdjson, stage 2 only looks at these positions instead of every character.
+	struct JsonStructuralIndex
 	{
-		Buffer fileData{};
-		size_t pos = 0;
+		//Ends with the size of the json text as a sentinel, this is not in count.
+		uint32_t* positions = nullptr;
+		uint32_t count = 0;
 	};
 
+	/// <summary>
+	/// Find all the structural positions of a json text. Does not validate the json or UTF-8.
+	/// </summary>
+	/// <param name="a_Allocator:"> Allocates the positions array, up to a_Size + 1 uint32_t's. </param>
+	JsonStructuralIndex BuildJsonStructuralIndex(Allocator a_Allocator, const char* a_Data, const size_t a_Size);
+
 	void JsonNodeToString(const JsonNode* t_Node, String& a_String);
-	struct Token;
+
+	//Builds a full JsonNode tree, use JsonDocument to only read the values that you need.
 	class JsonParser
 	{
 	public:
-		//load from disk
+		//load from disk, the file is memory mapped while the parser lives.
 		JsonParser(const char* a_Path);
 		//load from memory
 		JsonParser(const Buffer& a_Buffer);
@@ -99,20 +117,176 @@ namespace BB
 
 		JsonNode* GetRootNode() { return m_RootNode; }
 
-		JsonNode* ParseObject();
-		JsonNode* ParseList();
-		JsonNode* ParseString(const Token& a_Token);
-		JsonNode* ParseNumber(const Token& a_Token);
-		JsonNode* ParseBoolean(const Token& a_Token);
-		JsonNode* ParseNull();
 	private:
-		
-		//jank
-		JsonNode* PraseSingleToken(const Token& a_Token);
+		JsonNode* ParseValue(uint32_t& a_Index);
+		JsonNode* ParseObject(uint32_t& a_Index);
+		JsonNode* ParseList(uint32_t& a_Index);
+		JsonNode* ParseString(uint32_t& a_Index);
+		JsonNode* ParseNumber(uint32_t& a_Index);
+		JsonNode* ParseBoolean(uint32_t& a_Index);
+		JsonNode* ParseNull(uint32_t& a_Index);
+
 		LinearAllocator_t m_Allocator;
-		JsonFile m_JsonFile;
+		Buffer m_JsonData;
+		bool m_Mapped = false;
+		JsonStructuralIndex m_Index;
 
 		JsonNode* m_RootNode = nullptr;
 	};
-}
 
+	class JsonDocument;
+
+	//A value inside a JsonDocument, nothing is parsed until you ask for it.
+	//Finding a field or element walks over the structural positions and skips nested objects and lists without looking at them.
+	class JsonValue
+	{
+	public:
+		JsonValue() = default;
+		JsonValue(const JsonDocument* a_Document, const uint32_t a_Index) : m_Document(a_Document), m_Index(a_Index) {};
+
+		//false if the value was not found.
+		bool IsValid() const { return m_Document != nullptr; }
+		JSON_TYPE GetType() const;
+
+		//Returns an invalid JsonValue if the object does not have the key.
+		JsonValue Find(const char* a_Key) const;
+		//The id is only 32 bits, if a_Key is interned the key string is compared too.
+		JsonValue Find(const StringID a_Key) const;
+		//Returns an invalid JsonValue if the index is out of range.
+		JsonValue GetElement(const uint32_t a_Index) const;
+		//Amount of elements in a list or fields in an object, 0 for an invalid value.
+		uint32_t GetCount() const;
+
+		//Points into the json text and is not null terminated, escape sequences are not decoded.
+		Slice<const char> GetString() const;
+		StringID GetStringID() const;
+		float GetNumber() const;
+		double GetDouble() const;
+		int64_t GetInteger() const;
+		bool GetBoolean() const;
+
+		//for (JsonValue t_Element : t_Value.GetList()), an invalid value gives an empty range.
+		class ListIterator
+		{
+		public:
+			ListIterator(const JsonDocument* a_Document, const uint32_t a_Index) : m_Document(a_Document), m_Index(a_Index) {};
+			JsonValue operator*() const { return JsonValue(m_Document, m_Index); }
+			ListIterator& operator++();
+			bool operator!=(const ListIterator& a_Rhs) const { return m_Index != a_Rhs.m_Index; }
+
+		private:
+			const JsonDocument* m_Document;
+			uint32_t m_Index;
+		};
+		struct ListRange
+		{
+			ListIterator first;
+			ListIterator last;
+			ListIterator begin() const { return first; }
+			ListIterator end() const { return last; }
+		};
+		ListRange GetList() const;
+
+		//Index of the structural position of this value.
+		uint32_t GetIndex() const { return m_Index; }
+
+	private:
+		const JsonDocument* m_Document = nullptr;
+		uint32_t m_Index = 0;
+	};
+
+	//On demand json, only the structural index is build when it's loaded.
+	class JsonDocument
+	{
+	public:
+		//load from disk, the file is memory mapped while the document lives.
+		JsonDocument(const char* a_Path);
+		//load from memory, the buffer must stay valid while the document is used.
+		JsonDocument(const Buffer& a_Buffer);
+		~JsonDocument();
+
+		//just delete these for safety, copies might cause errors.
+		JsonDocument(const JsonDocument&) = delete;
+		JsonDocument(const JsonDocument&&) = delete;
+		JsonDocument& operator =(const JsonDocument&) = delete;
+		JsonDocument& operator =(JsonDocument&&) = delete;
+
+		JsonValue GetRoot() const;
+
+		const char* GetData() const { return m_JsonData.data; }
+		size_t GetSize() const { return m_JsonData.size; }
+		const JsonStructuralIndex& GetStructuralIndex() const { return m_Index; }
+
+	private:
+		LinearAllocator_t m_Allocator;
+		Buffer m_JsonData;
+		bool m_Mapped = false;
+		JsonStructuralIndex m_Index;
+	};
+
+	//Events send by JsonSaxParser, leave a function nullptr to ignore that event.
+	//Return false from an event to stop parsing, Parse will then return false.
+	//Keys and strings point into the chunk buffer, they are not null terminated and are only valid during the event.
+	struct JsonSaxHandler
+	{
+		void* userData = nullptr;
+		bool (*beginObject)(void* a_UserData) = nullptr;
+		bool (*endObject)(void* a_UserData) = nullptr;
+		bool (*beginList)(void* a_UserData) = nullptr;
+		bool (*endList)(void* a_UserData) = nullptr;
+		bool (*key)(void* a_UserData, const Slice<const char> a_Key) = nullptr;
+		bool (*string)(void* a_UserData, const Slice<const char> a_String) = nullptr;
+		bool (*number)(void* a_UserData, const double a_Number) = nullptr;
+		bool (*boolean)(void* a_UserData, const bool a_Boolean) = nullptr;
+		bool (*null)(void* a_UserData) = nullptr;
+	};
+
+	constexpr const size_t JSON_SAX_DEFAULT_CHUNK_SIZE = kbSize * 64;
+	constexpr const uint32_t JSON_SAX_MAX_DEPTH = 256;
+
+	//Streaming json, reads a file in chunks into one fixed size buffer and sends events while it goes.
+	//Memory use does not grow with the file, but a single string or number must fit in the chunk buffer.
+	class JsonSaxParser
+	{
+	public:
+		//The chunk buffer is allocated once and freed with a_Allocator.
+		JsonSaxParser(Allocator a_Allocator, const size_t a_ChunkSize = JSON_SAX_DEFAULT_CHUNK_SIZE);
+		~JsonSaxParser();
+
+		//just delete these for safety, copies might cause errors.
+		JsonSaxParser(const JsonSaxParser&) = delete;
+		JsonSaxParser(const JsonSaxParser&&) = delete;
+		JsonSaxParser& operator =(const JsonSaxParser&) = delete;
+		JsonSaxParser& operator =(JsonSaxParser&&) = delete;
+
+		//Returns false if the json is invalid, a token does not fit in the chunk buffer or an event stopped the parse.
+		bool Parse(const char* a_Path, const JsonSaxHandler& a_Handler);
+		//Parses the buffer in place, the chunk buffer is not used.
+		bool Parse(const Buffer& a_Buffer, const JsonSaxHandler& a_Handler);
+
+	private:
+		bool Run(const JsonSaxHandler& a_Handler);
+		//Moves the unread bytes to the front of the chunk and reads the file behind them.
+		bool Refill();
+		//false at the end of the text.
+		bool SkipWhitespace();
+		//Makes sure a_Count bytes can be read from m_Position.
+		bool Ensure(const size_t a_Count);
+		//a_Length is relative to m_Position.
+		bool ScanString(size_t& a_Length);
+		bool ScanNumber(size_t& a_Length);
+
+		Allocator m_Allocator;
+		char* m_Chunk;
+		size_t m_ChunkSize;
+
+		OSFileHandle m_File{};
+		const char* m_Data = nullptr;
+		size_t m_Position = 0;
+		size_t m_End = 0;
+		bool m_EndOfFile = true;
+
+		uint32_t m_Depth = 0;
+		bool m_InObject[JSON_SAX_MAX_DEPTH];
+	};
+}
@@ -1,8 +1,129 @@
 #pragma once
 #include "Common.h"
+#include <cmath>
+
+//Every x64 CPU has SSE2 and every ARM64 CPU has NEON, so the float4 and Mat4x4 math always uses them.
+//The batched functions at the bottom also use AVX2 when the CPU has it.
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#define BB_SIMD_SSE
+#include <emmintrin.h>
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define BB_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(BB_SIMD_SSE) || defined(BB_SIMD_NEON)
+#define BB_SIMD
+#endif
 
 namespace BB
 {
+#ifdef BB_SIMD
+	//Thin layer over SSE and NEON so the math below is only written once.
+	//Only the instructions that give the exact same result as the scalar math are used, no FMA or approximations.
+	namespace SIMD
+	{
+#ifdef BB_SIMD_SSE
+		using Vec4 = __m128;
+
+		static inline Vec4 Load(const float* a_Floats) { return _mm_loadu_ps(a_Floats); }
+		static inline void Store(float* a_Floats, const Vec4 a_Vec) { _mm_storeu_ps(a_Floats, a_Vec); }
+		static inline Vec4 Set(const float a_X, const float a_Y, const float a_Z, const float a_W) { return _mm_setr_ps(a_X, a_Y, a_Z, a_W); }
+		static inline Vec4 Set1(const float a_Float) { return _mm_set1_ps(a_Float); }
+
+		static inline Vec4 Add(const Vec4 a_Lhs, const Vec4 a_Rhs) { return _mm_add_ps(a_Lhs, a_Rhs); }
+		static inline Vec4 Sub(const Vec4 a_Lhs, const Vec4 a_Rhs) { return _mm_sub_ps(a_Lhs, a_Rhs); }
+		static inline Vec4 Mul(const Vec4 a_Lhs, const Vec4 a_Rhs) { return _mm_mul_ps(a_Lhs, a_Rhs); }
+		static inline Vec4 Div(const Vec4 a_Lhs, const Vec4 a_Rhs) { return _mm_div_ps(a_Lhs, a_Rhs); }
+
+		template<int Lane>
+		static inline Vec4 Splat(const Vec4 a_Vec) { return _mm_shuffle_ps(a_Vec, a_Vec, _MM_SHUFFLE(Lane, Lane, Lane, Lane)); }
+		//xyzw -> yzxw, w is not used by anything that calls it.
+		static inline Vec4 ShuffleYZX(const Vec4 a_Vec) { return _mm_shuffle_ps(a_Vec, a_Vec, _MM_SHUFFLE(3, 0, 2, 1)); }
+		static inline void Transpose(Vec4& a_R0, Vec4& a_R1, Vec4& a_R2, Vec4& a_R3) { _MM_TRANSPOSE4_PS(a_R0, a_R1, a_R2, a_R3); }
+		//a_Vec with its w replaced by lane Lane of a_Source.
+		template<int Lane>
+		static inline Vec4 CopyToW(const Vec4 a_Vec, const Vec4 a_Source)
+		{
+			const Vec4 t_ZW = _mm_shuffle_ps(a_Vec, a_Source, _MM_SHUFFLE(Lane, Lane, 2, 2));
+			return _mm_shuffle_ps(a_Vec, t_ZW, _MM_SHUFFLE(2, 0, 1, 0));
+		}
+		//x + y + z of both, in lane 0 and 1.
+		static inline Vec4 Sum3Pair(const Vec4 a_P, const Vec4 a_Q)
+		{
+			const Vec4 t_Low = _mm_unpacklo_ps(a_P, a_Q);
+			return _mm_add_ps(_mm_add_ps(t_Low, _mm_movehl_ps(t_Low, t_Low)), _mm_unpackhi_ps(a_P, a_Q));
+		}
+#elif defined(BB_SIMD_NEON)
+		using Vec4 = float32x4_t;
+
+		static inline Vec4 Load(const float* a_Floats) { return vld1q_f32(a_Floats); }
+		static inline void Store(float* a_Floats, const Vec4 a_Vec) { vst1q_f32(a_Floats, a_Vec); }
+		static inline Vec4 Set(const float a_X, const float a_Y, const float a_Z, const float a_W)
+		{
+			const float t_Floats[4]{ a_X, a_Y, a_Z, a_W };
+			return vld1q_f32(t_Floats);
+		}
+		static inline Vec4 Set1(const float a_Float) { return vdupq_n_f32(a_Float); }
+
+		static inline Vec4 Add(const Vec4 a_Lhs, const Vec4 a_Rhs) { return vaddq_f32(a_Lhs, a_Rhs); }
+		static inline Vec4 Sub(const Vec4 a_Lhs, const Vec4 a_Rhs) { return vsubq_f32(a_Lhs, a_Rhs); }
+		static inline Vec4 Mul(const Vec4 a_Lhs, const Vec4 a_Rhs) { return vmulq_f32(a_Lhs, a_Rhs); }
+		static inline Vec4 Div(const Vec4 a_Lhs, const Vec4 a_Rhs) { return vdivq_f32(a_Lhs, a_Rhs); }
+
+		template<int Lane>
+		static inline Vec4 Splat(const Vec4 a_Vec) { return vdupq_laneq_f32(a_Vec, Lane); }
+		//xyzw -> yzxx, w is not used by anything that calls it.
+		static inline Vec4 ShuffleYZX(const Vec4 a_Vec) { return vcopyq_laneq_f32(vextq_f32(a_Vec, a_Vec, 1), 2, a_Vec, 0); }
+		static inline void Transpose(Vec4& a_R0, Vec4& a_R1, Vec4& a_R2, Vec4& a_R3)
+		{
+			const Vec4 t_02Low = vzip1q_f32(a_R0, a_R2);
+			const Vec4 t_02High = vzip2q_f32(a_R0, a_R2);
+			const Vec4 t_13Low = vzip1q_f32(a_R1, a_R3);
+			const Vec4 t_13High = vzip2q_f32(a_R1, a_R3);
+			a_R0 = vzip1q_f32(t_02Low, t_13Low);
+			a_R1 = vzip2q_f32(t_02Low, t_13Low);
+			a_R2 = vzip1q_f32(t_02High, t_13High);
+			a_R3 = vzip2q_f32(t_02High, t_13High);
+		}
+		//a_Vec with its w replaced by lane Lane of a_Source.
+		template<int Lane>
+		static inline Vec4 CopyToW(const Vec4 a_Vec, const Vec4 a_Source) { return vcopyq_laneq_f32(a_Vec, 3, a_Source, Lane); }
+		//x + y + z of both, in lane 0 and 1.
+		static inline Vec4 Sum3Pair(const Vec4 a_P, const Vec4 a_Q)
+		{
+			const Vec4 t_Low = vzip1q_f32(a_P, a_Q);
+			const float32x2_t t_High = vget_high_f32(t_Low);
+			return vaddq_f32(vaddq_f32(t_Low, vcombine_f32(t_High, t_High)), vzip2q_f32(a_P, a_Q));
+		}
+#endif //BB_SIMD_SSE
+
+		static inline Vec4 Load(const float4 a_Float4) { return Load(a_Float4.e); }
+		static inline float4 ToFloat4(const Vec4 a_Vec)
+		{
+			float4 t_Float4;
+			Store(t_Float4.e, a_Vec);
+			return t_Float4;
+		}
+
+		//Same multiplies and subtracts as Float3Cross, only xyz are valid.
+		static inline Vec4 Cross3(const Vec4 a_A, const Vec4 a_B)
+		{
+			return ShuffleYZX(Sub(Mul(a_A, ShuffleYZX(a_B)), Mul(ShuffleYZX(a_A), a_B)));
+		}
+
+		//One row of a Mat4x4 multiply, the adds are in the same order as the scalar version.
+		static inline Vec4 Mat4x4Row(const Vec4 a_L0, const Vec4 a_L1, const Vec4 a_L2, const Vec4 a_L3, const Vec4 a_RhsRow)
+		{
+			return Add(Add(Add(
+				Mul(a_L0, Splat<0>(a_RhsRow)),
+				Mul(a_L1, Splat<1>(a_RhsRow))),
+				Mul(a_L2, Splat<2>(a_RhsRow))),
+				Mul(a_L3, Splat<3>(a_RhsRow)));
+		}
+	}
+#endif //BB_SIMD
+
 	static inline float ToRadians(const float degrees)
 	{
 		return degrees * 0.01745329252f;
@@ -149,27 +270,47 @@ namespace BB
 
 	static inline float4 operator+(const float4 a_Lhs, const float4 a_Rhs)
 	{
+#ifdef BB_SIMD
+		return SIMD::ToFloat4(SIMD::Add(SIMD::Load(a_Lhs), SIMD::Load(a_Rhs)));
+#else
 		return float4{ a_Lhs.x + a_Rhs.x, a_Lhs.y + a_Rhs.y, a_Lhs.z + a_Rhs.z, a_Lhs.w + a_Rhs.w };
+#endif //BB_SIMD
 	}
 
 	static inline float4 operator-(const float4 a_Lhs, const float4 a_Rhs)
 	{
+#ifdef BB_SIMD
+		return SIMD::ToFloat4(SIMD::Sub(SIMD::Load(a_Lhs), SIMD::Load(a_Rhs)));
+#else
 		return float4{ a_Lhs.x - a_Rhs.x, a_Lhs.y - a_Rhs.y, a_Lhs.z - a_Rhs.z, a_Lhs.w - a_Rhs.w };
+#endif //BB_SIMD
 	}
 
 	static inline float4 operator*(const float4 a_Lhs, const float a_Float)
 	{
+#ifdef BB_SIMD
+		return SIMD::ToFloat4(SIMD::Mul(SIMD::Load(a_Lhs), SIMD::Set1(a_Float)));
+#else
 		return float4{ a_Lhs.x * a_Float, a_Lhs.y * a_Float, a_Lhs.z * a_Float, a_Lhs.w * a_Float };
+#endif //BB_SIMD
 	}
 
 	static inline float4 operator*(const float4 a_Lhs, const float4 a_Rhs)
 	{
+#ifdef BB_SIMD
+		return SIMD::ToFloat4(SIMD::Mul(SIMD::Load(a_Lhs), SIMD::Load(a_Rhs)));
+#else
 		return float4{ a_Lhs.x * a_Rhs.x, a_Lhs.y * a_Rhs.y, a_Lhs.z * a_Rhs.z, a_Lhs.w * a_Rhs.w };
+#endif //BB_SIMD
 	}
 
 	static inline float4 operator/(const float4 a_Lhs, const float4 a_Rhs)
 	{
+#ifdef BB_SIMD
+		return SIMD::ToFloat4(SIMD::Div(SIMD::Load(a_Lhs), SIMD::Load(a_Rhs)));
+#else
 		return float4{ a_Lhs.x / a_Rhs.x, a_Lhs.y / a_Rhs.y, a_Lhs.z / a_Rhs.z, a_Lhs.w / a_Rhs.w };
+#endif //BB_SIMD
 	}
 
 	static inline float Float4Dot(const float4 a, const float4 b)
@@ -225,10 +366,21 @@ namespace BB
 	static inline Mat4x4 operator*(const Mat4x4 a_Lhs, const Mat4x4 a_Rhs)
 	{
 		Mat4x4 mat;
+#ifdef BB_SIMD
+		const SIMD::Vec4 t_L0 = SIMD::Load(a_Lhs.r0);
+		const SIMD::Vec4 t_L1 = SIMD::Load(a_Lhs.r1);
+		const SIMD::Vec4 t_L2 = SIMD::Load(a_Lhs.r2);
+		const SIMD::Vec4 t_L3 = SIMD::Load(a_Lhs.r3);
+		SIMD::Store(mat.r0.e, SIMD::Mat4x4Row(t_L0, t_L1, t_L2, t_L3, SIMD::Load(a_Rhs.r0)));
+		SIMD::Store(mat.r1.e, SIMD::Mat4x4Row(t_L0, t_L1, t_L2, t_L3, SIMD::Load(a_Rhs.r1)));
+		SIMD::Store(mat.r2.e, SIMD::Mat4x4Row(t_L0, t_L1, t_L2, t_L3, SIMD::Load(a_Rhs.r2)));
+		SIMD::Store(mat.r3.e, SIMD::Mat4x4Row(t_L0, t_L1, t_L2, t_L3, SIMD::Load(a_Rhs.r3)));
+#else
 		mat.r0 = a_Lhs.r0 * a_Rhs.r0.x + a_Lhs.r1 * a_Rhs.r0.y + a_Lhs.r2 * a_Rhs.r0.z + a_Lhs.r3 * a_Rhs.r0.w;
 		mat.r1 = a_Lhs.r0 * a_Rhs.r1.x + a_Lhs.r1 * a_Rhs.r1.y + a_Lhs.r2 * a_Rhs.r1.z + a_Lhs.r3 * a_Rhs.r1.w;
 		mat.r2 = a_Lhs.r0 * a_Rhs.r2.x + a_Lhs.r1 * a_Rhs.r2.y + a_Lhs.r2 * a_Rhs.r2.z + a_Lhs.r3 * a_Rhs.r2.w;
 		mat.r3 = a_Lhs.r0 * a_Rhs.r3.x + a_Lhs.r1 * a_Rhs.r3.y + a_Lhs.r2 * a_Rhs.r3.z + a_Lhs.r3 * a_Rhs.r3.w;
+#endif //BB_SIMD
 		return mat;
 	}
 
@@ -290,6 +442,12 @@ namespace BB
 		return mat;
 	}
 
+	//Translation * Rotation * Scale, the matrix of a Transform.
+	static inline Mat4x4 Mat4x4FromTRS(const float3 a_Position, const Quat a_Rotation, const float3 a_Scale)
+	{
+		return Mat4x4Scale(Mat4x4FromTranslation(a_Position) * Mat4x4FromQuat(a_Rotation), a_Scale);
+	}
+
 	static Mat4x4 Mat4x4Perspective(const float fov, const float aspect, const float nearField, const float farField)
 	{
 		const float tanHalfFov = tan(fov / 2.f);
@@ -327,6 +485,56 @@ namespace BB
 
 	static inline Mat4x4 Mat4x4Inverse(const Mat4x4 m)
 	{
+#ifdef BB_SIMD
+		//The scalar version below in SIMD, every step does the same float operations in the same order.
+		using namespace SIMD;
+		//Transposed the xyz of the rows are a, b, c and d from the scalar version, the w's are x, y, z and w.
+		Vec4 a = Load(m.r0);
+		Vec4 b = Load(m.r1);
+		Vec4 c = Load(m.r2);
+		Vec4 d = Load(m.r3);
+		Transpose(a, b, c, d);
+
+		const Vec4 x = Splat<3>(a);
+		const Vec4 y = Splat<3>(b);
+		const Vec4 z = Splat<3>(c);
+		const Vec4 w = Splat<3>(d);
+
+		Vec4 s = Cross3(a, b);
+		Vec4 t = Cross3(c, d);
+
+		Vec4 u = Sub(Mul(a, y), Mul(b, x));
+		Vec4 v = Sub(Mul(c, w), Mul(d, z));
+
+		//Both dot products at once, the sums go x + y + z like Float3Dot.
+		const Vec4 t_Dots = Sum3Pair(Mul(s, v), Mul(t, u));
+
+		const Vec4 inv_det = Div(Set1(1.0f), Add(Splat<0>(t_Dots), Splat<1>(t_Dots)));
+		s = Mul(s, inv_det);
+		t = Mul(t, inv_det);
+		u = Mul(u, inv_det);
+		v = Mul(v, inv_det);
+
+		const Vec4 r0 = Add(Cross3(b, v), Mul(t, y));
+		const Vec4 r1 = Sub(Cross3(v, a), Mul(t, x));
+		const Vec4 r2 = Add(Cross3(d, u), Mul(s, w));
+		const Vec4 r3 = Sub(Cross3(u, c), Mul(s, z));
+
+		//The last column, -Float3Dot(b, t), Float3Dot(a, t), -Float3Dot(d, s), Float3Dot(c, s).
+		Vec4 t_BT = Mul(b, t);
+		Vec4 t_AT = Mul(a, t);
+		Vec4 t_DS = Mul(d, s);
+		Vec4 t_CS = Mul(c, s);
+		Transpose(t_BT, t_AT, t_DS, t_CS);
+		const Vec4 t_LastColumn = Mul(Add(Add(t_BT, t_AT), t_DS), Set(-1.f, 1.f, -1.f, 1.f));
+
+		Mat4x4 mat;
+		Store(mat.r0.e, CopyToW<0>(r0, t_LastColumn));
+		Store(mat.r1.e, CopyToW<1>(r1, t_LastColumn));
+		Store(mat.r2.e, CopyToW<2>(r2, t_LastColumn));
+		Store(mat.r3.e, CopyToW<3>(r3, t_LastColumn));
+		return mat;
+#else
 		const float3 a = float3{ m.e[0][0], m.e[1][0], m.e[2][0] };
 		const float3 b = float3{ m.e[0][1], m.e[1][1], m.e[2][1] };
 		const float3 c = float3{ m.e[0][2], m.e[1][2], m.e[2][2] };
@@ -359,6 +567,7 @@ namespace BB
 			r1.x, r1.y, r1.z, Float3Dot(a, t),
 			r2.x, r2.y, r2.z, -Float3Dot(d, s),
 			r3.x, r3.y, r3.z, Float3Dot(c, s));
+#endif //BB_SIMD
 	}
 
 	// MAT4x4
@@ -367,7 +576,9 @@ namespace BB
 
 	static inline Quat operator*(const Quat a_Lhs, const Quat a_Rhs)
 	{
-		return Quat{ a_Lhs.x * a_Rhs.x, a_Lhs.y * a_Rhs.y, a_Lhs.z * a_Rhs.z, a_Lhs.w * a_Rhs.w };
+		Quat quat;
+		quat.xyzw = a_Lhs.xyzw * a_Rhs.xyzw;
+		return quat;
 	}
 
 	static inline Quat IdentityQuat()
@@ -390,10 +601,24 @@ namespace BB
 	static inline Quat QuatRotateQuat(const Quat a, const Quat b)
 	{
 		Quat quat;
-		quat.x = a.x * b.x;
-		quat.y = a.y * b.y;
-		quat.z = a.z * b.z;
-		quat.w = a.w * b.w;
+		quat.xyzw = a.xyzw * b.xyzw;
 		return quat;
 	}
+
+	// QUAT
+	//--------------------------------------------------------
+	// BATCHED
+
+	//a_Out[i] = a_Lhs[i] * a_Rhs[i], two rows at a time with AVX2. a_Out may be a_Lhs or a_Rhs.
+	void Mat4x4MultiplyBatch(Mat4x4* a_Out, const Mat4x4* a_Lhs, const Mat4x4* a_Rhs, const size_t a_Count);
+	//a_Out[i] = Mat4x4Inverse(a_Matrices[i]), 4 or 8 matrices at a time with a float of each matrix in every lane.
+	//The result is the same as calling Mat4x4Inverse on every matrix. a_Out may be a_Matrices.
+	void Mat4x4InverseBatch(Mat4x4* a_Out, const Mat4x4* a_Matrices, const size_t a_Count);
+	//Mat4x4FromTRS and its inverse for every transform in a_Indices, 4 at a time from the seperate position, rotation and scale streams.
+	//The inverse is build from the parts instead of Mat4x4Inverse, a scale of 0 gives infinities.
+	//The matrix of transform i goes to a_Matrices + i * a_Stride bytes and its inverse to a_Inverses + i * a_Stride bytes.
+	//a_Stream writes with non-temporal stores for mapped GPU memory, the outputs then need to be 16 byte aligned.
+	void Mat4x4FromTRSBatch(Mat4x4* a_Matrices, Mat4x4* a_Inverses, const size_t a_Stride,
+		const float3* a_Positions, const Quat* a_Rotations, const float3* a_Scales,
+		const uint32_t* a_Indices, const size_t a_Count, const bool a_Stream);
 }
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include <cstdint>
 #include "Common.h"
 #include "BBMemory.h"
+#include "Allocators/BackingAllocator.h"
 #include "BBString.h"
 
 namespace BB
@@ -41,6 +42,14 @@ namespace BB
 #endif
 	};
 
+	//How a mapped file is going to be read, the OS uses it to decide how far to read ahead.
+	enum class OS_FILE_ACCESS_HINT : uint32_t
+	{
+		NORMAL,
+		SEQUENTIAL, //Read front to back once, the OS starts reading ahead right away.
+		RANDOM //Jumps around in the file, the OS does not read ahead.
+	};
+
 	//Hide this in the future so that users cannot access it.
 	void InitProgram();
 
@@ -50,9 +59,15 @@ namespace BB
 	//TODO: Get the linux variant of this.
 	const size_t VirtualMemoryMinimumAllocation();
 
-	void* ReserveVirtualMemory(const size_t a_Size);
+	//Size of a huge page, 0 if huge pages are not supported for reserved memory.
+	const size_t VirtualMemoryHugePageSize();
+
+	//With huge pages a_Size and all commits must be a multiple of VirtualMemoryHugePageSize.
+	//Explicit huge pages take the entire reservation from the OS huge page pool.
+	void* ReserveVirtualMemory(const size_t a_Size, const VIRTUAL_PAGE_TYPE a_PageType = VIRTUAL_PAGE_TYPE::NORMAL, const uint32_t a_NumaNode = VIRTUAL_NUMA_NODE_ANY);
 	bool CommitVirtualMemory(void* a_Ptr, const size_t a_Size);
-	bool ReleaseVirtualMemory(void* a_Ptr);
+	//a_Size must be the size given to ReserveVirtualMemory.
+	bool ReleaseVirtualMemory(void* a_Ptr, const size_t a_Size);
 
 	//Prints the latest OS error and returns the error code, if it has no error code it returns 0.
 	const uint32_t LatestOSError();
@@ -86,14 +101,30 @@ namespace BB
 	//Buffer.data will have a dynamic allocation from the given allocator.
 	Buffer ReadOSFile(Allocator a_SysAllocator, const char* a_Path);
 	Buffer ReadOSFile(Allocator a_SysAllocator, const wchar* a_Path);
+	//Reads up to a_Size bytes from the current file position into a_Data and moves the position forward.
+	//Returns the amount of bytes read, 0 at the end of the file or on failure.
+	uint64_t ReadFromOSFile(const OSFileHandle a_FileHandle, void* a_Data, const uint64_t a_Size);
+	//Reads up to a_Size bytes at a_Offset, blocks until it is done. Safe to call from multiple threads on the same file.
+	//a_BytesRead is less then a_Size at the end of the file. Returns false on failure.
+	//On Windows the file position is changed, on Linux it is not.
+	bool ReadOSFileAt(const OSFileHandle a_FileHandle, void* a_Data, const uint64_t a_Size, const uint64_t a_Offset, uint64_t& a_BytesRead);
+	//Maps a whole file as a read-only view, nothing is allocated or copied. Writing to Buffer.data will crash.
+	//Buffer.data is nullptr if the file does not exist or is empty. Release the view with UnmapOSFile.
+	Buffer MapOSFile(const char* a_Path, const OS_FILE_ACCESS_HINT a_Hint = OS_FILE_ACCESS_HINT::NORMAL);
+	Buffer MapOSFile(const wchar* a_Path, const OS_FILE_ACCESS_HINT a_Hint = OS_FILE_ACCESS_HINT::NORMAL);
+	void UnmapOSFile(const Buffer& a_Mapping);
 	//Get a file's size in bytes.
 	uint64_t GetOSFileSize(const OSFileHandle a_FileHandle);
 	//Set the file position, a_Offset can be 0 if you just want to move it to BEGIN or END.
-	void SetOSFilePosition(const OSFileHandle a_FileHandle, const uint32_t a_Offset, const OS_FILE_READ_POINT a_FileReadPoint);
+	void SetOSFilePosition(const OSFileHandle a_FileHandle, const int64_t a_Offset, const OS_FILE_READ_POINT a_FileReadPoint);
 
 	void CloseOSFile(const OSFileHandle a_FileHandle);
 
-	OSThreadHandle OSCreateThread(void(*a_Func)(void*), const unsigned int a_StackSize, void* a_ArgList);
+	//Pin a thread to a single core, use OS_THREAD_ANY_CORE to let the OS pick.
+	constexpr uint32_t OS_THREAD_ANY_CORE = UINT32_MAX;
+	//a_CoreIndex is a hint, if the core cannot be used the thread runs on any core.
+	OSThreadHandle OSCreateThread(void(*a_Func)(void*), const unsigned int a_StackSize, void* a_ArgList, const uint32_t a_CoreIndex = OS_THREAD_ANY_CORE);
+	//Waits until the thread returns and releases it, every created thread must be waited on once.
 	void OSWaitThreadfinish(const OSThreadHandle a_Thread);
 
 	BBMutex OSCreateMutex();
@@ -101,6 +132,14 @@ namespace BB
 	void OSUnlockMutex(const BBMutex a_Mutex);
 	void DestroyMutex(const BBMutex a_Mutex);
 
+	//Sleeps while the 32 bit value at a_Address is a_Expected, a futex on Linux and WaitOnAddress on Windows.
+	//Can return without a wake, always check the value again after waking up.
+	void OSWaitOnAddress(const volatile void* a_Address, const uint32_t a_Expected);
+	//Wakes a thread (or all threads) sleeping in OSWaitOnAddress on a_Address.
+	void OSWakeOneOnAddress(const volatile void* a_Address);
+	void OSWakeAllOnAddress(const volatile void* a_Address);
+
+	//Returns a handle of 0 if the window could not be made, on Linux also when there is no X server.
 	WindowHandle CreateOSWindow(const OS_WINDOW_STYLE a_Style, const int a_X, const int a_Y, const int a_Width, const int a_Height, const wchar* a_WindowName);
 	//Get the OS window handle (hwnd for windows as en example. Reinterpret_cast the void* to the hwnd).
 	void* GetOSWindowHandle(const WindowHandle a_Handle);
@@ -117,7 +156,7 @@ namespace BB
 	//Exits the application.
 	void ExitApp();
 
-	//Process the OS (or window) messages
+	//Process the OS (or window) messages, false on Linux when there is no X server.
 	bool ProcessMessages(const WindowHandle a_WindowHandle);
 
 	//Get the program name.
@@ -0,0 +1,97 @@
+#pragma once
+#include "Common.h"
+#include "BBMemory.h"
+#include "Slice.h"
+
+namespace BB
+{
+	constexpr const uint32_t SCENE_FILE_MAGIC = 0x53424242; //"BBBS"
+	constexpr const uint32_t SCENE_FILE_VERSION = 1;
+	//Every section starts at this alignment so the arrays can be used in place.
+	constexpr const uint32_t SCENE_FILE_SECTION_ALIGNMENT = 16;
+	//Offset into the string table for a model without a path.
+	constexpr const uint32_t SCENE_FILE_NO_STRING = UINT32_MAX;
+
+	//offset is relative to the start of the file.
+	struct SceneFileSection
+	{
+		uint32_t offset;
+		uint32_t count;
+	};
+
+	//File order: header, lights, transforms, models, string table.
+	//String offsets are relative to the start of the string table, every string is null terminated.
+	struct SceneFileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t fileSize;
+		uint32_t sceneName;
+		SceneFileSection lights;
+		SceneFileSection transforms;
+		SceneFileSection models;
+		//count is the size of the string table in bytes.
+		SceneFileSection strings;
+	};
+
+	//Same layout as Light in the renderer, SceneGraph uses the array without converting it.
+	struct SceneFileLight
+	{
+		float3 pos;
+		float radius;
+		float4 color;
+	};
+
+	struct SceneFileTransform
+	{
+		float3 position;
+		//quaternion, xyz is the axis part.
+		float4 rotation;
+		float3 scale;
+	};
+
+	struct SceneFileModel
+	{
+		uint32_t path;
+		//Index into the transform array.
+		uint32_t transform;
+	};
+
+	//A scene file used in place, the getters point into the file memory so nothing gets parsed.
+	class SceneFile
+	{
+	public:
+		//load from disk, the file is memory mapped and unmapped when the scene file is destroyed.
+		SceneFile(const char* a_Path);
+		//load from memory, the buffer must stay valid while the scene file is used and be aligned to SCENE_FILE_SECTION_ALIGNMENT.
+		SceneFile(const Buffer& a_Buffer);
+		~SceneFile();
+
+		//just delete these for safety, copies might cause errors.
+		SceneFile(const SceneFile&) = delete;
+		SceneFile(const SceneFile&&) = delete;
+		SceneFile& operator =(const SceneFile&) = delete;
+		SceneFile& operator =(SceneFile&&) = delete;
+
+		//false if the file is missing, not aligned, has the wrong version or a section is out of bounds.
+		bool IsValid() const { return m_Header != nullptr; }
+
+		const char* GetSceneName() const;
+		Slice<const SceneFileLight> GetLights() const;
+		Slice<const SceneFileTransform> GetTransforms() const;
+		Slice<const SceneFileModel> GetModels() const;
+		//Returns nullptr if the offset is outside the string table.
+		const char* GetString(const uint32_t a_Offset) const;
+
+	private:
+		void Validate();
+
+		Buffer m_Data{};
+		const SceneFileHeader* m_Header = nullptr;
+		bool m_Mapped = false;
+	};
+
+	//Converts a scene json like Resources/Json/test_scene.json to a scene file.
+	//The returned buffer is allocated with a_Allocator and aligned to SCENE_FILE_SECTION_ALIGNMENT, size is 0 if the json has no scene object.
+	Buffer ConvertJsonToSceneFile(Allocator a_Allocator, const Buffer& a_Json);
+}
@@ -0,0 +1,333 @@
+#pragma once
+#include "Utils/Logger.h"
+#include "BBMemory.h"
+#include "BBSync.hpp"
+#include "BBParallel.hpp"
+
+#include "Common.h"
+
+#include <atomic>
+
+namespace BB
+{
+	namespace HandleRegistry_Specs
+	{
+		//Slots per page, a page is allocated when every slot before it is in use.
+		constexpr const uint32_t pageSize = 256;
+	}
+
+	//index is the slot, extraIndex the generation of the slot when it was inserted.
+	using RegistryHandle = FrameworkHandle<struct RegistryHandleTag>;
+
+	/// <summary>
+	/// Slotmap successor that never moves an object, objects live in pages that are allocated once and only freed by the destructor.
+	/// A pointer to an object stays valid until that object is erased, also while other objects are inserted.
+	/// insert, emplace, erase and clear take a lock, find, valid and operator[] never lock so any thread can read while one inserts.
+	/// Every slot has a generation that is odd while the slot is in use, a handle is only valid if it has the current generation.
+	/// Live objects are also tracked in a dense list, iteration goes over that list and erase swaps with the last entry.
+	/// Iterating or reading an object while it is erased is not safe.
+	/// </summary>
+	template<typename T>
+	class HandleRegistry
+	{
+		static constexpr bool trivialDestructible_T = std::is_trivially_destructible_v<T>;
+		static constexpr uint32_t PAGE_SIZE = HandleRegistry_Specs::pageSize;
+
+		struct Page
+		{
+			alignas(T) unsigned char objects[sizeof(T) * PAGE_SIZE];
+			std::atomic<uint32_t> generations[PAGE_SIZE];
+			//The dense index of the slot, or the next free slot when the slot is not in use.
+			uint32_t denseIndex[PAGE_SIZE];
+			//Dense list part of this page, dense index i is in page i / PAGE_SIZE.
+			uint32_t denseSlots[PAGE_SIZE];
+		};
+
+	public:
+		struct Iterator
+		{
+			Iterator(const HandleRegistry<T>* a_Registry, const uint32_t a_DenseIndex) : m_Registry(a_Registry), m_DenseIndex(a_DenseIndex) {}
+
+			T& operator*() const { return m_Registry->GetDenseObject(m_DenseIndex); }
+			T* operator->() const { return &m_Registry->GetDenseObject(m_DenseIndex); }
+			//The handle of the object the iterator points to.
+			RegistryHandle handle() const { return m_Registry->GetDenseHandle(m_DenseIndex); }
+
+			Iterator& operator++()
+			{
+				++m_DenseIndex;
+				return *this;
+			}
+
+			Iterator operator++(int)
+			{
+				Iterator t_Tmp = *this;
+				++(*this);
+				return t_Tmp;
+			}
+
+			friend bool operator== (const Iterator& a_Lhs, const Iterator& a_Rhs) { return a_Lhs.m_DenseIndex == a_Rhs.m_DenseIndex; };
+			friend bool operator!= (const Iterator& a_Lhs, const Iterator& a_Rhs) { return a_Lhs.m_DenseIndex != a_Rhs.m_DenseIndex; };
+			friend bool operator< (const Iterator& a_Lhs, const Iterator& a_Rhs) { return a_Lhs.m_DenseIndex < a_Rhs.m_DenseIndex; };
+			friend bool operator> (const Iterator& a_Lhs, const Iterator& a_Rhs) { return a_Lhs.m_DenseIndex > a_Rhs.m_DenseIndex; };
+			friend bool operator<= (const Iterator& a_Lhs, const Iterator& a_Rhs) { return a_Lhs.m_DenseIndex <= a_Rhs.m_DenseIndex; };
+			friend bool operator>= (const Iterator& a_Lhs, const Iterator& a_Rhs) { return a_Lhs.m_DenseIndex >= a_Rhs.m_DenseIndex; };
+
+		private:
+			const HandleRegistry<T>* m_Registry;
+			uint32_t m_DenseIndex;
+		};
+
+		//Called for every object in a ParallelForEach, from any worker thread.
+		typedef void (*PFN_RegistryForEach)(T& a_Object, const RegistryHandle a_Handle, void* a_UserData);
+
+		//a_MaxSize is the most objects the registry can ever hold, only the page table is allocated for it up front.
+		HandleRegistry(Allocator a_Allocator, const uint32_t a_MaxSize);
+		~HandleRegistry();
+
+		//just delete these for safety, other threads might hold pointers to the objects.
+		HandleRegistry(const HandleRegistry&) = delete;
+		HandleRegistry(const HandleRegistry&&) = delete;
+		HandleRegistry& operator =(const HandleRegistry&) = delete;
+		HandleRegistry& operator =(HandleRegistry&&) = delete;
+
+		//Asserts on a handle that is not valid, use find when the handle might be old.
+		T& operator[](const RegistryHandle a_Handle) const;
+
+		RegistryHandle insert(const T& a_Obj);
+		template <class... Args>
+		RegistryHandle emplace(Args&&... a_Args);
+		//Returns nullptr when the handle's object is erased, also in release builds.
+		T* find(const RegistryHandle a_Handle) const;
+		bool valid(const RegistryHandle a_Handle) const;
+		void erase(const RegistryHandle a_Handle);
+
+		void clear();
+
+		/// <summary>
+		/// Calls a_Function for every object on the worker threads, a_GrainSize objects per job.
+		/// Objects inserted after the call are not visited, nothing may be erased until the returned task is finished.
+		/// </summary>
+		ThreadTask ParallelForEach(const size_t a_GrainSize, PFN_RegistryForEach a_Function, void* a_UserData);
+
+		Iterator begin() const { return Iterator(this, 0); }
+		Iterator end() const { return Iterator(this, size()); }
+
+		uint32_t size() const { return m_Size.load(std::memory_order_acquire); }
+		uint32_t capacity() const { return m_MaxSize; }
+
+	private:
+		//Slot a_Index must have a page.
+		inline Page& GetPage(const uint32_t a_Index) const { return *m_Pages[a_Index / PAGE_SIZE].load(std::memory_order_acquire); }
+		inline T* GetSlotObject(Page& a_Page, const uint32_t a_Index) const { return reinterpret_cast<T*>(&a_Page.objects[sizeof(T) * (a_Index % PAGE_SIZE)]); }
+		inline uint32_t& DenseSlot(const uint32_t a_DenseIndex) const { return GetPage(a_DenseIndex).denseSlots[a_DenseIndex % PAGE_SIZE]; }
+
+		T& GetDenseObject(const uint32_t a_DenseIndex) const;
+		RegistryHandle GetDenseHandle(const uint32_t a_DenseIndex) const;
+		//Takes a slot from the free list, allocates a new page if there is none. Call with m_WriteLock locked.
+		uint32_t AllocateSlot();
+
+		Allocator m_Allocator;
+		FutexMutex m_WriteLock;
+
+		//Never reallocated, a page pointer is written once so readers never need to lock.
+		std::atomic<Page*>* m_Pages;
+		const uint32_t m_MaxSize;
+		uint32_t m_PageCount = 0;
+
+		std::atomic<uint32_t> m_Size{ 0 };
+		//index of the first free slot.
+		uint32_t m_NextFree = UINT32_MAX;
+	};
+
+	template<typename T>
+	inline BB::HandleRegistry<T>::HandleRegistry(Allocator a_Allocator, const uint32_t a_MaxSize)
+		:	m_Allocator(a_Allocator), m_MaxSize(a_MaxSize)
+	{
+		BB_ASSERT(a_MaxSize != 0 && a_MaxSize < UINT32_MAX, "HandleRegistry max size must be between 0 and UINT32_MAX!");
+		const uint32_t t_PageTableSize = (a_MaxSize + PAGE_SIZE - 1) / PAGE_SIZE;
+		m_Pages = reinterpret_cast<std::atomic<Page*>*>(BBalloc(m_Allocator, sizeof(std::atomic<Page*>) * t_PageTableSize));
+		for (uint32_t i = 0; i < t_PageTableSize; i++)
+			new (&m_Pages[i]) std::atomic<Page*>(nullptr);
+	}
+
+	template<typename T>
+	inline BB::HandleRegistry<T>::~HandleRegistry()
+	{
+		clear();
+		for (uint32_t i = 0; i < m_PageCount; i++)
+			BBfree(m_Allocator, m_Pages[i].load(std::memory_order_relaxed));
+		BBfree(m_Allocator, m_Pages);
+	}
+
+	template<typename T>
+	inline T& BB::HandleRegistry<T>::operator[](const RegistryHandle a_Handle) const
+	{
+		T* t_Object = find(a_Handle);
+		BB_ASSERT(t_Object != nullptr,
+			"HandleRegistry, Handle is from the wrong generation! Likely means this handle was already used to delete an element.");
+		return *t_Object;
+	}
+
+	template<typename T>
+	inline RegistryHandle BB::HandleRegistry<T>::insert(const T& a_Obj)
+	{
+		return emplace(a_Obj);
+	}
+
+	template<typename T>
+	template<class ...Args>
+	inline RegistryHandle BB::HandleRegistry<T>::emplace(Args&&... a_Args)
+	{
+		m_WriteLock.lock();
+		const uint32_t t_Index = AllocateSlot();
+		Page& t_Page = GetPage(t_Index);
+		const uint32_t t_Slot = t_Index % PAGE_SIZE;
+
+		new (GetSlotObject(t_Page, t_Index)) T(std::forward<Args>(a_Args)...);
+
+		const uint32_t t_DenseIndex = m_Size.load(std::memory_order_relaxed);
+		t_Page.denseIndex[t_Slot] = t_DenseIndex;
+		DenseSlot(t_DenseIndex) = t_Index;
+
+		//Odd means in use, the release makes the constructed object visible to a thread that sees the new generation.
+		const uint32_t t_Generation = t_Page.generations[t_Slot].load(std::memory_order_relaxed) + 1;
+		t_Page.generations[t_Slot].store(t_Generation, std::memory_order_release);
+		m_Size.store(t_DenseIndex + 1, std::memory_order_release);
+		m_WriteLock.unlock();
+
+		return RegistryHandle(t_Index, t_Generation);
+	}
+
+	template<typename T>
+	inline T* BB::HandleRegistry<T>::find(const RegistryHandle a_Handle) const
+	{
+		if (!valid(a_Handle))
+			return nullptr;
+		return GetSlotObject(GetPage(a_Handle.index), a_Handle.index);
+	}
+
+	template<typename T>
+	inline bool BB::HandleRegistry<T>::valid(const RegistryHandle a_Handle) const
+	{
+		if (a_Handle.index >= m_MaxSize)
+			return false;
+		Page* t_Page = m_Pages[a_Handle.index / PAGE_SIZE].load(std::memory_order_acquire);
+		if (t_Page == nullptr)
+			return false;
+		return t_Page->generations[a_Handle.index % PAGE_SIZE].load(std::memory_order_acquire) == a_Handle.extraIndex &&
+			(a_Handle.extraIndex & 1) == 1;
+	}
+
+	template<typename T>
+	inline void BB::HandleRegistry<T>::erase(const RegistryHandle a_Handle)
+	{
+		m_WriteLock.lock();
+		BB_ASSERT(valid(a_Handle),
+			"HandleRegistry, Handle is from the wrong generation! Likely means this handle was already used to delete an element.");
+		Page& t_Page = GetPage(a_Handle.index);
+		const uint32_t t_Slot = a_Handle.index % PAGE_SIZE;
+
+		//Even means free, readers see the handle as invalid before the object is gone.
+		t_Page.generations[t_Slot].store(a_Handle.extraIndex + 1, std::memory_order_release);
+		if constexpr (!trivialDestructible_T)
+			GetSlotObject(t_Page, a_Handle.index)->~T();
+
+		//The last dense entry takes the place of the erased one, no object moves.
+		const uint32_t t_DenseIndex = t_Page.denseIndex[t_Slot];
+		const uint32_t t_LastDense = m_Size.load(std::memory_order_relaxed) - 1;
+		const uint32_t t_LastSlot = DenseSlot(t_LastDense);
+		DenseSlot(t_DenseIndex) = t_LastSlot;
+		GetPage(t_LastSlot).denseIndex[t_LastSlot % PAGE_SIZE] = t_DenseIndex;
+		m_Size.store(t_LastDense, std::memory_order_release);
+
+		t_Page.denseIndex[t_Slot] = m_NextFree;
+		m_NextFree = a_Handle.index;
+		m_WriteLock.unlock();
+	}
+
+	template<typename T>
+	inline void BB::HandleRegistry<T>::clear()
+	{
+		m_WriteLock.lock();
+		const uint32_t t_Size = m_Size.load(std::memory_order_relaxed);
+		for (uint32_t i = 0; i < t_Size; i++)
+		{
+			const uint32_t t_Index = DenseSlot(i);
+			Page& t_Page = GetPage(t_Index);
+			const uint32_t t_Slot = t_Index % PAGE_SIZE;
+			t_Page.generations[t_Slot].fetch_add(1, std::memory_order_release);
+			if constexpr (!trivialDestructible_T)
+				GetSlotObject(t_Page, t_Index)->~T();
+			t_Page.denseIndex[t_Slot] = m_NextFree;
+			m_NextFree = t_Index;
+		}
+		m_Size.store(0, std::memory_order_release);
+		m_WriteLock.unlock();
+	}
+
+	template<typename T>
+	inline ThreadTask BB::HandleRegistry<T>::ParallelForEach(const size_t a_GrainSize, PFN_RegistryForEach a_Function, void* a_UserData)
+	{
+		struct ForEachData
+		{
+			const HandleRegistry<T>* registry;
+			PFN_RegistryForEach function;
+			void* userData;
+		};
+		const ForEachData t_Data{ this, a_Function, a_UserData };
+
+		return Threads::StartParallelRange(size(), a_GrainSize,
+			[](const size_t a_Begin, const size_t a_End, const uint32_t, Allocator, void* a_Data)
+			{
+				const ForEachData& t_ForEachData = *reinterpret_cast<const ForEachData*>(a_Data);
+				for (size_t i = a_Begin; i < a_End; i++)
+				{
+					const uint32_t t_DenseIndex = static_cast<uint32_t>(i);
+					t_ForEachData.function(t_ForEachData.registry->GetDenseObject(t_DenseIndex),
+						t_ForEachData.registry->GetDenseHandle(t_DenseIndex),
+						t_ForEachData.userData);
+				}
+			},
+			nullptr, &t_Data, sizeof(t_Data));
+	}
+
+	template<typename T>
+	inline T& BB::HandleRegistry<T>::GetDenseObject(const uint32_t a_DenseIndex) const
+	{
+		const uint32_t t_Index = DenseSlot(a_DenseIndex);
+		return *GetSlotObject(GetPage(t_Index), t_Index);
+	}
+
+	template<typename T>
+	inline RegistryHandle BB::HandleRegistry<T>::GetDenseHandle(const uint32_t a_DenseIndex) const
+	{
+		const uint32_t t_Index = DenseSlot(a_DenseIndex);
+		return RegistryHandle(t_Index, GetPage(t_Index).generations[t_Index % PAGE_SIZE].load(std::memory_order_relaxed));
+	}
+
+	template<typename T>
+	inline uint32_t BB::HandleRegistry<T>::AllocateSlot()
+	{
+		if (m_NextFree == UINT32_MAX)
+		{
+			const uint32_t t_FirstIndex = m_PageCount * PAGE_SIZE;
+			BB_ASSERT(t_FirstIndex < m_MaxSize, "HandleRegistry is full!");
+			Page* t_Page = BBnew(m_Allocator, Page);
+			//Slots past the max size never go in the free list.
+			const uint32_t t_SlotCount = m_MaxSize - t_FirstIndex < PAGE_SIZE ? m_MaxSize - t_FirstIndex : PAGE_SIZE;
+			for (uint32_t i = 0; i < PAGE_SIZE; i++)
+			{
+				t_Page->generations[i].store(0, std::memory_order_relaxed);
+				t_Page->denseIndex[i] = i + 1 < t_SlotCount ? t_FirstIndex + i + 1 : UINT32_MAX;
+			}
+			m_NextFree = t_FirstIndex;
+			//Readers that load the page pointer see the initialized generations.
+			m_Pages[m_PageCount++].store(t_Page, std::memory_order_release);
+		}
+
+		const uint32_t t_Index = m_NextFree;
+		m_NextFree = GetPage(t_Index).denseIndex[t_Index % PAGE_SIZE];
+		return t_Index;
+	}
+}
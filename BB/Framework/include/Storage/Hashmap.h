@@ -2,6 +2,13 @@
 #include "Utils/Hash.h"
 #include "Utils/Utils.h"
 #include "BBMemory.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+//SW_Group compares a group of control bytes with SSE2 (or AVX2), otherwise it uses a scalar 8 slot group.
+#define BB_SW_GROUP_SIMD
+#endif //__SSE2__ || _M_X64
+
 namespace BB
 {
 	namespace Hashmap_Specs
@@ -16,6 +23,19 @@ namespace BB
 		constexpr const float OL_LoadFactor = 1.3f;
 		constexpr const size_t OL_TOMBSTONE = 0xDEADBEEFDEADBEEF;
 		constexpr const size_t OL_EMPTY = 0xAABBCCDD;
+
+		//Group probing keeps lookups fast at high loads, so the SW map only grows above this.
+		constexpr const float SW_MaxLoadFactor = 0.9f;
+		//Full slots store the low 7 bits of the hash in their control byte, the sign bit marks empty and deleted slots.
+		constexpr const int8_t SW_EMPTY = -128;
+		constexpr const int8_t SW_DELETED = -2;
+#if defined(__AVX2__)
+		constexpr const size_t SW_GroupWidth = 32;
+#elif defined(BB_SW_GROUP_SIMD)
+		constexpr const size_t SW_GroupWidth = 16;
+#else
+		constexpr const size_t SW_GroupWidth = 8;
+#endif //__AVX2__
 	};
 
 	//Calculate the load factor.
@@ -26,6 +46,9 @@ namespace BB
 
 	struct String_KeyComp
 	{
+		//Lets the SW_HashMap find char* keys with a const char* without a cast.
+		using is_transparent = void;
+
 		bool operator()(const char* a_A, const char* a_B) const
 		{
 			return strcmp(a_A, a_B) == 0;
@@ -373,8 +396,11 @@ namespace BB
 				}
 			}
 
+			//The destructor clears the map and ends the lifetime of the members, so keep the size.
+			const size_t t_Size = m_Size;
 			this->~UM_HashMap();
 
+			m_Size = t_Size;
 			m_Capacity = t_NewCapacity;
 			m_LoadCapacity = a_NewLoadCapacity;
 			m_Entries = t_NewEntries;
@@ -744,8 +770,12 @@ namespace BB
 			}
 
 			//Remove all the elements and free the memory.
+			//The destructor ends the lifetime of the members, so keep the size. Optimized builds lose it otherwise.
+			const size_t t_Size = m_Size;
 			this->~OL_HashMap();
 
+			m_Size = t_Size;
+
 			m_Hashes = t_NewHashes;
 			m_Keys = t_NewKeys;
 			m_Values = t_NewValues;
@@ -764,6 +794,422 @@ namespace BB
 		Key* m_Keys;
 		Value* m_Values;
 
+		Allocator m_Allocator;
+	};
+#pragma endregion
+
+#pragma region Swiss table (SW)
+	//Compares the control bytes of a whole group of slots at once.
+	struct SW_Group
+	{
+		//One bit for every slot in the group.
+		using BitMask = uint32_t;
+
+		explicit SW_Group(const int8_t* a_Control)
+		{
+#if defined(__AVX2__)
+			control = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a_Control));
+#elif defined(BB_SW_GROUP_SIMD)
+			control = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a_Control));
+#else
+			memcpy(control, a_Control, sizeof(control));
+#endif //__AVX2__
+		}
+
+		BitMask Match(const int8_t a_ControlByte) const
+		{
+#if defined(__AVX2__)
+			return static_cast<BitMask>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(control, _mm256_set1_epi8(a_ControlByte))));
+#elif defined(BB_SW_GROUP_SIMD)
+			return static_cast<BitMask>(_mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8(a_ControlByte))));
+#else
+			BitMask t_Mask = 0;
+			for (size_t i = 0; i < Hashmap_Specs::SW_GroupWidth; i++)
+				t_Mask |= static_cast<BitMask>(control[i] == a_ControlByte) << i;
+			return t_Mask;
+#endif //__AVX2__
+		}
+
+		BitMask MatchEmpty() const
+		{
+			return Match(Hashmap_Specs::SW_EMPTY);
+		}
+
+		//Empty and deleted are the only control bytes with the sign bit set.
+		BitMask MatchEmptyOrDeleted() const
+		{
+#if defined(__AVX2__)
+			return static_cast<BitMask>(_mm256_movemask_epi8(control));
+#elif defined(BB_SW_GROUP_SIMD)
+			return static_cast<BitMask>(_mm_movemask_epi8(control));
+#else
+			BitMask t_Mask = 0;
+			for (size_t i = 0; i < Hashmap_Specs::SW_GroupWidth; i++)
+				t_Mask |= static_cast<BitMask>(control[i] < 0) << i;
+			return t_Mask;
+#endif //__AVX2__
+		}
+
+#if defined(__AVX2__)
+		__m256i control;
+#elif defined(BB_SW_GROUP_SIMD)
+		__m128i control;
+#else
+		int8_t control[Hashmap_Specs::SW_GroupWidth];
+#endif //__AVX2__
+	};
+
+	template<typename KeyComp, typename = void>
+	struct IsTransparentKeyComp : std::false_type {};
+	template<typename KeyComp>
+	struct IsTransparentKeyComp<KeyComp, std::void_t<typename KeyComp::is_transparent>> : std::true_type {};
+
+	//Open addressing with a byte of metadata per slot, a whole group of slots is probed with one SIMD compare.
+	//Keys and values are stored next to each other so a hit only touches the control bytes and one slot.
+	//A KeyComp with is_transparent (like String_KeyComp) also allows lookups with a different key type.
+	template<typename Key, typename Value, typename KeyComp = Standard_KeyComp<Key>>
+	class SW_HashMap
+	{
+		static constexpr bool trivalDestructableValue = std::is_trivially_destructible_v<Value>;
+		static constexpr bool trivalDestructableKey = std::is_trivially_destructible_v<Key>;
+
+		struct Slot
+		{
+			Key key;
+			Value value;
+		};
+
+		template<typename LookupKey>
+		using EnableTransparent = std::enable_if_t<!std::is_same_v<LookupKey, Key> && IsTransparentKeyComp<KeyComp>::value, bool>;
+
+	public:
+		SW_HashMap(Allocator a_Allocator)
+			: SW_HashMap(a_Allocator, Hashmap_Specs::Standard_Hashmap_Size)
+		{}
+		SW_HashMap(Allocator a_Allocator, const size_t a_Size)
+			: m_Allocator(a_Allocator)
+		{
+			Allocate(CapacityForSize(a_Size));
+		}
+		SW_HashMap(const SW_HashMap<Key, Value, KeyComp>& a_Map)
+			: m_Allocator(a_Map.m_Allocator)
+		{
+			Allocate(a_Map.m_Capacity);
+			a_Map.CopyInto(*this);
+		}
+		SW_HashMap(SW_HashMap<Key, Value, KeyComp>&& a_Map) noexcept
+		{
+			Steal(a_Map);
+		}
+		~SW_HashMap()
+		{
+			if (m_Control != nullptr)
+			{
+				DestroySlots();
+				BBfree(m_Allocator, m_Control);
+				m_Control = nullptr;
+			}
+		}
+
+		SW_HashMap<Key, Value, KeyComp>& operator=(const SW_HashMap<Key, Value, KeyComp>& a_Rhs)
+		{
+			this->~SW_HashMap();
+
+			m_Allocator = a_Rhs.m_Allocator;
+			Allocate(a_Rhs.m_Capacity);
+			a_Rhs.CopyInto(*this);
+
+			return *this;
+		}
+		SW_HashMap<Key, Value, KeyComp>& operator=(SW_HashMap<Key, Value, KeyComp>&& a_Rhs) noexcept
+		{
+			this->~SW_HashMap();
+
+			Steal(a_Rhs);
+
+			return *this;
+		}
+
+		void insert(const Key& a_Key, Value& a_Res)
+		{
+			emplace(a_Key, a_Res);
+		}
+		template <class... Args>
+		void emplace(const Key& a_Key, Args&&... a_ValueArgs)
+		{
+#ifdef _DEBUG
+			BB_ASSERT(find(a_Key) == nullptr, "SW_HashMap emplace called with a key that is already in the map!");
+#endif //_DEBUG
+			if (m_Size + m_Deleted >= m_GrowthLimit)
+				grow();
+
+			const uint64_t t_Hash = Hash::MakeHash(a_Key).hash;
+			const size_t t_Index = FindInsertSlot(t_Hash);
+			if (m_Control[t_Index] == Hashmap_Specs::SW_DELETED)
+				--m_Deleted;
+
+			SetControl(t_Index, H2(t_Hash));
+			new (&m_Slots[t_Index].key) Key(a_Key);
+			new (&m_Slots[t_Index].value) Value(std::forward<Args>(a_ValueArgs)...);
+			++m_Size;
+		}
+		Value* find(const Key& a_Key) const
+		{
+			return FindValue(a_Key);
+		}
+		template<typename LookupKey, EnableTransparent<LookupKey> = true>
+		Value* find(const LookupKey& a_Key) const
+		{
+			return FindValue(a_Key);
+		}
+		bool contains(const Key& a_Key) const
+		{
+			return FindIndex(a_Key) != m_Capacity;
+		}
+		template<typename LookupKey, EnableTransparent<LookupKey> = true>
+		bool contains(const LookupKey& a_Key) const
+		{
+			return FindIndex(a_Key) != m_Capacity;
+		}
+		void erase(const Key& a_Key)
+		{
+			EraseIndex(FindIndex(a_Key));
+		}
+		template<typename LookupKey, EnableTransparent<LookupKey> = true>
+		void erase(const LookupKey& a_Key)
+		{
+			EraseIndex(FindIndex(a_Key));
+		}
+		void clear()
+		{
+			DestroySlots();
+			memset(m_Control, Hashmap_Specs::SW_EMPTY, m_Capacity + Hashmap_Specs::SW_GroupWidth);
+			m_Size = 0;
+			m_Deleted = 0;
+		}
+
+		void reserve(const size_t a_Size)
+		{
+			const size_t t_Capacity = CapacityForSize(a_Size);
+			if (t_Capacity > m_Capacity)
+				reallocate(t_Capacity);
+		}
+
+		size_t size() const { return m_Size; }
+		//Amount of slots, this is always a power of 2.
+		size_t capacity() const { return m_Capacity; }
+
+	private:
+		template<typename LookupKey>
+		Value* FindValue(const LookupKey& a_Key) const
+		{
+			const size_t t_Index = FindIndex(a_Key);
+			if (t_Index == m_Capacity)
+				return nullptr;
+			return &m_Slots[t_Index].value;
+		}
+
+		void EraseIndex(const size_t a_Index)
+		{
+			BB_ASSERT(a_Index != m_Capacity, "SW_Hashmap remove called but key not found!");
+
+			DestroySlot(a_Index);
+			--m_Size;
+
+			//A probe only continues past a group that was full. If there is an empty slot close enough on both sides,
+			//no group containing this slot was ever full and it can become empty instead of deleted.
+			const size_t a_IndexBefore = (a_Index - Hashmap_Specs::SW_GroupWidth) & (m_Capacity - 1);
+			const SW_Group::BitMask t_EmptyBefore = SW_Group(&m_Control[a_IndexBefore]).MatchEmpty();
+			const SW_Group::BitMask t_EmptyAfter = SW_Group(&m_Control[a_Index]).MatchEmpty();
+			if (t_EmptyBefore != 0 && t_EmptyAfter != 0 &&
+				(Hashmap_Specs::SW_GroupWidth - 1 - Math::FindLastSetBit(t_EmptyBefore)) + Math::FindFirstSetBit(t_EmptyAfter) < Hashmap_Specs::SW_GroupWidth)
+			{
+				SetControl(a_Index, Hashmap_Specs::SW_EMPTY);
+			}
+			else
+			{
+				SetControl(a_Index, Hashmap_Specs::SW_DELETED);
+				++m_Deleted;
+			}
+		}
+
+		static int8_t H2(const uint64_t a_Hash) { return static_cast<int8_t>(a_Hash & 0x7F); }
+		static size_t H1(const uint64_t a_Hash) { return static_cast<size_t>(a_Hash >> 7); }
+
+		static size_t CapacityForSize(const size_t a_Size)
+		{
+			size_t t_Capacity = Hashmap_Specs::SW_GroupWidth;
+			while (static_cast<size_t>(static_cast<float>(t_Capacity) * Hashmap_Specs::SW_MaxLoadFactor) < a_Size)
+				t_Capacity *= 2;
+			return t_Capacity;
+		}
+
+		void grow()
+		{
+			//Lots of deleted slots, cleaning them up is enough.
+			if (m_Deleted > m_Size)
+			{
+				reallocate(m_Capacity);
+				return;
+			}
+
+			BB_WARNING(false, "Resizing an SW_HashMap, this might be a bit slow. Possibly reserve more.", WarningType::OPTIMALIZATION);
+			reallocate(m_Capacity * 2);
+		}
+
+		void reallocate(const size_t a_NewCapacity)
+		{
+			int8_t* t_OldControl = m_Control;
+			Slot* t_OldSlots = m_Slots;
+			const size_t t_OldCapacity = m_Capacity;
+
+			Allocate(a_NewCapacity);
+
+			for (size_t i = 0; i < t_OldCapacity; i++)
+			{
+				if (t_OldControl[i] >= 0)
+				{
+					const uint64_t t_Hash = Hash::MakeHash(t_OldSlots[i].key).hash;
+					const size_t t_Index = FindInsertSlot(t_Hash);
+					SetControl(t_Index, H2(t_Hash));
+					new (&m_Slots[t_Index]) Slot(std::move(t_OldSlots[i]));
+					t_OldSlots[i].~Slot();
+					++m_Size;
+				}
+			}
+
+			BBfree(m_Allocator, t_OldControl);
+		}
+
+		//Control bytes first, the first group is copied behind the last slot so that a group can be loaded from any slot.
+		void Allocate(const size_t a_Capacity)
+		{
+			const size_t t_ControlSize = Math::RoundUp(a_Capacity + Hashmap_Specs::SW_GroupWidth, alignof(Slot));
+			void* t_Buffer = BBalloc(m_Allocator, t_ControlSize + sizeof(Slot) * a_Capacity);
+
+			m_Control = reinterpret_cast<int8_t*>(t_Buffer);
+			m_Slots = reinterpret_cast<Slot*>(Pointer::Add(t_Buffer, t_ControlSize));
+			memset(m_Control, Hashmap_Specs::SW_EMPTY, a_Capacity + Hashmap_Specs::SW_GroupWidth);
+
+			m_Capacity = a_Capacity;
+			m_GrowthLimit = static_cast<size_t>(static_cast<float>(a_Capacity) * Hashmap_Specs::SW_MaxLoadFactor);
+			m_Size = 0;
+			m_Deleted = 0;
+		}
+
+		void SetControl(const size_t a_Index, const int8_t a_ControlByte)
+		{
+			m_Control[a_Index] = a_ControlByte;
+			if (a_Index < Hashmap_Specs::SW_GroupWidth)
+				m_Control[a_Index + m_Capacity] = a_ControlByte;
+		}
+
+		//Returns m_Capacity if the key is not in the map.
+		template<typename LookupKey>
+		size_t FindIndex(const LookupKey& a_Key) const
+		{
+			const uint64_t t_Hash = Hash::MakeHash(a_Key).hash;
+			const int8_t t_H2 = H2(t_Hash);
+			const size_t t_Mask = m_Capacity - 1;
+
+			//Triangular steps of whole groups visit every group once.
+			size_t t_Offset = H1(t_Hash) & t_Mask;
+			size_t t_Step = 0;
+			while (true)
+			{
+				const SW_Group t_Group(&m_Control[t_Offset]);
+				SW_Group::BitMask t_Matches = t_Group.Match(t_H2);
+				while (t_Matches != 0)
+				{
+					const size_t t_Index = (t_Offset + Math::FindFirstSetBit(t_Matches)) & t_Mask;
+					if (KeyComp()(m_Slots[t_Index].key, a_Key))
+						return t_Index;
+					t_Matches &= t_Matches - 1;
+				}
+				//The key would have been placed in this group's empty slot.
+				if (t_Group.MatchEmpty() != 0)
+					return m_Capacity;
+
+				t_Step += Hashmap_Specs::SW_GroupWidth;
+				t_Offset = (t_Offset + t_Step) & t_Mask;
+			}
+		}
+
+		size_t FindInsertSlot(const uint64_t a_Hash) const
+		{
+			const size_t t_Mask = m_Capacity - 1;
+
+			size_t t_Offset = H1(a_Hash) & t_Mask;
+			size_t t_Step = 0;
+			while (true)
+			{
+				const SW_Group::BitMask t_Free = SW_Group(&m_Control[t_Offset]).MatchEmptyOrDeleted();
+				if (t_Free != 0)
+					return (t_Offset + Math::FindFirstSetBit(t_Free)) & t_Mask;
+
+				t_Step += Hashmap_Specs::SW_GroupWidth;
+				t_Offset = (t_Offset + t_Step) & t_Mask;
+			}
+		}
+
+		void DestroySlot(const size_t a_Index)
+		{
+			//Call the destructor if it has one for the value.
+			if constexpr (!trivalDestructableValue)
+				m_Slots[a_Index].value.~Value();
+			//Call the destructor if it has one for the key.
+			if constexpr (!trivalDestructableKey)
+				m_Slots[a_Index].key.~Key();
+		}
+
+		void DestroySlots()
+		{
+			if constexpr (!trivalDestructableValue || !trivalDestructableKey)
+				for (size_t i = 0; i < m_Capacity; i++)
+					if (m_Control[i] >= 0)
+						DestroySlot(i);
+		}
+
+		void CopyInto(SW_HashMap<Key, Value, KeyComp>& a_Map) const
+		{
+			for (size_t i = 0; i < m_Capacity; i++)
+				if (m_Control[i] >= 0)
+					a_Map.emplace(m_Slots[i].key, m_Slots[i].value);
+		}
+
+		void Steal(SW_HashMap<Key, Value, KeyComp>& a_Map)
+		{
+			m_Capacity = a_Map.m_Capacity;
+			m_Size = a_Map.m_Size;
+			m_Deleted = a_Map.m_Deleted;
+			m_GrowthLimit = a_Map.m_GrowthLimit;
+
+			m_Control = a_Map.m_Control;
+			m_Slots = a_Map.m_Slots;
+
+			m_Allocator = a_Map.m_Allocator;
+
+			a_Map.m_Capacity = 0;
+			a_Map.m_Size = 0;
+			a_Map.m_Deleted = 0;
+			a_Map.m_GrowthLimit = 0;
+			a_Map.m_Control = nullptr;
+			a_Map.m_Slots = nullptr;
+
+			a_Map.m_Allocator.allocator = nullptr;
+			a_Map.m_Allocator.func = nullptr;
+		}
+
+	private:
+		size_t m_Capacity;
+		size_t m_Size;
+		//Deleted slots still make probes longer, they count towards growing.
+		size_t m_Deleted;
+		size_t m_GrowthLimit;
+
+		int8_t* m_Control = nullptr;
+		Slot* m_Slots = nullptr;
+
 		Allocator m_Allocator;
 	};
 }
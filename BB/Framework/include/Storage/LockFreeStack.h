@@ -0,0 +1,101 @@
+#pragma once
+#include "Utils/Logger.h"
+
+#include <atomic>
+
+namespace BB
+{
+	/// <summary>
+	/// Intrusive lock-free stack, T needs a "T* next" member. Made for free lists.
+	/// It owns no memory, a node that is popped must stay valid memory since another thread
+	/// might still read its next pointer. Perfect for nodes that live in a pool or array.
+	/// The head stores a tag next to the pointer so a node that is popped and pushed again
+	/// between another thread's read and compare exchange does not corrupt the stack (ABA).
+	/// </summary>
+	template<typename T>
+	class LockFreeStack
+	{
+	public:
+		LockFreeStack() = default;
+		//just delete these for safety, copies might cause errors.
+		LockFreeStack(const LockFreeStack&) = delete;
+		LockFreeStack(const LockFreeStack&&) = delete;
+		LockFreeStack& operator =(const LockFreeStack&) = delete;
+		LockFreeStack& operator =(LockFreeStack&&) = delete;
+
+		void push(T* a_Node);
+		//Pushes a list of nodes already linked with next, a_Last->next gets overwritten.
+		void push(T* a_First, T* a_Last);
+		//Returns nullptr when the stack is empty.
+		T* pop();
+
+		bool empty() const { return GetPointer(m_Head.load(std::memory_order_relaxed)) == nullptr; }
+
+	private:
+		//x64 only uses the lower 48 bits of an address, the upper 16 bits hold the tag.
+		static constexpr const uint64_t POINTER_BITS = 48;
+		static constexpr const uint64_t POINTER_MASK = (1ull << POINTER_BITS) - 1;
+
+		//next is read by a pop that might lose the race, so it is always read and written atomically.
+		static T* LoadNext(T* const* a_Next)
+		{
+#ifdef _MSC_VER
+			return *reinterpret_cast<T* const volatile*>(a_Next);
+#else
+			return __atomic_load_n(a_Next, __ATOMIC_RELAXED);
+#endif //_MSC_VER
+		}
+		static void StoreNext(T** a_Next, T* a_Value)
+		{
+#ifdef _MSC_VER
+			*reinterpret_cast<T* volatile*>(a_Next) = a_Value;
+#else
+			__atomic_store_n(a_Next, a_Value, __ATOMIC_RELAXED);
+#endif //_MSC_VER
+		}
+
+		static T* GetPointer(const uint64_t a_Head) { return reinterpret_cast<T*>(a_Head & POINTER_MASK); }
+		static uint64_t MakeHead(const T* a_Node, const uint64_t a_OldHead)
+		{
+			BB_ASSERT((reinterpret_cast<uint64_t>(a_Node) & ~POINTER_MASK) == 0, "LockFreeStack node address does not fit in 48 bits!");
+			//Every change gets a new tag.
+			return reinterpret_cast<uint64_t>(a_Node) | ((a_OldHead & ~POINTER_MASK) + (1ull << POINTER_BITS));
+		}
+
+		std::atomic<uint64_t> m_Head{ 0 };
+	};
+
+	template<typename T>
+	inline void LockFreeStack<T>::push(T* a_Node)
+	{
+		push(a_Node, a_Node);
+	}
+
+	template<typename T>
+	inline void LockFreeStack<T>::push(T* a_First, T* a_Last)
+	{
+		uint64_t t_Head = m_Head.load(std::memory_order_relaxed);
+		uint64_t t_NewHead;
+		do
+		{
+			StoreNext(&a_Last->next, GetPointer(t_Head));
+			t_NewHead = MakeHead(a_First, t_Head);
+		} while (!m_Head.compare_exchange_weak(t_Head, t_NewHead, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	template<typename T>
+	inline T* LockFreeStack<T>::pop()
+	{
+		uint64_t t_Head = m_Head.load(std::memory_order_acquire);
+		T* t_Node;
+		do
+		{
+			t_Node = GetPointer(t_Head);
+			if (t_Node == nullptr)
+				return nullptr;
+			//t_Node might just have been popped by another thread, the tag makes the exchange fail if so.
+		} while (!m_Head.compare_exchange_weak(t_Head, MakeHead(LoadNext(&t_Node->next), t_Head), std::memory_order_acquire, std::memory_order_acquire));
+
+		return t_Node;
+	}
+}
@@ -0,0 +1,152 @@
+#pragma once
+#include "Utils/Logger.h"
+#include "BBMemory.h"
+
+#include <atomic>
+
+namespace BB
+{
+	/// <summary>
+	/// Bounded lock-free queue, any amount of threads can push and pop at the same time.
+	/// Every slot has a sequence number that tells if it's ready to be written or read,
+	/// so a push or pop is one compare exchange on the position and no thread ever waits on a lock.
+	/// Based on Dmitry Vyukov's bounded MPMC queue.
+	/// </summary>
+	template<typename T>
+	class MPMCQueue
+	{
+	public:
+		//a_Capacity must be a power of 2.
+		MPMCQueue(Allocator a_Allocator, const size_t a_Capacity);
+		~MPMCQueue();
+
+		//just delete these for safety, copies might cause errors.
+		MPMCQueue(const MPMCQueue&) = delete;
+		MPMCQueue(const MPMCQueue&&) = delete;
+		MPMCQueue& operator =(const MPMCQueue&) = delete;
+		MPMCQueue& operator =(MPMCQueue&&) = delete;
+
+		//Returns false when the queue is full.
+		bool try_push(const T& a_Element);
+		template <class... Args>
+		bool try_emplace(Args&&... a_Args);
+		//Returns false when the queue is empty.
+		bool try_pop(T& a_Out);
+
+		//Only a guess when other threads are using the queue.
+		size_t size() const;
+		size_t capacity() const { return m_Mask + 1; }
+
+	private:
+		struct Cell
+		{
+			std::atomic<size_t> sequence;
+			alignas(T) char element[sizeof(T)];
+		};
+
+		Allocator m_Allocator;
+		Cell* m_Cells;
+		const size_t m_Mask;
+
+		//Seperate cache lines, producers and consumers should not slow eachother down.
+		alignas(64) std::atomic<size_t> m_PushPos{ 0 };
+		alignas(64) std::atomic<size_t> m_PopPos{ 0 };
+	};
+
+	template<typename T>
+	inline MPMCQueue<T>::MPMCQueue(Allocator a_Allocator, const size_t a_Capacity)
+		: m_Allocator(a_Allocator), m_Mask(a_Capacity - 1)
+	{
+		BB_ASSERT(a_Capacity >= 2 && (a_Capacity & (a_Capacity - 1)) == 0, "MPMCQueue capacity must be a power of 2!");
+		m_Cells = reinterpret_cast<Cell*>(BBalloc(m_Allocator, a_Capacity * sizeof(Cell)));
+		//A cell can be pushed to when its sequence is equal to the push position.
+		for (size_t i = 0; i < a_Capacity; i++)
+			new (&m_Cells[i].sequence) std::atomic<size_t>(i);
+	}
+
+	template<typename T>
+	inline MPMCQueue<T>::~MPMCQueue()
+	{
+		if constexpr (!std::is_trivially_destructible_v<T>)
+		{
+			//No other thread uses the queue anymore, everything between the positions is still alive.
+			const size_t t_Push = m_PushPos.load(std::memory_order_relaxed);
+			for (size_t i = m_PopPos.load(std::memory_order_relaxed); i != t_Push; i++)
+				reinterpret_cast<T*>(m_Cells[i & m_Mask].element)->~T();
+		}
+		BBfree(m_Allocator, reinterpret_cast<void*>(m_Cells));
+	}
+
+	template<typename T>
+	inline bool MPMCQueue<T>::try_push(const T& a_Element)
+	{
+		return try_emplace(a_Element);
+	}
+
+	template<typename T>
+	template<class ...Args>
+	inline bool MPMCQueue<T>::try_emplace(Args&&... a_Args)
+	{
+		Cell* t_Cell;
+		size_t t_Pos = m_PushPos.load(std::memory_order_relaxed);
+		while (true)
+		{
+			t_Cell = &m_Cells[t_Pos & m_Mask];
+			const size_t t_Sequence = t_Cell->sequence.load(std::memory_order_acquire);
+			const intptr_t t_Difference = static_cast<intptr_t>(t_Sequence) - static_cast<intptr_t>(t_Pos);
+			if (t_Difference == 0)
+			{
+				if (m_PushPos.compare_exchange_weak(t_Pos, t_Pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			//The cell still has the element from a lap ago, the queue is full.
+			else if (t_Difference < 0)
+				return false;
+			//Another producer took this position.
+			else
+				t_Pos = m_PushPos.load(std::memory_order_relaxed);
+		}
+
+		new (t_Cell->element) T(std::forward<Args>(a_Args)...);
+		t_Cell->sequence.store(t_Pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	template<typename T>
+	inline bool MPMCQueue<T>::try_pop(T& a_Out)
+	{
+		Cell* t_Cell;
+		size_t t_Pos = m_PopPos.load(std::memory_order_relaxed);
+		while (true)
+		{
+			t_Cell = &m_Cells[t_Pos & m_Mask];
+			const size_t t_Sequence = t_Cell->sequence.load(std::memory_order_acquire);
+			const intptr_t t_Difference = static_cast<intptr_t>(t_Sequence) - static_cast<intptr_t>(t_Pos + 1);
+			if (t_Difference == 0)
+			{
+				if (m_PopPos.compare_exchange_weak(t_Pos, t_Pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			//Nothing was pushed to this cell yet, the queue is empty.
+			else if (t_Difference < 0)
+				return false;
+			else
+				t_Pos = m_PopPos.load(std::memory_order_relaxed);
+		}
+
+		T* t_Element = reinterpret_cast<T*>(t_Cell->element);
+		a_Out = std::move(*t_Element);
+		t_Element->~T();
+		//Ready for the push one lap later.
+		t_Cell->sequence.store(t_Pos + m_Mask + 1, std::memory_order_release);
+		return true;
+	}
+
+	template<typename T>
+	inline size_t MPMCQueue<T>::size() const
+	{
+		const size_t t_Push = m_PushPos.load(std::memory_order_relaxed);
+		const size_t t_Pop = m_PopPos.load(std::memory_order_relaxed);
+		return t_Push > t_Pop ? t_Push - t_Pop : 0;
+	}
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include "Utils/Logger.h"
+#include "BBMemory.h"
+
+#include <atomic>
+
+namespace BB
+{
+	/// <summary>
+	/// Bounded lock-free ring buffer for exactly one producer thread and one consumer thread.
+	/// Cheaper then the MPMCQueue since there is no compare exchange, only a load and store per side.
+	/// </summary>
+	template<typename T>
+	class SPSCQueue
+	{
+	public:
+		//a_Capacity must be a power of 2.
+		SPSCQueue(Allocator a_Allocator, const size_t a_Capacity);
+		~SPSCQueue();
+
+		//just delete these for safety, copies might cause errors.
+		SPSCQueue(const SPSCQueue&) = delete;
+		SPSCQueue(const SPSCQueue&&) = delete;
+		SPSCQueue& operator =(const SPSCQueue&) = delete;
+		SPSCQueue& operator =(SPSCQueue&&) = delete;
+
+		//Producer thread only. Returns false when the queue is full.
+		bool try_push(const T& a_Element);
+		template <class... Args>
+		bool try_emplace(Args&&... a_Args);
+		//Consumer thread only. Returns false when the queue is empty.
+		bool try_pop(T& a_Out);
+
+		//Only a guess when the other thread is using the queue.
+		size_t size() const;
+		size_t capacity() const { return m_Mask + 1; }
+
+	private:
+		Allocator m_Allocator;
+		T* m_Elements;
+		const size_t m_Mask;
+
+		//Written by the producer, with the consumer's position it last saw so it does not read m_Head every push.
+		alignas(64) std::atomic<size_t> m_Tail{ 0 };
+		size_t m_CachedHead = 0;
+		//Written by the consumer, with the producer's position it last saw.
+		alignas(64) std::atomic<size_t> m_Head{ 0 };
+		size_t m_CachedTail = 0;
+	};
+
+	template<typename T>
+	inline SPSCQueue<T>::SPSCQueue(Allocator a_Allocator, const size_t a_Capacity)
+		: m_Allocator(a_Allocator), m_Mask(a_Capacity - 1)
+	{
+		BB_ASSERT(a_Capacity >= 2 && (a_Capacity & (a_Capacity - 1)) == 0, "SPSCQueue capacity must be a power of 2!");
+		m_Elements = reinterpret_cast<T*>(BBalloc(m_Allocator, a_Capacity * sizeof(T)));
+	}
+
+	template<typename T>
+	inline SPSCQueue<T>::~SPSCQueue()
+	{
+		if constexpr (!std::is_trivially_destructible_v<T>)
+		{
+			const size_t t_Tail = m_Tail.load(std::memory_order_relaxed);
+			for (size_t i = m_Head.load(std::memory_order_relaxed); i != t_Tail; i++)
+				m_Elements[i & m_Mask].~T();
+		}
+		BBfree(m_Allocator, reinterpret_cast<void*>(m_Elements));
+	}
+
+	template<typename T>
+	inline bool SPSCQueue<T>::try_push(const T& a_Element)
+	{
+		return try_emplace(a_Element);
+	}
+
+	template<typename T>
+	template<class ...Args>
+	inline bool SPSCQueue<T>::try_emplace(Args&&... a_Args)
+	{
+		const size_t t_Tail = m_Tail.load(std::memory_order_relaxed);
+		if (t_Tail - m_CachedHead > m_Mask)
+		{
+			//Looks full, check where the consumer actually is.
+			m_CachedHead = m_Head.load(std::memory_order_acquire);
+			if (t_Tail - m_CachedHead > m_Mask)
+				return false;
+		}
+
+		new (&m_Elements[t_Tail & m_Mask]) T(std::forward<Args>(a_Args)...);
+		m_Tail.store(t_Tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	template<typename T>
+	inline bool SPSCQueue<T>::try_pop(T& a_Out)
+	{
+		const size_t t_Head = m_Head.load(std::memory_order_relaxed);
+		if (t_Head == m_CachedTail)
+		{
+			//Looks empty, check where the producer actually is.
+			m_CachedTail = m_Tail.load(std::memory_order_acquire);
+			if (t_Head == m_CachedTail)
+				return false;
+		}
+
+		T& t_Element = m_Elements[t_Head & m_Mask];
+		a_Out = std::move(t_Element);
+		t_Element.~T();
+		m_Head.store(t_Head + 1, std::memory_order_release);
+		return true;
+	}
+
+	template<typename T>
+	inline size_t SPSCQueue<T>::size() const
+	{
+		const size_t t_Head = m_Head.load(std::memory_order_relaxed);
+		const size_t t_Tail = m_Tail.load(std::memory_order_relaxed);
+		return t_Tail > t_Head ? t_Tail - t_Head : 0;
+	}
+}
@@ -351,10 +351,15 @@ namespace BB
 			t_NewIdArr[i].generation = 1;
 		}
 
-		m_IdArr[a_NewCapacity - 1].generation = 1;
+		t_NewIdArr[a_NewCapacity - 1].generation = 1;
 		
+		//The destructor ends the lifetime of the members, so keep the ones that are not reassigned.
+		const uint32_t t_Size = m_Size;
+		const uint32_t t_NextFree = m_NextFree;
 		this->~Slotmap();
 
+		m_Size = t_Size;
+		m_NextFree = t_NextFree;
 		m_Capacity = a_NewCapacity;
 		m_IdArr = t_NewIdArr;
 		m_ObjArr = t_NewObjArr;
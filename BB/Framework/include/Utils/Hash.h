@@ -1,6 +1,184 @@
 #pragma once
 #include "Utils/Logger.h"
 #include <type_traits>
+#include <cstdint>
+#include <cstring>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif //_MSC_VER
+
+namespace BB
+{
+	struct StringID;
+
+	//wyhash style hashing, multiply-mix over 8 byte reads with three independent lanes for long inputs.
+	//Every function is constexpr so hashes of string literals can be made at compile time, they give the same value as at runtime.
+	//Assumes a little endian CPU.
+	namespace Hashing
+	{
+		constexpr const uint64_t HASH_SECRET[4]{ 0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull };
+
+		namespace Internal
+		{
+			//a_A and a_B become the low and high 64 bits of a_A * a_B.
+			constexpr void Multiply128(uint64_t& a_A, uint64_t& a_B)
+			{
+#if defined(__SIZEOF_INT128__)
+				const __uint128_t t_Result = static_cast<__uint128_t>(a_A) * a_B;
+				a_A = static_cast<uint64_t>(t_Result);
+				a_B = static_cast<uint64_t>(t_Result >> 64);
+#else
+#if defined(_MSC_VER) && defined(_M_X64)
+				if (!__builtin_is_constant_evaluated())
+				{
+					a_A = _umul128(a_A, a_B, &a_B);
+					return;
+				}
+#endif //_MSC_VER && _M_X64
+				const uint64_t t_ALow = a_A & 0xFFFFFFFF, t_AHigh = a_A >> 32;
+				const uint64_t t_BLow = a_B & 0xFFFFFFFF, t_BHigh = a_B >> 32;
+				const uint64_t t_LowLow = t_ALow * t_BLow;
+				const uint64_t t_LowHigh = t_ALow * t_BHigh;
+				const uint64_t t_HighLow = t_AHigh * t_BLow;
+				const uint64_t t_HighHigh = t_AHigh * t_BHigh;
+				const uint64_t t_Middle = (t_LowLow >> 32) + (t_LowHigh & 0xFFFFFFFF) + (t_HighLow & 0xFFFFFFFF);
+				a_A = (t_Middle << 32) | (t_LowLow & 0xFFFFFFFF);
+				a_B = t_HighHigh + (t_LowHigh >> 32) + (t_HighLow >> 32) + (t_Middle >> 32);
+#endif //__SIZEOF_INT128__
+			}
+
+			constexpr uint64_t Mix(uint64_t a_A, uint64_t a_B)
+			{
+				Multiply128(a_A, a_B);
+				return a_A ^ a_B;
+			}
+
+			//Bytes are put together one by one when constant evaluated, at runtime this is a single load.
+			template<typename Char>
+			constexpr uint64_t Read(const Char* a_Data, const size_t a_Bytes)
+			{
+				if (!__builtin_is_constant_evaluated())
+				{
+					uint64_t t_Value = 0;
+					memcpy(&t_Value, a_Data, a_Bytes);
+					return t_Value;
+				}
+				uint64_t t_Value = 0;
+				for (size_t i = 0; i < a_Bytes; i++)
+					t_Value |= static_cast<uint64_t>(static_cast<uint8_t>(a_Data[i])) << (i * 8);
+				return t_Value;
+			}
+
+			template<typename Char>
+			constexpr uint64_t HashBytes(const Char* a_Data, const size_t a_Size, uint64_t a_Seed)
+			{
+				a_Seed ^= Mix(a_Seed ^ HASH_SECRET[0], HASH_SECRET[1]);
+				uint64_t t_A = 0;
+				uint64_t t_B = 0;
+				if (a_Size <= 16)
+				{
+					if (a_Size >= 4)
+					{
+						//Two overlapping reads of 4 bytes from each side cover everything up to 16 bytes.
+						const size_t t_Offset = (a_Size >> 3) << 2;
+						t_A = (Read(a_Data, 4) << 32) | Read(a_Data + t_Offset, 4);
+						t_B = (Read(a_Data + a_Size - 4, 4) << 32) | Read(a_Data + a_Size - 4 - t_Offset, 4);
+					}
+					else if (a_Size > 0)
+					{
+						t_A = (static_cast<uint64_t>(static_cast<uint8_t>(a_Data[0])) << 16) |
+							(static_cast<uint64_t>(static_cast<uint8_t>(a_Data[a_Size >> 1])) << 8) |
+							static_cast<uint64_t>(static_cast<uint8_t>(a_Data[a_Size - 1]));
+					}
+				}
+				else
+				{
+					const Char* t_Data = a_Data;
+					size_t t_Remaining = a_Size;
+					if (t_Remaining > 48)
+					{
+						//Three lanes without dependencies between them so the multiplies run in parallel.
+						uint64_t t_Lane1 = a_Seed;
+						uint64_t t_Lane2 = a_Seed;
+						do
+						{
+							a_Seed = Mix(Read(t_Data, 8) ^ HASH_SECRET[1], Read(t_Data + 8, 8) ^ a_Seed);
+							t_Lane1 = Mix(Read(t_Data + 16, 8) ^ HASH_SECRET[2], Read(t_Data + 24, 8) ^ t_Lane1);
+							t_Lane2 = Mix(Read(t_Data + 32, 8) ^ HASH_SECRET[3], Read(t_Data + 40, 8) ^ t_Lane2);
+							t_Data += 48;
+							t_Remaining -= 48;
+						} while (t_Remaining > 48);
+						a_Seed ^= t_Lane1 ^ t_Lane2;
+					}
+					while (t_Remaining > 16)
+					{
+						a_Seed = Mix(Read(t_Data, 8) ^ HASH_SECRET[1], Read(t_Data + 8, 8) ^ a_Seed);
+						t_Data += 16;
+						t_Remaining -= 16;
+					}
+					//The last 16 bytes, these overlap with bytes that were already mixed in.
+					t_A = Read(t_Data + t_Remaining - 16, 8);
+					t_B = Read(t_Data + t_Remaining - 8, 8);
+				}
+
+				t_A ^= HASH_SECRET[1];
+				t_B ^= a_Seed;
+				Multiply128(t_A, t_B);
+				return Mix(t_A ^ HASH_SECRET[0] ^ a_Size, t_B ^ HASH_SECRET[1]);
+			}
+		}
+
+		/// <summary>
+		/// Hash a buffer of bytes.
+		/// </summary>
+		inline uint64_t HashBytes(const void* a_Data, const size_t a_Size, const uint64_t a_Seed = 0)
+		{
+			return Internal::HashBytes(reinterpret_cast<const uint8_t*>(a_Data), a_Size, a_Seed);
+		}
+
+		/// <summary>
+		/// Hash a string without the null terminator, the same as HashBytes over the characters.
+		/// </summary>
+		constexpr uint64_t HashString(const char* a_String, const size_t a_Length, const uint64_t a_Seed = 0)
+		{
+			return Internal::HashBytes(a_String, a_Length, a_Seed);
+		}
+
+		/// <summary>
+		/// Hash a null terminated string, use it in a constexpr variable to hash a literal at compile time.
+		/// </summary>
+		constexpr uint64_t HashString(const char* a_String)
+		{
+			size_t t_Length = 0;
+			while (a_String[t_Length] != '\0')
+				++t_Length;
+			return HashString(a_String, t_Length);
+		}
+
+		/// <summary>
+		/// Mix the bits of an integer key, every input bit changes about half of the output bits.
+		/// 0 does not hash to 0 and keys that only differ in their high bits (like aligned pointers) still spread over every bucket.
+		/// </summary>
+		constexpr uint64_t MixInteger(uint64_t a_Value)
+		{
+			a_Value += 0x9E3779B97F4A7C15ull;
+			a_Value = (a_Value ^ (a_Value >> 30)) * 0xBF58476D1CE4E5B9ull;
+			a_Value = (a_Value ^ (a_Value >> 27)) * 0x94D049BB133111EBull;
+			return a_Value ^ (a_Value >> 31);
+		}
+
+		namespace Literals
+		{
+			/// <summary>
+			/// "path"_hash is hashed at compile time and is equal to HashString("path").
+			/// </summary>
+			constexpr uint64_t operator""_hash(const char* a_String, const size_t a_Length)
+			{
+				return HashString(a_String, a_Length);
+			}
+		}
+	}
+}
 
 //will remove this, I don't like it.
 //Maybe a unified hash is cringe and I should just have some basic hashing operations in this file.
@@ -19,6 +197,8 @@ struct Hash
 	static Hash MakeHash(size_t a_Value);
 	static Hash MakeHash(const char* a_Value);
 	static Hash MakeHash(void* a_Value);
+	//Defined in StringID.h.
+	static Hash MakeHash(const BB::StringID a_Value);
 
 private:
 
@@ -26,27 +206,15 @@ private:
 
 inline Hash Hash::MakeHash(size_t a_Value)
 {
-	a_Value ^= a_Value << 13, a_Value ^= a_Value >> 17;
-	a_Value ^= a_Value << 5;
-	return Hash(a_Value);
+	return Hash(BB::Hashing::MixInteger(a_Value));
 }
 
 inline Hash Hash::MakeHash(void* a_Value)
 {
-	uintptr_t t_Value = reinterpret_cast<uintptr_t>(a_Value);
-
-	t_Value ^= t_Value << 13, t_Value ^= t_Value >> 17;
-	t_Value ^= t_Value << 5;
-	return Hash(t_Value);
+	return Hash(BB::Hashing::MixInteger(reinterpret_cast<uintptr_t>(a_Value)));
 }
 
 inline Hash Hash::MakeHash(const char* a_Value)
 {
-	uint64_t t_Hash = 5381;
-	int t_C;
-
-	while (t_C = *a_Value++)
-		t_Hash = ((t_Hash << 5) + t_Hash) + t_C;
-
-	return Hash(t_Hash);
-}
\ No newline at end of file
+	return Hash(BB::Hashing::HashString(a_Value));
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "Utils/Hash.h"
+
+namespace BB
+{
+	//32 bit id of an interned string. The id is made from the hash of the string so it is the same every run
+	//and a literal can be turned into an id at compile time, after that comparing names is an integer compare.
+	//0 is never a valid id.
+	struct StringID
+	{
+		uint32_t id = 0;
+
+		constexpr bool IsValid() const { return id != 0; }
+		constexpr bool operator==(const StringID a_Rhs) const { return id == a_Rhs.id; }
+		constexpr bool operator!=(const StringID a_Rhs) const { return id != a_Rhs.id; }
+	};
+
+	/// <summary>
+	/// Make the id of a string without interning it, this does not check for collisions.
+	/// </summary>
+	constexpr StringID MakeStringID(const char* a_String, const size_t a_Length)
+	{
+		const uint64_t t_Hash = Hashing::HashString(a_String, a_Length);
+		const uint32_t t_ID = static_cast<uint32_t>(t_Hash ^ (t_Hash >> 32));
+		return StringID{ t_ID == 0 ? 1u : t_ID };
+	}
+
+	constexpr StringID MakeStringID(const char* a_String)
+	{
+		size_t t_Length = 0;
+		while (a_String[t_Length] != '\0')
+			++t_Length;
+		return MakeStringID(a_String, t_Length);
+	}
+
+	/// <summary>
+	/// "scene"_sid is made at compile time and is equal to the id InternString("scene") returns.
+	/// </summary>
+	constexpr StringID operator""_sid(const char* a_String, const size_t a_Length)
+	{
+		return MakeStringID(a_String, a_Length);
+	}
+
+	/// <summary>
+	/// Add a string to the global string table and get it's id. Thread safe and lock free.
+	/// The table keeps a copy of the string until the program ends, interning the same string again returns the same id and copy.
+	/// When a different string already has the same id, or the table is out of memory, it logs an error and returns an invalid StringID, also in release.
+	/// </summary>
+	/// <param name="a_String:"> The string to intern, a nullptr gives an invalid StringID. </param>
+	StringID InternString(const char* a_String);
+	/// <param name="a_Length:"> The length of a_String without the null terminator, a_String does not need to be null terminated. </param>
+	StringID InternString(const char* a_String, const size_t a_Length);
+	/// <summary>
+	/// Get the interned copy of a string, returns nullptr if no string with this id is interned.
+	/// </summary>
+	const char* GetInternedString(const StringID a_ID);
+	//How many strings are in the global string table.
+	uint32_t GetInternedStringCount();
+	//How many times InternString found a different string with the same id, this is also counted in release.
+	uint32_t GetStringIDCollisionCount();
+}
+
+inline Hash Hash::MakeHash(const BB::StringID a_Value)
+{
+	//The id already is a hash, but only 32 bits of it. Mix it so the hashmaps that use the top bits get a good value too.
+	return Hash(BB::Hashing::MixInteger(a_Value.id));
+}
@@ -5,24 +5,50 @@
 #include <cstring>
 
 #include <cwchar>
+#ifdef _WIN32
+#include <intrin.h>
+#endif //_WIN32
 
 namespace BB
 {
 	namespace Memory	
 	{
 
-		void MemCpy(void* __restrict  a_Destination, const void* __restrict  a_Source, size_t a_Size);
-		void MemCpySIMD128(void* __restrict  a_Destination, const void* __restrict  a_Source, size_t a_Size);
-		void MemCpySIMD256(void* __restrict  a_Destination, const void* __restrict  a_Source, size_t a_Size);
-		
-		void MemSet(void* __restrict  a_Destination, const int32_t a_Value, size_t a_Size);
-		void MemSetSIMD128(void* __restrict a_Destination, const int32_t a_Value, size_t a_Size);
-		void MemSetSIMD256(void* __restrict  a_Destination, const int32_t a_Value, size_t a_Size);
+		enum class SIMD_LEVEL : uint32_t
+		{
+			SSE2, //Every x64 CPU has it.
+			AVX2,
+			AVX512 //AVX-512 F and BW.
+		};
+
+		//The widest instruction set the CPU and OS support, read with CPUID the first time it's needed.
+		SIMD_LEVEL GetSIMDLevel();
+
+		//Copies from this size go past the cache with MemCpy, they would only push everything else out of it.
+		constexpr const size_t MEMCPY_STREAM_THRESHOLD = 1024 * 1024 * 4;
+
+		//MemCpy, MemSet and MemCmp pick the widest version the CPU supports.
+		//Small sizes and the tails are done with overlapping loads and stores instead of byte loops.
+		void MemCpy(void* __restrict a_Destination, const void* __restrict a_Source, size_t a_Size);
+		//MemCpy with non-temporal stores, use it for write-combined memory like an UploadBuffer that the CPU never reads back.
+		void MemCpyStream(void* __restrict a_Destination, const void* __restrict a_Source, size_t a_Size);
+		//Sets every byte to the lowest byte of a_Value, same as memset.
+		void MemSet(void* __restrict a_Destination, const int32_t a_Value, size_t a_Size);
+		//Returns true when the memory is equal.
+		bool MemCmp(const void* __restrict a_Left, const void* __restrict a_Right, size_t a_Size);
+
+		//Fixed versions, only call the 256 and 512 versions when GetSIMDLevel says the CPU has them.
+		void MemCpySIMD128(void* __restrict a_Destination, const void* __restrict a_Source, size_t a_Size);
+		void MemCpySIMD256(void* __restrict a_Destination, const void* __restrict a_Source, size_t a_Size);
+		void MemCpySIMD512(void* __restrict a_Destination, const void* __restrict a_Source, size_t a_Size);
 
-		bool MemCmp(const void* __restrict  a_Left, const void* __restrict  a_Right, size_t a_Size);
-		bool MemCmpSIMD128(const void* __restrict  a_Left, const void* __restrict  a_Right, size_t a_Size);
-		bool MemCmpSIMD256(const void* __restrict  a_Left, const void* __restrict  a_Right, size_t a_Size);
+		void MemSetSIMD128(void* __restrict a_Destination, const int32_t a_Value, size_t a_Size);
+		void MemSetSIMD256(void* __restrict a_Destination, const int32_t a_Value, size_t a_Size);
+		void MemSetSIMD512(void* __restrict a_Destination, const int32_t a_Value, size_t a_Size);
 
+		bool MemCmpSIMD128(const void* __restrict a_Left, const void* __restrict a_Right, size_t a_Size);
+		bool MemCmpSIMD256(const void* __restrict a_Left, const void* __restrict a_Right, size_t a_Size);
+		bool MemCmpSIMD512(const void* __restrict a_Left, const void* __restrict a_Right, size_t a_Size);
 
 		/// <summary>
 		/// Memcpy abstraction that will call the constructor if needed.
@@ -162,6 +188,34 @@ namespace BB
 		{
 			return ((a_NumToRound + a_Multiple - 1) / a_Multiple) * a_Multiple;
 		}
+
+		/// <summary>
+		/// Index of the lowest set bit, a_Value must not be 0.
+		/// </summary>
+		inline static uint32_t FindFirstSetBit(const uint64_t a_Value)
+		{
+#ifdef _WIN32
+			unsigned long t_Index;
+			_BitScanForward64(&t_Index, a_Value);
+			return static_cast<uint32_t>(t_Index);
+#else
+			return static_cast<uint32_t>(__builtin_ctzll(a_Value));
+#endif //_WIN32
+		}
+
+		/// <summary>
+		/// Index of the highest set bit, a_Value must not be 0.
+		/// </summary>
+		inline static uint32_t FindLastSetBit(const uint64_t a_Value)
+		{
+#ifdef _WIN32
+			unsigned long t_Index;
+			_BitScanReverse64(&t_Index, a_Value);
+			return static_cast<uint32_t>(t_Index);
+#else
+			return static_cast<uint32_t>(63 - __builtin_clzll(a_Value));
+#endif //_WIN32
+		}
 	}
 
 	namespace Random
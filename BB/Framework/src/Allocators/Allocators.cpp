@@ -1,4 +1,5 @@
 #include "Allocators.h"
+#include "HeapProfiler.h"
 #include "Utils/Utils.h"
 #include "Utils/Logger.h"
 
@@ -10,7 +11,7 @@
 using namespace BB;
 using namespace BB::allocators;
 #pragma region DEBUG_LOG
-
+#ifdef _DEBUG
 constexpr const uintptr_t MEMORY_BOUNDRY_CHECK_VALUE = 0xDEADBEEFDEADBEEF;
 enum class BOUNDRY_ERROR
 {
@@ -19,18 +20,6 @@ enum class BOUNDRY_ERROR
 	BACK
 };
 
-static BaseAllocator::AllocationLog* DeleteEntry(BaseAllocator::AllocationLog* a_Front, const BaseAllocator::AllocationLog* a_DeletedEntry)
-{
-	BaseAllocator::AllocationLog* t_Entry = a_Front;
-	while (t_Entry->prev != a_DeletedEntry)
-	{
-		t_Entry = t_Entry->prev;
-	}
-	t_Entry->prev = a_DeletedEntry->prev;
-
-	return a_Front;
-}
-
 //Checks Adds memory boundry to an allocation log.
 void* Memory_AddBoundries(void* a_Front, const size_t a_AllocSize)
 {
@@ -63,6 +52,9 @@ void* AllocDebug(BB_MEMORY_DEBUG BaseAllocator* a_Allocator, const size_t a_Size
 		Pointer::Add(a_AllocatedPtr, MEMORY_BOUNDRY_FRONT));
 
 	t_AllocLog->prev = a_Allocator->frontLog;
+	t_AllocLog->next = nullptr;
+	if (a_Allocator->frontLog != nullptr)
+		a_Allocator->frontLog->next = t_AllocLog;
 	t_AllocLog->front = a_AllocatedPtr;
 	t_AllocLog->back = Memory_AddBoundries(a_AllocatedPtr, a_Size);
 	t_AllocLog->allocSize = static_cast<uint32_t>(a_Size);
@@ -98,18 +90,27 @@ void* FreeDebug(BaseAllocator* a_Allocator, void* a_Ptr)
 
 	a_Ptr = Pointer::Subtract(a_Ptr, MEMORY_BOUNDRY_FRONT + sizeof(BaseAllocator::AllocationLog));
 
-	BaseAllocator::AllocationLog* t_FrontLog = a_Allocator->frontLog;
-
-	if (t_AllocLog != a_Allocator->frontLog)
-		DeleteEntry(t_FrontLog, t_AllocLog);
+	//Unlink the log, the front log has no next.
+	if (t_AllocLog->prev != nullptr)
+		t_AllocLog->prev->next = t_AllocLog->next;
+	if (t_AllocLog->next != nullptr)
+		t_AllocLog->next->prev = t_AllocLog->prev;
 	else
-		a_Allocator->frontLog = t_FrontLog->prev;
+		a_Allocator->frontLog = t_AllocLog->prev;
 
 	return a_Ptr;
 }
-
+#endif //_DEBUG
 #pragma endregion DEBUG
 
+BB::allocators::BaseAllocator::BaseAllocator(const char* a_Name)
+{
+	name = a_Name;
+#ifdef BB_HEAP_PROFILER
+	HeapProfiler::RegisterAllocator(this, a_Name);
+#endif //BB_HEAP_PROFILER
+}
+
 void BB::allocators::BaseAllocator::Validate() const
 {
 #ifdef _DEBUG
@@ -144,6 +145,9 @@ void BB::allocators::BaseAllocator::Validate() const
 
 void BB::allocators::BaseAllocator::Clear()
 {
+#ifdef BB_HEAP_PROFILER
+	HeapProfiler::OnClear(this);
+#endif //BB_HEAP_PROFILER
 #ifdef _DEBUG
 	while (frontLog != nullptr)
 	{
@@ -196,14 +200,16 @@ void* LinearAllocator::Alloc(size_t a_Size, size_t a_Alignment)
 	size_t t_Adjustment = Pointer::AlignForwardAdjustment(m_Buffer, a_Alignment);
 
 	uintptr_t t_Address = reinterpret_cast<uintptr_t>(Pointer::Add(m_Buffer, t_Adjustment));
-	m_Buffer = reinterpret_cast<void*>(t_Address + a_Size);
 
-	if (t_Address + a_Size > m_End)
+	//Keep doubling, a single allocation can be bigger then the whole allocator.
+	while (t_Address + a_Size > m_End)
 	{
 		size_t t_Increase = m_End - reinterpret_cast<uintptr_t>(m_Start);
-		mallocVirtual(m_Start, t_Increase);
+		if (mallocVirtual(m_Start, t_Increase) == nullptr)
+			return nullptr;
 		m_End += t_Increase;
 	}
+	m_Buffer = reinterpret_cast<void*>(t_Address + a_Size);
 
 	return reinterpret_cast<void*>(t_Address);
 }
@@ -296,13 +302,13 @@ void* FreelistRealloc(BB_MEMORY_DEBUG void* a_Allocator, size_t a_Size, const si
 	}
 };
 
-FreelistAllocator::FreelistAllocator(const size_t a_Size, const char* a_Name)
+FreelistAllocator::FreelistAllocator(const size_t a_Size, const char* a_Name, const VirtualMemoryOptions& a_VirtualOptions)
 	: BaseAllocator(a_Name)
 {
 	BB_ASSERT(a_Size != 0, "Freelist allocator is created with a size of 0!");
 	BB_WARNING(a_Size > 10240, "Freelist allocator is smaller then 10 kb, you generally want a bigger freelist.", WarningType::OPTIMALIZATION);
 	m_TotalAllocSize = a_Size;
-	m_Start = reinterpret_cast<uint8_t*>(mallocVirtual(nullptr, m_TotalAllocSize));
+	m_Start = reinterpret_cast<uint8_t*>(mallocVirtual(nullptr, m_TotalAllocSize, VIRTUAL_RESERVE_STANDARD, a_VirtualOptions));
 	m_FreeBlocks = reinterpret_cast<FreeBlock*>(m_Start);
 	m_FreeBlocks->size = m_TotalAllocSize;
 	m_FreeBlocks->next = nullptr;
@@ -371,6 +377,8 @@ void* FreelistAllocator::Alloc(size_t a_Size, size_t a_Alignment)
 	BB_WARNING(false, "Increasing the size of a freelist allocator, risk of fragmented memory.", WarningType::OPTIMALIZATION);
 	//Double the size of the freelist.
 	FreeBlock* t_NewAllocBlock = reinterpret_cast<FreeBlock*>(mallocVirtual(m_Start, m_TotalAllocSize));
+	if (t_NewAllocBlock == nullptr)
+		return nullptr;
 	t_NewAllocBlock->size = m_TotalAllocSize;
 	t_NewAllocBlock->next = m_FreeBlocks;
 
@@ -506,29 +514,32 @@ void* BB::allocators::POW_FreelistAllocator::Alloc(size_t a_Size, size_t)
 	{
 		FreeBlock* t_FreeBlock = t_FreeList->freeBlock;
 
-		FreeBlock* t_NewBlock = reinterpret_cast<FreeBlock*>(Pointer::Add(t_FreeList->freeBlock, t_FreeList->allocSize));
-		t_NewBlock->size = t_FreeBlock->size - t_FreeList->allocSize;
-		t_NewBlock->next = t_FreeBlock->next;
-
-		//If we cannot support enough memory for the next allocation, allocate more memory.
-		//The reasoning behind it is that it commits more memory in virtual alloc, which won't commit it to RAM yet.
-		//So there is no cost yet, until we write to it.
-		if (t_FreeBlock->size < t_FreeList->allocSize)
+		if (t_FreeBlock->size > t_FreeList->allocSize)
 		{
-			if (t_FreeBlock->next != nullptr && t_FreeList->freeBlock->size == 0)
-			{
-				t_FreeBlock = t_FreeBlock->next;
-			}
-			else
-			{
-				//double the size of the freelist, since the block that triggers this condition is always the end we will extend the current block.
-				mallocVirtual(t_FreeList->start, t_FreeList->fullSize);
-				t_FreeBlock->size += t_FreeList->fullSize;
-				t_FreeList->fullSize += t_FreeList->fullSize;
-			}
+			//Split the allocation off the front of the block.
+			FreeBlock* t_NewBlock = reinterpret_cast<FreeBlock*>(Pointer::Add(t_FreeBlock, t_FreeList->allocSize));
+			t_NewBlock->size = t_FreeBlock->size - t_FreeList->allocSize;
+			t_NewBlock->next = t_FreeBlock->next;
+			t_FreeList->freeBlock = t_NewBlock;
+		}
+		else if (t_FreeBlock->next != nullptr)
+		{
+			t_FreeList->freeBlock = t_FreeBlock->next;
+		}
+		else
+		{
+			//If we cannot support enough memory for the next allocation, allocate more memory.
+			//The reasoning behind it is that it commits more memory in virtual alloc, which won't commit it to RAM yet.
+			//So there is no cost yet, until we write to it.
+			size_t t_Increase = t_FreeList->fullSize;
+			FreeBlock* t_NewBlock = reinterpret_cast<FreeBlock*>(mallocVirtual(t_FreeList->start, t_Increase));
+			if (t_NewBlock == nullptr)
+				return nullptr;
+			t_NewBlock->size = t_Increase - t_Increase % t_FreeList->allocSize;
+			t_NewBlock->next = nullptr;
+			t_FreeList->fullSize += t_NewBlock->size;
+			t_FreeList->freeBlock = t_NewBlock;
 		}
-
-		t_FreeList->freeBlock = t_NewBlock;
 
 		//Place the freelist into the allocation so that it can go back to this.
 		reinterpret_cast<AllocHeader*>(t_FreeBlock)->freeList = t_FreeList;
@@ -565,6 +576,291 @@ void BB::allocators::POW_FreelistAllocator::Clear()
 	}
 }
 
+using TLSFBlock = TLSFAllocator::BlockHeader;
+//Used blocks only keep the prevPhysical and size.
+constexpr const size_t TLSF_BLOCK_OVERHEAD = sizeof(TLSFBlock*) + sizeof(size_t);
+constexpr const size_t TLSF_MIN_BLOCK_SIZE = sizeof(TLSFBlock);
+constexpr const size_t TLSF_BLOCK_FREE_BIT = 1;
+
+static inline size_t TLSFBlockSize(const TLSFBlock* a_Block)
+{
+	return a_Block->size & ~TLSF_BLOCK_FREE_BIT;
+}
+
+static inline bool TLSFBlockIsFree(const TLSFBlock* a_Block)
+{
+	return (a_Block->size & TLSF_BLOCK_FREE_BIT) != 0;
+}
+
+static inline TLSFBlock* TLSFNextPhysical(const TLSFBlock* a_Block)
+{
+	return reinterpret_cast<TLSFBlock*>(Pointer::Add(a_Block, TLSFBlockSize(a_Block)));
+}
+
+//Get the first and second level index of the list that a_Size belongs to.
+static inline void TLSFMappingInsert(const size_t a_Size, uint32_t& a_FL, uint32_t& a_SL)
+{
+	if (a_Size < TLSFAllocator::SMALL_BLOCK_SIZE)
+	{
+		a_FL = 0;
+		a_SL = static_cast<uint32_t>(a_Size / (TLSFAllocator::SMALL_BLOCK_SIZE / TLSFAllocator::SL_INDEX_COUNT));
+	}
+	else
+	{
+		const uint32_t t_LastBit = Math::FindLastSetBit(a_Size);
+		a_SL = static_cast<uint32_t>(a_Size >> (t_LastBit - TLSFAllocator::SL_INDEX_COUNT_LOG2)) ^ TLSFAllocator::SL_INDEX_COUNT;
+		a_FL = t_LastBit - (TLSFAllocator::FL_INDEX_SHIFT - 1);
+	}
+}
+
+//The size TLSFMappingSearch rounds a_Size up to, a free block needs to be at least this big to be found for a_Size.
+static inline size_t TLSFRoundSearchSize(const size_t a_Size)
+{
+	if (a_Size < TLSFAllocator::SMALL_BLOCK_SIZE)
+		return a_Size;
+	return a_Size + (1ull << (Math::FindLastSetBit(a_Size) - TLSFAllocator::SL_INDEX_COUNT_LOG2)) - 1;
+}
+
+//Same as TLSFMappingInsert but rounds up to the next list, so every block in that list is big enough.
+static inline void TLSFMappingSearch(const size_t a_Size, uint32_t& a_FL, uint32_t& a_SL)
+{
+	TLSFMappingInsert(TLSFRoundSearchSize(a_Size), a_FL, a_SL);
+}
+
+void* TLSFRealloc(BB_MEMORY_DEBUG void* a_Allocator, size_t a_Size, const size_t a_Alignment, void* a_Ptr)
+{
+	TLSFAllocator* t_TLSF = reinterpret_cast<TLSFAllocator*>(a_Allocator);
+	if (a_Size > 0)
+	{
+#ifdef _DEBUG
+		a_Size += MEMORY_BOUNDRY_FRONT + MEMORY_BOUNDRY_BACK + sizeof(BaseAllocator::AllocationLog);
+#endif //_DEBUG
+		void* t_AllocatedPtr = t_TLSF->Alloc(a_Size, a_Alignment);
+#ifdef _DEBUG
+		t_AllocatedPtr = AllocDebug(a_File, a_Line, t_TLSF, a_Size, t_AllocatedPtr);
+#endif //_DEBUG
+		return t_AllocatedPtr;
+	}
+	else
+	{
+#ifdef _DEBUG
+		a_Ptr = FreeDebug(t_TLSF, a_Ptr);
+#endif //_DEBUG
+		t_TLSF->Free(a_Ptr);
+		return nullptr;
+	}
+}
+
+TLSFAllocator::TLSFAllocator(const size_t a_Size, const char* a_Name)
+	: BaseAllocator(a_Name)
+{
+	BB_ASSERT(a_Size != 0, "TLSF allocator is created with a size of 0!");
+	m_TotalAllocSize = a_Size;
+	m_Start = reinterpret_cast<uint8_t*>(mallocVirtual(nullptr, m_TotalAllocSize));
+	Clear();
+}
+
+TLSFAllocator::~TLSFAllocator()
+{
+	Validate();
+	freeVirtual(m_Start);
+}
+
+TLSFAllocator::operator Allocator()
+{
+	Allocator t_AllocatorInterface;
+	t_AllocatorInterface.allocator = this;
+	t_AllocatorInterface.func = TLSFRealloc;
+	return t_AllocatorInterface;
+}
+
+void* TLSFAllocator::Alloc(size_t a_Size, size_t a_Alignment)
+{
+	size_t t_BlockSize = Math::RoundUp(a_Size + TLSF_BLOCK_OVERHEAD, ALIGN_SIZE);
+	if (t_BlockSize < TLSF_MIN_BLOCK_SIZE)
+		t_BlockSize = TLSF_MIN_BLOCK_SIZE;
+
+	//Bigger alignments need room to split off the unaligned front of a block.
+	size_t t_SearchSize = t_BlockSize;
+	if (a_Alignment > ALIGN_SIZE)
+		t_SearchSize += a_Alignment + TLSF_MIN_BLOCK_SIZE;
+
+	TLSFBlock* t_Block = FindFreeBlock(t_SearchSize);
+	if (t_Block == nullptr)
+	{
+		if (!Grow(t_SearchSize))
+			return nullptr;
+		t_Block = FindFreeBlock(t_SearchSize);
+		BB_ASSERT(t_Block != nullptr, "TLSF allocator failed to find a block after growing.");
+	}
+	RemoveFreeBlock(t_Block);
+
+	if (a_Alignment > ALIGN_SIZE)
+	{
+		size_t t_Gap = Pointer::AlignForwardAdjustment(Pointer::Add(t_Block, TLSF_BLOCK_OVERHEAD), a_Alignment);
+		//The front needs to be big enough to be a block on it's own.
+		if (t_Gap != 0 && t_Gap < TLSF_MIN_BLOCK_SIZE)
+			t_Gap += a_Alignment;
+
+		if (t_Gap != 0)
+		{
+			TLSFBlock* t_AlignedBlock = reinterpret_cast<TLSFBlock*>(Pointer::Add(t_Block, t_Gap));
+			t_AlignedBlock->prevPhysical = t_Block;
+			t_AlignedBlock->size = TLSFBlockSize(t_Block) - t_Gap;
+			TLSFNextPhysical(t_AlignedBlock)->prevPhysical = t_AlignedBlock;
+
+			t_Block->size = t_Gap;
+			ReleaseBlock(t_Block);
+			t_Block = t_AlignedBlock;
+		}
+	}
+
+	//Split off the back if it's big enough to be a block.
+	const size_t t_FullSize = TLSFBlockSize(t_Block);
+	if (t_FullSize >= t_BlockSize + TLSF_MIN_BLOCK_SIZE)
+	{
+		TLSFBlock* t_Remainder = reinterpret_cast<TLSFBlock*>(Pointer::Add(t_Block, t_BlockSize));
+		t_Remainder->prevPhysical = t_Block;
+		t_Remainder->size = t_FullSize - t_BlockSize;
+		TLSFNextPhysical(t_Remainder)->prevPhysical = t_Remainder;
+		t_Block->size = t_BlockSize;
+		ReleaseBlock(t_Remainder);
+	}
+
+	return Pointer::Add(t_Block, TLSF_BLOCK_OVERHEAD);
+}
+
+void TLSFAllocator::Free(void* a_Ptr)
+{
+	BB_ASSERT(a_Ptr != nullptr, "Nullptr send to TLSFAllocator::Free!.");
+	TLSFBlock* t_Block = reinterpret_cast<TLSFBlock*>(Pointer::Subtract(a_Ptr, TLSF_BLOCK_OVERHEAD));
+	BB_ASSERT(!TLSFBlockIsFree(t_Block), "Double free on a TLSF allocator!");
+	ReleaseBlock(t_Block);
+}
+
+void TLSFAllocator::Clear()
+{
+	BaseAllocator::Clear();
+	m_FLBitmap = 0;
+	memset(m_SLBitmap, 0, sizeof(m_SLBitmap));
+	memset(m_FreeBlocks, 0, sizeof(m_FreeBlocks));
+
+	//One block over all the memory, minus the sentinel at the end.
+	const size_t t_UsableSize = m_TotalAllocSize & ~(ALIGN_SIZE - 1);
+	m_Sentinel = reinterpret_cast<TLSFBlock*>(m_Start + t_UsableSize - TLSF_BLOCK_OVERHEAD);
+	TLSFBlock* t_Block = reinterpret_cast<TLSFBlock*>(m_Start);
+	t_Block->prevPhysical = nullptr;
+	t_Block->size = t_UsableSize - TLSF_BLOCK_OVERHEAD;
+	m_Sentinel->prevPhysical = t_Block;
+	m_Sentinel->size = 0;
+	ReleaseBlock(t_Block);
+}
+
+void TLSFAllocator::InsertFreeBlock(BlockHeader* a_Block)
+{
+	uint32_t t_FL, t_SL;
+	TLSFMappingInsert(TLSFBlockSize(a_Block), t_FL, t_SL);
+	BlockHeader* t_Head = m_FreeBlocks[t_FL][t_SL];
+	a_Block->nextFree = t_Head;
+	a_Block->prevFree = nullptr;
+	if (t_Head != nullptr)
+		t_Head->prevFree = a_Block;
+	m_FreeBlocks[t_FL][t_SL] = a_Block;
+	m_FLBitmap |= 1u << t_FL;
+	m_SLBitmap[t_FL] |= 1u << t_SL;
+}
+
+void TLSFAllocator::RemoveFreeBlock(BlockHeader* a_Block)
+{
+	uint32_t t_FL, t_SL;
+	TLSFMappingInsert(TLSFBlockSize(a_Block), t_FL, t_SL);
+	if (a_Block->nextFree != nullptr)
+		a_Block->nextFree->prevFree = a_Block->prevFree;
+	if (a_Block->prevFree != nullptr)
+		a_Block->prevFree->nextFree = a_Block->nextFree;
+	else
+	{
+		m_FreeBlocks[t_FL][t_SL] = a_Block->nextFree;
+		if (a_Block->nextFree == nullptr)
+		{
+			m_SLBitmap[t_FL] &= ~(1u << t_SL);
+			if (m_SLBitmap[t_FL] == 0)
+				m_FLBitmap &= ~(1u << t_FL);
+		}
+	}
+	a_Block->size &= ~TLSF_BLOCK_FREE_BIT;
+}
+
+TLSFAllocator::BlockHeader* TLSFAllocator::FindFreeBlock(const size_t a_Size)
+{
+	uint32_t t_FL, t_SL;
+	TLSFMappingSearch(a_Size, t_FL, t_SL);
+	if (t_FL >= FL_INDEX_COUNT)
+		return nullptr;
+
+	//First look for a big enough list in the same first level, else go to the next used first level.
+	uint32_t t_SLMap = m_SLBitmap[t_FL] & (~0u << t_SL);
+	if (t_SLMap == 0)
+	{
+		const uint32_t t_FLMap = t_FL + 1 < FL_INDEX_COUNT ? m_FLBitmap & (~0u << (t_FL + 1)) : 0;
+		if (t_FLMap == 0)
+			return nullptr;
+
+		t_FL = Math::FindFirstSetBit(t_FLMap);
+		t_SLMap = m_SLBitmap[t_FL];
+	}
+	t_SL = Math::FindFirstSetBit(t_SLMap);
+	return m_FreeBlocks[t_FL][t_SL];
+}
+
+void TLSFAllocator::ReleaseBlock(BlockHeader* a_Block)
+{
+	BlockHeader* t_Prev = a_Block->prevPhysical;
+	if (t_Prev != nullptr && TLSFBlockIsFree(t_Prev))
+	{
+		RemoveFreeBlock(t_Prev);
+		t_Prev->size += TLSFBlockSize(a_Block);
+		a_Block = t_Prev;
+	}
+
+	BlockHeader* t_Next = TLSFNextPhysical(a_Block);
+	if (TLSFBlockIsFree(t_Next))
+	{
+		RemoveFreeBlock(t_Next);
+		a_Block->size = TLSFBlockSize(a_Block) + TLSFBlockSize(t_Next);
+		t_Next = TLSFNextPhysical(a_Block);
+	}
+	t_Next->prevPhysical = a_Block;
+
+	a_Block->size |= TLSF_BLOCK_FREE_BIT;
+	InsertFreeBlock(a_Block);
+}
+
+bool TLSFAllocator::Grow(const size_t a_MinimumSize)
+{
+	BB_WARNING(false, "Increasing the size of a TLSF allocator.", WarningType::OPTIMALIZATION);
+	//At least double the size, the old sentinel becomes the header of the new block.
+	//The new block must be big enough for the size class FindFreeBlock searches, not just for a_MinimumSize.
+	size_t t_Increase = m_TotalAllocSize;
+	const size_t t_SearchSize = TLSFRoundSearchSize(a_MinimumSize) + TLSF_BLOCK_OVERHEAD;
+	if (t_Increase < t_SearchSize)
+		t_Increase = t_SearchSize;
+
+	void* t_NewRange = mallocVirtual(m_Start, t_Increase);
+	if (t_NewRange == nullptr)
+		return false;
+	void* t_NewEnd = Pointer::Add(t_NewRange, t_Increase);
+	m_TotalAllocSize = reinterpret_cast<uintptr_t>(t_NewEnd) - reinterpret_cast<uintptr_t>(m_Start);
+
+	TLSFBlock* t_Block = m_Sentinel;
+	m_Sentinel = reinterpret_cast<TLSFBlock*>(Pointer::Subtract(t_NewEnd, TLSF_BLOCK_OVERHEAD));
+	t_Block->size = reinterpret_cast<uintptr_t>(m_Sentinel) - reinterpret_cast<uintptr_t>(t_Block);
+	m_Sentinel->prevPhysical = t_Block;
+	m_Sentinel->size = 0;
+	ReleaseBlock(t_Block);
+	return true;
+}
+
 //BB::allocators::PoolAllocator::PoolAllocator(const size_t a_ObjectSize, const size_t a_ObjectCount, const size_t a_Alignment)
 //{
 //	BB_ASSERT(a_ObjectSize != 0, "Pool allocator is created with an object size of 0!");
@@ -4,53 +4,165 @@
 #include "OS/Program.h"
 #include "Math.inl"
 
+#include <atomic>
+
 using namespace BB;
 
-struct VirtualHeader
+//16 byte aligned so the memory after the header keeps the alignment that SIMD types and the allocators expect.
+struct alignas(16) VirtualHeader
 {
+	//Bytes handed out by mallocVirtual, this includes the header.
 	size_t bytesCommited;
 	size_t bytesReserved;
+	//Bytes that are actually commited by the OS, can be ahead of bytesCommited.
+	size_t bytesCommitedOS;
+	//Every commit is a multiple of this.
+	size_t commitGranularity;
+	VIRTUAL_PAGE_TYPE pageType;
+	bool commitAhead;
 };
+static_assert(sizeof(VirtualHeader) % 16 == 0, "VirtualHeader must keep mallocVirtual 16 byte aligned.");
 
-void* BB::mallocVirtual(void* a_Start, size_t& a_Size, const size_t a_ReserveSize)
+struct VirtualMemoryCounters
 {
-	//Adjust the requested bytes by the page size and the minimum virtual allocaion size.
-	size_t t_PageAdjustedSize = Math::RoundUp(a_Size + sizeof(VirtualHeader), VirtualMemoryPageSize());
-	t_PageAdjustedSize = Max(t_PageAdjustedSize, VirtualMemoryMinimumAllocation());
+	std::atomic<size_t> reserveCount{ 0 };
+	std::atomic<size_t> commitCount{ 0 };
+	std::atomic<size_t> commitsAvoided{ 0 };
+	std::atomic<size_t> bytesReserved{ 0 };
+	std::atomic<size_t> bytesCommited{ 0 };
+	std::atomic<size_t> hugePageBytesCommited{ 0 };
+	std::atomic<size_t> pageFaultsAvoided{ 0 };
+};
+static VirtualMemoryCounters s_VirtualCounters;
 
-	//Set the reference of a_Size so that the allocator has enough memory until the end of the page.
-	a_Size = t_PageAdjustedSize - sizeof(VirtualHeader);
+//Commits up to a_NewCommitSize bytes from the start of the reservation, false if the OS has no memory left.
+static bool CommitOS(void* a_Reservation, VirtualHeader& a_Header, const size_t a_NewCommitSize)
+{
+	if (!CommitVirtualMemory(a_Reservation, a_NewCommitSize))
+	{
+		Logger::Log_Warning_High(__FILE__, __LINE__, "s", "Error commiting virtual memory, mallocVirtual returns a nullptr.");
+		return false;
+	}
+	const size_t t_Increase = a_NewCommitSize - a_Header.bytesCommitedOS;
+	a_Header.bytesCommitedOS = a_NewCommitSize;
 
+	s_VirtualCounters.commitCount.fetch_add(1, std::memory_order_relaxed);
+	s_VirtualCounters.bytesCommited.fetch_add(t_Increase, std::memory_order_relaxed);
+	if (a_Header.pageType != VIRTUAL_PAGE_TYPE::NORMAL)
+	{
+		s_VirtualCounters.hugePageBytesCommited.fetch_add(t_Increase, std::memory_order_relaxed);
+		s_VirtualCounters.pageFaultsAvoided.fetch_add(t_Increase / VirtualMemoryPageSize() - t_Increase / a_Header.commitGranularity, std::memory_order_relaxed);
+	}
+	return true;
+}
+
+void* BB::mallocVirtual(void* a_Start, size_t& a_Size, const size_t a_ReserveSize, const VirtualMemoryOptions& a_Options)
+{
+	const size_t t_RequestedSize = a_Size;
 	//Check the pageHeader
 	if (a_Start != nullptr)
 	{
 		//Get the header for preperation to resize it.
 		VirtualHeader* t_PageHeader = reinterpret_cast<VirtualHeader*>(Pointer::Subtract(a_Start, sizeof(VirtualHeader)));
 
+		//Adjust the requested bytes by the commit size of the reservation.
+		const size_t t_PageAdjustedSize = Math::RoundUp(a_Size, t_PageHeader->commitGranularity);
+		a_Size = t_PageAdjustedSize;
+
 		//Commit more memory if there is enough reserved.
 		if (t_PageHeader->bytesReserved > t_PageAdjustedSize + t_PageHeader->bytesCommited)
 		{
 			void* t_NewCommitRange = Pointer::Add(t_PageHeader, t_PageHeader->bytesCommited);
-
 			t_PageHeader->bytesCommited += t_PageAdjustedSize;
-			BB_ASSERT(CommitVirtualMemory(t_PageHeader, t_PageHeader->bytesCommited) != 0, "Error commiting virtual memory");
+
+			if (t_PageHeader->bytesCommited <= t_PageHeader->bytesCommitedOS)
+			{
+				s_VirtualCounters.commitsAvoided.fetch_add(1, std::memory_order_relaxed);
+				return t_NewCommitRange;
+			}
+
+			size_t t_NewCommitSize = t_PageHeader->bytesCommited;
+			if (t_PageHeader->commitAhead)
+			{
+				//Grow by what is already commited so the next resizes do not need the OS.
+				const size_t t_Ahead = Min(t_PageHeader->bytesCommitedOS, VIRTUAL_COMMIT_AHEAD_MAX);
+				t_NewCommitSize = Max(t_NewCommitSize, Math::RoundUp(t_PageHeader->bytesCommitedOS + t_Ahead, t_PageHeader->commitGranularity));
+				t_NewCommitSize = Min(t_NewCommitSize, t_PageHeader->bytesReserved);
+			}
+			if (!CommitOS(t_PageHeader, *t_PageHeader, t_NewCommitSize))
+			{
+				t_PageHeader->bytesCommited -= t_PageAdjustedSize;
+				return nullptr;
+			}
 			return t_NewCommitRange;
 		}
 
-		BB_ASSERT(false, "Going over reserved memory! Make sure to reserve more memory");
+		//A new reservation would not be contiguous with a_Start, so the caller has to handle it.
+		Logger::Log_Warning_High(__FILE__, __LINE__, "s", "Going over reserved memory! Make sure to reserve more memory, mallocVirtual returns a nullptr.");
+		return nullptr;
+	}
+
+	//Huge pages are committed in huge page steps, fall back to normal pages if the OS has none.
+	VIRTUAL_PAGE_TYPE t_PageType = a_Options.pageType;
+	size_t t_Granularity = VirtualMemoryPageSize();
+	if (t_PageType != VIRTUAL_PAGE_TYPE::NORMAL)
+	{
+		const size_t t_HugePageSize = VirtualMemoryHugePageSize();
+		if (t_HugePageSize != 0)
+			t_Granularity = t_HugePageSize;
+		else
+			t_PageType = VIRTUAL_PAGE_TYPE::NORMAL;
 	}
 
-	//When making a new header reserve a lot more then that is requested to support later resizes better.
-	size_t t_AdditionalReserve = t_PageAdjustedSize * a_ReserveSize;
-	void* t_Address = ReserveVirtualMemory(t_AdditionalReserve);
-	BB_ASSERT(t_Address != NULL, "Error reserving virtual memory");
+	//Adjust the requested bytes by the page size and the minimum virtual allocaion size.
+	size_t t_PageAdjustedSize = Math::RoundUp(a_Size + sizeof(VirtualHeader), t_Granularity);
+	t_PageAdjustedSize = Max(t_PageAdjustedSize, Math::RoundUp(VirtualMemoryMinimumAllocation(), t_Granularity));
+
+	//Set the reference of a_Size so that the allocator has enough memory until the end of the page.
+	a_Size = t_PageAdjustedSize - sizeof(VirtualHeader);
 
-	//Now commit enough memory that the user requested.
-	BB_ASSERT(CommitVirtualMemory(t_Address, t_PageAdjustedSize) != NULL, "Error commiting right after a reserve virtual memory");
+	//When making a new header reserve a lot more then that is requested to support later resizes better, but not more then VIRTUAL_RESERVE_MAX_SIZE.
+	size_t t_AdditionalReserve = Max(t_PageAdjustedSize, Math::RoundUp(Min(t_PageAdjustedSize * a_ReserveSize, VIRTUAL_RESERVE_MAX_SIZE), t_Granularity));
+	void* t_Address = ReserveVirtualMemory(t_AdditionalReserve, t_PageType, a_Options.numaNode);
+	//Out of address space, try to reserve less until only the requested size is left.
+	while (t_Address == nullptr && t_AdditionalReserve > t_PageAdjustedSize)
+	{
+		t_AdditionalReserve = Max(t_PageAdjustedSize, Math::RoundUp(t_AdditionalReserve / 2, t_Granularity));
+		t_Address = ReserveVirtualMemory(t_AdditionalReserve, t_PageType, a_Options.numaNode);
+	}
+
+	if (t_Address == nullptr)
+	{
+		if (t_PageType != VIRTUAL_PAGE_TYPE::NORMAL)
+		{
+			//Huge pages waste the most space at the end of a reservation, try again with normal pages.
+			VirtualMemoryOptions t_NormalOptions = a_Options;
+			t_NormalOptions.pageType = VIRTUAL_PAGE_TYPE::NORMAL;
+			a_Size = t_RequestedSize;
+			return mallocVirtual(nullptr, a_Size, a_ReserveSize, t_NormalOptions);
+		}
+		Logger::Log_Warning_High(__FILE__, __LINE__, "s", "Error reserving virtual memory, mallocVirtual returns a nullptr.");
+		return nullptr;
+	}
 
 	//Set the header of the allocator, used for later resizes and when you need to free it.
-	reinterpret_cast<VirtualHeader*>(t_Address)->bytesCommited = t_PageAdjustedSize;
-	reinterpret_cast<VirtualHeader*>(t_Address)->bytesReserved = t_AdditionalReserve;
+	VirtualHeader t_Header;
+	t_Header.bytesCommited = t_PageAdjustedSize;
+	t_Header.bytesReserved = t_AdditionalReserve;
+	t_Header.bytesCommitedOS = 0;
+	t_Header.commitGranularity = t_Granularity;
+	t_Header.pageType = t_PageType;
+	t_Header.commitAhead = a_Options.commitAhead;
+
+	//Now commit enough memory that the user requested, the header can only be written after that.
+	if (!CommitOS(t_Address, t_Header, t_PageAdjustedSize))
+	{
+		BB_ASSERT(ReleaseVirtualMemory(t_Address, t_AdditionalReserve) != 0, "Error on releasing virtual memory");
+		return nullptr;
+	}
+	s_VirtualCounters.reserveCount.fetch_add(1, std::memory_order_relaxed);
+	s_VirtualCounters.bytesReserved.fetch_add(t_AdditionalReserve, std::memory_order_relaxed);
+	*reinterpret_cast<VirtualHeader*>(t_Address) = t_Header;
 
 	//Return the pointer that does not include the StartPageHeader
 	return Pointer::Add(t_Address, sizeof(VirtualHeader));
@@ -58,7 +170,26 @@ void* BB::mallocVirtual(void* a_Start, size_t& a_Size, const size_t a_ReserveSiz
 
 void BB::freeVirtual(void* a_Ptr)
 {
-	BB_ASSERT(ReleaseVirtualMemory(Pointer::Subtract(a_Ptr, sizeof(VirtualHeader))) != 0, "Error on releasing virtual memory");
+	const VirtualHeader* t_PageHeader = reinterpret_cast<const VirtualHeader*>(Pointer::Subtract(a_Ptr, sizeof(VirtualHeader)));
+	s_VirtualCounters.bytesReserved.fetch_sub(t_PageHeader->bytesReserved, std::memory_order_relaxed);
+	s_VirtualCounters.bytesCommited.fetch_sub(t_PageHeader->bytesCommitedOS, std::memory_order_relaxed);
+	if (t_PageHeader->pageType != VIRTUAL_PAGE_TYPE::NORMAL)
+		s_VirtualCounters.hugePageBytesCommited.fetch_sub(t_PageHeader->bytesCommitedOS, std::memory_order_relaxed);
+
+	BB_ASSERT(ReleaseVirtualMemory(Pointer::Subtract(a_Ptr, sizeof(VirtualHeader)), t_PageHeader->bytesReserved) != 0, "Error on releasing virtual memory");
+}
+
+VirtualMemoryStats BB::GetVirtualMemoryStats()
+{
+	VirtualMemoryStats t_Stats;
+	t_Stats.reserveCount = s_VirtualCounters.reserveCount.load(std::memory_order_relaxed);
+	t_Stats.commitCount = s_VirtualCounters.commitCount.load(std::memory_order_relaxed);
+	t_Stats.commitsAvoided = s_VirtualCounters.commitsAvoided.load(std::memory_order_relaxed);
+	t_Stats.bytesReserved = s_VirtualCounters.bytesReserved.load(std::memory_order_relaxed);
+	t_Stats.bytesCommited = s_VirtualCounters.bytesCommited.load(std::memory_order_relaxed);
+	t_Stats.hugePageBytesCommited = s_VirtualCounters.hugePageBytesCommited.load(std::memory_order_relaxed);
+	t_Stats.pageFaultsAvoided = s_VirtualCounters.pageFaultsAvoided.load(std::memory_order_relaxed);
+	return t_Stats;
 }
 
 //#pragma region Unit Test
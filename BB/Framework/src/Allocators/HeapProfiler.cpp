@@ -0,0 +1,457 @@
+#include "HeapProfiler.h"
+#include "ScratchAllocator.h"
+#include "OS/Program.h"
+
+#include <atomic>
+#include <mutex>
+#include <cstring>
+
+using namespace BB;
+
+static_assert(HEAP_PROFILER_MAX_CALL_SITES <= UINT16_MAX, "Call site indices are stored in 16 bits.");
+static_assert(HEAP_PROFILER_MAX_ALLOCATORS <= UINT8_MAX + 1 && HEAP_PROFILER_MAX_TAGS <= UINT8_MAX + 1, "Allocator and tag indices are stored in 8 bits.");
+
+//Placed right before the pointer that is returned.
+struct HeapProfilerHeader
+{
+	uint64_t size;
+	uint16_t callSite;
+	uint8_t allocator;
+	uint8_t tag;
+	//Bytes from the start of the allocation to the returned pointer.
+	uint32_t offset;
+};
+static_assert(sizeof(HeapProfilerHeader) == HEAP_PROFILER_HEADER_SIZE, "Heap profiler header size changed.");
+
+struct HeapCounters
+{
+	std::atomic<uint64_t> allocCount{ 0 };
+	std::atomic<uint64_t> freeCount{ 0 };
+	std::atomic<uint64_t> totalBytes{ 0 };
+	std::atomic<uint64_t> liveBytes{ 0 };
+	std::atomic<uint64_t> peakBytes{ 0 };
+};
+
+struct CallSiteEntry
+{
+	//Written last when the entry is added, nullptr means the slot is empty.
+	std::atomic<const char*> file{ nullptr };
+	int line = 0;
+	std::atomic<uint8_t> allocator{ 0 };
+	HeapCounters counters;
+};
+
+//Used for both the allocators and the tags, keyed by the pointer.
+struct PointerEntry
+{
+	std::atomic<const void*> key{ nullptr };
+	std::atomic<const char*> name{ nullptr };
+	HeapCounters counters;
+};
+
+struct HeapFrameCounters
+{
+	std::atomic<uint64_t> allocCount{ 0 };
+	std::atomic<uint64_t> freeCount{ 0 };
+	std::atomic<uint64_t> allocBytes{ 0 };
+	std::atomic<uint64_t> freeBytes{ 0 };
+};
+
+//Slot 0 of every table is the overflow slot, the hashed slots start at 1.
+static CallSiteEntry s_CallSites[HEAP_PROFILER_MAX_CALL_SITES];
+static PointerEntry s_Allocators[HEAP_PROFILER_MAX_ALLOCATORS];
+static PointerEntry s_Tags[HEAP_PROFILER_MAX_TAGS];
+//Lookups never lock, only adding a new entry does.
+static std::mutex s_InsertLock;
+
+static HeapFrameCounters s_CurrentFrame;
+static HeapProfileFrame s_FrameHistory[HEAP_PROFILER_FRAME_HISTORY];
+static uint64_t s_FrameNumber = 0;
+
+static uint64_t HashMix(uint64_t a_Value)
+{
+	a_Value ^= a_Value >> 33;
+	a_Value *= 0xff51afd7ed558ccdull;
+	a_Value ^= a_Value >> 33;
+	return a_Value;
+}
+
+static void AddLiveBytes(HeapCounters& a_Counters, const uint64_t a_Size)
+{
+	const uint64_t t_Live = a_Counters.liveBytes.fetch_add(a_Size, std::memory_order_relaxed) + a_Size;
+	uint64_t t_Peak = a_Counters.peakBytes.load(std::memory_order_relaxed);
+	while (t_Live > t_Peak && !a_Counters.peakBytes.compare_exchange_weak(t_Peak, t_Live, std::memory_order_relaxed));
+}
+
+static void AddAllocation(HeapCounters& a_Counters, const uint64_t a_Size)
+{
+	a_Counters.allocCount.fetch_add(1, std::memory_order_relaxed);
+	a_Counters.totalBytes.fetch_add(a_Size, std::memory_order_relaxed);
+	AddLiveBytes(a_Counters, a_Size);
+}
+
+static void RemoveAllocation(HeapCounters& a_Counters, const uint64_t a_Size)
+{
+	a_Counters.freeCount.fetch_add(1, std::memory_order_relaxed);
+	a_Counters.liveBytes.fetch_sub(a_Size, std::memory_order_relaxed);
+}
+
+#if defined(_DEBUG) || defined(BB_HEAP_PROFILER)
+static uint32_t FindCallSite(const char* a_File, const int a_Line)
+{
+	if (a_File == nullptr)
+		return 0;
+
+	constexpr const uint32_t t_SlotCount = HEAP_PROFILER_MAX_CALL_SITES - 1;
+	const uint32_t t_Start = static_cast<uint32_t>(HashMix(reinterpret_cast<uintptr_t>(a_File) ^ (static_cast<uint64_t>(a_Line) << 48)) % t_SlotCount);
+	for (uint32_t i = 0; i < t_SlotCount; i++)
+	{
+		CallSiteEntry& t_Entry = s_CallSites[(t_Start + i) % t_SlotCount + 1];
+		const char* t_File = t_Entry.file.load(std::memory_order_acquire);
+		if (t_File == a_File && t_Entry.line == a_Line)
+			return static_cast<uint32_t>(&t_Entry - s_CallSites);
+
+		if (t_File == nullptr)
+		{
+			std::lock_guard<std::mutex> t_Lock(s_InsertLock);
+			//Another thread might have taken the slot while we waited.
+			t_File = t_Entry.file.load(std::memory_order_relaxed);
+			if (t_File == nullptr)
+			{
+				t_Entry.line = a_Line;
+				t_Entry.file.store(a_File, std::memory_order_release);
+				return static_cast<uint32_t>(&t_Entry - s_CallSites);
+			}
+			if (t_File == a_File && t_Entry.line == a_Line)
+				return static_cast<uint32_t>(&t_Entry - s_CallSites);
+		}
+	}
+	return 0;
+}
+#endif //_DEBUG || BB_HEAP_PROFILER
+
+static uint32_t FindPointerEntry(PointerEntry* a_Table, const uint32_t a_TableSize, const void* a_Key, const bool a_Add)
+{
+	if (a_Key == nullptr)
+		return 0;
+
+	const uint32_t t_SlotCount = a_TableSize - 1;
+	const uint32_t t_Start = static_cast<uint32_t>(HashMix(reinterpret_cast<uintptr_t>(a_Key)) % t_SlotCount);
+	for (uint32_t i = 0; i < t_SlotCount; i++)
+	{
+		PointerEntry& t_Entry = a_Table[(t_Start + i) % t_SlotCount + 1];
+		const void* t_Key = t_Entry.key.load(std::memory_order_acquire);
+		if (t_Key == a_Key)
+			return static_cast<uint32_t>(&t_Entry - a_Table);
+
+		if (t_Key == nullptr)
+		{
+			if (!a_Add)
+				return 0;
+
+			std::lock_guard<std::mutex> t_Lock(s_InsertLock);
+			t_Key = t_Entry.key.load(std::memory_order_relaxed);
+			if (t_Key == nullptr)
+			{
+				t_Entry.key.store(a_Key, std::memory_order_release);
+				return static_cast<uint32_t>(&t_Entry - a_Table);
+			}
+			if (t_Key == a_Key)
+				return static_cast<uint32_t>(&t_Entry - a_Table);
+		}
+	}
+	return 0;
+}
+
+static HeapProfilerHeader* GetHeader(const void* a_Ptr)
+{
+	return reinterpret_cast<HeapProfilerHeader*>(Pointer::Subtract(a_Ptr, sizeof(HeapProfilerHeader)));
+}
+
+void* BB::HeapProfiler::Alloc(BB_MEMORY_DEBUG Allocator a_Allocator, const size_t a_Size, const size_t a_Alignment)
+{
+	//Keeps the returned pointer aligned, a_Alignment is always a power of 2.
+	//The header itself needs 8 byte alignment.
+	const size_t t_Alignment = a_Alignment > alignof(HeapProfilerHeader) ? a_Alignment : alignof(HeapProfilerHeader);
+	const size_t t_Offset = t_Alignment > HEAP_PROFILER_HEADER_SIZE ? t_Alignment : HEAP_PROFILER_HEADER_SIZE;
+	void* t_Start = a_Allocator.func(BB_MEMORY_DEBUG_SEND a_Allocator.allocator, a_Size + t_Offset, t_Alignment, nullptr);
+	void* t_Ptr = Pointer::Add(t_Start, t_Offset);
+
+#if defined(_DEBUG) || defined(BB_HEAP_PROFILER)
+	const uint32_t t_CallSite = FindCallSite(a_File, a_Line);
+#else
+	const uint32_t t_CallSite = 0;
+#endif
+	const uint32_t t_AllocatorIndex = FindPointerEntry(s_Allocators, HEAP_PROFILER_MAX_ALLOCATORS, a_Allocator.allocator, true);
+
+	HeapProfilerHeader* t_Header = GetHeader(t_Ptr);
+	t_Header->size = a_Size;
+	t_Header->callSite = static_cast<uint16_t>(t_CallSite);
+	t_Header->allocator = static_cast<uint8_t>(t_AllocatorIndex);
+	t_Header->tag = 0;
+	t_Header->offset = static_cast<uint32_t>(t_Offset);
+
+	CallSiteEntry& t_CallSiteEntry = s_CallSites[t_CallSite];
+	t_CallSiteEntry.allocator.store(static_cast<uint8_t>(t_AllocatorIndex), std::memory_order_relaxed);
+	AddAllocation(t_CallSiteEntry.counters, a_Size);
+	AddAllocation(s_Allocators[t_AllocatorIndex].counters, a_Size);
+	AddLiveBytes(s_Tags[0].counters, a_Size);
+
+	s_CurrentFrame.allocCount.fetch_add(1, std::memory_order_relaxed);
+	s_CurrentFrame.allocBytes.fetch_add(a_Size, std::memory_order_relaxed);
+	return t_Ptr;
+}
+
+void BB::HeapProfiler::Free(Allocator a_Allocator, void* a_Ptr)
+{
+	const HeapProfilerHeader t_Header = *GetHeader(a_Ptr);
+
+	RemoveAllocation(s_CallSites[t_Header.callSite].counters, t_Header.size);
+	RemoveAllocation(s_Allocators[t_Header.allocator].counters, t_Header.size);
+	s_Tags[t_Header.tag].counters.liveBytes.fetch_sub(t_Header.size, std::memory_order_relaxed);
+
+	s_CurrentFrame.freeCount.fetch_add(1, std::memory_order_relaxed);
+	s_CurrentFrame.freeBytes.fetch_add(t_Header.size, std::memory_order_relaxed);
+
+	a_Allocator.func(BB_MEMORY_DEBUG_FREE a_Allocator.allocator, 0, 0, Pointer::Subtract(a_Ptr, t_Header.offset));
+}
+
+void BB::HeapProfiler::TagAllocation(const void* a_Ptr, const char* a_TagName)
+{
+	HeapProfilerHeader* t_Header = GetHeader(a_Ptr);
+	const uint32_t t_Tag = FindPointerEntry(s_Tags, HEAP_PROFILER_MAX_TAGS, a_TagName, true);
+	if (t_Tag == t_Header->tag)
+		return;
+
+	if (t_Tag != 0)
+		s_Tags[t_Tag].name.store(a_TagName, std::memory_order_relaxed);
+	s_Tags[t_Header->tag].counters.liveBytes.fetch_sub(t_Header->size, std::memory_order_relaxed);
+	AddLiveBytes(s_Tags[t_Tag].counters, t_Header->size);
+	t_Header->tag = static_cast<uint8_t>(t_Tag);
+}
+
+void* BB::HeapProfiler::GetAllocationStart(const void* a_Ptr)
+{
+	return Pointer::Subtract(a_Ptr, GetHeader(a_Ptr)->offset);
+}
+
+void BB::HeapProfiler::RegisterAllocator(const void* a_Allocator, const char* a_Name)
+{
+	const uint32_t t_Index = FindPointerEntry(s_Allocators, HEAP_PROFILER_MAX_ALLOCATORS, a_Allocator, true);
+	//The overflow slot has no single name.
+	if (t_Index != 0)
+		s_Allocators[t_Index].name.store(a_Name, std::memory_order_relaxed);
+}
+
+void BB::HeapProfiler::OnClear(const void* a_Allocator)
+{
+	const uint32_t t_Index = FindPointerEntry(s_Allocators, HEAP_PROFILER_MAX_ALLOCATORS, a_Allocator, false);
+	if (t_Index != 0)
+		s_Allocators[t_Index].counters.liveBytes.store(0, std::memory_order_relaxed);
+}
+
+void BB::HeapProfiler::NextFrame()
+{
+	HeapProfileFrame& t_Frame = s_FrameHistory[s_FrameNumber % HEAP_PROFILER_FRAME_HISTORY];
+	t_Frame.frameNumber = s_FrameNumber++;
+	t_Frame.allocCount = s_CurrentFrame.allocCount.exchange(0, std::memory_order_relaxed);
+	t_Frame.freeCount = s_CurrentFrame.freeCount.exchange(0, std::memory_order_relaxed);
+	t_Frame.allocBytes = s_CurrentFrame.allocBytes.exchange(0, std::memory_order_relaxed);
+	t_Frame.freeBytes = s_CurrentFrame.freeBytes.exchange(0, std::memory_order_relaxed);
+}
+
+static void GetCounters(const HeapCounters& a_Counters, uint64_t& a_AllocCount, uint64_t& a_FreeCount, uint64_t& a_TotalBytes, uint64_t& a_LiveBytes, uint64_t& a_PeakBytes)
+{
+	a_AllocCount = a_Counters.allocCount.load(std::memory_order_relaxed);
+	a_FreeCount = a_Counters.freeCount.load(std::memory_order_relaxed);
+	a_TotalBytes = a_Counters.totalBytes.load(std::memory_order_relaxed);
+	a_LiveBytes = a_Counters.liveBytes.load(std::memory_order_relaxed);
+	a_PeakBytes = a_Counters.peakBytes.load(std::memory_order_relaxed);
+}
+
+uint32_t BB::HeapProfiler::GetCallSiteInfos(HeapCallSiteInfo* a_Infos, const uint32_t a_MaxCount)
+{
+	uint32_t t_Count = 0;
+	for (uint32_t i = 0; i < HEAP_PROFILER_MAX_CALL_SITES && t_Count < a_MaxCount; i++)
+	{
+		const CallSiteEntry& t_Entry = s_CallSites[i];
+		HeapCallSiteInfo& t_Info = a_Infos[t_Count];
+		GetCounters(t_Entry.counters, t_Info.allocCount, t_Info.freeCount, t_Info.totalBytes, t_Info.liveBytes, t_Info.peakBytes);
+		if (t_Info.allocCount == 0)
+			continue;
+
+		t_Info.file = t_Entry.file.load(std::memory_order_acquire);
+		t_Info.line = t_Entry.line;
+		const PointerEntry& t_Allocator = s_Allocators[t_Entry.allocator.load(std::memory_order_relaxed)];
+		t_Info.allocator = t_Allocator.key.load(std::memory_order_acquire);
+		t_Info.allocatorName = t_Allocator.name.load(std::memory_order_relaxed);
+		++t_Count;
+	}
+	return t_Count;
+}
+
+uint32_t BB::HeapProfiler::GetAllocatorInfos(HeapAllocatorInfo* a_Infos, const uint32_t a_MaxCount)
+{
+	uint32_t t_Count = 0;
+	for (uint32_t i = 0; i < HEAP_PROFILER_MAX_ALLOCATORS && t_Count < a_MaxCount; i++)
+	{
+		const PointerEntry& t_Entry = s_Allocators[i];
+		HeapAllocatorInfo& t_Info = a_Infos[t_Count];
+		GetCounters(t_Entry.counters, t_Info.allocCount, t_Info.freeCount, t_Info.totalBytes, t_Info.liveBytes, t_Info.peakBytes);
+		if (t_Info.allocCount == 0)
+			continue;
+
+		t_Info.allocator = t_Entry.key.load(std::memory_order_acquire);
+		t_Info.name = t_Entry.name.load(std::memory_order_relaxed);
+		++t_Count;
+	}
+	return t_Count;
+}
+
+uint32_t BB::HeapProfiler::GetTagInfos(HeapTagInfo* a_Infos, const uint32_t a_MaxCount)
+{
+	uint32_t t_Count = 0;
+	for (uint32_t i = 0; i < HEAP_PROFILER_MAX_TAGS && t_Count < a_MaxCount; i++)
+	{
+		const PointerEntry& t_Entry = s_Tags[i];
+		const uint64_t t_PeakBytes = t_Entry.counters.peakBytes.load(std::memory_order_relaxed);
+		if (t_PeakBytes == 0)
+			continue;
+
+		HeapTagInfo& t_Info = a_Infos[t_Count++];
+		t_Info.name = i == 0 ? "untagged" : t_Entry.name.load(std::memory_order_relaxed);
+		t_Info.liveBytes = t_Entry.counters.liveBytes.load(std::memory_order_relaxed);
+		t_Info.peakBytes = t_PeakBytes;
+	}
+	return t_Count;
+}
+
+uint32_t BB::HeapProfiler::GetFrameHistory(HeapProfileFrame* a_Frames, const uint32_t a_MaxCount)
+{
+	const uint64_t t_Available = s_FrameNumber < HEAP_PROFILER_FRAME_HISTORY ? s_FrameNumber : HEAP_PROFILER_FRAME_HISTORY;
+	const uint32_t t_Count = static_cast<uint32_t>(t_Available < a_MaxCount ? t_Available : a_MaxCount);
+	const uint64_t t_FirstFrame = s_FrameNumber - t_Count;
+	for (uint32_t i = 0; i < t_Count; i++)
+		a_Frames[i] = s_FrameHistory[(t_FirstFrame + i) % HEAP_PROFILER_FRAME_HISTORY];
+	return t_Count;
+}
+
+//Adds the string to the table and returns it's offset.
+static uint32_t WriteString(char* a_Table, uint64_t& a_TableSize, const char* a_String)
+{
+	if (a_String == nullptr)
+		return HEAP_PROFILE_NO_STRING;
+
+	const size_t t_Length = strlen(a_String) + 1;
+	const uint32_t t_Offset = static_cast<uint32_t>(a_TableSize);
+	if (a_Table != nullptr)
+		memcpy(a_Table + a_TableSize, a_String, t_Length);
+	a_TableSize += t_Length;
+	return t_Offset;
+}
+
+bool BB::HeapProfiler::DumpToFile(const char* a_Path)
+{
+	//Scratch memory is not profiled, so dumping does not change what it writes.
+	ScratchScope t_Scratch;
+
+	HeapCallSiteInfo* t_CallSites = reinterpret_cast<HeapCallSiteInfo*>(t_Scratch.Alloc(sizeof(HeapCallSiteInfo) * HEAP_PROFILER_MAX_CALL_SITES, alignof(HeapCallSiteInfo)));
+	HeapAllocatorInfo* t_Allocators = reinterpret_cast<HeapAllocatorInfo*>(t_Scratch.Alloc(sizeof(HeapAllocatorInfo) * HEAP_PROFILER_MAX_ALLOCATORS, alignof(HeapAllocatorInfo)));
+	HeapTagInfo* t_Tags = reinterpret_cast<HeapTagInfo*>(t_Scratch.Alloc(sizeof(HeapTagInfo) * HEAP_PROFILER_MAX_TAGS, alignof(HeapTagInfo)));
+	HeapProfileFrame* t_Frames = reinterpret_cast<HeapProfileFrame*>(t_Scratch.Alloc(sizeof(HeapProfileFrame) * HEAP_PROFILER_FRAME_HISTORY, alignof(HeapProfileFrame)));
+
+	HeapProfileFileHeader t_FileHeader;
+	t_FileHeader.magic = HEAP_PROFILE_MAGIC;
+	t_FileHeader.version = HEAP_PROFILE_VERSION;
+	t_FileHeader.callSiteCount = GetCallSiteInfos(t_CallSites, HEAP_PROFILER_MAX_CALL_SITES);
+	t_FileHeader.allocatorCount = GetAllocatorInfos(t_Allocators, HEAP_PROFILER_MAX_ALLOCATORS);
+	t_FileHeader.tagCount = GetTagInfos(t_Tags, HEAP_PROFILER_MAX_TAGS);
+	t_FileHeader.frameCount = GetFrameHistory(t_Frames, HEAP_PROFILER_FRAME_HISTORY);
+
+	//Call sites point to the allocator itself in the info, find the index in the dumped allocators again.
+	auto t_FindAllocator = [&](const void* a_Allocator) -> uint32_t
+	{
+		for (uint32_t i = 0; i < t_FileHeader.allocatorCount; i++)
+			if (t_Allocators[i].allocator == a_Allocator)
+				return i;
+		return UINT32_MAX;
+	};
+
+	//First pass gets the string table size, the second pass writes it.
+	uint64_t t_StringTableSize = 0;
+	for (uint32_t i = 0; i < t_FileHeader.callSiteCount; i++)
+		WriteString(nullptr, t_StringTableSize, t_CallSites[i].file);
+	for (uint32_t i = 0; i < t_FileHeader.allocatorCount; i++)
+		WriteString(nullptr, t_StringTableSize, t_Allocators[i].name);
+	for (uint32_t i = 0; i < t_FileHeader.tagCount; i++)
+		WriteString(nullptr, t_StringTableSize, t_Tags[i].name);
+
+	char* t_StringTable = reinterpret_cast<char*>(t_Scratch.Alloc(t_StringTableSize + 1, 1));
+	t_FileHeader.stringTableSize = t_StringTableSize;
+	t_StringTableSize = 0;
+
+	HeapProfileCallSite* t_FileCallSites = reinterpret_cast<HeapProfileCallSite*>(t_Scratch.Alloc(sizeof(HeapProfileCallSite) * (t_FileHeader.callSiteCount + 1), alignof(HeapProfileCallSite)));
+	for (uint32_t i = 0; i < t_FileHeader.callSiteCount; i++)
+	{
+		const HeapCallSiteInfo& t_Info = t_CallSites[i];
+		HeapProfileCallSite& t_Site = t_FileCallSites[i];
+		t_Site.file = WriteString(t_StringTable, t_StringTableSize, t_Info.file);
+		t_Site.line = static_cast<uint32_t>(t_Info.line);
+		t_Site.allocator = t_FindAllocator(t_Info.allocator);
+		t_Site.padding = 0;
+		t_Site.allocCount = t_Info.allocCount;
+		t_Site.freeCount = t_Info.freeCount;
+		t_Site.totalBytes = t_Info.totalBytes;
+		t_Site.liveBytes = t_Info.liveBytes;
+		t_Site.peakBytes = t_Info.peakBytes;
+	}
+
+	HeapProfileAllocator* t_FileAllocators = reinterpret_cast<HeapProfileAllocator*>(t_Scratch.Alloc(sizeof(HeapProfileAllocator) * (t_FileHeader.allocatorCount + 1), alignof(HeapProfileAllocator)));
+	for (uint32_t i = 0; i < t_FileHeader.allocatorCount; i++)
+	{
+		const HeapAllocatorInfo& t_Info = t_Allocators[i];
+		HeapProfileAllocator& t_Allocator = t_FileAllocators[i];
+		t_Allocator.name = WriteString(t_StringTable, t_StringTableSize, t_Info.name);
+		t_Allocator.padding = 0;
+		t_Allocator.allocCount = t_Info.allocCount;
+		t_Allocator.freeCount = t_Info.freeCount;
+		t_Allocator.totalBytes = t_Info.totalBytes;
+		t_Allocator.liveBytes = t_Info.liveBytes;
+		t_Allocator.peakBytes = t_Info.peakBytes;
+	}
+
+	HeapProfileTag* t_FileTags = reinterpret_cast<HeapProfileTag*>(t_Scratch.Alloc(sizeof(HeapProfileTag) * (t_FileHeader.tagCount + 1), alignof(HeapProfileTag)));
+	for (uint32_t i = 0; i < t_FileHeader.tagCount; i++)
+	{
+		t_FileTags[i].name = WriteString(t_StringTable, t_StringTableSize, t_Tags[i].name);
+		t_FileTags[i].padding = 0;
+		t_FileTags[i].liveBytes = t_Tags[i].liveBytes;
+		t_FileTags[i].peakBytes = t_Tags[i].peakBytes;
+	}
+
+	const OSFileHandle t_File = CreateOSFile(a_Path);
+	if (t_File == 0)
+		return false;
+
+	Buffer t_Buffer;
+	t_Buffer.data = reinterpret_cast<char*>(&t_FileHeader);
+	t_Buffer.size = sizeof(t_FileHeader);
+	WriteToFile(t_File, t_Buffer);
+	t_Buffer.data = reinterpret_cast<char*>(t_FileCallSites);
+	t_Buffer.size = sizeof(HeapProfileCallSite) * t_FileHeader.callSiteCount;
+	WriteToFile(t_File, t_Buffer);
+	t_Buffer.data = reinterpret_cast<char*>(t_FileAllocators);
+	t_Buffer.size = sizeof(HeapProfileAllocator) * t_FileHeader.allocatorCount;
+	WriteToFile(t_File, t_Buffer);
+	t_Buffer.data = reinterpret_cast<char*>(t_FileTags);
+	t_Buffer.size = sizeof(HeapProfileTag) * t_FileHeader.tagCount;
+	WriteToFile(t_File, t_Buffer);
+	t_Buffer.data = reinterpret_cast<char*>(t_Frames);
+	t_Buffer.size = sizeof(HeapProfileFrame) * t_FileHeader.frameCount;
+	WriteToFile(t_File, t_Buffer);
+	t_Buffer.data = t_StringTable;
+	t_Buffer.size = t_FileHeader.stringTableSize;
+	WriteToFile(t_File, t_Buffer);
+	CloseOSFile(t_File);
+	return true;
+}
@@ -1,5 +1,7 @@
 #include "RingAllocator.h"
 #include "BackingAllocator.h"
+#include "OS/Program.h"
+#include "Math.inl"
 
 using namespace BB;
 
@@ -38,7 +40,7 @@ RingAllocator::~RingAllocator()
 void* RingAllocator::Alloc(size_t a_Size, size_t a_Alignment)
 {
 	size_t t_Adjustment = Pointer::AlignForwardAdjustment(m_BufferPos, a_Alignment);
-	size_t t_AdjustedSize = a_Size + a_Alignment;
+	size_t t_AdjustedSize = a_Size + t_Adjustment;
 	//Go back to the buffer start if we cannot fill this allocation.
 	if (m_Used + t_AdjustedSize > m_Size)
 	{
@@ -93,7 +95,7 @@ LocalRingAllocator::~LocalRingAllocator()
 void* LocalRingAllocator::Alloc(size_t a_Size, size_t a_Alignment)
 {
 	size_t t_Adjustment = Pointer::AlignForwardAdjustment(m_BufferPos, a_Alignment);
-	size_t t_AdjustedSize = a_Size + a_Alignment;
+	size_t t_AdjustedSize = a_Size + t_Adjustment;
 	//Go back to the buffer start if we cannot fill this allocation.
 	if (m_Used + t_AdjustedSize > m_Size)
 	{
@@ -110,4 +112,181 @@ void* LocalRingAllocator::Alloc(size_t a_Size, size_t a_Alignment)
 	m_Used += t_AdjustedSize;
 
 	return t_ReturnPtr;
-}
\ No newline at end of file
+}
+
+
+
+void* ReallocFrameRing(BB_MEMORY_DEBUG void* a_Allocator, size_t a_Size, size_t a_Alignment, void*)
+{
+	//Frees happen when the frame's fence is retired.
+	if (a_Size == 0)
+		return nullptr;
+
+	return reinterpret_cast<FrameRingAllocator*>(a_Allocator)->Alloc(a_Size, a_Alignment);
+}
+
+FrameRingAllocator::operator BB::Allocator()
+{
+	Allocator t_AllocatorInterface;
+	t_AllocatorInterface.allocator = this;
+	t_AllocatorInterface.func = ReallocFrameRing;
+	return t_AllocatorInterface;
+}
+
+FrameRingAllocator::FrameRingAllocator(size_t& a_Size, const size_t a_ReserveMultiplier)
+{
+	BB_ASSERT(a_ReserveMultiplier >= VIRTUAL_RESERVE_NONE, "FrameRingAllocator needs a reserve multiplier of at least VIRTUAL_RESERVE_NONE.");
+	m_Start = mallocVirtual(nullptr, a_Size, a_ReserveMultiplier);
+	m_Capacity = a_Size;
+	//Grow in whole pages and stay under the reservation, it also holds the virtual header.
+	const size_t t_PageSize = VirtualMemoryPageSize();
+	m_MaxCapacity = m_Capacity + m_Capacity * (a_ReserveMultiplier - 1) / t_PageSize * t_PageSize;
+
+	m_Head = 0;
+	m_Limit = m_Capacity;
+	m_SpanStart = 0;
+	m_LastFenceValue = 0;
+	m_GrowCount = 0;
+
+	m_SpanFront = 0;
+	m_SpanCount = 0;
+	m_OpenSpanCount = 0;
+}
+
+FrameRingAllocator::~FrameRingAllocator()
+{
+	freeVirtual(m_Start);
+}
+
+void* FrameRingAllocator::Alloc(size_t a_Size, size_t a_Alignment)
+{
+	size_t t_Position = AlignPosition(m_Head, a_Alignment);
+	if (t_Position + a_Size > m_Limit)
+		t_Position = FindSpace(a_Size, a_Alignment);
+
+	m_Head = t_Position + a_Size;
+	return Pointer::Add(m_Start, t_Position);
+}
+
+void FrameRingAllocator::EndFrame(const uint64_t a_FenceValue)
+{
+	BB_ASSERT(a_FenceValue >= m_LastFenceValue, "FrameRingAllocator fence values must go up.");
+	CloseSpan();
+
+	//Only the back of the FIFO has spans without a fence value.
+	for (uint32_t i = m_SpanCount - m_OpenSpanCount; i < m_SpanCount; i++)
+		m_Spans[(m_SpanFront + i) % FRAME_RING_MAX_SPANS].fenceValue = a_FenceValue;
+
+	m_OpenSpanCount = 0;
+	m_LastFenceValue = a_FenceValue;
+}
+
+void FrameRingAllocator::Retire(const uint64_t a_CompletedFenceValue)
+{
+	while (m_SpanCount > m_OpenSpanCount && m_Spans[m_SpanFront].fenceValue <= a_CompletedFenceValue)
+	{
+		m_SpanFront = (m_SpanFront + 1) % FRAME_RING_MAX_SPANS;
+		--m_SpanCount;
+	}
+
+	//Start at the beginning again when nothing is in use, so the ring does not get split up.
+	if (m_SpanCount == 0 && m_SpanStart == m_Head)
+	{
+		m_Head = 0;
+		m_SpanStart = 0;
+		m_Limit = m_Capacity;
+	}
+	//Otherwise m_Limit can only be too low, FindSpace updates it when it's needed.
+}
+
+size_t FrameRingAllocator::GetUsed() const
+{
+	size_t t_Used = m_Head - m_SpanStart;
+	for (uint32_t i = 0; i < m_SpanCount; i++)
+	{
+		const Span& t_Span = m_Spans[(m_SpanFront + i) % FRAME_RING_MAX_SPANS];
+		t_Used += t_Span.end - t_Span.start;
+	}
+	return t_Used;
+}
+
+size_t FrameRingAllocator::AlignPosition(const size_t a_Position, const size_t a_Alignment) const
+{
+	return a_Position + Pointer::AlignForwardAdjustment(Pointer::Add(m_Start, a_Position), a_Alignment);
+}
+
+size_t FrameRingAllocator::FindLimit(const size_t a_Position) const
+{
+	size_t t_Limit = m_Capacity;
+	for (uint32_t i = 0; i < m_SpanCount; i++)
+	{
+		const Span& t_Span = m_Spans[(m_SpanFront + i) % FRAME_RING_MAX_SPANS];
+		if (t_Span.start >= a_Position && t_Span.start < t_Limit)
+			t_Limit = t_Span.start;
+	}
+	return t_Limit;
+}
+
+size_t FrameRingAllocator::FindSpace(const size_t a_Size, const size_t a_Alignment)
+{
+	//Spans might have retired since the limit was calculated.
+	m_Limit = FindLimit(m_Head);
+	size_t t_Position = AlignPosition(m_Head, a_Alignment);
+	if (t_Position + a_Size <= m_Limit)
+		return t_Position;
+
+	//The head moves somewhere else, so the current span ends here.
+	CloseSpan();
+
+	//Go back to the start if the oldest frames retired.
+	size_t t_SpanStart = 0;
+	m_Limit = FindLimit(t_SpanStart);
+	t_Position = AlignPosition(t_SpanStart, a_Alignment);
+	if (t_Position + a_Size > m_Limit)
+	{
+		//Everything behind the last span is free, grow the ring there instead of overwriting live memory.
+		t_SpanStart = 0;
+		for (uint32_t i = 0; i < m_SpanCount; i++)
+			t_SpanStart = Max(t_SpanStart, m_Spans[(m_SpanFront + i) % FRAME_RING_MAX_SPANS].end);
+
+		t_Position = AlignPosition(t_SpanStart, a_Alignment);
+		if (t_Position + a_Size > m_Capacity)
+			Grow(t_Position + a_Size);
+		m_Limit = m_Capacity;
+	}
+
+	m_Head = t_SpanStart;
+	m_SpanStart = t_SpanStart;
+	return t_Position;
+}
+
+void FrameRingAllocator::CloseSpan()
+{
+	if (m_Head == m_SpanStart)
+		return;
+
+	BB_ASSERT(m_SpanCount < FRAME_RING_MAX_SPANS, "FrameRingAllocator has too many spans waiting on a fence, call Retire more often.");
+	Span& t_Span = m_Spans[(m_SpanFront + m_SpanCount) % FRAME_RING_MAX_SPANS];
+	t_Span.fenceValue = UINT64_MAX;
+	t_Span.start = m_SpanStart;
+	t_Span.end = m_Head;
+	++m_SpanCount;
+	++m_OpenSpanCount;
+
+	m_SpanStart = m_Head;
+}
+
+void FrameRingAllocator::Grow(const size_t a_RequiredCapacity)
+{
+	BB_ASSERT(a_RequiredCapacity <= m_MaxCapacity, "FrameRingAllocator is out of reserved memory, retire fences more often or reserve more.");
+
+	//At least double so that a busy frame does not grow the ring every allocation.
+	const size_t t_NewCapacity = Min(Max(a_RequiredCapacity, m_Capacity * 2), m_MaxCapacity);
+	size_t t_Increase = Math::RoundUp(t_NewCapacity - m_Capacity, VirtualMemoryPageSize());
+	//m_MaxCapacity is a whole amount of pages away from m_Capacity.
+	t_Increase = Min(t_Increase, m_MaxCapacity - m_Capacity);
+	mallocVirtual(m_Start, t_Increase);
+
+	m_Capacity += t_Increase;
+	++m_GrowCount;
+}
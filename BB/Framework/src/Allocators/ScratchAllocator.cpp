@@ -0,0 +1,204 @@
+#include "ScratchAllocator.h"
+#include "Math.inl"
+
+#include <atomic>
+
+using namespace BB;
+
+struct ScratchArena
+{
+	std::atomic<bool> inUse{ false };
+	//Frame this arena was last reset in.
+	uint32_t frame = 0;
+	uint32_t openScopes = 0;
+	void* start = nullptr;
+	void* position = nullptr;
+
+	//Written by the owning thread, read by anyone that asks for the arena infos.
+	std::atomic<size_t> commited{ 0 };
+	std::atomic<size_t> reserved{ 0 };
+	std::atomic<size_t> used{ 0 };
+	std::atomic<size_t> highWaterMark{ 0 };
+	std::atomic<size_t> frameHighWaterMark{ 0 };
+	std::atomic<size_t> lastFrameHighWaterMark{ 0 };
+};
+
+static ScratchArena s_Arenas[SCRATCH_MAX_ARENAS];
+static std::atomic<uint32_t> s_ScratchFrame{ 0 };
+
+//Gives the arena back when the thread exits.
+struct ScratchThreadArena
+{
+	ScratchArena* arena = nullptr;
+
+	~ScratchThreadArena()
+	{
+		if (arena == nullptr)
+			return;
+
+		freeVirtual(arena->start);
+		arena->start = nullptr;
+		arena->position = nullptr;
+		arena->used.store(0, std::memory_order_relaxed);
+		arena->inUse.store(false, std::memory_order_release);
+	}
+};
+static thread_local ScratchThreadArena s_ThreadArena;
+
+static ScratchArena* CreateArena()
+{
+	for (uint32_t i = 0; i < SCRATCH_MAX_ARENAS; i++)
+	{
+		bool t_Expected = false;
+		if (s_Arenas[i].inUse.load(std::memory_order_relaxed) ||
+			!s_Arenas[i].inUse.compare_exchange_strong(t_Expected, true, std::memory_order_acquire))
+			continue;
+
+		ScratchArena* t_Arena = &s_Arenas[i];
+		size_t t_CommitSize = SCRATCH_COMMIT_START;
+		t_Arena->start = mallocVirtual(nullptr, t_CommitSize, SCRATCH_RESERVE_MULTIPLIER);
+		t_Arena->position = t_Arena->start;
+		t_Arena->commited.store(t_CommitSize, std::memory_order_relaxed);
+		t_Arena->reserved.store(t_CommitSize * SCRATCH_RESERVE_MULTIPLIER, std::memory_order_relaxed);
+		t_Arena->openScopes = 0;
+		t_Arena->frame = s_ScratchFrame.load(std::memory_order_relaxed);
+		t_Arena->highWaterMark.store(0, std::memory_order_relaxed);
+		t_Arena->frameHighWaterMark.store(0, std::memory_order_relaxed);
+		t_Arena->lastFrameHighWaterMark.store(0, std::memory_order_relaxed);
+#ifdef BB_HEAP_PROFILER
+		HeapProfiler::RegisterAllocator(t_Arena, "scratch arena");
+#endif //BB_HEAP_PROFILER
+		return t_Arena;
+	}
+
+	BB_ASSERT(false, "Too many threads use scratch memory, increase SCRATCH_MAX_ARENAS.");
+	return nullptr;
+}
+
+static ScratchArena& GetThreadArena()
+{
+	if (s_ThreadArena.arena == nullptr)
+		s_ThreadArena.arena = CreateArena();
+
+	ScratchArena& t_Arena = *s_ThreadArena.arena;
+	//Lazy frame reset, memory inside an open scope might still be in use so wait until they are all closed.
+	const uint32_t t_Frame = s_ScratchFrame.load(std::memory_order_relaxed);
+	if (t_Arena.frame != t_Frame && t_Arena.openScopes == 0)
+	{
+		t_Arena.frame = t_Frame;
+		t_Arena.position = t_Arena.start;
+		t_Arena.used.store(0, std::memory_order_relaxed);
+		t_Arena.lastFrameHighWaterMark.store(t_Arena.frameHighWaterMark.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		t_Arena.frameHighWaterMark.store(0, std::memory_order_relaxed);
+#ifdef BB_HEAP_PROFILER
+		HeapProfiler::OnClear(&t_Arena);
+#endif //BB_HEAP_PROFILER
+	}
+	return t_Arena;
+}
+
+static void* ArenaAlloc(ScratchArena& a_Arena, const size_t a_Size, const size_t a_Alignment)
+{
+	const size_t t_Adjustment = Pointer::AlignForwardAdjustment(a_Arena.position, a_Alignment);
+	const size_t t_Used = a_Arena.used.load(std::memory_order_relaxed) + a_Size + t_Adjustment;
+
+	const size_t t_Commited = a_Arena.commited.load(std::memory_order_relaxed);
+	if (t_Used > t_Commited)
+	{
+		//Grow at least by what is already commited so we don't commit on every allocation.
+		size_t t_Increase = Max(t_Used - t_Commited, t_Commited);
+		BB_ASSERT(t_Commited + t_Increase < a_Arena.reserved.load(std::memory_order_relaxed),
+			"Scratch arena is going over it's reserved memory, check the high water marks and increase SCRATCH_COMMIT_START.");
+		mallocVirtual(a_Arena.start, t_Increase);
+		a_Arena.commited.store(t_Commited + t_Increase, std::memory_order_relaxed);
+	}
+
+	void* t_Address = Pointer::Add(a_Arena.position, t_Adjustment);
+	a_Arena.position = Pointer::Add(t_Address, a_Size);
+	a_Arena.used.store(t_Used, std::memory_order_relaxed);
+
+	if (t_Used > a_Arena.frameHighWaterMark.load(std::memory_order_relaxed))
+	{
+		a_Arena.frameHighWaterMark.store(t_Used, std::memory_order_relaxed);
+		if (t_Used > a_Arena.highWaterMark.load(std::memory_order_relaxed))
+			a_Arena.highWaterMark.store(t_Used, std::memory_order_relaxed);
+	}
+
+	return t_Address;
+}
+
+static void* ScratchRealloc(BB_MEMORY_DEBUG void* a_Allocator, size_t a_Size, size_t a_Alignment, void*)
+{
+	if (a_Size == 0)
+		return nullptr;
+
+	ScratchArena& t_Arena = GetThreadArena();
+	BB_ASSERT(a_Allocator == &t_Arena, "Scratch allocator is used on a different thread then the one that owns it.");
+	return ArenaAlloc(t_Arena, a_Size, a_Alignment);
+}
+
+Allocator BB::Scratch::GetAllocator()
+{
+	Allocator t_AllocatorInterface;
+	t_AllocatorInterface.allocator = &GetThreadArena();
+	t_AllocatorInterface.func = ScratchRealloc;
+	return t_AllocatorInterface;
+}
+
+void* BB::Scratch::Alloc(const size_t a_Size, const size_t a_Alignment)
+{
+	return ArenaAlloc(GetThreadArena(), a_Size, a_Alignment);
+}
+
+ScratchMarker BB::Scratch::Mark()
+{
+	ScratchArena& t_Arena = GetThreadArena();
+	++t_Arena.openScopes;
+	return ScratchMarker{ t_Arena.position };
+}
+
+void BB::Scratch::Rewind(const ScratchMarker a_Marker)
+{
+	//No GetThreadArena, a frame reset must wait until this scope is closed.
+	ScratchArena& t_Arena = *s_ThreadArena.arena;
+	BB_ASSERT(t_Arena.openScopes != 0, "Scratch rewind without a mark.");
+	BB_ASSERT(a_Marker.position >= t_Arena.start && a_Marker.position <= t_Arena.position,
+		"Scratch marker is not from this thread or was already rewound past.");
+
+	--t_Arena.openScopes;
+	t_Arena.position = a_Marker.position;
+	t_Arena.used.store(static_cast<size_t>(reinterpret_cast<uintptr_t>(a_Marker.position) - reinterpret_cast<uintptr_t>(t_Arena.start)), std::memory_order_relaxed);
+}
+
+void BB::Scratch::NextFrame()
+{
+	s_ScratchFrame.fetch_add(1, std::memory_order_relaxed);
+}
+
+static ScratchArenaInfo GetInfo(const ScratchArena& a_Arena)
+{
+	ScratchArenaInfo t_Info;
+	t_Info.arenaIndex = static_cast<uint32_t>(&a_Arena - s_Arenas);
+	t_Info.used = a_Arena.used.load(std::memory_order_relaxed);
+	t_Info.commited = a_Arena.commited.load(std::memory_order_relaxed);
+	t_Info.reserved = a_Arena.reserved.load(std::memory_order_relaxed);
+	t_Info.highWaterMark = a_Arena.highWaterMark.load(std::memory_order_relaxed);
+	t_Info.frameHighWaterMark = a_Arena.lastFrameHighWaterMark.load(std::memory_order_relaxed);
+	return t_Info;
+}
+
+ScratchArenaInfo BB::Scratch::GetThreadArenaInfo()
+{
+	return GetInfo(GetThreadArena());
+}
+
+uint32_t BB::Scratch::GetArenaInfos(ScratchArenaInfo* a_Infos, const uint32_t a_MaxCount)
+{
+	uint32_t t_Count = 0;
+	for (uint32_t i = 0; i < SCRATCH_MAX_ARENAS && t_Count < a_MaxCount; i++)
+	{
+		if (s_Arenas[i].inUse.load(std::memory_order_acquire))
+			a_Infos[t_Count++] = GetInfo(s_Arenas[i]);
+	}
+	return t_Count;
+}
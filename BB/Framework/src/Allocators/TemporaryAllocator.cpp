@@ -80,6 +80,9 @@ namespace BB
 
 	void BB::TemporaryAllocator::Clear()
 	{
+#ifdef BB_HEAP_PROFILER
+		HeapProfiler::OnClear(this);
+#endif //BB_HEAP_PROFILER
 		while (m_FreeBlock->previousBlock != nullptr)
 		{
 			TemporaryFreeBlock* t_PreviousBlock = m_FreeBlock->previousBlock;
@@ -0,0 +1,260 @@
+#include "ThreadCacheAllocator.h"
+#include "BackingAllocator.h"
+
+using namespace BB;
+
+static_assert(THREAD_CACHE_MAX_THREADS == 64, "Thread cache slots are tracked in a single 64 bit mask.");
+
+constexpr const uint8_t THREAD_CACHE_LARGE_CLASS = UINT8_MAX;
+//Every block starts 16 byte aligned and has room for the header before the returned pointer.
+constexpr const size_t THREAD_CACHE_HEADER_SIZE = 16;
+constexpr const size_t CACHE_LINE_SIZE = 64;
+
+//Placed right before the pointer that is returned.
+struct ThreadCacheBlockHeader
+{
+	uint16_t cacheIndex;
+	uint8_t sizeClass;
+	uint8_t padding;
+	//Bytes from the start of the block to the returned pointer.
+	uint32_t offset;
+};
+
+struct FreeNode
+{
+	FreeNode* next;
+};
+
+struct SpanHeader
+{
+	SpanHeader* next;
+};
+
+struct SizeClassCache
+{
+	FreeNode* localFree = nullptr;
+	uint8_t* spanPosition = nullptr;
+	uint8_t* spanEnd = nullptr;
+};
+
+struct BB::ThreadCache
+{
+	SizeClassCache classes[THREAD_CACHE_CLASS_COUNT];
+	SpanHeader* spans = nullptr;
+	//Written by other threads, keep it away from the cache lines the owner uses.
+	alignas(CACHE_LINE_SIZE) std::atomic<FreeNode*> remoteFree[THREAD_CACHE_CLASS_COUNT];
+};
+
+//Every thread that uses a thread cache allocator gets a slot, the same slot is used for every allocator.
+//A slot is given back when it's thread exits, the next thread that takes it also takes over the cached memory.
+static std::atomic<uint64_t> s_UsedThreadSlots{ 0 };
+
+struct ThreadCacheSlot
+{
+	uint32_t index = UINT32_MAX;
+
+	~ThreadCacheSlot()
+	{
+		if (index != UINT32_MAX)
+			s_UsedThreadSlots.fetch_and(~(1ull << index), std::memory_order_release);
+	}
+};
+static thread_local ThreadCacheSlot s_ThreadSlot;
+
+static uint32_t GetThreadSlot()
+{
+	if (s_ThreadSlot.index == UINT32_MAX)
+	{
+		uint64_t t_Used = s_UsedThreadSlots.load(std::memory_order_relaxed);
+		while (true)
+		{
+			BB_ASSERT(t_Used != UINT64_MAX, "Too many threads use a thread cache allocator, increase THREAD_CACHE_MAX_THREADS.");
+			const uint32_t t_Slot = Math::FindFirstSetBit(~t_Used);
+			if (s_UsedThreadSlots.compare_exchange_weak(t_Used, t_Used | (1ull << t_Slot), std::memory_order_acquire, std::memory_order_relaxed))
+			{
+				s_ThreadSlot.index = t_Slot;
+				break;
+			}
+		}
+	}
+	return s_ThreadSlot.index;
+}
+
+//16 byte steps up to 128, after that every power of two is split in 4 classes.
+static uint32_t SizeToClass(const size_t a_Size)
+{
+	if (a_Size <= 128)
+		return static_cast<uint32_t>((a_Size + 15) / 16 - 1);
+
+	const uint32_t t_Bit = Math::FindLastSetBit(a_Size - 1);
+	return 8 + (t_Bit - 7) * 4 + static_cast<uint32_t>((a_Size - 1) >> (t_Bit - 2)) - 4;
+}
+
+static size_t ClassToSize(const uint32_t a_SizeClass)
+{
+	if (a_SizeClass < 8)
+		return (static_cast<size_t>(a_SizeClass) + 1) * 16;
+
+	const uint32_t t_Group = (a_SizeClass - 8) / 4;
+	const uint32_t t_Step = (a_SizeClass - 8) % 4;
+	return static_cast<size_t>(5 + t_Step) << (t_Group + 5);
+}
+
+static void* ThreadCacheRealloc(BB_MEMORY_DEBUG void* a_Allocator, size_t a_Size, const size_t a_Alignment, void* a_Ptr)
+{
+	ThreadCacheAllocator* t_Allocator = reinterpret_cast<ThreadCacheAllocator*>(a_Allocator);
+	if (a_Size > 0)
+		return t_Allocator->Alloc(a_Size, a_Alignment);
+
+	t_Allocator->Free(a_Ptr);
+	return nullptr;
+}
+
+ThreadCacheAllocator::operator BB::Allocator()
+{
+	Allocator t_AllocatorInterface;
+	t_AllocatorInterface.allocator = this;
+	t_AllocatorInterface.func = ThreadCacheRealloc;
+	return t_AllocatorInterface;
+}
+
+ThreadCacheAllocator::ThreadCacheAllocator(const Allocator a_BackingAllocator, const char* a_Name)
+	: name(a_Name), m_BackingAllocator(a_BackingAllocator)
+{
+#ifdef BB_HEAP_PROFILER
+	HeapProfiler::RegisterAllocator(this, a_Name);
+#endif //BB_HEAP_PROFILER
+	m_CacheMemory = BBnewArr(m_BackingAllocator, sizeof(ThreadCache) * THREAD_CACHE_MAX_THREADS + alignof(ThreadCache), uint8_t);
+	m_Caches = reinterpret_cast<ThreadCache*>(Pointer::Add(m_CacheMemory, Pointer::AlignForwardAdjustment(m_CacheMemory, alignof(ThreadCache))));
+	for (uint32_t i = 0; i < THREAD_CACHE_MAX_THREADS; i++)
+	{
+		new (&m_Caches[i]) ThreadCache();
+		for (uint32_t t_Class = 0; t_Class < THREAD_CACHE_CLASS_COUNT; t_Class++)
+			m_Caches[i].remoteFree[t_Class].store(nullptr, std::memory_order_relaxed);
+	}
+}
+
+ThreadCacheAllocator::~ThreadCacheAllocator()
+{
+	for (uint32_t i = 0; i < THREAD_CACHE_MAX_THREADS; i++)
+	{
+		SpanHeader* t_Span = m_Caches[i].spans;
+		while (t_Span != nullptr)
+		{
+			SpanHeader* t_Next = t_Span->next;
+			BBfree(m_BackingAllocator, t_Span);
+			t_Span = t_Next;
+		}
+	}
+	BBfreeArr(m_BackingAllocator, m_CacheMemory);
+}
+
+void* ThreadCacheAllocator::Alloc(size_t a_Size, size_t a_Alignment)
+{
+	//Bigger alignments need room to move the returned pointer forward.
+	size_t t_BlockSize = a_Size + THREAD_CACHE_HEADER_SIZE;
+	if (a_Alignment > THREAD_CACHE_HEADER_SIZE)
+		t_BlockSize += a_Alignment - THREAD_CACHE_HEADER_SIZE;
+
+	void* t_Block;
+	uint32_t t_SizeClass;
+	uint32_t t_CacheIndex = 0;
+	if (t_BlockSize > THREAD_CACHE_MAX_CLASS_SIZE)
+	{
+		t_Block = mallocVirtual(nullptr, t_BlockSize, VIRTUAL_RESERVE_NONE);
+		t_SizeClass = THREAD_CACHE_LARGE_CLASS;
+	}
+	else
+	{
+		t_CacheIndex = GetThreadSlot();
+		t_SizeClass = SizeToClass(t_BlockSize);
+		ThreadCache& t_Cache = m_Caches[t_CacheIndex];
+		SizeClassCache& t_ClassCache = t_Cache.classes[t_SizeClass];
+
+		//Take back everything other threads freed in one go.
+		if (t_ClassCache.localFree == nullptr && t_Cache.remoteFree[t_SizeClass].load(std::memory_order_relaxed) != nullptr)
+			t_ClassCache.localFree = t_Cache.remoteFree[t_SizeClass].exchange(nullptr, std::memory_order_acquire);
+
+		if (t_ClassCache.localFree != nullptr)
+		{
+			t_Block = t_ClassCache.localFree;
+			t_ClassCache.localFree = t_ClassCache.localFree->next;
+		}
+		else
+			t_Block = AllocFromSpan(t_Cache, t_SizeClass);
+	}
+
+	void* t_Ptr = Pointer::Add(t_Block, THREAD_CACHE_HEADER_SIZE);
+	if (a_Alignment > THREAD_CACHE_HEADER_SIZE)
+		t_Ptr = Pointer::Add(t_Ptr, Pointer::AlignForwardAdjustment(t_Ptr, a_Alignment));
+
+	ThreadCacheBlockHeader* t_Header = reinterpret_cast<ThreadCacheBlockHeader*>(Pointer::Subtract(t_Ptr, sizeof(ThreadCacheBlockHeader)));
+	t_Header->cacheIndex = static_cast<uint16_t>(t_CacheIndex);
+	t_Header->sizeClass = static_cast<uint8_t>(t_SizeClass);
+	t_Header->padding = 0;
+	t_Header->offset = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(t_Ptr) - reinterpret_cast<uintptr_t>(t_Block));
+	return t_Ptr;
+}
+
+void ThreadCacheAllocator::Free(void* a_Ptr)
+{
+	BB_ASSERT(a_Ptr != nullptr, "Nullptr send to ThreadCacheAllocator::Free!.");
+	const ThreadCacheBlockHeader t_Header = *reinterpret_cast<const ThreadCacheBlockHeader*>(Pointer::Subtract(a_Ptr, sizeof(ThreadCacheBlockHeader)));
+	FreeNode* t_Block = reinterpret_cast<FreeNode*>(Pointer::Subtract(a_Ptr, t_Header.offset));
+
+	if (t_Header.sizeClass == THREAD_CACHE_LARGE_CLASS)
+	{
+		freeVirtual(t_Block);
+		return;
+	}
+
+	ThreadCache& t_Owner = m_Caches[t_Header.cacheIndex];
+	if (t_Header.cacheIndex == GetThreadSlot())
+	{
+		SizeClassCache& t_ClassCache = t_Owner.classes[t_Header.sizeClass];
+		t_Block->next = t_ClassCache.localFree;
+		t_ClassCache.localFree = t_Block;
+	}
+	else
+	{
+		//Only the owner takes from this queue and it takes all of it, so there is no ABA problem.
+		std::atomic<FreeNode*>& t_Queue = t_Owner.remoteFree[t_Header.sizeClass];
+		FreeNode* t_Head = t_Queue.load(std::memory_order_relaxed);
+		do
+		{
+			t_Block->next = t_Head;
+		} while (!t_Queue.compare_exchange_weak(t_Head, t_Block, std::memory_order_release, std::memory_order_relaxed));
+	}
+}
+
+void* ThreadCacheAllocator::AllocFromSpan(ThreadCache& a_Cache, const uint32_t a_SizeClass)
+{
+	SizeClassCache& t_ClassCache = a_Cache.classes[a_SizeClass];
+	const size_t t_ClassSize = ClassToSize(a_SizeClass);
+
+	if (static_cast<size_t>(t_ClassCache.spanEnd - t_ClassCache.spanPosition) < t_ClassSize)
+	{
+		//Big classes still get a couple of blocks out of a span.
+		size_t t_SpanSize = THREAD_CACHE_SPAN_SIZE;
+		if (t_SpanSize < t_ClassSize * 8)
+			t_SpanSize = t_ClassSize * 8;
+
+		uint8_t* t_Span;
+		{
+			std::lock_guard<std::mutex> t_Lock(m_BackingMutex);
+			t_Span = BBnewArr(m_BackingAllocator, sizeof(SpanHeader) + THREAD_CACHE_HEADER_SIZE + t_SpanSize, uint8_t);
+		}
+		SpanHeader* t_SpanHeader = reinterpret_cast<SpanHeader*>(t_Span);
+		t_SpanHeader->next = a_Cache.spans;
+		a_Cache.spans = t_SpanHeader;
+
+		uint8_t* t_Start = t_Span + sizeof(SpanHeader);
+		t_Start += Pointer::AlignForwardAdjustment(t_Start, THREAD_CACHE_HEADER_SIZE);
+		t_ClassCache.spanPosition = t_Start;
+		t_ClassCache.spanEnd = t_Start + t_SpanSize;
+	}
+
+	void* t_Block = t_ClassCache.spanPosition;
+	t_ClassCache.spanPosition += t_ClassSize;
+	return t_Block;
+}
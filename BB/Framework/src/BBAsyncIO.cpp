@@ -0,0 +1,518 @@
+#include "BBAsyncIO.hpp"
+#include "Program.h"
+#include "Utils/Logger.h"
+#include "Utils.h"
+#include "Math.inl"
+
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstring>
+
+#ifdef _LINUX
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#endif //_LINUX
+
+using namespace BB;
+
+constexpr const uint32_t MAX_IO_THREADS = 16;
+
+#ifdef _LINUX
+//The rings shared with the kernel, io_uring is called through syscall so liburing is not needed.
+struct IOUring
+{
+	int fd = -1;
+	uint32_t entries = 0;
+
+	void* sqRing = nullptr;
+	size_t sqRingSize = 0;
+	void* cqRing = nullptr;
+	size_t cqRingSize = 0;
+	io_uring_sqe* sqes = nullptr;
+	size_t sqesSize = 0;
+
+	uint32_t* sqHead;
+	uint32_t* sqTail;
+	uint32_t sqMask;
+	uint32_t* sqArray;
+	uint32_t* cqHead;
+	uint32_t* cqTail;
+	uint32_t cqMask;
+	io_uring_cqe* cqes;
+};
+#endif //_LINUX
+
+struct AsyncIOState
+{
+	ASYNC_IO_BACKEND backend = ASYNC_IO_BACKEND::NONE;
+	std::atomic<uint32_t> inFlight{ 0 };
+
+	//Thread pool, requests are linked with AsyncReadRequest::next.
+	std::mutex queueMutex;
+	std::condition_variable queueCondition;
+	AsyncReadRequest* queueHead = nullptr;
+	AsyncReadRequest* queueTail = nullptr;
+	bool destroy = false;
+	uint32_t threadCount = 0;
+	OSThreadHandle threads[MAX_IO_THREADS]{};
+
+#ifdef _LINUX
+	//Only one thread fills the submission ring at a time, the completion thread is the only one reading the completion ring.
+	std::mutex submitMutex;
+	IOUring ring;
+	//Submitters wait here without holding submitMutex when the ring is full, the completion thread wakes them.
+	std::mutex ringSpaceMutex;
+	std::condition_variable ringSpaceCondition;
+	std::atomic<uint32_t> ringSpaceWaiters{ 0 };
+#endif //_LINUX
+};
+
+static AsyncIOState s_AsyncIO;
+
+//The caller may free or reuse the request as soon as the state changes, so everything is read out of it first.
+static void CompleteRequest(AsyncReadRequest* a_Request, const bool a_Success, const uint64_t a_BytesRead)
+{
+	void(*t_CompletionJob)(void*) = a_Request->completionJob;
+	void* t_CompletionParameter = a_Request->completionParameter;
+	JobCounter* t_Counter = a_Request->counter;
+
+	a_Request->bytesRead = a_BytesRead;
+	a_Request->state.store(a_Success ? ASYNC_READ_STATE::DONE : ASYNC_READ_STATE::FAILED, std::memory_order_release);
+
+	//The job adds itself to the counter before the read is removed from it, so the counter never hits 0 in between.
+	if (t_CompletionJob)
+		Threads::StartTaskThread(t_CompletionJob, t_CompletionParameter, t_Counter);
+	if (t_Counter)
+		t_Counter->value.fetch_sub(1, std::memory_order_release);
+}
+
+static void FinishRead(AsyncReadRequest* a_Request, const bool a_Success, const uint64_t a_BytesRead)
+{
+	CompleteRequest(a_Request, a_Success, a_BytesRead);
+	s_AsyncIO.inFlight.fetch_sub(1, std::memory_order_release);
+}
+
+//Reads that are too big are never handed to a backend, they fail right away. Also in release, a single read cannot go over ASYNC_READ_MAX_SIZE.
+static bool RejectOversizedRead(AsyncReadRequest& a_Request)
+{
+	if (a_Request.size <= ASYNC_READ_MAX_SIZE)
+		return false;
+
+	Logger::Log_Warning_High(__FILE__, __LINE__, "s", "Async read is too big, split it up in more requests. The read is set to FAILED.");
+	CompleteRequest(&a_Request, false, 0);
+	return true;
+}
+
+#pragma region ThreadPool
+static void IOThreadStartFunc(void*)
+{
+	while (true)
+	{
+		AsyncReadRequest* t_Request;
+		{
+			std::unique_lock<std::mutex> t_Lock(s_AsyncIO.queueMutex);
+			s_AsyncIO.queueCondition.wait(t_Lock, [] { return s_AsyncIO.queueHead != nullptr || s_AsyncIO.destroy; });
+			if (s_AsyncIO.queueHead == nullptr)
+				break;
+
+			t_Request = s_AsyncIO.queueHead;
+			s_AsyncIO.queueHead = t_Request->next;
+			if (s_AsyncIO.queueHead == nullptr)
+				s_AsyncIO.queueTail = nullptr;
+		}
+
+		uint64_t t_BytesRead = 0;
+		const bool t_Success = ReadOSFileAt(t_Request->file, t_Request->buffer, t_Request->size, t_Request->offset, t_BytesRead);
+		FinishRead(t_Request, t_Success, t_BytesRead);
+	}
+}
+
+static void ThreadPoolSubmit(AsyncReadRequest* a_Requests, const uint32_t a_RequestCount)
+{
+	uint32_t t_Next = 0;
+	while (t_Next < a_RequestCount)
+	{
+		//A request is not touched again after it is rejected or queued, so this goes over them in order.
+		if (RejectOversizedRead(a_Requests[t_Next]))
+		{
+			++t_Next;
+			continue;
+		}
+
+		uint32_t t_RunEnd = t_Next + 1;
+		while (t_RunEnd < a_RequestCount && a_Requests[t_RunEnd].size <= ASYNC_READ_MAX_SIZE)
+			++t_RunEnd;
+
+		{
+			std::lock_guard<std::mutex> t_Lock(s_AsyncIO.queueMutex);
+			s_AsyncIO.inFlight.fetch_add(t_RunEnd - t_Next, std::memory_order_relaxed);
+			for (uint32_t i = t_Next; i < t_RunEnd; i++)
+			{
+				a_Requests[i].next = nullptr;
+				if (s_AsyncIO.queueTail == nullptr)
+					s_AsyncIO.queueHead = &a_Requests[i];
+				else
+					s_AsyncIO.queueTail->next = &a_Requests[i];
+				s_AsyncIO.queueTail = &a_Requests[i];
+			}
+		}
+
+		if (t_RunEnd - t_Next == 1)
+			s_AsyncIO.queueCondition.notify_one();
+		else
+			s_AsyncIO.queueCondition.notify_all();
+		t_Next = t_RunEnd;
+	}
+}
+#pragma endregion
+
+#ifdef _LINUX
+#pragma region IOUring
+//user_data of the no-op that tells the completion thread to stop, requests are never at address 0.
+constexpr const uint64_t IO_URING_STOP = 0;
+
+static int IOUringEnter(const uint32_t a_Submit, const uint32_t a_MinComplete, const uint32_t a_Flags)
+{
+	int t_Result;
+	do
+	{
+		t_Result = static_cast<int>(syscall(__NR_io_uring_enter, s_AsyncIO.ring.fd, a_Submit, a_MinComplete, a_Flags, nullptr, 0));
+	} while (t_Result == -1 && errno == EINTR);
+	return t_Result;
+}
+
+static void DestroyIOUring(IOUring& a_Ring)
+{
+	if (a_Ring.sqes != nullptr)
+		munmap(a_Ring.sqes, a_Ring.sqesSize);
+	if (a_Ring.cqRing != nullptr && a_Ring.cqRing != a_Ring.sqRing)
+		munmap(a_Ring.cqRing, a_Ring.cqRingSize);
+	if (a_Ring.sqRing != nullptr)
+		munmap(a_Ring.sqRing, a_Ring.sqRingSize);
+	if (a_Ring.fd != -1)
+		close(a_Ring.fd);
+	a_Ring = IOUring();
+}
+
+static bool CreateIOUring(IOUring& a_Ring, const uint32_t a_QueueDepth)
+{
+	io_uring_params t_Params{};
+	a_Ring.fd = static_cast<int>(syscall(__NR_io_uring_setup, a_QueueDepth, &t_Params));
+	if (a_Ring.fd == -1)
+		return false;
+
+	//IORING_OP_READ came in the same kernel as this feature, older kernels use the thread pool.
+	if ((t_Params.features & IORING_FEAT_RW_CUR_POS) == 0)
+	{
+		DestroyIOUring(a_Ring);
+		return false;
+	}
+
+	a_Ring.entries = t_Params.sq_entries;
+	a_Ring.sqRingSize = t_Params.sq_off.array + t_Params.sq_entries * sizeof(uint32_t);
+	a_Ring.cqRingSize = t_Params.cq_off.cqes + t_Params.cq_entries * sizeof(io_uring_cqe);
+	const bool t_SingleMap = (t_Params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (t_SingleMap)
+		a_Ring.sqRingSize = a_Ring.cqRingSize = Max(a_Ring.sqRingSize, a_Ring.cqRingSize);
+
+	void* t_SqRing = mmap(nullptr, a_Ring.sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, a_Ring.fd, IORING_OFF_SQ_RING);
+	if (t_SqRing == MAP_FAILED)
+	{
+		DestroyIOUring(a_Ring);
+		return false;
+	}
+	a_Ring.sqRing = t_SqRing;
+
+	if (t_SingleMap)
+		a_Ring.cqRing = a_Ring.sqRing;
+	else
+	{
+		void* t_CqRing = mmap(nullptr, a_Ring.cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, a_Ring.fd, IORING_OFF_CQ_RING);
+		if (t_CqRing == MAP_FAILED)
+		{
+			DestroyIOUring(a_Ring);
+			return false;
+		}
+		a_Ring.cqRing = t_CqRing;
+	}
+
+	a_Ring.sqesSize = t_Params.sq_entries * sizeof(io_uring_sqe);
+	void* t_Sqes = mmap(nullptr, a_Ring.sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, a_Ring.fd, IORING_OFF_SQES);
+	if (t_Sqes == MAP_FAILED)
+	{
+		DestroyIOUring(a_Ring);
+		return false;
+	}
+	a_Ring.sqes = reinterpret_cast<io_uring_sqe*>(t_Sqes);
+
+	a_Ring.sqHead = reinterpret_cast<uint32_t*>(Pointer::Add(a_Ring.sqRing, t_Params.sq_off.head));
+	a_Ring.sqTail = reinterpret_cast<uint32_t*>(Pointer::Add(a_Ring.sqRing, t_Params.sq_off.tail));
+	a_Ring.sqMask = *reinterpret_cast<uint32_t*>(Pointer::Add(a_Ring.sqRing, t_Params.sq_off.ring_mask));
+	a_Ring.sqArray = reinterpret_cast<uint32_t*>(Pointer::Add(a_Ring.sqRing, t_Params.sq_off.array));
+	a_Ring.cqHead = reinterpret_cast<uint32_t*>(Pointer::Add(a_Ring.cqRing, t_Params.cq_off.head));
+	a_Ring.cqTail = reinterpret_cast<uint32_t*>(Pointer::Add(a_Ring.cqRing, t_Params.cq_off.tail));
+	a_Ring.cqMask = *reinterpret_cast<uint32_t*>(Pointer::Add(a_Ring.cqRing, t_Params.cq_off.ring_mask));
+	a_Ring.cqes = reinterpret_cast<io_uring_cqe*>(Pointer::Add(a_Ring.cqRing, t_Params.cq_off.cqes));
+	return true;
+}
+
+//Only call with submitMutex locked. IOUringSubmitQueued hands the entry to the kernel.
+static void PushSqe(const uint8_t a_Opcode, const int a_File, void* a_Buffer, const uint32_t a_Size, const uint64_t a_Offset, const uint64_t a_UserData)
+{
+	IOUring& t_Ring = s_AsyncIO.ring;
+	const uint32_t t_Tail = *t_Ring.sqTail;
+	const uint32_t t_Index = t_Tail & t_Ring.sqMask;
+	io_uring_sqe& t_Sqe = t_Ring.sqes[t_Index];
+	memset(&t_Sqe, 0, sizeof(t_Sqe));
+	t_Sqe.opcode = a_Opcode;
+	t_Sqe.fd = a_File;
+	t_Sqe.addr = reinterpret_cast<uint64_t>(a_Buffer);
+	t_Sqe.len = a_Size;
+	t_Sqe.off = a_Offset;
+	t_Sqe.user_data = a_UserData;
+	t_Ring.sqArray[t_Index] = t_Index;
+	//Release so that the kernel sees the entry when it sees the new tail.
+	__atomic_store_n(t_Ring.sqTail, t_Tail + 1, __ATOMIC_RELEASE);
+}
+
+//Wakes the submitters that wait for ring space, call after lowering inFlight.
+static void WakeRingSpaceWaiters()
+{
+	//Pairs with the waiter that adds itself before it checks inFlight, so either it sees the lower inFlight or it is seen here.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (s_AsyncIO.ringSpaceWaiters.load(std::memory_order_relaxed) == 0)
+		return;
+
+	//Taking the lock makes sure a waiter that just checked inFlight is waiting before the notify.
+	{
+		std::lock_guard<std::mutex> t_Lock(s_AsyncIO.ringSpaceMutex);
+	}
+	s_AsyncIO.ringSpaceCondition.notify_all();
+}
+
+//Never have more reads in flight then the ring has entries, so the completion ring cannot overflow.
+//Waits without holding submitMutex until there is space and returns how many of a_Count reads can be submitted, at least 1.
+static uint32_t ReserveRingSpace(const uint32_t a_Count)
+{
+	const uint32_t t_Entries = s_AsyncIO.ring.entries;
+	uint32_t t_InFlight = s_AsyncIO.inFlight.load(std::memory_order_acquire);
+	while (true)
+	{
+		if (t_InFlight >= t_Entries)
+		{
+			s_AsyncIO.ringSpaceWaiters.fetch_add(1, std::memory_order_seq_cst);
+			{
+				std::unique_lock<std::mutex> t_Lock(s_AsyncIO.ringSpaceMutex);
+				s_AsyncIO.ringSpaceCondition.wait(t_Lock, [t_Entries] { return s_AsyncIO.inFlight.load(std::memory_order_seq_cst) < t_Entries; });
+			}
+			s_AsyncIO.ringSpaceWaiters.fetch_sub(1, std::memory_order_relaxed);
+			t_InFlight = s_AsyncIO.inFlight.load(std::memory_order_acquire);
+			continue;
+		}
+
+		const uint32_t t_Reserved = Min(a_Count, t_Entries - t_InFlight);
+		if (s_AsyncIO.inFlight.compare_exchange_weak(t_InFlight, t_InFlight + t_Reserved, std::memory_order_acq_rel))
+			return t_Reserved;
+	}
+}
+
+//Only call with submitMutex locked. Calls io_uring_enter until the kernel took every queued entry.
+//On an error that retrying does not fix the entries it did not take are completed as FAILED, so their counters still go down.
+static void IOUringSubmitQueued()
+{
+	IOUring& t_Ring = s_AsyncIO.ring;
+	while (true)
+	{
+		const uint32_t t_Head = __atomic_load_n(t_Ring.sqHead, __ATOMIC_ACQUIRE);
+		const uint32_t t_Tail = *t_Ring.sqTail;
+		if (t_Head == t_Tail)
+			return;
+
+		const int t_Submitted = IOUringEnter(t_Tail - t_Head, 0, 0);
+		if (t_Submitted > 0)
+			continue;
+		//The kernel is out of memory for requests or the completion ring is full, the completion thread makes space.
+		if (t_Submitted == 0 || errno == EAGAIN || errno == EBUSY)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		Logger::Log_Warning_High(__FILE__, __LINE__, "ss", "io_uring failed to submit reads, the reads are set to FAILED. Error: ", strerror(errno));
+		for (uint32_t t_Entry = t_Head; t_Entry != t_Tail; t_Entry++)
+		{
+			const uint64_t t_UserData = t_Ring.sqes[t_Ring.sqArray[t_Entry & t_Ring.sqMask]].user_data;
+			if (t_UserData != IO_URING_STOP)
+				FinishRead(reinterpret_cast<AsyncReadRequest*>(t_UserData), false, 0);
+		}
+		//The kernel only reads the ring in io_uring_enter, so the entries can be taken back.
+		__atomic_store_n(t_Ring.sqTail, t_Head, __ATOMIC_RELEASE);
+		WakeRingSpaceWaiters();
+		return;
+	}
+}
+
+static void IOUringSubmit(AsyncReadRequest* a_Requests, const uint32_t a_RequestCount)
+{
+	uint32_t t_Next = 0;
+	while (t_Next < a_RequestCount)
+	{
+		//A request is not touched again after it is rejected or submitted, so this goes over them in order.
+		if (RejectOversizedRead(a_Requests[t_Next]))
+		{
+			++t_Next;
+			continue;
+		}
+
+		uint32_t t_RunEnd = t_Next + 1;
+		while (t_RunEnd < a_RequestCount && a_Requests[t_RunEnd].size <= ASYNC_READ_MAX_SIZE)
+			++t_RunEnd;
+
+		const uint32_t t_Reserved = ReserveRingSpace(t_RunEnd - t_Next);
+		std::lock_guard<std::mutex> t_Lock(s_AsyncIO.submitMutex);
+		for (uint32_t i = t_Next; i < t_Next + t_Reserved; i++)
+		{
+			AsyncReadRequest& t_Request = a_Requests[i];
+			PushSqe(IORING_OP_READ,
+				static_cast<int>(t_Request.file.handle),
+				t_Request.buffer,
+				static_cast<uint32_t>(t_Request.size),
+				t_Request.offset,
+				reinterpret_cast<uint64_t>(&t_Request));
+		}
+		IOUringSubmitQueued();
+		t_Next += t_Reserved;
+	}
+}
+
+static void IOUringCompletionThread(void*)
+{
+	IOUring& t_Ring = s_AsyncIO.ring;
+	bool t_Stop = false;
+	while (!t_Stop)
+	{
+		IOUringEnter(0, 1, IORING_ENTER_GETEVENTS);
+
+		uint32_t t_Head = *t_Ring.cqHead;
+		const uint32_t t_Tail = __atomic_load_n(t_Ring.cqTail, __ATOMIC_ACQUIRE);
+		for (; t_Head != t_Tail; t_Head++)
+		{
+			const io_uring_cqe& t_Cqe = t_Ring.cqes[t_Head & t_Ring.cqMask];
+			if (t_Cqe.user_data == IO_URING_STOP)
+			{
+				t_Stop = true;
+				continue;
+			}
+
+			//res is the amount of bytes read or -errno.
+			AsyncReadRequest* t_Request = reinterpret_cast<AsyncReadRequest*>(t_Cqe.user_data);
+			BB_WARNING(t_Cqe.res >= 0, "OS, failed to read from file!", WarningType::HIGH);
+			FinishRead(t_Request, t_Cqe.res >= 0, t_Cqe.res >= 0 ? static_cast<uint64_t>(t_Cqe.res) : 0);
+		}
+		__atomic_store_n(t_Ring.cqHead, t_Head, __ATOMIC_RELEASE);
+		WakeRingSpaceWaiters();
+	}
+}
+#pragma endregion
+#endif //_LINUX
+
+void BB::AsyncIO::InitAsyncIO(const uint32_t a_QueueDepth, const uint32_t a_FallbackThreadCount, const bool a_ForceThreadPool)
+{
+	BB_ASSERT(s_AsyncIO.backend == ASYNC_IO_BACKEND::NONE, "AsyncIO is already initialized!");
+	BB_ASSERT(a_QueueDepth != 0, "AsyncIO queue depth is 0!");
+	s_AsyncIO.destroy = false;
+	s_AsyncIO.inFlight.store(0, std::memory_order_relaxed);
+
+#ifdef _LINUX
+	if (!a_ForceThreadPool)
+	{
+		if (CreateIOUring(s_AsyncIO.ring, a_QueueDepth))
+		{
+			s_AsyncIO.backend = ASYNC_IO_BACKEND::IO_URING;
+			s_AsyncIO.threadCount = 1;
+			s_AsyncIO.threads[0] = OSCreateThread(IOUringCompletionThread, 0, nullptr);
+			return;
+		}
+		BB_WARNING(false, "io_uring is not available, AsyncIO uses a thread pool instead.", WarningType::OPTIMALIZATION);
+	}
+#endif //_LINUX
+
+	BB_ASSERT(a_FallbackThreadCount != 0, "AsyncIO needs at least 1 thread for the thread pool!");
+	BB_ASSERT(a_FallbackThreadCount <= MAX_IO_THREADS, "Trying to create too many AsyncIO threads!");
+	s_AsyncIO.backend = ASYNC_IO_BACKEND::THREAD_POOL;
+	s_AsyncIO.threadCount = a_FallbackThreadCount;
+	for (uint32_t i = 0; i < a_FallbackThreadCount; i++)
+		s_AsyncIO.threads[i] = OSCreateThread(IOThreadStartFunc, 0, nullptr);
+}
+
+void BB::AsyncIO::DestroyAsyncIO()
+{
+	BB_ASSERT(s_AsyncIO.inFlight.load(std::memory_order_acquire) == 0, "Destroying AsyncIO while reads are in flight!");
+
+#ifdef _LINUX
+	if (s_AsyncIO.backend == ASYNC_IO_BACKEND::IO_URING)
+	{
+		{
+			std::lock_guard<std::mutex> t_Lock(s_AsyncIO.submitMutex);
+			PushSqe(IORING_OP_NOP, -1, nullptr, 0, 0, IO_URING_STOP);
+			IOUringSubmitQueued();
+		}
+		for (uint32_t i = 0; i < s_AsyncIO.threadCount; i++)
+			OSWaitThreadfinish(s_AsyncIO.threads[i]);
+		DestroyIOUring(s_AsyncIO.ring);
+	}
+#endif //_LINUX
+
+	if (s_AsyncIO.backend == ASYNC_IO_BACKEND::THREAD_POOL)
+	{
+		{
+			std::lock_guard<std::mutex> t_Lock(s_AsyncIO.queueMutex);
+			s_AsyncIO.destroy = true;
+		}
+		s_AsyncIO.queueCondition.notify_all();
+		for (uint32_t i = 0; i < s_AsyncIO.threadCount; i++)
+			OSWaitThreadfinish(s_AsyncIO.threads[i]);
+	}
+
+	s_AsyncIO.threadCount = 0;
+	s_AsyncIO.backend = ASYNC_IO_BACKEND::NONE;
+}
+
+void BB::AsyncIO::SubmitReads(AsyncReadRequest* a_Requests, const uint32_t a_RequestCount, JobCounter* a_Counter)
+{
+	BB_ASSERT(s_AsyncIO.backend != ASYNC_IO_BACKEND::NONE, "Submitting reads while AsyncIO is not initialized!");
+	for (uint32_t i = 0; i < a_RequestCount; i++)
+	{
+		AsyncReadRequest& t_Request = a_Requests[i];
+		t_Request.state.store(ASYNC_READ_STATE::PENDING, std::memory_order_relaxed);
+		t_Request.bytesRead = 0;
+		t_Request.counter = a_Counter;
+	}
+	if (a_Counter)
+		a_Counter->value.fetch_add(a_RequestCount, std::memory_order_relaxed);
+
+#ifdef _LINUX
+	if (s_AsyncIO.backend == ASYNC_IO_BACKEND::IO_URING)
+	{
+		IOUringSubmit(a_Requests, a_RequestCount);
+		return;
+	}
+#endif //_LINUX
+
+	ThreadPoolSubmit(a_Requests, a_RequestCount);
+}
+
+void BB::AsyncIO::WaitForRead(const AsyncReadRequest& a_Request)
+{
+	while (a_Request.state.load(std::memory_order_acquire) == ASYNC_READ_STATE::PENDING)
+		std::this_thread::yield();
+}
+
+ASYNC_IO_BACKEND BB::AsyncIO::GetBackend()
+{
+	return s_AsyncIO.backend;
+}
@@ -0,0 +1,81 @@
+#include "BBParallel.hpp"
+#include "ScratchAllocator.h"
+#include "ThreadCacheAllocator.h"
+
+using namespace BB;
+
+struct ParallelRange
+{
+	Threads::PFN_ParallelRange range;
+	Threads::PFN_ParallelFinish finish;
+	size_t count;
+	size_t grainSize;
+	size_t chunkCount;
+	std::atomic<size_t> nextChunk{ 0 };
+	std::atomic<uint32_t> nextJobSlot{ 0 };
+	//Copy of the caller's data, placed directly after this struct.
+	void* data;
+};
+
+//Ranges are started and finished from any thread, the finish job mostly frees them on a different thread.
+static FreelistAllocator_t s_ParallelBacking{ mbSize * 2, "Parallel range backing allocator" };
+static ThreadCacheAllocator s_ParallelAllocator{ s_ParallelBacking, "Parallel range allocator" };
+
+static void ParallelRangeJob(void* a_Param)
+{
+	ParallelRange& t_Range = *reinterpret_cast<ParallelRange*>(a_Param);
+	const uint32_t t_JobSlot = t_Range.nextJobSlot.fetch_add(1, std::memory_order_relaxed);
+
+	//Chunks are taken dynamically, a job that finishes early just grabs the next one.
+	for (size_t t_Chunk = t_Range.nextChunk.fetch_add(1, std::memory_order_relaxed);
+		t_Chunk < t_Range.chunkCount;
+		t_Chunk = t_Range.nextChunk.fetch_add(1, std::memory_order_relaxed))
+	{
+		const size_t t_Begin = t_Chunk * t_Range.grainSize;
+		size_t t_End = t_Begin + t_Range.grainSize;
+		if (t_End > t_Range.count)
+			t_End = t_Range.count;
+
+		ScratchScope t_Scratch;
+		t_Range.range(t_Begin, t_End, t_JobSlot, t_Scratch, t_Range.data);
+	}
+}
+
+static void ParallelFinishJob(void* a_Param)
+{
+	ParallelRange* t_Range = reinterpret_cast<ParallelRange*>(a_Param);
+	if (t_Range->finish)
+		t_Range->finish(t_Range->nextJobSlot.load(std::memory_order_relaxed), t_Range->data);
+
+	BBfree(s_ParallelAllocator, t_Range);
+}
+
+ThreadTask BB::Threads::StartParallelRange(const size_t a_Count, const size_t a_GrainSize, PFN_ParallelRange a_Range, PFN_ParallelFinish a_Finish, const void* a_Data, const size_t a_DataSize)
+{
+	BB_ASSERT(a_GrainSize != 0, "Parallel range with a grain size of 0!");
+	BB_ASSERT(a_Range != nullptr, "Parallel range without a range function!");
+
+	const size_t t_HeaderSize = Math::RoundUp(sizeof(ParallelRange), 16);
+	ParallelRange* t_Range = new (BBalloc_f(BB_MEMORY_DEBUG_ARGS s_ParallelAllocator, t_HeaderSize + a_DataSize, 16)) ParallelRange();
+	t_Range->range = a_Range;
+	t_Range->finish = a_Finish;
+	t_Range->count = a_Count;
+	t_Range->grainSize = a_GrainSize;
+	t_Range->chunkCount = (a_Count + a_GrainSize - 1) / a_GrainSize;
+	t_Range->data = Pointer::Add(t_Range, t_HeaderSize);
+	if (a_DataSize)
+		memcpy(t_Range->data, a_Data, a_DataSize);
+
+	//No point in starting more jobs then there are chunks or threads.
+	size_t t_JobCount = GetThreadCount();
+	if (t_JobCount > t_Range->chunkCount)
+		t_JobCount = t_Range->chunkCount;
+	if (t_JobCount > PARALLEL_MAX_JOBS)
+		t_JobCount = PARALLEL_MAX_JOBS;
+
+	ThreadTask t_Jobs[PARALLEL_MAX_JOBS];
+	for (size_t i = 0; i < t_JobCount; i++)
+		t_Jobs[i] = StartTaskThread(ParallelRangeJob, t_Range);
+
+	return StartTaskAfter(ParallelFinishJob, t_Range, t_Jobs, static_cast<uint32_t>(t_JobCount));
+}
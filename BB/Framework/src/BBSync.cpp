@@ -0,0 +1,155 @@
+#include "BBSync.hpp"
+#include "OS/Program.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#endif //__x86_64__ || _M_X64
+
+using namespace BB;
+
+//Tells the core it's a spin loop, this saves power and gives the other hyperthread more time.
+static inline void SpinPause()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+	_mm_pause();
+#elif defined(__aarch64__)
+	__asm__ volatile("yield");
+#endif //__x86_64__ || _M_X64
+}
+
+void FutexMutex::LockSlow()
+{
+	if (m_Contention != nullptr)
+		m_Contention->contended.fetch_add(1, std::memory_order_relaxed);
+
+	for (uint32_t i = 0; i < LOCK_SPIN_COUNT; i++)
+	{
+		SpinPause();
+		uint32_t t_State = m_State.load(std::memory_order_relaxed);
+		if (t_State == UNLOCKED &&
+			m_State.compare_exchange_weak(t_State, LOCKED, std::memory_order_acquire, std::memory_order_relaxed))
+			return;
+	}
+
+	//Taking it as SLEEPERS is safe, at worst the unlock does a wake that nobody needed.
+	uint32_t t_State = m_State.exchange(SLEEPERS, std::memory_order_acquire);
+	while (t_State != UNLOCKED)
+	{
+		if (m_Contention != nullptr)
+			m_Contention->sleeps.fetch_add(1, std::memory_order_relaxed);
+		OSWaitOnAddress(&m_State, SLEEPERS);
+		t_State = m_State.exchange(SLEEPERS, std::memory_order_acquire);
+	}
+}
+
+void FutexMutex::WakeOne()
+{
+	OSWakeOneOnAddress(&m_State);
+}
+
+void RWLock::LockSharedSlow()
+{
+	if (m_Contention != nullptr)
+		m_Contention->contended.fetch_add(1, std::memory_order_relaxed);
+
+	uint32_t t_Spins = 0;
+	while (true)
+	{
+		uint32_t t_State = m_State.load(std::memory_order_relaxed);
+		if ((t_State & (WRITER | WRITER_WAITING)) == 0)
+		{
+			if (m_State.compare_exchange_weak(t_State, t_State + 1, std::memory_order_acquire, std::memory_order_relaxed))
+				return;
+			continue;
+		}
+
+		if (t_Spins++ < LOCK_SPIN_COUNT)
+		{
+			SpinPause();
+			continue;
+		}
+
+		//The unlocks check m_Sleepers after changing the state, if the state changed before this the wait returns right away.
+		if (m_Contention != nullptr)
+			m_Contention->sleeps.fetch_add(1, std::memory_order_relaxed);
+		m_Sleepers.fetch_add(1, std::memory_order_seq_cst);
+		OSWaitOnAddress(&m_State, t_State);
+		m_Sleepers.fetch_sub(1, std::memory_order_relaxed);
+	}
+}
+
+void RWLock::LockSlow()
+{
+	if (m_Contention != nullptr)
+		m_Contention->contended.fetch_add(1, std::memory_order_relaxed);
+
+	uint32_t t_Spins = 0;
+	while (true)
+	{
+		uint32_t t_State = m_State.load(std::memory_order_relaxed);
+		if ((t_State & (READER_MASK | WRITER)) == 0)
+		{
+			//Clear WRITER_WAITING, other waiting writers set it again.
+			if (m_State.compare_exchange_weak(t_State, (t_State | WRITER) & ~WRITER_WAITING, std::memory_order_acquire, std::memory_order_relaxed))
+				return;
+			continue;
+		}
+
+		//Stop new readers right away, the current ones finish.
+		if ((t_State & WRITER_WAITING) == 0)
+		{
+			m_State.fetch_or(WRITER_WAITING, std::memory_order_relaxed);
+			continue;
+		}
+
+		if (t_Spins++ < LOCK_SPIN_COUNT)
+		{
+			SpinPause();
+			continue;
+		}
+
+		if (m_Contention != nullptr)
+			m_Contention->sleeps.fetch_add(1, std::memory_order_relaxed);
+		m_Sleepers.fetch_add(1, std::memory_order_seq_cst);
+		OSWaitOnAddress(&m_State, t_State);
+		m_Sleepers.fetch_sub(1, std::memory_order_relaxed);
+	}
+}
+
+void RWLock::WakeAll()
+{
+	OSWakeAllOnAddress(&m_State);
+}
+
+void TicketLock::LockSlow(const uint32_t a_Ticket)
+{
+	if (m_Contention != nullptr)
+		m_Contention->contended.fetch_add(1, std::memory_order_relaxed);
+
+	//Only the next in line spins, the others would burn the time the owner needs to finish.
+	for (uint32_t i = 0; i < LOCK_SPIN_COUNT; i++)
+	{
+		const uint32_t t_Serving = m_NowServing.load(std::memory_order_acquire);
+		if (t_Serving == a_Ticket)
+			return;
+		if (a_Ticket - t_Serving > 1)
+			break;
+		SpinPause();
+	}
+
+	if (m_Contention != nullptr)
+		m_Contention->sleeps.fetch_add(1, std::memory_order_relaxed);
+	m_Sleepers.fetch_add(1, std::memory_order_seq_cst);
+	uint32_t t_Serving = m_NowServing.load(std::memory_order_acquire);
+	while (t_Serving != a_Ticket)
+	{
+		OSWaitOnAddress(&m_NowServing, t_Serving);
+		t_Serving = m_NowServing.load(std::memory_order_acquire);
+	}
+	m_Sleepers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void TicketLock::WakeAll()
+{
+	OSWakeAllOnAddress(&m_NowServing);
+}
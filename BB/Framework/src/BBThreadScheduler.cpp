@@ -1,104 +1,549 @@
 #include "BBThreadScheduler.hpp"
 #include "Program.h"
 
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
 using namespace BB;
 
-enum class THREAD_STATUS : uint32_t
-{
-	IDLE,
-	BUSY,
-	DESTROY
-};
+//Jobs are stored in pages that are never freed while the scheduler is alive,
+//this keeps a job index valid for the ThreadTask handle and allows unbounded submission.
+constexpr const uint32_t POOL_PAGE_SIZE = 256;
+constexpr const uint32_t POOL_PAGE_MAX = 1024;
+constexpr const uint32_t JOB_INVALID_INDEX = UINT32_MAX;
+constexpr const int64_t DEQUE_START_CAPACITY = 256;
+constexpr const uint32_t MAX_WORKER_THREADS = 32;
 
-struct ThreadInfo
+//Job::state holds the generation in the upper 32 bits and the continuation list head in the lower 32 bits.
+//Finishing a job swaps both in one go, so a continuation is either in the list or sees the job as finished.
+static inline uint32_t StateGeneration(const uint64_t a_State) { return static_cast<uint32_t>(a_State >> 32); }
+static inline uint32_t StateContinuation(const uint64_t a_State) { return static_cast<uint32_t>(a_State); }
+static inline uint64_t MakeState(const uint32_t a_Generation, const uint32_t a_Continuation) { return static_cast<uint64_t>(a_Generation) << 32 | a_Continuation; }
+
+struct Job
 {
 	void(*function)(void*);
 	void* functionParameter;
-	THREAD_STATUS threadStatus;
-	//debug value for the ThreadHandle extraIndex;
-	uint32_t generation;
+	JobCounter* counter;
+	//ThreadTask.extraIndex holds the generation the job was started with.
+	std::atomic<uint64_t> state{ MakeState(1, JOB_INVALID_INDEX) };
+	//Tasks this job still waits on, +1 while the job is being set up.
+	std::atomic<uint32_t> dependencies{ 0 };
+	//Used for the free list and the global queue, atomic since a thief may read it while the job is reused.
+	std::atomic<uint32_t> next{ JOB_INVALID_INDEX };
 };
 
-static void ThreadStartFunc(void* a_Args)
+//A job that waits on another job, one is made for every dependency.
+struct Continuation
 {
-	ThreadInfo* t_ThreadInfo = reinterpret_cast<ThreadInfo*>(a_Args);
-	while (t_ThreadInfo->threadStatus != THREAD_STATUS::DESTROY)
+	uint32_t jobIndex;
+	std::atomic<uint32_t> next{ JOB_INVALID_INDEX };
+};
+
+//Growable pool with stable indices and a lock-free free list, used for jobs and continuations.
+template<typename T>
+struct PagedPool
+{
+	struct Page
 	{
-		if (t_ThreadInfo->function != nullptr)
+		T elements[POOL_PAGE_SIZE];
+	};
+
+	std::atomic<Page*> pages[POOL_PAGE_MAX]{};
+	std::atomic<uint32_t> pageCount{ 0 };
+	//Tagged free list head, lower 32 bits is the index and the upper 32 bits a tag against ABA.
+	std::atomic<uint64_t> freeHead{ JOB_INVALID_INDEX };
+
+	inline T& Get(const uint32_t a_Index)
+	{
+		return pages[a_Index / POOL_PAGE_SIZE].load(std::memory_order_acquire)->elements[a_Index % POOL_PAGE_SIZE];
+	}
+
+	inline bool Valid(const uint32_t a_Index) const
+	{
+		return a_Index < pageCount.load(std::memory_order_acquire) * POOL_PAGE_SIZE;
+	}
+
+	uint32_t Alloc(Allocator a_Allocator, std::mutex& a_AllocatorMutex)
+	{
+		uint64_t t_Head = freeHead.load(std::memory_order_acquire);
+		while (static_cast<uint32_t>(t_Head) != JOB_INVALID_INDEX)
 		{
-			t_ThreadInfo->threadStatus = THREAD_STATUS::BUSY;
-			t_ThreadInfo->function(t_ThreadInfo->functionParameter);
-			++t_ThreadInfo->generation;
-			t_ThreadInfo->function = nullptr;
-			t_ThreadInfo->functionParameter = nullptr;
-			t_ThreadInfo->threadStatus = THREAD_STATUS::IDLE;
+			const uint32_t t_Index = static_cast<uint32_t>(t_Head);
+			const uint64_t t_NewHead = ((t_Head >> 32) + 1) << 32 | Get(t_Index).next.load(std::memory_order_relaxed);
+			if (freeHead.compare_exchange_weak(t_Head, t_NewHead, std::memory_order_acq_rel, std::memory_order_acquire))
+				return t_Index;
 		}
+
+		//Nothing free, add a new page and put all but the first element in the free list.
+		std::lock_guard<std::mutex> t_Lock(a_AllocatorMutex);
+		const uint32_t t_PageIndex = pageCount.load(std::memory_order_relaxed);
+		BB_ASSERT(t_PageIndex < POOL_PAGE_MAX, "Too many jobs in flight, increase POOL_PAGE_MAX.");
+		Page* t_Page = BBnew(a_Allocator, Page)();
+		const uint32_t t_FirstIndex = t_PageIndex * POOL_PAGE_SIZE;
+		for (uint32_t i = 1; i < POOL_PAGE_SIZE - 1; i++)
+			t_Page->elements[i].next.store(t_FirstIndex + i + 1, std::memory_order_relaxed);
+
+		pages[t_PageIndex].store(t_Page, std::memory_order_release);
+		pageCount.store(t_PageIndex + 1, std::memory_order_release);
+
+		t_Head = freeHead.load(std::memory_order_acquire);
+		do
+		{
+			t_Page->elements[POOL_PAGE_SIZE - 1].next.store(static_cast<uint32_t>(t_Head), std::memory_order_relaxed);
+		} while (!freeHead.compare_exchange_weak(t_Head, ((t_Head >> 32) + 1) << 32 | (t_FirstIndex + 1), std::memory_order_acq_rel, std::memory_order_acquire));
+
+		return t_FirstIndex;
+	}
+
+	void Free(const uint32_t a_Index)
+	{
+		T& t_Element = Get(a_Index);
+		uint64_t t_Head = freeHead.load(std::memory_order_acquire);
+		do
+		{
+			t_Element.next.store(static_cast<uint32_t>(t_Head), std::memory_order_relaxed);
+		} while (!freeHead.compare_exchange_weak(t_Head, ((t_Head >> 32) + 1) << 32 | a_Index, std::memory_order_acq_rel, std::memory_order_acquire));
 	}
-}
 
-struct Thread
+	void Reset()
+	{
+		for (uint32_t i = 0; i < POOL_PAGE_MAX; i++)
+			pages[i].store(nullptr, std::memory_order_relaxed);
+		pageCount.store(0, std::memory_order_relaxed);
+		freeHead.store(JOB_INVALID_INDEX, std::memory_order_relaxed);
+	}
+};
+
+//Chase-Lev work stealing deque, only the owning worker pushes and pops at the bottom.
+//Other workers steal from the top. Based on "Correct and Efficient Work-Stealing for Weak Memory Models".
+struct WorkDeque
+{
+	struct Ring
+	{
+		int64_t capacity;
+		std::atomic<uint32_t>* buffer;
+		//Kept alive until the scheduler is destroyed since a thief might still read from it.
+		Ring* previous;
+
+		inline uint32_t Get(const int64_t a_Index) const { return buffer[a_Index & (capacity - 1)].load(std::memory_order_relaxed); }
+		inline void Put(const int64_t a_Index, const uint32_t a_Value) { buffer[a_Index & (capacity - 1)].store(a_Value, std::memory_order_relaxed); }
+	};
+
+	std::atomic<int64_t> top{ 0 };
+	std::atomic<int64_t> bottom{ 0 };
+	std::atomic<Ring*> ring{ nullptr };
+};
+
+struct Worker
 {
 	OSThreadHandle osThreadHandle;
-	ThreadInfo threadInfo; //used to send functions to threads
+	WorkDeque deque;
+	uint32_t workerIndex;
 };
 
 struct ThreadScheduler
 {
 	uint32_t threadCount = 0;
-	Thread threads[32]{};
+	Worker workers[MAX_WORKER_THREADS]{};
+
+	PagedPool<Job> jobs;
+	PagedPool<Continuation> continuations;
+
+	//Jobs that are started from a thread that is not a worker go here.
+	std::mutex globalQueueMutex;
+	uint32_t globalQueueHead = JOB_INVALID_INDEX;
+	uint32_t globalQueueTail = JOB_INVALID_INDEX;
+
+	//Sleeping workers wait on this when no jobs are queued.
+	std::mutex sleepMutex;
+	std::condition_variable sleepCondition;
+	std::atomic<uint32_t> sleepingWorkers{ 0 };
+	std::atomic<uint32_t> queuedJobs{ 0 };
+
+	std::atomic<bool> destroy{ false };
+
+	//Only used for rare growth (pool pages and deque rings).
+	std::mutex allocatorMutex;
+	FreelistAllocator_t allocator{ mbSize * 4, "Thread scheduler allocator" };
 };
 
 static ThreadScheduler s_ThreadScheduler;
+//Index into ThreadScheduler::workers, JOB_INVALID_INDEX when this thread is not a worker.
+static thread_local uint32_t s_WorkerIndex = JOB_INVALID_INDEX;
+//Used to pick a random victim when stealing.
+static thread_local uint32_t s_StealSeed = 2654435761u;
+
+static WorkDeque::Ring* CreateRing(const int64_t a_Capacity, WorkDeque::Ring* a_Previous)
+{
+	std::lock_guard<std::mutex> t_Lock(s_ThreadScheduler.allocatorMutex);
+	WorkDeque::Ring* t_Ring = BBnew(s_ThreadScheduler.allocator, WorkDeque::Ring);
+	t_Ring->capacity = a_Capacity;
+	t_Ring->buffer = reinterpret_cast<std::atomic<uint32_t>*>(BBalloc(s_ThreadScheduler.allocator, sizeof(std::atomic<uint32_t>) * a_Capacity));
+	for (int64_t i = 0; i < a_Capacity; i++)
+		new (&t_Ring->buffer[i]) std::atomic<uint32_t>(JOB_INVALID_INDEX);
+	t_Ring->previous = a_Previous;
+	return t_Ring;
+}
+
+#pragma region Deque
+static void DequePush(WorkDeque& a_Deque, const uint32_t a_JobIndex)
+{
+	const int64_t t_Bottom = a_Deque.bottom.load(std::memory_order_relaxed);
+	const int64_t t_Top = a_Deque.top.load(std::memory_order_acquire);
+	WorkDeque::Ring* t_Ring = a_Deque.ring.load(std::memory_order_relaxed);
+
+	if (t_Bottom - t_Top > t_Ring->capacity - 1)
+	{
+		WorkDeque::Ring* t_NewRing = CreateRing(t_Ring->capacity * 2, t_Ring);
+		for (int64_t i = t_Top; i < t_Bottom; i++)
+			t_NewRing->Put(i, t_Ring->Get(i));
+		a_Deque.ring.store(t_NewRing, std::memory_order_release);
+		t_Ring = t_NewRing;
+	}
+
+	t_Ring->Put(t_Bottom, a_JobIndex);
+	//Release so that a thief sees the job data when it sees the new bottom.
+	a_Deque.bottom.store(t_Bottom + 1, std::memory_order_release);
+}
+
+static uint32_t DequePop(WorkDeque& a_Deque)
+{
+	const int64_t t_Bottom = a_Deque.bottom.load(std::memory_order_relaxed) - 1;
+	WorkDeque::Ring* t_Ring = a_Deque.ring.load(std::memory_order_relaxed);
+	a_Deque.bottom.store(t_Bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t t_Top = a_Deque.top.load(std::memory_order_relaxed);
+
+	uint32_t t_JobIndex = JOB_INVALID_INDEX;
+	if (t_Top <= t_Bottom)
+	{
+		t_JobIndex = t_Ring->Get(t_Bottom);
+		if (t_Top == t_Bottom)
+		{
+			//Last job, race against the thieves.
+			if (!a_Deque.top.compare_exchange_strong(t_Top, t_Top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				t_JobIndex = JOB_INVALID_INDEX;
+			a_Deque.bottom.store(t_Bottom + 1, std::memory_order_relaxed);
+		}
+	}
+	else
+		a_Deque.bottom.store(t_Bottom + 1, std::memory_order_relaxed);
+
+	return t_JobIndex;
+}
+
+static uint32_t DequeSteal(WorkDeque& a_Deque)
+{
+	int64_t t_Top = a_Deque.top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	const int64_t t_Bottom = a_Deque.bottom.load(std::memory_order_acquire);
+
+	if (t_Top < t_Bottom)
+	{
+		WorkDeque::Ring* t_Ring = a_Deque.ring.load(std::memory_order_acquire);
+		const uint32_t t_JobIndex = t_Ring->Get(t_Top);
+		if (!a_Deque.top.compare_exchange_strong(t_Top, t_Top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return JOB_INVALID_INDEX;
+		return t_JobIndex;
+	}
+	return JOB_INVALID_INDEX;
+}
+#pragma endregion
+
+static inline Job& GetJob(const uint32_t a_Index)
+{
+	return s_ThreadScheduler.jobs.Get(a_Index);
+}
+
+static uint32_t PopGlobalQueue()
+{
+	std::lock_guard<std::mutex> t_Lock(s_ThreadScheduler.globalQueueMutex);
+	const uint32_t t_JobIndex = s_ThreadScheduler.globalQueueHead;
+	if (t_JobIndex != JOB_INVALID_INDEX)
+	{
+		s_ThreadScheduler.globalQueueHead = GetJob(t_JobIndex).next.load(std::memory_order_relaxed);
+		if (s_ThreadScheduler.globalQueueHead == JOB_INVALID_INDEX)
+			s_ThreadScheduler.globalQueueTail = JOB_INVALID_INDEX;
+	}
+	return t_JobIndex;
+}
+
+//Puts a job that has no unfinished dependencies in a queue and wakes a worker.
+static void EnqueueJob(const uint32_t a_JobIndex)
+{
+	if (s_WorkerIndex != JOB_INVALID_INDEX)
+		DequePush(s_ThreadScheduler.workers[s_WorkerIndex].deque, a_JobIndex);
+	else
+	{
+		GetJob(a_JobIndex).next.store(JOB_INVALID_INDEX, std::memory_order_relaxed);
+		std::lock_guard<std::mutex> t_Lock(s_ThreadScheduler.globalQueueMutex);
+		if (s_ThreadScheduler.globalQueueTail == JOB_INVALID_INDEX)
+			s_ThreadScheduler.globalQueueHead = a_JobIndex;
+		else
+			GetJob(s_ThreadScheduler.globalQueueTail).next.store(a_JobIndex, std::memory_order_relaxed);
+		s_ThreadScheduler.globalQueueTail = a_JobIndex;
+	}
+
+	s_ThreadScheduler.queuedJobs.fetch_add(1, std::memory_order_seq_cst);
+	if (s_ThreadScheduler.sleepingWorkers.load(std::memory_order_seq_cst) != 0)
+	{
+		//Lock so that a worker that is about to sleep cannot miss the notify.
+		{
+			std::lock_guard<std::mutex> t_Lock(s_ThreadScheduler.sleepMutex);
+		}
+		s_ThreadScheduler.sleepCondition.notify_one();
+	}
+}
+
+static inline void ReleaseDependency(const uint32_t a_JobIndex)
+{
+	if (GetJob(a_JobIndex).dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		EnqueueJob(a_JobIndex);
+}
+
+//Works for both workers and other threads, a non-worker only has the global queue and stealing.
+static uint32_t FindJob()
+{
+	uint32_t t_JobIndex = JOB_INVALID_INDEX;
+	if (s_WorkerIndex != JOB_INVALID_INDEX)
+		t_JobIndex = DequePop(s_ThreadScheduler.workers[s_WorkerIndex].deque);
+	if (t_JobIndex == JOB_INVALID_INDEX)
+		t_JobIndex = PopGlobalQueue();
+
+	if (t_JobIndex == JOB_INVALID_INDEX && s_ThreadScheduler.threadCount != 0)
+	{
+		//xorshift to pick a starting victim, then go over all of them.
+		s_StealSeed ^= s_StealSeed << 13;
+		s_StealSeed ^= s_StealSeed >> 17;
+		s_StealSeed ^= s_StealSeed << 5;
+		const uint32_t t_Start = s_StealSeed % s_ThreadScheduler.threadCount;
+		for (uint32_t i = 0; i < s_ThreadScheduler.threadCount && t_JobIndex == JOB_INVALID_INDEX; i++)
+		{
+			const uint32_t t_Victim = (t_Start + i) % s_ThreadScheduler.threadCount;
+			if (t_Victim != s_WorkerIndex)
+				t_JobIndex = DequeSteal(s_ThreadScheduler.workers[t_Victim].deque);
+		}
+	}
+
+	if (t_JobIndex != JOB_INVALID_INDEX)
+		s_ThreadScheduler.queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+
+	return t_JobIndex;
+}
+
+static void ExecuteJob(const uint32_t a_JobIndex)
+{
+	Job& t_Job = GetJob(a_JobIndex);
+	t_Job.function(t_Job.functionParameter);
+
+	JobCounter* t_Counter = t_Job.counter;
+	//Bump the generation and close the continuation list at the same time.
+	uint64_t t_State = t_Job.state.load(std::memory_order_relaxed);
+	while (!t_Job.state.compare_exchange_weak(t_State, MakeState(StateGeneration(t_State) + 1, JOB_INVALID_INDEX), std::memory_order_acq_rel, std::memory_order_relaxed)) {}
+
+	if (t_Counter)
+		t_Counter->value.fetch_sub(1, std::memory_order_release);
+
+	uint32_t t_ContinuationIndex = StateContinuation(t_State);
+	while (t_ContinuationIndex != JOB_INVALID_INDEX)
+	{
+		Continuation& t_Continuation = s_ThreadScheduler.continuations.Get(t_ContinuationIndex);
+		const uint32_t t_Next = t_Continuation.next.load(std::memory_order_relaxed);
+		ReleaseDependency(t_Continuation.jobIndex);
+		s_ThreadScheduler.continuations.Free(t_ContinuationIndex);
+		t_ContinuationIndex = t_Next;
+	}
+
+	s_ThreadScheduler.jobs.Free(a_JobIndex);
+}
+
+//Runs a single queued job on the calling thread, returns false if nothing was found.
+static bool HelpWithJob()
+{
+	const uint32_t t_JobIndex = FindJob();
+	if (t_JobIndex == JOB_INVALID_INDEX)
+		return false;
+
+	ExecuteJob(t_JobIndex);
+	return true;
+}
+
+static void ThreadStartFunc(void* a_Args)
+{
+	Worker& t_Worker = *reinterpret_cast<Worker*>(a_Args);
+	s_WorkerIndex = t_Worker.workerIndex;
+	s_StealSeed = t_Worker.workerIndex * 2654435761u + 1;
+
+	while (!s_ThreadScheduler.destroy.load(std::memory_order_acquire))
+	{
+		if (HelpWithJob())
+			continue;
+
+		//Nothing to do, sleep until a job gets queued instead of spinning.
+		std::unique_lock<std::mutex> t_Lock(s_ThreadScheduler.sleepMutex);
+		s_ThreadScheduler.sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+		s_ThreadScheduler.sleepCondition.wait(t_Lock, []
+			{
+				return s_ThreadScheduler.queuedJobs.load(std::memory_order_seq_cst) > 0 ||
+					s_ThreadScheduler.destroy.load(std::memory_order_seq_cst);
+			});
+		s_ThreadScheduler.sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+	}
+}
 
 void BB::Threads::InitThreads(const uint32_t a_ThreadCount)
 {
-	BB_ASSERT(a_ThreadCount < _countof(s_ThreadScheduler.threads), "Trying to create too many threads!");
+	BB_ASSERT(a_ThreadCount != 0, "Trying to create 0 threads!");
+	BB_ASSERT(a_ThreadCount <= _countof(s_ThreadScheduler.workers), "Trying to create too many threads!");
 	s_ThreadScheduler.threadCount = a_ThreadCount;
+	s_ThreadScheduler.destroy.store(false, std::memory_order_relaxed);
 
 	for (uint32_t i = 0; i < s_ThreadScheduler.threadCount; i++)
 	{
-		s_ThreadScheduler.threads[i].threadInfo.function = nullptr;
-		s_ThreadScheduler.threads[i].threadInfo.functionParameter = nullptr;
-		s_ThreadScheduler.threads[i].threadInfo.threadStatus = THREAD_STATUS::IDLE;
-		s_ThreadScheduler.threads[i].threadInfo.generation = 0;
-		s_ThreadScheduler.threads[i].osThreadHandle = OSCreateThread(ThreadStartFunc,
+		Worker& t_Worker = s_ThreadScheduler.workers[i];
+		t_Worker.workerIndex = i;
+		t_Worker.deque.top.store(0, std::memory_order_relaxed);
+		t_Worker.deque.bottom.store(0, std::memory_order_relaxed);
+		t_Worker.deque.ring.store(CreateRing(DEQUE_START_CAPACITY, nullptr), std::memory_order_relaxed);
+	}
+
+	//Start the threads after all the deques exist, workers steal from eachother.
+	//Every worker stays on its own core so the jobs it pushes are still in that core's cache when it pops them.
+	//With more workers then cores pinning only makes them fight over a core, so let the OS place them.
+	const bool t_PinWorkers = s_ThreadScheduler.threadCount <= std::thread::hardware_concurrency();
+	for (uint32_t i = 0; i < s_ThreadScheduler.threadCount; i++)
+	{
+		s_ThreadScheduler.workers[i].osThreadHandle = OSCreateThread(ThreadStartFunc,
 			0,
-			&s_ThreadScheduler.threads[i].threadInfo);
+			&s_ThreadScheduler.workers[i],
+			t_PinWorkers ? i : OS_THREAD_ANY_CORE);
 	}
 }
 
 void BB::Threads::DestroyThreads()
 {
-	for (uint32_t i = 0; i < s_ThreadScheduler.threadCount; i++)
 	{
-		s_ThreadScheduler.threads[i].threadInfo.threadStatus = THREAD_STATUS::DESTROY;
+		std::lock_guard<std::mutex> t_Lock(s_ThreadScheduler.sleepMutex);
+		s_ThreadScheduler.destroy.store(true, std::memory_order_seq_cst);
 	}
+	s_ThreadScheduler.sleepCondition.notify_all();
+
+	//Workers finish their current job first.
+	for (uint32_t i = 0; i < s_ThreadScheduler.threadCount; i++)
+		OSWaitThreadfinish(s_ThreadScheduler.workers[i].osThreadHandle);
+
+	s_ThreadScheduler.allocator.Clear();
+	s_ThreadScheduler.jobs.Reset();
+	s_ThreadScheduler.continuations.Reset();
+	s_ThreadScheduler.globalQueueHead = JOB_INVALID_INDEX;
+	s_ThreadScheduler.globalQueueTail = JOB_INVALID_INDEX;
+	s_ThreadScheduler.queuedJobs.store(0, std::memory_order_relaxed);
+	s_ThreadScheduler.threadCount = 0;
 }
 
-ThreadTask BB::Threads::StartTaskThread(void(*a_Function)(void*), void* a_FuncParameter)
+ThreadTask BB::Threads::StartTaskThread(void(*a_Function)(void*), void* a_FuncParameter, JobCounter* a_Counter)
 {
-	for (uint32_t i = 0; i < s_ThreadScheduler.threadCount; i++)
+	return StartTaskAfter(a_Function, a_FuncParameter, nullptr, 0, a_Counter);
+}
+
+ThreadTask BB::Threads::StartTaskAfter(void(*a_Function)(void*), void* a_FuncParameter, const ThreadTask* a_Dependencies, const uint32_t a_DependencyCount, JobCounter* a_Counter)
+{
+	BB_ASSERT(s_ThreadScheduler.threadCount != 0, "Starting a task while the thread scheduler is not initialized!");
+	const uint32_t t_JobIndex = s_ThreadScheduler.jobs.Alloc(s_ThreadScheduler.allocator, s_ThreadScheduler.allocatorMutex);
+	Job& t_Job = GetJob(t_JobIndex);
+	t_Job.function = a_Function;
+	t_Job.functionParameter = a_FuncParameter;
+	t_Job.counter = a_Counter;
+	//The extra dependency stops the job from starting while the continuations are still being added.
+	t_Job.dependencies.store(a_DependencyCount + 1, std::memory_order_relaxed);
+	const ThreadTask t_Task(t_JobIndex, StateGeneration(t_Job.state.load(std::memory_order_relaxed)));
+
+	if (a_Counter)
+		a_Counter->value.fetch_add(1, std::memory_order_relaxed);
+
+	for (uint32_t i = 0; i < a_DependencyCount; i++)
 	{
-		if (s_ThreadScheduler.threads[i].threadInfo.threadStatus == THREAD_STATUS::IDLE)
+		const ThreadTask t_Dependency = a_Dependencies[i];
+		bool t_Added = false;
+		if (s_ThreadScheduler.jobs.Valid(t_Dependency.index))
 		{
-			s_ThreadScheduler.threads[i].threadInfo.function = a_Function;
-			s_ThreadScheduler.threads[i].threadInfo.functionParameter = a_FuncParameter;
-			return ThreadTask(i, s_ThreadScheduler.threads[i].threadInfo.generation + 1);
+			Job& t_DependencyJob = GetJob(t_Dependency.index);
+			uint64_t t_State = t_DependencyJob.state.load(std::memory_order_acquire);
+			if (StateGeneration(t_State) == t_Dependency.extraIndex)
+			{
+				const uint32_t t_ContinuationIndex = s_ThreadScheduler.continuations.Alloc(s_ThreadScheduler.allocator, s_ThreadScheduler.allocatorMutex);
+				Continuation& t_Continuation = s_ThreadScheduler.continuations.Get(t_ContinuationIndex);
+				t_Continuation.jobIndex = t_JobIndex;
+				do
+				{
+					t_Continuation.next.store(StateContinuation(t_State), std::memory_order_relaxed);
+					if (t_DependencyJob.state.compare_exchange_weak(t_State, MakeState(t_Dependency.extraIndex, t_ContinuationIndex), std::memory_order_acq_rel, std::memory_order_acquire))
+					{
+						t_Added = true;
+						break;
+					}
+				} while (StateGeneration(t_State) == t_Dependency.extraIndex);
+
+				if (!t_Added)
+					s_ThreadScheduler.continuations.Free(t_ContinuationIndex);
+			}
 		}
+
+		//Dependency already finished.
+		if (!t_Added)
+			t_Job.dependencies.fetch_sub(1, std::memory_order_relaxed);
 	}
-	BB_ASSERT(false, "No free threads! Maybe implement a way to just re-iterate over the list again.");
-	return 0;
+
+	ReleaseDependency(t_JobIndex);
+	return t_Task;
 }
 
 void BB::Threads::WaitForTask(const ThreadTask a_Handle)
 {
-	while (s_ThreadScheduler.threads->threadInfo.generation < a_Handle.extraIndex) {};
+	while (!TaskFinished(a_Handle))
+		if (!HelpWithJob())
+			std::this_thread::yield();
 }
 
 bool BB::Threads::TaskFinished(const ThreadTask a_Handle)
 {
-	if (s_ThreadScheduler.threads->threadInfo.generation <= a_Handle.extraIndex)
+	//An empty handle or a handle from before the scheduler restarted is always finished.
+	if (!s_ThreadScheduler.jobs.Valid(a_Handle.index))
 		return true;
 
-	return false;
-}
\ No newline at end of file
+	return StateGeneration(GetJob(a_Handle.index).state.load(std::memory_order_acquire)) != a_Handle.extraIndex;
+}
+
+void BB::Threads::WaitForTasks(const ThreadTask* a_Tasks, const uint32_t a_TaskCount)
+{
+	for (uint32_t i = 0; i < a_TaskCount; i++)
+		WaitForTask(a_Tasks[i]);
+}
+
+uint32_t BB::Threads::WaitForAnyTask(const ThreadTask* a_Tasks, const uint32_t a_TaskCount)
+{
+	BB_ASSERT(a_TaskCount != 0, "Waiting for any task of an empty list!");
+	while (true)
+	{
+		for (uint32_t i = 0; i < a_TaskCount; i++)
+			if (TaskFinished(a_Tasks[i]))
+				return i;
+
+		if (!HelpWithJob())
+			std::this_thread::yield();
+	}
+}
+
+void BB::Threads::WaitForCounter(const JobCounter& a_Counter)
+{
+	while (a_Counter.value.load(std::memory_order_acquire) != 0)
+		if (!HelpWithJob())
+			std::this_thread::yield();
+}
+
+uint32_t BB::Threads::GetThreadCount()
+{
+	return s_ThreadScheduler.threadCount;
+}
@@ -2,139 +2,300 @@
 #include "OS/Program.h"
 
 #include "Utils/Utils.h"
-#include <string>
+#include <immintrin.h>
 
 using namespace BB;
 
-enum class TOKEN_TYPE : uint32_t
+#pragma region Stage 1
+//Stage 1 looks at 64 bytes at the same time, every character is one bit in a uint64_t mask.
+//Based on simdjson: https://arxiv.org/abs/1902.08318
+
+#ifdef __AVX2__
+using JsonSimd = __m256i;
+constexpr const uint32_t JSON_SIMD_WIDTH = 32;
+static inline JsonSimd JsonLoad(const char* a_Chars) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a_Chars)); }
+static inline JsonSimd JsonSet(const char a_Char) { return _mm256_set1_epi8(a_Char); }
+static inline JsonSimd JsonEqual(const JsonSimd a_A, const JsonSimd a_B) { return _mm256_cmpeq_epi8(a_A, a_B); }
+static inline JsonSimd JsonOr(const JsonSimd a_A, const JsonSimd a_B) { return _mm256_or_si256(a_A, a_B); }
+static inline uint64_t JsonMoveMask(const JsonSimd a_Mask) { return static_cast<uint32_t>(_mm256_movemask_epi8(a_Mask)); }
+#else
+using JsonSimd = __m128i;
+constexpr const uint32_t JSON_SIMD_WIDTH = 16;
+static inline JsonSimd JsonLoad(const char* a_Chars) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(a_Chars)); }
+static inline JsonSimd JsonSet(const char a_Char) { return _mm_set1_epi8(a_Char); }
+static inline JsonSimd JsonEqual(const JsonSimd a_A, const JsonSimd a_B) { return _mm_cmpeq_epi8(a_A, a_B); }
+static inline JsonSimd JsonOr(const JsonSimd a_A, const JsonSimd a_B) { return _mm_or_si128(a_A, a_B); }
+static inline uint64_t JsonMoveMask(const JsonSimd a_Mask) { return static_cast<uint32_t>(_mm_movemask_epi8(a_Mask)); }
+#endif //__AVX2__
+
+constexpr const uint32_t JSON_BLOCK_SIZE = 64;
+constexpr const uint64_t JSON_EVEN_BITS = 0x5555555555555555ull;
+
+struct JsonBlock
 {
-	OUT_OF_TOKENS,
-	CURLY_OPEN,
-	CURLY_CLOSE,
-	COLON,
-	STRING,
-	NUMBER,
-	ARRAY_OPEN,
-	ARRAY_CLOSE,
-	COMMA,
-	BOOLEAN,
-	NULL_TYPE
+	uint64_t whitespace = 0;
+	uint64_t op = 0; //{}[]:,
+	uint64_t quote = 0;
+	uint64_t backslash = 0;
 };
 
-//16 bytes
-struct BB::Token
+static inline JsonBlock ClassifyJsonBlock(const char* a_Chars)
 {
-	TOKEN_TYPE type = TOKEN_TYPE::OUT_OF_TOKENS;
-	uint32_t strSize = 0;
-	char* str = nullptr;
-};
+	JsonBlock t_Block;
+	for (uint32_t i = 0; i < JSON_BLOCK_SIZE; i += JSON_SIMD_WIDTH)
+	{
+		const JsonSimd t_Chars = JsonLoad(a_Chars + i);
+		//'[' and ']' are '{' and '}' without the 0x20 bit, so one compare finds both.
+		const JsonSimd t_Lower = JsonOr(t_Chars, JsonSet(0x20));
+		const JsonSimd t_Op = JsonOr(JsonOr(JsonEqual(t_Lower, JsonSet('{')), JsonEqual(t_Lower, JsonSet('}'))),
+			JsonOr(JsonEqual(t_Chars, JsonSet(':')), JsonEqual(t_Chars, JsonSet(','))));
+		const JsonSimd t_Whitespace = JsonOr(JsonOr(JsonEqual(t_Chars, JsonSet(' ')), JsonEqual(t_Chars, JsonSet('\t'))),
+			JsonOr(JsonEqual(t_Chars, JsonSet('\n')), JsonEqual(t_Chars, JsonSet('\r'))));
 
-static char ignoreWhiteSpace(JsonFile& a_JsonFile)
+		t_Block.op |= JsonMoveMask(t_Op) << i;
+		t_Block.whitespace |= JsonMoveMask(t_Whitespace) << i;
+		t_Block.quote |= JsonMoveMask(JsonEqual(t_Chars, JsonSet('"'))) << i;
+		t_Block.backslash |= JsonMoveMask(JsonEqual(t_Chars, JsonSet('\\'))) << i;
+	}
+	return t_Block;
+}
+
+//Characters that come after an odd amount of backslashes.
+static inline uint64_t FindEscaped(uint64_t a_Backslash, uint64_t& a_PrevEscaped)
 {
-	char t_C = a_JsonFile.fileData.data[a_JsonFile.pos++];
-	while ((t_C == ' ' || t_C == '\n' || t_C == '\r'))
+	if (a_Backslash == 0)
 	{
-		BB_ASSERT(a_JsonFile.pos <= a_JsonFile.fileData.size, "out of tokens");
-		t_C = a_JsonFile.fileData.data[a_JsonFile.pos++];
+		const uint64_t t_Escaped = a_PrevEscaped;
+		a_PrevEscaped = 0;
+		return t_Escaped;
 	}
 
-	return t_C;
+	//If the last block ended with an escaping backslash the first character is escaped and not a backslash.
+	a_Backslash &= ~a_PrevEscaped;
+	const uint64_t t_FollowsEscape = (a_Backslash << 1) | a_PrevEscaped;
+
+	//Adding the start of a backslash sequence to the sequence carries to the end of it, sequences that start on an odd bit
+	//then end with a carry on the other parity which gets flipped in the mask.
+	const uint64_t t_OddSequenceStarts = a_Backslash & ~JSON_EVEN_BITS & ~t_FollowsEscape;
+	const uint64_t t_SequencesStartingOnEvenBits = t_OddSequenceStarts + a_Backslash;
+	a_PrevEscaped = t_SequencesStartingOnEvenBits < t_OddSequenceStarts ? 1 : 0;
+	const uint64_t t_InvertMask = t_SequencesStartingOnEvenBits << 1;
+
+	return (JSON_EVEN_BITS ^ t_InvertMask) & t_FollowsEscape;
 }
 
-Token GetToken(JsonFile& a_JsonFile)
+//Every bit becomes the xor of itself and all bits below it, this turns the quotes into a mask of everything inside of a string.
+static inline uint64_t PrefixXor(uint64_t a_Bits)
 {
-	Token t_Token;
+#ifdef __PCLMUL__
+	const __m128i t_Result = _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<int64_t>(a_Bits)), _mm_set1_epi8(-1), 0);
+	return static_cast<uint64_t>(_mm_cvtsi128_si64(t_Result));
+#else
+	a_Bits ^= a_Bits << 1;
+	a_Bits ^= a_Bits << 2;
+	a_Bits ^= a_Bits << 4;
+	a_Bits ^= a_Bits << 8;
+	a_Bits ^= a_Bits << 16;
+	a_Bits ^= a_Bits << 32;
+	return a_Bits;
+#endif //__PCLMUL__
+}
+
+JsonStructuralIndex BB::BuildJsonStructuralIndex(Allocator a_Allocator, const char* a_Data, const size_t a_Size)
+{
+	BB_ASSERT(a_Size < UINT32_MAX, "Json text is too big for 32 bit structural positions.");
+	JsonStructuralIndex t_Index;
+	//Worst case every character is a structural position, +1 for the sentinel.
+	t_Index.positions = BBnewArr(a_Allocator, a_Size + 1, uint32_t);
 
-	if (a_JsonFile.pos > a_JsonFile.fileData.size) //If we are at the end of the file, we will produce no more tokens.
+	uint64_t t_PrevEscaped = 0;
+	uint64_t t_PrevInString = 0;
+	uint64_t t_PrevScalar = 0;
+	uint32_t t_Count = 0;
+	char t_LastBlock[JSON_BLOCK_SIZE];
+	for (size_t t_Offset = 0; t_Offset < a_Size; t_Offset += JSON_BLOCK_SIZE)
 	{
-		t_Token.type = TOKEN_TYPE::OUT_OF_TOKENS;
-		return t_Token;
+		const char* t_Chars = a_Data + t_Offset;
+		if (a_Size - t_Offset < JSON_BLOCK_SIZE)
+		{
+			//Pad with whitespace so the last block can use the same SIMD loads.
+			memset(t_LastBlock, ' ', JSON_BLOCK_SIZE);
+			memcpy(t_LastBlock, t_Chars, a_Size - t_Offset);
+			t_Chars = t_LastBlock;
+		}
+		const JsonBlock t_Block = ClassifyJsonBlock(t_Chars);
+
+		const uint64_t t_Quote = t_Block.quote & ~FindEscaped(t_Block.backslash, t_PrevEscaped);
+		//Includes the opening quote but not the closing quote.
+		const uint64_t t_InString = PrefixXor(t_Quote) ^ t_PrevInString;
+		t_PrevInString = static_cast<uint64_t>(static_cast<int64_t>(t_InString) >> 63);
+		//Everything in the string after the opening quote, the closing quote included.
+		const uint64_t t_StringTail = t_InString ^ t_Quote;
+
+		//The start of a number, true, false, null or string is any non whitespace that does not follow another scalar character.
+		const uint64_t t_Scalar = ~(t_Block.op | t_Block.whitespace);
+		const uint64_t t_NonQuoteScalar = t_Scalar & ~t_Quote;
+		const uint64_t t_FollowsNonQuoteScalar = (t_NonQuoteScalar << 1) | t_PrevScalar;
+		t_PrevScalar = t_NonQuoteScalar >> 63;
+		const uint64_t t_ScalarStart = t_Scalar & ~t_FollowsNonQuoteScalar;
+
+		uint64_t t_Structurals = (t_Block.op | t_ScalarStart) & ~t_StringTail;
+		while (t_Structurals != 0)
+		{
+			t_Index.positions[t_Count++] = static_cast<uint32_t>(t_Offset + Math::FindFirstSetBit(t_Structurals));
+			t_Structurals &= t_Structurals - 1;
+		}
 	}
+	BB_WARNING(t_PrevInString == 0, "Json text ends inside of a string.", WarningType::HIGH);
 
-	char t_C = ignoreWhiteSpace(a_JsonFile);
+	t_Index.positions[t_Count] = static_cast<uint32_t>(a_Size);
+	t_Index.count = t_Count;
+	return t_Index;
+}
 
-	if (t_C == '"') //is string
-	{
-		//get string length
-		size_t t_StrLen = 0;
-		while (a_JsonFile.fileData.data[a_JsonFile.pos + t_StrLen] != '"')
-			++t_StrLen;
+#pragma endregion
 
-		t_Token.type = TOKEN_TYPE::STRING;
-		t_Token.strSize = static_cast<uint32_t>(t_StrLen);
-		t_Token.str = &a_JsonFile.fileData.data[a_JsonFile.pos];
+#pragma region Stage 2
+//Stage 2 only looks at the structural positions, values are skipped by counting the depth of the brackets.
 
-		a_JsonFile.pos += t_StrLen + 1; //includes the last "
-	}
-	else if (t_C == '-' || (t_C >= '0' && t_C <= '9')) //is number
-	{
-		//get string length which are numbers
-		size_t t_StrLen = 1;
-		char t_Num = a_JsonFile.fileData.data[a_JsonFile.pos + t_StrLen];
-		while (t_Num == '-' || (t_Num >= '0' && t_Num <= '9') || t_Num == '.')
-			t_Num = a_JsonFile.fileData.data[a_JsonFile.pos + t_StrLen++];
+static inline bool IsJsonWhitespace(const char a_Char)
+{
+	return a_Char == ' ' || a_Char == '\n' || a_Char == '\r' || a_Char == '\t';
+}
 
-		t_Token.type = TOKEN_TYPE::NUMBER;
-		t_Token.strSize = static_cast<uint32_t>(t_StrLen);
-		t_Token.str = &a_JsonFile.fileData.data[a_JsonFile.pos - 1];
+static inline char JsonCharAt(const char* a_Data, const JsonStructuralIndex& a_Index, const uint32_t a_Position)
+{
+	return a_Data[a_Index.positions[a_Position]];
+}
 
-		a_JsonFile.pos += t_StrLen - 1; //includes the last
-	}
-	else if (t_C == 'f') {
-		t_Token.type = TOKEN_TYPE::BOOLEAN;
-		t_Token.strSize = 5;
-		t_Token.str = &a_JsonFile.fileData.data[a_JsonFile.pos - 1];
-		//Do a janky check to see if False was actually correctly written.
-		BB_WARNING(Memory::Compare("false", &a_JsonFile.fileData.data[a_JsonFile.pos - 1], 5) == 0,
-			"JSON file tried to read a boolean that was set to True but it's not written as True!",
-			WarningType::MEDIUM);
-		a_JsonFile.pos += 4;
-	}
-	else if (t_C == 't') {
-		t_Token.type = TOKEN_TYPE::BOOLEAN;
-		t_Token.strSize = 4;
-		t_Token.str = &a_JsonFile.fileData.data[a_JsonFile.pos - 1];
-		//Do a janky check to see if True was actually correctly written.
-		BB_WARNING(Memory::Compare("true", &a_JsonFile.fileData.data[a_JsonFile.pos - 1], 4) == 0,
-			"JSON file tried to read a boolean that was set to True but it's not written as True!",
-			WarningType::MEDIUM);
-		a_JsonFile.pos += 3;
-	}
-	else if (t_C == 'n') {
-		t_Token.type = TOKEN_TYPE::NULL_TYPE;
-		BB_WARNING(Memory::Compare("null", &a_JsonFile.fileData.data[a_JsonFile.pos - 1], 4) == 0,
-			"JSON file tried to read a boolean that was set to True but it's not written as True!",
-			WarningType::MEDIUM);
-		a_JsonFile.pos += 3;
-	}
-	else if (t_C == '{')
-	{
-		t_Token.type = TOKEN_TYPE::CURLY_OPEN;
-	}
-	else if (t_C == '}')
+//Returns the structural position after the value, nested objects and lists are skipped.
+static uint32_t SkipJsonValue(const char* a_Data, const JsonStructuralIndex& a_Index, uint32_t a_Position)
+{
+	const char t_Char = JsonCharAt(a_Data, a_Index, a_Position++);
+	if (t_Char != '{' && t_Char != '[')
+		return a_Position;
+
+	uint32_t t_Depth = 1;
+	while (t_Depth != 0 && a_Position < a_Index.count)
 	{
-		t_Token.type = TOKEN_TYPE::CURLY_CLOSE;
+		const char t_Next = JsonCharAt(a_Data, a_Index, a_Position++);
+		if (t_Next == '{' || t_Next == '[')
+			++t_Depth;
+		else if (t_Next == '}' || t_Next == ']')
+			--t_Depth;
 	}
-	else if (t_C == '[')
+	BB_WARNING(t_Depth == 0, "Json object or list is not closed.", WarningType::HIGH);
+	return a_Position;
+}
+
+//A string or scalar ends before the next structural position, the whitespace in between is not part of it.
+static const char* JsonScalarEnd(const char* a_Data, const JsonStructuralIndex& a_Index, const uint32_t a_Position)
+{
+	const char* t_Begin = a_Data + a_Index.positions[a_Position];
+	const char* t_End = a_Data + a_Index.positions[a_Position + 1];
+	while (t_End > t_Begin + 1 && IsJsonWhitespace(t_End[-1]))
+		--t_End;
+	return t_End;
+}
+
+static Slice<const char> GetJsonString(const char* a_Data, const JsonStructuralIndex& a_Index, const uint32_t a_Position)
+{
+	BB_ASSERT(JsonCharAt(a_Data, a_Index, a_Position) == '"', "Json value is not a string.");
+	const char* t_Begin = a_Data + a_Index.positions[a_Position] + 1;
+	//Do not include the closing quote.
+	const char* t_End = JsonScalarEnd(a_Data, a_Index, a_Position) - 1;
+	return Slice<const char>(t_Begin, t_End > t_Begin ? t_End : t_Begin);
+}
+
+//Powers of 10 that are exact in a double.
+constexpr const double JSON_POWERS_OF_TEN[23]
+{
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+//Exact for numbers with up to 19 significant digits and small exponents, further away it can be off by a few ulps.
+static double ParseJsonNumber(const char* a_Begin, const char* a_End)
+{
+	const char* t_Char = a_Begin;
+	const bool t_Negative = t_Char < a_End && *t_Char == '-';
+	if (t_Negative)
+		++t_Char;
+
+	uint64_t t_Mantissa = 0;
+	uint32_t t_Digits = 0;
+	int32_t t_Exponent = 0;
+	for (; t_Char < a_End && *t_Char >= '0' && *t_Char <= '9'; ++t_Char)
 	{
-		t_Token.type = TOKEN_TYPE::ARRAY_OPEN;
+		if (t_Digits < 19)
+		{
+			t_Mantissa = t_Mantissa * 10 + static_cast<uint64_t>(*t_Char - '0');
+			if (t_Mantissa != 0)
+				++t_Digits;
+		}
+		else
+			++t_Exponent;
 	}
-	else if (t_C == ']')
+
+	if (t_Char < a_End && *t_Char == '.')
 	{
-		t_Token.type = TOKEN_TYPE::ARRAY_CLOSE;
+		for (++t_Char; t_Char < a_End && *t_Char >= '0' && *t_Char <= '9'; ++t_Char)
+		{
+			if (t_Digits < 19)
+			{
+				t_Mantissa = t_Mantissa * 10 + static_cast<uint64_t>(*t_Char - '0');
+				if (t_Mantissa != 0)
+					++t_Digits;
+				--t_Exponent;
+			}
+		}
 	}
-	else if (t_C == ':')
+
+	if (t_Char < a_End && (*t_Char == 'e' || *t_Char == 'E'))
 	{
-		t_Token.type = TOKEN_TYPE::COLON;
+		++t_Char;
+		const bool t_NegativeExponent = t_Char < a_End && *t_Char == '-';
+		if (t_Char < a_End && (*t_Char == '-' || *t_Char == '+'))
+			++t_Char;
+
+		int32_t t_WrittenExponent = 0;
+		for (; t_Char < a_End && *t_Char >= '0' && *t_Char <= '9'; ++t_Char)
+			if (t_WrittenExponent < 10000)
+				t_WrittenExponent = t_WrittenExponent * 10 + (*t_Char - '0');
+		t_Exponent += t_NegativeExponent ? -t_WrittenExponent : t_WrittenExponent;
 	}
-	else if (t_C == ',')
+	BB_WARNING(t_Char == a_End, "Json number has characters that are not part of a number.", WarningType::MEDIUM);
+
+	double t_Value = static_cast<double>(t_Mantissa);
+	if (t_Value != 0.0)
 	{
-		t_Token.type = TOKEN_TYPE::COMMA;
+		for (; t_Exponent > 22; t_Exponent -= 22)
+			t_Value *= JSON_POWERS_OF_TEN[22];
+		for (; t_Exponent < -22; t_Exponent += 22)
+			t_Value /= JSON_POWERS_OF_TEN[22];
+		if (t_Exponent >= 0)
+			t_Value *= JSON_POWERS_OF_TEN[t_Exponent];
+		else
+			t_Value /= JSON_POWERS_OF_TEN[-t_Exponent];
 	}
+	return t_Negative ? -t_Value : t_Value;
+}
 
-	return t_Token;
+//After a value there is a , or the closing bracket. A trailing comma before the closing bracket is allowed.
+//Returns false when the closing bracket is reached.
+static bool NextJsonElement(const char* a_Data, const JsonStructuralIndex& a_Index, uint32_t& a_Position, const char a_Close)
+{
+	if (a_Position >= a_Index.count)
+		return false;
+	if (JsonCharAt(a_Data, a_Index, a_Position) == ',')
+		++a_Position;
+	else
+		BB_WARNING(JsonCharAt(a_Data, a_Index, a_Position) == a_Close, "Json element is not followed by a , or closing bracket.", WarningType::HIGH);
+	return a_Position < a_Index.count && JsonCharAt(a_Data, a_Index, a_Position) != a_Close;
 }
 
+#pragma endregion
+
 void BB::JsonNodeToString(const JsonNode* a_Node, String& a_String)
 {
 	switch (a_Node->type)
@@ -148,7 +309,7 @@ void BB::JsonNodeToString(const JsonNode* a_Node, String& a_String)
 		while (t_Pair != nullptr)
 		{
 			a_String.append("\"");
-			a_String.append(t_Pair->name);
+			a_String.append(t_Pair->key);
 			a_String.append("\"");
 			a_String.append(" : ");
 			JsonNodeToString(t_Pair->node, a_String);
@@ -199,296 +360,726 @@ void BB::JsonNodeToString(const JsonNode* a_Node, String& a_String)
 	}
 }
 
+#pragma region JsonParser
+
 JsonParser::JsonParser(const char* a_Path)
 	: m_Allocator(mbSize * 8, a_Path)
 {
-	m_JsonFile.fileData = ReadOSFile(m_Allocator, a_Path);
+	m_JsonData = MapOSFile(a_Path, OS_FILE_ACCESS_HINT::SEQUENTIAL);
+	m_Mapped = true;
 }
 
 JsonParser::JsonParser(const Buffer& a_Buffer)
 	: m_Allocator(mbSize * 8, "Json from memory read")
 {
-	m_JsonFile.fileData = a_Buffer;
+	m_JsonData = a_Buffer;
 }
 
 JsonParser::~JsonParser()
 {
+	if (m_Mapped)
+		UnmapOSFile(m_JsonData);
 	m_Allocator.Clear();
 }
 
-JsonNode* JsonParser::PraseSingleToken(const Token& a_Token)
+void JsonParser::Parse()
 {
-	JsonNode* t_Node;
-	switch (a_Token.type)
-	{
-	case TOKEN_TYPE::CURLY_OPEN:
-		t_Node = ParseObject();
-		break;
-	case TOKEN_TYPE::ARRAY_OPEN:
-		t_Node = ParseList();
-		break;
-	case TOKEN_TYPE::STRING:
-		t_Node = ParseString(a_Token);
-		break;
-	case TOKEN_TYPE::NUMBER:
-		t_Node = ParseNumber(a_Token);
-		break;
-	case TOKEN_TYPE::BOOLEAN:
-		t_Node = ParseBoolean(a_Token);
-		break;
-	default:
-		BB_WARNING(false, "unknown json token found.", WarningType::HIGH);
-		break;
-	}
-	return t_Node;
+	m_Index = BuildJsonStructuralIndex(m_Allocator, m_JsonData.data, m_JsonData.size);
+	BB_WARNING(m_Index.count != 0, "Json text is empty.", WarningType::MEDIUM);
+	if (m_Index.count == 0)
+		return;
+
+	uint32_t t_Position = 0;
+	m_RootNode = ParseValue(t_Position);
 }
 
-void JsonParser::Parse()
+JsonNode* JsonParser::ParseValue(uint32_t& a_Index)
 {
-	Token t_Token = GetToken(m_JsonFile);
-	m_RootNode = PraseSingleToken(t_Token);
-
-	//ignore?
-	/*t_Token = GetToken(m_JsonFile);
-	JsonNode* t_NextRoot = m_RootNode;
-	while (t_Token.type != TOKEN_TYPE::OUT_OF_TOKENS)
+	switch (JsonCharAt(m_JsonData.data, m_Index, a_Index))
 	{
-		t_NextRoot->next = PraseSingleToken(t_Token);
-		t_Token = GetToken(m_JsonFile);
-		t_NextRoot = m_RootNode->next;
+	case '{':
+		return ParseObject(a_Index);
+	case '[':
+		return ParseList(a_Index);
+	case '"':
+		return ParseString(a_Index);
+	case 't':
+	case 'f':
+		return ParseBoolean(a_Index);
+	case 'n':
+		return ParseNull(a_Index);
+	default:
+		return ParseNumber(a_Index);
 	}
-	t_NextRoot->next = nullptr;*/
 }
 
-JsonNode* JsonParser::ParseObject()
+JsonNode* JsonParser::ParseObject(uint32_t& a_Index)
 {
+	const char* t_Data = m_JsonData.data;
 	JsonNode* t_ObjectNode = BBnew(m_Allocator, JsonNode);
 	t_ObjectNode->type = JSON_TYPE::OBJECT;
 
-	JsonObject::Pair* t_PairHead = BBnew(m_Allocator, JsonObject::Pair);
+	JsonObject::Pair* t_PairHead = nullptr;
+	JsonObject::Pair* t_LastPair = nullptr;
 	uint32_t t_PairCount = 0;
 
-	Token t_NextToken = GetToken(m_JsonFile);
-	uint32_t t_ArrayIndex = 0;
-
-	JsonObject::Pair* t_Pair = t_PairHead;
-	bool t_ContinueLoop = true;
+	++a_Index; //the {
+	bool t_ContinueLoop = a_Index < m_Index.count && JsonCharAt(t_Data, m_Index, a_Index) != '}';
 	while (t_ContinueLoop)
 	{
-		BB_WARNING(t_NextToken.type == TOKEN_TYPE::STRING, "Object does not start with a string!", WarningType::HIGH);
-		char* t_ElementName = BBnewArr(m_Allocator, t_NextToken.strSize + 1, char);
-		Memory::Copy(t_ElementName, t_NextToken.str, t_NextToken.strSize);
-		t_ElementName[t_NextToken.strSize] = '\0';
-
-		t_NextToken = GetToken(m_JsonFile);
-		BB_WARNING(t_NextToken.type == TOKEN_TYPE::COLON, "token after string is not a :", WarningType::HIGH);
-		t_NextToken = GetToken(m_JsonFile); //the value
+		BB_WARNING(JsonCharAt(t_Data, m_Index, a_Index) == '"', "Object does not start with a string!", WarningType::HIGH);
+		//Keys are interned, the same key in every object and file shares one copy and finding it is an integer compare.
+		const Slice<const char> t_Key = GetJsonString(t_Data, m_Index, a_Index++);
+		BB_WARNING(JsonCharAt(t_Data, m_Index, a_Index) == ':', "token after string is not a :", WarningType::HIGH);
+		++a_Index;
 
-		t_Pair->name = t_ElementName;
-		switch (t_NextToken.type)
-		{
-		case TOKEN_TYPE::CURLY_OPEN:
-			t_Pair->node = ParseObject();
-			break;
-		case TOKEN_TYPE::ARRAY_OPEN:
-			t_Pair->node = ParseList();
-			break;
-		case TOKEN_TYPE::STRING:
-			t_Pair->node = ParseString(t_NextToken);
-			break;
-		case TOKEN_TYPE::NUMBER:
-			t_Pair->node = ParseNumber(t_NextToken);
-			break;
-		case TOKEN_TYPE::BOOLEAN:
-			t_Pair->node = ParseBoolean(t_NextToken);
-			break;
-		case TOKEN_TYPE::NULL_TYPE:
-			t_Pair->node = ParseNull();
-			break;
-		case TOKEN_TYPE::OUT_OF_TOKENS:
-			BB_ASSERT(false, "OUT_OF_TOKENS while reading a list in JSON");
-			break;
-		}
-
-		t_NextToken = GetToken(m_JsonFile);
-
-		++t_PairCount;
-		if (t_NextToken.type == TOKEN_TYPE::CURLY_CLOSE)
-			t_ContinueLoop = false;
+		JsonObject::Pair* t_Pair = BBnew(m_Allocator, JsonObject::Pair);
+		t_Pair->name = InternString(t_Key.data(), t_Key.size());
+		if (t_Pair->name.IsValid())
+			t_Pair->key = GetInternedString(t_Pair->name);
 		else
 		{
-			BB_ASSERT(t_NextToken.type == TOKEN_TYPE::COMMA, "the token after a object pair should be a } or ,");
-			t_NextToken = GetToken(m_JsonFile);
-			t_Pair->next = BBnew(m_Allocator, JsonObject::Pair);
-			t_Pair = t_Pair->next;
+			//Collision or a full string table, keep the key so the pair can still be found by it's string.
+			char* t_KeyCopy = BBnewArr(m_Allocator, t_Key.size() + 1, char);
+			Memory::Copy(t_KeyCopy, t_Key.data(), t_Key.size());
+			t_KeyCopy[t_Key.size()] = '\0';
+			t_Pair->key = t_KeyCopy;
 		}
+		t_Pair->node = ParseValue(a_Index);
+		if (t_LastPair == nullptr)
+			t_PairHead = t_Pair;
+		else
+			t_LastPair->next = t_Pair;
+		t_LastPair = t_Pair;
+		++t_PairCount;
+
+		t_ContinueLoop = NextJsonElement(t_Data, m_Index, a_Index, '}');
 	}
+	++a_Index; //the }
+
 	t_ObjectNode->object = BBnew(m_Allocator, JsonObject)(m_Allocator, t_PairCount, t_PairHead);
-	t_Pair = t_PairHead;
-	for (size_t i = 0; i < t_PairCount; i++)
+	for (JsonObject::Pair* t_Pair = t_PairHead; t_Pair != nullptr; t_Pair = t_Pair->next)
 	{
-		t_ObjectNode->object->map.insert(t_Pair->name, t_Pair->node);
-		t_Pair = t_Pair->next;
+		//InternString already logged the error, the key can only be found with JsonObject::Find.
+		if (!t_Pair->name.IsValid())
+			continue;
+
+		//Like most parsers the first value of a duplicate key is the one that is found.
+		if (t_ObjectNode->object->map.find(t_Pair->name) == nullptr)
+			t_ObjectNode->object->map.insert(t_Pair->name, t_Pair->node);
+		else
+			BB_WARNING(false, "Json object has a duplicate key, only the first value can be found.", WarningType::MEDIUM);
 	}
 
 	return t_ObjectNode;
 }
 
-JsonNode* JsonParser::ParseList()
+JsonNode* JsonObject::Find(const char* a_Key) const
 {
+	for (const Pair* t_Pair = pairLL; t_Pair != nullptr; t_Pair = t_Pair->next)
+		if (strcmp(t_Pair->key, a_Key) == 0)
+			return t_Pair->node;
+	return nullptr;
+}
+
+JsonNode* JsonParser::ParseList(uint32_t& a_Index)
+{
+	const char* t_Data = m_JsonData.data;
 	JsonNode* t_Node = BBnew(m_Allocator, JsonNode);
 	t_Node->type = JSON_TYPE::LIST;
 
+	//Count the elements first, nested values are skipped over the structural positions so this does not touch the text.
+	const uint32_t t_ListStart = ++a_Index; //the [
 	uint32_t t_ListSize = 0;
-	const uint32_t t_ListStartPos = static_cast<uint32_t>(m_JsonFile.pos);
-	Token t_NextToken = GetToken(m_JsonFile);
-	while (t_NextToken.type != TOKEN_TYPE::ARRAY_CLOSE) //get how many tokens we need to allocate
+	bool t_ContinueLoop = a_Index < m_Index.count && JsonCharAt(t_Data, m_Index, a_Index) != ']';
+	while (t_ContinueLoop)
 	{
-		switch (t_NextToken.type)
-		{
-		case TOKEN_TYPE::CURLY_OPEN:
-		{
-			uint32_t t_ObjectStack = 1;
-			bool t_LocalLoop = true;
-			t_NextToken = GetToken(m_JsonFile);
-			while (t_LocalLoop)
-			{
-				if (t_NextToken.type == TOKEN_TYPE::CURLY_OPEN)
-				{
-					++t_ObjectStack;
-				}
-				else if (t_NextToken.type == TOKEN_TYPE::CURLY_CLOSE)
-				{
-					if (--t_ObjectStack == 0)
-						t_LocalLoop = false;
-				}
-				else
-					t_NextToken = GetToken(m_JsonFile);
-			}
-			++t_ListSize;
-		}
-		break;
-		case TOKEN_TYPE::ARRAY_OPEN:
-		{
-			uint32_t t_ArrayStack = 1;
-			t_NextToken = GetToken(m_JsonFile);
-			bool t_LocalLoop = true;
-			while (t_LocalLoop)
-			{
-				if (t_NextToken.type == TOKEN_TYPE::ARRAY_OPEN)
-				{
-					++t_ArrayStack;
-				}
-				else if (t_NextToken.type == TOKEN_TYPE::ARRAY_CLOSE)
-				{
-					if (--t_ArrayStack == 0)
-						t_LocalLoop = false;
-				}
-				else
-					t_NextToken = GetToken(m_JsonFile);
-			}
-			++t_ListSize;
-		}
-		break;
-		case TOKEN_TYPE::STRING:
-		case TOKEN_TYPE::NUMBER:
-		case TOKEN_TYPE::BOOLEAN:
-		case TOKEN_TYPE::NULL_TYPE:
-			++t_ListSize;
-			break;
-		case TOKEN_TYPE::OUT_OF_TOKENS:
-			BB_ASSERT(false, "OUT_OF_TOKENS while reading a list in JSON");
-			break;
-		}
-
-		t_NextToken = GetToken(m_JsonFile);
+		a_Index = SkipJsonValue(t_Data, m_Index, a_Index);
+		++t_ListSize;
+		t_ContinueLoop = NextJsonElement(t_Data, m_Index, a_Index, ']');
 	}
-	//reset position back to the start of the list and iterate again
-	m_JsonFile.pos = t_ListStartPos;
 
 	t_Node->list.nodeCount = t_ListSize;
-	t_Node->list.nodes = BBnewArr(m_Allocator, t_Node->list.nodeCount, JsonNode*);
+	t_Node->list.nodes = t_ListSize != 0 ? BBnewArr(m_Allocator, t_Node->list.nodeCount, JsonNode*) : nullptr;
 
-	t_NextToken = GetToken(m_JsonFile);
-
-	uint32_t t_NodeIndex = 0;
-	while(t_NextToken.type != TOKEN_TYPE::ARRAY_CLOSE)
+	a_Index = t_ListStart;
+	for (uint32_t i = 0; i < t_ListSize; i++)
 	{
-		switch (t_NextToken.type)
-		{
-		case TOKEN_TYPE::CURLY_OPEN:
-			t_Node->list.nodes[t_NodeIndex++] = ParseObject();
-			break;
-		case TOKEN_TYPE::ARRAY_OPEN:
-			t_Node->list.nodes[t_NodeIndex++] = ParseList();
-			break;
-		case TOKEN_TYPE::STRING:
-			t_Node->list.nodes[t_NodeIndex++] = ParseString(t_NextToken);
-			break;
-		case TOKEN_TYPE::NUMBER:
-			t_Node->list.nodes[t_NodeIndex++] = ParseNumber(t_NextToken);
-			break;
-		case TOKEN_TYPE::BOOLEAN:
-			t_Node->list.nodes[t_NodeIndex++] = ParseBoolean(t_NextToken);
-			break;
-		case TOKEN_TYPE::NULL_TYPE:
-			t_Node->list.nodes[t_NodeIndex++] = ParseNull();
-			break;
-		case TOKEN_TYPE::CURLY_CLOSE:
-			BB_ASSERT(false, "We should not reach this, algorithm mistake happened.");
-			break;
-		case TOKEN_TYPE::OUT_OF_TOKENS:
-			BB_ASSERT(false, "OUT_OF_TOKENS while reading a list in JSON");
-			break;
-		}
-
-		t_NextToken = GetToken(m_JsonFile);
+		t_Node->list.nodes[i] = ParseValue(a_Index);
+		NextJsonElement(t_Data, m_Index, a_Index, ']');
 	}
+	++a_Index; //the ]
+
 	return t_Node;
 }
 
-JsonNode* JsonParser::ParseString(const Token& a_Token)
+JsonNode* JsonParser::ParseString(uint32_t& a_Index)
 {
 	JsonNode* t_Node = BBnew(m_Allocator, JsonNode);
 	t_Node->type = JSON_TYPE::STRING;
 
-	t_Node->string = BBnewArr(m_Allocator, a_Token.strSize + 1, char);
-	Memory::Copy(t_Node->string, a_Token.str, a_Token.strSize);
-	t_Node->string[a_Token.strSize] = '\0';
+	const Slice<const char> t_String = GetJsonString(m_JsonData.data, m_Index, a_Index++);
+	t_Node->string = BBnewArr(m_Allocator, t_String.size() + 1, char);
+	Memory::Copy(t_Node->string, t_String.data(), t_String.size());
+	t_Node->string[t_String.size()] = '\0';
 
 	return t_Node;
 }
 
-JsonNode* JsonParser::ParseNumber(const Token& a_Token)
+JsonNode* JsonParser::ParseNumber(uint32_t& a_Index)
 {
 	JsonNode* t_Node = BBnew(m_Allocator, JsonNode);
 	t_Node->type = JSON_TYPE::NUMBER;
 
-	t_Node->number = std::stof(a_Token.str);
+	const char* t_Begin = m_JsonData.data + m_Index.positions[a_Index];
+	t_Node->number = static_cast<float>(ParseJsonNumber(t_Begin, JsonScalarEnd(m_JsonData.data, m_Index, a_Index)));
+	++a_Index;
 
 	return t_Node;
 }
 
-JsonNode* JsonParser::ParseBoolean(const Token& a_Token)
+JsonNode* JsonParser::ParseBoolean(uint32_t& a_Index)
 {
 	JsonNode* t_Node = BBnew(m_Allocator, JsonNode);
 	t_Node->type = JSON_TYPE::BOOL;
 
-	const Token t_Token = GetToken(m_JsonFile);
-	if (strcmp(t_Token.str, "False") == 0)
-		t_Node->boolean = false;
-	else if (strcmp(t_Token.str, "True") == 0)
-		t_Node->boolean = true;
-	else
-		BB_ASSERT(false, "JSON bool is wrongly typed, this assert should never be hit even with a wrong json anyway.");
+	const char* t_Begin = m_JsonData.data + m_Index.positions[a_Index];
+	const size_t t_Size = static_cast<size_t>(JsonScalarEnd(m_JsonData.data, m_Index, a_Index) - t_Begin);
+	t_Node->boolean = t_Size == 4 && Memory::Compare("true", t_Begin, 4) == 0;
+	BB_WARNING(t_Node->boolean || (t_Size == 5 && Memory::Compare("false", t_Begin, 5) == 0),
+		"JSON file tried to read a boolean but it's not written as true or false!",
+		WarningType::MEDIUM);
+	++a_Index;
 
 	return t_Node;
 }
 
-JsonNode* JsonParser::ParseNull()
+JsonNode* JsonParser::ParseNull(uint32_t& a_Index)
 {
 	JsonNode* t_Node = BBnew(m_Allocator, JsonNode);
 	t_Node->type = JSON_TYPE::NULL_TYPE;
 
+	BB_WARNING(Memory::Compare("null", m_JsonData.data + m_Index.positions[a_Index], 4) == 0,
+		"JSON file tried to read a null but it's not written as null!",
+		WarningType::MEDIUM);
+	++a_Index;
+
 	return t_Node;
-}
\ No newline at end of file
+}
+
+#pragma endregion
+
+#pragma region JsonDocument
+
+JsonDocument::JsonDocument(const char* a_Path)
+	: m_Allocator(mbSize * 8, a_Path)
+{
+	m_JsonData = MapOSFile(a_Path, OS_FILE_ACCESS_HINT::SEQUENTIAL);
+	m_Mapped = true;
+	m_Index = BuildJsonStructuralIndex(m_Allocator, m_JsonData.data, m_JsonData.size);
+}
+
+JsonDocument::JsonDocument(const Buffer& a_Buffer)
+	: m_Allocator(mbSize * 8, "Json document from memory")
+{
+	m_JsonData = a_Buffer;
+	m_Index = BuildJsonStructuralIndex(m_Allocator, m_JsonData.data, m_JsonData.size);
+}
+
+JsonDocument::~JsonDocument()
+{
+	if (m_Mapped)
+		UnmapOSFile(m_JsonData);
+	m_Allocator.Clear();
+}
+
+JsonValue JsonDocument::GetRoot() const
+{
+	BB_WARNING(m_Index.count != 0, "Json text is empty.", WarningType::MEDIUM);
+	if (m_Index.count == 0)
+		return JsonValue();
+	return JsonValue(this, 0);
+}
+
+JSON_TYPE JsonValue::GetType() const
+{
+	switch (JsonCharAt(m_Document->GetData(), m_Document->GetStructuralIndex(), m_Index))
+	{
+	case '{':
+		return JSON_TYPE::OBJECT;
+	case '[':
+		return JSON_TYPE::LIST;
+	case '"':
+		return JSON_TYPE::STRING;
+	case 't':
+	case 'f':
+		return JSON_TYPE::BOOL;
+	case 'n':
+		return JSON_TYPE::NULL_TYPE;
+	default:
+		return JSON_TYPE::NUMBER;
+	}
+}
+
+JsonValue JsonValue::Find(const char* a_Key) const
+{
+	const char* t_Data = m_Document->GetData();
+	const JsonStructuralIndex& t_Index = m_Document->GetStructuralIndex();
+	BB_ASSERT(JsonCharAt(t_Data, t_Index, m_Index) == '{', "Json value is not an object.");
+
+	const size_t t_KeySize = strlen(a_Key);
+	uint32_t t_Position = m_Index + 1;
+	bool t_ContinueLoop = t_Position < t_Index.count && JsonCharAt(t_Data, t_Index, t_Position) != '}';
+	while (t_ContinueLoop)
+	{
+		const Slice<const char> t_Key = GetJsonString(t_Data, t_Index, t_Position);
+		//Skip the key and the :
+		t_Position += 2;
+		if (t_Key.size() == t_KeySize && memcmp(t_Key.data(), a_Key, t_KeySize) == 0)
+			return JsonValue(m_Document, t_Position);
+
+		t_Position = SkipJsonValue(t_Data, t_Index, t_Position);
+		t_ContinueLoop = NextJsonElement(t_Data, t_Index, t_Position, '}');
+	}
+	return JsonValue();
+}
+
+JsonValue JsonValue::Find(const StringID a_Key) const
+{
+	const char* t_Data = m_Document->GetData();
+	const JsonStructuralIndex& t_Index = m_Document->GetStructuralIndex();
+	BB_ASSERT(JsonCharAt(t_Data, t_Index, m_Index) == '{', "Json value is not an object.");
+
+	//The keys are short, hashing them is cheaper then interning the document.
+	//Two keys can have the same 32 bit id, so the string is compared too if the id was interned.
+	const char* t_Name = GetInternedString(a_Key);
+	const size_t t_NameSize = t_Name != nullptr ? strlen(t_Name) : 0;
+	uint32_t t_Position = m_Index + 1;
+	bool t_ContinueLoop = t_Position < t_Index.count && JsonCharAt(t_Data, t_Index, t_Position) != '}';
+	while (t_ContinueLoop)
+	{
+		const Slice<const char> t_Key = GetJsonString(t_Data, t_Index, t_Position);
+		t_Position += 2;
+		if (MakeStringID(t_Key.data(), t_Key.size()) == a_Key &&
+			(t_Name == nullptr || (t_Key.size() == t_NameSize && memcmp(t_Key.data(), t_Name, t_NameSize) == 0)))
+			return JsonValue(m_Document, t_Position);
+
+		t_Position = SkipJsonValue(t_Data, t_Index, t_Position);
+		t_ContinueLoop = NextJsonElement(t_Data, t_Index, t_Position, '}');
+	}
+	return JsonValue();
+}
+
+JsonValue JsonValue::GetElement(const uint32_t a_Index) const
+{
+	uint32_t t_Element = 0;
+	for (JsonValue t_Value : GetList())
+		if (t_Element++ == a_Index)
+			return t_Value;
+	return JsonValue();
+}
+
+uint32_t JsonValue::GetCount() const
+{
+	if (!IsValid())
+		return 0;
+	const char* t_Data = m_Document->GetData();
+	const JsonStructuralIndex& t_Index = m_Document->GetStructuralIndex();
+	const char t_Open = JsonCharAt(t_Data, t_Index, m_Index);
+	BB_ASSERT(t_Open == '{' || t_Open == '[', "Json value is not an object or list.");
+	const char t_Close = t_Open == '{' ? '}' : ']';
+
+	uint32_t t_Count = 0;
+	uint32_t t_Position = m_Index + 1;
+	bool t_ContinueLoop = t_Position < t_Index.count && JsonCharAt(t_Data, t_Index, t_Position) != t_Close;
+	while (t_ContinueLoop)
+	{
+		//Skip the key and the : of an object field.
+		if (t_Open == '{')
+			t_Position += 2;
+		t_Position = SkipJsonValue(t_Data, t_Index, t_Position);
+		++t_Count;
+		t_ContinueLoop = NextJsonElement(t_Data, t_Index, t_Position, t_Close);
+	}
+	return t_Count;
+}
+
+Slice<const char> JsonValue::GetString() const
+{
+	return GetJsonString(m_Document->GetData(), m_Document->GetStructuralIndex(), m_Index);
+}
+
+StringID JsonValue::GetStringID() const
+{
+	const Slice<const char> t_String = GetString();
+	return InternString(t_String.data(), t_String.size());
+}
+
+float JsonValue::GetNumber() const
+{
+	return static_cast<float>(GetDouble());
+}
+
+double JsonValue::GetDouble() const
+{
+	BB_ASSERT(GetType() == JSON_TYPE::NUMBER, "Json value is not a number.");
+	const char* t_Data = m_Document->GetData();
+	const JsonStructuralIndex& t_Index = m_Document->GetStructuralIndex();
+	return ParseJsonNumber(t_Data + t_Index.positions[m_Index], JsonScalarEnd(t_Data, t_Index, m_Index));
+}
+
+int64_t JsonValue::GetInteger() const
+{
+	BB_ASSERT(GetType() == JSON_TYPE::NUMBER, "Json value is not a number.");
+	const char* t_Data = m_Document->GetData();
+	const JsonStructuralIndex& t_Index = m_Document->GetStructuralIndex();
+	const char* t_Char = t_Data + t_Index.positions[m_Index];
+	const char* t_End = JsonScalarEnd(t_Data, t_Index, m_Index);
+
+	const bool t_Negative = *t_Char == '-';
+	if (t_Negative)
+		++t_Char;
+	int64_t t_Value = 0;
+	for (; t_Char < t_End && *t_Char >= '0' && *t_Char <= '9'; ++t_Char)
+		t_Value = t_Value * 10 + (*t_Char - '0');
+	//Not a plain integer, like 1.0 or 1e3.
+	if (t_Char != t_End)
+		return static_cast<int64_t>(GetDouble());
+	return t_Negative ? -t_Value : t_Value;
+}
+
+bool JsonValue::GetBoolean() const
+{
+	BB_ASSERT(GetType() == JSON_TYPE::BOOL, "Json value is not a boolean.");
+	return JsonCharAt(m_Document->GetData(), m_Document->GetStructuralIndex(), m_Index) == 't';
+}
+
+//The end iterator, never a structural position since those are smaller then the json text size.
+constexpr const uint32_t JSON_LIST_END = UINT32_MAX;
+
+JsonValue::ListIterator& JsonValue::ListIterator::operator++()
+{
+	const char* t_Data = m_Document->GetData();
+	const JsonStructuralIndex& t_Index = m_Document->GetStructuralIndex();
+	m_Index = SkipJsonValue(t_Data, t_Index, m_Index);
+	if (!NextJsonElement(t_Data, t_Index, m_Index, ']'))
+		m_Index = JSON_LIST_END;
+	return *this;
+}
+
+JsonValue::ListRange JsonValue::GetList() const
+{
+	if (!IsValid())
+		return ListRange{ ListIterator(nullptr, JSON_LIST_END), ListIterator(nullptr, JSON_LIST_END) };
+	const char* t_Data = m_Document->GetData();
+	const JsonStructuralIndex& t_Index = m_Document->GetStructuralIndex();
+	BB_ASSERT(JsonCharAt(t_Data, t_Index, m_Index) == '[', "Json value is not a list.");
+
+	const ListIterator t_End(m_Document, JSON_LIST_END);
+	const uint32_t t_First = m_Index + 1;
+	if (t_First >= t_Index.count || JsonCharAt(t_Data, t_Index, t_First) == ']')
+		return ListRange{ t_End, t_End };
+	return ListRange{ ListIterator(m_Document, t_First), t_End };
+}
+
+#pragma endregion
+
+#pragma region JsonSaxParser
+
+enum class JSON_SAX_STATE : uint32_t
+{
+	VALUE,
+	VALUE_OR_LIST_END,
+	KEY_OR_OBJECT_END,
+	COLON,
+	COMMA_OR_END,
+	DONE
+};
+
+template<typename Event, typename... Args>
+static inline bool SendJsonSaxEvent(const Event a_Event, void* a_UserData, const Args&... a_Args)
+{
+	return a_Event == nullptr || a_Event(a_UserData, a_Args...);
+}
+
+static inline bool IsJsonNumberChar(const char a_Char)
+{
+	return (a_Char >= '0' && a_Char <= '9') || a_Char == '-' || a_Char == '+' || a_Char == '.' || a_Char == 'e' || a_Char == 'E';
+}
+
+JsonSaxParser::JsonSaxParser(Allocator a_Allocator, const size_t a_ChunkSize)
+	: m_Allocator(a_Allocator), m_ChunkSize(a_ChunkSize)
+{
+	m_Chunk = BBnewArr(m_Allocator, m_ChunkSize, char);
+}
+
+JsonSaxParser::~JsonSaxParser()
+{
+	BBfreeArr(m_Allocator, m_Chunk);
+}
+
+bool JsonSaxParser::Parse(const char* a_Path, const JsonSaxHandler& a_Handler)
+{
+	m_File = LoadOSFile(a_Path);
+	m_Data = m_Chunk;
+	m_Position = 0;
+	m_End = 0;
+	m_EndOfFile = false;
+
+	const bool t_Result = Run(a_Handler);
+	CloseOSFile(m_File);
+	m_File = OSFileHandle();
+	return t_Result;
+}
+
+bool JsonSaxParser::Parse(const Buffer& a_Buffer, const JsonSaxHandler& a_Handler)
+{
+	m_Data = a_Buffer.data;
+	m_Position = 0;
+	m_End = a_Buffer.size;
+	m_EndOfFile = true;
+	return Run(a_Handler);
+}
+
+bool JsonSaxParser::Refill()
+{
+	if (m_EndOfFile)
+		return false;
+
+	const size_t t_Unread = m_End - m_Position;
+	if (t_Unread == m_ChunkSize)
+	{
+		BB_WARNING(false, "Json string or number is bigger then the sax chunk size.", WarningType::MEDIUM);
+		return false;
+	}
+
+	memmove(m_Chunk, m_Chunk + m_Position, t_Unread);
+	m_Position = 0;
+	m_End = t_Unread;
+	const uint64_t t_Read = ReadFromOSFile(m_File, m_Chunk + m_End, m_ChunkSize - m_End);
+	m_End += t_Read;
+	m_EndOfFile = t_Read == 0;
+	return t_Read != 0;
+}
+
+bool JsonSaxParser::SkipWhitespace()
+{
+	while (true)
+	{
+		while (m_Position < m_End && IsJsonWhitespace(m_Data[m_Position]))
+			++m_Position;
+		//Json from memory is often null terminated, treat it as the end of the text.
+		if (m_Position < m_End)
+			return m_Data[m_Position] != '\0';
+		if (!Refill())
+			return false;
+	}
+}
+
+bool JsonSaxParser::Ensure(const size_t a_Count)
+{
+	while (m_End - m_Position < a_Count)
+		if (!Refill())
+			return false;
+	return true;
+}
+
+bool JsonSaxParser::ScanString(size_t& a_Length)
+{
+	//Offsets are relative to the opening quote since a refill moves it to the front of the chunk.
+	size_t t_Scan = 1;
+	while (true)
+	{
+		const char* t_String = m_Data + m_Position;
+		const size_t t_Available = m_End - m_Position;
+		const char* t_Quote = t_Scan < t_Available ?
+			reinterpret_cast<const char*>(memchr(t_String + t_Scan, '"', t_Available - t_Scan)) : nullptr;
+		if (t_Quote != nullptr)
+		{
+			const size_t t_Offset = static_cast<size_t>(t_Quote - t_String);
+			//An odd amount of backslashes escapes the quote, the opening quote stops the loop.
+			size_t t_Backslashes = 0;
+			while (t_String[t_Offset - 1 - t_Backslashes] == '\\')
+				++t_Backslashes;
+			if ((t_Backslashes & 1) == 0)
+			{
+				a_Length = t_Offset;
+				return true;
+			}
+			t_Scan = t_Offset + 1;
+			continue;
+		}
+
+		t_Scan = t_Available;
+		if (!Refill())
+			return false;
+	}
+}
+
+bool JsonSaxParser::ScanNumber(size_t& a_Length)
+{
+	size_t t_Length = 0;
+	while (true)
+	{
+		while (m_Position + t_Length < m_End && IsJsonNumberChar(m_Data[m_Position + t_Length]))
+			++t_Length;
+		if (m_Position + t_Length < m_End)
+			break;
+		//A number can end at the end of the file, but not at the end of a full chunk.
+		if (!Refill())
+		{
+			if (!m_EndOfFile)
+				return false;
+			break;
+		}
+	}
+	a_Length = t_Length;
+	return t_Length != 0;
+}
+
+bool JsonSaxParser::Run(const JsonSaxHandler& a_Handler)
+{
+	m_Depth = 0;
+	JSON_SAX_STATE t_State = JSON_SAX_STATE::VALUE;
+	while (SkipWhitespace())
+	{
+		const char t_Char = m_Data[m_Position];
+		if (t_State == JSON_SAX_STATE::DONE)
+		{
+			BB_WARNING(false, "Json has more text after the root value.", WarningType::MEDIUM);
+			return false;
+		}
+
+		if (t_State == JSON_SAX_STATE::COLON)
+		{
+			if (t_Char != ':')
+			{
+				BB_WARNING(false, "Json object key is not followed by a colon.", WarningType::MEDIUM);
+				return false;
+			}
+			++m_Position;
+			t_State = JSON_SAX_STATE::VALUE;
+			continue;
+		}
+
+		const bool t_InObject = m_Depth != 0 && m_InObject[m_Depth - 1];
+		if (t_State == JSON_SAX_STATE::COMMA_OR_END && t_Char == ',')
+		{
+			++m_Position;
+			t_State = t_InObject ? JSON_SAX_STATE::KEY_OR_OBJECT_END : JSON_SAX_STATE::VALUE_OR_LIST_END;
+			continue;
+		}
+
+		//Trailing commas are allowed, same as JsonParser.
+		if (t_State != JSON_SAX_STATE::VALUE && m_Depth != 0 && t_Char == (t_InObject ? '}' : ']'))
+		{
+			++m_Position;
+			--m_Depth;
+			if (!SendJsonSaxEvent(t_InObject ? a_Handler.endObject : a_Handler.endList, a_Handler.userData))
+				return false;
+			t_State = m_Depth == 0 ? JSON_SAX_STATE::DONE : JSON_SAX_STATE::COMMA_OR_END;
+			continue;
+		}
+
+		if (t_State == JSON_SAX_STATE::COMMA_OR_END)
+		{
+			BB_WARNING(false, "Json value is not followed by a comma or a closing bracket.", WarningType::MEDIUM);
+			return false;
+		}
+
+		if (t_State == JSON_SAX_STATE::KEY_OR_OBJECT_END)
+		{
+			size_t t_Length;
+			if (t_Char != '"' || !ScanString(t_Length))
+			{
+				BB_WARNING(false, "Json object has an invalid key.", WarningType::MEDIUM);
+				return false;
+			}
+			if (!SendJsonSaxEvent(a_Handler.key, a_Handler.userData, Slice<const char>(m_Data + m_Position + 1, t_Length - 1)))
+				return false;
+			m_Position += t_Length + 1;
+			t_State = JSON_SAX_STATE::COLON;
+			continue;
+		}
+
+		switch (t_Char)
+		{
+		case '{':
+		case '[':
+			if (m_Depth == JSON_SAX_MAX_DEPTH)
+			{
+				BB_WARNING(false, "Json is nested deeper then JSON_SAX_MAX_DEPTH.", WarningType::MEDIUM);
+				return false;
+			}
+			m_InObject[m_Depth++] = t_Char == '{';
+			++m_Position;
+			if (!SendJsonSaxEvent(t_Char == '{' ? a_Handler.beginObject : a_Handler.beginList, a_Handler.userData))
+				return false;
+			t_State = t_Char == '{' ? JSON_SAX_STATE::KEY_OR_OBJECT_END : JSON_SAX_STATE::VALUE_OR_LIST_END;
+			continue;
+		case '"':
+		{
+			size_t t_Length;
+			if (!ScanString(t_Length))
+			{
+				BB_WARNING(false, "Json string is not closed.", WarningType::MEDIUM);
+				return false;
+			}
+			if (!SendJsonSaxEvent(a_Handler.string, a_Handler.userData, Slice<const char>(m_Data + m_Position + 1, t_Length - 1)))
+				return false;
+			m_Position += t_Length + 1;
+		}
+			break;
+		case 't':
+			if (!Ensure(4) || memcmp(m_Data + m_Position, "true", 4) != 0)
+			{
+				BB_WARNING(false, "Json has an invalid literal.", WarningType::MEDIUM);
+				return false;
+			}
+			m_Position += 4;
+			if (!SendJsonSaxEvent(a_Handler.boolean, a_Handler.userData, true))
+				return false;
+			break;
+		case 'f':
+			if (!Ensure(5) || memcmp(m_Data + m_Position, "false", 5) != 0)
+			{
+				BB_WARNING(false, "Json has an invalid literal.", WarningType::MEDIUM);
+				return false;
+			}
+			m_Position += 5;
+			if (!SendJsonSaxEvent(a_Handler.boolean, a_Handler.userData, false))
+				return false;
+			break;
+		case 'n':
+			if (!Ensure(4) || memcmp(m_Data + m_Position, "null", 4) != 0)
+			{
+				BB_WARNING(false, "Json has an invalid literal.", WarningType::MEDIUM);
+				return false;
+			}
+			m_Position += 4;
+			if (!SendJsonSaxEvent(a_Handler.null, a_Handler.userData))
+				return false;
+			break;
+		default:
+		{
+			size_t t_Length;
+			if (!IsJsonNumberChar(t_Char) || !ScanNumber(t_Length))
+			{
+				BB_WARNING(false, "Json has an invalid value.", WarningType::MEDIUM);
+				return false;
+			}
+			const double t_Number = ParseJsonNumber(m_Data + m_Position, m_Data + m_Position + t_Length);
+			m_Position += t_Length;
+			if (!SendJsonSaxEvent(a_Handler.number, a_Handler.userData, t_Number))
+				return false;
+		}
+			break;
+		}
+		t_State = m_Depth == 0 ? JSON_SAX_STATE::DONE : JSON_SAX_STATE::COMMA_OR_END;
+	}
+
+	BB_WARNING(t_State == JSON_SAX_STATE::DONE, "Json text ended before the root value was closed.", WarningType::MEDIUM);
+	return t_State == JSON_SAX_STATE::DONE;
+}
+
+#pragma endregion
@@ -0,0 +1,412 @@
+#include "Math.inl"
+
+#ifdef BB_SIMD_SSE
+#include "Utils/Utils.h"
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+//MSVC allows every intrinsic in any function, the CPU check happens at runtime.
+#define BB_TARGET_AVX2
+#else
+#define BB_TARGET_AVX2 __attribute__((target("avx2")))
+#endif //_MSC_VER
+#endif //BB_SIMD_SSE
+
+using namespace BB;
+
+#ifdef BB_SIMD
+#pragma region 4 lanes
+//The inverse for 4 matrices at once, a_M[row][column] holds that float of all 4 matrices.
+//Same steps as the scalar Mat4x4Inverse, so every lane gets the exact same result.
+static void Mat4x4InverseLanes(const SIMD::Vec4 a_M[4][4], SIMD::Vec4 a_Out[4][4])
+{
+	using namespace SIMD;
+	const Vec4 ax = a_M[0][0], ay = a_M[1][0], az = a_M[2][0];
+	const Vec4 bx = a_M[0][1], by = a_M[1][1], bz = a_M[2][1];
+	const Vec4 cx = a_M[0][2], cy = a_M[1][2], cz = a_M[2][2];
+	const Vec4 dx = a_M[0][3], dy = a_M[1][3], dz = a_M[2][3];
+	const Vec4 x = a_M[3][0], y = a_M[3][1], z = a_M[3][2], w = a_M[3][3];
+
+	Vec4 sx = Sub(Mul(ay, bz), Mul(az, by));
+	Vec4 sy = Sub(Mul(az, bx), Mul(ax, bz));
+	Vec4 sz = Sub(Mul(ax, by), Mul(ay, bx));
+
+	Vec4 tx = Sub(Mul(cy, dz), Mul(cz, dy));
+	Vec4 ty = Sub(Mul(cz, dx), Mul(cx, dz));
+	Vec4 tz = Sub(Mul(cx, dy), Mul(cy, dx));
+
+	Vec4 ux = Sub(Mul(ax, y), Mul(bx, x));
+	Vec4 uy = Sub(Mul(ay, y), Mul(by, x));
+	Vec4 uz = Sub(Mul(az, y), Mul(bz, x));
+
+	Vec4 vx = Sub(Mul(cx, w), Mul(dx, z));
+	Vec4 vy = Sub(Mul(cy, w), Mul(dy, z));
+	Vec4 vz = Sub(Mul(cz, w), Mul(dz, z));
+
+	const Vec4 t_DotSV = Add(Add(Mul(sx, vx), Mul(sy, vy)), Mul(sz, vz));
+	const Vec4 t_DotTU = Add(Add(Mul(tx, ux), Mul(ty, uy)), Mul(tz, uz));
+	const Vec4 inv_det = Div(Set1(1.0f), Add(t_DotSV, t_DotTU));
+	sx = Mul(sx, inv_det); sy = Mul(sy, inv_det); sz = Mul(sz, inv_det);
+	tx = Mul(tx, inv_det); ty = Mul(ty, inv_det); tz = Mul(tz, inv_det);
+	ux = Mul(ux, inv_det); uy = Mul(uy, inv_det); uz = Mul(uz, inv_det);
+	vx = Mul(vx, inv_det); vy = Mul(vy, inv_det); vz = Mul(vz, inv_det);
+
+	const Vec4 t_Negative = Set1(-1.f);
+
+	//r0 = Float3Cross(b, v) + t * y
+	a_Out[0][0] = Add(Sub(Mul(by, vz), Mul(bz, vy)), Mul(tx, y));
+	a_Out[0][1] = Add(Sub(Mul(bz, vx), Mul(bx, vz)), Mul(ty, y));
+	a_Out[0][2] = Add(Sub(Mul(bx, vy), Mul(by, vx)), Mul(tz, y));
+	a_Out[0][3] = Mul(Add(Add(Mul(bx, tx), Mul(by, ty)), Mul(bz, tz)), t_Negative);
+
+	//r1 = Float3Cross(v, a) - t * x
+	a_Out[1][0] = Sub(Sub(Mul(vy, az), Mul(vz, ay)), Mul(tx, x));
+	a_Out[1][1] = Sub(Sub(Mul(vz, ax), Mul(vx, az)), Mul(ty, x));
+	a_Out[1][2] = Sub(Sub(Mul(vx, ay), Mul(vy, ax)), Mul(tz, x));
+	a_Out[1][3] = Add(Add(Mul(ax, tx), Mul(ay, ty)), Mul(az, tz));
+
+	//r2 = Float3Cross(d, u) + s * w
+	a_Out[2][0] = Add(Sub(Mul(dy, uz), Mul(dz, uy)), Mul(sx, w));
+	a_Out[2][1] = Add(Sub(Mul(dz, ux), Mul(dx, uz)), Mul(sy, w));
+	a_Out[2][2] = Add(Sub(Mul(dx, uy), Mul(dy, ux)), Mul(sz, w));
+	a_Out[2][3] = Mul(Add(Add(Mul(dx, sx), Mul(dy, sy)), Mul(dz, sz)), t_Negative);
+
+	//r3 = Float3Cross(u, c) - s * z
+	a_Out[3][0] = Sub(Sub(Mul(uy, cz), Mul(uz, cy)), Mul(sx, z));
+	a_Out[3][1] = Sub(Sub(Mul(uz, cx), Mul(ux, cz)), Mul(sy, z));
+	a_Out[3][2] = Sub(Sub(Mul(ux, cy), Mul(uy, cx)), Mul(sz, z));
+	a_Out[3][3] = Add(Add(Mul(cx, sx), Mul(cy, sy)), Mul(cz, sz));
+}
+
+static void Mat4x4InverseBatchSIMD4(Mat4x4* a_Out, const Mat4x4* a_Matrices, const size_t a_Count)
+{
+	using namespace SIMD;
+	size_t i = 0;
+	for (; i + 4 <= a_Count; i += 4)
+	{
+		//Row r of the 4 matrices transposed gives element [r][column] of all 4 matrices.
+		Vec4 t_M[4][4];
+		for (int r = 0; r < 4; r++)
+		{
+			t_M[r][0] = Load(a_Matrices[i + 0].e[r]);
+			t_M[r][1] = Load(a_Matrices[i + 1].e[r]);
+			t_M[r][2] = Load(a_Matrices[i + 2].e[r]);
+			t_M[r][3] = Load(a_Matrices[i + 3].e[r]);
+			Transpose(t_M[r][0], t_M[r][1], t_M[r][2], t_M[r][3]);
+		}
+
+		Vec4 t_Out[4][4];
+		Mat4x4InverseLanes(t_M, t_Out);
+
+		for (int r = 0; r < 4; r++)
+		{
+			Transpose(t_Out[r][0], t_Out[r][1], t_Out[r][2], t_Out[r][3]);
+			Store(a_Out[i + 0].e[r], t_Out[r][0]);
+			Store(a_Out[i + 1].e[r], t_Out[r][1]);
+			Store(a_Out[i + 2].e[r], t_Out[r][2]);
+			Store(a_Out[i + 3].e[r], t_Out[r][3]);
+		}
+	}
+
+	for (; i < a_Count; i++)
+		a_Out[i] = Mat4x4Inverse(a_Matrices[i]);
+}
+
+template<bool Stream>
+static inline void StoreRow(float* a_Destination, const SIMD::Vec4 a_Row)
+{
+#ifdef BB_SIMD_SSE
+	if constexpr (Stream)
+		return _mm_stream_ps(a_Destination, a_Row);
+#endif //BB_SIMD_SSE
+	SIMD::Store(a_Destination, a_Row);
+}
+
+//Transposes 4 rows of lanes back to the matrices and stores the ones that are real.
+//A whole matrix is written at once so a streamed store fills a cache line before the next one starts.
+template<bool Stream>
+static inline void StoreLanes(SIMD::Vec4 a_M[4][4], Mat4x4* a_Out, const size_t a_Stride, const uint32_t a_Indices[4], const size_t a_LaneCount)
+{
+	for (int r = 0; r < 4; r++)
+		SIMD::Transpose(a_M[r][0], a_M[r][1], a_M[r][2], a_M[r][3]);
+
+	for (size_t j = 0; j < a_LaneCount; j++)
+	{
+		Mat4x4* t_Matrix = reinterpret_cast<Mat4x4*>(reinterpret_cast<char*>(a_Out) + a_Indices[j] * a_Stride);
+		for (int r = 0; r < 4; r++)
+			StoreRow<Stream>(t_Matrix->e[r], a_M[r][j]);
+	}
+}
+
+template<bool Stream>
+static void Mat4x4FromTRSBatchSIMD4(Mat4x4* a_Matrices, Mat4x4* a_Inverses, const size_t a_Stride,
+	const float3* a_Positions, const Quat* a_Rotations, const float3* a_Scales,
+	const uint32_t* a_Indices, const size_t a_Count)
+{
+	using namespace SIMD;
+	const Vec4 t_Zero = Set1(0.f);
+	const Vec4 t_One = Set1(1.f);
+	const Vec4 t_Two = Set1(2.f);
+
+	for (size_t i = 0; i < a_Count; i += 4)
+	{
+		//The last group repeats its last transform in the lanes that are left, only the real lanes get stored.
+		const size_t t_LaneCount = a_Count - i < 4 ? a_Count - i : 4;
+		uint32_t t_Indices[4];
+		for (size_t j = 0; j < 4; j++)
+			t_Indices[j] = a_Indices[i + (j < t_LaneCount ? j : t_LaneCount - 1)];
+
+		Vec4 qx = Load(a_Rotations[t_Indices[0]].xyzw);
+		Vec4 qy = Load(a_Rotations[t_Indices[1]].xyzw);
+		Vec4 qz = Load(a_Rotations[t_Indices[2]].xyzw);
+		Vec4 qw = Load(a_Rotations[t_Indices[3]].xyzw);
+		Transpose(qx, qy, qz, qw);
+
+		//A float3 is loaded with w as 0, a 16 byte load could read past the end of the stream.
+		Vec4 px = Set(a_Positions[t_Indices[0]].x, a_Positions[t_Indices[0]].y, a_Positions[t_Indices[0]].z, 0.f);
+		Vec4 py = Set(a_Positions[t_Indices[1]].x, a_Positions[t_Indices[1]].y, a_Positions[t_Indices[1]].z, 0.f);
+		Vec4 pz = Set(a_Positions[t_Indices[2]].x, a_Positions[t_Indices[2]].y, a_Positions[t_Indices[2]].z, 0.f);
+		Vec4 t_PositionW = Set(a_Positions[t_Indices[3]].x, a_Positions[t_Indices[3]].y, a_Positions[t_Indices[3]].z, 0.f);
+		Transpose(px, py, pz, t_PositionW);
+
+		Vec4 sx = Set(a_Scales[t_Indices[0]].x, a_Scales[t_Indices[0]].y, a_Scales[t_Indices[0]].z, 0.f);
+		Vec4 sy = Set(a_Scales[t_Indices[1]].x, a_Scales[t_Indices[1]].y, a_Scales[t_Indices[1]].z, 0.f);
+		Vec4 sz = Set(a_Scales[t_Indices[2]].x, a_Scales[t_Indices[2]].y, a_Scales[t_Indices[2]].z, 0.f);
+		Vec4 t_ScaleW = Set(a_Scales[t_Indices[3]].x, a_Scales[t_Indices[3]].y, a_Scales[t_Indices[3]].z, 0.f);
+		Transpose(sx, sy, sz, t_ScaleW);
+
+		//Mat4x4FromQuat
+		const Vec4 qxx = Mul(qx, qx);
+		const Vec4 qyy = Mul(qy, qy);
+		const Vec4 qzz = Mul(qz, qz);
+		const Vec4 qxz = Mul(qx, qz);
+		const Vec4 qxy = Mul(qx, qy);
+		const Vec4 qyz = Mul(qy, qz);
+		const Vec4 qwx = Mul(qw, qx);
+		const Vec4 qwy = Mul(qw, qy);
+		const Vec4 qwz = Mul(qw, qz);
+
+		const Vec4 r00 = Sub(t_One, Mul(t_Two, Add(qyy, qzz)));
+		const Vec4 r01 = Mul(t_Two, Add(qxy, qwz));
+		const Vec4 r02 = Mul(t_Two, Sub(qxz, qwy));
+		const Vec4 r10 = Mul(t_Two, Sub(qxy, qwz));
+		const Vec4 r11 = Sub(t_One, Mul(t_Two, Add(qxx, qzz)));
+		const Vec4 r12 = Mul(t_Two, Add(qyz, qwx));
+		const Vec4 r20 = Mul(t_Two, Add(qxz, qwy));
+		const Vec4 r21 = Mul(t_Two, Sub(qyz, qwx));
+		const Vec4 r22 = Sub(t_One, Mul(t_Two, Add(qxx, qyy)));
+
+		Vec4 t_Matrix[4][4]{
+			{ Mul(r00, sx), Mul(r01, sx), Mul(r02, sx), t_Zero },
+			{ Mul(r10, sy), Mul(r11, sy), Mul(r12, sy), t_Zero },
+			{ Mul(r20, sz), Mul(r21, sz), Mul(r22, sz), t_Zero },
+			{ px, py, pz, t_One } };
+		StoreLanes<Stream>(t_Matrix, a_Matrices, a_Stride, t_Indices, t_LaneCount);
+
+		//The inverse is the transposed rotation divided by the scale, with the position moved back by it.
+		const Vec4 t_InvScaleX = Div(t_One, sx);
+		const Vec4 t_InvScaleY = Div(t_One, sy);
+		const Vec4 t_InvScaleZ = Div(t_One, sz);
+		const Vec4 t_InvPosX = Sub(t_Zero, Mul(Add(Add(Mul(r00, px), Mul(r01, py)), Mul(r02, pz)), t_InvScaleX));
+		const Vec4 t_InvPosY = Sub(t_Zero, Mul(Add(Add(Mul(r10, px), Mul(r11, py)), Mul(r12, pz)), t_InvScaleY));
+		const Vec4 t_InvPosZ = Sub(t_Zero, Mul(Add(Add(Mul(r20, px), Mul(r21, py)), Mul(r22, pz)), t_InvScaleZ));
+
+		Vec4 t_Inverse[4][4]{
+			{ Mul(r00, t_InvScaleX), Mul(r10, t_InvScaleY), Mul(r20, t_InvScaleZ), t_Zero },
+			{ Mul(r01, t_InvScaleX), Mul(r11, t_InvScaleY), Mul(r21, t_InvScaleZ), t_Zero },
+			{ Mul(r02, t_InvScaleX), Mul(r12, t_InvScaleY), Mul(r22, t_InvScaleZ), t_Zero },
+			{ t_InvPosX, t_InvPosY, t_InvPosZ, t_One } };
+		StoreLanes<Stream>(t_Inverse, a_Inverses, a_Stride, t_Indices, t_LaneCount);
+	}
+
+#ifdef BB_SIMD_SSE
+	if constexpr (Stream)
+		_mm_sfence();
+#endif //BB_SIMD_SSE
+}
+#pragma endregion
+#endif //BB_SIMD
+
+#ifdef BB_SIMD_SSE
+#pragma region AVX2
+BB_TARGET_AVX2 static inline __m256 MulSub8(const __m256 a_A, const __m256 a_B, const __m256 a_C, const __m256 a_D)
+{
+	return _mm256_sub_ps(_mm256_mul_ps(a_A, a_B), _mm256_mul_ps(a_C, a_D));
+}
+
+//Same as Float3Dot, x + y + z.
+BB_TARGET_AVX2 static inline __m256 Dot8(const __m256 a_AX, const __m256 a_AY, const __m256 a_AZ, const __m256 a_BX, const __m256 a_BY, const __m256 a_BZ)
+{
+	return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a_AX, a_BX), _mm256_mul_ps(a_AY, a_BY)), _mm256_mul_ps(a_AZ, a_BZ));
+}
+
+//_MM_TRANSPOSE4_PS for both 128 bit halves.
+BB_TARGET_AVX2 static inline void Transpose8(__m256& a_R0, __m256& a_R1, __m256& a_R2, __m256& a_R3)
+{
+	const __m256 t_01Low = _mm256_unpacklo_ps(a_R0, a_R1);
+	const __m256 t_23Low = _mm256_unpacklo_ps(a_R2, a_R3);
+	const __m256 t_01High = _mm256_unpackhi_ps(a_R0, a_R1);
+	const __m256 t_23High = _mm256_unpackhi_ps(a_R2, a_R3);
+	a_R0 = _mm256_shuffle_ps(t_01Low, t_23Low, _MM_SHUFFLE(1, 0, 1, 0));
+	a_R1 = _mm256_shuffle_ps(t_01Low, t_23Low, _MM_SHUFFLE(3, 2, 3, 2));
+	a_R2 = _mm256_shuffle_ps(t_01High, t_23High, _MM_SHUFFLE(1, 0, 1, 0));
+	a_R3 = _mm256_shuffle_ps(t_01High, t_23High, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+BB_TARGET_AVX2 static void Mat4x4MultiplyBatchAVX2(Mat4x4* a_Out, const Mat4x4* a_Lhs, const Mat4x4* a_Rhs, const size_t a_Count)
+{
+	for (size_t i = 0; i < a_Count; i++)
+	{
+		//Every row of a_Lhs in both halves, then row 0 and 1 of the result are made in one register.
+		const __m256 t_L0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a_Lhs[i].r0.e));
+		const __m256 t_L1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a_Lhs[i].r1.e));
+		const __m256 t_L2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a_Lhs[i].r2.e));
+		const __m256 t_L3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a_Lhs[i].r3.e));
+		const __m256 t_R01 = _mm256_loadu_ps(a_Rhs[i].r0.e);
+		const __m256 t_R23 = _mm256_loadu_ps(a_Rhs[i].r2.e);
+
+		const __m256 t_Out01 = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+			_mm256_mul_ps(t_L0, _mm256_permute_ps(t_R01, _MM_SHUFFLE(0, 0, 0, 0))),
+			_mm256_mul_ps(t_L1, _mm256_permute_ps(t_R01, _MM_SHUFFLE(1, 1, 1, 1)))),
+			_mm256_mul_ps(t_L2, _mm256_permute_ps(t_R01, _MM_SHUFFLE(2, 2, 2, 2)))),
+			_mm256_mul_ps(t_L3, _mm256_permute_ps(t_R01, _MM_SHUFFLE(3, 3, 3, 3))));
+		const __m256 t_Out23 = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+			_mm256_mul_ps(t_L0, _mm256_permute_ps(t_R23, _MM_SHUFFLE(0, 0, 0, 0))),
+			_mm256_mul_ps(t_L1, _mm256_permute_ps(t_R23, _MM_SHUFFLE(1, 1, 1, 1)))),
+			_mm256_mul_ps(t_L2, _mm256_permute_ps(t_R23, _MM_SHUFFLE(2, 2, 2, 2)))),
+			_mm256_mul_ps(t_L3, _mm256_permute_ps(t_R23, _MM_SHUFFLE(3, 3, 3, 3))));
+
+		_mm256_storeu_ps(a_Out[i].r0.e, t_Out01);
+		_mm256_storeu_ps(a_Out[i].r2.e, t_Out23);
+	}
+}
+
+//Mat4x4InverseLanes with 8 lanes, matrix i in the low half and matrix i + 4 in the high half.
+BB_TARGET_AVX2 static void Mat4x4InverseBatchAVX2(Mat4x4* a_Out, const Mat4x4* a_Matrices, const size_t a_Count)
+{
+	size_t i = 0;
+	for (; i + 8 <= a_Count; i += 8)
+	{
+		__m256 t_M[4][4];
+		for (int r = 0; r < 4; r++)
+		{
+			for (int j = 0; j < 4; j++)
+				t_M[r][j] = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(a_Matrices[i + j].e[r])), _mm_loadu_ps(a_Matrices[i + j + 4].e[r]), 1);
+			Transpose8(t_M[r][0], t_M[r][1], t_M[r][2], t_M[r][3]);
+		}
+
+		const __m256 ax = t_M[0][0], ay = t_M[1][0], az = t_M[2][0];
+		const __m256 bx = t_M[0][1], by = t_M[1][1], bz = t_M[2][1];
+		const __m256 cx = t_M[0][2], cy = t_M[1][2], cz = t_M[2][2];
+		const __m256 dx = t_M[0][3], dy = t_M[1][3], dz = t_M[2][3];
+		const __m256 x = t_M[3][0], y = t_M[3][1], z = t_M[3][2], w = t_M[3][3];
+
+		__m256 sx = MulSub8(ay, bz, az, by);
+		__m256 sy = MulSub8(az, bx, ax, bz);
+		__m256 sz = MulSub8(ax, by, ay, bx);
+
+		__m256 tx = MulSub8(cy, dz, cz, dy);
+		__m256 ty = MulSub8(cz, dx, cx, dz);
+		__m256 tz = MulSub8(cx, dy, cy, dx);
+
+		__m256 ux = MulSub8(ax, y, bx, x);
+		__m256 uy = MulSub8(ay, y, by, x);
+		__m256 uz = MulSub8(az, y, bz, x);
+
+		__m256 vx = MulSub8(cx, w, dx, z);
+		__m256 vy = MulSub8(cy, w, dy, z);
+		__m256 vz = MulSub8(cz, w, dz, z);
+
+		const __m256 inv_det = _mm256_div_ps(_mm256_set1_ps(1.0f),
+			_mm256_add_ps(Dot8(sx, sy, sz, vx, vy, vz), Dot8(tx, ty, tz, ux, uy, uz)));
+		sx = _mm256_mul_ps(sx, inv_det); sy = _mm256_mul_ps(sy, inv_det); sz = _mm256_mul_ps(sz, inv_det);
+		tx = _mm256_mul_ps(tx, inv_det); ty = _mm256_mul_ps(ty, inv_det); tz = _mm256_mul_ps(tz, inv_det);
+		ux = _mm256_mul_ps(ux, inv_det); uy = _mm256_mul_ps(uy, inv_det); uz = _mm256_mul_ps(uz, inv_det);
+		vx = _mm256_mul_ps(vx, inv_det); vy = _mm256_mul_ps(vy, inv_det); vz = _mm256_mul_ps(vz, inv_det);
+
+		const __m256 t_Negative = _mm256_set1_ps(-1.f);
+
+		__m256 t_Out[4][4];
+		t_Out[0][0] = _mm256_add_ps(MulSub8(by, vz, bz, vy), _mm256_mul_ps(tx, y));
+		t_Out[0][1] = _mm256_add_ps(MulSub8(bz, vx, bx, vz), _mm256_mul_ps(ty, y));
+		t_Out[0][2] = _mm256_add_ps(MulSub8(bx, vy, by, vx), _mm256_mul_ps(tz, y));
+		t_Out[0][3] = _mm256_mul_ps(Dot8(bx, by, bz, tx, ty, tz), t_Negative);
+
+		t_Out[1][0] = _mm256_sub_ps(MulSub8(vy, az, vz, ay), _mm256_mul_ps(tx, x));
+		t_Out[1][1] = _mm256_sub_ps(MulSub8(vz, ax, vx, az), _mm256_mul_ps(ty, x));
+		t_Out[1][2] = _mm256_sub_ps(MulSub8(vx, ay, vy, ax), _mm256_mul_ps(tz, x));
+		t_Out[1][3] = Dot8(ax, ay, az, tx, ty, tz);
+
+		t_Out[2][0] = _mm256_add_ps(MulSub8(dy, uz, dz, uy), _mm256_mul_ps(sx, w));
+		t_Out[2][1] = _mm256_add_ps(MulSub8(dz, ux, dx, uz), _mm256_mul_ps(sy, w));
+		t_Out[2][2] = _mm256_add_ps(MulSub8(dx, uy, dy, ux), _mm256_mul_ps(sz, w));
+		t_Out[2][3] = _mm256_mul_ps(Dot8(dx, dy, dz, sx, sy, sz), t_Negative);
+
+		t_Out[3][0] = _mm256_sub_ps(MulSub8(uy, cz, uz, cy), _mm256_mul_ps(sx, z));
+		t_Out[3][1] = _mm256_sub_ps(MulSub8(uz, cx, ux, cz), _mm256_mul_ps(sy, z));
+		t_Out[3][2] = _mm256_sub_ps(MulSub8(ux, cy, uy, cx), _mm256_mul_ps(sz, z));
+		t_Out[3][3] = Dot8(cx, cy, cz, sx, sy, sz);
+
+		for (int r = 0; r < 4; r++)
+		{
+			Transpose8(t_Out[r][0], t_Out[r][1], t_Out[r][2], t_Out[r][3]);
+			for (int j = 0; j < 4; j++)
+			{
+				_mm_storeu_ps(a_Out[i + j].e[r], _mm256_castps256_ps128(t_Out[r][j]));
+				_mm_storeu_ps(a_Out[i + j + 4].e[r], _mm256_extractf128_ps(t_Out[r][j], 1));
+			}
+		}
+	}
+
+	Mat4x4InverseBatchSIMD4(a_Out + i, a_Matrices + i, a_Count - i);
+}
+#pragma endregion
+#endif //BB_SIMD_SSE
+
+void BB::Mat4x4MultiplyBatch(Mat4x4* a_Out, const Mat4x4* a_Lhs, const Mat4x4* a_Rhs, const size_t a_Count)
+{
+#ifdef BB_SIMD_SSE
+	if (Memory::GetSIMDLevel() != Memory::SIMD_LEVEL::SSE2)
+		return Mat4x4MultiplyBatchAVX2(a_Out, a_Lhs, a_Rhs, a_Count);
+#endif //BB_SIMD_SSE
+	for (size_t i = 0; i < a_Count; i++)
+		a_Out[i] = a_Lhs[i] * a_Rhs[i];
+}
+
+void BB::Mat4x4InverseBatch(Mat4x4* a_Out, const Mat4x4* a_Matrices, const size_t a_Count)
+{
+#ifdef BB_SIMD_SSE
+	if (Memory::GetSIMDLevel() != Memory::SIMD_LEVEL::SSE2)
+		return Mat4x4InverseBatchAVX2(a_Out, a_Matrices, a_Count);
+#endif //BB_SIMD_SSE
+#ifdef BB_SIMD
+	Mat4x4InverseBatchSIMD4(a_Out, a_Matrices, a_Count);
+#else
+	for (size_t i = 0; i < a_Count; i++)
+		a_Out[i] = Mat4x4Inverse(a_Matrices[i]);
+#endif //BB_SIMD
+}
+
+void BB::Mat4x4FromTRSBatch(Mat4x4* a_Matrices, Mat4x4* a_Inverses, const size_t a_Stride,
+	const float3* a_Positions, const Quat* a_Rotations, const float3* a_Scales,
+	const uint32_t* a_Indices, const size_t a_Count, const bool a_Stream)
+{
+#ifdef BB_SIMD
+	if (a_Stream)
+	{
+		BB_ASSERT((reinterpret_cast<uintptr_t>(a_Matrices) & 15) == 0 && (reinterpret_cast<uintptr_t>(a_Inverses) & 15) == 0 && (a_Stride & 15) == 0,
+			"Mat4x4FromTRSBatch streaming needs 16 byte aligned matrices!");
+		return Mat4x4FromTRSBatchSIMD4<true>(a_Matrices, a_Inverses, a_Stride, a_Positions, a_Rotations, a_Scales, a_Indices, a_Count);
+	}
+	Mat4x4FromTRSBatchSIMD4<false>(a_Matrices, a_Inverses, a_Stride, a_Positions, a_Rotations, a_Scales, a_Indices, a_Count);
+#else
+	(void)a_Stream;
+	for (size_t i = 0; i < a_Count; i++)
+	{
+		const uint32_t t_Index = a_Indices[i];
+		const Mat4x4 t_Matrix = Mat4x4FromTRS(a_Positions[t_Index], a_Rotations[t_Index], a_Scales[t_Index]);
+		*reinterpret_cast<Mat4x4*>(reinterpret_cast<char*>(a_Matrices) + t_Index * a_Stride) = t_Matrix;
+		*reinterpret_cast<Mat4x4*>(reinterpret_cast<char*>(a_Inverses) + t_Index * a_Stride) = Mat4x4Inverse(t_Matrix);
+	}
+#endif //BB_SIMD
+}
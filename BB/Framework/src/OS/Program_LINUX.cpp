@@ -0,0 +1,1012 @@
+#include "BBGlobal.h"
+#include "Program.h"
+#include "HID.inl"
+#include "Math.inl"
+#include "Utils/Logger.h"
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/Xatom.h>
+#include <X11/XKBlib.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <dlfcn.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+#include <cwchar>
+
+#include <atomic>
+#include <iterator>
+#include <mutex>
+
+using namespace BB;
+
+void DefaultClose(WindowHandle) {}
+void DefaultResize(WindowHandle, uint32_t, uint32_t) {}
+
+static PFN_WindowCloseEvent sPFN_CloseEvent = DefaultClose;
+static PFN_WindowResizeEvent sPFN_ResizeEvent = DefaultResize;
+
+constexpr const uint32_t MAX_OS_WINDOWS = 8;
+
+struct InputBuffer
+{
+	InputEvent inputBuff[INPUT_EVENT_BUFFER_MAX];
+	uint32_t start = 0;
+	uint16_t pos = 0;
+	uint16_t used = 0;
+};
+
+//X11 has no resize event, ConfigureNotify is also send on a move so the last size is kept to only report real resizes.
+struct X11WindowInfo
+{
+	XID window = 0;
+	int width = 0;
+	int height = 0;
+};
+
+struct GlobalProgramInfo
+{
+	bool trackingMouse = true;
+	//All windows share one connection to the X server, opened with the first window.
+	Display* display = nullptr;
+	//XOpenDisplay failed, it is not tried again.
+	bool noDisplay = false;
+	Atom deleteWindowAtom = 0;
+	X11WindowInfo windows[MAX_OS_WINDOWS]{};
+	//X11 gives the mouse position, the offset is calculated from the last one.
+	float2 lastMousePos{};
+	bool hasLastMousePos = false;
+};
+
+static GlobalProgramInfo s_ProgramInfo{};
+static InputBuffer s_InputBuffer{};
+static std::mutex s_InputMutex{};
+
+static void PushInput(const InputEvent& a_Input)
+{
+	s_InputMutex.lock();
+	if (static_cast<size_t>(s_InputBuffer.pos) + 1 > INPUT_EVENT_BUFFER_MAX)
+		s_InputBuffer.pos = 0;
+
+	s_InputBuffer.inputBuff[s_InputBuffer.pos++] = a_Input;
+
+	//Since when we get the input we get all of it. 
+	if (s_InputBuffer.used < INPUT_EVENT_BUFFER_MAX)
+	{
+		++s_InputBuffer.used;
+	}
+	s_InputMutex.unlock();
+}
+
+static void GetAllInput(InputEvent* a_InputBuffer)
+{
+	s_InputMutex.lock();
+	uint32_t t_FirstIndex = s_InputBuffer.start;
+	for (size_t i = 0; i < s_InputBuffer.used; i++)
+	{
+		a_InputBuffer[i] = s_InputBuffer.inputBuff[t_FirstIndex];
+		//We go back to zero the read the data.
+		if (++t_FirstIndex >= INPUT_EVENT_BUFFER_MAX)
+			t_FirstIndex = 0;
+	}
+
+	s_InputBuffer.start = s_InputBuffer.pos;
+	s_InputBuffer.used = 0;
+	s_InputMutex.unlock();
+}
+
+//Linux paths are multibyte, the wide versions of the functions convert the path first.
+static bool WidePathToMultibyte(const wchar* a_Path, char (&a_Buffer)[PATH_MAX])
+{
+	if (wcstombs(a_Buffer, a_Path, sizeof(a_Buffer)) >= sizeof(a_Buffer))
+	{
+		BB_WARNING(false,
+			"OS, file path cannot be converted to a multibyte path!",
+			WarningType::MEDIUM);
+		return false;
+	}
+	return true;
+}
+
+//Keeps writing until everything is written, write can stop early on a signal or a full pipe.
+static bool WriteAll(const int a_File, const void* a_Data, const size_t a_Size)
+{
+	size_t t_Written = 0;
+	while (t_Written < a_Size)
+	{
+		const ssize_t t_Result = write(a_File, Pointer::Add(a_Data, t_Written), a_Size - t_Written);
+		if (t_Result == -1)
+		{
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		t_Written += static_cast<size_t>(t_Result);
+	}
+	return true;
+}
+
+void BB::InitProgram()
+{
+	SetupHIDTranslates();
+}
+
+//From linux/mempolicy.h, not every distro ships libnuma so mbind is called through syscall.
+constexpr const int LINUX_MPOL_PREFERRED = 1;
+constexpr const size_t LINUX_DEFAULT_HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+constexpr const size_t LINUX_MINIMUM_ALLOCATION = 64 * 1024;
+
+const size_t BB::VirtualMemoryPageSize()
+{
+	static const size_t s_PageSize = static_cast<size_t>(sysconf(_SC_PAGE_SIZE));
+	return s_PageSize;
+}
+
+const size_t BB::VirtualMemoryMinimumAllocation()
+{
+	//Linux can reserve on any page, but use the Windows allocation granularity so reservations are just as big on both.
+	return Max(VirtualMemoryPageSize(), LINUX_MINIMUM_ALLOCATION);
+}
+
+static size_t ReadHugePageSize()
+{
+	FILE* t_MemInfo = fopen("/proc/meminfo", "r");
+	if (t_MemInfo == nullptr)
+		return LINUX_DEFAULT_HUGE_PAGE_SIZE;
+
+	size_t t_HugePageSize = LINUX_DEFAULT_HUGE_PAGE_SIZE;
+	char t_Line[256];
+	while (fgets(t_Line, sizeof(t_Line), t_MemInfo) != nullptr)
+	{
+		unsigned long t_SizeKB;
+		if (sscanf(t_Line, "Hugepagesize: %lu kB", &t_SizeKB) == 1)
+		{
+			t_HugePageSize = static_cast<size_t>(t_SizeKB) * 1024;
+			break;
+		}
+	}
+	fclose(t_MemInfo);
+	return t_HugePageSize;
+}
+
+const size_t BB::VirtualMemoryHugePageSize()
+{
+	static const size_t s_HugePageSize = ReadHugePageSize();
+	return s_HugePageSize;
+}
+
+void* BB::ReserveVirtualMemory(const size_t a_Size, const VIRTUAL_PAGE_TYPE a_PageType, const uint32_t a_NumaNode)
+{
+	void* t_Address = MAP_FAILED;
+	if (a_PageType == VIRTUAL_PAGE_TYPE::EXPLICIT_HUGE)
+	{
+		//No MAP_NORESERVE, the kernel fails here if the pool does not have enough huge pages instead of crashing on the first touch.
+		t_Address = mmap(nullptr, a_Size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		BB_WARNING(t_Address != MAP_FAILED, "Not enough explicit huge pages in the pool, using transparent huge pages instead.", WarningType::OPTIMALIZATION);
+	}
+
+	if (t_Address == MAP_FAILED)
+	{
+		if (a_PageType == VIRTUAL_PAGE_TYPE::NORMAL)
+		{
+			t_Address = mmap(nullptr, a_Size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+			if (t_Address == MAP_FAILED)
+				return nullptr;
+		}
+		else
+		{
+			//The kernel only uses huge pages for aligned ranges, reserve extra to align the start and give back the rest.
+			const size_t t_HugePageSize = VirtualMemoryHugePageSize();
+			void* t_Mapped = mmap(nullptr, a_Size + t_HugePageSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+			if (t_Mapped == MAP_FAILED)
+				return nullptr;
+
+			const size_t t_Head = Pointer::AlignForwardAdjustment(t_Mapped, t_HugePageSize);
+			t_Address = Pointer::Add(t_Mapped, t_Head);
+			if (t_Head != 0)
+				munmap(t_Mapped, t_Head);
+			if (t_HugePageSize - t_Head != 0)
+				munmap(Pointer::Add(t_Address, a_Size), t_HugePageSize - t_Head);
+
+			BB_WARNING(madvise(t_Address, a_Size, MADV_HUGEPAGE) == 0, "madvise for transparent huge pages failed, transparent huge pages might be disabled.", WarningType::OPTIMALIZATION);
+		}
+	}
+
+	if (a_NumaNode != VIRTUAL_NUMA_NODE_ANY)
+	{
+		//The policy is used when the pages are touched, so setting it on the reservation covers every commit.
+		unsigned long t_NodeMask = 0;
+		if (a_NumaNode < sizeof(t_NodeMask) * 8)
+		{
+			t_NodeMask = 1ul << a_NumaNode;
+			//The kernel reads one bit less then maxnode.
+			const long t_Result = syscall(SYS_mbind, t_Address, a_Size, LINUX_MPOL_PREFERRED, &t_NodeMask, sizeof(t_NodeMask) * 8 + 1, 0);
+			BB_WARNING(t_Result == 0, "mbind failed, the NUMA node preference is ignored.", WarningType::OPTIMALIZATION);
+		}
+		else
+			BB_WARNING(false, "NUMA node is too high, the NUMA node preference is ignored.", WarningType::OPTIMALIZATION);
+	}
+
+	return t_Address;
+}
+
+bool BB::CommitVirtualMemory(void* a_Ptr, const size_t a_Size)
+{
+	return mprotect(a_Ptr, a_Size, PROT_READ | PROT_WRITE) == 0;
+}
+
+bool BB::ReleaseVirtualMemory(void* a_Ptr, const size_t a_Size)
+{
+	return munmap(a_Ptr, a_Size) == 0;
+}
+
+const uint32_t BB::LatestOSError()
+{
+	const int t_Error = errno;
+	if (t_Error == 0)
+		return 0;
+
+	BB_WARNING(false, strerror(t_Error), WarningType::HIGH);
+	return static_cast<uint32_t>(t_Error);
+}
+
+LibHandle BB::LoadLib(const wchar* a_LibName)
+{
+	char t_LibName[PATH_MAX];
+	if (!WidePathToMultibyte(a_LibName, t_LibName))
+		return LibHandle(0);
+
+	//LoadLibrary adds .dll when there is no extension, do the same with .so.
+	if (strchr(t_LibName, '.') == nullptr && strlen(t_LibName) + sizeof(".so") <= sizeof(t_LibName))
+		strcat(t_LibName, ".so");
+
+	void* t_Lib = dlopen(t_LibName, RTLD_NOW | RTLD_LOCAL);
+	if (t_Lib == nullptr)
+	{
+		BB_WARNING(false, dlerror(), WarningType::HIGH);
+		BB_ASSERT(false, "Failed to load .so");
+	}
+	return LibHandle(reinterpret_cast<uintptr_t>(t_Lib));
+}
+
+void BB::UnloadLib(const LibHandle a_Handle)
+{
+	dlclose(reinterpret_cast<void*>(a_Handle.ptrHandle));
+}
+
+LibFuncPtr BB::LibLoadFunc(const LibHandle a_Handle, const char* a_FuncName)
+{
+	LibFuncPtr t_Func = dlsym(reinterpret_cast<void*>(a_Handle.ptrHandle), a_FuncName);
+	if (t_Func == nullptr)
+	{
+		BB_WARNING(false, dlerror(), WarningType::HIGH);
+		BB_ASSERT(false, "Failed to load function from .so");
+	}
+	return t_Func;
+}
+
+void BB::WriteToConsole(const char* a_String, uint32_t a_StrLength)
+{
+	if (!WriteAll(STDOUT_FILENO, a_String, a_StrLength))
+	{
+		BB_WARNING(false,
+			"OS, failed to write to console! This can be severe.",
+			WarningType::HIGH);
+		LatestOSError();
+	}
+}
+
+void BB::WriteToConsole(const wchar_t* a_String, uint32_t a_StrLength)
+{
+	//Convert in small pieces so that no allocation is needed, characters that the locale cannot show become '?'.
+	char t_Buffer[256];
+	size_t t_Used = 0;
+	mbstate_t t_State{};
+	for (uint32_t i = 0; i < a_StrLength; i++)
+	{
+		if (t_Used + MB_LEN_MAX > sizeof(t_Buffer))
+		{
+			WriteToConsole(t_Buffer, static_cast<uint32_t>(t_Used));
+			t_Used = 0;
+		}
+
+		const size_t t_Size = wcrtomb(t_Buffer + t_Used, a_String[i], &t_State);
+		if (t_Size == static_cast<size_t>(-1))
+		{
+			t_Buffer[t_Used++] = '?';
+			t_State = mbstate_t{};
+		}
+		else
+			t_Used += t_Size;
+	}
+	WriteToConsole(t_Buffer, static_cast<uint32_t>(t_Used));
+}
+
+OSFileHandle BB::CreateOSFile(const char* a_FileName)
+{
+	const int t_CreatedFile = open(a_FileName, O_CREAT | O_TRUNC | O_RDWR | O_CLOEXEC, 0644);
+	if (t_CreatedFile == -1)
+	{
+		LatestOSError();
+		BB_WARNING(false,
+			"OS, failed to create file! This can be severe.",
+			WarningType::HIGH);
+		return OSFileHandle(0);
+	}
+
+	return OSFileHandle(static_cast<uint64_t>(t_CreatedFile));
+}
+
+OSFileHandle BB::CreateOSFile(const wchar* a_FileName)
+{
+	char t_FileName[PATH_MAX];
+	if (!WidePathToMultibyte(a_FileName, t_FileName))
+		return OSFileHandle(0);
+	return CreateOSFile(t_FileName);
+}
+
+OSFileHandle BB::LoadOSFile(const char* a_FileName)
+{
+	int t_LoadedFile = open(a_FileName, O_RDWR | O_CLOEXEC);
+	//Read-only files can still be loaded for reading.
+	if (t_LoadedFile == -1 && (errno == EACCES || errno == EROFS))
+		t_LoadedFile = open(a_FileName, O_RDONLY | O_CLOEXEC);
+
+	if (t_LoadedFile == -1)
+	{
+		LatestOSError();
+		return OSFileHandle(0);
+	}
+
+	return OSFileHandle(static_cast<uint64_t>(t_LoadedFile));
+}
+
+OSFileHandle BB::LoadOSFile(const wchar* a_FileName)
+{
+	char t_FileName[PATH_MAX];
+	if (!WidePathToMultibyte(a_FileName, t_FileName))
+		return OSFileHandle(0);
+	return LoadOSFile(t_FileName);
+}
+
+void BB::WriteToFile(const OSFileHandle a_FileHandle, const Buffer& a_Buffer)
+{
+	if (!WriteAll(static_cast<int>(a_FileHandle.handle), a_Buffer.data, a_Buffer.size))
+	{
+		LatestOSError();
+		BB_WARNING(false,
+			"OS, failed to write to file!",
+			WarningType::HIGH);
+	}
+}
+
+//Reads a loaded file from the current file position.
+//Buffer.data will have a dynamic allocation from the given allocator.
+Buffer BB::ReadOSFile(Allocator a_SysAllocator, const OSFileHandle a_FileHandle)
+{
+	Buffer t_FileBuffer{};
+
+	const uint64_t t_FileSize = GetOSFileSize(a_FileHandle);
+	t_FileBuffer.data = reinterpret_cast<char*>(BBalloc(a_SysAllocator, t_FileSize));
+	while (t_FileBuffer.size < t_FileSize)
+	{
+		const uint64_t t_Read = ReadFromOSFile(a_FileHandle, t_FileBuffer.data + t_FileBuffer.size, t_FileSize - t_FileBuffer.size);
+		if (t_Read == 0)
+			break;
+		t_FileBuffer.size += t_Read;
+	}
+
+	return t_FileBuffer;
+}
+
+Buffer BB::ReadOSFile(Allocator a_SysAllocator, const char* a_Path)
+{
+	const OSFileHandle t_ReadFile = LoadOSFile(a_Path);
+	if (t_ReadFile.handle == 0)
+	{
+		BB_WARNING(false,
+			"OS, failed to load file! This can be severe.",
+			WarningType::HIGH);
+		return Buffer{};
+	}
+
+	const Buffer t_FileBuffer = ReadOSFile(a_SysAllocator, t_ReadFile);
+	CloseOSFile(t_ReadFile);
+	return t_FileBuffer;
+}
+
+Buffer BB::ReadOSFile(Allocator a_SysAllocator, const wchar* a_Path)
+{
+	char t_Path[PATH_MAX];
+	if (!WidePathToMultibyte(a_Path, t_Path))
+		return Buffer{};
+	return ReadOSFile(a_SysAllocator, t_Path);
+}
+
+uint64_t BB::ReadFromOSFile(const OSFileHandle a_FileHandle, void* a_Data, const uint64_t a_Size)
+{
+	ssize_t t_BytesRead = read(static_cast<int>(a_FileHandle.handle), a_Data, a_Size);
+	//Interrupted by a signal before anything was read, just try again.
+	while (t_BytesRead == -1 && errno == EINTR)
+		t_BytesRead = read(static_cast<int>(a_FileHandle.handle), a_Data, a_Size);
+
+	if (t_BytesRead == -1)
+	{
+		BB_WARNING(false,
+			"OS, failed to read from file!",
+			WarningType::HIGH);
+		return 0;
+	}
+	return static_cast<uint64_t>(t_BytesRead);
+}
+
+bool BB::ReadOSFileAt(const OSFileHandle a_FileHandle, void* a_Data, const uint64_t a_Size, const uint64_t a_Offset, uint64_t& a_BytesRead)
+{
+	a_BytesRead = 0;
+	while (a_BytesRead < a_Size)
+	{
+		const ssize_t t_ChunkRead = pread(static_cast<int>(a_FileHandle.handle),
+			Pointer::Add(a_Data, a_BytesRead),
+			a_Size - a_BytesRead,
+			static_cast<off_t>(a_Offset + a_BytesRead));
+
+		if (t_ChunkRead == -1)
+		{
+			if (errno == EINTR)
+				continue;
+
+			BB_WARNING(false,
+				"OS, failed to read from file!",
+				WarningType::HIGH);
+			return false;
+		}
+
+		//End of the file.
+		if (t_ChunkRead == 0)
+			break;
+		a_BytesRead += static_cast<uint64_t>(t_ChunkRead);
+	}
+	return true;
+}
+
+Buffer BB::MapOSFile(const char* a_Path, const OS_FILE_ACCESS_HINT a_Hint)
+{
+	Buffer t_Mapping{};
+	const int t_File = open(a_Path, O_RDONLY | O_CLOEXEC);
+	if (t_File == -1)
+	{
+		BB_WARNING(false,
+			"OS, failed to open a file for mapping!",
+			WarningType::MEDIUM);
+		return t_Mapping;
+	}
+
+	struct stat t_FileInfo;
+	//Empty files cannot be mapped.
+	if (fstat(t_File, &t_FileInfo) == 0 && t_FileInfo.st_size > 0)
+	{
+		const size_t t_FileSize = static_cast<size_t>(t_FileInfo.st_size);
+		void* t_Address = mmap(nullptr, t_FileSize, PROT_READ, MAP_PRIVATE, t_File, 0);
+		if (t_Address != MAP_FAILED)
+		{
+			switch (a_Hint)
+			{
+			case OS_FILE_ACCESS_HINT::SEQUENTIAL:
+				madvise(t_Address, t_FileSize, MADV_SEQUENTIAL);
+				madvise(t_Address, t_FileSize, MADV_WILLNEED);
+				break;
+			case OS_FILE_ACCESS_HINT::RANDOM:
+				madvise(t_Address, t_FileSize, MADV_RANDOM);
+				break;
+			default:
+				break;
+			}
+			t_Mapping.data = reinterpret_cast<char*>(t_Address);
+			t_Mapping.size = t_FileSize;
+		}
+		else
+			BB_WARNING(false,
+				"OS, failed to map a file!",
+				WarningType::HIGH);
+	}
+
+	//The mapping keeps the file open by itself.
+	close(t_File);
+	return t_Mapping;
+}
+
+Buffer BB::MapOSFile(const wchar* a_Path, const OS_FILE_ACCESS_HINT a_Hint)
+{
+	char t_Path[PATH_MAX];
+	if (!WidePathToMultibyte(a_Path, t_Path))
+		return Buffer{};
+	return MapOSFile(t_Path, a_Hint);
+}
+
+void BB::UnmapOSFile(const Buffer& a_Mapping)
+{
+	if (a_Mapping.data != nullptr)
+		munmap(a_Mapping.data, a_Mapping.size);
+}
+
+uint64_t BB::GetOSFileSize(const OSFileHandle a_FileHandle)
+{
+	struct stat t_FileInfo;
+	if (fstat(static_cast<int>(a_FileHandle.handle), &t_FileInfo) == -1)
+	{
+		LatestOSError();
+		return 0;
+	}
+	return static_cast<uint64_t>(t_FileInfo.st_size);
+}
+
+void BB::SetOSFilePosition(const OSFileHandle a_FileHandle, const int64_t a_Offset, const OS_FILE_READ_POINT a_FileReadPoint)
+{
+	if (lseek(static_cast<int>(a_FileHandle.handle), static_cast<off_t>(a_Offset), static_cast<int>(a_FileReadPoint)) == -1)
+	{
+		LatestOSError();
+		BB_WARNING(false,
+			"OS, Setting the file position failed, it might be put in negative!",
+			WarningType::HIGH);
+	}
+}
+
+void BB::CloseOSFile(const OSFileHandle a_FileHandle)
+{
+	close(static_cast<int>(a_FileHandle.handle));
+}
+
+//pthread wants a function that returns a void*, the start info is freed by the new thread.
+struct LinuxThreadStart
+{
+	void(*function)(void*);
+	void* parameter;
+};
+
+static void* LinuxThreadEntry(void* a_Start)
+{
+	const LinuxThreadStart t_Start = *reinterpret_cast<LinuxThreadStart*>(a_Start);
+	delete reinterpret_cast<LinuxThreadStart*>(a_Start);
+	t_Start.function(t_Start.parameter);
+	return nullptr;
+}
+
+static pthread_t StartLinuxThread(void(*a_Func)(void*), const unsigned int a_StackSize, void* a_ArgList, const cpu_set_t* a_Affinity, int& a_Result)
+{
+	pthread_attr_t t_Attributes;
+	pthread_attr_init(&t_Attributes);
+	if (a_StackSize != 0)
+		pthread_attr_setstacksize(&t_Attributes, Max(static_cast<size_t>(a_StackSize), static_cast<size_t>(PTHREAD_STACK_MIN)));
+	if (a_Affinity != nullptr)
+		pthread_attr_setaffinity_np(&t_Attributes, sizeof(cpu_set_t), a_Affinity);
+
+	LinuxThreadStart* t_Start = new LinuxThreadStart{ a_Func, a_ArgList };
+	pthread_t t_Thread{};
+	a_Result = pthread_create(&t_Thread, &t_Attributes, LinuxThreadEntry, t_Start);
+	if (a_Result != 0)
+		delete t_Start;
+
+	pthread_attr_destroy(&t_Attributes);
+	return t_Thread;
+}
+
+OSThreadHandle BB::OSCreateThread(void(*a_Func)(void*), const unsigned int a_StackSize, void* a_ArgList, const uint32_t a_CoreIndex)
+{
+	int t_Result = -1;
+	pthread_t t_Thread{};
+	if (a_CoreIndex != OS_THREAD_ANY_CORE)
+	{
+		if (a_CoreIndex < CPU_SETSIZE)
+		{
+			cpu_set_t t_Affinity;
+			CPU_ZERO(&t_Affinity);
+			CPU_SET(a_CoreIndex, &t_Affinity);
+			t_Thread = StartLinuxThread(a_Func, a_StackSize, a_ArgList, &t_Affinity, t_Result);
+		}
+		//The core does not exist or the process is not allowed on it.
+		BB_WARNING(t_Result == 0, "OS, thread affinity is not possible for this core, the thread can run on any core.", WarningType::OPTIMALIZATION);
+	}
+
+	if (t_Result != 0)
+		t_Thread = StartLinuxThread(a_Func, a_StackSize, a_ArgList, nullptr, t_Result);
+
+	BB_ASSERT(t_Result == 0, "OS, failed to create a thread!");
+	return OSThreadHandle(static_cast<uint64_t>(t_Thread));
+}
+
+void BB::OSWaitThreadfinish(const OSThreadHandle a_Thread)
+{
+	pthread_join(static_cast<pthread_t>(a_Thread.handle), nullptr);
+}
+
+//Recursive like the Windows mutex, the logger locks again when a job it waits on logs something.
+//state is 0 when unlocked, 1 when locked and 2 when locked and another thread sleeps on it.
+struct OSMutex
+{
+	std::atomic<uint32_t> state{ 0 };
+	std::atomic<pid_t> owner{ 0 };
+	uint32_t recursion = 0;
+};
+
+static inline pid_t CurrentThreadId()
+{
+	static thread_local const pid_t s_ThreadId = static_cast<pid_t>(syscall(SYS_gettid));
+	return s_ThreadId;
+}
+
+BBMutex BB::OSCreateMutex()
+{
+	return BBMutex(reinterpret_cast<uintptr_t>(new OSMutex()));
+}
+
+void BB::OSWaitAndLockMutex(const BBMutex a_Mutex)
+{
+	OSMutex* t_Mutex = reinterpret_cast<OSMutex*>(a_Mutex.ptrHandle);
+	const pid_t t_ThreadId = CurrentThreadId();
+	if (t_Mutex->owner.load(std::memory_order_relaxed) == t_ThreadId)
+	{
+		++t_Mutex->recursion;
+		return;
+	}
+
+	//Uncontended it's a single compare exchange, otherwise mark it contended and sleep in the kernel.
+	uint32_t t_State = 0;
+	if (!t_Mutex->state.compare_exchange_strong(t_State, 1, std::memory_order_acquire, std::memory_order_relaxed))
+	{
+		if (t_State != 2)
+			t_State = t_Mutex->state.exchange(2, std::memory_order_acquire);
+		while (t_State != 0)
+		{
+			OSWaitOnAddress(&t_Mutex->state, 2);
+			t_State = t_Mutex->state.exchange(2, std::memory_order_acquire);
+		}
+	}
+
+	t_Mutex->owner.store(t_ThreadId, std::memory_order_relaxed);
+	t_Mutex->recursion = 1;
+}
+
+void BB::OSUnlockMutex(const BBMutex a_Mutex)
+{
+	OSMutex* t_Mutex = reinterpret_cast<OSMutex*>(a_Mutex.ptrHandle);
+	BB_ASSERT(t_Mutex->owner.load(std::memory_order_relaxed) == CurrentThreadId(), "OS, unlocking a mutex that this thread did not lock!");
+	if (--t_Mutex->recursion != 0)
+		return;
+
+	t_Mutex->owner.store(0, std::memory_order_relaxed);
+	//Only go to the kernel when someone might be sleeping.
+	if (t_Mutex->state.exchange(0, std::memory_order_release) == 2)
+		OSWakeOneOnAddress(&t_Mutex->state);
+}
+
+void BB::DestroyMutex(const BBMutex a_Mutex)
+{
+	delete reinterpret_cast<OSMutex*>(a_Mutex.ptrHandle);
+}
+
+void BB::OSWaitOnAddress(const volatile void* a_Address, const uint32_t a_Expected)
+{
+	syscall(SYS_futex, a_Address, FUTEX_WAIT_PRIVATE, a_Expected, nullptr, nullptr, 0);
+}
+
+void BB::OSWakeOneOnAddress(const volatile void* a_Address)
+{
+	syscall(SYS_futex, a_Address, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+
+void BB::OSWakeAllOnAddress(const volatile void* a_Address)
+{
+	syscall(SYS_futex, a_Address, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+
+//nullptr if there is no X server, every window and input function checks for it.
+static Display* GetDisplay()
+{
+	if (s_ProgramInfo.display == nullptr && !s_ProgramInfo.noDisplay)
+	{
+		s_ProgramInfo.display = XOpenDisplay(nullptr);
+		if (s_ProgramInfo.display == nullptr)
+		{
+			Logger::Log_Warning_High(__FILE__, __LINE__, "s", "Linux XOpenDisplay failed, no windows can be made.");
+			s_ProgramInfo.noDisplay = true;
+			return nullptr;
+		}
+		//Holding a key only sends presses, like Windows raw input. Without it X11 sends a release and press pair for every repeat.
+		XkbSetDetectableAutoRepeat(s_ProgramInfo.display, True, nullptr);
+		s_ProgramInfo.deleteWindowAtom = XInternAtom(s_ProgramInfo.display, "WM_DELETE_WINDOW", False);
+	}
+	return s_ProgramInfo.display;
+}
+
+static X11WindowInfo* FindWindowInfo(const XID a_Window)
+{
+	for (uint32_t i = 0; i < MAX_OS_WINDOWS; i++)
+		if (s_ProgramInfo.windows[i].window == a_Window)
+			return &s_ProgramInfo.windows[i];
+	return nullptr;
+}
+
+WindowHandle BB::CreateOSWindow(const OS_WINDOW_STYLE a_Style, const int a_X, const int a_Y, const int a_Width, const int a_Height, const wchar* a_WindowName)
+{
+	Display* t_Display = GetDisplay();
+	if (t_Display == nullptr)
+		return WindowHandle(static_cast<uint64_t>(0));
+	X11WindowInfo* t_WindowInfo = FindWindowInfo(0);
+	BB_ASSERT(t_WindowInfo != nullptr, "Too many OS windows, increase MAX_OS_WINDOWS.");
+	if (t_WindowInfo == nullptr)
+		return WindowHandle(static_cast<uint64_t>(0));
+
+	const int t_Screen = DefaultScreen(t_Display);
+	const XID t_Window = XCreateSimpleWindow(t_Display,
+		RootWindow(t_Display, t_Screen),
+		a_X,
+		a_Y,
+		static_cast<unsigned int>(a_Width),
+		static_cast<unsigned int>(a_Height),
+		0,
+		WhitePixel(t_Display, t_Screen),
+		BlackPixel(t_Display, t_Screen));
+
+	switch (a_Style)
+	{
+	case OS_WINDOW_STYLE::MAIN:
+		break;
+	case OS_WINDOW_STYLE::CHILD:
+	{
+		//Tell the window manager it's a utility window so it's not shown as a seperate application.
+		const Atom t_WindowType = XInternAtom(t_Display, "_NET_WM_WINDOW_TYPE", False);
+		const Atom t_Utility = XInternAtom(t_Display, "_NET_WM_WINDOW_TYPE_UTILITY", False);
+		XChangeProperty(t_Display, t_Window, t_WindowType, XA_ATOM, 32, PropModeReplace, reinterpret_cast<const unsigned char*>(&t_Utility), 1);
+		break;
+	}
+	default:
+		BB_ASSERT(false, "Tried to create a window with a OS_WINDOW_STYLE it does not accept.");
+		break;
+	}
+
+	//Same as Windows, the program name is the title.
+	char t_Title[256];
+	if (wcstombs(t_Title, g_ProgramName, sizeof(t_Title)) >= sizeof(t_Title))
+		t_Title[0] = '\0';
+	XStoreName(t_Display, t_Window, t_Title);
+
+	//Windows registers the window name as the window class, X11 has the WM_CLASS hint for that.
+	char t_ClassName[256];
+	if (wcstombs(t_ClassName, a_WindowName, sizeof(t_ClassName)) < sizeof(t_ClassName))
+	{
+		XClassHint t_ClassHint;
+		t_ClassHint.res_name = t_ClassName;
+		t_ClassHint.res_class = t_ClassName;
+		XSetClassHint(t_Display, t_Window, &t_ClassHint);
+	}
+
+	XSelectInput(t_Display, t_Window,
+		KeyPressMask | KeyReleaseMask |
+		ButtonPressMask | ButtonReleaseMask | PointerMotionMask |
+		EnterWindowMask | LeaveWindowMask |
+		StructureNotifyMask);
+	//Get a message instead of the connection being closed when the window's close button is pressed.
+	XSetWMProtocols(t_Display, t_Window, &s_ProgramInfo.deleteWindowAtom, 1);
+
+	XMapRaised(t_Display, t_Window);
+	XFlush(t_Display);
+
+	t_WindowInfo->window = t_Window;
+	t_WindowInfo->width = a_Width;
+	t_WindowInfo->height = a_Height;
+	return WindowHandle(static_cast<uint64_t>(t_Window));
+}
+
+void* BB::GetOSWindowHandle(const WindowHandle a_Handle)
+{
+	return reinterpret_cast<void*>(a_Handle.handle);
+}
+
+void BB::GetWindowSize(const WindowHandle a_Handle, int& a_X, int& a_Y)
+{
+	XWindowAttributes t_Attributes{};
+	Display* t_Display = GetDisplay();
+	if (t_Display != nullptr)
+		XGetWindowAttributes(t_Display, static_cast<XID>(a_Handle.handle), &t_Attributes);
+
+	a_X = t_Attributes.width;
+	a_Y = t_Attributes.height;
+}
+
+void BB::DirectDestroyOSWindow(const WindowHandle a_Handle)
+{
+	X11WindowInfo* t_WindowInfo = FindWindowInfo(static_cast<XID>(a_Handle.handle));
+	if (t_WindowInfo != nullptr)
+		*t_WindowInfo = X11WindowInfo();
+
+	Display* t_Display = GetDisplay();
+	if (t_Display == nullptr)
+		return;
+	XDestroyWindow(t_Display, static_cast<XID>(a_Handle.handle));
+	XFlush(t_Display);
+}
+
+void BB::FreezeMouseOnWindow(const WindowHandle a_Handle)
+{
+	Display* t_Display = GetDisplay();
+	if (t_Display == nullptr)
+		return;
+	const XID t_Window = static_cast<XID>(a_Handle.handle);
+	XGrabPointer(t_Display,
+		t_Window,
+		True,
+		ButtonPressMask | ButtonReleaseMask | PointerMotionMask,
+		GrabModeAsync,
+		GrabModeAsync,
+		t_Window,
+		None,
+		CurrentTime);
+}
+
+void BB::UnfreezeMouseOnWindow()
+{
+	Display* t_Display = GetDisplay();
+	if (t_Display != nullptr)
+		XUngrabPointer(t_Display, CurrentTime);
+}
+
+void BB::SetCloseWindowPtr(PFN_WindowCloseEvent a_Func)
+{
+	sPFN_CloseEvent = a_Func;
+}
+
+void BB::SetResizeEventPtr(PFN_WindowResizeEvent a_Func)
+{
+	sPFN_ResizeEvent = a_Func;
+}
+
+void BB::ExitApp()
+{
+	exit(EXIT_SUCCESS);
+}
+
+static void PushKeyEvent(const XKeyEvent& a_Key, const bool a_Pressed)
+{
+	//X11 keycodes are the evdev codes + 8, the evdev codes are the same as the scan codes Windows raw input gives.
+	const uint32_t t_ScanCode = a_Key.keycode - 8;
+	if (t_ScanCode >= std::size(s_translate_key))
+		return;
+
+	InputEvent t_Event{};
+	t_Event.inputType = INPUT_TYPE::KEYBOARD;
+	t_Event.keyInfo.scancode = s_translate_key[t_ScanCode];
+	t_Event.keyInfo.keyPressed = a_Pressed;
+	PushInput(t_Event);
+}
+
+static void PushMouseEvent(const int a_X, const int a_Y, const uint32_t a_Button, const bool a_Pressed)
+{
+	if (!s_ProgramInfo.trackingMouse)
+		return;
+
+	InputEvent t_Event{};
+	t_Event.inputType = INPUT_TYPE::MOUSE;
+	const float2 t_MousePos{ static_cast<float>(a_X), static_cast<float>(a_Y) };
+	if (s_ProgramInfo.hasLastMousePos)
+		t_Event.mouseInfo.moveOffset = float2{ t_MousePos.x - s_ProgramInfo.lastMousePos.x, t_MousePos.y - s_ProgramInfo.lastMousePos.y };
+	t_Event.mouseInfo.mousePos = t_MousePos;
+	s_ProgramInfo.lastMousePos = t_MousePos;
+	s_ProgramInfo.hasLastMousePos = true;
+
+	switch (a_Button)
+	{
+	case Button1:
+		t_Event.mouseInfo.left_pressed = a_Pressed;
+		t_Event.mouseInfo.left_released = !a_Pressed;
+		break;
+	case Button2:
+		t_Event.mouseInfo.middle_pressed = a_Pressed;
+		t_Event.mouseInfo.middle_released = !a_Pressed;
+		break;
+	case Button3:
+		t_Event.mouseInfo.right_pressed = a_Pressed;
+		t_Event.mouseInfo.right_released = !a_Pressed;
+		break;
+	case Button4:
+		//The wheel is a button press, the release that follows has no extra information.
+		if (!a_Pressed)
+			return;
+		t_Event.mouseInfo.wheelMove = 1;
+		break;
+	case Button5:
+		if (!a_Pressed)
+			return;
+		t_Event.mouseInfo.wheelMove = -1;
+		break;
+	default:
+		break;
+	}
+	PushInput(t_Event);
+}
+
+bool BB::ProcessMessages(const WindowHandle a_WindowHandle)
+{
+	//All windows share the event queue of the display, so this handles the events of every window.
+	(void)a_WindowHandle;
+	Display* t_Display = GetDisplay();
+	//Without a display there are no windows to get messages from.
+	if (t_Display == nullptr)
+		return false;
+	while (XPending(t_Display))
+	{
+		XEvent t_Event;
+		XNextEvent(t_Display, &t_Event);
+
+		switch (t_Event.type)
+		{
+		case ClientMessage:
+			if (static_cast<Atom>(t_Event.xclient.data.l[0]) == s_ProgramInfo.deleteWindowAtom)
+			{
+				const WindowHandle t_Window(static_cast<uint64_t>(t_Event.xclient.window));
+				DirectDestroyOSWindow(t_Window);
+				sPFN_CloseEvent(t_Window);
+			}
+			break;
+		case ConfigureNotify:
+		{
+			X11WindowInfo* t_WindowInfo = FindWindowInfo(t_Event.xconfigure.window);
+			if (t_WindowInfo != nullptr &&
+				(t_WindowInfo->width != t_Event.xconfigure.width || t_WindowInfo->height != t_Event.xconfigure.height))
+			{
+				t_WindowInfo->width = t_Event.xconfigure.width;
+				t_WindowInfo->height = t_Event.xconfigure.height;
+				sPFN_ResizeEvent(WindowHandle(static_cast<uint64_t>(t_Event.xconfigure.window)),
+					static_cast<uint32_t>(t_Event.xconfigure.width),
+					static_cast<uint32_t>(t_Event.xconfigure.height));
+			}
+			break;
+		}
+		case KeyPress:
+			PushKeyEvent(t_Event.xkey, true);
+			break;
+		case KeyRelease:
+			PushKeyEvent(t_Event.xkey, false);
+			break;
+		case ButtonPress:
+			PushMouseEvent(t_Event.xbutton.x, t_Event.xbutton.y, t_Event.xbutton.button, true);
+			break;
+		case ButtonRelease:
+			PushMouseEvent(t_Event.xbutton.x, t_Event.xbutton.y, t_Event.xbutton.button, false);
+			break;
+		case MotionNotify:
+			PushMouseEvent(t_Event.xmotion.x, t_Event.xmotion.y, 0, false);
+			break;
+		case EnterNotify:
+			s_ProgramInfo.trackingMouse = true;
+			s_ProgramInfo.hasLastMousePos = false;
+			break;
+		case LeaveNotify:
+			s_ProgramInfo.trackingMouse = false;
+			break;
+		default:
+			break;
+		}
+	}
+
+	return true;
+}
+
+void BB::PollInputEvents(InputEvent* a_EventBuffers, size_t& a_InputEventAmount)
+{
+	a_InputEventAmount = s_InputBuffer.used;
+	if (a_EventBuffers == nullptr)
+		return;
+
+	//Overwrite could happen! But this is user's responsibility.
+	GetAllInput(a_EventBuffers);
+}
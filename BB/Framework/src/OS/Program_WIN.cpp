@@ -12,6 +12,8 @@
 #include <libloaderapi.h>
 #include <WinUser.h>
 #include <hidusage.h>
+#include <process.h>
+#include <synchapi.h>
 
 #include <mutex>
 
@@ -192,8 +194,17 @@ const size_t BB::VirtualMemoryMinimumAllocation()
 	return t_Info.dwAllocationGranularity;
 }
 
-void* BB::ReserveVirtualMemory(const size_t a_Size)
+const size_t BB::VirtualMemoryHugePageSize()
 {
+	//Windows large pages can only be commited together with the reserve, that does not work with the reserve and commit model.
+	return 0;
+}
+
+void* BB::ReserveVirtualMemory(const size_t a_Size, const VIRTUAL_PAGE_TYPE, const uint32_t a_NumaNode)
+{
+	if (a_NumaNode != VIRTUAL_NUMA_NODE_ANY)
+		return VirtualAllocExNuma(GetCurrentProcess(), nullptr, a_Size, MEM_RESERVE, PAGE_NOACCESS, a_NumaNode);
+
 	return VirtualAlloc(nullptr, a_Size, MEM_RESERVE, PAGE_NOACCESS);
 }
 
@@ -203,7 +214,7 @@ bool BB::CommitVirtualMemory(void* a_Ptr, const size_t a_Size)
 	return t_Ptr;
 }
 
-bool BB::ReleaseVirtualMemory(void* a_Ptr)
+bool BB::ReleaseVirtualMemory(void* a_Ptr, const size_t)
 {
 	return VirtualFree(a_Ptr, 0, MEM_RELEASE);
 }
@@ -453,6 +464,142 @@ Buffer BB::ReadOSFile(Allocator a_SysAllocator, const wchar* a_Path)
 	return t_FileBuffer;
 }
 
+uint64_t BB::ReadFromOSFile(const OSFileHandle a_FileHandle, void* a_Data, const uint64_t a_Size)
+{
+	DWORD t_BytesRead = 0;
+	//ReadFile takes a DWORD, a chunked reader never comes close to that.
+	if (FALSE == ReadFile(reinterpret_cast<HANDLE>(a_FileHandle.ptrHandle),
+		a_Data,
+		static_cast<DWORD>(a_Size),
+		&t_BytesRead,
+		NULL))
+	{
+		LatestOSError();
+		BB_WARNING(false,
+			"OS, failed to read from file!",
+			WarningType::HIGH);
+		return 0;
+	}
+
+	return t_BytesRead;
+}
+
+bool BB::ReadOSFileAt(const OSFileHandle a_FileHandle, void* a_Data, const uint64_t a_Size, const uint64_t a_Offset, uint64_t& a_BytesRead)
+{
+	a_BytesRead = 0;
+	while (a_BytesRead < a_Size)
+	{
+		//The offset in the OVERLAPPED makes it a positional read, even on a handle that is not opened for overlapped I/O.
+		const uint64_t t_Offset = a_Offset + a_BytesRead;
+		OVERLAPPED t_Overlapped{};
+		t_Overlapped.Offset = static_cast<DWORD>(t_Offset);
+		t_Overlapped.OffsetHigh = static_cast<DWORD>(t_Offset >> 32);
+		const DWORD t_ChunkSize = static_cast<DWORD>(Min(static_cast<size_t>(a_Size - a_BytesRead), static_cast<size_t>(UINT32_MAX)));
+		DWORD t_ChunkRead = 0;
+
+		if (FALSE == ReadFile(reinterpret_cast<HANDLE>(a_FileHandle.ptrHandle),
+			Pointer::Add(a_Data, a_BytesRead),
+			t_ChunkSize,
+			&t_ChunkRead,
+			&t_Overlapped))
+		{
+			if (GetLastError() == ERROR_HANDLE_EOF)
+				break;
+
+			LatestOSError();
+			BB_WARNING(false,
+				"OS, failed to read from file!",
+				WarningType::HIGH);
+			return false;
+		}
+
+		if (t_ChunkRead == 0)
+			break;
+		a_BytesRead += t_ChunkRead;
+	}
+	return true;
+}
+
+static DWORD FileFlagsFromHint(const OS_FILE_ACCESS_HINT a_Hint)
+{
+	switch (a_Hint)
+	{
+	case OS_FILE_ACCESS_HINT::SEQUENTIAL:
+		return FILE_FLAG_SEQUENTIAL_SCAN;
+	case OS_FILE_ACCESS_HINT::RANDOM:
+		return FILE_FLAG_RANDOM_ACCESS;
+	default:
+		return FILE_ATTRIBUTE_NORMAL;
+	}
+}
+
+//Closes a_File, the view keeps the file open by itself.
+static Buffer MapOpenedFile(const HANDLE a_File)
+{
+	Buffer t_Mapping{};
+	if (a_File == INVALID_HANDLE_VALUE)
+	{
+		LatestOSError();
+		BB_WARNING(false,
+			"OS, failed to open a file for mapping!",
+			WarningType::MEDIUM);
+		return t_Mapping;
+	}
+
+	LARGE_INTEGER t_FileSize;
+	//Empty files cannot be mapped.
+	if (GetFileSizeEx(a_File, &t_FileSize) && t_FileSize.QuadPart > 0)
+	{
+		const HANDLE t_FileMapping = CreateFileMappingW(a_File, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (t_FileMapping != NULL)
+		{
+			t_Mapping.data = reinterpret_cast<char*>(MapViewOfFile(t_FileMapping, FILE_MAP_READ, 0, 0, 0));
+			CloseHandle(t_FileMapping);
+		}
+
+		if (t_Mapping.data != nullptr)
+			t_Mapping.size = static_cast<uint64_t>(t_FileSize.QuadPart);
+		else
+		{
+			LatestOSError();
+			BB_WARNING(false,
+				"OS, failed to map a file!",
+				WarningType::HIGH);
+		}
+	}
+
+	CloseHandle(a_File);
+	return t_Mapping;
+}
+
+Buffer BB::MapOSFile(const char* a_Path, const OS_FILE_ACCESS_HINT a_Hint)
+{
+	return MapOpenedFile(CreateFileA(a_Path,
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		NULL,
+		OPEN_EXISTING,
+		FileFlagsFromHint(a_Hint),
+		NULL));
+}
+
+Buffer BB::MapOSFile(const wchar* a_Path, const OS_FILE_ACCESS_HINT a_Hint)
+{
+	return MapOpenedFile(CreateFileW(a_Path,
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		NULL,
+		OPEN_EXISTING,
+		FileFlagsFromHint(a_Hint),
+		NULL));
+}
+
+void BB::UnmapOSFile(const Buffer& a_Mapping)
+{
+	if (a_Mapping.data != nullptr)
+		UnmapViewOfFile(a_Mapping.data);
+}
+
 //char replaced with string view later on.
 void BB::WriteToFile(const OSFileHandle a_FileHandle, const Buffer& a_Buffer)
 {
@@ -476,11 +623,13 @@ uint64_t BB::GetOSFileSize(const OSFileHandle a_FileHandle)
 	return GetFileSize(reinterpret_cast<HANDLE>(a_FileHandle.ptrHandle), NULL);
 }
 
-void BB::SetOSFilePosition(const OSFileHandle a_FileHandle, const uint32_t a_Offset, const OS_FILE_READ_POINT a_FileReadPoint)
+void BB::SetOSFilePosition(const OSFileHandle a_FileHandle, const int64_t a_Offset, const OS_FILE_READ_POINT a_FileReadPoint)
 {
-	DWORD t_Err = SetFilePointer(reinterpret_cast<HANDLE>(a_FileHandle.ptrHandle), a_Offset, NULL, static_cast<DWORD>(a_FileReadPoint));
+	LARGE_INTEGER t_Offset;
+	t_Offset.QuadPart = a_Offset;
+	BOOL t_Result = SetFilePointerEx(reinterpret_cast<HANDLE>(a_FileHandle.ptrHandle), t_Offset, NULL, static_cast<DWORD>(a_FileReadPoint));
 #ifdef _DEBUG
-	if (t_Err == INVALID_SET_FILE_POINTER && 
+	if (t_Result == FALSE &&
 		LatestOSError() == ERROR_NEGATIVE_SEEK)
 	{
 		BB_WARNING(false,
@@ -495,14 +644,44 @@ void BB::CloseOSFile(const OSFileHandle a_FileHandle)
 	CloseHandle(reinterpret_cast<HANDLE>(a_FileHandle.ptrHandle));
 }
 
-OSThreadHandle BB::OSCreateThread(void(*a_Func)(void*), const unsigned int a_StackSize, void* a_ArgList)
+//_beginthreadex wants a function that returns an unsigned, the start info is freed by the new thread.
+struct WinThreadStart
+{
+	void(*function)(void*);
+	void* parameter;
+};
+
+static unsigned __stdcall WinThreadEntry(void* a_Start)
+{
+	const WinThreadStart t_Start = *reinterpret_cast<WinThreadStart*>(a_Start);
+	delete reinterpret_cast<WinThreadStart*>(a_Start);
+	t_Start.function(t_Start.parameter);
+	return 0;
+}
+
+OSThreadHandle BB::OSCreateThread(void(*a_Func)(void*), const unsigned int a_StackSize, void* a_ArgList, const uint32_t a_CoreIndex)
 {
-	return OSThreadHandle(_beginthread(a_Func, a_StackSize, a_ArgList));
+	//Not _beginthread, that closes the handle when the thread ends so it cannot be waited on.
+	WinThreadStart* t_Start = new WinThreadStart{ a_Func, a_ArgList };
+	const uintptr_t t_Thread = _beginthreadex(nullptr, a_StackSize, WinThreadEntry, t_Start, CREATE_SUSPENDED, nullptr);
+	BB_ASSERT(t_Thread != 0, "OS, failed to create a thread!");
+
+	if (a_CoreIndex != OS_THREAD_ANY_CORE)
+	{
+		//The core does not exist or the process is not allowed on it.
+		const bool t_Pinned = a_CoreIndex < sizeof(DWORD_PTR) * 8 &&
+			SetThreadAffinityMask(reinterpret_cast<HANDLE>(t_Thread), static_cast<DWORD_PTR>(1) << a_CoreIndex) != 0;
+		BB_WARNING(t_Pinned, "OS, thread affinity is not possible for this core, the thread can run on any core.", WarningType::OPTIMALIZATION);
+	}
+
+	ResumeThread(reinterpret_cast<HANDLE>(t_Thread));
+	return OSThreadHandle(t_Thread);
 }
 
 void BB::OSWaitThreadfinish(const OSThreadHandle a_Thread)
 {
 	WaitForSingleObject((HANDLE)a_Thread.handle, INFINITE);
+	CloseHandle((HANDLE)a_Thread.handle);
 }
 
 BBMutex BB::OSCreateMutex()
@@ -525,6 +704,21 @@ void BB::DestroyMutex(const BBMutex a_Mutex)
 	CloseHandle((HANDLE)a_Mutex.handle);
 }
 
+void BB::OSWaitOnAddress(const volatile void* a_Address, const uint32_t a_Expected)
+{
+	WaitOnAddress(const_cast<volatile void*>(a_Address), const_cast<uint32_t*>(&a_Expected), sizeof(uint32_t), INFINITE);
+}
+
+void BB::OSWakeOneOnAddress(const volatile void* a_Address)
+{
+	WakeByAddressSingle(const_cast<void*>(a_Address));
+}
+
+void BB::OSWakeAllOnAddress(const volatile void* a_Address)
+{
+	WakeByAddressAll(const_cast<void*>(a_Address));
+}
+
 WindowHandle BB::CreateOSWindow(const OS_WINDOW_STYLE a_Style, const int a_X, const int a_Y, const int a_Width, const int a_Height, const wchar* a_WindowName)
 {
 	HWND t_Window;
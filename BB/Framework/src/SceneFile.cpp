@@ -0,0 +1,216 @@
+#include "SceneFile.hpp"
+#include "BBjson.hpp"
+#include "Utils.h"
+#include "OS/Program.h"
+
+using namespace BB;
+
+SceneFile::SceneFile(const char* a_Path)
+{
+	//Only the pages that get touched are read, the sections are used straight from the mapping.
+	m_Data = MapOSFile(a_Path, OS_FILE_ACCESS_HINT::SEQUENTIAL);
+	m_Mapped = true;
+	Validate();
+}
+
+SceneFile::SceneFile(const Buffer& a_Buffer)
+{
+	m_Data = a_Buffer;
+	Validate();
+}
+
+SceneFile::~SceneFile()
+{
+	if (m_Mapped)
+		UnmapOSFile(m_Data);
+}
+
+static bool SectionInFile(const SceneFileSection& a_Section, const size_t a_ElementSize, const uint64_t a_FileSize)
+{
+	return a_Section.offset % SCENE_FILE_SECTION_ALIGNMENT == 0 &&
+		a_Section.offset <= a_FileSize &&
+		static_cast<uint64_t>(a_Section.count) * a_ElementSize <= a_FileSize - a_Section.offset;
+}
+
+void SceneFile::Validate()
+{
+	m_Header = nullptr;
+	if (m_Data.data == nullptr || m_Data.size < sizeof(SceneFileHeader))
+	{
+		BB_WARNING(false, "Scene file is too small to be a scene file.", WarningType::HIGH);
+		return;
+	}
+	//The sections are used in place, so the file needs the same alignment as the sections.
+	if (reinterpret_cast<uintptr_t>(m_Data.data) % SCENE_FILE_SECTION_ALIGNMENT != 0)
+	{
+		BB_WARNING(false, "Scene file memory is not aligned to SCENE_FILE_SECTION_ALIGNMENT.", WarningType::HIGH);
+		return;
+	}
+
+	const SceneFileHeader* t_Header = reinterpret_cast<const SceneFileHeader*>(m_Data.data);
+	if (t_Header->magic != SCENE_FILE_MAGIC || t_Header->version != SCENE_FILE_VERSION || t_Header->fileSize > m_Data.size)
+	{
+		BB_WARNING(false, "Scene file has the wrong magic or version, convert the scene json again.", WarningType::HIGH);
+		return;
+	}
+
+	//The string table must end with a null terminator so that a string can never read past it.
+	const bool t_SectionsValid =
+		SectionInFile(t_Header->lights, sizeof(SceneFileLight), t_Header->fileSize) &&
+		SectionInFile(t_Header->transforms, sizeof(SceneFileTransform), t_Header->fileSize) &&
+		SectionInFile(t_Header->models, sizeof(SceneFileModel), t_Header->fileSize) &&
+		SectionInFile(t_Header->strings, sizeof(char), t_Header->fileSize) &&
+		t_Header->strings.count != 0 &&
+		m_Data.data[t_Header->strings.offset + t_Header->strings.count - 1] == '\0';
+	if (!t_SectionsValid)
+	{
+		BB_WARNING(false, "Scene file has a section outside of the file.", WarningType::HIGH);
+		return;
+	}
+
+	m_Header = t_Header;
+}
+
+const char* SceneFile::GetSceneName() const
+{
+	if (m_Header == nullptr)
+		return nullptr;
+	return GetString(m_Header->sceneName);
+}
+
+Slice<const SceneFileLight> SceneFile::GetLights() const
+{
+	if (m_Header == nullptr)
+		return Slice<const SceneFileLight>();
+	return Slice(reinterpret_cast<const SceneFileLight*>(m_Data.data + m_Header->lights.offset), m_Header->lights.count);
+}
+
+Slice<const SceneFileTransform> SceneFile::GetTransforms() const
+{
+	if (m_Header == nullptr)
+		return Slice<const SceneFileTransform>();
+	return Slice(reinterpret_cast<const SceneFileTransform*>(m_Data.data + m_Header->transforms.offset), m_Header->transforms.count);
+}
+
+Slice<const SceneFileModel> SceneFile::GetModels() const
+{
+	if (m_Header == nullptr)
+		return Slice<const SceneFileModel>();
+	return Slice(reinterpret_cast<const SceneFileModel*>(m_Data.data + m_Header->models.offset), m_Header->models.count);
+}
+
+const char* SceneFile::GetString(const uint32_t a_Offset) const
+{
+	if (m_Header == nullptr || a_Offset >= m_Header->strings.count)
+		return nullptr;
+	return m_Data.data + m_Header->strings.offset + a_Offset;
+}
+
+static void ReadJsonFloats(const JsonValue& a_List, float* a_Floats, const uint32_t a_Count)
+{
+	if (!a_List.IsValid())
+		return;
+
+	uint32_t t_Index = 0;
+	for (const JsonValue t_Element : a_List.GetList())
+		if (t_Index < a_Count)
+			a_Floats[t_Index++] = t_Element.GetNumber();
+	BB_WARNING(t_Index == a_Count, "Scene json has a vector with the wrong amount of elements.", WarningType::MEDIUM);
+}
+
+//Appends a null terminated copy, returns the offset in the string table.
+static uint32_t AddSceneString(char* a_StringTable, uint32_t& a_Used, const Slice<const char> a_String)
+{
+	const uint32_t t_Offset = a_Used;
+	if (a_String.size() != 0)
+		memcpy(a_StringTable + a_Used, a_String.data(), a_String.size());
+	a_Used += static_cast<uint32_t>(a_String.size());
+	a_StringTable[a_Used++] = '\0';
+	return t_Offset;
+}
+
+Buffer BB::ConvertJsonToSceneFile(Allocator a_Allocator, const Buffer& a_Json)
+{
+	JsonDocument t_Document(a_Json);
+	const JsonValue t_Root = t_Document.GetRoot();
+	JsonValue t_Scene;
+	if (t_Root.IsValid() && t_Root.GetType() == JSON_TYPE::OBJECT)
+		t_Scene = t_Root.Find("scene"_sid);
+	if (!t_Scene.IsValid() || t_Scene.GetType() != JSON_TYPE::OBJECT)
+	{
+		BB_WARNING(false, "Scene json has no scene object.", WarningType::HIGH);
+		return Buffer{};
+	}
+
+	const JsonValue t_Name = t_Scene.Find("scene_name"_sid);
+	const JsonValue t_Lights = t_Scene.Find("scene_lights"_sid);
+	const JsonValue t_Models = t_Scene.Find("scene_models"_sid);
+	const uint32_t t_LightCount = t_Lights.GetCount();
+	const uint32_t t_ModelCount = t_Models.GetCount();
+
+	//Size the string table first so the file is written with one allocation.
+	uint32_t t_StringTableSize = t_Name.IsValid() ? static_cast<uint32_t>(t_Name.GetString().size()) + 1 : 1;
+	for (const JsonValue t_Model : t_Models.GetList())
+	{
+		const JsonValue t_Path = t_Model.Find("path"_sid);
+		if (t_Path.IsValid())
+			t_StringTableSize += static_cast<uint32_t>(t_Path.GetString().size()) + 1;
+	}
+
+	SceneFileHeader t_Header{};
+	t_Header.magic = SCENE_FILE_MAGIC;
+	t_Header.version = SCENE_FILE_VERSION;
+	t_Header.lights.offset = static_cast<uint32_t>(Pointer::AlignPad(sizeof(SceneFileHeader), SCENE_FILE_SECTION_ALIGNMENT));
+	t_Header.lights.count = t_LightCount;
+	t_Header.transforms.offset = static_cast<uint32_t>(Pointer::AlignPad(t_Header.lights.offset + t_LightCount * sizeof(SceneFileLight), SCENE_FILE_SECTION_ALIGNMENT));
+	t_Header.transforms.count = t_ModelCount;
+	t_Header.models.offset = static_cast<uint32_t>(Pointer::AlignPad(t_Header.transforms.offset + t_ModelCount * sizeof(SceneFileTransform), SCENE_FILE_SECTION_ALIGNMENT));
+	t_Header.models.count = t_ModelCount;
+	t_Header.strings.offset = static_cast<uint32_t>(Pointer::AlignPad(t_Header.models.offset + t_ModelCount * sizeof(SceneFileModel), SCENE_FILE_SECTION_ALIGNMENT));
+	t_Header.strings.count = t_StringTableSize;
+	t_Header.fileSize = t_Header.strings.offset + t_StringTableSize;
+
+	Buffer t_File;
+	t_File.size = t_Header.fileSize;
+	t_File.data = reinterpret_cast<char*>(BBalloc_f(BB_MEMORY_DEBUG_ARGS a_Allocator, t_File.size, SCENE_FILE_SECTION_ALIGNMENT));
+	//Zero the padding between sections so the same json always gives the same file.
+	memset(t_File.data, 0, t_File.size);
+
+	char* t_StringTable = t_File.data + t_Header.strings.offset;
+	uint32_t t_StringsUsed = 0;
+	t_Header.sceneName = t_Name.IsValid() ? AddSceneString(t_StringTable, t_StringsUsed, t_Name.GetString()) : AddSceneString(t_StringTable, t_StringsUsed, Slice<const char>());
+
+	SceneFileLight* t_FileLights = reinterpret_cast<SceneFileLight*>(t_File.data + t_Header.lights.offset);
+	uint32_t t_LightIndex = 0;
+	for (const JsonValue t_Light : t_Lights.GetList())
+	{
+		SceneFileLight& t_FileLight = t_FileLights[t_LightIndex++];
+		const JsonValue t_Radius = t_Light.Find("radius"_sid);
+		if (t_Radius.IsValid())
+			t_FileLight.radius = t_Radius.GetNumber();
+		ReadJsonFloats(t_Light.Find("position"_sid), t_FileLight.pos.e, 3);
+		ReadJsonFloats(t_Light.Find("color"_sid), t_FileLight.color.e, 4);
+	}
+
+	//Every model gets its own transform, models can share them later when the json has a way to express that.
+	SceneFileTransform* t_FileTransforms = reinterpret_cast<SceneFileTransform*>(t_File.data + t_Header.transforms.offset);
+	SceneFileModel* t_FileModels = reinterpret_cast<SceneFileModel*>(t_File.data + t_Header.models.offset);
+	uint32_t t_ModelIndex = 0;
+	for (const JsonValue t_Model : t_Models.GetList())
+	{
+		SceneFileTransform& t_Transform = t_FileTransforms[t_ModelIndex];
+		t_Transform.rotation = float4{ 0.f, 0.f, 0.f, 1.f };
+		t_Transform.scale = float3{ 1.f, 1.f, 1.f };
+		ReadJsonFloats(t_Model.Find("position"_sid), t_Transform.position.e, 3);
+		ReadJsonFloats(t_Model.Find("rotation"_sid), t_Transform.rotation.e, 4);
+		ReadJsonFloats(t_Model.Find("scale"_sid), t_Transform.scale.e, 3);
+
+		const JsonValue t_Path = t_Model.Find("path"_sid);
+		t_FileModels[t_ModelIndex].path = t_Path.IsValid() ? AddSceneString(t_StringTable, t_StringsUsed, t_Path.GetString()) : SCENE_FILE_NO_STRING;
+		t_FileModels[t_ModelIndex].transform = t_ModelIndex;
+		++t_ModelIndex;
+	}
+
+	memcpy(t_File.data, &t_Header, sizeof(t_Header));
+	return t_File;
+}
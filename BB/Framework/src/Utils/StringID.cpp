@@ -0,0 +1,151 @@
+#include "StringID.h"
+#include "Utils/Logger.h"
+#include "BBMemory.h"
+
+#include <atomic>
+
+using namespace BB;
+
+//Open addressing with linear probing, slots are only ever added so a lookup never has to deal with removed slots.
+constexpr const uint32_t STRING_TABLE_SLOT_COUNT = 1 << 16;
+constexpr const uint32_t STRING_TABLE_SLOT_MASK = STRING_TABLE_SLOT_COUNT - 1;
+constexpr const size_t STRING_TABLE_STORAGE_SIZE = mbSize * 8;
+
+struct StringTableSlot
+{
+	//Claimed first with a compare exchange, the string is published after it has been copied.
+	std::atomic<uint32_t> id{ 0 };
+	std::atomic<uint32_t> length{ 0 };
+	std::atomic<const char*> string{ nullptr };
+};
+
+struct StringTable
+{
+	StringTable()
+	{
+		size_t t_StorageSize = STRING_TABLE_STORAGE_SIZE;
+		storage = reinterpret_cast<char*>(mallocVirtual(nullptr, t_StorageSize, VIRTUAL_RESERVE_NONE));
+		storageCapacity = t_StorageSize;
+	}
+
+	StringTableSlot slots[STRING_TABLE_SLOT_COUNT]{};
+	char* storage;
+	size_t storageCapacity;
+	std::atomic<size_t> storageUsed{ 0 };
+	std::atomic<uint32_t> stringCount{ 0 };
+	std::atomic<uint32_t> collisionCount{ 0 };
+};
+
+//Function static so strings can be interned during static initialization.
+static StringTable& GetStringTable()
+{
+	static StringTable s_StringTable{};
+	return s_StringTable;
+}
+
+//Another thread claimed the slot but might still be copying the string.
+static const char* WaitForString(const StringTableSlot& a_Slot)
+{
+	const char* t_String = a_Slot.string.load(std::memory_order_acquire);
+	while (t_String == nullptr)
+		t_String = a_Slot.string.load(std::memory_order_acquire);
+	return t_String;
+}
+
+StringID BB::InternString(const char* a_String)
+{
+	if (a_String == nullptr)
+		return StringID();
+	return InternString(a_String, strlen(a_String));
+}
+
+StringID BB::InternString(const char* a_String, const size_t a_Length)
+{
+	if (a_String == nullptr)
+		return StringID();
+
+	StringTable& t_Table = GetStringTable();
+	const StringID t_ID = MakeStringID(a_String, a_Length);
+	uint32_t t_Index = t_ID.id & STRING_TABLE_SLOT_MASK;
+	for (uint32_t t_Probe = 0; t_Probe < STRING_TABLE_SLOT_COUNT; t_Probe++)
+	{
+		StringTableSlot& t_Slot = t_Table.slots[t_Index];
+		uint32_t t_SlotID = t_Slot.id.load(std::memory_order_acquire);
+		if (t_SlotID == 0)
+		{
+			//Take the storage before claiming the slot, a claimed slot must always get a string or other threads wait on it forever.
+			//When another thread wins the slot these bytes are lost, that only happens when two threads intern a new string at the same time.
+			const size_t t_Offset = t_Table.storageUsed.fetch_add(a_Length + 1, std::memory_order_relaxed);
+			if (t_Offset + a_Length + 1 > t_Table.storageCapacity)
+			{
+				Logger::Log_Assert(__FILE__, __LINE__, "s", "String table is out of memory, increase STRING_TABLE_STORAGE_SIZE.");
+				assert(false);
+				return StringID();
+			}
+
+			if (t_Slot.id.compare_exchange_strong(t_SlotID, t_ID.id, std::memory_order_acq_rel))
+			{
+				char* t_String = t_Table.storage + t_Offset;
+				memcpy(t_String, a_String, a_Length);
+				t_String[a_Length] = '\0';
+
+				t_Slot.length.store(static_cast<uint32_t>(a_Length), std::memory_order_relaxed);
+				t_Slot.string.store(t_String, std::memory_order_release);
+				t_Table.stringCount.fetch_add(1, std::memory_order_relaxed);
+				return t_ID;
+			}
+		}
+
+		//When the compare exchange failed t_SlotID holds the id of the thread that won the slot.
+		if (t_SlotID == t_ID.id)
+		{
+			const char* t_String = WaitForString(t_Slot);
+			if (t_Slot.length.load(std::memory_order_relaxed) != a_Length || memcmp(t_String, a_String, a_Length) != 0)
+			{
+				//Returning the id would make both strings name the same thing, so this is logged in release too.
+				t_Table.collisionCount.fetch_add(1, std::memory_order_relaxed);
+				Logger::Log_Assert(__FILE__, __LINE__, "ss", "StringID collision, two different strings have the same id. Rename one of them. Interned string: ", t_String);
+				assert(false);
+				return StringID();
+			}
+			return t_ID;
+		}
+
+		t_Index = (t_Index + 1) & STRING_TABLE_SLOT_MASK;
+	}
+
+	Logger::Log_Assert(__FILE__, __LINE__, "s", "String table is full, increase STRING_TABLE_SLOT_COUNT.");
+	assert(false);
+	return StringID();
+}
+
+const char* BB::GetInternedString(const StringID a_ID)
+{
+	if (!a_ID.IsValid())
+		return nullptr;
+
+	const StringTable& t_Table = GetStringTable();
+	uint32_t t_Index = a_ID.id & STRING_TABLE_SLOT_MASK;
+	for (uint32_t t_Probe = 0; t_Probe < STRING_TABLE_SLOT_COUNT; t_Probe++)
+	{
+		const StringTableSlot& t_Slot = t_Table.slots[t_Index];
+		const uint32_t t_SlotID = t_Slot.id.load(std::memory_order_acquire);
+		if (t_SlotID == a_ID.id)
+			return WaitForString(t_Slot);
+		if (t_SlotID == 0)
+			return nullptr;
+
+		t_Index = (t_Index + 1) & STRING_TABLE_SLOT_MASK;
+	}
+	return nullptr;
+}
+
+uint32_t BB::GetInternedStringCount()
+{
+	return GetStringTable().stringCount.load(std::memory_order_relaxed);
+}
+
+uint32_t BB::GetStringIDCollisionCount()
+{
+	return GetStringTable().collisionCount.load(std::memory_order_relaxed);
+}
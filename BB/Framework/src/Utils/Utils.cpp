@@ -2,315 +2,757 @@
 #include "Math.inl"
 
 #include <immintrin.h>
-
-
-namespace BB
+#include <atomic>
+
+#ifdef _MSC_VER
+//MSVC allows every intrinsic in any function, the CPU check happens at runtime.
+#define BB_TARGET_AVX2
+#define BB_TARGET_AVX512
+#else
+#include <cpuid.h>
+#define BB_TARGET_AVX2 __attribute__((target("avx2")))
+#define BB_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#endif //_MSC_VER
+
+using namespace BB;
+
+typedef void (*MemCpyFunc)(void* __restrict, const void* __restrict, size_t);
+typedef void (*MemSetFunc)(void* __restrict, const int32_t, size_t);
+typedef bool (*MemCmpFunc)(const void* __restrict, const void* __restrict, size_t);
+
+#pragma region CPU detection
+static void CPUID(const uint32_t a_Leaf, const uint32_t a_SubLeaf, uint32_t a_Registers[4])
+{
+#ifdef _MSC_VER
+	__cpuidex(reinterpret_cast<int*>(a_Registers), static_cast<int>(a_Leaf), static_cast<int>(a_SubLeaf));
+#else
+	__cpuid_count(a_Leaf, a_SubLeaf, a_Registers[0], a_Registers[1], a_Registers[2], a_Registers[3]);
+#endif //_MSC_VER
+}
+
+//Which registers the OS saves on a context switch, a CPU with AVX is useless if the OS does not save the ymm registers.
+static uint64_t ReadXCR0()
+{
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	uint32_t t_Low, t_High;
+	__asm__ volatile("xgetbv" : "=a"(t_Low), "=d"(t_High) : "c"(0));
+	return (static_cast<uint64_t>(t_High) << 32) | t_Low;
+#endif //_MSC_VER
+}
+
+static Memory::SIMD_LEVEL DetectSIMDLevel()
+{
+	uint32_t t_Registers[4];
+	CPUID(0, 0, t_Registers);
+	const uint32_t t_MaxLeaf = t_Registers[0];
+	if (t_MaxLeaf < 7)
+		return Memory::SIMD_LEVEL::SSE2;
+
+	CPUID(1, 0, t_Registers);
+	constexpr uint32_t OSXSAVE_BIT = 1u << 27;
+	constexpr uint32_t AVX_BIT = 1u << 28;
+	if ((t_Registers[2] & (OSXSAVE_BIT | AVX_BIT)) != (OSXSAVE_BIT | AVX_BIT))
+		return Memory::SIMD_LEVEL::SSE2;
+
+	const uint64_t t_XCR0 = ReadXCR0();
+	constexpr uint64_t XMM_YMM_STATE = 0x6;
+	constexpr uint64_t ZMM_STATE = 0xE0;
+	if ((t_XCR0 & XMM_YMM_STATE) != XMM_YMM_STATE)
+		return Memory::SIMD_LEVEL::SSE2;
+
+	CPUID(7, 0, t_Registers);
+	constexpr uint32_t AVX2_BIT = 1u << 5;
+	constexpr uint32_t AVX512F_BIT = 1u << 16;
+	constexpr uint32_t AVX512BW_BIT = 1u << 30;
+	if ((t_Registers[1] & AVX2_BIT) == 0)
+		return Memory::SIMD_LEVEL::SSE2;
+
+	if ((t_Registers[1] & (AVX512F_BIT | AVX512BW_BIT)) == (AVX512F_BIT | AVX512BW_BIT) &&
+		(t_XCR0 & ZMM_STATE) == ZMM_STATE)
+		return Memory::SIMD_LEVEL::AVX512;
+
+	return Memory::SIMD_LEVEL::AVX2;
+}
+#pragma endregion
+
+#pragma region Small sizes
+//Everything below 16 bytes, two overlapping loads and stores cover any size without a loop.
+static inline void CopySmall(uint8_t* __restrict a_Destination, const uint8_t* __restrict a_Source, const size_t a_Size)
 {
-	void BB::Memory::MemCpy(void* __restrict  a_Destination, const void* __restrict  a_Source, size_t a_Size)
+	if (a_Size >= 8)
 	{
-		const size_t t_Diff = Pointer::AlignForwardAdjustment(a_Destination, sizeof(size_t));
-
-		uint8_t* __restrict t_AlignDest = reinterpret_cast<uint8_t*>(a_Destination);
-		const uint8_t* __restrict t_AlignSrc = reinterpret_cast<const uint8_t*>(a_Source);
-
-		for (size_t i = 0; i < t_Diff; i++)
-		{
-			*t_AlignDest++ = *t_AlignSrc++;
-		}
-
-		a_Size -= t_Diff;
-
-		//Get the registry size for most optimal memcpy.
-		size_t* __restrict  t_Dest = reinterpret_cast<size_t*>(t_AlignDest);
-		const size_t* __restrict  t_Src = reinterpret_cast<const size_t*>(t_AlignSrc);
+		uint64_t t_First, t_Last;
+		memcpy(&t_First, a_Source, 8);
+		memcpy(&t_Last, a_Source + a_Size - 8, 8);
+		memcpy(a_Destination, &t_First, 8);
+		memcpy(a_Destination + a_Size - 8, &t_Last, 8);
+	}
+	else if (a_Size >= 4)
+	{
+		uint32_t t_First, t_Last;
+		memcpy(&t_First, a_Source, 4);
+		memcpy(&t_Last, a_Source + a_Size - 4, 4);
+		memcpy(a_Destination, &t_First, 4);
+		memcpy(a_Destination + a_Size - 4, &t_Last, 4);
+	}
+	else if (a_Size >= 2)
+	{
+		uint16_t t_First, t_Last;
+		memcpy(&t_First, a_Source, 2);
+		memcpy(&t_Last, a_Source + a_Size - 2, 2);
+		memcpy(a_Destination, &t_First, 2);
+		memcpy(a_Destination + a_Size - 2, &t_Last, 2);
+	}
+	else if (a_Size == 1)
+	{
+		*a_Destination = *a_Source;
+	}
+}
 
-		while (a_Size >= sizeof(size_t))
-		{
-			*t_Dest++ = *t_Src++;
-			a_Size -= sizeof(size_t);
-		}
+static inline void SetSmall(uint8_t* __restrict a_Destination, const uint8_t a_Value, const size_t a_Size)
+{
+	const uint64_t t_Pattern = 0x0101010101010101ull * a_Value;
+	if (a_Size >= 8)
+	{
+		memcpy(a_Destination, &t_Pattern, 8);
+		memcpy(a_Destination + a_Size - 8, &t_Pattern, 8);
+	}
+	else if (a_Size >= 4)
+	{
+		memcpy(a_Destination, &t_Pattern, 4);
+		memcpy(a_Destination + a_Size - 4, &t_Pattern, 4);
+	}
+	else if (a_Size >= 2)
+	{
+		memcpy(a_Destination, &t_Pattern, 2);
+		memcpy(a_Destination + a_Size - 2, &t_Pattern, 2);
+	}
+	else if (a_Size == 1)
+	{
+		*a_Destination = a_Value;
+	}
+}
 
-		uint8_t* __restrict t_DestChar = reinterpret_cast<uint8_t*>(t_Dest);
-		const uint8_t* __restrict t_SrcChar = reinterpret_cast<const uint8_t*>(t_Src);
+static inline bool CmpSmall(const uint8_t* __restrict a_Left, const uint8_t* __restrict a_Right, const size_t a_Size)
+{
+	if (a_Size >= 8)
+	{
+		uint64_t t_Left[2], t_Right[2];
+		memcpy(&t_Left[0], a_Left, 8);
+		memcpy(&t_Left[1], a_Left + a_Size - 8, 8);
+		memcpy(&t_Right[0], a_Right, 8);
+		memcpy(&t_Right[1], a_Right + a_Size - 8, 8);
+		return ((t_Left[0] ^ t_Right[0]) | (t_Left[1] ^ t_Right[1])) == 0;
+	}
+	if (a_Size >= 4)
+	{
+		uint32_t t_Left[2], t_Right[2];
+		memcpy(&t_Left[0], a_Left, 4);
+		memcpy(&t_Left[1], a_Left + a_Size - 4, 4);
+		memcpy(&t_Right[0], a_Right, 4);
+		memcpy(&t_Right[1], a_Right + a_Size - 4, 4);
+		return ((t_Left[0] ^ t_Right[0]) | (t_Left[1] ^ t_Right[1])) == 0;
+	}
+	if (a_Size >= 2)
+	{
+		uint16_t t_Left[2], t_Right[2];
+		memcpy(&t_Left[0], a_Left, 2);
+		memcpy(&t_Left[1], a_Left + a_Size - 2, 2);
+		memcpy(&t_Right[0], a_Right, 2);
+		memcpy(&t_Right[1], a_Right + a_Size - 2, 2);
+		return ((t_Left[0] ^ t_Right[0]) | (t_Left[1] ^ t_Right[1])) == 0;
+	}
+	if (a_Size == 1)
+		return *a_Left == *a_Right;
+	return true;
+}
+#pragma endregion
+
+#pragma region SSE2
+template<bool Stream>
+static void MemCpySSE2(void* __restrict a_Destination, const void* __restrict a_Source, size_t a_Size)
+{
+	uint8_t* __restrict t_Dest = reinterpret_cast<uint8_t*>(a_Destination);
+	const uint8_t* __restrict t_Src = reinterpret_cast<const uint8_t*>(a_Source);
+	if (a_Size < 16)
+		return CopySmall(t_Dest, t_Src, a_Size);
+
+	const __m128i t_Head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Src));
+	const __m128i t_Tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Src + a_Size - 16));
+	if (a_Size <= 32)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(t_Dest), t_Head);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(t_Dest + a_Size - 16), t_Tail);
+		return;
+	}
 
-		//Again but then go by byte.
-		while (a_Size--)
+	if (a_Size <= 128)
+	{
+		//Load everything before storing, a load right after a store to the same page offset can stall on it.
+		const __m128i t_1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Src + 16));
+		const __m128i t_2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Src + a_Size - 32));
+		if (a_Size <= 64)
 		{
-			*t_DestChar++ = *t_SrcChar++;
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(t_Dest), t_Head);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(t_Dest + 16), t_1);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(t_Dest + a_Size - 32), t_2);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(t_Dest + a_Size - 16), t_Tail);
+			return;
 		}
+		const __m128i t_3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Src + 32));
+		const __m128i t_4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Src + 48));
+		const __m128i t_5 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Src + a_Size - 64));
+		const __m128i t_6 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Src + a_Size - 48));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(t_Dest), t_Head);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(t_Dest + 16), t_1);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(t_Dest + 32), t_3);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(t_Dest + 48), t_4);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(t_Dest + a_Size - 64), t_5);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(t_Dest + a_Size - 48), t_6);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(t_Dest + a_Size - 32), t_2);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(t_Dest + a_Size - 16), t_Tail);
+		return;
 	}
 
-	void BB::Memory::MemCpySIMD128(void* __restrict  a_Destination, const void* __restrict a_Source, size_t a_Size)
+	//The last 4 vectors are loaded before the loop and everything unaligned is stored after it, the loop only does aligned stores.
+	const __m128i t_Last0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Src + a_Size - 64));
+	const __m128i t_Last1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Src + a_Size - 48));
+	const __m128i t_Last2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Src + a_Size - 32));
+	uint8_t* const t_DestStart = t_Dest;
+	uint8_t* const t_DestEnd = t_Dest + a_Size;
+	const size_t t_Adjust = 16 - (reinterpret_cast<uintptr_t>(t_Dest) & 15);
+	t_Dest += t_Adjust;
+	t_Src += t_Adjust;
+
+	for (; t_Dest < t_DestEnd - 64; t_Dest += 64, t_Src += 64)
 	{
-		const size_t t_Diff = Pointer::AlignForwardAdjustment(a_Destination, sizeof(__m128i));
-
-		uint8_t* __restrict t_AlignDest = reinterpret_cast<uint8_t*>(a_Destination);
-		const uint8_t* __restrict t_AlignSrc = reinterpret_cast<const uint8_t*>(a_Source);
-
-		for (size_t i = 0; i < t_Diff; i++)
+		const __m128i t_0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Src));
+		const __m128i t_1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Src + 16));
+		const __m128i t_2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Src + 32));
+		const __m128i t_3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Src + 48));
+		if constexpr (Stream)
 		{
-			*t_AlignDest++ = *t_AlignSrc++;
+			_mm_stream_si128(reinterpret_cast<__m128i*>(t_Dest), t_0);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(t_Dest + 16), t_1);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(t_Dest + 32), t_2);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(t_Dest + 48), t_3);
 		}
-
-		a_Size -= t_Diff;
-
-		//Get the registry size for most optimal memcpy.
-		__m128i* __restrict  t_Dest = reinterpret_cast<__m128i*>(t_AlignDest);
-		const __m128i* __restrict  t_Src = reinterpret_cast<const __m128i*>(t_AlignSrc);
-
-		while(a_Size >= sizeof(__m128i))
+		else
 		{
-			*t_Dest++ = _mm_loadu_epi64(t_Src++);
-			a_Size -= sizeof(__m128i);
+			_mm_store_si128(reinterpret_cast<__m128i*>(t_Dest), t_0);
+			_mm_store_si128(reinterpret_cast<__m128i*>(t_Dest + 16), t_1);
+			_mm_store_si128(reinterpret_cast<__m128i*>(t_Dest + 32), t_2);
+			_mm_store_si128(reinterpret_cast<__m128i*>(t_Dest + 48), t_3);
 		}
+	}
+	if constexpr (Stream)
+		_mm_sfence();
 
-		uint8_t* __restrict t_DestChar = reinterpret_cast<uint8_t*>(t_Dest);
-		const uint8_t* __restrict t_SrcChar = reinterpret_cast<const uint8_t*>(t_Src);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(t_DestEnd - 64), t_Last0);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(t_DestEnd - 48), t_Last1);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(t_DestEnd - 32), t_Last2);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(t_DestEnd - 16), t_Tail);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(t_DestStart), t_Head);
+}
 
-		//Again but then go by byte.
-		while(a_Size--)
-		{
-			*t_DestChar++ = *t_SrcChar++;
-		}
+static void MemSetSSE2(void* __restrict a_Destination, const int32_t a_Value, size_t a_Size)
+{
+	uint8_t* __restrict t_Dest = reinterpret_cast<uint8_t*>(a_Destination);
+	if (a_Size < 16)
+		return SetSmall(t_Dest, static_cast<uint8_t>(a_Value), a_Size);
+
+	const __m128i t_Value = _mm_set1_epi8(static_cast<char>(a_Value));
+	uint8_t* t_DestEnd = t_Dest + a_Size;
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(t_Dest), t_Value);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(t_DestEnd - 16), t_Value);
+	if (a_Size <= 32)
+		return;
+
+	//The first store already covered the bytes up to the next aligned address.
+	t_Dest += 16 - (reinterpret_cast<uintptr_t>(t_Dest) & 15);
+	for (; t_Dest + 64 <= t_DestEnd; t_Dest += 64)
+	{
+		_mm_store_si128(reinterpret_cast<__m128i*>(t_Dest), t_Value);
+		_mm_store_si128(reinterpret_cast<__m128i*>(t_Dest + 16), t_Value);
+		_mm_store_si128(reinterpret_cast<__m128i*>(t_Dest + 32), t_Value);
+		_mm_store_si128(reinterpret_cast<__m128i*>(t_Dest + 48), t_Value);
 	}
+	for (; t_Dest + 16 <= t_DestEnd; t_Dest += 16)
+		_mm_store_si128(reinterpret_cast<__m128i*>(t_Dest), t_Value);
+}
 
-	void BB::Memory::MemCpySIMD256(void* __restrict  a_Destination, const void* __restrict  a_Source, size_t a_Size)
+static bool MemCmpSSE2(const void* __restrict a_Left, const void* __restrict a_Right, size_t a_Size)
+{
+	const uint8_t* __restrict t_Left = reinterpret_cast<const uint8_t*>(a_Left);
+	const uint8_t* __restrict t_Right = reinterpret_cast<const uint8_t*>(a_Right);
+	if (a_Size < 16)
+		return CmpSmall(t_Left, t_Right, a_Size);
+
+	const __m128i t_Zero = _mm_setzero_si128();
+	//Or all the differences together, any bit set means unequal.
+	for (; a_Size >= 64; a_Size -= 64, t_Left += 64, t_Right += 64)
 	{
-		const size_t t_Diff = Pointer::AlignForwardAdjustment(a_Destination, sizeof(__m256i));
-
-		uint8_t* __restrict t_AlignDest = reinterpret_cast<uint8_t*>(a_Destination);
-		const uint8_t* __restrict t_AlignSrc = reinterpret_cast<const uint8_t*>(a_Source);
-
-		for (size_t i = 0; i < t_Diff; i++)
-		{
-			*t_AlignDest++ = *t_AlignSrc++;
-		}
-
-		a_Size -= t_Diff;
-
-		//Get the registry size for most optimal memcpy.
-		__m256i* __restrict  t_Dest = reinterpret_cast<__m256i*>(t_AlignDest);
-		const __m256i* __restrict  t_Src = reinterpret_cast<const __m256i*>(t_AlignSrc);
+		__m128i t_Diff = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Left)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Right)));
+		t_Diff = _mm_or_si128(t_Diff, _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Left + 16)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Right + 16))));
+		t_Diff = _mm_or_si128(t_Diff, _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Left + 32)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Right + 32))));
+		t_Diff = _mm_or_si128(t_Diff, _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Left + 48)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Right + 48))));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(t_Diff, t_Zero)) != 0xFFFF)
+			return false;
+	}
+	for (; a_Size >= 16; a_Size -= 16, t_Left += 16, t_Right += 16)
+	{
+		const __m128i t_Equal = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Left)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Right)));
+		if (_mm_movemask_epi8(t_Equal) != 0xFFFF)
+			return false;
+	}
+	if (a_Size == 0)
+		return true;
 
-		while (a_Size >= sizeof(__m256i))
-		{
-			*t_Dest++ = _mm256_loadu_epi64(t_Src++);
-			a_Size -= sizeof(__m256i);
-		}
+	//Overlaps with bytes that were already compared.
+	const __m128i t_Equal = _mm_cmpeq_epi8(
+		_mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Left + a_Size - 16)),
+		_mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Right + a_Size - 16)));
+	return _mm_movemask_epi8(t_Equal) == 0xFFFF;
+}
+#pragma endregion
+
+#pragma region AVX2
+template<bool Stream>
+BB_TARGET_AVX2 static void MemCpyAVX2(void* __restrict a_Destination, const void* __restrict a_Source, size_t a_Size)
+{
+	uint8_t* __restrict t_Dest = reinterpret_cast<uint8_t*>(a_Destination);
+	const uint8_t* __restrict t_Src = reinterpret_cast<const uint8_t*>(a_Source);
+	if (a_Size < 16)
+		return CopySmall(t_Dest, t_Src, a_Size);
+	if (a_Size <= 32)
+	{
+		const __m128i t_Head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Src));
+		const __m128i t_Tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_Src + a_Size - 16));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(t_Dest), t_Head);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(t_Dest + a_Size - 16), t_Tail);
+		return;
+	}
 
-		uint8_t* __restrict t_DestChar = reinterpret_cast<uint8_t*>(t_Dest);
-		const uint8_t* __restrict t_SrcChar = reinterpret_cast<const uint8_t*>(t_Src);
+	const __m256i t_Head = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Src));
+	const __m256i t_Tail = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Src + a_Size - 32));
+	if (a_Size <= 64)
+	{
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(t_Dest), t_Head);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(t_Dest + a_Size - 32), t_Tail);
+		return;
+	}
 
-		//Again but then go by byte.
-		while (a_Size--)
+	if (a_Size <= 256)
+	{
+		//Load everything before storing, a load right after a store to the same page offset can stall on it.
+		const __m256i t_1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Src + 32));
+		const __m256i t_2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Src + a_Size - 64));
+		if (a_Size <= 128)
 		{
-			*t_DestChar++ = *t_SrcChar++;
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(t_Dest), t_Head);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(t_Dest + 32), t_1);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(t_Dest + a_Size - 64), t_2);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(t_Dest + a_Size - 32), t_Tail);
+			return;
 		}
+		const __m256i t_3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Src + 64));
+		const __m256i t_4 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Src + 96));
+		const __m256i t_5 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Src + a_Size - 128));
+		const __m256i t_6 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Src + a_Size - 96));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(t_Dest), t_Head);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(t_Dest + 32), t_1);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(t_Dest + 64), t_3);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(t_Dest + 96), t_4);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(t_Dest + a_Size - 128), t_5);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(t_Dest + a_Size - 96), t_6);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(t_Dest + a_Size - 64), t_2);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(t_Dest + a_Size - 32), t_Tail);
+		return;
 	}
 
-	void BB::Memory::MemSet(void* __restrict  a_Destination, const int32_t a_Value, size_t a_Size)
+	//The last 4 vectors are loaded before the loop and everything unaligned is stored after it, the loop only does aligned stores.
+	const __m256i t_Last0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Src + a_Size - 128));
+	const __m256i t_Last1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Src + a_Size - 96));
+	const __m256i t_Last2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Src + a_Size - 64));
+	uint8_t* const t_DestStart = t_Dest;
+	uint8_t* const t_DestEnd = t_Dest + a_Size;
+	const size_t t_Adjust = 32 - (reinterpret_cast<uintptr_t>(t_Dest) & 31);
+	t_Dest += t_Adjust;
+	t_Src += t_Adjust;
+
+	for (; t_Dest < t_DestEnd - 128; t_Dest += 128, t_Src += 128)
 	{
-		//Get the registry size for most optimal memcpy.
-		size_t* __restrict  t_Dest = reinterpret_cast<size_t*>(a_Destination);
-
-		while (a_Size >= sizeof(size_t))
+		const __m256i t_0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Src));
+		const __m256i t_1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Src + 32));
+		const __m256i t_2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Src + 64));
+		const __m256i t_3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Src + 96));
+		if constexpr (Stream)
 		{
-			*t_Dest++ = a_Value;
-			a_Size -= sizeof(size_t);
+			_mm256_stream_si256(reinterpret_cast<__m256i*>(t_Dest), t_0);
+			_mm256_stream_si256(reinterpret_cast<__m256i*>(t_Dest + 32), t_1);
+			_mm256_stream_si256(reinterpret_cast<__m256i*>(t_Dest + 64), t_2);
+			_mm256_stream_si256(reinterpret_cast<__m256i*>(t_Dest + 96), t_3);
 		}
-
-		uint8_t* __restrict t_DestChar = reinterpret_cast<uint8_t*>(t_Dest);
-
-		//Again but then go by byte.
-		for (size_t i = 0; i < a_Size; i++)
+		else
 		{
-			*t_DestChar++ = reinterpret_cast<uint8_t*>(static_cast<uint8_t>(a_Value))[i];
+			_mm256_store_si256(reinterpret_cast<__m256i*>(t_Dest), t_0);
+			_mm256_store_si256(reinterpret_cast<__m256i*>(t_Dest + 32), t_1);
+			_mm256_store_si256(reinterpret_cast<__m256i*>(t_Dest + 64), t_2);
+			_mm256_store_si256(reinterpret_cast<__m256i*>(t_Dest + 96), t_3);
 		}
 	}
+	if constexpr (Stream)
+		_mm_sfence();
 
-	void BB::Memory::MemSetSIMD128(void* __restrict  a_Destination, const int32_t a_Value, size_t a_Size)
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(t_DestEnd - 128), t_Last0);
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(t_DestEnd - 96), t_Last1);
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(t_DestEnd - 64), t_Last2);
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(t_DestEnd - 32), t_Tail);
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(t_DestStart), t_Head);
+}
+
+BB_TARGET_AVX2 static void MemSetAVX2(void* __restrict a_Destination, const int32_t a_Value, size_t a_Size)
+{
+	uint8_t* __restrict t_Dest = reinterpret_cast<uint8_t*>(a_Destination);
+	if (a_Size < 32)
+		return MemSetSSE2(a_Destination, a_Value, a_Size);
+
+	const __m256i t_Value = _mm256_set1_epi8(static_cast<char>(a_Value));
+	uint8_t* t_DestEnd = t_Dest + a_Size;
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(t_Dest), t_Value);
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(t_DestEnd - 32), t_Value);
+	if (a_Size <= 64)
+		return;
+
+	//The first store already covered the bytes up to the next aligned address.
+	t_Dest += 32 - (reinterpret_cast<uintptr_t>(t_Dest) & 31);
+	for (; t_Dest + 128 <= t_DestEnd; t_Dest += 128)
 	{
-		//Get the registry size for most optimal memcpy.
-		__m128i* __restrict  t_Dest = reinterpret_cast<__m128i*>(a_Destination);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(t_Dest), t_Value);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(t_Dest + 32), t_Value);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(t_Dest + 64), t_Value);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(t_Dest + 96), t_Value);
+	}
+	for (; t_Dest + 32 <= t_DestEnd; t_Dest += 32)
+		_mm256_store_si256(reinterpret_cast<__m256i*>(t_Dest), t_Value);
+}
 
-		while (a_Size >= sizeof(__m128i))
-		{
-			*t_Dest++ = _mm_set1_epi32(a_Value);
-			a_Size -= sizeof(__m128i);
-		}
+BB_TARGET_AVX2 static bool MemCmpAVX2(const void* __restrict a_Left, const void* __restrict a_Right, size_t a_Size)
+{
+	const uint8_t* __restrict t_Left = reinterpret_cast<const uint8_t*>(a_Left);
+	const uint8_t* __restrict t_Right = reinterpret_cast<const uint8_t*>(a_Right);
+	if (a_Size < 32)
+		return MemCmpSSE2(a_Left, a_Right, a_Size);
 
-		size_t* __restrict  t_intDest = reinterpret_cast<size_t*>(t_Dest);
+	for (; a_Size >= 128; a_Size -= 128, t_Left += 128, t_Right += 128)
+	{
+		__m256i t_Diff = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Left)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Right)));
+		t_Diff = _mm256_or_si256(t_Diff, _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Left + 32)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Right + 32))));
+		t_Diff = _mm256_or_si256(t_Diff, _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Left + 64)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Right + 64))));
+		t_Diff = _mm256_or_si256(t_Diff, _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Left + 96)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Right + 96))));
+		if (!_mm256_testz_si256(t_Diff, t_Diff))
+			return false;
+	}
+	for (; a_Size >= 32; a_Size -= 32, t_Left += 32, t_Right += 32)
+	{
+		const __m256i t_Diff = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Left)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Right)));
+		if (!_mm256_testz_si256(t_Diff, t_Diff))
+			return false;
+	}
+	if (a_Size == 0)
+		return true;
 
-		while (a_Size >= sizeof(size_t))
-		{
-			*t_intDest++ = a_Value;
-			a_Size -= sizeof(size_t);
-		}
+	const __m256i t_Diff = _mm256_xor_si256(
+		_mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Left + a_Size - 32)),
+		_mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_Right + a_Size - 32)));
+	return _mm256_testz_si256(t_Diff, t_Diff);
+}
+#pragma endregion
 
-		uint8_t* __restrict t_DestChar = reinterpret_cast<uint8_t*>(t_intDest);
+#pragma region AVX512
+//Loads and stores of less then 64 bytes are masked, so there is no small size path at all.
+BB_TARGET_AVX512 static inline __mmask64 TailMask(const size_t a_Size)
+{
+	return a_Size >= 64 ? ~0ull : (1ull << a_Size) - 1;
+}
 
-		//Again but then go by byte.
-		for (size_t i = 0; i < a_Size; i++)
-		{
-			*t_DestChar++ = reinterpret_cast<uint8_t*>(static_cast<uint8_t>(a_Value))[i];
-		}
+template<bool Stream>
+BB_TARGET_AVX512 static void MemCpyAVX512(void* __restrict a_Destination, const void* __restrict a_Source, size_t a_Size)
+{
+	uint8_t* __restrict t_Dest = reinterpret_cast<uint8_t*>(a_Destination);
+	const uint8_t* __restrict t_Src = reinterpret_cast<const uint8_t*>(a_Source);
+	if (a_Size <= 64)
+	{
+		const __mmask64 t_Mask = TailMask(a_Size);
+		_mm512_mask_storeu_epi8(t_Dest, t_Mask, _mm512_maskz_loadu_epi8(t_Mask, t_Src));
+		return;
 	}
 
-	void BB::Memory::MemSetSIMD256(void* __restrict  a_Destination, const int32_t a_Value, size_t a_Size)
+	const __m512i t_Head = _mm512_loadu_si512(t_Src);
+	const __m512i t_Tail = _mm512_loadu_si512(t_Src + a_Size - 64);
+	if (a_Size <= 128)
 	{
-		//Get the registry size for most optimal memcpy.
-		__m256i* __restrict  t_Dest = reinterpret_cast<__m256i*>(a_Destination);
+		_mm512_storeu_si512(t_Dest, t_Head);
+		_mm512_storeu_si512(t_Dest + a_Size - 64, t_Tail);
+		return;
+	}
 
-		while (a_Size > sizeof(__m256i))
+	if (a_Size <= 512)
+	{
+		//Load everything before storing, a load right after a store to the same page offset can stall on it.
+		const __m512i t_1 = _mm512_loadu_si512(t_Src + 64);
+		const __m512i t_2 = _mm512_loadu_si512(t_Src + a_Size - 128);
+		if (a_Size <= 256)
 		{
-			*t_Dest++ = _mm256_set1_epi32(a_Value);
-			a_Size -= sizeof(__m256i);
+			_mm512_storeu_si512(t_Dest, t_Head);
+			_mm512_storeu_si512(t_Dest + 64, t_1);
+			_mm512_storeu_si512(t_Dest + a_Size - 128, t_2);
+			_mm512_storeu_si512(t_Dest + a_Size - 64, t_Tail);
+			return;
 		}
-		
-		size_t* __restrict  t_intDest = reinterpret_cast<size_t*>(t_Dest);
+		const __m512i t_3 = _mm512_loadu_si512(t_Src + 128);
+		const __m512i t_4 = _mm512_loadu_si512(t_Src + 192);
+		const __m512i t_5 = _mm512_loadu_si512(t_Src + a_Size - 256);
+		const __m512i t_6 = _mm512_loadu_si512(t_Src + a_Size - 192);
+		_mm512_storeu_si512(t_Dest, t_Head);
+		_mm512_storeu_si512(t_Dest + 64, t_1);
+		_mm512_storeu_si512(t_Dest + 128, t_3);
+		_mm512_storeu_si512(t_Dest + 192, t_4);
+		_mm512_storeu_si512(t_Dest + a_Size - 256, t_5);
+		_mm512_storeu_si512(t_Dest + a_Size - 192, t_6);
+		_mm512_storeu_si512(t_Dest + a_Size - 128, t_2);
+		_mm512_storeu_si512(t_Dest + a_Size - 64, t_Tail);
+		return;
+	}
 
-		while (a_Size >= sizeof(size_t))
+	//The last 4 vectors are loaded before the loop and everything unaligned is stored after it, the loop only does aligned stores.
+	const __m512i t_Last0 = _mm512_loadu_si512(t_Src + a_Size - 256);
+	const __m512i t_Last1 = _mm512_loadu_si512(t_Src + a_Size - 192);
+	const __m512i t_Last2 = _mm512_loadu_si512(t_Src + a_Size - 128);
+	uint8_t* const t_DestStart = t_Dest;
+	uint8_t* const t_DestEnd = t_Dest + a_Size;
+	const size_t t_Adjust = 64 - (reinterpret_cast<uintptr_t>(t_Dest) & 63);
+	t_Dest += t_Adjust;
+	t_Src += t_Adjust;
+
+	for (; t_Dest < t_DestEnd - 256; t_Dest += 256, t_Src += 256)
+	{
+		const __m512i t_0 = _mm512_loadu_si512(t_Src);
+		const __m512i t_1 = _mm512_loadu_si512(t_Src + 64);
+		const __m512i t_2 = _mm512_loadu_si512(t_Src + 128);
+		const __m512i t_3 = _mm512_loadu_si512(t_Src + 192);
+		if constexpr (Stream)
 		{
-			*t_intDest++ = a_Value;
-			a_Size -= sizeof(size_t);
+			_mm512_stream_si512(reinterpret_cast<__m512i*>(t_Dest), t_0);
+			_mm512_stream_si512(reinterpret_cast<__m512i*>(t_Dest + 64), t_1);
+			_mm512_stream_si512(reinterpret_cast<__m512i*>(t_Dest + 128), t_2);
+			_mm512_stream_si512(reinterpret_cast<__m512i*>(t_Dest + 192), t_3);
 		}
-
-		uint8_t* __restrict t_DestChar = reinterpret_cast<uint8_t*>(t_intDest);
-
-		//Again but then go by byte.
-		for (size_t i = 0; i < a_Size; i++)
+		else
 		{
-			*t_DestChar++ = reinterpret_cast<uint8_t*>(static_cast<uint8_t>(a_Value))[i];
+			_mm512_store_si512(t_Dest, t_0);
+			_mm512_store_si512(t_Dest + 64, t_1);
+			_mm512_store_si512(t_Dest + 128, t_2);
+			_mm512_store_si512(t_Dest + 192, t_3);
 		}
 	}
+	if constexpr (Stream)
+		_mm_sfence();
 
-	bool BB::Memory::MemCmp(const void* __restrict  a_Left, const void* __restrict  a_Right, size_t a_Size)
-	{
-		const size_t t_Diff = Max(
-			Pointer::AlignForwardAdjustment(a_Left, sizeof(size_t)),
-			Pointer::AlignForwardAdjustment(a_Right, sizeof(size_t)));
-
-		const uint8_t* __restrict t_AlignLeft = reinterpret_cast<const uint8_t*>(a_Left);
-		const uint8_t* __restrict t_AlignRight = reinterpret_cast<const uint8_t*>(a_Right);
+	_mm512_storeu_si512(t_DestEnd - 256, t_Last0);
+	_mm512_storeu_si512(t_DestEnd - 192, t_Last1);
+	_mm512_storeu_si512(t_DestEnd - 128, t_Last2);
+	_mm512_storeu_si512(t_DestEnd - 64, t_Tail);
+	_mm512_storeu_si512(t_DestStart, t_Head);
+}
 
-		for (size_t i = 0; i < t_Diff; i++)
-		{
-			if (t_AlignLeft++ != t_AlignRight++)
-				return false;
-		}
-
-		a_Size -= t_Diff;
-
-		//Get the registry size for most optimal memcpy.
-		const size_t* __restrict  t_Left = reinterpret_cast<const size_t*>(t_AlignLeft);
-		const size_t* __restrict  t_Right = reinterpret_cast<const size_t*>(t_AlignRight);
+BB_TARGET_AVX512 static void MemSetAVX512(void* __restrict a_Destination, const int32_t a_Value, size_t a_Size)
+{
+	uint8_t* __restrict t_Dest = reinterpret_cast<uint8_t*>(a_Destination);
+	const __m512i t_Value = _mm512_set1_epi8(static_cast<char>(a_Value));
+	if (a_Size <= 64)
+	{
+		_mm512_mask_storeu_epi8(t_Dest, TailMask(a_Size), t_Value);
+		return;
+	}
 
-		while (a_Size > sizeof(size_t))
-		{
-			if (t_Left++ != t_Right++)
-				return false;
-			a_Size -= sizeof(size_t);
-		}
+	uint8_t* t_DestEnd = t_Dest + a_Size;
+	_mm512_storeu_si512(t_Dest, t_Value);
+	_mm512_storeu_si512(t_DestEnd - 64, t_Value);
+	if (a_Size <= 128)
+		return;
 
-		const uint8_t* __restrict  t_CharLeft = reinterpret_cast<const uint8_t*>(t_Right);
-		const uint8_t* __restrict  t_CharRight = reinterpret_cast<const uint8_t*>(t_Left);
+	//The first store already covered the bytes up to the next aligned address.
+	t_Dest += 64 - (reinterpret_cast<uintptr_t>(t_Dest) & 63);
+	for (; t_Dest + 256 <= t_DestEnd; t_Dest += 256)
+	{
+		_mm512_store_si512(t_Dest, t_Value);
+		_mm512_store_si512(t_Dest + 64, t_Value);
+		_mm512_store_si512(t_Dest + 128, t_Value);
+		_mm512_store_si512(t_Dest + 192, t_Value);
+	}
+	for (; t_Dest + 64 <= t_DestEnd; t_Dest += 64)
+		_mm512_store_si512(t_Dest, t_Value);
+}
 
-		while (a_Size--)
-		{
-			if (t_CharLeft++ != t_CharRight++)
-				return false;
-		}
+BB_TARGET_AVX512 static bool MemCmpAVX512(const void* __restrict a_Left, const void* __restrict a_Right, size_t a_Size)
+{
+	const uint8_t* __restrict t_Left = reinterpret_cast<const uint8_t*>(a_Left);
+	const uint8_t* __restrict t_Right = reinterpret_cast<const uint8_t*>(a_Right);
 
-		return true;
+	for (; a_Size >= 256; a_Size -= 256, t_Left += 256, t_Right += 256)
+	{
+		__m512i t_Diff = _mm512_xor_si512(_mm512_loadu_si512(t_Left), _mm512_loadu_si512(t_Right));
+		t_Diff = _mm512_or_si512(t_Diff, _mm512_xor_si512(_mm512_loadu_si512(t_Left + 64), _mm512_loadu_si512(t_Right + 64)));
+		t_Diff = _mm512_or_si512(t_Diff, _mm512_xor_si512(_mm512_loadu_si512(t_Left + 128), _mm512_loadu_si512(t_Right + 128)));
+		t_Diff = _mm512_or_si512(t_Diff, _mm512_xor_si512(_mm512_loadu_si512(t_Left + 192), _mm512_loadu_si512(t_Right + 192)));
+		if (_mm512_test_epi64_mask(t_Diff, t_Diff) != 0)
+			return false;
 	}
-
-	bool BB::Memory::MemCmpSIMD128(const void* __restrict  a_Left, const void* __restrict  a_Right, size_t a_Size)
+	for (; a_Size >= 64; a_Size -= 64, t_Left += 64, t_Right += 64)
 	{
-		const size_t t_Diff = Max(
-			Pointer::AlignForwardAdjustment(a_Left, sizeof(__m128i)),
-			Pointer::AlignForwardAdjustment(a_Right, sizeof(__m128i)));
+		if (_mm512_cmpneq_epi8_mask(_mm512_loadu_si512(t_Left), _mm512_loadu_si512(t_Right)) != 0)
+			return false;
+	}
+	const __mmask64 t_Mask = TailMask(a_Size);
+	return _mm512_mask_cmpneq_epi8_mask(t_Mask, _mm512_maskz_loadu_epi8(t_Mask, t_Left), _mm512_maskz_loadu_epi8(t_Mask, t_Right)) == 0;
+}
+#pragma endregion
+
+#pragma region Dispatch
+//Every pointer starts at a function that picks the kernels for this CPU, after that it's a single indirect call.
+static void MemCpyResolve(void* __restrict a_Destination, const void* __restrict a_Source, size_t a_Size);
+static void MemCpyStreamResolve(void* __restrict a_Destination, const void* __restrict a_Source, size_t a_Size);
+static void MemSetResolve(void* __restrict a_Destination, const int32_t a_Value, size_t a_Size);
+static bool MemCmpResolve(const void* __restrict a_Left, const void* __restrict a_Right, size_t a_Size);
+
+static std::atomic<MemCpyFunc> s_MemCpy{ MemCpyResolve };
+static std::atomic<MemCpyFunc> s_MemCpyStream{ MemCpyStreamResolve };
+static std::atomic<MemSetFunc> s_MemSet{ MemSetResolve };
+static std::atomic<MemCmpFunc> s_MemCmp{ MemCmpResolve };
+
+static void SelectMemoryKernels()
+{
+	//Multiple threads can get here at the same time, they all write the same pointers.
+	switch (Memory::GetSIMDLevel())
+	{
+	case Memory::SIMD_LEVEL::AVX512:
+		s_MemCpy.store(MemCpyAVX512<false>, std::memory_order_relaxed);
+		s_MemCpyStream.store(MemCpyAVX512<true>, std::memory_order_relaxed);
+		s_MemSet.store(MemSetAVX512, std::memory_order_relaxed);
+		s_MemCmp.store(MemCmpAVX512, std::memory_order_relaxed);
+		break;
+	case Memory::SIMD_LEVEL::AVX2:
+		s_MemCpy.store(MemCpyAVX2<false>, std::memory_order_relaxed);
+		s_MemCpyStream.store(MemCpyAVX2<true>, std::memory_order_relaxed);
+		s_MemSet.store(MemSetAVX2, std::memory_order_relaxed);
+		s_MemCmp.store(MemCmpAVX2, std::memory_order_relaxed);
+		break;
+	default:
+		s_MemCpy.store(MemCpySSE2<false>, std::memory_order_relaxed);
+		s_MemCpyStream.store(MemCpySSE2<true>, std::memory_order_relaxed);
+		s_MemSet.store(MemSetSSE2, std::memory_order_relaxed);
+		s_MemCmp.store(MemCmpSSE2, std::memory_order_relaxed);
+		break;
+	}
+}
 
-		const uint8_t* __restrict t_AlignLeft = reinterpret_cast<const uint8_t*>(a_Left);
-		const uint8_t* __restrict t_AlignRight = reinterpret_cast<const uint8_t*>(a_Right);
+static void MemCpyResolve(void* __restrict a_Destination, const void* __restrict a_Source, size_t a_Size)
+{
+	SelectMemoryKernels();
+	s_MemCpy.load(std::memory_order_relaxed)(a_Destination, a_Source, a_Size);
+}
 
-		for (size_t i = 0; i < t_Diff; i++)
-		{
-			if (t_AlignLeft++ != t_AlignRight++)
-				return false;
-		}
+static void MemCpyStreamResolve(void* __restrict a_Destination, const void* __restrict a_Source, size_t a_Size)
+{
+	SelectMemoryKernels();
+	s_MemCpyStream.load(std::memory_order_relaxed)(a_Destination, a_Source, a_Size);
+}
 
-		a_Size -= t_Diff;
+static void MemSetResolve(void* __restrict a_Destination, const int32_t a_Value, size_t a_Size)
+{
+	SelectMemoryKernels();
+	s_MemSet.load(std::memory_order_relaxed)(a_Destination, a_Value, a_Size);
+}
 
-		//Get the registry size for most optimal memcpy.
-		const __m128i* __restrict  t_Left = reinterpret_cast<const __m128i*>(t_AlignLeft);
-		const __m128i* __restrict  t_Right = reinterpret_cast<const __m128i*>(t_AlignRight);
+static bool MemCmpResolve(const void* __restrict a_Left, const void* __restrict a_Right, size_t a_Size)
+{
+	SelectMemoryKernels();
+	return s_MemCmp.load(std::memory_order_relaxed)(a_Left, a_Right, a_Size);
+}
+#pragma endregion
 
-		const uint64_t t_CmpMode = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_EACH | _SIDD_NEGATIVE_POLARITY | _SIDD_LEAST_SIGNIFICANT;
+Memory::SIMD_LEVEL BB::Memory::GetSIMDLevel()
+{
+	static const SIMD_LEVEL s_Level = DetectSIMDLevel();
+	return s_Level;
+}
 
-		while (a_Size >= sizeof(__m128i))
-		{
-			__m128i loadLeft = _mm_loadu_si128(t_Left++);
-			__m128i loadRight = _mm_loadu_si128(t_Right++);
-			if (_mm_cmpestrc(loadLeft, static_cast<int>(a_Size), loadRight, static_cast<int>(a_Size), static_cast<int>(t_CmpMode)))
-			{
-				return false;
-			}
-			a_Size -= sizeof(__m128i);
-		}
+void BB::Memory::MemCpy(void* __restrict a_Destination, const void* __restrict a_Source, size_t a_Size)
+{
+	if (a_Size >= MEMCPY_STREAM_THRESHOLD)
+		return s_MemCpyStream.load(std::memory_order_relaxed)(a_Destination, a_Source, a_Size);
+	s_MemCpy.load(std::memory_order_relaxed)(a_Destination, a_Source, a_Size);
+}
 
-		const uint8_t* __restrict  t_CharLeft = reinterpret_cast<const uint8_t*>(t_Right);
-		const uint8_t* __restrict  t_CharRight = reinterpret_cast<const uint8_t*>(t_Left);
+void BB::Memory::MemCpyStream(void* __restrict a_Destination, const void* __restrict a_Source, size_t a_Size)
+{
+	s_MemCpyStream.load(std::memory_order_relaxed)(a_Destination, a_Source, a_Size);
+}
 
-		while (a_Size--)
-		{
-			if (t_CharLeft++ != t_CharRight++)
-				return false;
-		}
+void BB::Memory::MemSet(void* __restrict a_Destination, const int32_t a_Value, size_t a_Size)
+{
+	s_MemSet.load(std::memory_order_relaxed)(a_Destination, a_Value, a_Size);
+}
 
-		return true;
-	}
+bool BB::Memory::MemCmp(const void* __restrict a_Left, const void* __restrict a_Right, size_t a_Size)
+{
+	return s_MemCmp.load(std::memory_order_relaxed)(a_Left, a_Right, a_Size);
+}
 
-	bool BB::Memory::MemCmpSIMD256(const void* __restrict a_Left, const void* __restrict a_Right, size_t a_Size)
-	{
-		const size_t t_Diff = Max(
-			Pointer::AlignForwardAdjustment(a_Left, sizeof(__m256i)),
-			Pointer::AlignForwardAdjustment(a_Right, sizeof(__m256i)));
+void BB::Memory::MemCpySIMD128(void* __restrict a_Destination, const void* __restrict a_Source, size_t a_Size)
+{
+	MemCpySSE2<false>(a_Destination, a_Source, a_Size);
+}
 
-		const uint8_t* __restrict t_AlignLeft = reinterpret_cast<const uint8_t*>(a_Left);
-		const uint8_t* __restrict t_AlignRight = reinterpret_cast<const uint8_t*>(a_Right);
+void BB::Memory::MemCpySIMD256(void* __restrict a_Destination, const void* __restrict a_Source, size_t a_Size)
+{
+	MemCpyAVX2<false>(a_Destination, a_Source, a_Size);
+}
 
-		for (size_t i = 0; i < t_Diff; i++)
-		{
-			if (t_AlignLeft++ != t_AlignRight++)
-				return false;
-		}
+void BB::Memory::MemCpySIMD512(void* __restrict a_Destination, const void* __restrict a_Source, size_t a_Size)
+{
+	MemCpyAVX512<false>(a_Destination, a_Source, a_Size);
+}
 
-		a_Size -= t_Diff;
+void BB::Memory::MemSetSIMD128(void* __restrict a_Destination, const int32_t a_Value, size_t a_Size)
+{
+	MemSetSSE2(a_Destination, a_Value, a_Size);
+}
 
-		const __m256i* __restrict t_Left = reinterpret_cast<const __m256i*>(t_AlignLeft);
-		const __m256i* __restrict t_Right = reinterpret_cast<const __m256i*>(t_AlignRight);
-		
-		for (/**/; a_Size >= sizeof(__m256i); t_Left++, t_Right++)
-		{
-			const __m256i loadLeft = _mm256_loadu_si256(t_Left);
-			const __m256i loadRight = _mm256_loadu_si256(t_Right);
-			const __m256i result = _mm256_cmpeq_epi64(loadLeft, loadRight);
-			if (!(unsigned int)_mm256_testc_si256(result, _mm256_set1_epi64x(0xFFFFFFFFFFFFFFFF)))
-			{
-				return false;
-			}
-			a_Size -= sizeof(__m256i);
-		}
+void BB::Memory::MemSetSIMD256(void* __restrict a_Destination, const int32_t a_Value, size_t a_Size)
+{
+	MemSetAVX2(a_Destination, a_Value, a_Size);
+}
 
-		const uint8_t* __restrict  t_CharLeft = reinterpret_cast<const uint8_t*>(t_Right);
-		const uint8_t* __restrict  t_CharRight = reinterpret_cast<const uint8_t*>(t_Left);
+void BB::Memory::MemSetSIMD512(void* __restrict a_Destination, const int32_t a_Value, size_t a_Size)
+{
+	MemSetAVX512(a_Destination, a_Value, a_Size);
+}
 
-		while (a_Size--)
-		{
-			if (t_CharLeft++ != t_CharRight++)
-				return false;
-		}
+bool BB::Memory::MemCmpSIMD128(const void* __restrict a_Left, const void* __restrict a_Right, size_t a_Size)
+{
+	return MemCmpSSE2(a_Left, a_Right, a_Size);
+}
 
-		return true;
-	}
-}
\ No newline at end of file
+bool BB::Memory::MemCmpSIMD256(const void* __restrict a_Left, const void* __restrict a_Right, size_t a_Size)
+{
+	return MemCmpAVX2(a_Left, a_Right, a_Size);
+}
+
+bool BB::Memory::MemCmpSIMD512(const void* __restrict a_Left, const void* __restrict a_Right, size_t a_Size)
+{
+	return MemCmpAVX512(a_Left, a_Right, a_Size);
+}
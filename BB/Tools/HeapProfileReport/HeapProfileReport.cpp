@@ -0,0 +1,207 @@
+//Reads a heap profile written by HeapProfiler::DumpToFile and prints reports from it.
+//HeapProfileReport <profile> prints the allocator, tag, call site and frame reports.
+//HeapProfileReport <profile> --folded prints "allocator;file;file:line bytes" lines for flamegraph tools.
+//HeapProfileReport <profile> --frames prints the allocation rate per frame as csv.
+#include "HeapProfileFormat.h"
+
+#include <cstdio>
+#include <cstring>
+#include <cinttypes>
+#include <vector>
+#include <string>
+#include <map>
+#include <algorithm>
+
+using namespace BB;
+
+struct HeapProfile
+{
+	HeapProfileFileHeader header;
+	std::vector<HeapProfileCallSite> callSites;
+	std::vector<HeapProfileAllocator> allocators;
+	std::vector<HeapProfileTag> tags;
+	std::vector<HeapProfileFrame> frames;
+	std::vector<char> strings;
+
+	const char* GetString(const uint32_t a_Offset) const
+	{
+		if (a_Offset == HEAP_PROFILE_NO_STRING || a_Offset >= strings.size())
+			return "unknown";
+		return strings.data() + a_Offset;
+	}
+
+	const char* GetAllocatorName(const uint32_t a_Index) const
+	{
+		if (a_Index >= allocators.size())
+			return "unknown";
+		return GetString(allocators[a_Index].name);
+	}
+};
+
+template<typename T>
+static bool ReadArray(FILE* a_File, std::vector<T>& a_Array, const uint64_t a_Count)
+{
+	a_Array.resize(a_Count);
+	return a_Count == 0 || fread(a_Array.data(), sizeof(T), a_Count, a_File) == a_Count;
+}
+
+static bool LoadProfile(const char* a_Path, HeapProfile& a_Profile)
+{
+	FILE* t_File = fopen(a_Path, "rb");
+	if (t_File == nullptr)
+	{
+		fprintf(stderr, "Could not open %s\n", a_Path);
+		return false;
+	}
+
+	bool t_Result = fread(&a_Profile.header, sizeof(a_Profile.header), 1, t_File) == 1;
+	if (t_Result && (a_Profile.header.magic != HEAP_PROFILE_MAGIC || a_Profile.header.version != HEAP_PROFILE_VERSION))
+	{
+		fprintf(stderr, "%s is not a heap profile of version %u\n", a_Path, HEAP_PROFILE_VERSION);
+		t_Result = false;
+	}
+
+	t_Result = t_Result &&
+		ReadArray(t_File, a_Profile.callSites, a_Profile.header.callSiteCount) &&
+		ReadArray(t_File, a_Profile.allocators, a_Profile.header.allocatorCount) &&
+		ReadArray(t_File, a_Profile.tags, a_Profile.header.tagCount) &&
+		ReadArray(t_File, a_Profile.frames, a_Profile.header.frameCount) &&
+		ReadArray(t_File, a_Profile.strings, a_Profile.header.stringTableSize);
+
+	if (!t_Result)
+		fprintf(stderr, "Failed to read %s\n", a_Path);
+	else
+		a_Profile.strings.push_back('\0');
+
+	fclose(t_File);
+	return t_Result;
+}
+
+//The same file can show up under different string pointers, one for every translation unit, merge those.
+struct MergedCallSite
+{
+	std::string file;
+	uint32_t line;
+	std::string allocator;
+	uint64_t allocCount = 0;
+	uint64_t freeCount = 0;
+	uint64_t totalBytes = 0;
+	uint64_t liveBytes = 0;
+	uint64_t peakBytes = 0;
+};
+
+static std::vector<MergedCallSite> MergeCallSites(const HeapProfile& a_Profile)
+{
+	std::map<std::string, MergedCallSite> t_Sites;
+	for (const HeapProfileCallSite& t_Site : a_Profile.callSites)
+	{
+		const char* t_AllocatorName = a_Profile.GetAllocatorName(t_Site.allocator);
+		const std::string t_Key = std::string(a_Profile.GetString(t_Site.file)) + ":" + std::to_string(t_Site.line) + ";" + t_AllocatorName;
+		MergedCallSite& t_Merged = t_Sites[t_Key];
+		t_Merged.file = a_Profile.GetString(t_Site.file);
+		t_Merged.line = t_Site.line;
+		t_Merged.allocator = t_AllocatorName;
+		t_Merged.allocCount += t_Site.allocCount;
+		t_Merged.freeCount += t_Site.freeCount;
+		t_Merged.totalBytes += t_Site.totalBytes;
+		t_Merged.liveBytes += t_Site.liveBytes;
+		//Not exact, the peaks of the merged sites might not have happened at the same time.
+		t_Merged.peakBytes += t_Site.peakBytes;
+	}
+
+	std::vector<MergedCallSite> t_Result;
+	for (auto& t_Pair : t_Sites)
+		t_Result.push_back(t_Pair.second);
+	std::sort(t_Result.begin(), t_Result.end(), [](const MergedCallSite& a_Lhs, const MergedCallSite& a_Rhs)
+		{
+			return a_Lhs.totalBytes > a_Rhs.totalBytes;
+		});
+	return t_Result;
+}
+
+static void PrintReport(const HeapProfile& a_Profile)
+{
+	printf("Allocators\n");
+	printf("%-32s %12s %12s %16s %16s %16s\n", "name", "allocs", "frees", "total bytes", "live bytes", "peak bytes");
+	for (const HeapProfileAllocator& t_Allocator : a_Profile.allocators)
+	{
+		printf("%-32s %12" PRIu64 " %12" PRIu64 " %16" PRIu64 " %16" PRIu64 " %16" PRIu64 "\n",
+			a_Profile.GetString(t_Allocator.name), t_Allocator.allocCount, t_Allocator.freeCount,
+			t_Allocator.totalBytes, t_Allocator.liveBytes, t_Allocator.peakBytes);
+	}
+
+	printf("\nTags\n");
+	printf("%-32s %16s %16s\n", "name", "live bytes", "peak bytes");
+	for (const HeapProfileTag& t_Tag : a_Profile.tags)
+		printf("%-32s %16" PRIu64 " %16" PRIu64 "\n", a_Profile.GetString(t_Tag.name), t_Tag.liveBytes, t_Tag.peakBytes);
+
+	printf("\nCall sites by total bytes\n");
+	printf("%-64s %-24s %12s %12s %16s %16s\n", "call site", "allocator", "allocs", "frees", "total bytes", "live bytes");
+	for (const MergedCallSite& t_Site : MergeCallSites(a_Profile))
+	{
+		const std::string t_Location = t_Site.file + ":" + std::to_string(t_Site.line);
+		printf("%-64s %-24s %12" PRIu64 " %12" PRIu64 " %16" PRIu64 " %16" PRIu64 "\n",
+			t_Location.c_str(), t_Site.allocator.c_str(), t_Site.allocCount, t_Site.freeCount, t_Site.totalBytes, t_Site.liveBytes);
+	}
+
+	if (a_Profile.frames.empty())
+		return;
+
+	uint64_t t_TotalAllocs = 0;
+	uint64_t t_TotalBytes = 0;
+	const HeapProfileFrame* t_WorstFrame = &a_Profile.frames[0];
+	for (const HeapProfileFrame& t_Frame : a_Profile.frames)
+	{
+		t_TotalAllocs += t_Frame.allocCount;
+		t_TotalBytes += t_Frame.allocBytes;
+		if (t_Frame.allocBytes > t_WorstFrame->allocBytes)
+			t_WorstFrame = &t_Frame;
+	}
+	const uint64_t t_FrameCount = a_Profile.frames.size();
+	printf("\nFrames %" PRIu64 " to %" PRIu64 "\n", a_Profile.frames.front().frameNumber, a_Profile.frames.back().frameNumber);
+	printf("average: %" PRIu64 " allocations, %" PRIu64 " bytes per frame\n", t_TotalAllocs / t_FrameCount, t_TotalBytes / t_FrameCount);
+	printf("worst frame %" PRIu64 ": %" PRIu64 " allocations, %" PRIu64 " bytes\n", t_WorstFrame->frameNumber, t_WorstFrame->allocCount, t_WorstFrame->allocBytes);
+}
+
+static void PrintFolded(const HeapProfile& a_Profile)
+{
+	for (const MergedCallSite& t_Site : MergeCallSites(a_Profile))
+	{
+		//Only the file name for the middle frame, full paths make the flamegraph unreadable.
+		const size_t t_Slash = t_Site.file.find_last_of("/\\");
+		const std::string t_FileName = t_Slash == std::string::npos ? t_Site.file : t_Site.file.substr(t_Slash + 1);
+		printf("%s;%s;%s:%u %" PRIu64 "\n", t_Site.allocator.c_str(), t_FileName.c_str(), t_FileName.c_str(), t_Site.line, t_Site.totalBytes);
+	}
+}
+
+static void PrintFrames(const HeapProfile& a_Profile)
+{
+	printf("frame,allocs,frees,alloc bytes,free bytes\n");
+	for (const HeapProfileFrame& t_Frame : a_Profile.frames)
+	{
+		printf("%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+			t_Frame.frameNumber, t_Frame.allocCount, t_Frame.freeCount, t_Frame.allocBytes, t_Frame.freeBytes);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: HeapProfileReport <profile> [--folded | --frames]\n");
+		return 1;
+	}
+
+	HeapProfile t_Profile;
+	if (!LoadProfile(argv[1], t_Profile))
+		return 1;
+
+	if (argc > 2 && strcmp(argv[2], "--folded") == 0)
+		PrintFolded(t_Profile);
+	else if (argc > 2 && strcmp(argv[2], "--frames") == 0)
+		PrintFrames(t_Profile);
+	else
+		PrintReport(t_Profile);
+
+	return 0;
+}
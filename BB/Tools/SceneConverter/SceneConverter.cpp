@@ -0,0 +1,92 @@
+//Converts a scene json to the binary scene file that SceneGraph loads in place.
+//SceneConverter <scene.json> <scene.bbscene>
+#include "BBMain.h"
+#include "BBMemory.h"
+#include "SceneFile.hpp"
+
+#include <cstdio>
+#include <vector>
+
+using namespace BB;
+
+static bool ReadJson(const char* a_Path, std::vector<char>& a_Json)
+{
+	FILE* t_File = fopen(a_Path, "rb");
+	if (t_File == nullptr)
+	{
+		fprintf(stderr, "Could not open %s\n", a_Path);
+		return false;
+	}
+
+	fseek(t_File, 0, SEEK_END);
+	a_Json.resize(static_cast<size_t>(ftell(t_File)));
+	fseek(t_File, 0, SEEK_SET);
+	const bool t_Result = a_Json.empty() || fread(a_Json.data(), 1, a_Json.size(), t_File) == a_Json.size();
+	if (!t_Result)
+		fprintf(stderr, "Failed to read %s\n", a_Path);
+
+	fclose(t_File);
+	return t_Result;
+}
+
+static int WriteSceneFile(const char* a_JsonPath, const char* a_Path, const Buffer& a_SceneFile)
+{
+	if (a_SceneFile.size == 0)
+	{
+		fprintf(stderr, "%s has no scene object\n", a_JsonPath);
+		return 1;
+	}
+
+	//Load it back the same way the renderer does so a broken file fails the build instead of the renderer.
+	const SceneFile t_Check{ a_SceneFile };
+	if (!t_Check.IsValid())
+	{
+		fprintf(stderr, "Converted scene file of %s is invalid\n", a_JsonPath);
+		return 1;
+	}
+
+	FILE* t_File = fopen(a_Path, "wb");
+	if (t_File == nullptr)
+	{
+		fprintf(stderr, "Could not create %s\n", a_Path);
+		return 1;
+	}
+	const bool t_Written = fwrite(a_SceneFile.data, 1, a_SceneFile.size, t_File) == a_SceneFile.size;
+	fclose(t_File);
+	if (!t_Written)
+	{
+		fprintf(stderr, "Failed to write %s\n", a_Path);
+		return 1;
+	}
+
+	printf("%s: %u lights, %u models, %u bytes\n", a_Path,
+		static_cast<uint32_t>(t_Check.GetLights().size()),
+		static_cast<uint32_t>(t_Check.GetModels().size()),
+		static_cast<uint32_t>(a_SceneFile.size));
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		fprintf(stderr, "usage: SceneConverter <scene.json> <scene.bbscene>\n");
+		return 1;
+	}
+
+	BBInitInfo t_BBInitInfo{};
+	t_BBInitInfo.exePath = argv[0];
+	t_BBInitInfo.programName = L"SceneConverter";
+	InitBB(t_BBInitInfo);
+
+	std::vector<char> t_Json;
+	if (!ReadJson(argv[1], t_Json))
+		return 1;
+
+	LinearAllocator_t t_Allocator{ mbSize * 4, "Scene converter" };
+	const Buffer t_JsonBuffer{ t_Json.data(), t_Json.size() };
+	const Buffer t_SceneFile = ConvertJsonToSceneFile(t_Allocator, t_JsonBuffer);
+	const int t_Result = WriteSceneFile(argv[1], argv[2], t_SceneFile);
+	t_Allocator.Clear();
+	return t_Result;
+}
@@ -3,6 +3,12 @@
 #include "BBMemory.h"
 #include "Allocators/TemporaryAllocator.h"
 #include "Allocators/RingAllocator.h"
+#include "Allocators/ScratchAllocator.h"
+#include "Allocators/ThreadCacheAllocator.h"
+#include "Allocators/HeapProfiler.h"
+#include "OS/Program.h"
+#include "BBThreadScheduler.hpp"
+#include <chrono>
 
 //Bytes samples with different sizes.
 constexpr const size_t sample_32_bytes = 10000;
@@ -497,4 +503,701 @@ TEST(MemoryAllocators, RING_ALLOCATOR)
 	}
 }
 
-#pragma endregion //RING_ALLOCATOR
\ No newline at end of file
+#pragma endregion //RING_ALLOCATOR
+
+#pragma region FRAME_RING_ALLOCATOR
+TEST(MemoryAllocators, FRAME_RING_ALLOCATOR)
+{
+	constexpr const uint32_t framesInFlight = 3;
+	constexpr const uint32_t frameCount = 64;
+	constexpr const uint32_t allocationsPerFrame = 32;
+
+	size_t t_Size = 64 * 1024;
+	BB::FrameRingAllocator t_FrameRing(t_Size);
+	const size_t t_StartCapacity = t_FrameRing.GetCapacity();
+
+	struct FrameAllocation
+	{
+		uint8_t* ptr;
+		size_t size;
+	};
+	FrameAllocation t_Allocations[framesInFlight][allocationsPerFrame]{};
+
+	for (uint32_t t_Frame = 0; t_Frame < frameCount; t_Frame++)
+	{
+		const uint64_t t_FenceValue = t_Frame + 1;
+		//The GPU is framesInFlight frames behind.
+		if (t_FenceValue > framesInFlight)
+			t_FrameRing.Retire(t_FenceValue - framesInFlight);
+
+		//Every frame in flight must still have it's own data.
+		for (uint32_t t_Old = 1; t_Old < framesInFlight && t_Old <= t_Frame; t_Old++)
+		{
+			const uint32_t t_OldFrame = t_Frame - t_Old;
+			for (uint32_t i = 0; i < allocationsPerFrame; i++)
+			{
+				const FrameAllocation& t_Allocation = t_Allocations[t_OldFrame % framesInFlight][i];
+				ASSERT_EQ(t_Allocation.ptr[0], static_cast<uint8_t>(t_OldFrame)) << "Frame ring allocator overwrote a frame in flight.";
+				ASSERT_EQ(t_Allocation.ptr[t_Allocation.size - 1], static_cast<uint8_t>(t_OldFrame)) << "Frame ring allocator overwrote a frame in flight.";
+			}
+		}
+
+		//Some frames upload a lot more, the ring has to grow for those instead of wrapping over live frames.
+		const size_t t_FrameScale = (t_Frame % 16 == 15) ? 16 : 1;
+		for (uint32_t i = 0; i < allocationsPerFrame; i++)
+		{
+			const size_t t_Alignment = size_t(1) << (i % 8);
+			const size_t t_AllocSize = (static_cast<size_t>(BB::Random::Random(16, 1024)) + i) * t_FrameScale;
+			uint8_t* t_Ptr = reinterpret_cast<uint8_t*>(t_FrameRing.Alloc(t_AllocSize, t_Alignment));
+			ASSERT_EQ(reinterpret_cast<uintptr_t>(t_Ptr) % t_Alignment, 0) << "Frame ring allocation is not aligned.";
+			memset(t_Ptr, static_cast<uint8_t>(t_Frame), t_AllocSize);
+			t_Allocations[t_Frame % framesInFlight][i] = { t_Ptr, t_AllocSize };
+		}
+		t_FrameRing.EndFrame(t_FenceValue);
+	}
+
+	EXPECT_GT(t_FrameRing.GetGrowCount(), 0u) << "Frame ring allocator did not grow for the big frames.";
+	EXPECT_GT(t_FrameRing.GetCapacity(), t_StartCapacity);
+	EXPECT_LE(t_FrameRing.GetCapacity(), t_FrameRing.GetMaxCapacity());
+
+	t_FrameRing.Retire(frameCount);
+	EXPECT_EQ(t_FrameRing.GetUsed(), 0) << "Frame ring allocator still has memory in use after retiring every fence.";
+
+	//Allocations through the Allocator interface are tagged with the next EndFrame as well.
+	size32Bytes* t_Sample = BBnew(t_FrameRing, size32Bytes);
+	t_Sample->value = 32;
+	//The heap profiler puts a header in front of it.
+	EXPECT_GE(t_FrameRing.GetUsed(), sizeof(size32Bytes));
+	t_FrameRing.EndFrame(frameCount + 1);
+	t_FrameRing.Retire(frameCount + 1);
+	EXPECT_EQ(t_FrameRing.GetUsed(), 0);
+}
+#pragma endregion //FRAME_RING_ALLOCATOR
+
+#pragma region SCRATCH_ALLOCATOR
+TEST(MemoryAllocators, SCRATCH_ALLOCATOR)
+{
+	constexpr const size_t allocatorSize =
+		sizeof(size32Bytes) * sample_32_bytes +
+		sizeof(size256Bytes) * sample_256_bytes +
+		sizeof(size2593bytes) * sample_2593_bytes;
+
+	//Make sure this thread's arena is reset.
+	BB::Scratch::NextFrame();
+	const BB::ScratchMarker t_Start = BB::Scratch::Mark();
+	BB::Scratch::Rewind(t_Start);
+	const uint32_t t_ArenaIndex = BB::Scratch::GetThreadArenaInfo().arenaIndex;
+
+	{
+		BB::ScratchScope t_Scope;
+		//Goes over SCRATCH_COMMIT_START so the arena has to commit more memory.
+		for (size_t i = 0; i < sample_32_bytes; i++)
+		{
+			size32Bytes* sample = BBnew(t_Scope, size32Bytes);
+			sample->value = i;
+		}
+		for (size_t i = 0; i < sample_256_bytes; i++)
+		{
+			size256Bytes* sample = BBnew(t_Scope, size256Bytes);
+			sample->value = i;
+		}
+
+		const BB::ScratchMarker t_Nested = BB::Scratch::Mark();
+		size2593bytes* t_Last = nullptr;
+		for (size_t i = 0; i < sample_2593_bytes; i++)
+		{
+			t_Last = BBnew(t_Scope, size2593bytes);
+			t_Last->value = i;
+		}
+		EXPECT_EQ(t_Last->value, sample_2593_bytes - 1);
+		EXPECT_GE(BB::Scratch::GetThreadArenaInfo().used, allocatorSize);
+		EXPECT_GE(BB::Scratch::GetThreadArenaInfo().commited, allocatorSize);
+
+		//A rewind hands out the same memory again.
+		BB::Scratch::Rewind(t_Nested);
+		const BB::ScratchMarker t_AfterRewind = BB::Scratch::Mark();
+		EXPECT_EQ(t_AfterRewind.position, t_Nested.position);
+		BB::Scratch::Rewind(t_AfterRewind);
+
+		//A new frame does not reset the arena while a scope is open.
+		BB::Scratch::NextFrame();
+		void* t_Ptr = BB::Scratch::Alloc(16, 16);
+		EXPECT_GT(t_Ptr, t_Start.position);
+	}
+
+	const BB::ScratchArenaInfo t_Info = BB::Scratch::GetThreadArenaInfo();
+	EXPECT_EQ(t_Info.used, 0u);
+	EXPECT_GE(t_Info.highWaterMark, allocatorSize);
+	EXPECT_LE(t_Info.highWaterMark, t_Info.commited);
+
+	//Memory outside a scope lives until the next frame.
+	BB::Scratch::Alloc(256, 16);
+	BB::Scratch::NextFrame();
+	const BB::ScratchMarker t_Reset = BB::Scratch::Mark();
+	BB::Scratch::Rewind(t_Reset);
+	EXPECT_EQ(t_Reset.position, t_Start.position);
+	EXPECT_GE(BB::Scratch::GetThreadArenaInfo().frameHighWaterMark, 256u);
+
+	//The infos of all the arenas include this thread's arena.
+	BB::ScratchArenaInfo t_Infos[BB::SCRATCH_MAX_ARENAS];
+	const uint32_t t_InfoCount = BB::Scratch::GetArenaInfos(t_Infos, BB::SCRATCH_MAX_ARENAS);
+	bool t_Found = false;
+	for (uint32_t i = 0; i < t_InfoCount; i++)
+		if (t_Infos[i].arenaIndex == t_ArenaIndex)
+			t_Found = true;
+	EXPECT_TRUE(t_Found);
+}
+
+#pragma endregion //SCRATCH_ALLOCATOR
+
+#pragma region TLSF_ALLOCATOR
+TEST(MemoryAllocators, TLSF_SINGLE_ALLOCATIONS)
+{
+	constexpr const size_t allocatorSize =
+		sizeof(size32Bytes) * sample_32_bytes +
+		sizeof(size256Bytes) * sample_256_bytes +
+		sizeof(size2593bytes) * sample_2593_bytes;
+
+	size_t randomValues[samples]{};
+	for (size_t i = 0; i < samples; i++)
+	{
+		randomValues[i] = static_cast<size_t>(BB::Random::Random());
+	}
+
+	//Half the size so the allocator has to grow.
+	BB::TLSFAllocator_t t_TLSFAllocator(allocatorSize / 2);
+
+	size32Bytes* t_32Bytes[sample_32_bytes];
+	size256Bytes* t_256Bytes[sample_256_bytes];
+	size2593bytes* t_2593Bytes[sample_2593_bytes];
+	for (size_t i = 0; i < sample_32_bytes; i++)
+	{
+		t_32Bytes[i] = BBnew(t_TLSFAllocator, size32Bytes);
+		t_32Bytes[i]->value = randomValues[i];
+	}
+	for (size_t i = 0; i < sample_256_bytes; i++)
+	{
+		t_256Bytes[i] = BBnew(t_TLSFAllocator, size256Bytes);
+		t_256Bytes[i]->value = randomValues[sample_32_bytes + i];
+	}
+	for (size_t i = 0; i < sample_2593_bytes; i++)
+	{
+		t_2593Bytes[i] = BBnew(t_TLSFAllocator, size2593bytes);
+		t_2593Bytes[i]->value = randomValues[sample_32_bytes + sample_256_bytes + i];
+	}
+
+	//Free every other allocation so the holes get merged with their neighbours on the second pass.
+	for (size_t i = 0; i < sample_32_bytes; i += 2)
+		BB::BBfree(t_TLSFAllocator, t_32Bytes[i]);
+	for (size_t i = 0; i < sample_256_bytes; i += 2)
+		BB::BBfree(t_TLSFAllocator, t_256Bytes[i]);
+	for (size_t i = 0; i < sample_2593_bytes; i += 2)
+		BB::BBfree(t_TLSFAllocator, t_2593Bytes[i]);
+
+	for (size_t i = 1; i < sample_32_bytes; i += 2)
+	{
+		EXPECT_EQ(t_32Bytes[i]->value, randomValues[i]) << "32 bytes is wrong.";
+		BB::BBfree(t_TLSFAllocator, t_32Bytes[i]);
+	}
+	for (size_t i = 1; i < sample_256_bytes; i += 2)
+	{
+		EXPECT_EQ(t_256Bytes[i]->value, randomValues[sample_32_bytes + i]) << "256 bytes is wrong.";
+		BB::BBfree(t_TLSFAllocator, t_256Bytes[i]);
+	}
+	for (size_t i = 1; i < sample_2593_bytes; i += 2)
+	{
+		EXPECT_EQ(t_2593Bytes[i]->value, randomValues[sample_32_bytes + sample_256_bytes + i]) << "2593 bytes is wrong.";
+		BB::BBfree(t_TLSFAllocator, t_2593Bytes[i]);
+	}
+
+	//Everything is merged back, so a single allocation of nearly all the memory fits without growing.
+	const size_t t_TotalSize = t_TLSFAllocator.m_TotalAllocSize;
+	void* t_Big = t_TLSFAllocator.Alloc(t_TotalSize / 2, 16);
+	EXPECT_EQ(t_TotalSize, t_TLSFAllocator.m_TotalAllocSize);
+	t_TLSFAllocator.Free(t_Big);
+
+	//Alignment is checked on the allocator itself, the debug boundries would shift the pointer.
+	void* t_Aligned[8];
+	for (size_t i = 0; i < 8; i++)
+	{
+		const size_t t_Alignment = static_cast<size_t>(32) << i;
+		t_Aligned[i] = t_TLSFAllocator.Alloc(48, t_Alignment);
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(t_Aligned[i]) % t_Alignment, 0u);
+	}
+	for (size_t i = 0; i < 8; i++)
+		t_TLSFAllocator.Free(t_Aligned[i]);
+}
+
+TEST(MemoryAllocators, TLSF_GROW)
+{
+	constexpr const size_t GROW_COUNT = 3;
+
+	BB::TLSFAllocator_t t_TLSFAllocator(BB::kbSize * 256);
+	//Takes nearly all of the pool, so a grow cannot lean on a big free block at the end.
+	void* t_Fill = t_TLSFAllocator.Alloc(t_TLSFAllocator.m_TotalAllocSize - (t_TLSFAllocator.m_TotalAllocSize >> 5) - 64, 16);
+	ASSERT_NE(t_Fill, nullptr);
+
+	uint8_t* t_Allocations[GROW_COUNT];
+	size_t t_Sizes[GROW_COUNT];
+	for (size_t i = 0; i < GROW_COUNT; i++)
+	{
+		//Always more then what is left. Just over a power of 2 the size class rounds up the most,
+		//the grow must be big enough for that rounded up class and not just for the size.
+		t_Sizes[i] = (BB::mbSize / 2 << i) + 24;
+		t_Allocations[i] = reinterpret_cast<uint8_t*>(t_TLSFAllocator.Alloc(t_Sizes[i], 16));
+		ASSERT_NE(t_Allocations[i], nullptr) << "TLSF allocator did not find a block after growing.";
+
+		//The whole allocation must be usable, the last word is next to the block after it.
+		memset(t_Allocations[i], static_cast<int>(i), t_Sizes[i]);
+		size_t* t_LastWord = reinterpret_cast<size_t*>(t_Allocations[i] + t_Sizes[i] - sizeof(size_t));
+		*t_LastWord = t_Sizes[i];
+	}
+
+	for (size_t i = 0; i < GROW_COUNT; i++)
+	{
+		EXPECT_EQ(t_Allocations[i][0], static_cast<uint8_t>(i)) << "Allocation " << i << " was overwritten.";
+		EXPECT_EQ(*reinterpret_cast<size_t*>(t_Allocations[i] + t_Sizes[i] - sizeof(size_t)), t_Sizes[i]) << "Allocation " << i << " was overwritten.";
+	}
+	for (size_t i = 0; i < GROW_COUNT; i++)
+		t_TLSFAllocator.Free(t_Allocations[i]);
+	t_TLSFAllocator.Free(t_Fill);
+
+	//Everything merged back into one block, that block is bigger then every allocation so no grow is needed.
+	const size_t t_TotalSize = t_TLSFAllocator.m_TotalAllocSize;
+	void* t_Big = t_TLSFAllocator.Alloc(t_Sizes[GROW_COUNT - 1], 16);
+	ASSERT_NE(t_Big, nullptr);
+	EXPECT_EQ(t_TotalSize, t_TLSFAllocator.m_TotalAllocSize);
+	t_TLSFAllocator.Free(t_Big);
+}
+
+struct AllocatorTraceOp
+{
+	uint32_t slot;
+	//0 means free the slot.
+	uint32_t size;
+};
+
+//Random alloc/free trace, most allocations are small with the occasional big one.
+static void CreateAllocatorTrace(AllocatorTraceOp* a_Ops, const size_t a_OpCount, bool* a_SlotUsed, const uint32_t a_SlotCount)
+{
+	BB::Random::Seed(1337);
+	for (uint32_t i = 0; i < a_SlotCount; i++)
+		a_SlotUsed[i] = false;
+
+	for (size_t i = 0; i < a_OpCount; i++)
+	{
+		const uint32_t t_Slot = BB::Random::Random(a_SlotCount);
+		a_Ops[i].slot = t_Slot;
+		if (a_SlotUsed[t_Slot])
+			a_Ops[i].size = 0;
+		else if (BB::Random::Random(16) == 0)
+			a_Ops[i].size = BB::Random::Random(4096, 32768);
+		else
+			a_Ops[i].size = BB::Random::Random(16, 512);
+		a_SlotUsed[t_Slot] = !a_SlotUsed[t_Slot];
+	}
+}
+
+//Returns the time in milliseconds, the first and last size_t of every allocation are checked to find overlapping allocations.
+static float RunAllocatorTrace(BB::Allocator a_Allocator, const AllocatorTraceOp* a_Ops, const size_t a_OpCount, size_t** a_Slots, const uint32_t a_SlotCount)
+{
+	typedef std::chrono::duration<float, std::milli> ms;
+	for (uint32_t i = 0; i < a_SlotCount; i++)
+		a_Slots[i] = nullptr;
+
+	size_t t_Errors = 0;
+	auto t_Timer = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < a_OpCount; i++)
+	{
+		const AllocatorTraceOp& t_Op = a_Ops[i];
+		if (t_Op.size != 0)
+		{
+			size_t* t_Ptr = reinterpret_cast<size_t*>(BBalloc(a_Allocator, t_Op.size));
+			t_Ptr[0] = t_Op.slot;
+			t_Ptr[t_Op.size / sizeof(size_t) - 1] = t_Op.slot;
+			a_Slots[t_Op.slot] = t_Ptr;
+		}
+		else
+		{
+			size_t* t_Ptr = a_Slots[t_Op.slot];
+			if (t_Ptr[0] != t_Op.slot)
+				++t_Errors;
+			BB::BBfree(a_Allocator, t_Ptr);
+			a_Slots[t_Op.slot] = nullptr;
+		}
+	}
+	for (uint32_t i = 0; i < a_SlotCount; i++)
+	{
+		if (a_Slots[i] != nullptr)
+			BB::BBfree(a_Allocator, a_Slots[i]);
+	}
+	const float t_Time = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count();
+
+	EXPECT_EQ(t_Errors, 0u) << "Allocations overlapped during the trace.";
+	return t_Time;
+}
+
+TEST(MemoryAllocators, ALLOCATOR_RANDOM_TRACE_SPEED)
+{
+	constexpr const size_t OP_COUNT = 200000;
+	constexpr const uint32_t SLOT_COUNT = 2048;
+
+	BB::LinearAllocator_t t_TraceAllocator(BB::mbSize * 4, "Trace allocator");
+	AllocatorTraceOp* t_Ops = BBnewArr(t_TraceAllocator, OP_COUNT, AllocatorTraceOp);
+	bool* t_SlotUsed = BBnewArr(t_TraceAllocator, SLOT_COUNT, bool);
+	size_t** t_Slots = BBnewArr(t_TraceAllocator, SLOT_COUNT, size_t*);
+	CreateAllocatorTrace(t_Ops, OP_COUNT, t_SlotUsed, SLOT_COUNT);
+
+	{
+		BB::FreelistAllocator_t t_Freelist(BB::mbSize * 16, "Trace freelist");
+		const float t_Time = RunAllocatorTrace(t_Freelist, t_Ops, OP_COUNT, t_Slots, SLOT_COUNT);
+		std::cout << "Freelist allocator random trace of " << OP_COUNT << " operations in MS:" << t_Time << "\n";
+	}
+	{
+		BB::POW_FreelistAllocator_t t_POWFreelist(BB::mbSize * 16, "Trace POW freelist");
+		const float t_Time = RunAllocatorTrace(t_POWFreelist, t_Ops, OP_COUNT, t_Slots, SLOT_COUNT);
+		std::cout << "POW Freelist allocator random trace of " << OP_COUNT << " operations in MS:" << t_Time << "\n";
+	}
+	{
+		BB::TLSFAllocator_t t_TLSF(BB::mbSize * 16, "Trace TLSF");
+		const float t_Time = RunAllocatorTrace(t_TLSF, t_Ops, OP_COUNT, t_Slots, SLOT_COUNT);
+		std::cout << "TLSF allocator random trace of " << OP_COUNT << " operations in MS:" << t_Time << "\n";
+	}
+	t_TraceAllocator.Clear();
+}
+
+#pragma endregion //TLSF_ALLOCATOR
+
+#pragma region THREAD_CACHE_ALLOCATOR
+TEST(MemoryAllocators, THREAD_CACHE_SINGLE_THREAD)
+{
+	BB::FreelistAllocator_t t_Backing(BB::mbSize * 4, "Thread cache backing");
+	BB::ThreadCacheAllocator t_Allocator(t_Backing, "Thread cache");
+
+	//Every size class and a couple of sizes that go to mallocVirtual.
+	constexpr const size_t ALLOCATION_COUNT = 96;
+	size_t* t_Allocations[ALLOCATION_COUNT];
+	size_t t_Sizes[ALLOCATION_COUNT];
+	for (size_t i = 0; i < ALLOCATION_COUNT; i++)
+	{
+		t_Sizes[i] = (i + 1) * (i + 1) * 8;
+		t_Allocations[i] = reinterpret_cast<size_t*>(BBalloc(t_Allocator, t_Sizes[i]));
+		t_Allocations[i][0] = i;
+		t_Allocations[i][t_Sizes[i] / sizeof(size_t) - 1] = i;
+	}
+	for (size_t i = 0; i < ALLOCATION_COUNT; i++)
+	{
+		EXPECT_EQ(t_Allocations[i][0], i);
+		EXPECT_EQ(t_Allocations[i][t_Sizes[i] / sizeof(size_t) - 1], i);
+		BB::BBfree(t_Allocator, t_Allocations[i]);
+	}
+
+	//Freed memory is reused by the same size class.
+	size_t* t_First = BBnew(t_Allocator, size_t);
+	BB::BBfree(t_Allocator, t_First);
+	size_t* t_Second = BBnew(t_Allocator, size_t);
+	EXPECT_EQ(t_First, t_Second);
+	BB::BBfree(t_Allocator, t_Second);
+
+	for (size_t i = 0; i < 10; i++)
+	{
+		const size_t t_Alignment = static_cast<size_t>(16) << i;
+		void* t_Aligned = t_Allocator.Alloc(100, t_Alignment);
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(t_Aligned) % t_Alignment, 0u);
+		t_Allocator.Free(t_Aligned);
+	}
+}
+
+struct ThreadCacheTestParam
+{
+	BB::ThreadCacheAllocator* allocator;
+	size_t** allocations;
+	size_t begin;
+	size_t end;
+};
+
+static void ThreadCacheTest_Alloc(void* a_Param)
+{
+	ThreadCacheTestParam* t_Param = reinterpret_cast<ThreadCacheTestParam*>(a_Param);
+	for (size_t i = t_Param->begin; i < t_Param->end; i++)
+	{
+		t_Param->allocations[i] = reinterpret_cast<size_t*>(BBalloc(*t_Param->allocator, 16 + (i % 64) * 16));
+		t_Param->allocations[i][0] = i;
+	}
+}
+
+//Frees the allocations of a different job, most of them are remote frees.
+static void ThreadCacheTest_Free(void* a_Param)
+{
+	ThreadCacheTestParam* t_Param = reinterpret_cast<ThreadCacheTestParam*>(a_Param);
+	for (size_t i = t_Param->begin; i < t_Param->end; i++)
+	{
+		if (t_Param->allocations[i][0] != i)
+			t_Param->allocations[i] = nullptr;
+		else
+			BB::BBfree(*t_Param->allocator, t_Param->allocations[i]);
+	}
+}
+
+TEST(MemoryAllocators, THREAD_CACHE_CROSS_THREAD)
+{
+	constexpr const size_t JOB_COUNT = 16;
+	constexpr const size_t ALLOCATIONS_PER_JOB = 2048;
+	constexpr const size_t ALLOCATION_COUNT = JOB_COUNT * ALLOCATIONS_PER_JOB;
+
+	BB::FreelistAllocator_t t_Backing(BB::mbSize * 16, "Thread cache backing");
+	BB::ThreadCacheAllocator t_Allocator(t_Backing, "Thread cache");
+	BB::LinearAllocator_t t_ListAllocator(sizeof(size_t*) * ALLOCATION_COUNT, "Allocation list");
+	size_t** t_Allocations = BBnewArr(t_ListAllocator, ALLOCATION_COUNT, size_t*);
+
+	ThreadCacheTestParam t_Params[JOB_COUNT];
+	for (size_t i = 0; i < JOB_COUNT; i++)
+		t_Params[i] = ThreadCacheTestParam{ &t_Allocator, t_Allocations, i * ALLOCATIONS_PER_JOB, (i + 1) * ALLOCATIONS_PER_JOB };
+
+	//Do it twice so the second round reuses the memory that was freed remotely.
+	for (size_t t_Round = 0; t_Round < 2; t_Round++)
+	{
+		BB::JobCounter t_AllocCounter;
+		for (size_t i = 0; i < JOB_COUNT; i++)
+			BB::Threads::StartTaskThread(ThreadCacheTest_Alloc, &t_Params[i], &t_AllocCounter);
+		BB::Threads::WaitForCounter(t_AllocCounter);
+
+		BB::JobCounter t_FreeCounter;
+		for (size_t i = 0; i < JOB_COUNT; i++)
+			BB::Threads::StartTaskThread(ThreadCacheTest_Free, &t_Params[JOB_COUNT - i - 1], &t_FreeCounter);
+		BB::Threads::WaitForCounter(t_FreeCounter);
+
+		//A nullptr means that the allocation was overwritten by a different one.
+		for (size_t i = 0; i < ALLOCATION_COUNT; i++)
+			ASSERT_NE(t_Allocations[i], nullptr) << "Allocation " << i << " was overwritten.";
+	}
+	t_ListAllocator.Clear();
+}
+
+#pragma endregion //THREAD_CACHE_ALLOCATOR
+
+#pragma region VIRTUAL_MEMORY
+TEST(MemoryAllocators, VIRTUAL_MEMORY_COMMIT_AHEAD)
+{
+	const BB::VirtualMemoryStats t_StartStats = BB::GetVirtualMemoryStats();
+
+	size_t t_Size = BB::VirtualMemoryPageSize();
+	uint8_t* t_Start = reinterpret_cast<uint8_t*>(BB::mallocVirtual(nullptr, t_Size, BB::VIRTUAL_RESERVE_STANDARD));
+	size_t t_TotalSize = t_Size;
+	memset(t_Start, 1, t_Size);
+
+	//Grow one page at a time, commit ahead should make most of these skip the OS.
+	constexpr const size_t RESIZE_COUNT = 32;
+	for (size_t i = 0; i < RESIZE_COUNT; i++)
+	{
+		size_t t_Increase = BB::VirtualMemoryPageSize();
+		uint8_t* t_NewRange = reinterpret_cast<uint8_t*>(BB::mallocVirtual(t_Start, t_Increase));
+		ASSERT_EQ(t_NewRange, t_Start + t_TotalSize) << "mallocVirtual did not return the end of the previous range.";
+		memset(t_NewRange, 2, t_Increase);
+		t_TotalSize += t_Increase;
+	}
+
+	const BB::VirtualMemoryStats t_GrowStats = BB::GetVirtualMemoryStats();
+	EXPECT_EQ(t_GrowStats.reserveCount - t_StartStats.reserveCount, 1u);
+	EXPECT_LT(t_GrowStats.commitCount - t_StartStats.commitCount, RESIZE_COUNT / 2);
+	EXPECT_GT(t_GrowStats.commitsAvoided - t_StartStats.commitsAvoided, RESIZE_COUNT / 2);
+
+	BB::freeVirtual(t_Start);
+	const BB::VirtualMemoryStats t_EndStats = BB::GetVirtualMemoryStats();
+	EXPECT_EQ(t_EndStats.bytesReserved, t_StartStats.bytesReserved);
+	EXPECT_EQ(t_EndStats.bytesCommited, t_StartStats.bytesCommited);
+}
+
+TEST(MemoryAllocators, VIRTUAL_MEMORY_HUGE_PAGES)
+{
+	const BB::VirtualMemoryStats t_StartStats = BB::GetVirtualMemoryStats();
+
+	BB::VirtualMemoryOptions t_Options;
+	t_Options.pageType = BB::VIRTUAL_PAGE_TYPE::TRANSPARENT_HUGE;
+	size_t t_Size = BB::mbSize;
+	uint8_t* t_Start = reinterpret_cast<uint8_t*>(BB::mallocVirtual(nullptr, t_Size, BB::VIRTUAL_RESERVE_HALF, t_Options));
+	ASSERT_GE(t_Size, BB::mbSize);
+	memset(t_Start, 5, t_Size);
+
+	const size_t t_HugePageSize = BB::VirtualMemoryHugePageSize();
+	const BB::VirtualMemoryStats t_HugeStats = BB::GetVirtualMemoryStats();
+	if (t_HugePageSize != 0)
+	{
+		//The commit is rounded up to the huge page size.
+		EXPECT_EQ((t_Size + reinterpret_cast<uintptr_t>(t_Start)) % t_HugePageSize, 0u);
+		EXPECT_GT(t_HugeStats.hugePageBytesCommited, t_StartStats.hugePageBytesCommited);
+		EXPECT_GT(t_HugeStats.pageFaultsAvoided, t_StartStats.pageFaultsAvoided);
+	}
+	else
+		EXPECT_EQ(t_HugeStats.hugePageBytesCommited, t_StartStats.hugePageBytesCommited);
+
+	{
+		//A freelist allocator must still work with the huge page backing.
+		BB::FreelistAllocator_t t_Allocator(BB::mbSize * 4, "Huge page freelist", t_Options);
+		uint8_t* t_Memory = BBnewArr(t_Allocator, BB::mbSize, uint8_t);
+		memset(t_Memory, 6, BB::mbSize);
+		BB::BBfreeArr(t_Allocator, t_Memory);
+	}
+
+	BB::freeVirtual(t_Start);
+	EXPECT_EQ(BB::GetVirtualMemoryStats().hugePageBytesCommited, t_StartStats.hugePageBytesCommited);
+}
+
+TEST(MemoryAllocators, VIRTUAL_MEMORY_ALIGNMENT)
+{
+	constexpr const size_t MIN_ALIGNMENT = 16;
+
+	size_t t_Size = BB::kbSize * 3;
+	void* t_Start = BB::mallocVirtual(nullptr, t_Size, BB::VIRTUAL_RESERVE_STANDARD);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(t_Start) % MIN_ALIGNMENT, 0u) << "mallocVirtual broke the 16 byte alignment.";
+	BB::freeVirtual(t_Start);
+
+	BB::VirtualMemoryOptions t_Options;
+	t_Options.pageType = BB::VIRTUAL_PAGE_TYPE::TRANSPARENT_HUGE;
+	t_Size = BB::mbSize;
+	t_Start = BB::mallocVirtual(nullptr, t_Size, BB::VIRTUAL_RESERVE_HALF, t_Options);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(t_Start) % MIN_ALIGNMENT, 0u) << "mallocVirtual broke the 16 byte alignment with huge pages.";
+	BB::freeVirtual(t_Start);
+
+	//TLSF only realigns above 16 bytes, so this depends on the virtual memory being aligned.
+	BB::TLSFAllocator_t t_TLSFAllocator(BB::mbSize);
+	void* t_Allocations[64];
+	for (size_t i = 0; i < 64; i++)
+	{
+		t_Allocations[i] = t_TLSFAllocator.Alloc(8 + i * 24, MIN_ALIGNMENT);
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(t_Allocations[i]) % MIN_ALIGNMENT, 0u) << "TLSF allocation " << i << " is not 16 byte aligned.";
+	}
+	for (size_t i = 0; i < 64; i++)
+		t_TLSFAllocator.Free(t_Allocations[i]);
+}
+
+TEST(MemoryAllocators, VIRTUAL_MEMORY_RESERVE_LIMIT)
+{
+	//A big pool with the standard reserve is capped instead of reserving 128 times the size.
+	size_t t_Size = BB::VIRTUAL_RESERVE_MAX_SIZE / 64;
+	const size_t t_ReservedBefore = BB::GetVirtualMemoryStats().bytesReserved;
+	void* t_Start = BB::mallocVirtual(nullptr, t_Size, BB::VIRTUAL_RESERVE_STANDARD);
+	ASSERT_NE(t_Start, nullptr) << "mallocVirtual failed to reserve a capped reservation.";
+	EXPECT_EQ(BB::GetVirtualMemoryStats().bytesReserved - t_ReservedBefore, BB::VIRTUAL_RESERVE_MAX_SIZE) << "mallocVirtual did not cap the reservation.";
+	BB::freeVirtual(t_Start);
+
+	//Resizing past the reservation can not stay contiguous, so it must fail instead of making a new reservation.
+	t_Size = BB::kbSize * 64;
+	t_Start = BB::mallocVirtual(nullptr, t_Size, BB::VIRTUAL_RESERVE_NONE);
+	ASSERT_NE(t_Start, nullptr);
+	size_t t_Increase = t_Size;
+	EXPECT_EQ(BB::mallocVirtual(t_Start, t_Increase), nullptr) << "mallocVirtual resized past the reservation.";
+	BB::freeVirtual(t_Start);
+
+#ifdef _64BIT
+	//More then the address space, the OS can not reserve this.
+	t_Size = 1ull << 50;
+	EXPECT_EQ(BB::mallocVirtual(nullptr, t_Size, BB::VIRTUAL_RESERVE_NONE), nullptr) << "mallocVirtual did not return a nullptr when the OS failed to reserve.";
+#endif //_64BIT
+}
+#pragma endregion //VIRTUAL_MEMORY
+
+#pragma region HEAP_PROFILER
+TEST(MemoryAllocators, HEAP_PROFILER)
+{
+	constexpr const size_t ALLOCATION_COUNT = 8;
+	constexpr const size_t ALLOCATION_SIZE = 100;
+	constexpr const size_t ALLOCATION_ALIGNMENT = 64;
+	constexpr const char* TAG_NAME = "Heap profiler tag";
+	constexpr const char* PROFILE_NAME = "HEAPPROFILERTEST.bbheap";
+
+	BB::FreelistAllocator_t t_Allocator(BB::kbSize * 16, "Heap profiler test");
+	//BaseAllocators only register themselves when compiled with BB_HEAP_PROFILER.
+	BB::HeapProfiler::RegisterAllocator(&t_Allocator, t_Allocator.name);
+	BB::Allocator t_Interface = t_Allocator;
+
+	BB::HeapProfiler::NextFrame();
+	void* t_Allocations[ALLOCATION_COUNT];
+#if defined(_DEBUG) || defined(BB_HEAP_PROFILER)
+	//Call sites are only recorded in these builds.
+	const int t_AllocLine = __LINE__ + 3;
+#endif //_DEBUG || BB_HEAP_PROFILER
+	for (size_t i = 0; i < ALLOCATION_COUNT; i++)
+		t_Allocations[i] = BB::HeapProfiler::Alloc(BB_MEMORY_DEBUG_ARGS t_Interface, ALLOCATION_SIZE, ALLOCATION_ALIGNMENT);
+	BB::HeapProfiler::NextFrame();
+
+	for (size_t i = 0; i < ALLOCATION_COUNT; i++)
+		ASSERT_EQ(reinterpret_cast<uintptr_t>(t_Allocations[i]) % ALLOCATION_ALIGNMENT, 0u) << "Heap profiler broke the alignment.";
+
+	BB::HeapProfiler::TagAllocation(t_Allocations[0], TAG_NAME);
+	for (size_t i = ALLOCATION_COUNT / 2; i < ALLOCATION_COUNT; i++)
+		BB::HeapProfiler::Free(t_Interface, t_Allocations[i]);
+
+	BB::HeapAllocatorInfo t_AllocatorInfos[BB::HEAP_PROFILER_MAX_ALLOCATORS];
+	const uint32_t t_AllocatorCount = BB::HeapProfiler::GetAllocatorInfos(t_AllocatorInfos, BB::HEAP_PROFILER_MAX_ALLOCATORS);
+	const BB::HeapAllocatorInfo* t_AllocatorInfo = nullptr;
+	for (uint32_t i = 0; i < t_AllocatorCount; i++)
+		if (t_AllocatorInfos[i].allocator == &t_Allocator)
+			t_AllocatorInfo = &t_AllocatorInfos[i];
+
+	ASSERT_NE(t_AllocatorInfo, nullptr);
+	EXPECT_STREQ(t_AllocatorInfo->name, t_Allocator.name);
+	EXPECT_EQ(t_AllocatorInfo->allocCount, ALLOCATION_COUNT);
+	EXPECT_EQ(t_AllocatorInfo->freeCount, ALLOCATION_COUNT / 2);
+	EXPECT_EQ(t_AllocatorInfo->liveBytes, ALLOCATION_SIZE * ALLOCATION_COUNT / 2);
+	EXPECT_EQ(t_AllocatorInfo->peakBytes, ALLOCATION_SIZE * ALLOCATION_COUNT);
+
+	BB::HeapTagInfo t_TagInfos[BB::HEAP_PROFILER_MAX_TAGS];
+	const uint32_t t_TagCount = BB::HeapProfiler::GetTagInfos(t_TagInfos, BB::HEAP_PROFILER_MAX_TAGS);
+	bool t_FoundTag = false;
+	for (uint32_t i = 0; i < t_TagCount; i++)
+	{
+		if (t_TagInfos[i].name == TAG_NAME)
+		{
+			t_FoundTag = true;
+			EXPECT_EQ(t_TagInfos[i].liveBytes, ALLOCATION_SIZE);
+		}
+	}
+	EXPECT_TRUE(t_FoundTag);
+
+#if defined(_DEBUG) || defined(BB_HEAP_PROFILER)
+	BB::HeapCallSiteInfo* t_CallSiteInfos = BBnewArr(t_Allocator, BB::HEAP_PROFILER_MAX_CALL_SITES, BB::HeapCallSiteInfo);
+	const uint32_t t_CallSiteCount = BB::HeapProfiler::GetCallSiteInfos(t_CallSiteInfos, BB::HEAP_PROFILER_MAX_CALL_SITES);
+	bool t_FoundCallSite = false;
+	for (uint32_t i = 0; i < t_CallSiteCount; i++)
+	{
+		if (t_CallSiteInfos[i].line == t_AllocLine && strcmp(t_CallSiteInfos[i].file, __FILE__) == 0)
+		{
+			t_FoundCallSite = true;
+			EXPECT_EQ(t_CallSiteInfos[i].allocator, &t_Allocator);
+			EXPECT_EQ(t_CallSiteInfos[i].allocCount, ALLOCATION_COUNT);
+			EXPECT_EQ(t_CallSiteInfos[i].liveBytes, ALLOCATION_SIZE * ALLOCATION_COUNT / 2);
+		}
+	}
+	EXPECT_TRUE(t_FoundCallSite);
+	BB::BBfreeArr(t_Allocator, t_CallSiteInfos);
+#endif //_DEBUG || BB_HEAP_PROFILER
+
+	//The last frame holds all the allocations, other tests might allocate in it too when profiling everything.
+	BB::HeapProfileFrame t_Frames[2];
+	ASSERT_EQ(BB::HeapProfiler::GetFrameHistory(t_Frames, 2), 2u);
+	EXPECT_GE(t_Frames[1].allocCount, ALLOCATION_COUNT);
+	EXPECT_GE(t_Frames[1].allocBytes, ALLOCATION_SIZE * ALLOCATION_COUNT);
+	EXPECT_EQ(t_Frames[1].frameNumber, t_Frames[0].frameNumber + 1);
+
+	ASSERT_TRUE(BB::HeapProfiler::DumpToFile(PROFILE_NAME));
+	BB::Buffer t_Profile = BB::ReadOSFile(t_Allocator, PROFILE_NAME);
+	ASSERT_GE(t_Profile.size, sizeof(BB::HeapProfileFileHeader));
+	//The read buffer has no alignment for the header, so copy it out.
+	BB::HeapProfileFileHeader t_Header;
+	memcpy(&t_Header, t_Profile.data, sizeof(t_Header));
+	EXPECT_EQ(t_Header.magic, BB::HEAP_PROFILE_MAGIC);
+	EXPECT_EQ(t_Header.version, BB::HEAP_PROFILE_VERSION);
+	EXPECT_GE(t_Header.allocatorCount, 1u);
+	EXPECT_EQ(t_Profile.size, sizeof(BB::HeapProfileFileHeader) +
+		sizeof(BB::HeapProfileCallSite) * t_Header.callSiteCount +
+		sizeof(BB::HeapProfileAllocator) * t_Header.allocatorCount +
+		sizeof(BB::HeapProfileTag) * t_Header.tagCount +
+		sizeof(BB::HeapProfileFrame) * t_Header.frameCount +
+		t_Header.stringTableSize);
+	BB::BBfreeArr(t_Allocator, t_Profile.data);
+
+	for (size_t i = 0; i < ALLOCATION_COUNT / 2; i++)
+		BB::HeapProfiler::Free(t_Interface, t_Allocations[i]);
+}
+#pragma endregion //HEAP_PROFILER
@@ -0,0 +1,309 @@
+#pragma once
+#include "../TestValues.h"
+#include "BBAsyncIO.hpp"
+#include "OS/Program.h"
+#include <chrono>
+
+constexpr const char* ASYNC_IO_FILE_NAME = "ASYNCIOTEST.bin";
+constexpr const uint32_t ASYNC_IO_FILE_VALUES = 1024 * 1024;
+
+//Every uint32_t in the file is its own index, so any read can be checked by its offset.
+static void AsyncIO_CreateTestFile(BB::Allocator a_Allocator)
+{
+	BB::Buffer t_WriteBuffer;
+	t_WriteBuffer.size = ASYNC_IO_FILE_VALUES * sizeof(uint32_t);
+	t_WriteBuffer.data = reinterpret_cast<char*>(BBalloc(a_Allocator, t_WriteBuffer.size));
+	uint32_t* t_Values = reinterpret_cast<uint32_t*>(t_WriteBuffer.data);
+	for (uint32_t i = 0; i < ASYNC_IO_FILE_VALUES; i++)
+		t_Values[i] = i;
+
+	BB::OSFileHandle t_File = BB::CreateOSFile(ASYNC_IO_FILE_NAME);
+	BB::WriteToFile(t_File, t_WriteBuffer);
+	BB::CloseOSFile(t_File);
+}
+
+static void AsyncIO_AddOne(void* a_Param)
+{
+	reinterpret_cast<std::atomic<uint32_t>*>(a_Param)->fetch_add(1, std::memory_order_relaxed);
+}
+
+TEST(AsyncIO, Batched_Reads)
+{
+	constexpr const uint32_t READ_COUNT = 256;
+	constexpr const uint32_t READ_VALUES = 1024;
+
+	BB::LinearAllocator_t t_Allocator{ BB::mbSize * 8 };
+	AsyncIO_CreateTestFile(t_Allocator);
+	uint32_t* t_Buffers = BBnewArr(t_Allocator, READ_COUNT * READ_VALUES, uint32_t);
+
+	//Run it with io_uring if the OS has it and always with the thread pool.
+	for (const bool t_ForceThreadPool : { false, true })
+	{
+		BB::AsyncIO::InitAsyncIO(64, 4, t_ForceThreadPool);
+		BB::OSFileHandle t_File = BB::LoadOSFile(ASYNC_IO_FILE_NAME);
+
+		//More reads then the queue depth so that SubmitReads has to wait for space.
+		BB::AsyncReadRequest t_Requests[READ_COUNT];
+		uint32_t t_Seed = 12345;
+		for (uint32_t i = 0; i < READ_COUNT; i++)
+		{
+			t_Seed = t_Seed * 1664525u + 1013904223u;
+			t_Requests[i].file = t_File;
+			t_Requests[i].buffer = t_Buffers + i * READ_VALUES;
+			t_Requests[i].offset = static_cast<uint64_t>(t_Seed % (ASYNC_IO_FILE_VALUES - READ_VALUES)) * sizeof(uint32_t);
+			t_Requests[i].size = READ_VALUES * sizeof(uint32_t);
+		}
+
+		BB::JobCounter t_Counter;
+		BB::AsyncIO::SubmitReads(t_Requests, READ_COUNT, &t_Counter);
+		BB::Threads::WaitForCounter(t_Counter);
+
+		for (uint32_t i = 0; i < READ_COUNT; i++)
+		{
+			ASSERT_EQ(t_Requests[i].state.load(), BB::ASYNC_READ_STATE::DONE);
+			ASSERT_EQ(t_Requests[i].bytesRead, t_Requests[i].size);
+			const uint32_t t_FirstValue = static_cast<uint32_t>(t_Requests[i].offset / sizeof(uint32_t));
+			const uint32_t* t_Values = reinterpret_cast<const uint32_t*>(t_Requests[i].buffer);
+			for (uint32_t j = 0; j < READ_VALUES; j++)
+				ASSERT_EQ(t_Values[j], t_FirstValue + j) << "async read returned the wrong bytes";
+		}
+
+		BB::CloseOSFile(t_File);
+		BB::AsyncIO::DestroyAsyncIO();
+	}
+	EXPECT_EQ(BB::AsyncIO::GetBackend(), BB::ASYNC_IO_BACKEND::NONE);
+
+	t_Allocator.Clear();
+}
+
+TEST(AsyncIO, End_Of_File_And_Completion_Jobs)
+{
+	BB::LinearAllocator_t t_Allocator{ BB::mbSize * 8 };
+	AsyncIO_CreateTestFile(t_Allocator);
+
+	for (const bool t_ForceThreadPool : { false, true })
+	{
+		BB::AsyncIO::InitAsyncIO(16, 2, t_ForceThreadPool);
+		BB::OSFileHandle t_File = BB::LoadOSFile(ASYNC_IO_FILE_NAME);
+
+		uint32_t t_Tail[8]{};
+		std::atomic<uint32_t> t_CompletionJobs{ 0 };
+		BB::AsyncReadRequest t_Requests[2];
+		//Starts 4 values before the end of the file, so only half of it is read.
+		t_Requests[0].file = t_File;
+		t_Requests[0].buffer = t_Tail;
+		t_Requests[0].offset = (ASYNC_IO_FILE_VALUES - 4) * sizeof(uint32_t);
+		t_Requests[0].size = sizeof(t_Tail);
+		t_Requests[0].completionJob = AsyncIO_AddOne;
+		t_Requests[0].completionParameter = &t_CompletionJobs;
+		//Completely past the end of the file.
+		t_Requests[1].file = t_File;
+		t_Requests[1].buffer = t_Tail + 4;
+		t_Requests[1].offset = ASYNC_IO_FILE_VALUES * sizeof(uint32_t) * 2;
+		t_Requests[1].size = sizeof(uint32_t);
+		t_Requests[1].completionJob = AsyncIO_AddOne;
+		t_Requests[1].completionParameter = &t_CompletionJobs;
+
+		BB::JobCounter t_Counter;
+		BB::AsyncIO::SubmitReads(t_Requests, 2, &t_Counter);
+		//The counter also covers the completion jobs.
+		BB::Threads::WaitForCounter(t_Counter);
+		EXPECT_EQ(t_CompletionJobs.load(), 2u);
+
+		EXPECT_EQ(t_Requests[0].state.load(), BB::ASYNC_READ_STATE::DONE);
+		EXPECT_EQ(t_Requests[0].bytesRead, 4 * sizeof(uint32_t));
+		EXPECT_EQ(t_Tail[3], ASYNC_IO_FILE_VALUES - 1);
+		EXPECT_EQ(t_Requests[1].state.load(), BB::ASYNC_READ_STATE::DONE);
+		EXPECT_EQ(t_Requests[1].bytesRead, 0u);
+
+		//A request can be submitted again once it is done, without a counter.
+		t_Requests[0].completionJob = nullptr;
+		t_Requests[0].offset = 0;
+		BB::AsyncIO::SubmitReads(t_Requests, 1);
+		BB::AsyncIO::WaitForRead(t_Requests[0]);
+		EXPECT_EQ(t_Requests[0].bytesRead, sizeof(t_Tail));
+		EXPECT_EQ(t_Tail[7], 7u);
+
+		BB::CloseOSFile(t_File);
+		BB::AsyncIO::DestroyAsyncIO();
+	}
+
+	t_Allocator.Clear();
+}
+
+TEST(AsyncIO, Oversized_Read_Fails)
+{
+	BB::LinearAllocator_t t_Allocator{ BB::mbSize * 8 };
+	AsyncIO_CreateTestFile(t_Allocator);
+
+	for (const bool t_ForceThreadPool : { false, true })
+	{
+		BB::AsyncIO::InitAsyncIO(16, 2, t_ForceThreadPool);
+		BB::OSFileHandle t_File = BB::LoadOSFile(ASYNC_IO_FILE_NAME);
+
+		uint32_t t_Values[2]{};
+		std::atomic<uint32_t> t_CompletionJobs{ 0 };
+		//The oversized read is between two normal reads, it may not stop them from being read.
+		BB::AsyncReadRequest t_Requests[3];
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			t_Requests[i].file = t_File;
+			t_Requests[i].buffer = &t_Values[i / 2];
+			t_Requests[i].offset = (i + 1) * sizeof(uint32_t);
+			t_Requests[i].size = sizeof(uint32_t);
+			t_Requests[i].completionJob = AsyncIO_AddOne;
+			t_Requests[i].completionParameter = &t_CompletionJobs;
+		}
+		t_Requests[1].size = BB::ASYNC_READ_MAX_SIZE + 1;
+
+		BB::JobCounter t_Counter;
+		BB::AsyncIO::SubmitReads(t_Requests, 3, &t_Counter);
+		BB::Threads::WaitForCounter(t_Counter);
+		EXPECT_EQ(t_CompletionJobs.load(), 3u);
+
+		EXPECT_EQ(t_Requests[1].state.load(), BB::ASYNC_READ_STATE::FAILED);
+		EXPECT_EQ(t_Requests[1].bytesRead, 0u);
+		EXPECT_EQ(t_Requests[0].state.load(), BB::ASYNC_READ_STATE::DONE);
+		EXPECT_EQ(t_Requests[2].state.load(), BB::ASYNC_READ_STATE::DONE);
+		EXPECT_EQ(t_Values[0], 1u);
+		EXPECT_EQ(t_Values[1], 3u);
+
+		BB::CloseOSFile(t_File);
+		BB::AsyncIO::DestroyAsyncIO();
+	}
+
+	t_Allocator.Clear();
+}
+
+constexpr const uint32_t ASYNC_IO_SUBMIT_THREADS = 4;
+constexpr const uint32_t ASYNC_IO_THREAD_READS = 128;
+constexpr const uint32_t ASYNC_IO_THREAD_READ_VALUES = 256;
+
+struct AsyncIO_SubmitThreadParam
+{
+	BB::OSFileHandle file;
+	uint32_t* buffers;
+	uint32_t seed;
+	uint32_t failures;
+};
+
+//Every thread submits more reads then the queue depth, a thread waiting for space may not stop the others from submitting.
+static void AsyncIO_SubmitThread(void* a_Param)
+{
+	AsyncIO_SubmitThreadParam& t_Param = *reinterpret_cast<AsyncIO_SubmitThreadParam*>(a_Param);
+	BB::AsyncReadRequest t_Requests[ASYNC_IO_THREAD_READS];
+	for (uint32_t i = 0; i < ASYNC_IO_THREAD_READS; i++)
+	{
+		t_Param.seed = t_Param.seed * 1664525u + 1013904223u;
+		t_Requests[i].file = t_Param.file;
+		t_Requests[i].buffer = t_Param.buffers + i * ASYNC_IO_THREAD_READ_VALUES;
+		t_Requests[i].offset = static_cast<uint64_t>(t_Param.seed % (ASYNC_IO_FILE_VALUES - ASYNC_IO_THREAD_READ_VALUES)) * sizeof(uint32_t);
+		t_Requests[i].size = ASYNC_IO_THREAD_READ_VALUES * sizeof(uint32_t);
+	}
+
+	BB::JobCounter t_Counter;
+	BB::AsyncIO::SubmitReads(t_Requests, ASYNC_IO_THREAD_READS, &t_Counter);
+	BB::Threads::WaitForCounter(t_Counter);
+
+	t_Param.failures = 0;
+	for (uint32_t i = 0; i < ASYNC_IO_THREAD_READS; i++)
+	{
+		const uint32_t t_FirstValue = static_cast<uint32_t>(t_Requests[i].offset / sizeof(uint32_t));
+		const uint32_t* t_Values = reinterpret_cast<const uint32_t*>(t_Requests[i].buffer);
+		if (t_Requests[i].state.load() != BB::ASYNC_READ_STATE::DONE || t_Values[ASYNC_IO_THREAD_READ_VALUES - 1] != t_FirstValue + ASYNC_IO_THREAD_READ_VALUES - 1)
+			++t_Param.failures;
+	}
+}
+
+TEST(AsyncIO, Reads_From_Threads)
+{
+	BB::LinearAllocator_t t_Allocator{ BB::mbSize * 8 };
+	AsyncIO_CreateTestFile(t_Allocator);
+	uint32_t* t_Buffers = BBnewArr(t_Allocator, ASYNC_IO_SUBMIT_THREADS * ASYNC_IO_THREAD_READS * ASYNC_IO_THREAD_READ_VALUES, uint32_t);
+
+	for (const bool t_ForceThreadPool : { false, true })
+	{
+		BB::AsyncIO::InitAsyncIO(8, 2, t_ForceThreadPool);
+		BB::OSFileHandle t_File = BB::LoadOSFile(ASYNC_IO_FILE_NAME);
+
+		AsyncIO_SubmitThreadParam t_Params[ASYNC_IO_SUBMIT_THREADS];
+		BB::OSThreadHandle t_Threads[ASYNC_IO_SUBMIT_THREADS];
+		for (uint32_t i = 0; i < ASYNC_IO_SUBMIT_THREADS; i++)
+		{
+			t_Params[i].file = t_File;
+			t_Params[i].buffers = t_Buffers + i * ASYNC_IO_THREAD_READS * ASYNC_IO_THREAD_READ_VALUES;
+			t_Params[i].seed = i + 1;
+			t_Params[i].failures = ASYNC_IO_THREAD_READS;
+			t_Threads[i] = BB::OSCreateThread(AsyncIO_SubmitThread, 0, &t_Params[i]);
+		}
+		for (uint32_t i = 0; i < ASYNC_IO_SUBMIT_THREADS; i++)
+			BB::OSWaitThreadfinish(t_Threads[i]);
+
+		for (uint32_t i = 0; i < ASYNC_IO_SUBMIT_THREADS; i++)
+			EXPECT_EQ(t_Params[i].failures, 0u) << "Thread " << i << " got a wrong or failed read.";
+
+		BB::CloseOSFile(t_File);
+		BB::AsyncIO::DestroyAsyncIO();
+	}
+
+	t_Allocator.Clear();
+}
+
+TEST(AsyncIO, AsyncIO_Speedtest)
+{
+	typedef std::chrono::duration<float, std::milli> ms;
+	constexpr const float MILLITIMEDIVIDE = 1 / 1000.f;
+	constexpr const uint32_t READ_COUNT = 1024;
+	constexpr const uint32_t READ_SIZE = BB::kbSize * 4;
+
+	BB::LinearAllocator_t t_Allocator{ BB::mbSize * 16 };
+	AsyncIO_CreateTestFile(t_Allocator);
+	char* t_Buffers = BBnewArr(t_Allocator, READ_COUNT * READ_SIZE, char);
+	uint64_t t_Offsets[READ_COUNT];
+	uint32_t t_Seed = 777;
+	for (uint32_t i = 0; i < READ_COUNT; i++)
+	{
+		t_Seed = t_Seed * 1664525u + 1013904223u;
+		t_Offsets[i] = static_cast<uint64_t>(t_Seed % (ASYNC_IO_FILE_VALUES * sizeof(uint32_t) / READ_SIZE)) * READ_SIZE;
+	}
+
+	std::cout << "/-----------------------------------------/" << "\n" << READ_COUNT << " reads of " << READ_SIZE << " bytes at random offsets, with time in MS:" << "\n";
+	BB::OSFileHandle t_File = BB::LoadOSFile(ASYNC_IO_FILE_NAME);
+
+	auto t_Timer = std::chrono::high_resolution_clock::now();
+	for (uint32_t i = 0; i < READ_COUNT; i++)
+	{
+		uint64_t t_BytesRead;
+		BB::ReadOSFileAt(t_File, t_Buffers + i * READ_SIZE, READ_SIZE, t_Offsets[i], t_BytesRead);
+	}
+	auto t_Speed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+	std::cout << "blocking reads one by one: " << t_Speed << "\n";
+
+	BB::AsyncReadRequest* t_Requests = BBnewArr(t_Allocator, READ_COUNT, BB::AsyncReadRequest);
+	for (const bool t_ForceThreadPool : { false, true })
+	{
+		BB::AsyncIO::InitAsyncIO(128, 4, t_ForceThreadPool);
+		for (uint32_t i = 0; i < READ_COUNT; i++)
+		{
+			new (&t_Requests[i]) BB::AsyncReadRequest();
+			t_Requests[i].file = t_File;
+			t_Requests[i].buffer = t_Buffers + i * READ_SIZE;
+			t_Requests[i].offset = t_Offsets[i];
+			t_Requests[i].size = READ_SIZE;
+		}
+
+		t_Timer = std::chrono::high_resolution_clock::now();
+		BB::JobCounter t_Counter;
+		BB::AsyncIO::SubmitReads(t_Requests, READ_COUNT, &t_Counter);
+		BB::Threads::WaitForCounter(t_Counter);
+		t_Speed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+		std::cout << (BB::AsyncIO::GetBackend() == BB::ASYNC_IO_BACKEND::IO_URING ? "async io_uring: " : "async thread pool: ") << t_Speed << "\n";
+
+		for (uint32_t i = 0; i < READ_COUNT; i++)
+			ASSERT_EQ(t_Requests[i].bytesRead, READ_SIZE);
+		BB::AsyncIO::DestroyAsyncIO();
+	}
+
+	BB::CloseOSFile(t_File);
+	t_Allocator.Clear();
+}
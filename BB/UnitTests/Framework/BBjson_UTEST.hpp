@@ -3,6 +3,10 @@
 #include "BBJson.hpp"
 #include "BBMain.h"
 #include "BBString.h"
+#include "OS/Program.h"
+#include <vector>
+#include <string>
+#include <chrono>
 
 TEST(BBjson, Small_Local_Memory_JSON)
 {
@@ -73,4 +77,362 @@ TEST(BBjson, Big_Disk_JSON)
 	//call the destructor as I want to clear the allocator.
 	t_JsonString.~Basic_String();
 	t_Allocator.Clear();
-}
\ No newline at end of file
+}
+
+//One character at a time, only here to check the SIMD structural index against.
+static std::vector<uint32_t> ScalarJsonStructurals(const char* a_Data, const size_t a_Size)
+{
+	std::vector<uint32_t> t_Positions;
+	bool t_InString = false;
+	bool t_PrevScalar = false;
+	for (size_t i = 0; i < a_Size; i++)
+	{
+		const char t_C = a_Data[i];
+		if (t_InString)
+		{
+			if (t_C == '\\')
+				++i;
+			else if (t_C == '"')
+				t_InString = false;
+			continue;
+		}
+
+		const bool t_Op = t_C == '{' || t_C == '}' || t_C == '[' || t_C == ']' || t_C == ':' || t_C == ',';
+		const bool t_Whitespace = t_C == ' ' || t_C == '\t' || t_C == '\n' || t_C == '\r';
+		if (t_C == '"')
+		{
+			if (!t_PrevScalar)
+				t_Positions.push_back(static_cast<uint32_t>(i));
+			t_InString = true;
+			t_PrevScalar = false;
+		}
+		else if (t_Op)
+			t_Positions.push_back(static_cast<uint32_t>(i));
+		else if (!t_Whitespace && !t_PrevScalar)
+			t_Positions.push_back(static_cast<uint32_t>(i));
+
+		t_PrevScalar = !t_Op && !t_Whitespace && t_C != '"';
+	}
+	return t_Positions;
+}
+
+TEST(BBjson, Structural_Index_Equals_Scalar)
+{
+	BB::FreelistAllocator_t t_Allocator{ BB::mbSize * 4 };
+
+	//Escapes and backslash runs around the 64 byte block edges.
+	std::string t_Json = "{\"a\\\"b\": [1, -2.5e3, true, false, null], \"c\\\\\": \"{[,:]}\", \"d\": {\"e\": \"\\\\\\\"\"}}";
+	for (uint32_t i = 0; i < 256; i++)
+	{
+		t_Json += ", \"key";
+		t_Json.append(i % 7, '\\');
+		t_Json.append((i % 7) & 1 ? "\"" : "");
+		t_Json += "\": [";
+		t_Json += std::to_string(i * 31);
+		t_Json += ",\"x\\\\\",{}]";
+	}
+
+	for (size_t t_Size = 1; t_Size < t_Json.size(); t_Size += 37)
+	{
+		const std::vector<uint32_t> t_Expected = ScalarJsonStructurals(t_Json.data(), t_Size);
+		const BB::JsonStructuralIndex t_Index = BB::BuildJsonStructuralIndex(t_Allocator, t_Json.data(), t_Size);
+		ASSERT_EQ(t_Index.count, t_Expected.size()) << "size " << t_Size;
+		for (uint32_t i = 0; i < t_Index.count; i++)
+			ASSERT_EQ(t_Index.positions[i], t_Expected[i]) << "size " << t_Size << " structural " << i;
+		EXPECT_EQ(t_Index.positions[t_Index.count], t_Size);
+		BB::BBfreeArr(t_Allocator, t_Index.positions);
+	}
+}
+
+TEST(BBjson, On_Demand_Document)
+{
+	char t_JsonFile[] = R"(
+{
+  "name": "on demand",
+  "skip": { "nested": [ { "deep": [1, 2, {"a": 3}] } ], "more": "}]" },
+  "numbers": [0, -17, 3.25, 1e3, -2.5E-2, 12345678901234],
+  "flags": [true, false, null],
+  "empty_list": [],
+  "empty_object": {},
+  "nodes": [ { "name": "first", "mesh": 4 }, { "name": "second", "children": [1, 2] } ]
+}
+	)";
+
+	BB::Buffer t_JsonBuffer{ t_JsonFile,  _countof(t_JsonFile) };
+	BB::JsonDocument t_Document(t_JsonBuffer);
+	const BB::JsonValue t_Root = t_Document.GetRoot();
+	ASSERT_TRUE(t_Root.IsValid());
+	EXPECT_EQ(t_Root.GetType(), BB::JSON_TYPE::OBJECT);
+	EXPECT_EQ(t_Root.GetCount(), 7u);
+
+	const BB::Slice<const char> t_Name = t_Root.Find("name").GetString();
+	EXPECT_EQ(std::string(t_Name.data(), t_Name.size()), "on demand");
+	EXPECT_EQ(t_Root.Find("name").GetStringID(), BB::MakeStringID("on demand"));
+	EXPECT_FALSE(t_Root.Find("nested").IsValid());
+	EXPECT_FALSE(t_Root.Find("does not exist").IsValid());
+
+	const BB::JsonValue t_Numbers = t_Root.Find(BB::MakeStringID("numbers"));
+	ASSERT_EQ(t_Numbers.GetCount(), 6u);
+	EXPECT_EQ(t_Numbers.GetElement(0).GetInteger(), 0);
+	EXPECT_EQ(t_Numbers.GetElement(1).GetInteger(), -17);
+	EXPECT_FLOAT_EQ(t_Numbers.GetElement(2).GetNumber(), 3.25f);
+	EXPECT_EQ(t_Numbers.GetElement(3).GetInteger(), 1000);
+	EXPECT_DOUBLE_EQ(t_Numbers.GetElement(4).GetDouble(), -0.025);
+	EXPECT_EQ(t_Numbers.GetElement(5).GetInteger(), 12345678901234);
+	EXPECT_FALSE(t_Numbers.GetElement(6).IsValid());
+
+	const BB::JsonValue t_Flags = t_Root.Find("flags");
+	EXPECT_TRUE(t_Flags.GetElement(0).GetBoolean());
+	EXPECT_FALSE(t_Flags.GetElement(1).GetBoolean());
+	EXPECT_EQ(t_Flags.GetElement(2).GetType(), BB::JSON_TYPE::NULL_TYPE);
+
+	EXPECT_EQ(t_Root.Find("empty_list").GetCount(), 0u);
+	for (BB::JsonValue t_Element : t_Root.Find("empty_list").GetList())
+		ADD_FAILURE() << "empty list has an element at " << t_Element.GetIndex();
+	EXPECT_EQ(t_Root.Find("empty_object").GetCount(), 0u);
+	EXPECT_FALSE(t_Root.Find("empty_object").Find("name").IsValid());
+
+	uint32_t t_NodeCount = 0;
+	for (BB::JsonValue t_Node : t_Root.Find("nodes").GetList())
+	{
+		const BB::Slice<const char> t_NodeName = t_Node.Find("name").GetString();
+		EXPECT_EQ(std::string(t_NodeName.data(), t_NodeName.size()), t_NodeCount == 0 ? "first" : "second");
+		++t_NodeCount;
+	}
+	EXPECT_EQ(t_NodeCount, 2u);
+	EXPECT_EQ(t_Root.Find("nodes").GetElement(1).Find("children").GetCount(), 2u);
+}
+
+TEST(BBjson, Nested_Lists_And_Objects)
+{
+	//Lists of objects with nested objects, booleans and exponents in one tree.
+	char t_JsonFile[] = R"({"materials": [{"pbr": {"factor": [1, 0.5, 2.5e-1]}, "double": true}, {"pbr": {"factor": []}, "double": false}]})";
+
+	BB::Buffer t_JsonBuffer{ t_JsonFile,  _countof(t_JsonFile) - 1 };
+	BB::JsonParser t_Parser(t_JsonBuffer);
+	t_Parser.Parse();
+	const BB::JsonObject& t_Root = *t_Parser.GetRootNode()->GetObject();
+	const BB::JsonList t_Materials = (*t_Root.map.find(BB::MakeStringID("materials")))->GetList();
+	ASSERT_EQ(t_Materials.nodeCount, 2u);
+
+	const BB::JsonObject& t_First = *t_Materials.nodes[0]->GetObject();
+	const BB::JsonList t_Factor = (*(*t_First.map.find(BB::MakeStringID("pbr")))->GetObject()->map.find(BB::MakeStringID("factor")))->GetList();
+	ASSERT_EQ(t_Factor.nodeCount, 3u);
+	EXPECT_FLOAT_EQ(t_Factor.nodes[2]->GetNumber(), 0.25f);
+	EXPECT_TRUE((*t_First.map.find(BB::MakeStringID("double")))->GetBoolean());
+
+	const BB::JsonObject& t_Second = *t_Materials.nodes[1]->GetObject();
+	EXPECT_EQ((*(*t_Second.map.find(BB::MakeStringID("pbr")))->GetObject()->map.find(BB::MakeStringID("factor")))->GetList().nodeCount, 0u);
+	EXPECT_FALSE((*t_Second.map.find(BB::MakeStringID("double")))->GetBoolean());
+}
+
+//Writes every sax event to a string so that two parses can be compared.
+static BB::JsonSaxHandler MakeJsonSaxLogger(std::string& a_Log)
+{
+	BB::JsonSaxHandler t_Handler;
+	t_Handler.userData = &a_Log;
+	t_Handler.beginObject = [](void* a_Log) { *reinterpret_cast<std::string*>(a_Log) += "{"; return true; };
+	t_Handler.endObject = [](void* a_Log) { *reinterpret_cast<std::string*>(a_Log) += "}"; return true; };
+	t_Handler.beginList = [](void* a_Log) { *reinterpret_cast<std::string*>(a_Log) += "["; return true; };
+	t_Handler.endList = [](void* a_Log) { *reinterpret_cast<std::string*>(a_Log) += "]"; return true; };
+	t_Handler.key = [](void* a_Log, const BB::Slice<const char> a_Key)
+	{
+		*reinterpret_cast<std::string*>(a_Log) += "k:" + std::string(a_Key.data(), a_Key.size()) + " ";
+		return true;
+	};
+	t_Handler.string = [](void* a_Log, const BB::Slice<const char> a_String)
+	{
+		*reinterpret_cast<std::string*>(a_Log) += "s:" + std::string(a_String.data(), a_String.size()) + " ";
+		return true;
+	};
+	t_Handler.number = [](void* a_Log, const double a_Number) { *reinterpret_cast<std::string*>(a_Log) += "n:" + std::to_string(a_Number) + " "; return true; };
+	t_Handler.boolean = [](void* a_Log, const bool a_Boolean) { *reinterpret_cast<std::string*>(a_Log) += a_Boolean ? "true " : "false "; return true; };
+	t_Handler.null = [](void* a_Log) { *reinterpret_cast<std::string*>(a_Log) += "null "; return true; };
+	return t_Handler;
+}
+
+TEST(BBjson, SAX_Events)
+{
+	char t_JsonFile[] = R"({"name": "a \"quoted\" name", "values": [1, -2.5, 3e2,], "flags": {"on": true, "off": false, "none": null}, "empty": [], "nested": [[{}]]})";
+
+	BB::FreelistAllocator_t t_Allocator{ BB::kbSize * 16 };
+	BB::JsonSaxParser t_Parser(t_Allocator);
+	std::string t_Log;
+	ASSERT_TRUE(t_Parser.Parse(BB::Buffer{ t_JsonFile, _countof(t_JsonFile) }, MakeJsonSaxLogger(t_Log)));
+	EXPECT_EQ(t_Log, "{k:name s:a \\\"quoted\\\" name k:values [n:1.000000 n:-2.500000 n:300.000000 ]"
+		"k:flags {k:on true k:off false k:none null }k:empty []k:nested [[{}]]}");
+
+	//Only listen to numbers, the other events are skipped.
+	double t_Sum = 0;
+	BB::JsonSaxHandler t_Handler;
+	t_Handler.userData = &t_Sum;
+	t_Handler.number = [](void* a_Sum, const double a_Number) { *reinterpret_cast<double*>(a_Sum) += a_Number; return true; };
+	ASSERT_TRUE(t_Parser.Parse(BB::Buffer{ t_JsonFile, _countof(t_JsonFile) }, t_Handler));
+	EXPECT_EQ(t_Sum, 298.5);
+
+	//An event can stop the parse.
+	t_Handler.number = [](void*, const double) { return false; };
+	EXPECT_FALSE(t_Parser.Parse(BB::Buffer{ t_JsonFile, _countof(t_JsonFile) }, t_Handler));
+}
+
+TEST(BBjson, SAX_Invalid_Json)
+{
+	BB::FreelistAllocator_t t_Allocator{ BB::kbSize * 16 };
+	BB::JsonSaxParser t_Parser(t_Allocator);
+	const BB::JsonSaxHandler t_Handler;
+	const char* t_Invalid[] =
+	{
+		R"({"key" 1})",
+		R"({"key": 1)",
+		R"([1, 2] 3)",
+		R"({"key": tru})",
+		R"([1 2])",
+		R"({1: 2})",
+		R"(["unclosed])",
+		R"(})",
+		""
+	};
+
+	for (const char* t_Json : t_Invalid)
+		EXPECT_FALSE(t_Parser.Parse(BB::Buffer{ const_cast<char*>(t_Json), strlen(t_Json) }, t_Handler)) << t_Json << " is accepted";
+}
+
+TEST(BBjson, SAX_Chunked_File_Equals_Memory)
+{
+	const char* t_GLTFPath = "Resources/Models/Sponza.gltf";
+	BB::FreelistAllocator_t t_Allocator{ BB::mbSize * 4 };
+	const BB::Buffer t_File = BB::ReadOSFile(t_Allocator, t_GLTFPath);
+	ASSERT_NE(t_File.size, 0u);
+
+	std::string t_MemoryLog;
+	{
+		BB::JsonSaxParser t_Parser(t_Allocator);
+		ASSERT_TRUE(t_Parser.Parse(t_File, MakeJsonSaxLogger(t_MemoryLog)));
+	}
+
+	//Small chunks so that a lot of strings and numbers are cut in half by a chunk border.
+	for (const size_t t_ChunkSize : { size_t(128), size_t(1000), BB::JSON_SAX_DEFAULT_CHUNK_SIZE })
+	{
+		BB::JsonSaxParser t_Parser(t_Allocator, t_ChunkSize);
+		std::string t_FileLog;
+		ASSERT_TRUE(t_Parser.Parse(t_GLTFPath, MakeJsonSaxLogger(t_FileLog))) << "chunk size " << t_ChunkSize;
+		EXPECT_TRUE(t_FileLog == t_MemoryLog) << "chunk size " << t_ChunkSize << " gives different events";
+	}
+
+	//A string longer then the chunk can not be parsed.
+	{
+		BB::JsonSaxParser t_Parser(t_Allocator, 16);
+		EXPECT_FALSE(t_Parser.Parse(t_GLTFPath, BB::JsonSaxHandler()));
+	}
+
+	BB::BBfree(t_Allocator, t_File.data);
+}
+
+TEST(BBjson, JSON_Speedtest)
+{
+	typedef std::chrono::duration<float, std::milli> ms;
+	constexpr const float MILLITIMEDIVIDE = 1 / 1000.f;
+	constexpr const uint32_t RUNS = 16;
+	const char* t_GLTFPath = "Resources/Models/Sponza.gltf";
+
+	BB::FreelistAllocator_t t_Allocator{ BB::mbSize * 4 };
+	const BB::Buffer t_File = BB::ReadOSFile(t_Allocator, t_GLTFPath);
+	ASSERT_NE(t_File.size, 0u);
+
+	std::cout << "/-----------------------------------------/" << "\n" << "Json parse " << t_GLTFPath << " " << t_File.size << " bytes " << RUNS << " times with time in MS:" << "\n";
+
+	auto t_Timer = std::chrono::high_resolution_clock::now();
+	uint32_t t_DomAccessors = 0;
+	for (uint32_t i = 0; i < RUNS; i++)
+	{
+		BB::JsonParser t_Parser(t_File);
+		t_Parser.Parse();
+		t_DomAccessors += (*t_Parser.GetRootNode()->GetObject()->map.find(BB::MakeStringID("accessors")))->GetList().nodeCount;
+	}
+	auto t_Speed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+	std::cout << "JsonParser full JsonNode tree: " << t_Speed << "\n";
+
+	t_Timer = std::chrono::high_resolution_clock::now();
+	for (uint32_t i = 0; i < RUNS; i++)
+	{
+		BB::JsonDocument t_Document(t_File);
+	}
+	t_Speed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+	std::cout << "JsonDocument structural index only: " << t_Speed << "\n";
+
+	t_Timer = std::chrono::high_resolution_clock::now();
+	uint32_t t_OnDemandAccessors = 0;
+	uint64_t t_VertexCount = 0;
+	for (uint32_t i = 0; i < RUNS; i++)
+	{
+		BB::JsonDocument t_Document(t_File);
+		for (BB::JsonValue t_Accessor : t_Document.GetRoot().Find("accessors").GetList())
+		{
+			t_VertexCount += static_cast<uint64_t>(t_Accessor.Find("count").GetInteger());
+			++t_OnDemandAccessors;
+		}
+	}
+	t_Speed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+	std::cout << "JsonDocument on demand read of every accessor count: " << t_Speed << "\n";
+
+	//Counts the accessor count fields, a sax handler has to track where it is by itself.
+	struct SaxAccessorCounter
+	{
+		uint32_t depth = 0;
+		uint32_t accessorDepth = 0;
+		bool nextIsCount = false;
+		uint32_t accessors = 0;
+		uint64_t vertexCount = 0;
+	};
+	BB::JsonSaxHandler t_SaxHandler;
+	t_SaxHandler.beginObject = [](void* a_Counter) { ++reinterpret_cast<SaxAccessorCounter*>(a_Counter)->depth; return true; };
+	t_SaxHandler.endObject = [](void* a_Counter) { --reinterpret_cast<SaxAccessorCounter*>(a_Counter)->depth; return true; };
+	t_SaxHandler.beginList = t_SaxHandler.beginObject;
+	t_SaxHandler.endList = [](void* a_Counter)
+	{
+		SaxAccessorCounter* t_Counter = reinterpret_cast<SaxAccessorCounter*>(a_Counter);
+		if (t_Counter->depth-- == t_Counter->accessorDepth)
+			t_Counter->accessorDepth = 0;
+		return true;
+	};
+	t_SaxHandler.key = [](void* a_Counter, const BB::Slice<const char> a_Key)
+	{
+		SaxAccessorCounter* t_Counter = reinterpret_cast<SaxAccessorCounter*>(a_Counter);
+		const std::string t_Key(a_Key.data(), a_Key.size());
+		if (t_Counter->depth == 1 && t_Key == "accessors")
+			t_Counter->accessorDepth = 2;
+		t_Counter->nextIsCount = t_Counter->accessorDepth != 0 && t_Counter->depth == 3 && t_Key == "count";
+		return true;
+	};
+	t_SaxHandler.number = [](void* a_Counter, const double a_Number)
+	{
+		SaxAccessorCounter* t_Counter = reinterpret_cast<SaxAccessorCounter*>(a_Counter);
+		if (t_Counter->nextIsCount)
+		{
+			t_Counter->vertexCount += static_cast<uint64_t>(a_Number);
+			++t_Counter->accessors;
+			t_Counter->nextIsCount = false;
+		}
+		return true;
+	};
+
+	t_Timer = std::chrono::high_resolution_clock::now();
+	SaxAccessorCounter t_SaxCounter;
+	{
+		BB::JsonSaxParser t_SaxParser(t_Allocator);
+		for (uint32_t i = 0; i < RUNS; i++)
+		{
+			t_SaxCounter = SaxAccessorCounter();
+			t_SaxHandler.userData = &t_SaxCounter;
+			t_SaxParser.Parse(t_GLTFPath, t_SaxHandler);
+		}
+	}
+	t_Speed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+	std::cout << "JsonSaxParser streaming from disk in " << BB::JSON_SAX_DEFAULT_CHUNK_SIZE / BB::kbSize << "KB chunks: " << t_Speed << "\n";
+
+	EXPECT_EQ(t_DomAccessors, t_OnDemandAccessors);
+	EXPECT_EQ(t_SaxCounter.accessors * RUNS, t_OnDemandAccessors);
+	EXPECT_EQ(t_SaxCounter.vertexCount * RUNS, t_VertexCount);
+	EXPECT_NE(t_VertexCount, 0u);
+	BB::BBfree(t_Allocator, t_File.data);
+}
@@ -99,4 +99,36 @@ TEST(Program_IO, Read_Write_Files_Same_File)
 	ASSERT_STREQ(t_TestText, DOC_DATA);
 
 	t_Allocator.Clear();
+}
+
+TEST(Program_IO, Map_Files)
+{
+	constexpr char* DOC_NAME = "MAPTEST.txt";
+	constexpr char* DOC_DATA = "HELLO WORLD! I'm a BB engine unit test for memory mapping files.";
+
+	BB::OSFileHandle t_TestFile = BB::CreateOSFile(DOC_NAME);
+
+	BB::Buffer t_WriteBuffer;
+	t_WriteBuffer.size = strnlen_s(DOC_DATA, 1024);
+	t_WriteBuffer.data = DOC_DATA;
+	BB::WriteToFile(t_TestFile, t_WriteBuffer);
+
+	BB::CloseOSFile(t_TestFile);
+
+	//Every hint should give the same bytes, they only change how the OS reads ahead.
+	const BB::OS_FILE_ACCESS_HINT t_Hints[] = { BB::OS_FILE_ACCESS_HINT::NORMAL, BB::OS_FILE_ACCESS_HINT::SEQUENTIAL, BB::OS_FILE_ACCESS_HINT::RANDOM };
+	for (const BB::OS_FILE_ACCESS_HINT t_Hint : t_Hints)
+	{
+		const BB::Buffer t_Mapping = BB::MapOSFile(DOC_NAME, t_Hint);
+		ASSERT_NE(t_Mapping.data, nullptr) << "failed to map a file";
+		ASSERT_EQ(t_Mapping.size, t_WriteBuffer.size);
+		EXPECT_EQ(memcmp(t_Mapping.data, DOC_DATA, t_Mapping.size), 0) << "mapped file is not the same as the written file";
+		BB::UnmapOSFile(t_Mapping);
+	}
+
+	//A missing file is not an error that stops the program, the buffer is just empty.
+	const BB::Buffer t_Missing = BB::MapOSFile("MAPTEST_DOES_NOT_EXIST.txt");
+	EXPECT_EQ(t_Missing.data, nullptr);
+	EXPECT_EQ(t_Missing.size, 0u);
+	BB::UnmapOSFile(t_Missing);
 }
\ No newline at end of file
@@ -0,0 +1,206 @@
+#pragma once
+#include "../TestValues.h"
+#include "Storage/HandleRegistry.h"
+#include "OS/Program.h"
+
+TEST(HandleRegistry_Datastructure, HandleRegistry_Insert_Erase_Find)
+{
+	constexpr const uint32_t samples = 1024;
+
+	//32 MB alloactor.
+	const size_t allocatorSize = BB::mbSize * 32;
+	BB::FreelistAllocator_t t_Allocator(allocatorSize);
+	{
+		BB::HandleRegistry<size2593bytesObj> t_Registry(t_Allocator, samples);
+		EXPECT_FALSE(t_Registry.valid(BB::RegistryHandle(0, 0))) << "An empty handle should never be valid.";
+
+		size2593bytesObj t_Value1{};
+		t_Value1.value = 500;
+		BB::RegistryHandle t_ID1 = t_Registry.insert(t_Value1);
+		ASSERT_EQ(t_Registry[t_ID1].value, t_Value1.value) << "Wrong element was likely grabbed.";
+		const size2593bytesObj* t_Ptr1 = t_Registry.find(t_ID1);
+
+		//Fill it up so new pages get allocated, the first object may not move.
+		BB::RegistryHandle t_IDs[samples - 1];
+		for (uint32_t i = 0; i < samples - 1; i++)
+			t_IDs[i] = t_Registry.emplace(static_cast<size_t>(i));
+		ASSERT_EQ(t_Registry.size(), samples);
+		ASSERT_EQ(t_Registry.find(t_ID1), t_Ptr1) << "Object moved while inserting.";
+		ASSERT_EQ(t_Ptr1->value, t_Value1.value);
+
+		t_Registry.erase(t_ID1);
+		EXPECT_FALSE(t_Registry.valid(t_ID1));
+		EXPECT_EQ(t_Registry.find(t_ID1), nullptr) << "Erased handle still finds an object.";
+
+		//The slot gets reused with a new generation, the old handle stays invalid.
+		size2593bytesObj t_Value2{};
+		t_Value2.value = 1000;
+		const BB::RegistryHandle t_ID2 = t_Registry.insert(t_Value2);
+		EXPECT_EQ(t_ID2.index, t_ID1.index);
+		EXPECT_NE(t_ID2.extraIndex, t_ID1.extraIndex);
+		EXPECT_EQ(t_Registry.find(t_ID1), nullptr);
+		ASSERT_EQ(t_Registry[t_ID2].value, t_Value2.value) << "Wrong element was likely grabbed.";
+
+		for (uint32_t i = 0; i < samples - 1; i++)
+			ASSERT_EQ(t_Registry[t_IDs[i]].value, i) << "Wrong element was likely grabbed.";
+
+		t_Registry.clear();
+		EXPECT_EQ(t_Registry.size(), 0);
+		EXPECT_EQ(t_Registry.find(t_ID2), nullptr);
+		EXPECT_EQ(t_Registry.find(t_IDs[0]), nullptr);
+	}
+	t_Allocator.Clear();
+}
+
+TEST(HandleRegistry_Datastructure, HandleRegistry_Erase_Iterator)
+{
+	constexpr const uint32_t samples = 1000;
+
+	BB::FreelistAllocator_t t_Allocator(BB::mbSize * 4);
+	{
+		BB::HandleRegistry<size_t> t_Registry(t_Allocator, samples);
+		BB::RegistryHandle t_IDs[samples];
+		for (uint32_t i = 0; i < samples; i++)
+			t_IDs[i] = t_Registry.emplace(static_cast<size_t>(i));
+
+		//Erase every third one, the rest should be iterated once each.
+		size_t t_ExpectedSum = 0;
+		uint32_t t_ExpectedCount = 0;
+		for (uint32_t i = 0; i < samples; i++)
+		{
+			if (i % 3 == 0)
+			{
+				t_Registry.erase(t_IDs[i]);
+			}
+			else
+			{
+				t_ExpectedSum += i;
+				++t_ExpectedCount;
+			}
+		}
+		ASSERT_EQ(t_Registry.size(), t_ExpectedCount);
+
+		size_t t_Sum = 0;
+		uint32_t t_Count = 0;
+		for (auto it = t_Registry.begin(); it < t_Registry.end(); it++)
+		{
+			t_Sum += *it;
+			++t_Count;
+			ASSERT_EQ(t_Registry.find(it.handle()), &*it) << "Iterator handle does not point to the iterated object.";
+		}
+		EXPECT_EQ(t_Count, t_ExpectedCount);
+		EXPECT_EQ(t_Sum, t_ExpectedSum);
+
+		for (uint32_t i = 0; i < samples; i++)
+		{
+			if (i % 3 == 0)
+			{
+				EXPECT_EQ(t_Registry.find(t_IDs[i]), nullptr);
+			}
+			else
+			{
+				ASSERT_EQ(t_Registry[t_IDs[i]], i);
+			}
+		}
+	}
+	t_Allocator.Clear();
+}
+
+constexpr const uint32_t REGISTRY_READER_COUNT = 4;
+constexpr const uint32_t REGISTRY_INSERT_COUNT = 100000;
+
+struct HandleRegistry_ThreadParam
+{
+	BB::HandleRegistry<uint64_t>* registry;
+	BB::RegistryHandle* handles;
+	std::atomic<uint32_t> published{ 0 };
+	std::atomic<bool> done{ false };
+	std::atomic<uint32_t> failures{ 0 };
+};
+
+//Reads the handles that are already inserted while the main thread keeps inserting and allocating pages.
+static void HandleRegistry_Reader(void* a_Param)
+{
+	HandleRegistry_ThreadParam* t_Param = reinterpret_cast<HandleRegistry_ThreadParam*>(a_Param);
+	uint32_t t_Random = 12345;
+	uint32_t t_Failures = 0;
+	while (!t_Param->done.load(std::memory_order_acquire))
+	{
+		const uint32_t t_Published = t_Param->published.load(std::memory_order_acquire);
+		if (t_Published == 0)
+			continue;
+		t_Random = t_Random * 1664525 + 1013904223;
+		const uint32_t t_Index = t_Random % t_Published;
+		const uint64_t* t_Value = t_Param->registry->find(t_Param->handles[t_Index]);
+		if (t_Value == nullptr || *t_Value != t_Index)
+			++t_Failures;
+	}
+	t_Param->failures.fetch_add(t_Failures);
+}
+
+TEST(HandleRegistry_Datastructure, HandleRegistry_Read_While_Inserting)
+{
+	BB::FreelistAllocator_t t_Allocator(BB::mbSize * 8);
+	{
+		BB::HandleRegistry<uint64_t> t_Registry(t_Allocator, REGISTRY_INSERT_COUNT);
+		BB::RegistryHandle* t_Handles = reinterpret_cast<BB::RegistryHandle*>(BBalloc(t_Allocator, sizeof(BB::RegistryHandle) * REGISTRY_INSERT_COUNT));
+
+		HandleRegistry_ThreadParam t_Param;
+		t_Param.registry = &t_Registry;
+		t_Param.handles = t_Handles;
+
+		BB::OSThreadHandle t_Threads[REGISTRY_READER_COUNT];
+		for (uint32_t i = 0; i < REGISTRY_READER_COUNT; i++)
+			t_Threads[i] = BB::OSCreateThread(HandleRegistry_Reader, 0, &t_Param);
+
+		for (uint32_t i = 0; i < REGISTRY_INSERT_COUNT; i++)
+		{
+			t_Handles[i] = t_Registry.emplace(static_cast<uint64_t>(i));
+			t_Param.published.store(i + 1, std::memory_order_release);
+		}
+		t_Param.done.store(true, std::memory_order_release);
+
+		for (uint32_t i = 0; i < REGISTRY_READER_COUNT; i++)
+			BB::OSWaitThreadfinish(t_Threads[i]);
+
+		EXPECT_EQ(t_Param.failures.load(), 0) << "A reader got a wrong object while the registry was growing.";
+		BB::BBfree(t_Allocator, t_Handles);
+	}
+	t_Allocator.Clear();
+}
+
+static void HandleRegistry_Increment(uint64_t& a_Object, const BB::RegistryHandle a_Handle, void* a_UserData)
+{
+	std::atomic<uint64_t>* t_Visits = reinterpret_cast<std::atomic<uint64_t>*>(a_UserData);
+	t_Visits->fetch_add(1, std::memory_order_relaxed);
+	a_Object += a_Handle.index;
+}
+
+TEST(HandleRegistry_Datastructure, HandleRegistry_ParallelForEach)
+{
+	constexpr const uint32_t samples = 10000;
+
+	BB::FreelistAllocator_t t_Allocator(BB::mbSize * 4);
+	{
+		BB::HandleRegistry<uint64_t> t_Registry(t_Allocator, samples);
+		BB::RegistryHandle t_IDs[samples];
+		for (uint32_t i = 0; i < samples; i++)
+			t_IDs[i] = t_Registry.emplace(static_cast<uint64_t>(0));
+		for (uint32_t i = 0; i < samples; i += 7)
+			t_Registry.erase(t_IDs[i]);
+
+		std::atomic<uint64_t> t_Visits{ 0 };
+		BB::Threads::WaitForTask(t_Registry.ParallelForEach(64, HandleRegistry_Increment, &t_Visits));
+		EXPECT_EQ(t_Visits.load(), t_Registry.size());
+
+		//Every object got its own index added once.
+		for (uint32_t i = 0; i < samples; i++)
+		{
+			if (i % 7 != 0)
+			{
+				ASSERT_EQ(t_Registry[t_IDs[i]], t_IDs[i].index);
+			}
+		}
+	}
+	t_Allocator.Clear();
+}
@@ -0,0 +1,278 @@
+#pragma once
+#include "../TestValues.h"
+#include "Utils/Hash.h"
+#include "Storage/Hashmap.h"
+#include <chrono>
+
+//The hashes that Hash.h used before, only here to compare against.
+static uint64_t OldStringHash(const char* a_String)
+{
+	uint64_t t_Hash = 5381;
+	int t_C;
+
+	while ((t_C = *a_String++))
+		t_Hash = ((t_Hash << 5) + t_Hash) + t_C;
+
+	return t_Hash;
+}
+
+static uint64_t OldIntegerHash(uint64_t a_Value)
+{
+	a_Value ^= a_Value << 13, a_Value ^= a_Value >> 17;
+	a_Value ^= a_Value << 5;
+	return a_Value;
+}
+
+static uint32_t CountBits(uint64_t a_Value)
+{
+	uint32_t t_Count = 0;
+	for (; a_Value != 0; a_Value &= a_Value - 1)
+		++t_Count;
+	return t_Count;
+}
+
+//Highest amount of keys in one of the buckets, a_Shift picks which bits of the hash are used for the bucket.
+template<typename HashFunc>
+static uint32_t MaxBucketLoad(const uint32_t a_KeyCount, const uint32_t a_BucketBits, const uint32_t a_Shift, HashFunc a_HashFunc)
+{
+	uint32_t t_Buckets[1 << 12]{};
+	uint32_t t_Max = 0;
+	for (uint32_t i = 0; i < a_KeyCount; i++)
+	{
+		const uint64_t t_Bucket = (a_HashFunc(i) >> a_Shift) & ((1ull << a_BucketBits) - 1);
+		if (++t_Buckets[t_Bucket] > t_Max)
+			t_Max = t_Buckets[t_Bucket];
+	}
+	return t_Max;
+}
+
+TEST(Hash, Compile_Time_Equals_Runtime)
+{
+	using namespace BB::Hashing::Literals;
+
+	//Every length branch of the hash, up to multiple rounds of the 48 byte loop.
+	const char* t_Strings[]{
+		"",
+		"a",
+		"abc",
+		"asset",
+		"textures/box.png",
+		"textures/box.png1",
+		"models/sponza/sponza_textures/sponza_curtain.png",
+		"models/sponza/sponza_textures/sponza_curtain_diffuse.png",
+		"a much longer string to make sure that the hash goes through the three lanes at least twice, and has a tail after it."
+	};
+	constexpr const uint64_t t_CompileTimeHashes[]{
+		BB::Hashing::HashString(""),
+		BB::Hashing::HashString("a"),
+		BB::Hashing::HashString("abc"),
+		"asset"_hash,
+		"textures/box.png"_hash,
+		"textures/box.png1"_hash,
+		"models/sponza/sponza_textures/sponza_curtain.png"_hash,
+		"models/sponza/sponza_textures/sponza_curtain_diffuse.png"_hash,
+		"a much longer string to make sure that the hash goes through the three lanes at least twice, and has a tail after it."_hash
+	};
+	static_assert(BB::Hashing::HashString("asset") == "asset"_hash, "Compile time hashes of the same string are different.");
+	static_assert(BB::Hashing::MixInteger(0) != 0, "0 hashes to 0.");
+
+	for (size_t i = 0; i < _countof(t_Strings); i++)
+	{
+		const size_t t_Length = strlen(t_Strings[i]);
+		//Copy it so that the runtime version can not be folded into a constant.
+		char t_Copy[256];
+		memcpy(t_Copy, t_Strings[i], t_Length + 1);
+
+		EXPECT_EQ(BB::Hashing::HashString(t_Copy), t_CompileTimeHashes[i]) << "Runtime hash is different from the compile time hash for " << t_Strings[i];
+		EXPECT_EQ(BB::Hashing::HashBytes(t_Copy, t_Length), t_CompileTimeHashes[i]) << "HashBytes is different from HashString for " << t_Strings[i];
+		EXPECT_EQ(Hash::MakeHash(static_cast<const char*>(t_Copy)).hash, t_CompileTimeHashes[i]) << "Hash::MakeHash does not use HashString for " << t_Strings[i];
+		EXPECT_NE(BB::Hashing::HashString(t_Copy, t_Length, 1), BB::Hashing::HashString(t_Copy)) << "The seed is not used for " << t_Strings[i];
+	}
+}
+
+TEST(Hash, Avalanche)
+{
+	constexpr const uint32_t samples = 2048;
+
+	//Flipping one input bit should flip about half of the output bits.
+	uint64_t t_MixFlips = 0;
+	uint64_t t_BytesFlips = 0;
+	uint64_t t_OldFlips = 0;
+	for (uint32_t i = 0; i < samples; i++)
+	{
+		const uint64_t t_Key = (static_cast<uint64_t>(BB::Random::Random()) << 32) | BB::Random::Random();
+		const uint64_t t_Mix = BB::Hashing::MixInteger(t_Key);
+		const uint64_t t_Bytes = BB::Hashing::HashBytes(&t_Key, sizeof(t_Key));
+		const uint64_t t_Old = OldIntegerHash(t_Key);
+		for (uint32_t t_Bit = 0; t_Bit < 64; t_Bit++)
+		{
+			const uint64_t t_FlippedKey = t_Key ^ (1ull << t_Bit);
+			t_MixFlips += CountBits(t_Mix ^ BB::Hashing::MixInteger(t_FlippedKey));
+			t_BytesFlips += CountBits(t_Bytes ^ BB::Hashing::HashBytes(&t_FlippedKey, sizeof(t_FlippedKey)));
+			t_OldFlips += CountBits(t_Old ^ OldIntegerHash(t_FlippedKey));
+		}
+	}
+
+	const double t_Tests = static_cast<double>(samples) * 64.0;
+	const double t_MixAverage = static_cast<double>(t_MixFlips) / t_Tests;
+	const double t_BytesAverage = static_cast<double>(t_BytesFlips) / t_Tests;
+	std::cout << "Average output bits changed by one input bit, 32 is perfect." << "\n";
+	std::cout << "MixInteger: " << t_MixAverage << "\n";
+	std::cout << "HashBytes: " << t_BytesAverage << "\n";
+	std::cout << "Old xorshift: " << static_cast<double>(t_OldFlips) / t_Tests << "\n";
+
+	EXPECT_NEAR(t_MixAverage, 32.0, 0.5) << "MixInteger does not avalanche.";
+	EXPECT_NEAR(t_BytesAverage, 32.0, 0.5) << "HashBytes does not avalanche.";
+}
+
+TEST(Hash, Bucket_Distribution)
+{
+	constexpr const uint32_t keyCount = 1 << 16;
+	constexpr const uint32_t bucketBits = 10;
+	constexpr const uint32_t expectedLoad = keyCount >> bucketBits;
+
+	//OL_HashMap uses the low bits through a modulo, SW_HashMap uses the high bits for the position.
+	const auto t_Sequential = [](const uint32_t a_Key) { return BB::Hashing::MixInteger(a_Key); };
+	const auto t_Pointers = [](const uint32_t a_Key) { return Hash::MakeHash(reinterpret_cast<void*>(0x7FF000000000ull + a_Key * 64ull)).hash; };
+	const auto t_Strings = [](const uint32_t a_Key)
+	{
+		char t_Name[32];
+		snprintf(t_Name, sizeof(t_Name), "asset_%u.png", a_Key);
+		return BB::Hashing::HashString(t_Name);
+	};
+	const auto t_OldSequential = [](const uint32_t a_Key) { return OldIntegerHash(a_Key); };
+	const auto t_OldPointers = [](const uint32_t a_Key) { return OldIntegerHash(0x7FF000000000ull + a_Key * 64ull); };
+	const auto t_OldStrings = [](const uint32_t a_Key)
+	{
+		char t_Name[32];
+		snprintf(t_Name, sizeof(t_Name), "asset_%u.png", a_Key);
+		return OldStringHash(t_Name);
+	};
+
+	std::cout << "Most keys in one bucket, " << keyCount << " keys over " << (1 << bucketBits) << " buckets, " << expectedLoad << " is perfect." << "\n";
+	std::cout << "Low bits | high bits" << "\n";
+
+	const uint32_t t_Results[3][2]{
+		{ MaxBucketLoad(keyCount, bucketBits, 0, t_Sequential), MaxBucketLoad(keyCount, bucketBits, 64 - bucketBits, t_Sequential) },
+		{ MaxBucketLoad(keyCount, bucketBits, 0, t_Pointers), MaxBucketLoad(keyCount, bucketBits, 64 - bucketBits, t_Pointers) },
+		{ MaxBucketLoad(keyCount, bucketBits, 0, t_Strings), MaxBucketLoad(keyCount, bucketBits, 64 - bucketBits, t_Strings) }
+	};
+	std::cout << "Sequential integers: " << t_Results[0][0] << " | " << t_Results[0][1] <<
+		", old: " << MaxBucketLoad(keyCount, bucketBits, 0, t_OldSequential) << " | " << MaxBucketLoad(keyCount, bucketBits, 64 - bucketBits, t_OldSequential) << "\n";
+	std::cout << "Aligned pointers: " << t_Results[1][0] << " | " << t_Results[1][1] <<
+		", old: " << MaxBucketLoad(keyCount, bucketBits, 0, t_OldPointers) << " | " << MaxBucketLoad(keyCount, bucketBits, 64 - bucketBits, t_OldPointers) << "\n";
+	std::cout << "Strings: " << t_Results[2][0] << " | " << t_Results[2][1] <<
+		", old: " << MaxBucketLoad(keyCount, bucketBits, 0, t_OldStrings) << " | " << MaxBucketLoad(keyCount, bucketBits, 64 - bucketBits, t_OldStrings) << "\n";
+
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		EXPECT_LT(t_Results[i][0], expectedLoad * 2) << "Low bits of the hash are clustered for key set " << i;
+		EXPECT_LT(t_Results[i][1], expectedLoad * 2) << "High bits of the hash are clustered for key set " << i;
+	}
+}
+
+TEST(Hash, Hash_Speedtest)
+{
+	typedef std::chrono::duration<float, std::milli> ms;
+	constexpr const float MILLITIMEDIVIDE = 1 / 1000.f;
+
+	constexpr const size_t bufferSize = BB::kbSize * 64;
+	constexpr const size_t sizes[]{ 8, 16, 64, 256, bufferSize };
+
+	BB::FreelistAllocator_t t_Allocator(BB::mbSize * 16);
+	char* t_Buffer = BBnewArr(t_Allocator, bufferSize + 1, char);
+	for (size_t i = 0; i < bufferSize; i++)
+		t_Buffer[i] = static_cast<char>('a' + BB::Random::Random(26));
+	t_Buffer[bufferSize] = '\0';
+
+	std::cout << "/-----------------------------------------/" << "\n" << "Hash throughput, time in MS to hash 1 MB in pieces of the size:" << "\n";
+	for (const size_t t_Size : sizes)
+	{
+		const size_t t_Rounds = BB::mbSize / t_Size;
+		//Keep the results so the hashing does not get optimized out.
+		uint64_t t_Sum = 0;
+		{
+			auto t_Timer = std::chrono::high_resolution_clock::now();
+			for (size_t i = 0; i < t_Rounds; i++)
+				t_Sum += BB::Hashing::HashBytes(t_Buffer + (i * 8) % (bufferSize - t_Size + 1), t_Size);
+			auto t_Speed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+			std::cout << "HashBytes " << t_Size << " bytes: " << t_Speed << "\n";
+		}
+		{
+			//djb2 needs the null terminator, so hash the end of the buffer.
+			const char* t_String = t_Buffer + bufferSize - t_Size;
+			auto t_Timer = std::chrono::high_resolution_clock::now();
+			for (size_t i = 0; i < t_Rounds; i++)
+				t_Sum += OldStringHash(t_String);
+			auto t_Speed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+			std::cout << "Old djb2 " << t_Size << " bytes: " << t_Speed << "\n";
+		}
+		EXPECT_NE(t_Sum, 0);
+	}
+	BB::BBfreeArr(t_Allocator, t_Buffer);
+
+	//Every map in the framework with the key types they are used with.
+	constexpr const uint32_t samples = 8192;
+	size_t t_IntegerKeys[samples]{};
+	void* t_PointerKeys[samples]{};
+	char t_StringKeys[samples][24]{};
+	for (uint32_t i = 0; i < samples; i++)
+	{
+		t_IntegerKeys[i] = i;
+		t_PointerKeys[i] = reinterpret_cast<void*>(0x7FF000000000ull + i * 64ull);
+		snprintf(t_StringKeys[i], sizeof(t_StringKeys[i]), "textures/asset_%u.png", i);
+	}
+
+	std::cout << "/-----------------------------------------/" << "\n" << "Map insert and lookup time in MS for " << samples << " keys:" << "\n";
+	const auto t_TestMap = [&](auto& a_Map, auto a_GetKey, const char* a_Name)
+	{
+		auto t_Timer = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < samples; i++)
+			a_Map.emplace(a_GetKey(i), i);
+		for (uint32_t i = 0; i < samples; i++)
+			EXPECT_EQ(*a_Map.find(a_GetKey(i)), i) << a_Name << " couldn't find key " << i;
+		auto t_Speed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+		std::cout << a_Name << ": " << t_Speed << "\n";
+	};
+	const auto t_GetInteger = [&](const uint32_t a_Index) { return t_IntegerKeys[a_Index]; };
+	const auto t_GetPointer = [&](const uint32_t a_Index) { return t_PointerKeys[a_Index]; };
+	const auto t_GetString = [&](const uint32_t a_Index) { return static_cast<char*>(t_StringKeys[a_Index]); };
+
+	{
+		BB::UM_HashMap<size_t, uint32_t> t_Map(t_Allocator, samples);
+		t_TestMap(t_Map, t_GetInteger, "UM sequential integers");
+	}
+	{
+		BB::UM_HashMap<void*, uint32_t> t_Map(t_Allocator, samples);
+		t_TestMap(t_Map, t_GetPointer, "UM aligned pointers");
+	}
+	{
+		BB::UM_HashMap<char*, uint32_t, BB::String_KeyComp> t_Map(t_Allocator, samples);
+		t_TestMap(t_Map, t_GetString, "UM strings");
+	}
+	{
+		BB::OL_HashMap<size_t, uint32_t> t_Map(t_Allocator, samples);
+		t_TestMap(t_Map, t_GetInteger, "OL sequential integers");
+	}
+	{
+		BB::OL_HashMap<void*, uint32_t> t_Map(t_Allocator, samples);
+		t_TestMap(t_Map, t_GetPointer, "OL aligned pointers");
+	}
+	{
+		BB::OL_HashMap<char*, uint32_t, BB::String_KeyComp> t_Map(t_Allocator, samples);
+		t_TestMap(t_Map, t_GetString, "OL strings");
+	}
+	{
+		BB::SW_HashMap<size_t, uint32_t> t_Map(t_Allocator, samples);
+		t_TestMap(t_Map, t_GetInteger, "SW sequential integers");
+	}
+	{
+		BB::SW_HashMap<void*, uint32_t> t_Map(t_Allocator, samples);
+		t_TestMap(t_Map, t_GetPointer, "SW aligned pointers");
+	}
+	{
+		BB::SW_HashMap<char*, uint32_t, BB::String_KeyComp> t_Map(t_Allocator, samples);
+		t_TestMap(t_Map, t_GetString, "SW strings");
+	}
+	std::cout << "/-----------------------------------------/" << "\n";
+}
@@ -268,6 +268,161 @@ TEST(Hashmap_Datastructure, OL_Hashmap_Range_Based_Loop)
 	//}
 }
 
+TEST(Hashmap_Datastructure, SW_Hashmap_Insert_Copy_Assignment)
+{
+	constexpr const uint32_t samples = 4096;
+
+	//32 MB alloactor.
+	const size_t allocatorSize = BB::mbSize * 32;
+	BB::FreelistAllocator_t t_Allocator(allocatorSize);
+
+	BB::SW_HashMap<size_t, size2593bytesObj> t_Map(t_Allocator);
+	{
+		size2593bytesObj t_Value{};
+		t_Value.value = 500;
+		size_t t_Key = 124;
+		t_Map.insert(t_Key, t_Value);
+
+		ASSERT_NE(t_Map.find(t_Key), nullptr) << "Cannot find the element while it was added!";
+		ASSERT_EQ(t_Map.find(t_Key)->value, t_Value.value) << "Wrong element was likely grabbed.";
+
+		t_Map.erase(t_Key);
+		ASSERT_EQ(t_Map.find(t_Key), nullptr) << "Element was found while it should've been deleted.";
+	}
+
+	size_t t_RandomKeys[samples]{};
+	for (size_t i = 0; i < samples; i++)
+	{
+		t_RandomKeys[i] = (i + 1) * 2;
+	}
+
+	//Insert and remove without growing, the deleted slots must not break later probes.
+	for (size_t i = 0; i < samples / 4; i++)
+	{
+		size2593bytesObj t_Value{};
+		t_Value.value = 500;
+		size_t t_Key = t_RandomKeys[i];
+		t_Map.insert(t_Key, t_Value);
+
+		ASSERT_NE(t_Map.find(t_Key), nullptr) << "Cannot find the element while it was added!";
+		ASSERT_EQ(t_Map.find(t_Key)->value, t_Value.value) << "Wrong element was likely grabbed.";
+
+		t_Map.erase(t_Key);
+		ASSERT_EQ(t_Map.find(t_Key), nullptr) << "Element was found while it should've been deleted.";
+	}
+	ASSERT_EQ(t_Map.size(), 0);
+
+	//Starts at the standard size, so this grows the map a couple of times.
+	for (size_t i = 0; i < samples; i++)
+	{
+		size2593bytesObj t_Value{};
+		t_Value.value = t_RandomKeys[i] + 2;
+		size_t t_Key = t_RandomKeys[i];
+		t_Map.insert(t_Key, t_Value);
+	}
+	ASSERT_EQ(t_Map.size(), samples);
+	ASSERT_LE(static_cast<float>(t_Map.size()) / static_cast<float>(t_Map.capacity()), BB::Hashmap_Specs::SW_MaxLoadFactor);
+	//Now check it
+	for (size_t i = 0; i < samples; i++)
+	{
+		size_t t_Key = t_RandomKeys[i];
+
+		EXPECT_NE(t_Map.find(t_Key), nullptr) << " Cannot find the element while it was added!";
+		if (t_Map.find(t_Key) != nullptr)
+			EXPECT_EQ(t_Map.find(t_Key)->value, t_Key + 2) << "element: " << i << " Wrong element was likely grabbed.";
+	}
+
+	//Remove every other element and add them back, the map should not grow from this.
+	const size_t t_Capacity = t_Map.capacity();
+	for (size_t i = 0; i < samples; i += 2)
+		t_Map.erase(t_RandomKeys[i]);
+	for (size_t i = 0; i < samples; i++)
+		ASSERT_EQ(t_Map.find(t_RandomKeys[i]) == nullptr, i % 2 == 0) << "element: " << i << " erase removed the wrong element.";
+	for (size_t i = 0; i < samples; i += 2)
+		t_Map.emplace(t_RandomKeys[i], t_RandomKeys[i] + 2);
+	ASSERT_EQ(t_Map.capacity(), t_Capacity);
+
+	//Copy Constructor
+	BB::SW_HashMap<size_t, size2593bytesObj> t_CopyMap(t_Map);
+
+	for (uint32_t i = 0; i < samples; i++)
+	{
+		size_t t_Key = t_RandomKeys[i];
+
+		ASSERT_EQ(t_CopyMap.find(t_Key)->value, t_Map.find(t_Key)->value) << "Wrong element was grabbed from the copy of the map.";
+	}
+
+	BB::SW_HashMap<size_t, size2593bytesObj> t_CopyOperatorMap(t_Allocator);
+	t_CopyOperatorMap = t_CopyMap;
+
+	for (uint32_t i = 0; i < samples; i++)
+	{
+		size_t t_Key = t_RandomKeys[i];
+
+		ASSERT_EQ(t_CopyOperatorMap.find(t_Key)->value, t_CopyMap.find(t_Key)->value) << "Wrong element was grabbed from the copy of the map.";
+	}
+
+	//Assignment Constructor
+	BB::SW_HashMap<size_t, size2593bytesObj> t_AssignmentMap(std::move(t_CopyOperatorMap));
+	ASSERT_EQ(t_CopyOperatorMap.size(), 0);
+
+	for (size_t i = 0; i < samples; i++)
+	{
+		size_t t_Key = t_RandomKeys[i];
+
+		ASSERT_EQ(t_AssignmentMap.find(t_Key)->value, t_Map.find(t_Key)->value) << "Wrong element was grabbed from the copy of the map.";
+	}
+
+	//Assignment Operator
+	BB::SW_HashMap<size_t, size2593bytesObj> t_AssignmentOperatorMap(t_Allocator);
+	t_AssignmentOperatorMap = std::move(t_AssignmentMap);
+	ASSERT_EQ(t_AssignmentMap.size(), 0);
+
+	for (size_t i = 0; i < samples; i++)
+	{
+		size_t t_Key = t_RandomKeys[i];
+
+		ASSERT_EQ(t_AssignmentOperatorMap.find(t_Key)->value, t_Map.find(t_Key)->value) << "Wrong element was grabbed from the copy of the map.";
+	}
+
+	t_Map.clear();
+	ASSERT_EQ(t_Map.size(), 0);
+	ASSERT_EQ(t_Map.find(t_RandomKeys[0]), nullptr) << "Element was found after clearing the map.";
+}
+
+TEST(Hashmap_Datastructure, SW_Hashmap_String_Keys)
+{
+	constexpr const uint32_t samples = 512;
+
+	const size_t allocatorSize = BB::mbSize * 4;
+	BB::FreelistAllocator_t t_Allocator(allocatorSize);
+
+	char t_Names[samples][16]{};
+	BB::SW_HashMap<char*, uint32_t, BB::String_KeyComp> t_Map(t_Allocator);
+	for (uint32_t i = 0; i < samples; i++)
+	{
+		snprintf(t_Names[i], sizeof(t_Names[i]), "node_%u", i);
+		t_Map.emplace(t_Names[i], i);
+	}
+
+	//Look up with a const char* from a different buffer, no cast to the key type needed.
+	for (uint32_t i = 0; i < samples; i++)
+	{
+		char t_Lookup[16];
+		snprintf(t_Lookup, sizeof(t_Lookup), "node_%u", i);
+		const char* t_LookupKey = t_Lookup;
+
+		ASSERT_NE(t_Map.find(t_LookupKey), nullptr) << "Cannot find the string key " << t_LookupKey;
+		ASSERT_EQ(*t_Map.find(t_LookupKey), i) << "Wrong element was likely grabbed.";
+	}
+
+	ASSERT_TRUE(t_Map.contains("node_0"));
+	ASSERT_FALSE(t_Map.contains("node"));
+	t_Map.erase("node_0");
+	ASSERT_FALSE(t_Map.contains("node_0")) << "Element was found while it should've been deleted.";
+	ASSERT_EQ(t_Map.size(), samples - 1);
+}
+
 #include <chrono>
 #include <unordered_map>
 
@@ -294,10 +449,12 @@ TEST(Hashmap_Datastructure, Hashmap_Speedtest)
 	std::unordered_map<size_t, size2593bytesObj> t_UnorderedMap;
 	BB::UM_HashMap<size_t, size2593bytesObj> t_UM_Map(t_Allocator);
 	BB::OL_HashMap<size_t, size2593bytesObj> t_OL_Map(t_Allocator);
+	BB::SW_HashMap<size_t, size2593bytesObj> t_SW_Map(t_Allocator);
 
 	t_UnorderedMap.reserve(samples);
 	t_UM_Map.reserve(samples);
 	t_OL_Map.reserve(samples);
+	t_SW_Map.reserve(samples);
 
 	//The samples we will use as an example.
 	size_t t_RandomKeys[samples]{};
@@ -306,7 +463,7 @@ TEST(Hashmap_Datastructure, Hashmap_Speedtest)
 		t_RandomKeys[i] = static_cast<size_t>(BB::Random::Random());
 	}
 
-	std::cout << "Hashmap speed test comparison with" << "\n" << "std::unordered_map" << "\n" << "BB::UM_Hashmap" << "\n" << "BB::OL_Hashmap" << "\n" << "\n";
+	std::cout << "Hashmap speed test comparison with" << "\n" << "std::unordered_map" << "\n" << "BB::UM_Hashmap" << "\n" << "BB::OL_Hashmap" << "\n" << "BB::SW_Hashmap" << "\n" << "\n";
 	std::cout << "The element sizes being added to the hashmap are 2593 bytes in size and have a constructor/deconstructor." << "\n";
 	std::cout << "The amount of samples per hashmap: " << samples << "\n" << "\n";
 	
@@ -352,6 +509,20 @@ TEST(Hashmap_Datastructure, Hashmap_Speedtest)
 		std::cout << "OL map speed with time in MS " << t_OLMapSpeed << "\n";
 	}
 
+	{
+		
+		auto t_Timer = std::chrono::high_resolution_clock::now();
+		//BB::SW speed.
+		for (size_t i = 0; i < samples; i++)
+		{
+			size2593bytesObj t_Insert{};
+			t_Insert.value = i;
+			t_SW_Map.emplace(t_RandomKeys[i], t_Insert.value);
+		}
+		auto t_SWMapSpeed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+		std::cout << "SW map speed with time in MS " << t_SWMapSpeed << "\n";
+	}
+
 #pragma endregion
 	std::cout << "/-----------------------------------------/" << "\n" << "Lookup Speed Test:" << "\n";
 #pragma region Lookup_Test
@@ -390,6 +561,18 @@ TEST(Hashmap_Datastructure, Hashmap_Speedtest)
 		std::cout << "OL map speed with time in MS " << t_OLMapSpeed << "\n";
 	}
 
+	{
+
+		auto t_Timer = std::chrono::high_resolution_clock::now();
+		//BB::SW speed.
+		for (size_t i = 0; i < samples; i++)
+		{
+			EXPECT_EQ(t_SW_Map.find(t_RandomKeys[i])->value, i) << "SW Hashmap couldn't find key " << t_RandomKeys[i];
+		}
+		auto t_SWMapSpeed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+		std::cout << "SW map speed with time in MS " << t_SWMapSpeed << "\n";
+	}
+
 #pragma endregion
 	std::cout << "/-----------------------------------------/" << "\n" << "Lookup Empty Speed Test:" << "\n";
 #pragma region Lookup_Empty_Test
@@ -429,6 +612,18 @@ TEST(Hashmap_Datastructure, Hashmap_Speedtest)
 		std::cout << "OL map speed with time in MS " << t_OLMapSpeed << "\n";
 	}
 
+	{
+
+		auto t_Timer = std::chrono::high_resolution_clock::now();
+		//BB::SW speed.
+		for (size_t i = 0; i < samples; i++)
+		{
+			EXPECT_EQ(t_SW_Map.find(EMPTY_KEY + i), nullptr) << "SW Hashmap found a key while it shouldn't exist." << t_RandomKeys[i];
+		}
+		auto t_SWMapSpeed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+		std::cout << "SW map speed with time in MS " << t_SWMapSpeed << "\n";
+	}
+
 #pragma endregion
 	std::cout << "/-----------------------------------------/" << "\n" << "Erase Speed Test:" << "\n";
 #pragma region Erase_Test
@@ -464,6 +659,90 @@ TEST(Hashmap_Datastructure, Hashmap_Speedtest)
 		auto t_OLMapSpeed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
 		std::cout << "OL map speed with time in MS " << t_OLMapSpeed << "\n";
 	}
+
+	{
+		auto t_Timer = std::chrono::high_resolution_clock::now();
+		//BB::SW speed.
+		for (size_t i = 0; i < samples; i++)
+		{
+			t_SW_Map.erase(t_RandomKeys[i]);
+		}
+		auto t_SWMapSpeed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+		std::cout << "SW map speed with time in MS " << t_SWMapSpeed << "\n";
+	}
 #pragma endregion
 	std::cout << "/-----------------------------------------/" << "\n";
-}
\ No newline at end of file
+}
+
+TEST(Hashmap_Datastructure, Hashmap_LoadFactor_Speedtest)
+{
+	//Some tools for the speed test.
+	typedef std::chrono::duration<float, std::milli> ms;
+	constexpr const float MILLITIMEDIVIDE = 1 / 1000.f;
+#ifdef _64BIT
+	constexpr const size_t slots = 16384;
+#endif //_64BIT
+#ifdef _32BIT
+	constexpr const size_t slots = 4096;
+#endif //_32BIT
+	constexpr const float loadFactors[]{ 0.5f, 0.6f, 0.7f, 0.8f, 0.9f };
+	constexpr const size_t EMPTY_KEY = 414141414141;
+
+	const size_t allocatorSize = BB::mbSize * 8;
+	BB::FreelistAllocator_t t_Allocator(allocatorSize);
+
+	//The samples we will use as an example.
+	size_t t_RandomKeys[slots]{};
+	for (size_t i = 0; i < slots; i++)
+	{
+		t_RandomKeys[i] = static_cast<size_t>(BB::Random::Random());
+	}
+
+	std::cout << "Hashmap load factor speed test comparison with" << "\n" << "BB::UM_Hashmap" << "\n" << "BB::OL_Hashmap" << "\n" << "BB::SW_Hashmap" << "\n" << "\n";
+	std::cout << "The SW map has " << slots << " slots, the load factor is the amount of elements divided by that." << "\n";
+	std::cout << "The UM and OL maps size their own tables for the same amount of elements." << "\n";
+	std::cout << "Times are insert, lookup and lookup of keys that do not exist in MS." << "\n" << "\n";
+
+	for (const float t_LoadFactor : loadFactors)
+	{
+		const size_t t_Elements = static_cast<size_t>(static_cast<float>(slots) * t_LoadFactor);
+
+		BB::UM_HashMap<size_t, size_t> t_UM_Map(t_Allocator, t_Elements);
+		BB::OL_HashMap<size_t, size_t> t_OL_Map(t_Allocator, t_Elements);
+		BB::SW_HashMap<size_t, size_t> t_SW_Map(t_Allocator, t_Elements);
+		ASSERT_EQ(t_SW_Map.capacity(), slots) << "SW map is not at the load factor that is being tested.";
+
+		std::cout << "/-----------------------------------------/" << "\n" << "Load factor " << t_LoadFactor << " with " << t_Elements << " elements:" << "\n";
+
+		const auto t_TestMap = [&](auto& a_Map, const char* a_Name)
+		{
+			auto t_Timer = std::chrono::high_resolution_clock::now();
+			for (size_t i = 0; i < t_Elements; i++)
+			{
+				a_Map.emplace(t_RandomKeys[i], i);
+			}
+			const float t_InsertSpeed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+
+			t_Timer = std::chrono::high_resolution_clock::now();
+			for (size_t i = 0; i < t_Elements; i++)
+			{
+				EXPECT_EQ(*a_Map.find(t_RandomKeys[i]), i) << a_Name << " Hashmap couldn't find key " << t_RandomKeys[i];
+			}
+			const float t_LookupSpeed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+
+			t_Timer = std::chrono::high_resolution_clock::now();
+			for (size_t i = 0; i < t_Elements; i++)
+			{
+				EXPECT_EQ(a_Map.find(EMPTY_KEY + i), nullptr) << a_Name << " Hashmap found a key while it shouldn't exist.";
+			}
+			const float t_LookupEmptySpeed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+
+			std::cout << a_Name << " map speed with time in MS " << t_InsertSpeed << " " << t_LookupSpeed << " " << t_LookupEmptySpeed << "\n";
+		};
+
+		t_TestMap(t_UM_Map, "UM");
+		t_TestMap(t_OL_Map, "OL");
+		t_TestMap(t_SW_Map, "SW");
+	}
+	std::cout << "/-----------------------------------------/" << "\n";
+}
@@ -0,0 +1,387 @@
+#pragma once
+#include "../TestValues.h"
+#include "Storage/MPMCQueue.h"
+#include "Storage/SPSCQueue.h"
+#include "Storage/LockFreeStack.h"
+#include "BBSync.hpp"
+#include "OS/Program.h"
+#include <chrono>
+#include <thread>
+
+constexpr const uint32_t LOCKFREE_THREAD_COUNT = 4;
+constexpr const uint32_t LOCKFREE_ITEMS_PER_THREAD = 100000;
+
+TEST(LockFreeStorage, MPMCQueue_Single_Thread)
+{
+	BB::FreelistAllocator_t t_Allocator{ BB::kbSize * 16 };
+	{
+		BB::MPMCQueue<size_t> t_Queue{ t_Allocator, 8 };
+		size_t t_Value;
+		EXPECT_FALSE(t_Queue.try_pop(t_Value));
+
+		//Go around the ring a few times to test the sequence numbers.
+		for (size_t t_Lap = 0; t_Lap < 4; t_Lap++)
+		{
+			for (size_t i = 0; i < t_Queue.capacity(); i++)
+				EXPECT_TRUE(t_Queue.try_push(t_Lap * 100 + i));
+			EXPECT_FALSE(t_Queue.try_push(0)) << "pushed into a full queue";
+			EXPECT_EQ(t_Queue.size(), t_Queue.capacity());
+
+			for (size_t i = 0; i < t_Queue.capacity(); i++)
+			{
+				ASSERT_TRUE(t_Queue.try_pop(t_Value));
+				EXPECT_EQ(t_Value, t_Lap * 100 + i) << "MPMCQueue is not first in first out";
+			}
+			EXPECT_FALSE(t_Queue.try_pop(t_Value));
+		}
+	}
+	t_Allocator.Clear();
+}
+
+TEST(LockFreeStorage, SPSCQueue_Single_Thread)
+{
+	BB::FreelistAllocator_t t_Allocator{ BB::kbSize * 16 };
+	{
+		BB::SPSCQueue<size_t> t_Queue{ t_Allocator, 16 };
+		size_t t_Value;
+		EXPECT_FALSE(t_Queue.try_pop(t_Value));
+
+		//Push and pop out of step so the head and tail wrap at different times.
+		size_t t_Pushed = 0;
+		size_t t_Popped = 0;
+		for (size_t i = 0; i < 1000; i++)
+		{
+			while (t_Queue.try_push(t_Pushed))
+				++t_Pushed;
+			EXPECT_EQ(t_Queue.size(), t_Queue.capacity());
+			for (size_t j = 0; j < i % 13 + 1; j++)
+			{
+				ASSERT_TRUE(t_Queue.try_pop(t_Value));
+				EXPECT_EQ(t_Value, t_Popped++) << "SPSCQueue is not first in first out";
+			}
+		}
+		while (t_Queue.try_pop(t_Value))
+			EXPECT_EQ(t_Value, t_Popped++);
+		EXPECT_EQ(t_Pushed, t_Popped);
+	}
+	t_Allocator.Clear();
+}
+
+struct LockFreeNode
+{
+	LockFreeNode* next;
+	uint32_t value;
+};
+
+TEST(LockFreeStorage, LockFreeStack_Single_Thread)
+{
+	LockFreeNode t_Nodes[64];
+	BB::LockFreeStack<LockFreeNode> t_Stack;
+	EXPECT_TRUE(t_Stack.empty());
+	EXPECT_EQ(t_Stack.pop(), nullptr);
+
+	for (uint32_t i = 0; i < _countof(t_Nodes); i++)
+	{
+		t_Nodes[i].value = i;
+		t_Stack.push(&t_Nodes[i]);
+	}
+	//Last in first out.
+	for (uint32_t i = _countof(t_Nodes); i > 0; i--)
+	{
+		LockFreeNode* t_Node = t_Stack.pop();
+		ASSERT_NE(t_Node, nullptr);
+		EXPECT_EQ(t_Node->value, i - 1);
+	}
+	EXPECT_TRUE(t_Stack.empty());
+
+	//Push a linked list in one go.
+	for (uint32_t i = 0; i < _countof(t_Nodes) - 1; i++)
+		t_Nodes[i].next = &t_Nodes[i + 1];
+	t_Stack.push(&t_Nodes[0], &t_Nodes[_countof(t_Nodes) - 1]);
+	for (uint32_t i = 0; i < _countof(t_Nodes); i++)
+		EXPECT_EQ(t_Stack.pop(), &t_Nodes[i]);
+	EXPECT_EQ(t_Stack.pop(), nullptr);
+}
+
+struct MPMC_ThreadParam
+{
+	BB::MPMCQueue<uint64_t>* queue;
+	std::atomic<uint32_t> producerIndex{ 0 };
+	std::atomic<uint32_t> producersDone{ 0 };
+	std::atomic<uint64_t> popCount{ 0 };
+	std::atomic<uint64_t> popSum{ 0 };
+};
+
+//Every thread pushes its own range of values and pops whatever it can, the sum tells if any got lost or duplicated.
+static void MPMC_PushAndPop(void* a_Param)
+{
+	MPMC_ThreadParam* t_Param = reinterpret_cast<MPMC_ThreadParam*>(a_Param);
+	const uint64_t t_First = static_cast<uint64_t>(t_Param->producerIndex.fetch_add(1)) * LOCKFREE_ITEMS_PER_THREAD;
+	uint64_t t_Count = 0;
+	uint64_t t_Sum = 0;
+	uint64_t t_Value;
+
+	for (uint64_t i = 0; i < LOCKFREE_ITEMS_PER_THREAD; i++)
+	{
+		while (!t_Param->queue->try_push(t_First + i))
+		{
+			//Full, help by popping one.
+			if (t_Param->queue->try_pop(t_Value))
+			{
+				++t_Count;
+				t_Sum += t_Value;
+			}
+		}
+	}
+	t_Param->producersDone.fetch_add(1);
+
+	while (t_Param->producersDone.load() != LOCKFREE_THREAD_COUNT || t_Param->queue->size() != 0)
+	{
+		if (t_Param->queue->try_pop(t_Value))
+		{
+			++t_Count;
+			t_Sum += t_Value;
+		}
+	}
+	t_Param->popCount.fetch_add(t_Count);
+	t_Param->popSum.fetch_add(t_Sum);
+}
+
+TEST(LockFreeStorage, MPMCQueue_Multi_Thread)
+{
+	constexpr const uint64_t TOTAL_ITEMS = static_cast<uint64_t>(LOCKFREE_THREAD_COUNT) * LOCKFREE_ITEMS_PER_THREAD;
+	BB::FreelistAllocator_t t_Allocator{ BB::kbSize * 16 };
+	{
+		//Small on purpose so the queue is full and empty a lot.
+		BB::MPMCQueue<uint64_t> t_Queue{ t_Allocator, 64 };
+		MPMC_ThreadParam t_Param;
+		t_Param.queue = &t_Queue;
+
+		BB::OSThreadHandle t_Threads[LOCKFREE_THREAD_COUNT];
+		for (uint32_t i = 0; i < LOCKFREE_THREAD_COUNT; i++)
+			t_Threads[i] = BB::OSCreateThread(MPMC_PushAndPop, 0, &t_Param);
+		for (uint32_t i = 0; i < LOCKFREE_THREAD_COUNT; i++)
+			BB::OSWaitThreadfinish(t_Threads[i]);
+
+		EXPECT_EQ(t_Param.popCount.load(), TOTAL_ITEMS);
+		EXPECT_EQ(t_Param.popSum.load(), TOTAL_ITEMS * (TOTAL_ITEMS - 1) / 2) << "MPMCQueue lost or duplicated values";
+	}
+	t_Allocator.Clear();
+}
+
+struct SPSC_ThreadParam
+{
+	BB::SPSCQueue<uint64_t>* queue;
+	uint64_t itemCount;
+	bool inOrder = true;
+};
+
+static void SPSC_Consume(void* a_Param)
+{
+	SPSC_ThreadParam* t_Param = reinterpret_cast<SPSC_ThreadParam*>(a_Param);
+	uint64_t t_Expected = 0;
+	uint64_t t_Value;
+	while (t_Expected != t_Param->itemCount)
+	{
+		if (t_Param->queue->try_pop(t_Value))
+		{
+			if (t_Value != t_Expected)
+				t_Param->inOrder = false;
+			++t_Expected;
+		}
+		//Let the producer run, there might be less cores then threads.
+		else
+			std::this_thread::yield();
+	}
+}
+
+TEST(LockFreeStorage, SPSCQueue_Multi_Thread)
+{
+	BB::FreelistAllocator_t t_Allocator{ BB::kbSize * 16 };
+	{
+		BB::SPSCQueue<uint64_t> t_Queue{ t_Allocator, 64 };
+		SPSC_ThreadParam t_Param;
+		t_Param.queue = &t_Queue;
+		t_Param.itemCount = static_cast<uint64_t>(LOCKFREE_THREAD_COUNT) * LOCKFREE_ITEMS_PER_THREAD;
+
+		BB::OSThreadHandle t_Consumer = BB::OSCreateThread(SPSC_Consume, 0, &t_Param);
+		for (uint64_t i = 0; i < t_Param.itemCount; i++)
+			while (!t_Queue.try_push(i))
+				std::this_thread::yield();
+		BB::OSWaitThreadfinish(t_Consumer);
+
+		EXPECT_TRUE(t_Param.inOrder) << "SPSCQueue consumer got the values out of order";
+		EXPECT_EQ(t_Queue.size(), 0u);
+	}
+	t_Allocator.Clear();
+}
+
+struct Stack_ThreadParam
+{
+	BB::LockFreeStack<LockFreeNode>* stack;
+	std::atomic<uint32_t> failedPops{ 0 };
+};
+
+//Takes nodes off the stack and puts them back, a node that is owned twice shows up in its value.
+static void Stack_PopAndPush(void* a_Param)
+{
+	Stack_ThreadParam* t_Param = reinterpret_cast<Stack_ThreadParam*>(a_Param);
+	for (uint32_t i = 0; i < LOCKFREE_ITEMS_PER_THREAD; i++)
+	{
+		LockFreeNode* t_Node = t_Param->stack->pop();
+		if (t_Node == nullptr)
+		{
+			t_Param->failedPops.fetch_add(1, std::memory_order_relaxed);
+			continue;
+		}
+		//Only this thread should own the node now.
+		const uint32_t t_Value = t_Node->value;
+		t_Node->value = t_Value + 1;
+		t_Param->stack->push(t_Node);
+	}
+}
+
+TEST(LockFreeStorage, LockFreeStack_Multi_Thread)
+{
+	//Less nodes then threads would be too much waiting on an empty stack, a few more makes ABA likely.
+	LockFreeNode t_Nodes[LOCKFREE_THREAD_COUNT * 2]{};
+	BB::LockFreeStack<LockFreeNode> t_Stack;
+	for (uint32_t i = 0; i < _countof(t_Nodes); i++)
+		t_Stack.push(&t_Nodes[i]);
+
+	Stack_ThreadParam t_Param;
+	t_Param.stack = &t_Stack;
+	BB::OSThreadHandle t_Threads[LOCKFREE_THREAD_COUNT];
+	for (uint32_t i = 0; i < LOCKFREE_THREAD_COUNT; i++)
+		t_Threads[i] = BB::OSCreateThread(Stack_PopAndPush, 0, &t_Param);
+	for (uint32_t i = 0; i < LOCKFREE_THREAD_COUNT; i++)
+		BB::OSWaitThreadfinish(t_Threads[i]);
+
+	EXPECT_EQ(t_Param.failedPops.load(), 0u) << "the stack was empty while there were more nodes then threads";
+	uint64_t t_Total = 0;
+	uint32_t t_NodeCount = 0;
+	while (LockFreeNode* t_Node = t_Stack.pop())
+	{
+		t_Total += t_Node->value;
+		++t_NodeCount;
+	}
+	EXPECT_EQ(t_NodeCount, _countof(t_Nodes)) << "LockFreeStack lost or duplicated nodes";
+	EXPECT_EQ(t_Total, static_cast<uint64_t>(LOCKFREE_THREAD_COUNT) * LOCKFREE_ITEMS_PER_THREAD);
+}
+
+struct LockedQueue_ThreadParam
+{
+	BB::FutexMutex lock;
+	uint64_t* values;
+	size_t capacity;
+	size_t head = 0;
+	size_t tail = 0;
+	std::atomic<uint32_t> producersDone{ 0 };
+	std::atomic<uint64_t> popCount{ 0 };
+};
+
+//Same work as MPMC_PushAndPop but with a mutex around a plain ring buffer.
+static void LockedQueue_PushAndPop(void* a_Param)
+{
+	LockedQueue_ThreadParam* t_Param = reinterpret_cast<LockedQueue_ThreadParam*>(a_Param);
+	uint64_t t_Count = 0;
+	const auto t_TryPop = [t_Param, &t_Count]()
+	{
+		std::lock_guard<BB::FutexMutex> t_Guard(t_Param->lock);
+		if (t_Param->head == t_Param->tail)
+			return;
+		++t_Param->head;
+		++t_Count;
+	};
+
+	for (uint64_t i = 0; i < LOCKFREE_ITEMS_PER_THREAD; i++)
+	{
+		while (true)
+		{
+			{
+				std::lock_guard<BB::FutexMutex> t_Guard(t_Param->lock);
+				if (t_Param->tail - t_Param->head < t_Param->capacity)
+				{
+					t_Param->values[t_Param->tail++ % t_Param->capacity] = i;
+					break;
+				}
+			}
+			t_TryPop();
+		}
+	}
+	t_Param->producersDone.fetch_add(1);
+
+	while (true)
+	{
+		const bool t_ProducersDone = t_Param->producersDone.load() == LOCKFREE_THREAD_COUNT;
+		{
+			std::lock_guard<BB::FutexMutex> t_Guard(t_Param->lock);
+			if (t_ProducersDone && t_Param->head == t_Param->tail)
+				break;
+		}
+		t_TryPop();
+	}
+	t_Param->popCount.fetch_add(t_Count);
+}
+
+TEST(LockFreeStorage, LockFreeStorage_Speedtest)
+{
+	typedef std::chrono::duration<float, std::milli> ms;
+	constexpr const float MILLITIMEDIVIDE = 1 / 1000.f;
+	constexpr const uint64_t TOTAL_ITEMS = static_cast<uint64_t>(LOCKFREE_THREAD_COUNT) * LOCKFREE_ITEMS_PER_THREAD;
+	constexpr const size_t QUEUE_SIZE = 1024;
+
+	BB::FreelistAllocator_t t_Allocator{ BB::kbSize * 64 };
+	std::cout << "/-----------------------------------------/" << "\n" << TOTAL_ITEMS << " items through a " << QUEUE_SIZE << " sized queue, with time in MS:" << "\n";
+
+	{
+		LockedQueue_ThreadParam t_Param;
+		t_Param.values = BBnewArr(t_Allocator, QUEUE_SIZE, uint64_t);
+		t_Param.capacity = QUEUE_SIZE;
+
+		auto t_Timer = std::chrono::high_resolution_clock::now();
+		BB::OSThreadHandle t_Threads[LOCKFREE_THREAD_COUNT];
+		for (uint32_t i = 0; i < LOCKFREE_THREAD_COUNT; i++)
+			t_Threads[i] = BB::OSCreateThread(LockedQueue_PushAndPop, 0, &t_Param);
+		for (uint32_t i = 0; i < LOCKFREE_THREAD_COUNT; i++)
+			BB::OSWaitThreadfinish(t_Threads[i]);
+		auto t_Speed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+		std::cout << LOCKFREE_THREAD_COUNT << " threads FutexMutex ring buffer: " << t_Speed << "\n";
+		EXPECT_EQ(t_Param.popCount.load(), TOTAL_ITEMS);
+	}
+
+	{
+		BB::MPMCQueue<uint64_t> t_Queue{ t_Allocator, QUEUE_SIZE };
+		MPMC_ThreadParam t_Param;
+		t_Param.queue = &t_Queue;
+
+		auto t_Timer = std::chrono::high_resolution_clock::now();
+		BB::OSThreadHandle t_Threads[LOCKFREE_THREAD_COUNT];
+		for (uint32_t i = 0; i < LOCKFREE_THREAD_COUNT; i++)
+			t_Threads[i] = BB::OSCreateThread(MPMC_PushAndPop, 0, &t_Param);
+		for (uint32_t i = 0; i < LOCKFREE_THREAD_COUNT; i++)
+			BB::OSWaitThreadfinish(t_Threads[i]);
+		auto t_Speed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+		std::cout << LOCKFREE_THREAD_COUNT << " threads MPMCQueue: " << t_Speed << "\n";
+		EXPECT_EQ(t_Param.popCount.load(), TOTAL_ITEMS);
+	}
+
+	{
+		BB::SPSCQueue<uint64_t> t_Queue{ t_Allocator, QUEUE_SIZE };
+		SPSC_ThreadParam t_Param;
+		t_Param.queue = &t_Queue;
+		t_Param.itemCount = TOTAL_ITEMS;
+
+		auto t_Timer = std::chrono::high_resolution_clock::now();
+		BB::OSThreadHandle t_Consumer = BB::OSCreateThread(SPSC_Consume, 0, &t_Param);
+		for (uint64_t i = 0; i < TOTAL_ITEMS; i++)
+			while (!t_Queue.try_push(i))
+				std::this_thread::yield();
+		BB::OSWaitThreadfinish(t_Consumer);
+		auto t_Speed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+		std::cout << "1 producer 1 consumer SPSCQueue: " << t_Speed << "\n";
+		EXPECT_TRUE(t_Param.inOrder);
+	}
+
+	t_Allocator.Clear();
+}
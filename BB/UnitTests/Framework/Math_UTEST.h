@@ -0,0 +1,383 @@
+#pragma once
+#include "../TestValues.h"
+#include "BBMemory.h"
+#include "Math.inl"
+#include <chrono>
+#include <random>
+
+//The scalar math from before Math.inl used SIMD, the SIMD versions should give the same results.
+namespace ScalarMath
+{
+	static BB::Mat4x4 Mat4x4Multiply(const BB::Mat4x4& a_Lhs, const BB::Mat4x4& a_Rhs)
+	{
+		BB::Mat4x4 t_Mat;
+		for (int r = 0; r < 4; r++)
+			for (int c = 0; c < 4; c++)
+				t_Mat.e[r][c] = a_Lhs.e[0][c] * a_Rhs.e[r][0] + a_Lhs.e[1][c] * a_Rhs.e[r][1] + a_Lhs.e[2][c] * a_Rhs.e[r][2] + a_Lhs.e[3][c] * a_Rhs.e[r][3];
+		return t_Mat;
+	}
+
+	static BB::Mat4x4 Mat4x4Inverse(const BB::Mat4x4& m)
+	{
+		using namespace BB;
+		const float3 a = float3{ m.e[0][0], m.e[1][0], m.e[2][0] };
+		const float3 b = float3{ m.e[0][1], m.e[1][1], m.e[2][1] };
+		const float3 c = float3{ m.e[0][2], m.e[1][2], m.e[2][2] };
+		const float3 d = float3{ m.e[0][3], m.e[1][3], m.e[2][3] };
+
+		const float x = m.e[3][0];
+		const float y = m.e[3][1];
+		const float z = m.e[3][2];
+		const float w = m.e[3][3];
+
+		float3 s = Float3Cross(a, b);
+		float3 t = Float3Cross(c, d);
+
+		float3 u = (a * y) - (b * x);
+		float3 v = (c * w) - (d * z);
+
+		float inv_det = 1.0f / (Float3Dot(s, v) + Float3Dot(t, u));
+		s = (s * inv_det);
+		t = (t * inv_det);
+		u = (u * inv_det);
+		v = (v * inv_det);
+
+		const float3 r0 = (Float3Cross(b, v) + (t * y));
+		const float3 r1 = (Float3Cross(v, a) - (t * x));
+		const float3 r2 = (Float3Cross(d, u) + (s * w));
+		const float3 r3 = (Float3Cross(u, c) - (s * z));
+
+		return Mat4x4FromFloats(
+			r0.x, r0.y, r0.z, -Float3Dot(b, t),
+			r1.x, r1.y, r1.z, Float3Dot(a, t),
+			r2.x, r2.y, r2.z, -Float3Dot(d, s),
+			r3.x, r3.y, r3.z, Float3Dot(c, s));
+	}
+}
+
+//Translation, rotation and scale like the nodes of a model.
+static BB::Mat4x4 RandomNodeTransform(std::mt19937& a_Random)
+{
+	std::uniform_real_distribution<float> t_Position(-100.f, 100.f);
+	std::uniform_real_distribution<float> t_Unit(-1.f, 1.f);
+	std::uniform_real_distribution<float> t_Scale(0.25f, 4.f);
+
+	const BB::float3 t_Axis = BB::Float3Normalize(BB::float3{ t_Unit(a_Random), t_Unit(a_Random), t_Unit(a_Random) + 2.f });
+	const BB::Quat t_Rotation = BB::QuatFromAxisAngle(t_Axis, t_Unit(a_Random) * 3.14f);
+
+	const BB::Mat4x4 t_Translation = BB::Mat4x4FromTranslation(BB::float3{ t_Position(a_Random), t_Position(a_Random), t_Position(a_Random) });
+	return BB::Mat4x4Scale(ScalarMath::Mat4x4Multiply(t_Translation, BB::Mat4x4FromQuat(t_Rotation)),
+		BB::float3{ t_Scale(a_Random), t_Scale(a_Random), t_Scale(a_Random) });
+}
+
+//Exact with the default float settings, the tolerance is for compilers that fuse a multiply and add into an FMA.
+static void ExpectMat4x4Near(const BB::Mat4x4& a_Result, const BB::Mat4x4& a_Expected)
+{
+	for (int r = 0; r < 4; r++)
+		for (int c = 0; c < 4; c++)
+			ASSERT_NEAR(a_Result.e[r][c], a_Expected.e[r][c], 0.0001f + fabsf(a_Expected.e[r][c]) * 0.00001f) << "row " << r << " column " << c;
+}
+
+TEST(Math, Float4_Operators)
+{
+	const BB::float4 t_A{ 1.f, -2.f, 3.5f, 8.f };
+	const BB::float4 t_B{ 4.f, 0.5f, -1.f, 2.f };
+
+	const BB::float4 t_Add = t_A + t_B;
+	const BB::float4 t_Sub = t_A - t_B;
+	const BB::float4 t_Mul = t_A * t_B;
+	const BB::float4 t_MulFloat = t_A * 3.f;
+	const BB::float4 t_Div = t_A / t_B;
+	for (int i = 0; i < 4; i++)
+	{
+		EXPECT_EQ(t_Add.e[i], t_A.e[i] + t_B.e[i]);
+		EXPECT_EQ(t_Sub.e[i], t_A.e[i] - t_B.e[i]);
+		EXPECT_EQ(t_Mul.e[i], t_A.e[i] * t_B.e[i]);
+		EXPECT_EQ(t_MulFloat.e[i], t_A.e[i] * 3.f);
+		EXPECT_EQ(t_Div.e[i], t_A.e[i] / t_B.e[i]);
+	}
+
+	BB::Quat t_QuatA, t_QuatB;
+	t_QuatA.xyzw = t_A;
+	t_QuatB.xyzw = t_B;
+	const BB::Quat t_Quat = t_QuatA * t_QuatB;
+	EXPECT_EQ(t_Quat.x, t_A.x * t_B.x);
+	EXPECT_EQ(t_Quat.w, t_A.w * t_B.w);
+}
+
+TEST(Math, Mat4x4_Same_As_Scalar)
+{
+	std::mt19937 t_Random(1337);
+	for (int i = 0; i < 1000; i++)
+	{
+		const BB::Mat4x4 t_A = RandomNodeTransform(t_Random);
+		const BB::Mat4x4 t_B = RandomNodeTransform(t_Random);
+
+		ExpectMat4x4Near(t_A * t_B, ScalarMath::Mat4x4Multiply(t_A, t_B));
+		const BB::Mat4x4 t_Inverse = BB::Mat4x4Inverse(t_A);
+		ExpectMat4x4Near(t_Inverse, ScalarMath::Mat4x4Inverse(t_A));
+		ExpectMat4x4Near(t_A * t_Inverse, BB::Mat4x4Identity());
+	}
+
+	//A full matrix, the last column of a node transform is always 0, 0, 0, 1.
+	const BB::Mat4x4 t_Projection = BB::Mat4x4Perspective(BB::ToRadians(60.f), 16.f / 9.f, 0.1f, 1000.f) *
+		BB::Mat4x4Lookat(BB::float3{ 0.f, 2.f, 5.f }, BB::float3{ 0.f, 0.f, 0.f }, BB::float3{ 0.f, 1.f, 0.f });
+	ExpectMat4x4Near(BB::Mat4x4Inverse(t_Projection), ScalarMath::Mat4x4Inverse(t_Projection));
+}
+
+TEST(Math, Mat4x4_Batch)
+{
+	std::mt19937 t_Random(42);
+	//Enough for every tail of the 4 and 8 matrix loops.
+	constexpr size_t MATRIX_COUNT = 37;
+	BB::Mat4x4 t_Lhs[MATRIX_COUNT];
+	BB::Mat4x4 t_Rhs[MATRIX_COUNT];
+	BB::Mat4x4 t_Out[MATRIX_COUNT + 1];
+	for (size_t i = 0; i < MATRIX_COUNT; i++)
+	{
+		t_Lhs[i] = RandomNodeTransform(t_Random);
+		t_Rhs[i] = RandomNodeTransform(t_Random);
+	}
+
+	for (size_t t_Count = 0; t_Count <= MATRIX_COUNT; t_Count++)
+	{
+		//The matrix after the last one should not be touched.
+		memset(t_Out, 0xCD, sizeof(t_Out));
+		BB::Mat4x4MultiplyBatch(t_Out, t_Lhs, t_Rhs, t_Count);
+		for (size_t i = 0; i < t_Count; i++)
+			ExpectMat4x4Near(t_Out[i], t_Lhs[i] * t_Rhs[i]);
+		EXPECT_EQ(t_Out[t_Count].r0.x, t_Out[MATRIX_COUNT].r0.x);
+
+		memset(t_Out, 0xCD, sizeof(t_Out));
+		BB::Mat4x4InverseBatch(t_Out, t_Lhs, t_Count);
+		for (size_t i = 0; i < t_Count; i++)
+			ExpectMat4x4Near(t_Out[i], BB::Mat4x4Inverse(t_Lhs[i]));
+		EXPECT_EQ(t_Out[t_Count].r0.x, t_Out[MATRIX_COUNT].r0.x);
+	}
+
+	//In place.
+	BB::Mat4x4 t_InPlace[MATRIX_COUNT];
+	memcpy(t_InPlace, t_Lhs, sizeof(t_InPlace));
+	BB::Mat4x4InverseBatch(t_InPlace, t_InPlace, MATRIX_COUNT);
+	for (size_t i = 0; i < MATRIX_COUNT; i++)
+		ExpectMat4x4Near(t_InPlace[i], BB::Mat4x4Inverse(t_Lhs[i]));
+
+	BB::Mat4x4MultiplyBatch(t_InPlace, t_Lhs, t_InPlace, MATRIX_COUNT);
+	for (size_t i = 0; i < MATRIX_COUNT; i++)
+		ExpectMat4x4Near(t_InPlace[i], BB::Mat4x4Identity());
+}
+
+//Translation, rotation and scale streams like the TransformPool stores them.
+static void RandomTRS(std::mt19937& a_Random, BB::float3& a_Position, BB::Quat& a_Rotation, BB::float3& a_Scale)
+{
+	std::uniform_real_distribution<float> t_Position(-100.f, 100.f);
+	std::uniform_real_distribution<float> t_Unit(-1.f, 1.f);
+	std::uniform_real_distribution<float> t_Scale(0.25f, 4.f);
+
+	const BB::float3 t_Axis = BB::Float3Normalize(BB::float3{ t_Unit(a_Random), t_Unit(a_Random), t_Unit(a_Random) + 2.f });
+	a_Position = BB::float3{ t_Position(a_Random), t_Position(a_Random), t_Position(a_Random) };
+	a_Rotation = BB::QuatFromAxisAngle(t_Axis, t_Unit(a_Random) * 3.14f);
+	a_Scale = BB::float3{ t_Scale(a_Random), t_Scale(a_Random), t_Scale(a_Random) };
+}
+
+struct alignas(16) TRSBatchMatrices
+{
+	BB::Mat4x4 transform;
+	BB::Mat4x4 inverse;
+};
+
+TEST(Math, Mat4x4_From_TRS_Batch)
+{
+	std::mt19937 t_Random(23);
+	//Enough for every tail of the 4 transform loop.
+	constexpr uint32_t TRANSFORM_COUNT = 37;
+	BB::float3 t_Positions[TRANSFORM_COUNT];
+	BB::Quat t_Rotations[TRANSFORM_COUNT];
+	BB::float3 t_Scales[TRANSFORM_COUNT];
+	for (uint32_t i = 0; i < TRANSFORM_COUNT; i++)
+		RandomTRS(t_Random, t_Positions[i], t_Rotations[i], t_Scales[i]);
+
+	//Out of order like the dirty transforms of a pool, 10 and 37 share no factor so every index shows up once.
+	uint32_t t_Indices[TRANSFORM_COUNT];
+	for (uint32_t i = 0; i < TRANSFORM_COUNT; i++)
+		t_Indices[i] = (i * 10 + 3) % TRANSFORM_COUNT;
+
+	TRSBatchMatrices t_Out[TRANSFORM_COUNT];
+	TRSBatchMatrices t_Untouched;
+	memset(&t_Untouched, 0xCD, sizeof(t_Untouched));
+
+	for (uint32_t t_Count = 0; t_Count <= TRANSFORM_COUNT; t_Count++)
+	{
+		//Both the cached and the streaming stores.
+		for (int t_Stream = 0; t_Stream < 2; t_Stream++)
+		{
+			memset(t_Out, 0xCD, sizeof(t_Out));
+			BB::Mat4x4FromTRSBatch(&t_Out->transform, &t_Out->inverse, sizeof(TRSBatchMatrices),
+				t_Positions, t_Rotations, t_Scales, t_Indices, t_Count, t_Stream == 1);
+
+			for (uint32_t i = 0; i < t_Count; i++)
+			{
+				const uint32_t t_Index = t_Indices[i];
+				const BB::Mat4x4 t_Expected = BB::Mat4x4FromTRS(t_Positions[t_Index], t_Rotations[t_Index], t_Scales[t_Index]);
+				ExpectMat4x4Near(t_Out[t_Index].transform, t_Expected);
+				ExpectMat4x4Near(t_Out[t_Index].inverse, BB::Mat4x4Inverse(t_Expected));
+			}
+			//Transforms that are not in the index list should not be touched.
+			for (uint32_t i = t_Count; i < TRANSFORM_COUNT; i++)
+				ASSERT_EQ(memcmp(&t_Out[t_Indices[i]], &t_Untouched, sizeof(t_Untouched)), 0) << "transform " << t_Indices[i];
+		}
+	}
+}
+
+TEST(Math_Speed_Comparison, Sponza_Node_Transforms)
+{
+	typedef std::chrono::duration<float, std::milli> ms;
+	constexpr const float MILLITIMEDIVIDE = 1 / 1000.f;
+	//Around the amount of mesh nodes in the Intel Sponza, every node gets a world matrix and its inverse each frame.
+	constexpr size_t NODE_COUNT = 4096;
+	constexpr size_t FRAME_COUNT = 200;
+
+	BB::FreelistAllocator_t t_Allocator(sizeof(BB::Mat4x4) * NODE_COUNT * 4 + BB::kbSize);
+	BB::Mat4x4* t_Parents = reinterpret_cast<BB::Mat4x4*>(BBalloc(t_Allocator, sizeof(BB::Mat4x4) * NODE_COUNT));
+	BB::Mat4x4* t_Locals = reinterpret_cast<BB::Mat4x4*>(BBalloc(t_Allocator, sizeof(BB::Mat4x4) * NODE_COUNT));
+	BB::Mat4x4* t_Worlds = reinterpret_cast<BB::Mat4x4*>(BBalloc(t_Allocator, sizeof(BB::Mat4x4) * NODE_COUNT));
+	BB::Mat4x4* t_Inverses = reinterpret_cast<BB::Mat4x4*>(BBalloc(t_Allocator, sizeof(BB::Mat4x4) * NODE_COUNT));
+
+	std::mt19937 t_Random(7);
+	for (size_t i = 0; i < NODE_COUNT; i++)
+	{
+		t_Parents[i] = RandomNodeTransform(t_Random);
+		t_Locals[i] = RandomNodeTransform(t_Random);
+	}
+
+	//Read a float of every result so the compiler can not skip any frame.
+	float t_CheckSum[3]{};
+
+	auto t_Timer = std::chrono::high_resolution_clock::now();
+	for (size_t t_Frame = 0; t_Frame < FRAME_COUNT; t_Frame++)
+	{
+		for (size_t i = 0; i < NODE_COUNT; i++)
+		{
+			t_Worlds[i] = ScalarMath::Mat4x4Multiply(t_Parents[i], t_Locals[i]);
+			t_Inverses[i] = ScalarMath::Mat4x4Inverse(t_Worlds[i]);
+		}
+		t_CheckSum[0] += t_Inverses[t_Frame % NODE_COUNT].e[3][0];
+	}
+	const float t_ScalarTime = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+
+	t_Timer = std::chrono::high_resolution_clock::now();
+	for (size_t t_Frame = 0; t_Frame < FRAME_COUNT; t_Frame++)
+	{
+		for (size_t i = 0; i < NODE_COUNT; i++)
+		{
+			t_Worlds[i] = t_Parents[i] * t_Locals[i];
+			t_Inverses[i] = BB::Mat4x4Inverse(t_Worlds[i]);
+		}
+		t_CheckSum[1] += t_Inverses[t_Frame % NODE_COUNT].e[3][0];
+	}
+	const float t_SIMDTime = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+
+	t_Timer = std::chrono::high_resolution_clock::now();
+	for (size_t t_Frame = 0; t_Frame < FRAME_COUNT; t_Frame++)
+	{
+		BB::Mat4x4MultiplyBatch(t_Worlds, t_Parents, t_Locals, NODE_COUNT);
+		BB::Mat4x4InverseBatch(t_Inverses, t_Worlds, NODE_COUNT);
+		t_CheckSum[2] += t_Inverses[t_Frame % NODE_COUNT].e[3][0];
+	}
+	const float t_BatchTime = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+
+	EXPECT_NEAR(t_CheckSum[0], t_CheckSum[1], fabsf(t_CheckSum[0]) * 0.0001f + 0.01f);
+	EXPECT_NEAR(t_CheckSum[0], t_CheckSum[2], fabsf(t_CheckSum[0]) * 0.0001f + 0.01f);
+
+	std::cout << "/-----------------------------------------/" << "\n" <<
+		NODE_COUNT << " node transforms and inverses for " << FRAME_COUNT << " frames, with time in MS:" << "\n" <<
+		"Scalar: " << t_ScalarTime << "\n" <<
+		"SIMD per matrix: " << t_SIMDTime << "\n" <<
+		"Batched: " << t_BatchTime << "\n" <<
+		"/-----------------------------------------/" << "\n";
+
+	BBfree(t_Allocator, t_Parents);
+	BBfree(t_Allocator, t_Locals);
+	BBfree(t_Allocator, t_Worlds);
+	BBfree(t_Allocator, t_Inverses);
+}
+
+TEST(Math_Speed_Comparison, Transform_Pool_Matrices)
+{
+	typedef std::chrono::duration<float, std::milli> ms;
+	constexpr const float MILLITIMEDIVIDE = 1 / 1000.f;
+	constexpr uint32_t TRANSFORM_COUNT = 100000;
+	constexpr size_t FRAME_COUNT = 20;
+	//Most objects in a scene do not move, a tenth changes every frame.
+	constexpr uint32_t DIRTY_STEP = 10;
+
+	BB::FreelistAllocator_t t_Allocator(sizeof(TRSBatchMatrices) * TRANSFORM_COUNT + sizeof(BB::float3) * TRANSFORM_COUNT * 2 +
+		sizeof(BB::Quat) * TRANSFORM_COUNT + sizeof(uint32_t) * TRANSFORM_COUNT + BB::kbSize);
+	BB::float3* t_Positions = reinterpret_cast<BB::float3*>(BBalloc(t_Allocator, sizeof(BB::float3) * TRANSFORM_COUNT));
+	BB::Quat* t_Rotations = reinterpret_cast<BB::Quat*>(BBalloc(t_Allocator, sizeof(BB::Quat) * TRANSFORM_COUNT));
+	BB::float3* t_Scales = reinterpret_cast<BB::float3*>(BBalloc(t_Allocator, sizeof(BB::float3) * TRANSFORM_COUNT));
+	uint32_t* t_Indices = reinterpret_cast<uint32_t*>(BBalloc(t_Allocator, sizeof(uint32_t) * TRANSFORM_COUNT));
+	//Freelist allocations are not 16 byte aligned, so get some extra space to align the streamed matrices.
+	void* t_MatrixMemory = BBalloc(t_Allocator, sizeof(TRSBatchMatrices) * TRANSFORM_COUNT + 16);
+	TRSBatchMatrices* t_Matrices = reinterpret_cast<TRSBatchMatrices*>((reinterpret_cast<uintptr_t>(t_MatrixMemory) + 15) & ~static_cast<uintptr_t>(15));
+
+	std::mt19937 t_Random(11);
+	for (uint32_t i = 0; i < TRANSFORM_COUNT; i++)
+	{
+		RandomTRS(t_Random, t_Positions[i], t_Rotations[i], t_Scales[i]);
+		t_Indices[i] = i;
+	}
+
+	//Read a float of every result so the compiler can not skip any frame.
+	float t_CheckSum[2]{};
+
+	auto t_Timer = std::chrono::high_resolution_clock::now();
+	for (size_t t_Frame = 0; t_Frame < FRAME_COUNT; t_Frame++)
+	{
+		for (uint32_t i = 0; i < TRANSFORM_COUNT; i++)
+		{
+			const BB::Mat4x4 t_Matrix = BB::Mat4x4FromTRS(t_Positions[i], t_Rotations[i], t_Scales[i]);
+			t_Matrices[i].transform = t_Matrix;
+			t_Matrices[i].inverse = BB::Mat4x4Inverse(t_Matrix);
+		}
+		t_CheckSum[0] += t_Matrices[t_Frame].inverse.e[3][0];
+	}
+	const float t_PerObjectTime = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+
+	t_Timer = std::chrono::high_resolution_clock::now();
+	for (size_t t_Frame = 0; t_Frame < FRAME_COUNT; t_Frame++)
+	{
+		BB::Mat4x4FromTRSBatch(&t_Matrices->transform, &t_Matrices->inverse, sizeof(TRSBatchMatrices),
+			t_Positions, t_Rotations, t_Scales, t_Indices, TRANSFORM_COUNT, true);
+		t_CheckSum[1] += t_Matrices[t_Frame].inverse.e[3][0];
+	}
+	const float t_BatchTime = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+
+	//Only the dirty ones, a different tenth every frame.
+	uint32_t t_DirtyCount = 0;
+	t_Timer = std::chrono::high_resolution_clock::now();
+	for (size_t t_Frame = 0; t_Frame < FRAME_COUNT; t_Frame++)
+	{
+		t_DirtyCount = 0;
+		for (uint32_t i = static_cast<uint32_t>(t_Frame % DIRTY_STEP); i < TRANSFORM_COUNT; i += DIRTY_STEP)
+			t_Indices[t_DirtyCount++] = i;
+		BB::Mat4x4FromTRSBatch(&t_Matrices->transform, &t_Matrices->inverse, sizeof(TRSBatchMatrices),
+			t_Positions, t_Rotations, t_Scales, t_Indices, t_DirtyCount, true);
+	}
+	const float t_DirtyTime = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+
+	EXPECT_NEAR(t_CheckSum[0], t_CheckSum[1], fabsf(t_CheckSum[0]) * 0.0001f + 0.01f);
+
+	std::cout << "/-----------------------------------------/" << "\n" <<
+		TRANSFORM_COUNT << " transform matrices and inverses for " << FRAME_COUNT << " frames, with time in MS:" << "\n" <<
+		"Per object: " << t_PerObjectTime << "\n" <<
+		"Batched: " << t_BatchTime << "\n" <<
+		"Batched, " << t_DirtyCount << " dirty: " << t_DirtyTime << "\n" <<
+		"/-----------------------------------------/" << "\n";
+
+	BB::BBfree(t_Allocator, t_Positions);
+	BB::BBfree(t_Allocator, t_Rotations);
+	BB::BBfree(t_Allocator, t_Scales);
+	BB::BBfree(t_Allocator, t_Indices);
+	BB::BBfree(t_Allocator, t_MatrixMemory);
+}
\ No newline at end of file
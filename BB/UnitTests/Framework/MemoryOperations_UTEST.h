@@ -497,4 +497,163 @@ TEST(MemoryOperation_Speed_Comparison, MemSet_Aligend)
 #pragma endregion //BigBuff
 
 	t_FixedAllocator.Clear();
-}
\ No newline at end of file
+}
+
+struct MemoryKernel_Versions
+{
+	const char* name;
+	void (*memCpy)(void* __restrict, const void* __restrict, size_t);
+	void (*memSet)(void* __restrict, const int32_t, size_t);
+	bool (*memCmp)(const void* __restrict, const void* __restrict, size_t);
+};
+
+//Only the versions this CPU can run.
+static uint32_t GetMemoryKernelVersions(MemoryKernel_Versions a_Versions[5])
+{
+	uint32_t t_Count = 0;
+	a_Versions[t_Count++] = { "dispatched", BB::Memory::MemCpy, BB::Memory::MemSet, BB::Memory::MemCmp };
+	a_Versions[t_Count++] = { "stream", BB::Memory::MemCpyStream, BB::Memory::MemSet, BB::Memory::MemCmp };
+	a_Versions[t_Count++] = { "SIMD128", BB::Memory::MemCpySIMD128, BB::Memory::MemSetSIMD128, BB::Memory::MemCmpSIMD128 };
+	if (BB::Memory::GetSIMDLevel() >= BB::Memory::SIMD_LEVEL::AVX2)
+		a_Versions[t_Count++] = { "SIMD256", BB::Memory::MemCpySIMD256, BB::Memory::MemSetSIMD256, BB::Memory::MemCmpSIMD256 };
+	if (BB::Memory::GetSIMDLevel() >= BB::Memory::SIMD_LEVEL::AVX512)
+		a_Versions[t_Count++] = { "SIMD512", BB::Memory::MemCpySIMD512, BB::Memory::MemSetSIMD512, BB::Memory::MemCmpSIMD512 };
+	return t_Count;
+}
+
+TEST(MemoryOperation, Unaligned_Sizes_And_Tails)
+{
+	constexpr size_t MAX_SIZE = 600;
+	constexpr size_t GUARD = 64;
+	constexpr uint8_t GUARD_VALUE = 0xCD;
+
+	MemoryKernel_Versions t_Versions[5];
+	const uint32_t t_VersionCount = GetMemoryKernelVersions(t_Versions);
+
+	uint8_t t_Source[MAX_SIZE + 64];
+	for (size_t i = 0; i < sizeof(t_Source); i++)
+		t_Source[i] = static_cast<uint8_t>(i * 7 + 3);
+	uint8_t t_Destination[GUARD + MAX_SIZE + 64 + GUARD];
+
+	for (uint32_t t_Version = 0; t_Version < t_VersionCount; t_Version++)
+	{
+		const MemoryKernel_Versions& t_Kernels = t_Versions[t_Version];
+		for (size_t t_Size = 0; t_Size <= MAX_SIZE; t_Size++)
+		{
+			//Different alignments for the source and destination so the head and tail paths all get hit.
+			const size_t t_SrcOffset = t_Size % 7;
+			const size_t t_DstOffset = GUARD + t_Size % 13;
+
+			memset(t_Destination, GUARD_VALUE, sizeof(t_Destination));
+			t_Kernels.memCpy(t_Destination + t_DstOffset, t_Source + t_SrcOffset, t_Size);
+			ASSERT_EQ(memcmp(t_Destination + t_DstOffset, t_Source + t_SrcOffset, t_Size), 0) << t_Kernels.name << " MemCpy wrong at size " << t_Size;
+			ASSERT_EQ(t_Destination[t_DstOffset - 1], GUARD_VALUE) << t_Kernels.name << " MemCpy wrote before the destination at size " << t_Size;
+			ASSERT_EQ(t_Destination[t_DstOffset + t_Size], GUARD_VALUE) << t_Kernels.name << " MemCpy wrote past the destination at size " << t_Size;
+
+			ASSERT_TRUE(t_Kernels.memCmp(t_Destination + t_DstOffset, t_Source + t_SrcOffset, t_Size)) << t_Kernels.name << " MemCmp at size " << t_Size;
+			if (t_Size != 0)
+			{
+				//A difference in the first, middle and last byte.
+				for (const size_t t_Index : { static_cast<size_t>(0), t_Size / 2, t_Size - 1 })
+				{
+					t_Destination[t_DstOffset + t_Index] ^= 0x10;
+					ASSERT_FALSE(t_Kernels.memCmp(t_Destination + t_DstOffset, t_Source + t_SrcOffset, t_Size)) << t_Kernels.name << " MemCmp missed byte " << t_Index << " at size " << t_Size;
+					t_Destination[t_DstOffset + t_Index] ^= 0x10;
+				}
+			}
+
+			memset(t_Destination, GUARD_VALUE, sizeof(t_Destination));
+			//Only the lowest byte is used, like memset.
+			t_Kernels.memSet(t_Destination + t_DstOffset, 0x1234, t_Size);
+			for (size_t i = 0; i < t_Size; i++)
+				ASSERT_EQ(t_Destination[t_DstOffset + i], 0x34) << t_Kernels.name << " MemSet wrong at size " << t_Size;
+			ASSERT_EQ(t_Destination[t_DstOffset - 1], GUARD_VALUE) << t_Kernels.name << " MemSet wrote before the destination at size " << t_Size;
+			ASSERT_EQ(t_Destination[t_DstOffset + t_Size], GUARD_VALUE) << t_Kernels.name << " MemSet wrote past the destination at size " << t_Size;
+		}
+	}
+
+	//Big enough for MemCpy to switch to streaming stores.
+	BB::FreelistAllocator_t t_Allocator{ BB::Memory::MEMCPY_STREAM_THRESHOLD * 2 + BB::kbSize * 4 };
+	const size_t t_BigSize = BB::Memory::MEMCPY_STREAM_THRESHOLD + 3;
+	uint8_t* t_BigSource = BBnewArr(t_Allocator, t_BigSize, uint8_t);
+	uint8_t* t_BigDestination = BBnewArr(t_Allocator, t_BigSize + 1, uint8_t);
+	FillBuffer(t_BigSource, t_BigSize);
+	t_BigDestination[t_BigSize] = GUARD_VALUE;
+	BB::Memory::MemCpy(t_BigDestination + 1, t_BigSource, t_BigSize - 1);
+	EXPECT_EQ(memcmp(t_BigDestination + 1, t_BigSource, t_BigSize - 1), 0);
+	EXPECT_TRUE(BB::Memory::MemCmp(t_BigDestination + 1, t_BigSource, t_BigSize - 1));
+	EXPECT_EQ(t_BigDestination[t_BigSize], GUARD_VALUE);
+	BBfreeArr(t_Allocator, t_BigDestination);
+	BBfreeArr(t_Allocator, t_BigSource);
+}
+
+TEST(MemoryOperation_Speed_Comparison, Size_Sweep)
+{
+	typedef std::chrono::duration<float, std::milli> ms;
+	constexpr const float MILLITIMEDIVIDE = 1 / 1000.f;
+	constexpr size_t MIN_SIZE = 16;
+	constexpr size_t MAX_SIZE = mbSize * 64;
+	//Roughly the same amount of bytes for every size, so small sizes are not lost in the timer resolution.
+	constexpr size_t BYTES_PER_SIZE = mbSize * 256;
+
+	BB::FixedLinearAllocator_t t_FixedAllocator(MAX_SIZE * 2 + BB::kbSize);
+	uint8_t* t_Source = BBnewArr(t_FixedAllocator, MAX_SIZE, uint8_t);
+	uint8_t* t_Destination = BBnewArr(t_FixedAllocator, MAX_SIZE, uint8_t);
+	FillBuffer(t_Source, MAX_SIZE);
+	memset(t_Destination, 0, MAX_SIZE);
+
+	static const char* s_LevelNames[] = { "SSE2", "AVX2", "AVX512" };
+	std::cout << "/-----------------------------------------/" << "\n" << "Memory kernels picked: " << s_LevelNames[static_cast<uint32_t>(BB::Memory::GetSIMDLevel())] << "\n";
+	std::cout << "size in bytes | BB MemCpy | memcpy | BB MemSet | memset | BB MemCmp | memcmp, with time in MS:" << "\n";
+
+	//Called through pointers, the compiler would otherwise take the libc calls out of the loops.
+	void* (*volatile t_LibcMemCpy)(void*, const void*, size_t) = memcpy;
+	void* (*volatile t_LibcMemSet)(void*, int, size_t) = memset;
+	int (*volatile t_LibcMemCmp)(const void*, const void*, size_t) = memcmp;
+
+	bool t_AllEqual = true;
+	for (size_t t_Size = MIN_SIZE; t_Size <= MAX_SIZE; t_Size *= 4)
+	{
+		const size_t t_Repeats = BYTES_PER_SIZE / t_Size > 0 ? BYTES_PER_SIZE / t_Size : 1;
+		float t_Times[6];
+
+		auto t_Timer = std::chrono::high_resolution_clock::now();
+		for (size_t i = 0; i < t_Repeats; i++)
+			BB::Memory::MemCpy(t_Destination, t_Source, t_Size);
+		t_Times[0] = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+
+		t_Timer = std::chrono::high_resolution_clock::now();
+		for (size_t i = 0; i < t_Repeats; i++)
+			t_LibcMemCpy(t_Destination, t_Source, t_Size);
+		t_Times[1] = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+
+		t_Timer = std::chrono::high_resolution_clock::now();
+		for (size_t i = 0; i < t_Repeats; i++)
+			BB::Memory::MemSet(t_Destination, static_cast<int32_t>(i), t_Size);
+		t_Times[2] = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+
+		t_Timer = std::chrono::high_resolution_clock::now();
+		for (size_t i = 0; i < t_Repeats; i++)
+			t_LibcMemSet(t_Destination, static_cast<int32_t>(i), t_Size);
+		t_Times[3] = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+
+		memcpy(t_Destination, t_Source, t_Size);
+		t_Timer = std::chrono::high_resolution_clock::now();
+		for (size_t i = 0; i < t_Repeats; i++)
+			t_AllEqual &= BB::Memory::MemCmp(t_Destination, t_Source, t_Size);
+		t_Times[4] = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+
+		t_Timer = std::chrono::high_resolution_clock::now();
+		for (size_t i = 0; i < t_Repeats; i++)
+			t_AllEqual &= t_LibcMemCmp(t_Destination, t_Source, t_Size) == 0;
+		t_Times[5] = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+
+		std::cout << t_Size << " x" << t_Repeats;
+		for (size_t i = 0; i < _countof(t_Times); i++)
+			std::cout << " | " << t_Times[i];
+		std::cout << "\n";
+	}
+	EXPECT_TRUE(t_AllEqual);
+
+	t_FixedAllocator.Clear();
+}
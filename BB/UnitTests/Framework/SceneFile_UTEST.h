@@ -0,0 +1,180 @@
+#pragma once
+#include "../TestValues.h"
+#include "SceneFile.hpp"
+#include "BBjson.hpp"
+#include "OS/Program.h"
+#include <string>
+#include <chrono>
+
+TEST(SceneFile, Json_To_Scene_File)
+{
+	using namespace BB;
+	char t_JsonFile[] = R"(
+{
+  "scene": {
+    "scene_name" : "unittest_scene",
+    "scene_lights": [
+      { "radius": 10.0, "position": [ 1.0, 2.0, 3.0 ], "color": [ 255.0, 128.0, 64.0, 1.0 ] },
+      { "radius": 2.5, "position": [ -1.0, -2.0, -3.0 ], "color": [ 0.0, 0.0, 0.0, 0.0 ] }
+    ],
+    "scene_models": [
+      { "path": "Resources/Models/Duck.gltf", "position": [ 0.0, -1.0, 1.0 ] },
+      { "path": "Resources/Models/Sponza.gltf", "position": [ 0.0, 10.0, 0.0 ], "rotation": [ 0.0, 0.0, 0.0, 1.0 ], "scale": [ 0.1, 0.1, 0.1 ] }
+    ]
+  }
+}
+	)";
+
+	LinearAllocator_t t_Allocator{ kbSize * 16 };
+	const Buffer t_SceneBuffer = ConvertJsonToSceneFile(t_Allocator, Buffer{ t_JsonFile, _countof(t_JsonFile) });
+	ASSERT_NE(t_SceneBuffer.size, 0u);
+
+	const SceneFile t_SceneFile{ t_SceneBuffer };
+	ASSERT_TRUE(t_SceneFile.IsValid());
+	EXPECT_STREQ(t_SceneFile.GetSceneName(), "unittest_scene");
+
+	const Slice<const SceneFileLight> t_Lights = t_SceneFile.GetLights();
+	ASSERT_EQ(t_Lights.size(), 2u);
+	EXPECT_EQ(t_Lights[0].radius, 10.f);
+	EXPECT_EQ(t_Lights[0].pos.z, 3.f);
+	EXPECT_EQ(t_Lights[0].color.y, 128.f);
+	EXPECT_EQ(t_Lights[1].radius, 2.5f);
+	EXPECT_EQ(t_Lights[1].pos.x, -1.f);
+
+	const Slice<const SceneFileTransform> t_Transforms = t_SceneFile.GetTransforms();
+	const Slice<const SceneFileModel> t_Models = t_SceneFile.GetModels();
+	ASSERT_EQ(t_Transforms.size(), 2u);
+	ASSERT_EQ(t_Models.size(), 2u);
+	EXPECT_STREQ(t_SceneFile.GetString(t_Models[0].path), "Resources/Models/Duck.gltf");
+	EXPECT_STREQ(t_SceneFile.GetString(t_Models[1].path), "Resources/Models/Sponza.gltf");
+	//Missing rotation and scale get the identity.
+	const SceneFileTransform& t_DuckTransform = t_Transforms[t_Models[0].transform];
+	EXPECT_EQ(t_DuckTransform.position.y, -1.f);
+	EXPECT_EQ(t_DuckTransform.rotation.w, 1.f);
+	EXPECT_EQ(t_DuckTransform.scale.x, 1.f);
+	EXPECT_EQ(t_Transforms[t_Models[1].transform].scale.z, 0.1f);
+
+	//Nothing is copied, every array points into the file.
+	EXPECT_EQ(reinterpret_cast<const char*>(t_Lights.data()), t_SceneBuffer.data + reinterpret_cast<const SceneFileHeader*>(t_SceneBuffer.data)->lights.offset);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(t_Transforms.data()) % SCENE_FILE_SECTION_ALIGNMENT, reinterpret_cast<uintptr_t>(t_SceneBuffer.data) % SCENE_FILE_SECTION_ALIGNMENT);
+	EXPECT_EQ(t_SceneFile.GetString(UINT32_MAX), nullptr);
+
+	t_Allocator.Clear();
+}
+
+TEST(SceneFile, Reject_Broken_Files)
+{
+	using namespace BB;
+	char t_JsonFile[] = R"({ "scene": { "scene_name" : "broken", "scene_lights": [ { "radius": 1.0, "position": [ 0, 0, 0 ], "color": [ 1, 1, 1, 1 ] } ] } })";
+
+	LinearAllocator_t t_Allocator{ kbSize * 16 };
+	const Buffer t_SceneBuffer = ConvertJsonToSceneFile(t_Allocator, Buffer{ t_JsonFile, _countof(t_JsonFile) });
+	//One extra section so a misaligned copy fits too.
+	char* t_Copy = reinterpret_cast<char*>(BBalloc_f(BB_MEMORY_DEBUG_ARGS t_Allocator, t_SceneBuffer.size + SCENE_FILE_SECTION_ALIGNMENT, SCENE_FILE_SECTION_ALIGNMENT));
+	SceneFileHeader* t_Header = reinterpret_cast<SceneFileHeader*>(t_Copy);
+
+	const auto t_IsValid = [&](const uint64_t a_Size)
+	{
+		return SceneFile(Buffer{ t_Copy, a_Size }).IsValid();
+	};
+
+	memcpy(t_Copy, t_SceneBuffer.data, t_SceneBuffer.size);
+	EXPECT_TRUE(t_IsValid(t_SceneBuffer.size));
+	EXPECT_FALSE(t_IsValid(t_SceneBuffer.size - 1)) << "truncated file is accepted";
+	EXPECT_FALSE(t_IsValid(sizeof(SceneFileHeader) - 1)) << "file smaller then the header is accepted";
+
+	t_Header->version = SCENE_FILE_VERSION + 1;
+	EXPECT_FALSE(t_IsValid(t_SceneBuffer.size)) << "file with a newer version is accepted";
+
+	memcpy(t_Copy, t_SceneBuffer.data, t_SceneBuffer.size);
+	t_Header->lights.count = UINT32_MAX;
+	EXPECT_FALSE(t_IsValid(t_SceneBuffer.size)) << "section outside of the file is accepted";
+
+	memcpy(t_Copy, t_SceneBuffer.data, t_SceneBuffer.size);
+	t_Copy[t_SceneBuffer.size - 1] = 'x';
+	EXPECT_FALSE(t_IsValid(t_SceneBuffer.size)) << "string table without a null terminator is accepted";
+
+	memcpy(t_Copy + sizeof(uint64_t), t_SceneBuffer.data, t_SceneBuffer.size);
+	EXPECT_FALSE(SceneFile(Buffer{ t_Copy + sizeof(uint64_t), t_SceneBuffer.size }).IsValid()) << "misaligned file is accepted";
+
+	EXPECT_EQ(ConvertJsonToSceneFile(t_Allocator, Buffer{ t_JsonFile + 1, 2 }).size, 0u);
+	t_Allocator.Clear();
+}
+
+TEST(SceneFile, SceneFile_Speedtest)
+{
+	using namespace BB;
+	typedef std::chrono::duration<float, std::milli> ms;
+	constexpr const float MILLITIMEDIVIDE = 1 / 1000.f;
+	constexpr const uint32_t LIGHT_COUNT = 8192;
+	constexpr const uint32_t MODEL_COUNT = 1024;
+	constexpr const char* JSON_NAME = "SCENEFILETEST.json";
+	constexpr const char* SCENE_NAME = "SCENEFILETEST.bbscene";
+
+	std::string t_Json = "{ \"scene\": { \"scene_name\": \"speedtest_scene\", \"scene_lights\": [\n";
+	for (uint32_t i = 0; i < LIGHT_COUNT; i++)
+	{
+		t_Json += "{ \"radius\": " + std::to_string(i % 50) + ".5, \"position\": [ " + std::to_string(i) + ".25, -3.5, 12.0 ], ";
+		t_Json += "\"color\": [ 255.0, 128.0, " + std::to_string(i & 255) + ".0, 1.0 ] }";
+		t_Json += i + 1 < LIGHT_COUNT ? ",\n" : "\n";
+	}
+	t_Json += "], \"scene_models\": [\n";
+	for (uint32_t i = 0; i < MODEL_COUNT; i++)
+	{
+		t_Json += "{ \"path\": \"Resources/Models/model_" + std::to_string(i) + ".gltf\", \"position\": [ 1.0, 2.0, 3.0 ], \"scale\": [ 0.5, 0.5, 0.5 ] }";
+		t_Json += i + 1 < MODEL_COUNT ? ",\n" : "\n";
+	}
+	t_Json += "] } }";
+
+	LinearAllocator_t t_Allocator{ mbSize * 8 };
+	{
+		Buffer t_JsonBuffer{ t_Json.data(), t_Json.size() };
+		OSFileHandle t_JsonFile = CreateOSFile(JSON_NAME);
+		WriteToFile(t_JsonFile, t_JsonBuffer);
+		CloseOSFile(t_JsonFile);
+
+		OSFileHandle t_SceneFile = CreateOSFile(SCENE_NAME);
+		WriteToFile(t_SceneFile, ConvertJsonToSceneFile(t_Allocator, t_JsonBuffer));
+		CloseOSFile(t_SceneFile);
+	}
+
+	std::cout << "/-----------------------------------------/" << "\n" << "Scene load with " << LIGHT_COUNT << " lights and " << MODEL_COUNT << " models, " << t_Json.size() / kbSize << "KB json, with time in MS:" << "\n";
+
+	//The path SceneGraph takes for a json scene, parse the whole tree and walk the lights.
+	auto t_Timer = std::chrono::high_resolution_clock::now();
+	float t_JsonRadius = 0;
+	{
+		JsonParser t_Parser(JSON_NAME);
+		t_Parser.Parse();
+		const JsonObject& t_Scene = *(*t_Parser.GetRootNode()->GetObject()->map.find("scene"_sid))->GetObject();
+		const JsonList& t_LightList = (*t_Scene.map.find("scene_lights"_sid))->GetList();
+		SceneFileLight* t_Lights = BBnewArr(t_Allocator, t_LightList.nodeCount, SceneFileLight);
+		for (uint32_t i = 0; i < t_LightList.nodeCount; i++)
+		{
+			const JsonObject& t_Light = *t_LightList.nodes[i]->GetObject();
+			t_Lights[i].radius = (*t_Light.map.find("radius"_sid))->GetNumber();
+			const JsonList& t_Position = (*t_Light.map.find("position"_sid))->GetList();
+			for (uint32_t j = 0; j < 3; j++)
+				t_Lights[i].pos.e[j] = t_Position.nodes[j]->GetNumber();
+			const JsonList& t_Color = (*t_Light.map.find("color"_sid))->GetList();
+			for (uint32_t j = 0; j < 4; j++)
+				t_Lights[i].color.e[j] = t_Color.nodes[j]->GetNumber();
+			t_JsonRadius += t_Lights[i].radius;
+		}
+	}
+	auto t_Speed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+	std::cout << "json file, parse and walk the tree: " << t_Speed << "\n";
+
+	t_Timer = std::chrono::high_resolution_clock::now();
+	float t_BinaryRadius = 0;
+	{
+		const SceneFile t_SceneFile{ SCENE_NAME };
+		for (const SceneFileLight& t_Light : t_SceneFile.GetLights())
+			t_BinaryRadius += t_Light.radius;
+	}
+	t_Speed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+	std::cout << "binary scene file, used in place: " << t_Speed << "\n";
+
+	EXPECT_EQ(t_JsonRadius, t_BinaryRadius);
+	t_Allocator.Clear();
+}
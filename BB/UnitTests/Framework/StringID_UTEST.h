@@ -0,0 +1,183 @@
+#pragma once
+#include "../TestValues.h"
+#include "Utils/StringID.h"
+#include "BBThreadScheduler.hpp"
+#include "BBjson.hpp"
+#include <chrono>
+
+TEST(StringID, Compile_Time_Equals_Runtime)
+{
+	using namespace BB;
+	constexpr StringID t_LiteralID = "Resources/Textures/unittest_string_id.png"_sid;
+	static_assert(t_LiteralID.IsValid(), "literal StringID is not made at compile time");
+	static_assert("scene"_sid == MakeStringID("scene"), "literal and MakeStringID are not equal");
+	static_assert("scene"_sid != "scene_name"_sid, "different strings have the same StringID");
+
+	EXPECT_EQ(InternString("Resources/Textures/unittest_string_id.png"), t_LiteralID);
+	EXPECT_EQ(InternString("Resources/Textures/unittest_string_id.png", 41), t_LiteralID);
+	EXPECT_FALSE(InternString(nullptr).IsValid());
+	EXPECT_EQ(GetInternedString(StringID()), nullptr);
+}
+
+TEST(StringID, Intern_Keeps_One_Copy)
+{
+	using namespace BB;
+	const uint32_t t_StartCount = GetInternedStringCount();
+
+	char t_Path[] = "Resources/Models/unittest_intern.gltf";
+	const StringID t_ID = InternString(t_Path);
+	const char* t_Interned = GetInternedString(t_ID);
+	ASSERT_NE(t_Interned, nullptr);
+	EXPECT_NE(t_Interned, t_Path);
+	EXPECT_STREQ(t_Interned, t_Path);
+
+	//Changing the source does not change the interned copy, interning it again returns the same copy.
+	t_Path[0] = 'X';
+	EXPECT_STREQ(t_Interned, "Resources/Models/unittest_intern.gltf");
+	EXPECT_EQ(InternString("Resources/Models/unittest_intern.gltf"), t_ID);
+	EXPECT_EQ(GetInternedString(t_ID), t_Interned);
+	EXPECT_EQ(GetInternedStringCount(), t_StartCount + 1);
+
+	//A part of a string can be interned without a null terminator.
+	const StringID t_PartID = InternString("unittest_part_and_more", 13);
+	EXPECT_EQ(t_PartID, "unittest_part"_sid);
+	EXPECT_STREQ(GetInternedString(t_PartID), "unittest_part");
+
+	EXPECT_EQ(GetInternedString("unittest_never_interned"_sid), nullptr);
+}
+
+constexpr const uint32_t STRING_ID_THREAD_STRINGS = 1024;
+constexpr const uint32_t STRING_ID_THREAD_JOBS = 16;
+
+struct StringID_ThreadParam
+{
+	char (*strings)[32];
+	BB::StringID* ids;
+};
+
+//Every job interns the same strings at the same time, they all have to agree on the id and the copy.
+static void StringID_InternJob(void* a_Param)
+{
+	StringID_ThreadParam* t_Param = reinterpret_cast<StringID_ThreadParam*>(a_Param);
+	for (uint32_t i = 0; i < STRING_ID_THREAD_STRINGS; i++)
+	{
+		const BB::StringID t_ID = BB::InternString(t_Param->strings[i]);
+		if (t_ID != t_Param->ids[i] || strcmp(BB::GetInternedString(t_ID), t_Param->strings[i]) != 0)
+			t_Param->ids[i] = BB::StringID();
+	}
+}
+
+TEST(StringID, Intern_From_Threads)
+{
+	char t_Strings[STRING_ID_THREAD_STRINGS][32];
+	BB::StringID t_IDs[STRING_ID_THREAD_STRINGS];
+	for (uint32_t i = 0; i < STRING_ID_THREAD_STRINGS; i++)
+	{
+		snprintf(t_Strings[i], sizeof(t_Strings[i]), "unittest_thread_string_%u", i);
+		t_IDs[i] = BB::MakeStringID(t_Strings[i]);
+	}
+
+	const uint32_t t_StartCount = BB::GetInternedStringCount();
+	const uint32_t t_StartCollisions = BB::GetStringIDCollisionCount();
+
+	StringID_ThreadParam t_Param{ t_Strings, t_IDs };
+	BB::JobCounter t_Counter;
+	for (uint32_t i = 0; i < STRING_ID_THREAD_JOBS; i++)
+		BB::Threads::StartTaskThread(StringID_InternJob, &t_Param, &t_Counter);
+	BB::Threads::WaitForCounter(t_Counter);
+
+	for (uint32_t i = 0; i < STRING_ID_THREAD_STRINGS; i++)
+		ASSERT_EQ(t_IDs[i], BB::MakeStringID(t_Strings[i])) << "thread got a different id or string for " << t_Strings[i];
+
+	EXPECT_EQ(BB::GetInternedStringCount(), t_StartCount + STRING_ID_THREAD_STRINGS);
+	EXPECT_EQ(BB::GetStringIDCollisionCount(), t_StartCollisions);
+}
+
+TEST(StringID, Json_Key_Lookup)
+{
+	using namespace BB;
+	char t_JsonFile[] = R"(
+{
+  "scene_name": "unittest scene",
+  "radius": 5,
+  "position": [1, 2, 3]
+}
+	)";
+
+	Buffer t_JsonBuffer{ t_JsonFile, _countof(t_JsonFile) };
+	JsonParser t_Parser(t_JsonBuffer);
+	t_Parser.Parse();
+	const JsonObject& t_Object = *t_Parser.GetRootNode()->GetObject();
+
+	ASSERT_NE(t_Object.map.find("scene_name"_sid), nullptr);
+	EXPECT_STREQ((*t_Object.map.find("scene_name"_sid))->GetString(), "unittest scene");
+	EXPECT_EQ((*t_Object.map.find("radius"_sid))->GetNumber(), 5.f);
+	EXPECT_EQ((*t_Object.map.find("position"_sid))->GetList().nodeCount, 3u);
+	EXPECT_EQ(t_Object.map.find("color"_sid), nullptr);
+	EXPECT_STREQ(GetInternedString(t_Object.pairLL->name), "scene_name");
+	EXPECT_STREQ(t_Object.pairLL->key, "scene_name");
+	EXPECT_EQ(t_Object.Find("radius"), *t_Object.map.find("radius"_sid));
+	EXPECT_EQ(t_Object.Find("color"), nullptr);
+}
+
+TEST(StringID, Json_Key_Collision)
+{
+	using namespace BB;
+	//These two keys have the same 32 bit id.
+	ASSERT_EQ(MakeStringID("key_32245"), MakeStringID("key_139099"));
+	const StringID t_ID = InternString("key_32245");
+	ASSERT_TRUE(t_ID.IsValid());
+
+	char t_JsonFile[] = R"({ "key_139099": 1, "key_32245": 2 })";
+	Buffer t_JsonBuffer{ t_JsonFile, _countof(t_JsonFile) - 1 };
+	JsonDocument t_Document(t_JsonBuffer);
+
+	const JsonValue t_Value = t_Document.GetRoot().Find(t_ID);
+	ASSERT_TRUE(t_Value.IsValid());
+	EXPECT_EQ(t_Value.GetInteger(), 2) << "Find matched a different key with the same id.";
+	EXPECT_EQ(t_Document.GetRoot().Find("key_139099").GetInteger(), 1);
+}
+
+TEST(StringID, StringID_Speedtest)
+{
+	using namespace BB;
+	typedef std::chrono::duration<float, std::milli> ms;
+	constexpr const float MILLITIMEDIVIDE = 1 / 1000.f;
+	constexpr const uint32_t LOOKUP_COUNT = 1 << 20;
+	constexpr const char* ASSET_PATHS[4]
+	{
+		"Resources/Textures/Sponza/sponza_column_a_diff.png",
+		"Resources/Textures/Sponza/sponza_column_b_diff.png",
+		"Resources/Textures/Sponza/sponza_column_c_diff.png",
+		"Resources/Textures/Sponza/sponza_curtain_blue_diff.png"
+	};
+
+	FreelistAllocator_t t_Allocator{ mbSize * 4 };
+	OL_HashMap<const char*, uint32_t, String_KeyComp> t_StringMap{ t_Allocator, 64 };
+	OL_HashMap<StringID, uint32_t> t_IDMap{ t_Allocator, 64 };
+	StringID t_IDs[4];
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		t_StringMap.insert(ASSET_PATHS[i], i);
+		t_IDs[i] = InternString(ASSET_PATHS[i]);
+		t_IDMap.insert(t_IDs[i], i);
+	}
+
+	std::cout << "/-----------------------------------------/" << "\n" << "Asset path lookup " << LOOKUP_COUNT << " times with time in MS:" << "\n";
+
+	uint64_t t_StringSum = 0;
+	auto t_Timer = std::chrono::high_resolution_clock::now();
+	for (uint32_t i = 0; i < LOOKUP_COUNT; i++)
+		t_StringSum += *t_StringMap.find(ASSET_PATHS[i & 3]);
+	auto t_Speed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+	std::cout << "char* keys, hash and strcmp every lookup: " << t_Speed << "\n";
+
+	uint64_t t_IDSum = 0;
+	t_Timer = std::chrono::high_resolution_clock::now();
+	for (uint32_t i = 0; i < LOOKUP_COUNT; i++)
+		t_IDSum += *t_IDMap.find(t_IDs[i & 3]);
+	t_Speed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+	std::cout << "StringID keys, integer compare every lookup: " << t_Speed << "\n";
+
+	EXPECT_EQ(t_StringSum, t_IDSum);
+}
@@ -0,0 +1,211 @@
+#pragma once
+#include "../TestValues.h"
+#include "BBSync.hpp"
+#include "OS/Program.h"
+#include <chrono>
+
+constexpr const uint32_t SYNC_THREAD_COUNT = 4;
+
+template<typename Lock>
+struct Sync_ThreadParam
+{
+	Lock* lock;
+	//Not atomic, the lock has to protect it.
+	uint64_t* value;
+	uint32_t iterations;
+};
+
+template<typename Lock>
+static void Sync_AddUnderLock(void* a_Param)
+{
+	Sync_ThreadParam<Lock>* t_Param = reinterpret_cast<Sync_ThreadParam<Lock>*>(a_Param);
+	for (uint32_t i = 0; i < t_Param->iterations; i++)
+	{
+		t_Param->lock->lock();
+		//Read and write seperately so a missing lock loses additions.
+		const uint64_t t_Value = *t_Param->value;
+		*t_Param->value = t_Value + 1;
+		t_Param->lock->unlock();
+	}
+}
+
+static void Sync_AddUnderMutex(void* a_Param)
+{
+	Sync_ThreadParam<const BB::BBMutex>* t_Param = reinterpret_cast<Sync_ThreadParam<const BB::BBMutex>*>(a_Param);
+	for (uint32_t i = 0; i < t_Param->iterations; i++)
+	{
+		BB::OSWaitAndLockMutex(*t_Param->lock);
+		const uint64_t t_Value = *t_Param->value;
+		*t_Param->value = t_Value + 1;
+		BB::OSUnlockMutex(*t_Param->lock);
+	}
+}
+
+//Runs a_Func on SYNC_THREAD_COUNT OS threads and waits for all of them.
+template<typename Lock>
+static void Sync_RunThreads(void(*a_Func)(void*), Sync_ThreadParam<Lock>& a_Param)
+{
+	BB::OSThreadHandle t_Threads[SYNC_THREAD_COUNT];
+	for (uint32_t i = 0; i < SYNC_THREAD_COUNT; i++)
+		t_Threads[i] = BB::OSCreateThread(a_Func, 0, &a_Param);
+	for (uint32_t i = 0; i < SYNC_THREAD_COUNT; i++)
+		BB::OSWaitThreadfinish(t_Threads[i]);
+}
+
+template<typename Lock>
+static void Sync_TestMutualExclusion()
+{
+	constexpr const uint32_t ITERATIONS = 100000;
+	BB::LockContention t_Contention;
+	Lock t_Lock{ &t_Contention };
+	uint64_t t_Value = 0;
+	Sync_ThreadParam<Lock> t_Param{ &t_Lock, &t_Value, ITERATIONS };
+
+	Sync_RunThreads(Sync_AddUnderLock<Lock>, t_Param);
+	EXPECT_EQ(t_Value, static_cast<uint64_t>(SYNC_THREAD_COUNT) * ITERATIONS) << "the lock let two threads in at the same time";
+	EXPECT_EQ(t_Contention.acquires.load(), static_cast<uint64_t>(SYNC_THREAD_COUNT) * ITERATIONS);
+	EXPECT_LE(t_Contention.contended.load(), t_Contention.acquires.load());
+
+	//Free again after all the threads are done.
+	EXPECT_TRUE(t_Lock.try_lock());
+	EXPECT_FALSE(t_Lock.try_lock());
+	t_Lock.unlock();
+}
+
+TEST(Sync, FutexMutex_Mutual_Exclusion)
+{
+	Sync_TestMutualExclusion<BB::FutexMutex>();
+}
+
+TEST(Sync, TicketLock_Mutual_Exclusion)
+{
+	Sync_TestMutualExclusion<BB::TicketLock>();
+}
+
+struct Sync_RWParam
+{
+	BB::RWLock* lock;
+	uint64_t* values;
+	uint32_t valueCount;
+	std::atomic<uint32_t>* readersInside;
+	std::atomic<uint32_t> tornReads{ 0 };
+	std::atomic<uint32_t> writesDone{ 0 };
+};
+
+//Every write sets all the values to the same number, a reader that sees different numbers read during a write.
+static void Sync_RWReadersAndWriter(void* a_Param)
+{
+	Sync_RWParam* t_Param = reinterpret_cast<Sync_RWParam*>(a_Param);
+	for (uint32_t i = 0; i < 20000; i++)
+	{
+		if (i % 16 == 0)
+		{
+			t_Param->lock->lock();
+			EXPECT_EQ(t_Param->readersInside->load(), 0u);
+			for (uint32_t j = 0; j < t_Param->valueCount; j++)
+				t_Param->values[j] = i;
+			t_Param->writesDone.fetch_add(1, std::memory_order_relaxed);
+			t_Param->lock->unlock();
+			continue;
+		}
+
+		t_Param->lock->lock_shared();
+		t_Param->readersInside->fetch_add(1);
+		for (uint32_t j = 1; j < t_Param->valueCount; j++)
+			if (t_Param->values[j] != t_Param->values[0])
+				t_Param->tornReads.fetch_add(1, std::memory_order_relaxed);
+		t_Param->readersInside->fetch_sub(1);
+		t_Param->lock->unlock_shared();
+	}
+}
+
+TEST(Sync, RWLock_Readers_And_Writers)
+{
+	BB::LockContention t_Contention;
+	BB::RWLock t_Lock{ &t_Contention };
+	uint64_t t_Values[32]{};
+	std::atomic<uint32_t> t_ReadersInside{ 0 };
+	Sync_RWParam t_Param;
+	t_Param.lock = &t_Lock;
+	t_Param.values = t_Values;
+	t_Param.valueCount = _countof(t_Values);
+	t_Param.readersInside = &t_ReadersInside;
+
+	BB::OSThreadHandle t_Threads[SYNC_THREAD_COUNT];
+	for (uint32_t i = 0; i < SYNC_THREAD_COUNT; i++)
+		t_Threads[i] = BB::OSCreateThread(Sync_RWReadersAndWriter, 0, &t_Param);
+	for (uint32_t i = 0; i < SYNC_THREAD_COUNT; i++)
+		BB::OSWaitThreadfinish(t_Threads[i]);
+
+	EXPECT_EQ(t_Param.tornReads.load(), 0u) << "a reader got in while a writer was writing";
+	EXPECT_EQ(t_Param.writesDone.load(), SYNC_THREAD_COUNT * (20000 / 16));
+	EXPECT_EQ(t_Contention.acquires.load(), static_cast<uint64_t>(SYNC_THREAD_COUNT) * 20000);
+
+	//Readers share the lock, a writer has to wait for all of them.
+	t_Lock.lock_shared();
+	t_Lock.lock_shared();
+	t_Lock.unlock_shared();
+	t_Lock.unlock_shared();
+	t_Lock.lock();
+	t_Lock.unlock();
+}
+
+TEST(Sync, Sync_Speedtest)
+{
+	typedef std::chrono::duration<float, std::milli> ms;
+	constexpr const float MILLITIMEDIVIDE = 1 / 1000.f;
+	constexpr const uint32_t UNCONTENDED_ITERATIONS = 1000000;
+	constexpr const uint32_t CONTENDED_ITERATIONS = 100000;
+
+	std::cout << "/-----------------------------------------/" << "\n" << "Lock and unlock, with time in MS:" << "\n";
+	uint64_t t_Value = 0;
+
+	{
+		const BB::BBMutex t_Mutex = BB::OSCreateMutex();
+		auto t_Timer = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < UNCONTENDED_ITERATIONS; i++)
+		{
+			BB::OSWaitAndLockMutex(t_Mutex);
+			++t_Value;
+			BB::OSUnlockMutex(t_Mutex);
+		}
+		auto t_Speed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+		std::cout << UNCONTENDED_ITERATIONS << " uncontended BBMutex: " << t_Speed << "\n";
+
+		Sync_ThreadParam<const BB::BBMutex> t_Param{ &t_Mutex, &t_Value, CONTENDED_ITERATIONS };
+		t_Timer = std::chrono::high_resolution_clock::now();
+		Sync_RunThreads(Sync_AddUnderMutex, t_Param);
+		t_Speed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+		std::cout << SYNC_THREAD_COUNT << " threads " << CONTENDED_ITERATIONS << " times BBMutex: " << t_Speed << "\n";
+		BB::DestroyMutex(t_Mutex);
+	}
+
+	const auto t_TimeLock = [&](auto& a_Lock, const char* a_Name)
+	{
+		using Lock = std::remove_reference_t<decltype(a_Lock)>;
+		auto t_Timer = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < UNCONTENDED_ITERATIONS; i++)
+		{
+			a_Lock.lock();
+			++t_Value;
+			a_Lock.unlock();
+		}
+		auto t_Speed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+		std::cout << UNCONTENDED_ITERATIONS << " uncontended " << a_Name << ": " << t_Speed << "\n";
+
+		Sync_ThreadParam<Lock> t_Param{ &a_Lock, &t_Value, CONTENDED_ITERATIONS };
+		t_Timer = std::chrono::high_resolution_clock::now();
+		Sync_RunThreads(Sync_AddUnderLock<Lock>, t_Param);
+		t_Speed = std::chrono::duration_cast<ms>(std::chrono::high_resolution_clock::now() - t_Timer).count() * MILLITIMEDIVIDE;
+		std::cout << SYNC_THREAD_COUNT << " threads " << CONTENDED_ITERATIONS << " times " << a_Name << ": " << t_Speed << "\n";
+	};
+
+	BB::FutexMutex t_FutexMutex;
+	t_TimeLock(t_FutexMutex, "FutexMutex");
+	BB::TicketLock t_TicketLock;
+	t_TimeLock(t_TicketLock, "TicketLock");
+	BB::RWLock t_RWLock;
+	t_TimeLock(t_RWLock, "RWLock (writer)");
+
+	EXPECT_EQ(t_Value, 4 * (UNCONTENDED_ITERATIONS + static_cast<uint64_t>(SYNC_THREAD_COUNT) * CONTENDED_ITERATIONS));
+}
@@ -0,0 +1,182 @@
+#pragma once
+#include "../TestValues.h"
+#include "BBThreadScheduler.hpp"
+#include "BBParallel.hpp"
+
+static void ThreadScheduler_AddOne(void* a_Param)
+{
+	reinterpret_cast<std::atomic<uint32_t>*>(a_Param)->fetch_add(1, std::memory_order_relaxed);
+}
+
+struct ThreadScheduler_NestedParam
+{
+	std::atomic<uint32_t>* value;
+	BB::JobCounter* counter;
+};
+
+//Starts jobs from inside a worker, these go to the worker's own deque and get stolen by the others.
+static void ThreadScheduler_StartNested(void* a_Param)
+{
+	ThreadScheduler_NestedParam* t_Param = reinterpret_cast<ThreadScheduler_NestedParam*>(a_Param);
+	for (uint32_t i = 0; i < 64; i++)
+		BB::Threads::StartTaskThread(ThreadScheduler_AddOne, t_Param->value, t_Param->counter);
+}
+
+TEST(ThreadScheduler, More_Jobs_Than_Threads)
+{
+	//Way more then the 32 thread slots the old scheduler had.
+	constexpr const uint32_t JOB_COUNT = 4096;
+	std::atomic<uint32_t> t_Value{ 0 };
+	BB::JobCounter t_Counter;
+
+	for (uint32_t i = 0; i < JOB_COUNT; i++)
+		BB::Threads::StartTaskThread(ThreadScheduler_AddOne, &t_Value, &t_Counter);
+
+	BB::Threads::WaitForCounter(t_Counter);
+	EXPECT_EQ(t_Value.load(), JOB_COUNT);
+}
+
+TEST(ThreadScheduler, Nested_Jobs_Stealing)
+{
+	constexpr const uint32_t PARENT_COUNT = 32;
+	std::atomic<uint32_t> t_Value{ 0 };
+	BB::JobCounter t_ParentCounter;
+	BB::JobCounter t_ChildCounter;
+	ThreadScheduler_NestedParam t_Param{ &t_Value, &t_ChildCounter };
+
+	for (uint32_t i = 0; i < PARENT_COUNT; i++)
+		BB::Threads::StartTaskThread(ThreadScheduler_StartNested, &t_Param, &t_ParentCounter);
+
+	//The children are only added to the counter once the parents run.
+	BB::Threads::WaitForCounter(t_ParentCounter);
+	BB::Threads::WaitForCounter(t_ChildCounter);
+	EXPECT_EQ(t_Value.load(), PARENT_COUNT * 64);
+}
+
+TEST(ThreadScheduler, Wait_For_Task_Handle)
+{
+	std::atomic<uint32_t> t_Values[16]{};
+	BB::ThreadTask t_Tasks[16];
+	for (uint32_t i = 0; i < 16; i++)
+		t_Tasks[i] = BB::Threads::StartTaskThread(ThreadScheduler_AddOne, &t_Values[i]);
+
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		BB::Threads::WaitForTask(t_Tasks[i]);
+		EXPECT_TRUE(BB::Threads::TaskFinished(t_Tasks[i]));
+		EXPECT_EQ(t_Values[i].load(), 1u);
+	}
+
+	//An empty handle is always finished.
+	EXPECT_TRUE(BB::Threads::TaskFinished(BB::ThreadTask(0)));
+}
+
+struct ThreadScheduler_ChainParam
+{
+	std::atomic<uint32_t>* order;
+	uint32_t expected;
+	std::atomic<uint32_t> failed{ 0 };
+};
+
+//Checks that the jobs before it already ran.
+static void ThreadScheduler_ChainStep(void* a_Param)
+{
+	ThreadScheduler_ChainParam* t_Param = reinterpret_cast<ThreadScheduler_ChainParam*>(a_Param);
+	if (t_Param->order->load() < t_Param->expected)
+		t_Param->failed.fetch_add(1);
+	t_Param->order->fetch_add(1);
+}
+
+TEST(ThreadScheduler, Continuations)
+{
+	constexpr const uint32_t WIDE_COUNT = 16;
+	std::atomic<uint32_t> t_Order{ 0 };
+
+	//Many jobs at the start, one in the middle that waits on all of them and one at the end that waits on the middle.
+	ThreadScheduler_ChainParam t_WideParam{ &t_Order, 0 };
+	ThreadScheduler_ChainParam t_MiddleParam{ &t_Order, WIDE_COUNT };
+	ThreadScheduler_ChainParam t_EndParam{ &t_Order, WIDE_COUNT + 1 };
+
+	BB::ThreadTask t_WideTasks[WIDE_COUNT];
+	for (uint32_t i = 0; i < WIDE_COUNT; i++)
+		t_WideTasks[i] = BB::Threads::StartTaskThread(ThreadScheduler_ChainStep, &t_WideParam);
+
+	const BB::ThreadTask t_MiddleTask = BB::Threads::StartTaskAfter(ThreadScheduler_ChainStep, &t_MiddleParam, t_WideTasks, WIDE_COUNT);
+	const BB::ThreadTask t_EndTask = BB::Threads::StartTaskAfter(ThreadScheduler_ChainStep, &t_EndParam, &t_MiddleTask, 1);
+
+	BB::Threads::WaitForTask(t_EndTask);
+	EXPECT_EQ(t_Order.load(), WIDE_COUNT + 2);
+	EXPECT_EQ(t_MiddleParam.failed.load(), 0u);
+	EXPECT_EQ(t_EndParam.failed.load(), 0u);
+
+	//Depending on finished tasks starts the job right away.
+	const BB::ThreadTask t_LateTask = BB::Threads::StartTaskAfter(ThreadScheduler_ChainStep, &t_WideParam, t_WideTasks, WIDE_COUNT);
+	BB::Threads::WaitForTask(t_LateTask);
+	EXPECT_EQ(t_Order.load(), WIDE_COUNT + 3);
+}
+
+TEST(ThreadScheduler, Wait_For_All_And_Any)
+{
+	constexpr const uint32_t TASK_COUNT = 64;
+	std::atomic<uint32_t> t_Value{ 0 };
+	BB::ThreadTask t_Tasks[TASK_COUNT];
+	for (uint32_t i = 0; i < TASK_COUNT; i++)
+		t_Tasks[i] = BB::Threads::StartTaskThread(ThreadScheduler_AddOne, &t_Value);
+
+	const uint32_t t_AnyIndex = BB::Threads::WaitForAnyTask(t_Tasks, TASK_COUNT);
+	EXPECT_LT(t_AnyIndex, TASK_COUNT);
+	EXPECT_TRUE(BB::Threads::TaskFinished(t_Tasks[t_AnyIndex]));
+
+	BB::Threads::WaitForTasks(t_Tasks, TASK_COUNT);
+	EXPECT_EQ(t_Value.load(), TASK_COUNT);
+}
+
+static void ThreadScheduler_Square(const BB::Slice<uint32_t> a_Range, const size_t a_StartIndex, BB::Allocator a_Scratch, void*)
+{
+	//Use the scratch allocator to make sure it works inside the jobs.
+	uint32_t* t_Temp = BBnewArr(a_Scratch, a_Range.size(), uint32_t);
+	for (size_t i = 0; i < a_Range.size(); i++)
+		t_Temp[i] = static_cast<uint32_t>(a_StartIndex + i);
+	for (size_t i = 0; i < a_Range.size(); i++)
+		a_Range[i] = t_Temp[i] * t_Temp[i];
+}
+
+static uint64_t ThreadScheduler_SumMap(const BB::Slice<uint32_t> a_Range, BB::Allocator, void*)
+{
+	uint64_t t_Sum = 0;
+	for (size_t i = 0; i < a_Range.size(); i++)
+		t_Sum += a_Range[i];
+	return t_Sum;
+}
+
+static uint64_t ThreadScheduler_SumCombine(const uint64_t& a_Lhs, const uint64_t& a_Rhs)
+{
+	return a_Lhs + a_Rhs;
+}
+
+TEST(ThreadScheduler, Parallel_For_And_Reduce)
+{
+	constexpr const size_t ELEMENT_COUNT = 10000;
+	constexpr const size_t GRAIN_SIZE = 97;
+	BB::FreelistAllocator_t t_Allocator{ BB::kbSize * 128 };
+	BB::Array<uint32_t> t_Array{ t_Allocator, ELEMENT_COUNT };
+	t_Array.resize(ELEMENT_COUNT);
+
+	BB::Threads::WaitForTask(BB::Threads::ParallelFor(t_Array, GRAIN_SIZE, ThreadScheduler_Square, nullptr));
+
+	uint64_t t_Expected = 0;
+	for (size_t i = 0; i < ELEMENT_COUNT; i++)
+	{
+		ASSERT_EQ(t_Array[i], static_cast<uint32_t>(i * i));
+		t_Expected += t_Array[i];
+	}
+
+	uint64_t t_Sum = 0;
+	BB::Threads::WaitForTask(BB::Threads::ParallelReduce(BB::Slice<uint32_t>(t_Array), GRAIN_SIZE, static_cast<uint64_t>(0), ThreadScheduler_SumMap, ThreadScheduler_SumCombine, &t_Sum, nullptr));
+	EXPECT_EQ(t_Sum, t_Expected);
+
+	//An empty range still finishes and writes the identity.
+	t_Sum = 5;
+	BB::Threads::WaitForTask(BB::Threads::ParallelReduce(BB::Slice<uint32_t>(), GRAIN_SIZE, static_cast<uint64_t>(0), ThreadScheduler_SumMap, ThreadScheduler_SumCombine, &t_Sum, nullptr));
+	EXPECT_EQ(t_Sum, 0u);
+}
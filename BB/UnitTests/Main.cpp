@@ -14,13 +14,22 @@
 #include "Framework/Array_UTEST.h"
 #include "Framework/Pool_UTEST.h"
 #include "Framework/Hashmap_UTEST.h"
+#include "Framework/Hash_UTEST.h"
+#include "Framework/StringID_UTEST.h"
 #include "Framework/MemoryArena_UTEST.h"
 #include "Framework/BBjson_UTEST.hpp"
+#include "Framework/SceneFile_UTEST.h"
 #include "Framework/MemoryOperations_UTEST.h"
 #include "Framework/Slice_UTEST.h"
 #include "Framework/Slotmap_UTEST.h"
 #include "Framework/String_UTEST.h"
 #include "Framework/FileReadWrite_UTEST.h"
+#include "Framework/ThreadScheduler_UTEST.h"
+#include "Framework/AsyncIO_UTEST.h"
+#include "Framework/Sync_UTEST.h"
+#include "Framework/LockFreeStorage_UTEST.h"
+#include "Framework/Math_UTEST.h"
+#include "Framework/HandleRegistry_UTEST.h"
 #pragma warning(default:6262)
 
 #include "BBMain.h"
@@ -45,7 +54,8 @@ int main(int argc, char** argv)
 	WindowHandle mainWindow = CreateOSWindow(OS_WINDOW_STYLE::MAIN, 250, 200, 250, 200, L"Unit Test Main Window");
 	Logger::EnableLogTypes(UINT32_MAX);
 
-	bool hasWindows = true;
+	//No window on a machine without a display, the tests already ran.
+	bool hasWindows = mainWindow.handle != 0;
 	InputEvent t_InputEvents[INPUT_EVENT_BUFFER_MAX]{};
 	size_t t_InputEventCount = 0;
 	while (hasWindows)
@@ -148,7 +148,7 @@ struct VulkanBackend_inst
 	Pool<VulkanPipeline> pipelinePool;
 	Pool<VulkanBuffer> bufferPool;
 
-	OL_HashMap<PipelineLayoutHash, VkPipelineLayout> pipelineLayouts{ s_VulkanAllocator };
+	SW_HashMap<PipelineLayoutHash, VkPipelineLayout> pipelineLayouts{ s_VulkanAllocator };
 
 	VulkanDebug vulkanDebug;
 	VulkanPhysicalDeviceInfo deviceInfo;
@@ -287,7 +287,7 @@ public:
 		}
 		else
 		{
-			ReleaseVirtualMemory(m_Start);
+			ReleaseVirtualMemory(m_Start, m_BufferSize);
 		}
 		memset(this, 0, sizeof(VulkanDescriptorBuffer));
 	}
@@ -14,5 +14,6 @@ namespace BB
 		static void DisplaySceneInfo(class SceneGraph& t_Scene);
 		static void DisplayRenderResources(class RenderResourceTracker& a_ResTracker);
 		static void DisplayAllocator(BB::allocators::BaseAllocator& a_Allocator);
+		static void DisplayScratchArenas();
 	};
 }
\ No newline at end of file
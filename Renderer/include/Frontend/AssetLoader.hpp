@@ -1,5 +1,6 @@
 #include "BBMemory.h"
 #include "RenderFrontendCommon.h"
+#include "Utils/StringID.h"
 
 namespace BB
 {
@@ -30,11 +31,13 @@ namespace BB
 
 	namespace Asset
 	{
-		char* FindOrCreateString(const char* a_string);
+		//Returns the interned copy of the string, see InternString.
+		const char* FindOrCreateString(const char* a_string);
 
 		const AssetHandle LoadAsset(void* a_AssetJobInfo);
 
 		const RTexture GetImage(const AssetHandle a_Asset);
 		const RTexture GetImageWait(const char* a_Path);
+		const RTexture GetImageWait(const StringID a_Path);
 	};
 }
\ No newline at end of file
@@ -1,10 +1,13 @@
 #pragma once
 #include "RenderFrontendCommon.h"
 #include "Slice.h"
+#include "BBSync.hpp"
+#include "Storage/LockFreeStack.h"
 
 namespace BB
 {
 	constexpr const size_t MAX_TEXTURES = 1024;
+	constexpr const uint32_t MAX_MODELS = 1024;
 
 	struct Render_IO
 	{
@@ -39,9 +42,10 @@ namespace BB
 
 	private:
 		const RENDER_QUEUE_TYPE m_Type;
-		BBMutex m_Mutex;
+		FutexMutex m_Mutex;
 		CommandList m_Lists[12]{};
-		CommandList* m_FreeCommandList;
+		//Popped without m_Mutex, GetCommandList is called from many threads.
+		LockFreeStack<CommandList> m_FreeCommandLists;
 		CommandList* m_InFlightLists = nullptr;
 
 		CommandQueueHandle m_Queue;
@@ -74,6 +78,10 @@ namespace BB
 		Model& GetModel(const RModelHandle a_Handle);
 		RModelHandle CreateRawModel(const CommandListHandle a_CommandList, const CreateRawModelInfo& a_CreateInfo);
 		RModelHandle LoadModel(const CommandListHandle a_CommandList, const LoadModelInfo& a_LoadInfo);
+		//Changes the transform of a node relative to its parent, the node and its childeren are rebuild on the next UpdateModelMatrices.
+		void SetModelNodeTransform(const RModelHandle a_Model, const uint32_t a_NodeIndex, const Mat4x4& a_Transform);
+		//Rebuilds Model::modelMatrices of the changed nodes and everything under them in one pass, does nothing if no node changed.
+		void UpdateModelMatrices(Model& a_Model);
 
 		void StartFrame(const CommandListHandle a_CommandList);
 		void Update(const float a_DeltaTime);
@@ -17,6 +17,7 @@ namespace BB
 	};
 
 	constexpr const uint32_t MESH_INVALID_INDEX = UINT32_MAX;
+	constexpr const uint32_t NODE_INVALID_INDEX = UINT32_MAX;
 	struct Model
 	{
 		struct Primitive
@@ -35,10 +36,13 @@ namespace BB
 
 		struct Node
 		{
-			Mat4x4 transform;
+			Mat4x4 transform; //Relative to the parent node.
 			Model::Node* childeren = nullptr;
 			uint32_t childCount = 0;
 			uint32_t meshIndex = MESH_INVALID_INDEX;
+			uint32_t parentIndex = NODE_INVALID_INDEX;
+			//Set by Render::SetModelNodeTransform, cleared by Render::UpdateModelMatrices.
+			bool dirty = false;
 		};
 
 		PipelineHandle pipelineHandle{};
@@ -50,11 +54,21 @@ namespace BB
 		RenderBufferPart vertexView;
 		RenderBufferPart indexView;
 
+		//The root nodes, they are at the start of linearNodes.
 		Node* nodes = nullptr;
+		//Breadth first, so a parent always comes before its childeren and the childeren of a node are next to each other.
 		Node* linearNodes = nullptr;
 		uint32_t nodeCount = 0;
 		uint32_t linearNodeCount = 0;
 
+		//Node to model space for every linear node, the node transform multiplied by all its parents.
+		//Only rebuild from firstDirtyNode, a model that does not change never rebuilds them.
+		Mat4x4* modelMatrices = nullptr;
+		uint32_t firstDirtyNode = NODE_INVALID_INDEX;
+		//Linear node indices that have a mesh, what a draw goes through.
+		uint32_t* meshNodes = nullptr;
+		uint32_t meshNodeCount = 0;
+
 		Mesh* meshes = nullptr;
 		uint32_t meshCount = 0;
 
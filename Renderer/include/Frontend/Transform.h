@@ -18,7 +18,7 @@ namespace BB
 		void SetRotation(const float3 a_Axis, const float a_Radians);
 		void SetScale(const float3 a_Scale);
 
-		const Mat4x4 CreateMatrix();
+		const Mat4x4 CreateMatrix() const;
 
 		//44 bytes class
 		float3 m_Pos; //12
@@ -27,15 +27,24 @@ namespace BB
 	};
 
 	using TransformHandle = FrameworkHandle<struct TransformHandleTag>;
+
+	//What the TransformPool builds for every transform in UpdateMatrices.
+	struct TransformMatrices
+	{
+		Mat4x4 transform; //64 bytes
+		Mat4x4 inverse; //128 bytes
+	};
+
 	/// <summary>
 	/// A special pool that handles Transform allocations.
-	/// It has a secondary pool of pointers that all point to memory regions in a CPU exposed GPU buffer.
+	/// Positions, rotations and scales are stored as separate arrays and every change marks the transform dirty.
+	/// UpdateMatrices rebuilds only the dirty matrices in one batch, GetMatrices reads them.
 	/// </summary>
 	class TransformPool
 	{
 	public:
 		/// <param name="a_SysAllocator">The allocator that will allocate the pool.</param>
-		/// <param name="a_MatrixSize">The amount of matrices you want to allocate. The a_GPUMemoryRegion needs to have enough space to hold them all.</param>
+		/// <param name="a_MatrixSize">The amount of matrices you want to allocate.</param>
 		TransformPool(Allocator a_SysAllocator, const uint32_t a_MatrixSize);
 		~TransformPool();
 
@@ -43,10 +52,27 @@ namespace BB
 		TransformHandle CreateTransform(const float3 a_Position, const float3 a_Axis, const float a_Radians);
 		TransformHandle CreateTransform(const float3 a_Position, const float3 a_Axis, const float a_Radians, const float3 a_Scale);
 		void FreeTransform(const TransformHandle a_Handle);
-		Transform& GetTransform(const TransformHandle a_Handle) const;
+		//A copy, change the transform through the pool so it gets marked dirty.
+		const Transform GetTransform(const TransformHandle a_Handle) const;
+
+		void Translate(const TransformHandle a_Handle, const float3 a_Translation);
+		void SetPosition(const TransformHandle a_Handle, const float3 a_Position);
+		void SetRotation(const TransformHandle a_Handle, const float3 a_Axis, const float a_Radians);
+		void SetScale(const TransformHandle a_Handle, const float3 a_Scale);
+
+		//Builds the matrix now, use GetMatrices after UpdateMatrices to not build it every time.
+		const Mat4x4 CreateMatrix(const TransformHandle a_Handle) const;
+
+		/// <summary>
+		/// Builds the matrix and inverse of every transform that changed since the last update.
+		/// Call it once per frame after changing the transforms and before reading them with GetMatrices.
+		/// </summary>
+		/// <returns>The amount of transforms that got updated.</returns>
+		const uint32_t UpdateMatrices();
+		//The matrices from the last UpdateMatrices, outdated if the transform changed after it.
+		const TransformMatrices& GetMatrices(const TransformHandle a_Handle) const;
 
 		const uint32_t PoolSize() const;
-		const class UploadBuffer& PoolGPUUploadBuffer();
 			
 	private:
 		struct TransformPool_inst* inst;
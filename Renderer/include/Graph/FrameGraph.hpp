@@ -17,11 +17,16 @@ namespace BB
 		void Render();
 		void EndRendering();
 
+		//Memory that stays valid until the GPU finished the frame it was allocated in, no need to free it.
+		//Only use it between BeginRendering and EndRendering.
+		Allocator GetFrameAllocator();
+
 		const FrameGraphResourceHandle CreateResource(const FrameGraphResource& a_Resource);
 		void DestroyResource(const FrameGraphResourceHandle a_Handle);
 
 	private:
-		FreelistAllocator_t m_Allocator{ mbSize * 32, "Framegraph allocator"};
+		//Big and touched every frame, huge pages save a lot of TLB misses.
+		FreelistAllocator_t m_Allocator{ mbSize * 32, "Framegraph allocator", VirtualMemoryOptions{ VIRTUAL_PAGE_TYPE::TRANSPARENT_HUGE } };
 		struct FrameGraph_inst* inst;
 	};
 }
\ No newline at end of file
@@ -7,7 +7,7 @@ namespace BB
 	struct SceneCreateInfo
 	{
 		const char* sceneName = nullptr;
-		BB::Slice<Light> lights{};
+		BB::Slice<const Light> lights{};
 		uint32_t sceneWindowWidth = 0;
 		uint32_t sceneWindowHeight = 0;
 	};
@@ -17,6 +17,8 @@ namespace BB
 	public:
 		SceneGraph(Allocator a_Allocator, const SceneCreateInfo& a_CreateInfo);
 		SceneGraph(Allocator a_Allocator, Allocator a_TemporaryAllocator, const char* a_JsonPath);
+		//Uses the lights of the scene file in place, the scene file can be freed after construction.
+		SceneGraph(Allocator a_Allocator, const class SceneFile& a_SceneFile);
 		~SceneGraph();
 
 		operator FrameGraphRenderPass();
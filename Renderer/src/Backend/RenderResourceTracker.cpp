@@ -1,5 +1,6 @@
 #include "RenderResourceTracker.h"
 #include "Hashmap.h"
+#include "StringID.h"
 #include "Editor.h"
 
 using namespace BB;
@@ -15,7 +16,8 @@ struct Entry
 	RESOURCE_TYPE type{};
 	uint64_t timeId = 0;
 	uint64_t id = NULL;
-	const char* name = nullptr;
+	//Interned, so the tracker does not depend on the lifetime of the name that was given.
+	StringID name{};
 	Entry* next = nullptr;
 	void* typeInfo = nullptr;
 };
@@ -31,7 +33,7 @@ struct BB::RenderResourceTracker_Inst
 {
 	RenderResourceTracker_Inst(Allocator a_Allocator) : entryMap(a_Allocator, 1028) {};
 
-	OL_HashMap<uint64_t, Entry*> entryMap;
+	SW_HashMap<uint64_t, Entry*> entryMap;
 	SORT_TYPE sortType = SORT_TYPE::TIME;
 	uint64_t timeID = 0;
 	uint32_t entries = 0;
@@ -45,7 +47,7 @@ struct BB::RenderResourceTracker_Inst
 		t_Entry->type = a_Type;
 		t_Entry->timeId = timeID++;
 		t_Entry->id = a_ID;
-		t_Entry->name = a_Name;
+		t_Entry->name = InternString(a_Name);
 		t_Entry->typeInfo = Pointer::Add(t_Entry, sizeof(Entry));
 		T* t_Obj = reinterpret_cast<T*>(t_Entry->typeInfo);
 		*t_Obj = a_TypeInfo;
@@ -104,11 +106,11 @@ void BB::RenderResourceTracker::AddDescriptor(const RenderDescriptorCreateInfo&
 	t_Entry->type = RESOURCE_TYPE::DESCRIPTOR;
 	t_Entry->timeId = inst->timeID++;
 	t_Entry->id = a_ID;
-	t_Entry->name = a_Name;
+	t_Entry->name = InternString(a_Name);
 	t_Entry->next = inst->headEntry;
 	t_Entry->typeInfo = Pointer::Add(t_Entry, sizeof(Entry));
 	DescriptorDebugInfo* t_DescDebug = reinterpret_cast<DescriptorDebugInfo*>(t_Entry->typeInfo);
-	t_DescDebug->name = a_Name;
+	t_DescDebug->name = GetInternedString(t_Entry->name);
 	t_DescDebug->bindingCount = static_cast<uint32_t>(a_Descriptor.bindings.size());
 	t_DescDebug->bindings = reinterpret_cast<DescriptorBinding*>(Pointer::Add(t_Entry, t_EntrySize));
 	Memory::Copy(t_DescDebug->bindings, a_Descriptor.bindings.data(), t_DescDebug->bindingCount);
@@ -148,7 +150,7 @@ void BB::RenderResourceTracker::AddPipeline(const PipelineDebugInfo& a_Pipeline,
 	t_Entry->type = RESOURCE_TYPE::PIPELINE;
 	t_Entry->timeId = inst->timeID++;
 	t_Entry->id = a_ID;
-	t_Entry->name = a_Name;
+	t_Entry->name = InternString(a_Name);
 	t_Entry->next = inst->headEntry;
 	t_Entry->typeInfo = Pointer::Add(t_Entry, sizeof(Entry));
 	PipelineDebugInfo* t_PipelineInfo = reinterpret_cast<PipelineDebugInfo*>(t_Entry->typeInfo);
@@ -205,7 +207,7 @@ void* BB::RenderResourceTracker::GetData(const uint64_t a_ID, const RESOURCE_TYP
 void BB::RenderResourceTracker::ChangeName(const uint64_t a_ID, const char* a_NewName)
 {
 	Entry* t_Entry = *inst->entryMap.find(a_ID);
-	t_Entry->name = a_NewName;
+	t_Entry->name = InternString(a_NewName);
 }
 
 void BB::RenderResourceTracker::RemoveEntry(const uint64_t a_ID)
@@ -399,8 +401,8 @@ void BB::Editor::DisplayRenderResources(BB::RenderResourceTracker& a_ResTracker)
 			ImGui::PushID(t_EntryCount++);
 			BB_ASSERT(t_EntryCount <= t_Inst->entries, "Render Resource tracker has too many entries while they are not marked!");
 			const char* t_ResName = "UNNAMED";
-			if (t_Entry->name != nullptr)
-				t_ResName = t_Entry->name;
+			if (t_Entry->name.IsValid())
+				t_ResName = GetInternedString(t_Entry->name);
 
 			if (ImGui::CollapsingHeader(t_ResName))
 			{
@@ -5,6 +5,7 @@
 #include "LightSystem.h"
 #include "RenderResourceTracker.h"
 #include "BBMemory.h"
+#include "ScratchAllocator.h"
 
 #include "SceneGraph.hpp"
 #include "imgui.h"
@@ -57,4 +58,28 @@ void BB::Editor::DisplayAllocator(BB::allocators::BaseAllocator& a_Allocator)
 			t_Log = t_Log->prev;
 		}
 	}
+}
+
+void BB::Editor::DisplayScratchArenas()
+{
+	if (!g_ShowEditor)
+		return;
+
+	if (ImGui::CollapsingHeader("Scratch Arenas"))
+	{
+		ScratchArenaInfo t_Infos[SCRATCH_MAX_ARENAS];
+		const uint32_t t_InfoCount = Scratch::GetArenaInfos(t_Infos, SCRATCH_MAX_ARENAS);
+		for (uint32_t i = 0; i < t_InfoCount; i++)
+		{
+			if (ImGui::TreeNode((void*)(intptr_t)t_Infos[i].arenaIndex, "Arena %u", t_Infos[i].arenaIndex))
+			{
+				ImGui::Text("Used: %zu", t_Infos[i].used);
+				ImGui::Text("Commited: %zu", t_Infos[i].commited);
+				ImGui::Text("Reserved: %zu", t_Infos[i].reserved);
+				ImGui::Text("High water mark: %zu", t_Infos[i].highWaterMark);
+				ImGui::Text("Last frame high water mark: %zu", t_Infos[i].frameHighWaterMark);
+				ImGui::TreePop();
+			}
+		}
+	}
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "AssetLoader.hpp"
 #include "RenderFrontend.h"
 #include "Storage/BBString.h"
+#include "OS/Program.h"
+#include "BBSync.hpp"
 
 #pragma warning(push, 0)
 #define STB_IMAGE_IMPLEMENTATION
@@ -8,21 +10,10 @@
 #pragma warning (pop)
 
 #include "Storage/Hashmap.h"
+#include "Utils/StringID.h"
 
 using namespace BB;
 
-//crappy hash, don't care for now.
-const uint64_t StringHash(const char* a_String)
-{
-	uint64_t hash = 5381;
-	int c;
-
-	while (c = *a_String++)
-		hash = ((hash << 5) + hash) + c;
-
-	return hash;
-}
-
 struct TextureAsset
 {
 	RTexture texture;
@@ -32,7 +23,7 @@ struct TextureAsset
 struct AssetSlot
 {
 	AssetType type;
-	uint64_t hash;
+	StringID id;
 	const char* path;
 	union
 	{
@@ -42,10 +33,11 @@ struct AssetSlot
 
 struct AssetManager
 {
-	FreelistAllocator_t allocator{ mbSize * 64, "asset manager allocator" };
-	OL_HashMap<uint64_t, AssetSlot> assetMap{ allocator, 64 };
-
-	OL_HashMap<uint64_t, char*> stringMap{ allocator, 128 };
+	FreelistAllocator_t allocator{ mbSize * 64, "asset manager allocator", VirtualMemoryOptions{ VIRTUAL_PAGE_TYPE::TRANSPARENT_HUGE } };
+	//Keyed by the interned path, so a path is hashed once and two different paths can never share a slot.
+	OL_HashMap<StringID, AssetSlot> assetMap{ allocator, 64 };
+	//Assets are looked up every frame and only added while loading.
+	RWLock assetMapLock;
 };
 static AssetManager s_AssetManager{};
 
@@ -75,9 +67,12 @@ static TextureAsset LoadImageDisk(const char* a_Path)
 	CommandList* t_CmdList = SetupCommandLists(a_Path);
 
 	int x, y, c;
-	//hacky way, whatever we do it for now.
-	stbi_uc* t_Pixels = stbi_load(a_Path, &x, &y, &c, 4);
-	BB_ASSERT(t_Pixels != nullptr, "failed to load image from disk");
+	//stb decodes straight from the mapped file, the compressed bytes are never copied.
+	const Buffer t_ImageFile = MapOSFile(a_Path, OS_FILE_ACCESS_HINT::SEQUENTIAL);
+	BB_ASSERT(t_ImageFile.data != nullptr, "failed to load image from disk");
+	stbi_uc* t_Pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(t_ImageFile.data), static_cast<int>(t_ImageFile.size), &x, &y, &c, 4);
+	UnmapOSFile(t_ImageFile);
+	BB_ASSERT(t_Pixels != nullptr, "failed to decode image from disk");
 	RImageHandle t_Image;
 	{
 		RenderImageCreateInfo t_ImageInfo;
@@ -167,19 +162,9 @@ static TextureAsset LoadImageDisk(const char* a_Path)
 	return t_ReturnValue;
 }
 
-char* Asset::FindOrCreateString(const char* a_string)
+const char* Asset::FindOrCreateString(const char* a_string)
 {
-	const uint64_t t_StringHash = StringHash(a_string);
-	char** t_StringPtr = s_AssetManager.stringMap.find(t_StringHash);
-	if (t_StringPtr != nullptr)
-		return *t_StringPtr;
-
-	const uint32_t t_StringSize = static_cast<uint32_t>(strlen(a_string) + 1);
-	char* t_String = BBnewArr(s_AssetManager.allocator, t_StringSize, char);
-	memcpy(t_String, a_string, t_StringSize);
-	t_String[t_StringSize - 1] = '\0';
-	s_AssetManager.stringMap.emplace(t_StringHash, t_String);
-	return t_String;
+	return GetInternedString(InternString(a_string));
 }
 
 const AssetHandle Asset::LoadAsset(void* a_AssetDiskJobInfo)
@@ -189,8 +174,8 @@ const AssetHandle Asset::LoadAsset(void* a_AssetDiskJobInfo)
 	AssetSlot t_AssetSlot{};
 
 	t_AssetSlot.type = a_JobInfo->assetType;
-	t_AssetSlot.path = FindOrCreateString(a_JobInfo->path);
-	t_AssetSlot.hash = StringHash(t_AssetSlot.path);
+	t_AssetSlot.id = InternString(a_JobInfo->path);
+	t_AssetSlot.path = GetInternedString(t_AssetSlot.id);
 	switch (a_JobInfo->assetType)
 	{
 	case AssetType::IMAGE:
@@ -210,35 +195,51 @@ const AssetHandle Asset::LoadAsset(void* a_AssetDiskJobInfo)
 		break;
 	}
 
-	s_AssetManager.assetMap.emplace(t_AssetSlot.hash, t_AssetSlot);
-	return AssetHandle(t_AssetSlot.hash);
+	s_AssetManager.assetMapLock.lock();
+	s_AssetManager.assetMap.emplace(t_AssetSlot.id, t_AssetSlot);
+	s_AssetManager.assetMapLock.unlock();
+	return AssetHandle(t_AssetSlot.id.id);
 }
 
 const RTexture Asset::GetImage(const AssetHandle a_Asset)
 {
-	const AssetSlot* t_Asset = s_AssetManager.assetMap.find(a_Asset.handle);
+	s_AssetManager.assetMapLock.lock_shared();
+	const AssetSlot* t_Asset = s_AssetManager.assetMap.find(StringID{ static_cast<uint32_t>(a_Asset.handle) });
 	BB_ASSERT(t_Asset->type == AssetType::IMAGE, "Asset found is not an image!");
-	return t_Asset->texture.texture;
+	const RTexture t_Texture = t_Asset->texture.texture;
+	s_AssetManager.assetMapLock.unlock_shared();
+	return t_Texture;
 }
 
 const RTexture Asset::GetImageWait(const char* a_Path)
 {
-	const uint64_t t_Hash = StringHash(a_Path);
-
-	AssetSlot* t_Slot = s_AssetManager.assetMap.find(t_Hash);
+	return GetImageWait(InternString(a_Path));
+}
 
+const RTexture Asset::GetImageWait(const StringID a_Path)
+{
+	s_AssetManager.assetMapLock.lock_shared();
+	AssetSlot* t_Slot = s_AssetManager.assetMap.find(a_Path);
 	if (t_Slot != BB_INVALID_HANDLE)
-		return t_Slot->texture.texture;
+	{
+		const RTexture t_Texture = t_Slot->texture.texture;
+		s_AssetManager.assetMapLock.unlock_shared();
+		return t_Texture;
+	}
+	s_AssetManager.assetMapLock.unlock_shared();
 
 	AssetDiskJobInfo a_JobInfo{};
 	a_JobInfo.assetType = AssetType::IMAGE;
 	a_JobInfo.loadType = AssetLoadType::DISK;
-	a_JobInfo.path = a_Path;
+	a_JobInfo.path = GetInternedString(a_Path);
+	BB_ASSERT(a_JobInfo.path != nullptr, "Trying to load an image with a path that was never interned.");
 
 	LoadAsset(&a_JobInfo);
-	t_Slot = s_AssetManager.assetMap.find(t_Hash);
-
+	s_AssetManager.assetMapLock.lock_shared();
+	t_Slot = s_AssetManager.assetMap.find(a_Path);
 	BB_ASSERT(t_Slot != BB_INVALID_HANDLE, "Uploaded a resource but still can't find it");
+	const RTexture t_Texture = t_Slot->texture.texture;
+	s_AssetManager.assetMapLock.unlock_shared();
 
-	return t_Slot->texture.texture;
+	return t_Texture;
 }
\ No newline at end of file
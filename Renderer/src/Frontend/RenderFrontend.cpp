@@ -4,7 +4,7 @@
 #include "OS/Program.h"
 #include "imgui_impl_CrossRenderer.h"
 
-#include "Storage/Slotmap.h"
+#include "Storage/HandleRegistry.h"
 #include "Storage/Array.h"
 
 #include "../Vulkan/include/VulkanBackend.h"
@@ -119,18 +119,15 @@ struct TextureManager
 		RenderBackend::SetPipelineBarriers(a_CommandList, t_PipelineInfos);
 
 		//texture 0 is always the debug texture.
-		textures[0].mutex;
 		textures[0].image = debugTexture;
 		textures[0].nextFree = UINT32_MAX;
 
 		for (uint32_t i = 1; i < MAX_TEXTURES - 1; i++)
 		{
-			textures[i].mutex = OSCreateMutex();
 			textures[i].image = debugTexture;
 			textures[i].nextFree = i + 1;
 		}
 
-		textures[MAX_TEXTURES - 1].mutex = OSCreateMutex();
 		textures[MAX_TEXTURES - 1].image = debugTexture;
 		textures[MAX_TEXTURES - 1].nextFree = UINT32_MAX;
 	}
@@ -139,7 +136,7 @@ struct TextureManager
 	{
 		RImageHandle image;
 		//when loading in the texture.
-		BBMutex mutex;
+		FutexMutex mutex;
 		uint32_t nextFree;
 	};
 
@@ -193,9 +190,7 @@ RenderQueue::RenderQueue(const RENDER_QUEUE_TYPE a_QueueType, const char* a_Name
 		m_Lists[i].next = &m_Lists[i + 1];
 	}
 
-	m_FreeCommandList = &m_Lists[0];
-
-	m_Mutex = OSCreateMutex();
+	m_FreeCommandLists.push(&m_Lists[0], &m_Lists[_countof(m_Lists) - 1]);
 }
 
 RenderQueue::~RenderQueue()
@@ -210,13 +205,12 @@ RenderQueue::~RenderQueue()
 
 	RenderBackend::DestroyCommandQueue(m_Queue);
 	RenderBackend::DestroyFence(m_Fence.fence);
-	DestroyMutex(m_Mutex);
 }
 
 CommandList* RenderQueue::GetCommandList(const char* a_ListName)
 {
-	OSWaitAndLockMutex(m_Mutex);
-	CommandList* t_List = BB_SLL_POP(m_FreeCommandList);
+	CommandList* t_List = m_FreeCommandLists.pop();
+	BB_ASSERT(t_List != nullptr, "No free commandlists left, wait for a fence value to get more.");
 #ifdef _TRACK_RENDER_RESOURCES
 	SetResourceNameInfo t_ResInfo;
 	t_ResInfo.name = a_ListName;
@@ -224,7 +218,6 @@ CommandList* RenderQueue::GetCommandList(const char* a_ListName)
 	t_ResInfo.resourceType = RENDER_RESOURCE_TYPE::COMMANT_LIST;
 	RenderBackend::SetResourceName(t_ResInfo);
 #endif //_TRACK_RENDER_RESOURCES
-	OSUnlockMutex(m_Mutex);
 	RenderBackend::StartCommandList(t_List->list);
 	return t_List;
 }
@@ -267,10 +260,10 @@ void RenderQueue::ExecuteCommands(CommandList** a_CommandLists, const uint32_t a
 	t_ExecuteInfo.signalFences = &m_Fence.fence;
 	t_ExecuteInfo.signalValues = &m_Fence.nextFenceValue;
 
-	OSWaitAndLockMutex(m_Mutex);
+	m_Mutex.lock();
 	RenderBackend::ExecuteCommands(m_Queue, &t_ExecuteInfo, 1);
 	++m_Fence.nextFenceValue;
-	OSUnlockMutex(m_Mutex);
+	m_Mutex.unlock();
 }
 
 void RenderQueue::ExecutePresentCommands(CommandList** a_CommandLists, const uint32_t a_CommandListCount, const RenderFence* a_WaitFences, const RENDER_PIPELINE_STAGE* a_WaitStages, const uint32_t a_FenceCount)
@@ -304,15 +297,15 @@ void RenderQueue::ExecutePresentCommands(CommandList** a_CommandLists, const uin
 	t_ExecuteInfo.signalFences = &m_Fence.fence;
 	t_ExecuteInfo.signalValues = &m_Fence.nextFenceValue;
 
-	OSWaitAndLockMutex(m_Mutex);
+	m_Mutex.lock();
 	RenderBackend::ExecutePresentCommands(m_Queue, t_ExecuteInfo);
 	++m_Fence.nextFenceValue;
-	OSUnlockMutex(m_Mutex);
+	m_Mutex.unlock();
 }
 
 void RenderQueue::WaitFenceValue(const uint64_t a_FenceValue)
 {
-	OSWaitAndLockMutex(m_Mutex);
+	m_Mutex.lock();
 	if (a_FenceValue > m_Fence.lastCompleteValue)
 	{
 		uint64_t t_WaitValue = a_FenceValue;
@@ -338,14 +331,14 @@ void RenderQueue::WaitFenceValue(const uint64_t a_FenceValue)
 
 			//Get next in-flight commandlist
 			*inflightCommandList = t_CommandList->next;
-			BB_SLL_PUSH(m_FreeCommandList, t_CommandList);
+			m_FreeCommandLists.push(t_CommandList);
 		}
 		else
 		{
 			inflightCommandList = &t_CommandList->next;
 		}
 	}
-	OSUnlockMutex(m_Mutex);
+	m_Mutex.unlock();
 }
 
 void RenderQueue::WaitIdle()
@@ -365,10 +358,9 @@ struct Render_inst
 			vertexBuffer(a_VertexBufferInfo),
 			indexBuffer(a_IndexBufferInfo),
 			descriptorManager(s_SystemAllocator, a_DescriptorManagerInfo, a_BackbufferAmount),
-			models(s_SystemAllocator, 64)
+			models(s_SystemAllocator, MAX_MODELS)
 	{
 		io.frameBufferAmount = a_BackbufferAmount;
-		startFrameCommands.mutex = OSCreateMutex();
 	}
 	Render_IO io;
 
@@ -382,14 +374,15 @@ struct Render_inst
 	LinearRenderBuffer vertexBuffer;
 	LinearRenderBuffer indexBuffer;
 
-	Slotmap<Model> models;
+	//Never moves a Model, a reference from GetModel stays valid while other models are loaded.
+	HandleRegistry<Model> models;
 
 	//Both arrays work the same.
 	struct StartFrameCommands
 	{
 		Array<PipelineBarrierImageInfo> barriers{ s_SystemAllocator, 16 };
 		Array<WriteDescriptorData> descriptorWrites{ s_SystemAllocator, 16 };
-		BBMutex mutex;
+		FutexMutex mutex;
 	} startFrameCommands;
 };
 
@@ -609,15 +602,15 @@ const LinearRenderBuffer& BB::Render::GetIndexBuffer()
 
 const RTexture BB::Render::SetupTexture(const RImageHandle a_Image)
 {
-	OSWaitAndLockMutex(s_RenderInst->startFrameCommands.mutex);
+	s_RenderInst->startFrameCommands.mutex.lock();
 	const uint32_t t_DescriptorIndex = s_RenderInst->textureManager.nextFree;
 
 	TextureManager::TextureSlot& t_FreeSlot = s_RenderInst->textureManager.textures[t_DescriptorIndex];
-	OSWaitAndLockMutex(t_FreeSlot.mutex);
+	t_FreeSlot.mutex.lock();
 	t_FreeSlot.image = a_Image;
 	s_RenderInst->textureManager.nextFree = t_FreeSlot.nextFree;
 	t_FreeSlot.nextFree = UINT32_MAX;
-	OSUnlockMutex(t_FreeSlot.mutex);
+	t_FreeSlot.mutex.unlock();
 
 	RTexture t_Texture;
 	t_Texture.index = t_DescriptorIndex;
@@ -651,7 +644,7 @@ const RTexture BB::Render::SetupTexture(const RImageHandle a_Image)
 		s_RenderInst->startFrameCommands.descriptorWrites.emplace_back(t_WriteData);
 	}
 
-	OSUnlockMutex(s_RenderInst->startFrameCommands.mutex);
+	s_RenderInst->startFrameCommands.mutex.unlock();
 	return t_DescriptorIndex;
 }
 
@@ -710,6 +703,30 @@ Model& BB::Render::GetModel(const RModelHandle a_Handle)
 	return s_RenderInst->models[a_Handle.handle];
 }
 
+//Call when the linear nodes are loaded, builds the mesh node list and the model matrices of every node.
+static void BuildModelHierarchy(Allocator a_SystemAllocator, Model& a_Model)
+{
+	a_Model.modelMatrices = BBnewArr(a_SystemAllocator, a_Model.linearNodeCount, Mat4x4);
+
+	a_Model.meshNodeCount = 0;
+	for (uint32_t i = 0; i < a_Model.linearNodeCount; i++)
+		if (a_Model.linearNodes[i].meshIndex != MESH_INVALID_INDEX)
+			++a_Model.meshNodeCount;
+
+	if (a_Model.meshNodeCount > 0)
+		a_Model.meshNodes = BBnewArr(a_SystemAllocator, a_Model.meshNodeCount, uint32_t);
+	uint32_t t_MeshNode = 0;
+	for (uint32_t i = 0; i < a_Model.linearNodeCount; i++)
+	{
+		if (a_Model.linearNodes[i].meshIndex != MESH_INVALID_INDEX)
+			a_Model.meshNodes[t_MeshNode++] = i;
+		a_Model.linearNodes[i].dirty = true;
+	}
+
+	a_Model.firstDirtyNode = 0;
+	Render::UpdateModelMatrices(a_Model);
+}
+
 RModelHandle BB::Render::CreateRawModel(const CommandListHandle a_CommandList, const CreateRawModelInfo& a_CreateInfo)
 {
 	Model t_Model;
@@ -719,7 +736,7 @@ RModelHandle BB::Render::CreateRawModel(const CommandListHandle a_CommandList, c
 
 	{
 		UploadBufferChunk t_StageBuffer = s_RenderInst->uploadBuffer.Alloc(a_CreateInfo.vertices.sizeInBytes());
-		memcpy(t_StageBuffer.memory, a_CreateInfo.vertices.data(), a_CreateInfo.vertices.sizeInBytes());
+		Memory::MemCpyStream(t_StageBuffer.memory, a_CreateInfo.vertices.data(), a_CreateInfo.vertices.sizeInBytes());
 
 		t_Model.vertexView = AllocateFromVertexBuffer(a_CreateInfo.vertices.sizeInBytes());
 
@@ -735,7 +752,7 @@ RModelHandle BB::Render::CreateRawModel(const CommandListHandle a_CommandList, c
 
 	{
 		UploadBufferChunk t_StageBuffer = s_RenderInst->uploadBuffer.Alloc(a_CreateInfo.indices.sizeInBytes());
-		memcpy(t_StageBuffer.memory, a_CreateInfo.indices.data(), a_CreateInfo.indices.sizeInBytes());
+		Memory::MemCpyStream(t_StageBuffer.memory, a_CreateInfo.indices.data(), a_CreateInfo.indices.sizeInBytes());
 
 		t_Model.indexView = AllocateFromIndexBuffer(a_CreateInfo.indices.sizeInBytes());
 
@@ -773,6 +790,7 @@ RModelHandle BB::Render::CreateRawModel(const CommandListHandle a_CommandList, c
 	t_Model.nodes->meshIndex = 0;
 	t_Model.nodes->transform = Mat4x4Identity();
 	t_Model.nodeCount = 1;
+	BuildModelHierarchy(s_SystemAllocator, t_Model);
 
 	t_Model.primitives = BBnew(s_SystemAllocator, Model::Primitive)();
 	t_Model.primitiveCount = 1;
@@ -827,12 +845,49 @@ RModelHandle BB::Render::LoadModel(const CommandListHandle a_CommandList, const
 	return RModelHandle(s_RenderInst->models.insert(t_Model).handle);
 }
 
+void BB::Render::SetModelNodeTransform(const RModelHandle a_Model, const uint32_t a_NodeIndex, const Mat4x4& a_Transform)
+{
+	Model& t_Model = GetModel(a_Model);
+	BB_ASSERT(a_NodeIndex < t_Model.linearNodeCount, "Model node index out of bounds!");
+	t_Model.linearNodes[a_NodeIndex].transform = a_Transform;
+	t_Model.linearNodes[a_NodeIndex].dirty = true;
+	if (a_NodeIndex < t_Model.firstDirtyNode)
+		t_Model.firstDirtyNode = a_NodeIndex;
+}
+
+void BB::Render::UpdateModelMatrices(Model& a_Model)
+{
+	if (a_Model.firstDirtyNode == NODE_INVALID_INDEX)
+		return;
+
+	//A parent is always before its childeren, so going through the nodes in order is enough to bring a change down the whole subtree.
+	//The dirty flag of a rebuild node stays set until the end so its childeren see it.
+	for (uint32_t i = a_Model.firstDirtyNode; i < a_Model.linearNodeCount; i++)
+	{
+		Model::Node& t_Node = a_Model.linearNodes[i];
+		if (t_Node.parentIndex == NODE_INVALID_INDEX)
+		{
+			if (t_Node.dirty)
+				a_Model.modelMatrices[i] = t_Node.transform;
+		}
+		else if (t_Node.dirty || a_Model.linearNodes[t_Node.parentIndex].dirty)
+		{
+			t_Node.dirty = true;
+			a_Model.modelMatrices[i] = a_Model.modelMatrices[t_Node.parentIndex] * t_Node.transform;
+		}
+	}
+
+	for (uint32_t i = a_Model.firstDirtyNode; i < a_Model.linearNodeCount; i++)
+		a_Model.linearNodes[i].dirty = false;
+	a_Model.firstDirtyNode = NODE_INVALID_INDEX;
+}
+
 void BB::Render::StartFrame(const CommandListHandle a_CommandList)
 {
 	ImGui_ImplCross_NewFrame();
 	ImGui::NewFrame();
 	{
-		OSWaitAndLockMutex(s_RenderInst->startFrameCommands.mutex);
+		s_RenderInst->startFrameCommands.mutex.lock();
 
 		if (s_RenderInst->startFrameCommands.barriers.size())
 		{
@@ -854,7 +909,7 @@ void BB::Render::StartFrame(const CommandListHandle a_CommandList)
 			s_RenderInst->startFrameCommands.descriptorWrites.clear();
 		}
 
-		OSUnlockMutex(s_RenderInst->startFrameCommands.mutex);
+		s_RenderInst->startFrameCommands.mutex.unlock();
 	}
 }
 
@@ -888,29 +943,17 @@ static inline void* GetAccessorDataPtr(const cgltf_accessor* a_Accessor)
 	return Pointer::Add(a_Accessor->buffer_view->buffer->data, t_AccessorOffset);
 }
 
-static inline uint32_t GetChildNodeCount(const cgltf_node& a_Node)
+//Loads the node itself, LoadglTFModel sets up the hierarchy.
+void LoadglTFNode(Allocator a_TempAllocator, Model& a_Model, const cgltf_node& a_glTFNode, Model::Node& a_ModelNode, uint32_t& a_MeshIndex, uint32_t& a_PrimitiveIndex, Vertex* a_Vertices, uint32_t& a_CurrentVertex, uint32_t* a_Indices, uint32_t& a_CurrentIndex)
 {
-	uint32_t t_NodeCount = 0;
-	for (size_t i = 0; i < a_Node.children_count; i++)
-	{
-		t_NodeCount += GetChildNodeCount(*a_Node.children[i]);
-	}
-	return t_NodeCount;
-}
-
-void LoadglTFNode(Allocator a_TempAllocator, Model& a_Model, const cgltf_node& a_glTFNode, uint32_t& a_NodeIndex, uint32_t& a_MeshIndex, uint32_t& a_PrimitiveIndex, Vertex* a_Vertices, uint32_t& a_CurrentVertex, uint32_t* a_Indices, uint32_t& a_CurrentIndex)
-{
-	Model::Node& t_ModelNode = a_Model.linearNodes[a_NodeIndex++];
-	if (a_glTFNode.has_matrix)
-		memcpy(&t_ModelNode.transform, a_glTFNode.matrix, sizeof(Mat4x4));
-	else
-		t_ModelNode.transform = Mat4x4Identity();
+	//Handles both a matrix and translation, rotation and scale.
+	cgltf_node_transform_local(&a_glTFNode, a_ModelNode.transform.e[0]);
 
 	if (a_glTFNode.mesh != nullptr)
 	{
 		const cgltf_mesh& t_Mesh = *a_glTFNode.mesh;
 		Model::Mesh& t_ModelMesh = a_Model.meshes[a_MeshIndex];
-		t_ModelNode.meshIndex = a_MeshIndex++;
+		a_ModelNode.meshIndex = a_MeshIndex++;
 		t_ModelMesh.primitiveOffset = a_PrimitiveIndex;
 		t_ModelMesh.primitiveCount = static_cast<uint32_t>(t_Mesh.primitives_count);
 
@@ -998,20 +1041,7 @@ void LoadglTFNode(Allocator a_TempAllocator, Model& a_Model, const cgltf_node& a
 		}
 	}
 	else
-		t_ModelNode.meshIndex = MESH_INVALID_INDEX;
-
-
-	if (a_glTFNode.children_count > 0)
-	{
-		t_ModelNode.childCount = a_glTFNode.children_count;
-		t_ModelNode.childeren = &a_Model.linearNodes[a_NodeIndex];; //For now we don't care.
-		for (size_t i = 0; i < a_glTFNode.children_count; i++)
-		{
-			LoadglTFNode(a_TempAllocator, a_Model, *a_glTFNode.children[i], a_NodeIndex, a_MeshIndex, a_PrimitiveIndex, a_Vertices, a_CurrentVertex, a_Indices, a_CurrentIndex);
-		}
-	}
-	else
-		t_ModelNode.childCount = 0;
+		a_ModelNode.meshIndex = MESH_INVALID_INDEX;
 }
 
 //Maybe use own allocators for this?
@@ -1032,17 +1062,11 @@ void LoadglTFModel(Allocator a_SystemAllocator, Model& a_Model, UploadBuffer& a_
 
 	uint32_t t_IndexCount = 0;
 	uint32_t t_VertexCount = 0;
+	//A glTF node has at most one parent, so the scene never has more nodes then the file.
 	uint32_t t_LinearNodeCount = static_cast<uint32_t>(t_Data->nodes_count);
 	uint32_t t_MeshCount = static_cast<uint32_t>(t_Data->meshes_count);
 	uint32_t t_PrimitiveCount = 0;
 
-	//Get the node count.
-	for (size_t nodeIndex = 0; nodeIndex < t_Data->nodes_count; nodeIndex++)
-	{
-		const cgltf_node& t_Node = t_Data->nodes[nodeIndex];
-		t_LinearNodeCount += GetChildNodeCount(t_Node);
-	}
-
 	//Get the sizes first for efficient allocation.
 	for (size_t meshIndex = 0; meshIndex < t_Data->meshes_count; meshIndex++)
 	{
@@ -1111,17 +1135,43 @@ void LoadglTFModel(Allocator a_SystemAllocator, Model& a_Model, UploadBuffer& a_
 	uint32_t t_CurrentMesh = 0;
 	uint32_t t_CurrentPrimitive = 0;
 
+	//Breadth first, the queue is the order of the linear nodes.
+	const cgltf_node** t_NodeQueue = BBnewArr(t_TempAllocator, t_LinearNodeCount, const cgltf_node*);
+	uint32_t t_QueueEnd = 0;
 	for (size_t i = 0; i < t_Data->scene->nodes_count; i++)
 	{
-		LoadglTFNode(t_TempAllocator, a_Model, *t_Data->scene->nodes[i], t_CurrentNode, t_CurrentMesh, t_CurrentPrimitive, t_Vertices, t_CurrentVertex, t_Indices, t_CurrentIndex);
+		t_LinearNodes[t_QueueEnd].parentIndex = NODE_INVALID_INDEX;
+		t_NodeQueue[t_QueueEnd++] = t_Data->scene->nodes[i];
 	}
 
+	for (; t_CurrentNode < t_QueueEnd; t_CurrentNode++)
+	{
+		const cgltf_node& t_glTFNode = *t_NodeQueue[t_CurrentNode];
+		Model::Node& t_ModelNode = t_LinearNodes[t_CurrentNode];
+		LoadglTFNode(t_TempAllocator, a_Model, t_glTFNode, t_ModelNode, t_CurrentMesh, t_CurrentPrimitive, t_Vertices, t_CurrentVertex, t_Indices, t_CurrentIndex);
+
+		t_ModelNode.childCount = static_cast<uint32_t>(t_glTFNode.children_count);
+		t_ModelNode.childeren = t_glTFNode.children_count > 0 ? &t_LinearNodes[t_QueueEnd] : nullptr;
+		for (size_t i = 0; i < t_glTFNode.children_count; i++)
+		{
+			BB_ASSERT(t_QueueEnd < t_LinearNodeCount, "glTF node hierarchy has more nodes then the file!");
+			t_LinearNodes[t_QueueEnd].parentIndex = t_CurrentNode;
+			t_NodeQueue[t_QueueEnd++] = t_glTFNode.children[i];
+		}
+	}
+
+	a_Model.nodes = t_LinearNodes;
+	a_Model.nodeCount = static_cast<uint32_t>(t_Data->scene->nodes_count);
+	a_Model.linearNodeCount = t_QueueEnd;
+	BuildModelHierarchy(a_SystemAllocator, a_Model);
+
 	//get it all in GPU buffers now.
 	{
 		const uint32_t t_VertexBufferSize = t_VertexCount * sizeof(Vertex);
 
 		const UploadBufferChunk t_VertChunk = a_UploadBuffer.Alloc(t_VertexBufferSize);
-		memcpy(t_VertChunk.memory, t_Vertices, t_VertexBufferSize);
+		//Upload memory is write-combined, streaming stores skip the cache that would never be read.
+		Memory::MemCpyStream(t_VertChunk.memory, t_Vertices, t_VertexBufferSize);
 
 		a_Model.vertexView = AllocateFromVertexBuffer(t_VertexBufferSize);
 
@@ -1139,7 +1189,7 @@ void LoadglTFModel(Allocator a_SystemAllocator, Model& a_Model, UploadBuffer& a_
 		const uint32_t t_IndexBufferSize = t_IndexCount * sizeof(uint32_t);
 
 		const UploadBufferChunk t_IndexChunk = a_UploadBuffer.Alloc(t_IndexBufferSize);
-		memcpy(t_IndexChunk.memory, t_Indices, t_IndexBufferSize);
+		Memory::MemCpyStream(t_IndexChunk.memory, t_Indices, t_IndexBufferSize);
 
 		a_Model.indexView = AllocateFromIndexBuffer(t_IndexBufferSize);
 
@@ -1,5 +1,6 @@
 #include "Transform.h"
 #include "RenderFrontend.h"
+#include "Utils/Utils.h"
 #include "Math.inl"
 
 using namespace BB;
@@ -41,51 +42,96 @@ void Transform::SetScale(const float3 a_Scale)
 	m_Scale = a_Scale;
 }
 
-const Mat4x4 Transform::CreateMatrix()
+const Mat4x4 Transform::CreateMatrix() const
 {
-	Mat4x4 t_Matrix = Mat4x4Identity();
-	t_Matrix = t_Matrix * Mat4x4FromTranslation(m_Pos);
-	t_Matrix = t_Matrix * Mat4x4FromQuat(m_Rot);
-	t_Matrix = Mat4x4Scale(t_Matrix, m_Scale);
-	return t_Matrix;
+	return Mat4x4FromTRS(m_Pos, m_Rot, m_Scale);
 }
 
-//slotmap type of data structure.
-struct TransformNode
-{
-	union //44 bytes
-	{
-		Transform transform; 
-		uint32_t next;
-	};
-	
-	uint32_t generation; //48 bytes
-};
-
+//slotmap type of data structure, every part of a transform has its own array so the matrices can be build in batches.
 struct BB::TransformPool_inst
 {
 	TransformPool_inst(Allocator a_SysAllocator, const uint32_t a_TransformCount)
 		:	systemAllocator(a_SysAllocator)
 	{
 		transformCount = a_TransformCount;
+		dirtyWordCount = (a_TransformCount + 63) / 64;
 		nextFreeTransform = 0;
-		transforms = reinterpret_cast<TransformNode*>(BBalloc(a_SysAllocator, sizeof(TransformNode) * a_TransformCount));
-		for (size_t i = 0; i < static_cast<size_t>(transformCount - 1); i++)
+
+		positions = BBnewArr(a_SysAllocator, a_TransformCount, float3);
+		rotations = BBnewArr(a_SysAllocator, a_TransformCount, Quat);
+		scales = BBnewArr(a_SysAllocator, a_TransformCount, float3);
+		generations = BBnewArr(a_SysAllocator, a_TransformCount, uint32_t);
+		nextFree = BBnewArr(a_SysAllocator, a_TransformCount, uint32_t);
+		matrices = BBnewArr(a_SysAllocator, a_TransformCount, TransformMatrices);
+		updateIndices = BBnewArr(a_SysAllocator, a_TransformCount, uint32_t);
+		dirtyBits = BBnewArr(a_SysAllocator, dirtyWordCount, uint64_t);
+
+		for (uint32_t i = 0; i < transformCount; i++)
 		{
-			transforms[i].next = static_cast<uint32_t>(i + 1);
-			transforms[i].generation = 1;
+			nextFree[i] = i + 1;
+			generations[i] = 1;
 		}
-
-		transforms[transformCount - 1].next = UINT32_MAX;
-		transforms[transformCount - 1].generation = 1;
+		nextFree[transformCount - 1] = UINT32_MAX;
+		memset(dirtyBits, 0, sizeof(uint64_t) * dirtyWordCount);
 	};
 
+	~TransformPool_inst()
+	{
+		BBfreeArr(systemAllocator, positions);
+		BBfreeArr(systemAllocator, rotations);
+		BBfreeArr(systemAllocator, scales);
+		BBfreeArr(systemAllocator, generations);
+		BBfreeArr(systemAllocator, nextFree);
+		BBfreeArr(systemAllocator, matrices);
+		BBfreeArr(systemAllocator, updateIndices);
+		BBfreeArr(systemAllocator, dirtyBits);
+	}
+
+	inline void MarkDirty(const uint32_t a_Index)
+	{
+		dirtyBits[a_Index / 64] |= 1ull << (a_Index & 63);
+	}
+
+	inline void ClearDirty(const uint32_t a_Index)
+	{
+		dirtyBits[a_Index / 64] &= ~(1ull << (a_Index & 63));
+	}
+
+	inline uint32_t Create(const Transform& a_Transform)
+	{
+		const uint32_t t_TransformIndex = nextFreeTransform;
+		BB_ASSERT(t_TransformIndex != UINT32_MAX, "TransformPool is full!");
+		nextFreeTransform = nextFree[t_TransformIndex];
+
+		positions[t_TransformIndex] = a_Transform.m_Pos;
+		rotations[t_TransformIndex] = a_Transform.m_Rot;
+		scales[t_TransformIndex] = a_Transform.m_Scale;
+		MarkDirty(t_TransformIndex);
+		return t_TransformIndex;
+	}
+
+	inline void CheckHandle(const TransformHandle a_Handle) const
+	{
+		BB_ASSERT(a_Handle.extraIndex == generations[a_Handle.index], "Transform likely freed twice.");
+	}
+
 	Allocator systemAllocator;
 
 	uint32_t transformCount;
+	uint32_t dirtyWordCount;
 	uint32_t nextFreeTransform;
 
-	TransformNode* transforms;
+	float3* positions;
+	Quat* rotations;
+	float3* scales;
+	uint32_t* generations;
+	uint32_t* nextFree;
+	TransformMatrices* matrices;
+
+	//Scratch space for the dirty transform indices of an update.
+	uint32_t* updateIndices;
+	//A set bit means the matrices of that transform are outdated.
+	uint64_t* dirtyBits;
 };
 
 TransformPool::TransformPool(Allocator a_SysAllocator, const uint32_t a_MatrixSize)
@@ -96,59 +142,111 @@ TransformPool::TransformPool(Allocator a_SysAllocator, const uint32_t a_MatrixSi
 TransformPool::~TransformPool()
 {
 	Allocator t_Allocator = inst->systemAllocator;
+	inst->~TransformPool_inst();
 	BBfree(t_Allocator, inst);
 }
 
 TransformHandle TransformPool::CreateTransform(const float3 a_Position)
 {
-	const uint32_t t_TransformIndex = inst->nextFreeTransform;
-	TransformNode* t_Node = &inst->transforms[t_TransformIndex];
-	inst->nextFreeTransform = t_Node->next;
+	const uint32_t t_TransformIndex = inst->Create(Transform(a_Position));
+	return TransformHandle(t_TransformIndex, inst->generations[t_TransformIndex]);
+}
 
-	//WILL OVERWRITE t_Node->next due to it being a union.
-	new (&t_Node->transform) Transform(a_Position);
+TransformHandle TransformPool::CreateTransform(const float3 a_Position, const float3 a_Axis, const float a_Radians)
+{
+	const uint32_t t_TransformIndex = inst->Create(Transform(a_Position, a_Axis, a_Radians));
+	return TransformHandle(t_TransformIndex, inst->generations[t_TransformIndex]);
+}
 
-	return TransformHandle(t_TransformIndex, t_Node->generation);
+TransformHandle TransformPool::CreateTransform(const float3 a_Position, const float3 a_Axis, const float a_Radians, const float3 a_Scale)
+{
+	const uint32_t t_TransformIndex = inst->Create(Transform(a_Position, a_Axis, a_Radians, a_Scale));
+	return TransformHandle(t_TransformIndex, inst->generations[t_TransformIndex]);
 }
 
-TransformHandle TransformPool::CreateTransform(const float3 a_Position, const float3 a_Axis, const float a_Radians)
+void TransformPool::FreeTransform(const TransformHandle a_Handle)
 {
-	const uint32_t t_TransformIndex = inst->nextFreeTransform;
-	TransformNode* t_Node = &inst->transforms[t_TransformIndex];
-	inst->nextFreeTransform = t_Node->next;
+	inst->CheckHandle(a_Handle);
 
-	//WILL OVERWRITE t_Node->next due to it being a union.
-	new (&t_Node->transform) Transform(a_Position, a_Axis, a_Radians);
+	//mark transform as free.
+	inst->nextFree[a_Handle.index] = inst->nextFreeTransform;
+	++inst->generations[a_Handle.index];
+	inst->nextFreeTransform = a_Handle.index;
+	inst->ClearDirty(a_Handle.index);
+}
 
-	return TransformHandle(t_TransformIndex, t_Node->generation);
+const Transform TransformPool::GetTransform(const TransformHandle a_Handle) const
+{
+	inst->CheckHandle(a_Handle);
+	Transform t_Transform(inst->positions[a_Handle.index]);
+	t_Transform.m_Rot = inst->rotations[a_Handle.index];
+	t_Transform.m_Scale = inst->scales[a_Handle.index];
+	return t_Transform;
 }
 
-TransformHandle TransformPool::CreateTransform(const float3 a_Position, const float3 a_Axis, const float a_Radians, const float3 a_Scale)
+void TransformPool::Translate(const TransformHandle a_Handle, const float3 a_Translation)
 {
-	const uint32_t t_TransformIndex = inst->nextFreeTransform;
-	TransformNode* t_Node = &inst->transforms[t_TransformIndex];
-	inst->nextFreeTransform = t_Node->next;
+	inst->CheckHandle(a_Handle);
+	inst->positions[a_Handle.index] = inst->positions[a_Handle.index] + a_Translation;
+	inst->MarkDirty(a_Handle.index);
+}
 
-	//WILL OVERWRITE t_Node->next due to it being a union.
-	new (&t_Node->transform) Transform(a_Position, a_Axis, a_Radians, a_Scale);
+void TransformPool::SetPosition(const TransformHandle a_Handle, const float3 a_Position)
+{
+	inst->CheckHandle(a_Handle);
+	inst->positions[a_Handle.index] = a_Position;
+	inst->MarkDirty(a_Handle.index);
+}
 
-	return TransformHandle(t_TransformIndex, t_Node->generation);
+void TransformPool::SetRotation(const TransformHandle a_Handle, const float3 a_Axis, const float a_Radians)
+{
+	inst->CheckHandle(a_Handle);
+	inst->rotations[a_Handle.index] = QuatFromAxisAngle(a_Axis, a_Radians);
+	inst->MarkDirty(a_Handle.index);
 }
 
-void TransformPool::FreeTransform(const TransformHandle a_Handle)
+void TransformPool::SetScale(const TransformHandle a_Handle, const float3 a_Scale)
+{
+	inst->CheckHandle(a_Handle);
+	inst->scales[a_Handle.index] = a_Scale;
+	inst->MarkDirty(a_Handle.index);
+}
+
+const Mat4x4 TransformPool::CreateMatrix(const TransformHandle a_Handle) const
 {
-	BB_ASSERT(a_Handle.extraIndex == inst->transforms[a_Handle.index].generation, "Transform likely freed twice.")
+	inst->CheckHandle(a_Handle);
+	return Mat4x4FromTRS(inst->positions[a_Handle.index], inst->rotations[a_Handle.index], inst->scales[a_Handle.index]);
+}
 
-	//mark transform as free.
-	inst->transforms[a_Handle.index].next = inst->transforms->next;
-	++inst->transforms[a_Handle.index].generation;
-	inst->transforms->next = a_Handle.index;
+const uint32_t TransformPool::UpdateMatrices()
+{
+	uint32_t t_UpdateCount = 0;
+	for (uint32_t i = 0; i < inst->dirtyWordCount; i++)
+	{
+		uint64_t t_Word = inst->dirtyBits[i];
+		inst->dirtyBits[i] = 0;
+		while (t_Word != 0)
+		{
+			inst->updateIndices[t_UpdateCount++] = i * 64 + Math::FindFirstSetBit(t_Word);
+			t_Word &= t_Word - 1;
+		}
+	}
+
+	if (t_UpdateCount == 0)
+		return 0;
+
+	//The matrices are read on the CPU right after, so keep them in the cache.
+	Mat4x4FromTRSBatch(&inst->matrices->transform, &inst->matrices->inverse, sizeof(TransformMatrices),
+		inst->positions, inst->rotations, inst->scales,
+		inst->updateIndices, t_UpdateCount, false);
+
+	return t_UpdateCount;
 }
 
-Transform& TransformPool::GetTransform(const TransformHandle a_Handle) const
+const TransformMatrices& TransformPool::GetMatrices(const TransformHandle a_Handle) const
 {
-	BB_ASSERT(a_Handle.extraIndex == inst->transforms[a_Handle.index].generation, "Transform likely freed twice.")
-	return inst->transforms[a_Handle.index].transform;
+	inst->CheckHandle(a_Handle);
+	return inst->matrices[a_Handle.index];
 }
 
 const uint32_t TransformPool::PoolSize() const
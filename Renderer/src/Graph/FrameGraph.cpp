@@ -6,7 +6,9 @@
 #include "Editor.h"
 
 #include "Array.h"
-#include "Slotmap.h"
+#include "HandleRegistry.h"
+#include "ScratchAllocator.h"
+#include "RingAllocator.h"
 
 using namespace BB;
 
@@ -24,16 +26,19 @@ struct FrameData
 
 struct BB::FrameGraph_inst
 {
-	FrameGraph_inst(Allocator a_Allocator) :
-		renderpasses(a_Allocator, 8), nodes(a_Allocator, 128), resources(a_Allocator, 256) {};
+	FrameGraph_inst(Allocator a_Allocator, size_t& a_FrameRingSize) :
+		renderpasses(a_Allocator, 8), nodes(a_Allocator, 1024), resources(a_Allocator, 4096), frameRing(a_FrameRingSize) {};
 
 	//TEMP
 	CommandList* commandList = nullptr;
 
 	Array<FrameGraphRenderPass> renderpasses;
 
-	Slotmap<FrameGraphNode> nodes;
-	Slotmap<FrameGraphResource> resources;
+	HandleRegistry<FrameGraphNode> nodes;
+	HandleRegistry<FrameGraphResource> resources;
+
+	//Retired with the graphics fence of the frame that allocated it.
+	FrameRingAllocator frameRing;
 
 	FrameIndex currentFrame = 0;
 	FrameData frameData[3]{};
@@ -41,7 +46,8 @@ struct BB::FrameGraph_inst
 
 FrameGraph::FrameGraph()
 {
-	inst = BBnew(m_Allocator, FrameGraph_inst)(m_Allocator);
+	size_t t_FrameRingSize = mbSize * 4;
+	inst = BBnew(m_Allocator, FrameGraph_inst)(m_Allocator, t_FrameRingSize);
 }
 
 FrameGraph::~FrameGraph()
@@ -60,6 +66,10 @@ void FrameGraph::BeginRendering()
 	//wait for the previous frame to be completely done.
 	Render::GetGraphicsQueue().WaitFenceValue(inst->frameData[inst->currentFrame].graphicsFenceValue);
 	Render::GetTransferQueue().WaitFenceValue(inst->frameData[inst->currentFrame].transferFenceValue);
+	inst->frameRing.Retire(inst->frameData[inst->currentFrame].graphicsFenceValue);
+	//Scratch memory from the previous frame is no longer used.
+	Scratch::NextFrame();
+	HeapProfiler::NextFrame();
 
 	inst->commandList = Render::GetGraphicsQueue().GetCommandList();
 	RenderBackend::BindDescriptorHeaps(inst->commandList->list, Render::GetGPUHeap(inst->currentFrame), BB_INVALID_HANDLE);
@@ -88,6 +98,7 @@ void FrameGraph::Render()
 	}
 	Render::UploadDescriptorsToGPU(inst->currentFrame);
 	Editor::DisplayAllocator(m_Allocator);
+	Editor::DisplayScratchArenas();
 }
 
 void FrameGraph::EndRendering()
@@ -104,6 +115,7 @@ void FrameGraph::EndRendering()
 
 	inst->frameData[inst->currentFrame].graphicsFenceValue = Render::GetGraphicsQueue().GetNextFenceValue() - 1;
 	inst->frameData[inst->currentFrame].transferFenceValue = Render::GetTransferQueue().GetNextFenceValue() - 1;
+	inst->frameRing.EndFrame(inst->frameData[inst->currentFrame].graphicsFenceValue);
 
 	Render::EndFrame(inst->commandList->list);
 	RenderBackend::EndCommandList(inst->commandList->list);
@@ -113,6 +125,11 @@ void FrameGraph::EndRendering()
 	inst->currentFrame = RenderBackend::PresentFrame(t_PresentFrame);
 }
 
+Allocator FrameGraph::GetFrameAllocator()
+{
+	return inst->frameRing;
+}
+
 const FrameGraphResourceHandle FrameGraph::CreateResource(const FrameGraphResource& a_Resource)
 {
 	return FrameGraphResourceHandle(inst->resources.emplace(a_Resource).handle);
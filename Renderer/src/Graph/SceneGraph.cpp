@@ -9,11 +9,20 @@
 
 #include "LightSystem.h"
 #include "BBjson.hpp"
+#include "SceneFile.hpp"
 
 #include "Math.inl"
 
+#include <cstddef>
+
 using namespace BB;
 
+static_assert(sizeof(Light) == sizeof(SceneFileLight) &&
+	offsetof(Light, pos) == offsetof(SceneFileLight, pos) &&
+	offsetof(Light, radius) == offsetof(SceneFileLight, radius) &&
+	offsetof(Light, color) == offsetof(SceneFileLight, color),
+	"Light and SceneFileLight need the same layout so that scene files can be used in place.");
+
 struct SceneInfo
 {
 	Mat4x4 view{};
@@ -209,15 +218,15 @@ SceneGraph::SceneGraph(Allocator a_Allocator, Allocator a_TemporaryAllocator, co
 	t_SceneJson.Parse();
 	const JsonObject& t_Head = *t_SceneJson.GetRootNode()->GetObject();
 	//Jank, find new way to do hashmap finding that does not return a pointer.
-	JsonNode* t_JsonNode = *t_Head.map.find("scene");
+	JsonNode* t_JsonNode = *t_Head.map.find("scene"_sid);
 	const JsonObject& t_SceneObj = *t_JsonNode->GetObject();
 
 	SceneCreateInfo t_SceneCreateInfo;
 	{
-		t_JsonNode = *t_SceneObj.map.find("scene_name");
+		t_JsonNode = *t_SceneObj.map.find("scene_name"_sid);
 		t_SceneCreateInfo.sceneName = Asset::FindOrCreateString(t_JsonNode->GetString());
 
-		t_JsonNode = *t_SceneObj.map.find("scene_lights");
+		t_JsonNode = *t_SceneObj.map.find("scene_lights"_sid);
 		const JsonList& t_LightsList = t_JsonNode->GetList();
 		//
 		Light* t_Lights = BBnewArr(a_TemporaryAllocator, t_LightsList.nodeCount, Light);
@@ -226,25 +235,25 @@ SceneGraph::SceneGraph(Allocator a_Allocator, Allocator a_TemporaryAllocator, co
 			const JsonObject& t_LightObject = *t_LightsList.nodes[i]->GetObject();
 			//Jank, find new way to do hashmap finding that does not return a pointer.
 			{
-				const JsonNode* t_Radius = *t_LightObject.map.find("radius");
-				t_Lights->radius = t_Radius->GetNumber();
+				const JsonNode* t_Radius = *t_LightObject.map.find("radius"_sid);
+				t_Lights[i].radius = t_Radius->GetNumber();
 			}
 			{
-				const JsonNode* t_PosList = *t_LightObject.map.find("position");
-				t_Lights->pos.x = t_PosList->GetList().nodes[0]->GetNumber();
-				t_Lights->pos.y = t_PosList->GetList().nodes[1]->GetNumber();
-				t_Lights->pos.z = t_PosList->GetList().nodes[2]->GetNumber();
+				const JsonNode* t_PosList = *t_LightObject.map.find("position"_sid);
+				t_Lights[i].pos.x = t_PosList->GetList().nodes[0]->GetNumber();
+				t_Lights[i].pos.y = t_PosList->GetList().nodes[1]->GetNumber();
+				t_Lights[i].pos.z = t_PosList->GetList().nodes[2]->GetNumber();
 			}
 			{
-				const JsonNode* t_ColorList = *t_LightObject.map.find("color");
-				t_Lights->color.x = t_ColorList->GetList().nodes[0]->GetNumber();
-				t_Lights->color.y = t_ColorList->GetList().nodes[1]->GetNumber();
-				t_Lights->color.z = t_ColorList->GetList().nodes[2]->GetNumber();
-				t_Lights->color.w = t_ColorList->GetList().nodes[3]->GetNumber();
+				const JsonNode* t_ColorList = *t_LightObject.map.find("color"_sid);
+				t_Lights[i].color.x = t_ColorList->GetList().nodes[0]->GetNumber();
+				t_Lights[i].color.y = t_ColorList->GetList().nodes[1]->GetNumber();
+				t_Lights[i].color.z = t_ColorList->GetList().nodes[2]->GetNumber();
+				t_Lights[i].color.w = t_ColorList->GetList().nodes[3]->GetNumber();
 			}
 		}
 
-		t_SceneCreateInfo.lights = BB::Slice(t_Lights, t_LightsList.nodeCount);
+		t_SceneCreateInfo.lights = BB::Slice<const Light>(t_Lights, t_LightsList.nodeCount);
 	}
 	const Render_IO t_RIO = Render::GetIO();
 	t_SceneCreateInfo.sceneWindowWidth = t_RIO.swapchainWidth;
@@ -253,6 +262,22 @@ SceneGraph::SceneGraph(Allocator a_Allocator, Allocator a_TemporaryAllocator, co
 	Init(a_Allocator, t_SceneCreateInfo);
 }
 
+SceneGraph::SceneGraph(Allocator a_Allocator, const SceneFile& a_SceneFile)
+{
+	BB_ASSERT(a_SceneFile.IsValid(), "Trying to make a scene from an invalid scene file.");
+	const Slice<const SceneFileLight> t_FileLights = a_SceneFile.GetLights();
+
+	SceneCreateInfo t_SceneCreateInfo;
+	t_SceneCreateInfo.sceneName = Asset::FindOrCreateString(a_SceneFile.GetSceneName());
+	t_SceneCreateInfo.lights = BB::Slice(reinterpret_cast<const Light*>(t_FileLights.data()), t_FileLights.size());
+
+	const Render_IO t_RIO = Render::GetIO();
+	t_SceneCreateInfo.sceneWindowWidth = t_RIO.swapchainWidth;
+	t_SceneCreateInfo.sceneWindowHeight = t_RIO.swapchainHeight;
+
+	Init(a_Allocator, t_SceneCreateInfo);
+}
+
 void SceneGraph::Init(Allocator a_Allocator, const SceneCreateInfo& a_CreateInfo)
 {
 	const uint32_t t_BackBufferAmount = RenderBackend::GetFrameBufferAmount();
@@ -657,50 +682,39 @@ void SceneGraph::SetView(const Mat4x4& a_View)
 	inst->sceneInfo.view = a_View;
 }
 
-void TraverseModelNode(SceneGraph_inst* a_Inst, SceneDrawCall& a_DrawCall, const Model& a_Model, const Model::Node& a_Node, const Mat4x4& a_Transform)
+void SceneGraph::RenderModel(const RModelHandle a_Model, const Mat4x4& a_Transform)
 {
-	const Mat4x4 t_LocalTransform = a_Transform * a_Node.transform;
+	Model& t_Model = Render::GetModel(a_Model);
+	//Only does work when a node of the model changed, otherwise the cached model matrices are used.
+	Render::UpdateModelMatrices(t_Model);
 
-	if (a_Node.meshIndex != MESH_INVALID_INDEX)
+	SceneDrawCall t_DrawCall;
+	t_DrawCall.meshDescriptorOffset = t_Model.descAllocation.offset;
+	t_DrawCall.pipeline = t_Model.pipelineHandle;
+
+	for (uint32_t t_MeshNode = 0; t_MeshNode < t_Model.meshNodeCount; t_MeshNode++)
 	{
-		const Model::Mesh& t_Mesh = a_Model.meshes[a_Node.meshIndex];
+		const uint32_t t_NodeIndex = t_Model.meshNodes[t_MeshNode];
+		const Model::Mesh& t_Mesh = t_Model.meshes[t_Model.linearNodes[t_NodeIndex].meshIndex];
+
 		InstanceTransform t_Transform;
-		//wrong, need to go through the childeren and then update the transforms that way.
-		t_Transform.transform = t_LocalTransform;
-		t_Transform.inverse = Mat4x4Inverse(t_LocalTransform);
-		a_DrawCall.transformIndex = a_Inst->currentFrame->transformArray.AddTransform(t_Transform);
+		t_Transform.transform = a_Transform * t_Model.modelMatrices[t_NodeIndex];
+		t_Transform.inverse = Mat4x4Inverse(t_Transform.transform);
+		t_DrawCall.transformIndex = inst->currentFrame->transformArray.AddTransform(t_Transform);
 
 		for (size_t t_PrimIndex = 0; t_PrimIndex < t_Mesh.primitiveCount; t_PrimIndex++)
 		{
-			const Model::Primitive& t_Prim = a_Model.primitives[t_Mesh.primitiveOffset + t_PrimIndex];
+			const Model::Primitive& t_Prim = t_Model.primitives[t_Mesh.primitiveOffset + t_PrimIndex];
 
-			BB_ASSERT(t_Prim.indexCount + t_Prim.indexStart < a_Model.indexView.size, "index buffer reading out of bounds");
-			a_DrawCall.baseColorIndex = t_Prim.baseColorIndex.index;
-			a_DrawCall.normalTexture = t_Prim.normalIndex.index;
-			a_DrawCall.indexCount = t_Prim.indexCount;
+			BB_ASSERT(t_Prim.indexCount + t_Prim.indexStart < t_Model.indexView.size, "index buffer reading out of bounds");
+			t_DrawCall.baseColorIndex = t_Prim.baseColorIndex.index;
+			t_DrawCall.normalTexture = t_Prim.normalIndex.index;
+			t_DrawCall.indexCount = t_Prim.indexCount;
 			//Hacky way to only set the index buffer once, and let the drawindexed just index deep into the buffer.
-			a_DrawCall.indexStart = t_Prim.indexStart + (a_Model.indexView.offset / (sizeof(uint32_t)));
-			a_Inst->currentFrame->drawArray.AddDrawCall(a_DrawCall);
+			t_DrawCall.indexStart = t_Prim.indexStart + (t_Model.indexView.offset / (sizeof(uint32_t)));
+			inst->currentFrame->drawArray.AddDrawCall(t_DrawCall);
 		}
 	}
-
-	for (size_t i = 0; i < a_Node.childCount; i++)
-	{
-		const Model::Node& a_ChildNode = a_Node.childeren[i];
-		TraverseModelNode(a_Inst, a_DrawCall, a_Model, a_ChildNode, t_LocalTransform);
-	}
-}
-
-void SceneGraph::RenderModel(const RModelHandle a_Model, const Mat4x4& a_Transform)
-{
-	const Model& t_Model = Render::GetModel(a_Model);
-
-	SceneDrawCall t_DrawCall;
-	t_DrawCall.meshDescriptorOffset = t_Model.descAllocation.offset;
-	t_DrawCall.pipeline = t_Model.pipelineHandle;
-
-	//root node is always 0? I think so, needs confirmation.
-	TraverseModelNode(inst, t_DrawCall, t_Model, t_Model.linearNodes[0], a_Transform);
 }
 
 void SceneGraph::RenderModels(const RModelHandle* a_Models, const Mat4x4* a_Transforms, const uint32_t a_ObjectCount)
@@ -10,6 +10,7 @@
 #include "Editor.h"
 
 #include "AssetLoader.hpp"
+#include "SceneFile.hpp"
 #include "Math.inl"
 
 #include <chrono>
@@ -71,8 +72,9 @@ int main(int argc, char** argv)
 	Camera t_Cam{ float3{2.0f, 2.0f, 2.0f}, 0.35f };
 	FreelistAllocator_t t_SceneAllocator{ mbSize * 32 };
 	TemporaryAllocator t_TempAllocator{ t_SceneAllocator };
-	SceneCreateInfo t_SceneCreateInfo;
-	SceneGraph t_Scene{ t_SceneAllocator, t_TempAllocator, "Resources/Json/test_scene.json" };
+	//Made from Resources/Json/test_scene.json by the SceneConverter tool during the build.
+	SceneFile t_SceneFile{ "Resources/Scenes/test_scene.bbscene" };
+	SceneGraph t_Scene{ t_SceneAllocator, t_SceneFile };
 
 	Mat4x4 t_ProjMat = Mat4x4Perspective(ToRadians(60.0f),
 		t_WindowWidth / (float)t_WindowHeight,
@@ -119,14 +121,9 @@ int main(int argc, char** argv)
 
 
 	const TransformHandle t_TransformHandle1 = transformPool.CreateTransform(float3{ 0, -1, 1 });
-	Transform& t_Transform1 = transformPool.GetTransform(t_TransformHandle1);
-
 	const TransformHandle t_TransformHandle2 = transformPool.CreateTransform(float3{ 0, 1, 0 });
-	Transform& t_Transform2 = transformPool.GetTransform(t_TransformHandle2);
-
 	const TransformHandle t_TransformHandle3 = transformPool.CreateTransform(float3{ 0, 10, 0 },
 		float3{ 0, 0, 0 }, 0, float3{ 0.1f, 0.1f, 0.1f });
-	Transform& t_Transform3 = transformPool.GetTransform(t_TransformHandle3);
 
 	static auto t_StartTime = std::chrono::high_resolution_clock::now();
 	auto t_CurrentTime = std::chrono::high_resolution_clock::now();
@@ -197,17 +194,19 @@ int main(int argc, char** argv)
 		}
 		t_Scene.SetView(t_Cam.CalculateView());
 		t_FrameGraph.BeginRendering();
+		//Only the transforms that changed last frame get a new matrix.
+		transformPool.UpdateMatrices();
 
-		t_Scene.RenderModel(t_glTFDuck, t_Transform1.CreateMatrix());
-		t_Scene.RenderModel(t_Model, t_Transform2.CreateMatrix());
-		t_Scene.RenderModel(t_gltfSponza, t_Transform3.CreateMatrix());
+		t_Scene.RenderModel(t_glTFDuck, transformPool.GetMatrices(t_TransformHandle1).transform);
+		t_Scene.RenderModel(t_Model, transformPool.GetMatrices(t_TransformHandle2).transform);
+		t_Scene.RenderModel(t_gltfSponza, transformPool.GetMatrices(t_TransformHandle3).transform);
 		Editor::StartEditorFrame();
 		Editor::DisplaySceneInfo(t_Scene);
 
 		t_DeltaTime = std::chrono::duration<float, std::chrono::seconds::period>(t_CurrentTime - t_StartTime).count();
 
-		t_Transform1.SetRotation(float3{ 0.0f, 1.0f, 0.0f }, 1.1f * t_DeltaTime);
-		t_Transform2.SetRotation(float3{ 0.0f, 0.0f, 1.0f }, 1.0f * t_DeltaTime);
+		transformPool.SetRotation(t_TransformHandle1, float3{ 0.0f, 1.0f, 0.0f }, 1.1f * t_DeltaTime);
+		transformPool.SetRotation(t_TransformHandle2, float3{ 0.0f, 0.0f, 1.0f }, 1.0f * t_DeltaTime);
 
 		t_FrameGraph.Render();
 		t_FrameGraph.EndRendering();